@@ -0,0 +1,150 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "common/packed_kv.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "butil/iobuf.h"
+#include "common/logging.h"
+
+namespace dingodb {
+
+static void WriteOffset(uint32_t offset, char* out) {
+  out[0] = static_cast<char>(offset & 0xFF);
+  out[1] = static_cast<char>((offset >> 8) & 0xFF);
+  out[2] = static_cast<char>((offset >> 16) & 0xFF);
+  out[3] = static_cast<char>((offset >> 24) & 0xFF);
+}
+
+static uint32_t ReadOffset(const char* in) {
+  const auto* p = reinterpret_cast<const uint8_t*>(in);
+  return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16) |
+         (static_cast<uint32_t>(p[3]) << 24);
+}
+
+void PackedKv::Encode(const std::vector<pb::common::KeyValue>& kvs, std::string& out) {
+  size_t data_size = 0;
+  for (const auto& kv : kvs) {
+    data_size += kv.key().size() + kv.value().size();
+  }
+
+  CHECK(data_size <= UINT32_MAX) << "packed kvs exceed 4GB, size: " << data_size;
+
+  size_t begin = out.size();
+  out.resize(begin + kvs.size() * 2 * kOffsetSize + data_size);
+
+  char* offset_pos = out.data() + begin;
+  char* data_begin = offset_pos + kvs.size() * 2 * kOffsetSize;
+  char* data_pos = data_begin;
+  for (const auto& kv : kvs) {
+    kv.key().copy(data_pos, kv.key().size());
+    data_pos += kv.key().size();
+    WriteOffset(static_cast<uint32_t>(data_pos - data_begin), offset_pos);
+    offset_pos += kOffsetSize;
+
+    kv.value().copy(data_pos, kv.value().size());
+    data_pos += kv.value().size();
+    WriteOffset(static_cast<uint32_t>(data_pos - data_begin), offset_pos);
+    offset_pos += kOffsetSize;
+  }
+}
+
+void PackedKv::Encode(const std::vector<pb::common::KeyValue>& kvs, butil::IOBuf& out) {
+  std::string offsets(kvs.size() * 2 * kOffsetSize, '\0');
+  char* offset_pos = offsets.data();
+  size_t data_size = 0;
+  for (const auto& kv : kvs) {
+    data_size += kv.key().size();
+    WriteOffset(static_cast<uint32_t>(data_size), offset_pos);
+    offset_pos += kOffsetSize;
+
+    data_size += kv.value().size();
+    WriteOffset(static_cast<uint32_t>(data_size), offset_pos);
+    offset_pos += kOffsetSize;
+  }
+  CHECK(data_size <= UINT32_MAX) << "packed kvs exceed 4GB, size: " << data_size;
+
+  out.append(offsets);
+  for (const auto& kv : kvs) {
+    out.append(kv.key());
+    out.append(kv.value());
+  }
+}
+
+bool PackedKv::Decode(std::string_view data, int64_t count,
+                      std::vector<std::pair<std::string_view, std::string_view>>& kvs) {
+  kvs.clear();
+  if (count < 0 || static_cast<uint64_t>(count) > data.size() / (2 * kOffsetSize)) {
+    return false;
+  }
+
+  size_t offsets_size = count * 2 * kOffsetSize;
+  std::string_view values = data.substr(offsets_size);
+  kvs.reserve(count);
+
+  uint32_t begin = 0;
+  for (int64_t i = 0; i < count; ++i) {
+    uint32_t key_end = ReadOffset(data.data() + i * 2 * kOffsetSize);
+    uint32_t value_end = ReadOffset(data.data() + i * 2 * kOffsetSize + kOffsetSize);
+    if (key_end < begin || value_end < key_end || value_end > values.size()) {
+      kvs.clear();
+      return false;
+    }
+
+    kvs.emplace_back(values.substr(begin, key_end - begin), values.substr(key_end, value_end - key_end));
+    begin = value_end;
+  }
+
+  return begin == values.size();
+}
+
+bool PackedKv::Decode(const butil::IOBuf& data, int64_t count, std::vector<std::pair<std::string, std::string>>& kvs) {
+  kvs.clear();
+  if (count < 0 || static_cast<uint64_t>(count) > data.size() / (2 * kOffsetSize)) {
+    return false;
+  }
+
+  // Share the blocks of data, cut the offsets and then each key and value from the front.
+  butil::IOBuf values = data;
+  std::string offsets(count * 2 * kOffsetSize, '\0');
+  values.cutn(offsets.data(), offsets.size());
+  kvs.reserve(count);
+
+  uint32_t begin = 0;
+  for (int64_t i = 0; i < count; ++i) {
+    uint32_t key_end = ReadOffset(offsets.data() + i * 2 * kOffsetSize);
+    uint32_t value_end = ReadOffset(offsets.data() + i * 2 * kOffsetSize + kOffsetSize);
+    if (key_end < begin || value_end < key_end || value_end - begin > values.size()) {
+      kvs.clear();
+      return false;
+    }
+
+    auto& [key, value] = kvs.emplace_back();
+    key.resize(key_end - begin);
+    values.cutn(key.data(), key.size());
+    value.resize(value_end - key_end);
+    values.cutn(value.data(), value.size());
+    begin = value_end;
+  }
+
+  return values.empty();
+}
+
+}  // namespace dingodb
@@ -0,0 +1,60 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGODB_COMMON_PACKED_KV_H_  // NOLINT
+#define DINGODB_COMMON_PACKED_KV_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "butil/iobuf.h"
+#include "proto/common.pb.h"
+
+namespace dingodb {
+
+// The packed scan response format, carried by the brpc attachment instead of repeated KeyValue.
+// Layout of n key values:
+//   uint32 little endian end offsets of key[0], value[0], ... key[n-1], value[n-1], 2 * n in total
+//   key[0] value[0] ... key[n-1] value[n-1]
+// The offsets are relative to the beginning of the keys and values, the count n is carried by the response.
+// The keys and values are less than 4GB in total.
+class PackedKv {
+ public:
+  PackedKv() = delete;
+  ~PackedKv() = delete;
+
+  // Append the packed kvs to out.
+  static void Encode(const std::vector<pb::common::KeyValue>& kvs, std::string& out);
+  // Append the packed kvs to out, the keys and values are copied into out only once.
+  static void Encode(const std::vector<pb::common::KeyValue>& kvs, butil::IOBuf& out);
+
+  // The keys and values are views of data, data must outlive them.
+  // Return false if data is not count packed key values.
+  static bool Decode(std::string_view data, int64_t count,
+                     std::vector<std::pair<std::string_view, std::string_view>>& kvs);
+  // The data may be split into several blocks, e.g. a brpc attachment, the keys and values are copied out once.
+  // Return false if data is not count packed key values.
+  static bool Decode(const butil::IOBuf& data, int64_t count, std::vector<std::pair<std::string, std::string>>& kvs);
+
+ private:
+  static constexpr size_t kOffsetSize = sizeof(uint32_t);
+};
+
+}  // namespace dingodb
+
+#endif  // DINGODB_COMMON_PACKED_KV_H_  // NOLINT
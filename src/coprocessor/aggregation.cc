@@ -14,10 +14,14 @@
 
 #include "coprocessor/aggregation.h"
 
+#include <any>
 #include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
+#include <type_traits>
+#include <typeinfo>
+#include <vector>
 
 #include "common/logging.h"
 #include "fmt/core.h"
@@ -25,103 +29,272 @@
 
 namespace dingodb {
 
-Aggregation::Aggregation() = default;
-Aggregation::~Aggregation() { Close(); }
-
-butil::Status Aggregation::Open(
-    size_t start_aggregation_operators_index,
-    const std::shared_ptr<std::vector<std::shared_ptr<BaseSchema>>>& result_serial_schemas,
-    const ::google::protobuf::RepeatedPtrField<pb::store::AggregationOperator>& aggregation_operators) {
-  butil::Status status;
-
-  result_record_ = std::make_shared<std::vector<std::any>>();
-
-  result_record_->reserve((*result_serial_schemas).size() - start_aggregation_operators_index);
-  size_t j = 0;
-  for (size_t i = start_aggregation_operators_index;
-       i < result_serial_schemas->size() && j < aggregation_operators.size(); i++, j++) {
-    auto type = (*result_serial_schemas)[i]->GetType();
-    auto oper = aggregation_operators[j].oper();
-
-    switch (type) {
-      case BaseSchema::Type::kBool: {
-        if (pb::store::COUNT == oper || pb::store::COUNTWITHNULL == oper || pb::store::SUM0 == oper) {
-          result_record_->emplace_back(std::optional<bool>(false));
-        } else {
-          result_record_->emplace_back(std::optional<bool>(std::nullopt));
-        }
-        break;
+template <typename T>
+static bool Less(const T& lhs, const T& rhs) {
+  if constexpr (std::is_same_v<std::shared_ptr<std::string>, T>) {
+    return *lhs < *rhs;
+  } else {
+    return lhs < rhs;
+  }
+}
+
+// The update of each operator, must keep the null semantic: null param is ignored except count with null.
+template <typename PARAM, typename RESULT>
+struct SUM {
+  static constexpr bool kIgnoreParam = false;
+  static void Update(const std::optional<PARAM>& param, std::optional<RESULT>& result) {
+    static_assert(!(std::is_same_v<std::shared_ptr<std::string>, PARAM> ||
+                    std::is_same_v<std::shared_ptr<std::string>, RESULT>),
+                  "SUM : unsupported shared_ptr<std::string>");
+    if (!param.has_value()) {
+      return;
+    }
+    if (!result.has_value()) {
+      result = param.value();
+    } else {
+      result.value() += param.value();
+    }
+  }
+  static void Merge(const std::optional<RESULT>& other, std::optional<RESULT>& result) {
+    SUM<RESULT, RESULT>::Update(other, result);
+  }
+};
+
+template <typename PARAM, typename RESULT>
+struct COUNT {
+  static constexpr bool kIgnoreParam = false;
+  static void Update(const std::optional<PARAM>& param, std::optional<RESULT>& result) {
+    if (!param.has_value()) {
+      return;
+    }
+    if (!result.has_value()) {
+      result = 1;
+    } else {
+      result.value() += 1;
+    }
+  }
+  static void Merge(const std::optional<RESULT>& other, std::optional<RESULT>& result) {
+    if (!other.has_value()) {
+      return;
+    }
+    result = result.value_or(0) + other.value();
+  }
+};
+
+template <typename PARAM, typename RESULT>
+struct COUNTWITHNULL {
+  static constexpr bool kIgnoreParam = true;
+  static void Update(std::optional<RESULT>& result) {
+    if (!result.has_value()) {
+      result = 1;
+    } else {
+      result.value() += 1;
+    }
+  }
+  static void Merge(const std::optional<RESULT>& other, std::optional<RESULT>& result) {
+    if (!other.has_value()) {
+      return;
+    }
+    result = result.value_or(0) + other.value();
+  }
+};
+
+template <typename PARAM, typename RESULT>
+struct MAX {
+  static constexpr bool kIgnoreParam = false;
+  static void Update(const std::optional<PARAM>& param, std::optional<RESULT>& result) {
+    if (!param.has_value()) {
+      return;
+    }
+    if (!result.has_value() || Less(result.value(), param.value())) {
+      result = param.value();
+    }
+  }
+  static void Merge(const std::optional<RESULT>& other, std::optional<RESULT>& result) {
+    MAX<RESULT, RESULT>::Update(other, result);
+  }
+};
+
+template <typename PARAM, typename RESULT>
+struct MIN {
+  static constexpr bool kIgnoreParam = false;
+  static void Update(const std::optional<PARAM>& param, std::optional<RESULT>& result) {
+    if (!param.has_value()) {
+      return;
+    }
+    if (!result.has_value() || Less(param.value(), result.value())) {
+      result = param.value();
+    }
+  }
+  static void Merge(const std::optional<RESULT>& other, std::optional<RESULT>& result) {
+    MIN<RESULT, RESULT>::Update(other, result);
+  }
+};
+
+template <typename PARAM, typename RESULT, template <typename, typename> class OPER>
+class TypedAggregation : public Aggregation {
+ public:
+  // COUNT/COUNTWITHNULL/SUM0 start from zero, others start from null.
+  explicit TypedAggregation(bool init_zero) : init_zero_(init_zero) {}
+  ~TypedAggregation() override = default;
+
+  void AddGroup() override {
+    if (init_zero_) {
+      results_.emplace_back(RESULT());
+    } else {
+      results_.emplace_back(std::nullopt);
+    }
+  }
+
+  bool Execute(int64_t group_index, const std::any& param) override {
+    if constexpr (OPER<PARAM, RESULT>::kIgnoreParam) {
+      OPER<PARAM, RESULT>::Update(results_[group_index]);
+    } else {
+      const auto* param_value = std::any_cast<std::optional<PARAM>>(&param);
+      if (param_value == nullptr) {
+        DINGO_LOG(ERROR) << fmt::format("Aggregation<{},{}> param type mismatch : {}", typeid(PARAM).name(),
+                                        typeid(RESULT).name(), param.type().name());
+        return false;
       }
-      case BaseSchema::Type::kInteger: {
-        if (pb::store::COUNT == oper || pb::store::COUNTWITHNULL == oper || pb::store::SUM0 == oper) {
-          result_record_->emplace_back(std::optional<int32_t>(0));
-        } else {
-          result_record_->emplace_back(std::optional<int32_t>(std::nullopt));
-        }
-        break;
+      OPER<PARAM, RESULT>::Update(*param_value, results_[group_index]);
+    }
+
+    return true;
+  }
+
+  std::any GetResult(int64_t group_index) const override { return results_[group_index]; }
+
+  bool Merge(int64_t group_index, const Aggregation& other, int64_t other_group_index) override {
+    const auto* typed_other = dynamic_cast<const TypedAggregation<PARAM, RESULT, OPER>*>(&other);
+    if (typed_other == nullptr) {
+      DINGO_LOG(ERROR) << fmt::format("Aggregation<{},{}> merge type mismatch", typeid(PARAM).name(),
+                                      typeid(RESULT).name());
+      return false;
+    }
+    OPER<PARAM, RESULT>::Merge(typed_other->results_[other_group_index], results_[group_index]);
+    return true;
+  }
+
+  void Close() override {
+    results_.clear();
+    results_.shrink_to_fit();
+  }
+
+ private:
+  bool init_zero_;
+  std::vector<std::optional<RESULT>> results_;
+};
+
+template <template <typename, typename> class OPER>
+static std::shared_ptr<Aggregation> NewSameTypeAggregation(BaseSchema::Type type, bool init_zero) {
+  switch (type) {
+    case BaseSchema::kBool:
+      return std::make_shared<TypedAggregation<bool, bool, OPER>>(init_zero);
+    case BaseSchema::kInteger:
+      return std::make_shared<TypedAggregation<int32_t, int32_t, OPER>>(init_zero);
+    case BaseSchema::kFloat:
+      return std::make_shared<TypedAggregation<float, float, OPER>>(init_zero);
+    case BaseSchema::kLong:
+      return std::make_shared<TypedAggregation<int64_t, int64_t, OPER>>(init_zero);
+    case BaseSchema::kDouble:
+      return std::make_shared<TypedAggregation<double, double, OPER>>(init_zero);
+    case BaseSchema::kString:
+      // SUM not support string.
+      if constexpr (!std::is_same_v<SUM<bool, bool>, OPER<bool, bool>>) {
+        return std::make_shared<TypedAggregation<std::shared_ptr<std::string>, std::shared_ptr<std::string>, OPER>>(
+            init_zero);
       }
-      case BaseSchema::Type::kFloat: {
-        if (pb::store::COUNT == oper || pb::store::COUNTWITHNULL == oper || pb::store::SUM0 == oper) {
-          result_record_->emplace_back(std::optional<float>(0.0f));
-        } else {
-          result_record_->emplace_back(std::optional<float>(std::nullopt));
-        }
-        break;
+      return nullptr;
+    default:
+      return nullptr;
+  }
+}
+
+template <template <typename, typename> class OPER>
+static std::shared_ptr<Aggregation> NewCountAggregation(BaseSchema::Type type) {
+  switch (type) {
+    case BaseSchema::kBool:
+      return std::make_shared<TypedAggregation<bool, int64_t, OPER>>(true);
+    case BaseSchema::kInteger:
+      return std::make_shared<TypedAggregation<int32_t, int64_t, OPER>>(true);
+    case BaseSchema::kFloat:
+      return std::make_shared<TypedAggregation<float, int64_t, OPER>>(true);
+    case BaseSchema::kLong:
+      return std::make_shared<TypedAggregation<int64_t, int64_t, OPER>>(true);
+    case BaseSchema::kDouble:
+      return std::make_shared<TypedAggregation<double, int64_t, OPER>>(true);
+    case BaseSchema::kString:
+      return std::make_shared<TypedAggregation<std::shared_ptr<std::string>, int64_t, OPER>>(true);
+    default:
+      return nullptr;
+  }
+}
+
+butil::Status Aggregation::New(const pb::store::AggregationOperator& aggregation_operator,
+                               BaseSchema::Type serial_schema_type, BaseSchema::Type result_schema_type,
+                               std::shared_ptr<Aggregation>& aggregation) {
+  const char* oper_name = "";
+  aggregation = nullptr;
+  switch (aggregation_operator.oper()) {
+    case pb::store::AggregationType::SUM0:
+      [[fallthrough]];
+    case pb::store::AggregationType::SUM: {
+      oper_name = "SUM";
+      if (serial_schema_type == result_schema_type) {
+        aggregation = NewSameTypeAggregation<SUM>(serial_schema_type,
+                                                  aggregation_operator.oper() == pb::store::AggregationType::SUM0);
       }
-      case BaseSchema::Type::kLong: {
-        if (pb::store::COUNT == oper || pb::store::COUNTWITHNULL == oper || pb::store::SUM0 == oper) {
-          result_record_->emplace_back(std::optional<int64_t>(0));
-        } else {
-          result_record_->emplace_back(std::optional<int64_t>(std::nullopt));
-        }
-        break;
+      break;
+    }
+    case pb::store::AggregationType::COUNT: {
+      bool with_null = aggregation_operator.index_of_column() == -1;
+      oper_name = with_null ? "COUNTWITHNULL" : "COUNT";
+      if (result_schema_type == BaseSchema::kLong) {
+        aggregation = with_null ? NewCountAggregation<COUNTWITHNULL>(serial_schema_type)
+                                : NewCountAggregation<COUNT>(serial_schema_type);
       }
-      case BaseSchema::Type::kDouble: {
-        if (pb::store::COUNT == oper || pb::store::COUNTWITHNULL == oper || pb::store::SUM0 == oper) {
-          result_record_->emplace_back(std::optional<double>(0.0));
-        } else {
-          result_record_->emplace_back(std::optional<double>(std::nullopt));
-        }
-        break;
+      break;
+    }
+    case pb::store::AggregationType::COUNTWITHNULL: {
+      oper_name = "COUNTWITHNULL";
+      if (result_schema_type == BaseSchema::kLong) {
+        aggregation = NewCountAggregation<COUNTWITHNULL>(serial_schema_type);
       }
-      case BaseSchema::Type::kString: {
-        if (pb::store::COUNT == oper || pb::store::COUNTWITHNULL == oper || pb::store::SUM0 == oper) {
-          result_record_->emplace_back(std::optional<std::shared_ptr<std::string>>(std::make_shared<std::string>()));
-        } else {
-          result_record_->emplace_back(std::optional<std::shared_ptr<std::string>>(std::nullopt));
-        }
-        break;
+      break;
+    }
+    case pb::store::AggregationType::MAX: {
+      oper_name = "MAX";
+      if (serial_schema_type == result_schema_type) {
+        aggregation = NewSameTypeAggregation<MAX>(serial_schema_type, false);
       }
-      default: {
-        std::string error_message = fmt::format("unsupported serial_schema1 type: {}", static_cast<int>(type));
-        DINGO_LOG(ERROR) << error_message;
-        return butil::Status(pb::error::EILLEGAL_PARAMTETERS, error_message);
+      break;
+    }
+    case pb::store::AggregationType::MIN: {
+      oper_name = "MIN";
+      if (serial_schema_type == result_schema_type) {
+        aggregation = NewSameTypeAggregation<MIN>(serial_schema_type, false);
       }
+      break;
     }
-  }
-
-  return butil::Status();
-}
-
-butil::Status Aggregation::Execute(
-    const std::vector<std::function<bool(const std::any&, std::any*)>>& aggregation_functions,
-    const std::vector<std::any>& group_by_operator_record) {
-  bool ret = false;
-  for (size_t i = 0; i < group_by_operator_record.size(); i++) {
-    ret = aggregation_functions[i](group_by_operator_record[i], &(*result_record_)[i]);
-    if (!ret) {
-      std::string error_message = fmt::format("Execute failed index :  {}", i);
+    case pb::store::AggregationType::AGGREGATION_NONE:
+      [[fallthrough]];
+    default: {
+      std::string error_message =
+          fmt::format("unsupported pb_schema1 oper: {}", static_cast<int>(aggregation_operator.oper()));
       DINGO_LOG(ERROR) << error_message;
-      return butil::Status(pb::error::EILLEGAL_PARAMTETERS, error_message);
+      return butil::Status(pb::error::ENOT_SUPPORT, error_message);
     }
   }
-  return butil::Status();
-}
 
-void Aggregation::Close() {
-  if (result_record_) {
-    result_record_.reset();
+  if (aggregation == nullptr) {
+    std::string error_message =
+        fmt::format("{}<{},{}>  not support yet", oper_name, BaseSchema::GetTypeString(serial_schema_type),
+                    BaseSchema::GetTypeString(result_schema_type));
+    DINGO_LOG(ERROR) << error_message;
+    return butil::Status(pb::error::ENOT_SUPPORT, error_message);
   }
+
+  return butil::Status();
 }
 
 }  // namespace dingodb
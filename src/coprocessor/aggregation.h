@@ -18,39 +18,45 @@
 #include <serial/schema/base_schema.h>
 
 #include <any>
-#include <functional>
+#include <cstdint>
 #include <memory>
-#include <vector>
 
 #include "butil/status.h"
 #include "proto/store.pb.h"
 
 namespace dingodb {
 
+// Typed accumulator of one aggregation operator, the state of all groups is kept in typed columns
+// indexed by the group index, instead of a std::any per group.
 class Aggregation {
  public:
-  Aggregation();
-  ~Aggregation();
+  Aggregation() = default;
+  virtual ~Aggregation() = default;
 
   Aggregation(const Aggregation& rhs) = delete;
   Aggregation& operator=(const Aggregation& rhs) = delete;
   Aggregation(Aggregation&& rhs) = delete;
   Aggregation& operator=(Aggregation&& rhs) = delete;
 
-  butil::Status Open(
-      size_t start_aggregation_operators_index,
-      const std::shared_ptr<std::vector<std::shared_ptr<BaseSchema>>>& result_serial_schemas,
-      const ::google::protobuf::RepeatedPtrField<pb::store::AggregationOperator>& aggregation_operators);
+  // Select the accumulator by the operator and the serial schema type, count(-1) is count with null.
+  static butil::Status New(const pb::store::AggregationOperator& aggregation_operator,
+                           BaseSchema::Type serial_schema_type, BaseSchema::Type result_schema_type,
+                           std::shared_ptr<Aggregation>& aggregation /*output*/);
 
-  butil::Status Execute(const std::vector<std::function<bool(const std::any&, std::any*)>>& aggregation_functions,
-                        const std::vector<std::any>& group_by_operator_record);
+  // Append the initial state of a new group.
+  virtual void AddGroup() = 0;
 
-  const std::shared_ptr<std::vector<std::any>>& GetResult() const { return result_record_; }
+  // Return false if the param type mismatch the serial schema type.
+  virtual bool Execute(int64_t group_index, const std::any& param) = 0;
 
-  void Close();
+  // Return std::optional<T> of the result schema type.
+  virtual std::any GetResult(int64_t group_index) const = 0;
 
- private:
-  std::shared_ptr<std::vector<std::any>> result_record_;
+  // Merge the partial state of other group into the group, other must be the same operator and type.
+  // Return false if other is not the same aggregation.
+  virtual bool Merge(int64_t group_index, const Aggregation& other, int64_t other_group_index) = 0;
+
+  virtual void Close() = 0;
 };
 
 }  // namespace dingodb
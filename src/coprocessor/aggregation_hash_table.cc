@@ -0,0 +1,115 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "coprocessor/aggregation_hash_table.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <string_view>
+#include <vector>
+
+namespace dingodb {
+
+static const size_t kInitSlotNum = 64;
+static const size_t kArenaBlockSize = 64 * 1024;
+
+AggregationHashTable::AggregationHashTable() : slots_(kInitSlotNum), mask_(kInitSlotNum - 1) {}
+
+int64_t AggregationHashTable::FindOrInsert(std::string_view key, bool& is_new) {
+  uint64_t hash = std::hash<std::string_view>()(key);
+  uint64_t pos = hash & mask_;
+  while (true) {
+    auto& slot = slots_[pos];
+    if (slot.group_index == -1) {
+      break;
+    }
+    if (slot.hash == hash && keys_[slot.group_index] == key) {
+      is_new = false;
+      return slot.group_index;
+    }
+    pos = (pos + 1) & mask_;
+  }
+
+  is_new = true;
+  int64_t group_index = keys_.size();
+  keys_.push_back(CopyToArena(key));
+  slots_[pos].hash = hash;
+  slots_[pos].group_index = group_index;
+
+  // Keep load factor under 0.5, the probe sequence is short.
+  if (keys_.size() * 2 > slots_.size()) {
+    Grow();
+  }
+
+  return group_index;
+}
+
+void AggregationHashTable::Grow() {
+  std::vector<Slot> new_slots(slots_.size() * 2);
+  uint64_t new_mask = new_slots.size() - 1;
+  for (const auto& slot : slots_) {
+    if (slot.group_index == -1) {
+      continue;
+    }
+    uint64_t pos = slot.hash & new_mask;
+    while (new_slots[pos].group_index != -1) {
+      pos = (pos + 1) & new_mask;
+    }
+    new_slots[pos] = slot;
+  }
+
+  slots_.swap(new_slots);
+  mask_ = new_mask;
+}
+
+std::string_view AggregationHashTable::CopyToArena(std::string_view key) {
+  if (key.empty()) {
+    return {};
+  }
+
+  if (arena_block_used_ + key.size() > arena_block_size_) {
+    // Big key take a block exclusively.
+    arena_block_size_ = std::max(kArenaBlockSize, key.size());
+    arena_blocks_.push_back(std::make_unique<char[]>(arena_block_size_));
+    arena_block_used_ = 0;
+  }
+
+  char* data = arena_blocks_.back().get() + arena_block_used_;
+  memcpy(data, key.data(), key.size());
+  arena_block_used_ += key.size();
+  return {data, key.size()};
+}
+
+std::vector<int64_t> AggregationHashTable::SortedGroupIndexes() const {
+  std::vector<int64_t> group_indexes(keys_.size());
+  std::iota(group_indexes.begin(), group_indexes.end(), 0);
+  std::sort(group_indexes.begin(), group_indexes.end(),
+            [this](int64_t lhs, int64_t rhs) { return keys_[lhs] < keys_[rhs]; });
+  return group_indexes;
+}
+
+void AggregationHashTable::Clear() {
+  slots_.assign(kInitSlotNum, Slot());
+  mask_ = kInitSlotNum - 1;
+  keys_.clear();
+  arena_blocks_.clear();
+  arena_block_used_ = 0;
+  arena_block_size_ = 0;
+}
+
+}  // namespace dingodb
@@ -0,0 +1,71 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGODB_COPROCESSOR_AGGREGATION_HASH_TABLE_H_  // NOLINT
+#define DINGODB_COPROCESSOR_AGGREGATION_HASH_TABLE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace dingodb {
+
+// Map the group by key to a dense group index, open addressing with linear probing.
+// The group key is copied once into an arena on the first time seen, the arena block never move,
+// so the key view is stable until Clear.
+class AggregationHashTable {
+ public:
+  AggregationHashTable();
+  ~AggregationHashTable() = default;
+
+  AggregationHashTable(const AggregationHashTable& rhs) = delete;
+  AggregationHashTable& operator=(const AggregationHashTable& rhs) = delete;
+
+  // Return the group index of the key, a new group is inserted if not exist and is_new is set.
+  int64_t FindOrInsert(std::string_view key, bool& is_new);
+
+  int64_t Size() const { return static_cast<int64_t>(keys_.size()); }
+  std::string_view GetKey(int64_t group_index) const { return keys_[group_index]; }
+
+  // The group indexes ordered by the group key.
+  std::vector<int64_t> SortedGroupIndexes() const;
+
+  void Clear();
+
+ private:
+  struct Slot {
+    uint64_t hash{0};
+    // -1 means empty slot.
+    int64_t group_index{-1};
+  };
+
+  void Grow();
+  std::string_view CopyToArena(std::string_view key);
+
+  std::vector<Slot> slots_;
+  uint64_t mask_{0};
+
+  // The group key of each group, indexed by group index.
+  std::vector<std::string_view> keys_;
+
+  std::vector<std::unique_ptr<char[]>> arena_blocks_;
+  size_t arena_block_used_{0};
+  size_t arena_block_size_{0};
+};
+
+}  // namespace dingodb
+
+#endif  // DINGODB_COPROCESSOR_AGGREGATION_HASH_TABLE_H_  // NOLINT
@@ -18,37 +18,67 @@
 #include <serial/schema/base_schema.h>
 
 #include <any>
-#include <functional>
-#include <map>
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "butil/status.h"
 #include "coprocessor/aggregation.h"
+#include "coprocessor/aggregation_hash_table.h"
 #include "proto/store.pb.h"
 
 namespace dingodb {
 
+using AggregationVector = std::vector<std::shared_ptr<Aggregation>>;
+
+// Iterate the groups in insert order, or in group key order if the sorted group indexes is given.
 class AggregationIterator {
  public:
-  explicit AggregationIterator(const std::shared_ptr<std::map<std::string, std::shared_ptr<Aggregation>>>& aggregations)
-      : aggregations_(aggregations) {
-    iter_ = aggregations_->begin();
-  }
+  AggregationIterator(const std::shared_ptr<AggregationHashTable>& hash_table,
+                      const std::shared_ptr<AggregationVector>& aggregations, std::vector<int64_t> group_indexes)
+      : hash_table_(hash_table), aggregations_(aggregations), group_indexes_(std::move(group_indexes)) {}
 
-  ~AggregationIterator() { aggregations_.reset(); }
+  ~AggregationIterator() {
+    hash_table_.reset();
+    aggregations_.reset();
+  }
 
-  bool HasNext() { return (iter_ != aggregations_->end()); }
-  void Next() { ++iter_; }
-  const std::string& GetKey() const { return iter_->first; }
-  const std::shared_ptr<std::vector<std::any>>& GetValue() const { return iter_->second->GetResult(); }
+  bool HasNext() { return position_ < hash_table_->Size(); }
+  void Next() {
+    ++position_;
+    value_.reset();
+  }
+  const std::string& GetKey() const {
+    key_.assign(hash_table_->GetKey(GroupIndex()));
+    return key_;
+  }
+  const std::shared_ptr<std::vector<std::any>>& GetValue() const {
+    if (value_ == nullptr) {
+      value_ = std::make_shared<std::vector<std::any>>();
+      value_->reserve(aggregations_->size());
+      for (const auto& aggregation : *aggregations_) {
+        value_->emplace_back(aggregation->GetResult(GroupIndex()));
+      }
+    }
+    return value_;
+  }
 
  private:
-  std::shared_ptr<std::map<std::string, std::shared_ptr<Aggregation>>> aggregations_;
-  std::map<std::string, std::shared_ptr<Aggregation>>::iterator iter_;
+  int64_t GroupIndex() const { return group_indexes_.empty() ? position_ : group_indexes_[position_]; }
+
+  std::shared_ptr<AggregationHashTable> hash_table_;
+  std::shared_ptr<AggregationVector> aggregations_;
+  std::vector<int64_t> group_indexes_;
+  int64_t position_{0};
+
+  mutable std::string key_;
+  mutable std::shared_ptr<std::vector<std::any>> value_;
 };
 
+// Hash aggregation, group by key is mapped to a group index by the open addressing hash table,
+// the typed accumulator of each aggregation operator is selected at Open.
 class AggregationManager {
  public:
   AggregationManager();
@@ -59,28 +89,25 @@ class AggregationManager {
   AggregationManager(AggregationManager&& rhs) = delete;
   AggregationManager& operator=(AggregationManager&& rhs) = delete;
 
+  // sorted_output: iterate the groups in group by key order, only when the caller require it.
   butil::Status Open(const std::shared_ptr<std::vector<std::shared_ptr<BaseSchema>>>& group_by_operator_serial_schemas,
                      const ::google::protobuf::RepeatedPtrField<pb::store::AggregationOperator>& aggregation_operators,
-                     const std::shared_ptr<std::vector<std::shared_ptr<BaseSchema>>>& result_serial_schemas);
+                     const std::shared_ptr<std::vector<std::shared_ptr<BaseSchema>>>& result_serial_schemas,
+                     bool sorted_output = false);
 
   butil::Status Execute(const std::string& group_by_key, const std::vector<std::any>& group_by_operator_record);
 
+  // Merge the partial aggregation of other, which is opened with the same operators, e.g. the one of a sub range.
+  butil::Status Merge(const AggregationManager& other);
+
   std::shared_ptr<AggregationIterator> CreateIterator();
 
   void Close();
 
  private:
-  butil::Status AddSumFunction(BaseSchema::Type serial_schema_type, BaseSchema::Type result_schema_type);
-  butil::Status AddCountFunction(BaseSchema::Type serial_schema_type, BaseSchema::Type result_schema_type);
-  butil::Status AddCountWithNullFunction(BaseSchema::Type serial_schema_type, BaseSchema::Type result_schema_type);
-  butil::Status AddMaxFunction(BaseSchema::Type serial_schema_type, BaseSchema::Type result_schema_type);
-  butil::Status AddMinFunction(BaseSchema::Type serial_schema_type, BaseSchema::Type result_schema_type);
-
-  std::shared_ptr<std::vector<std::shared_ptr<BaseSchema>>> group_by_operator_serial_schemas_;
-  ::google::protobuf::RepeatedPtrField<pb::store::AggregationOperator> aggregation_operators_;
-  std::shared_ptr<std::vector<std::shared_ptr<BaseSchema>>> result_serial_schemas_;
-  std::vector<std::function<bool(const std::any&, std::any*)>> aggregation_functions_;
-  std::shared_ptr<std::map<std::string, std::shared_ptr<Aggregation>>> aggregations_;
+  bool sorted_output_{false};
+  std::shared_ptr<AggregationVector> aggregations_;
+  std::shared_ptr<AggregationHashTable> hash_table_;
 };
 
 }  // namespace dingodb
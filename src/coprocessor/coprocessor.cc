@@ -23,9 +23,11 @@
 #include <vector>
 
 #include "common/logging.h"
+#include "coprocessor/expr_bytecode.h"
 #include "coprocessor/raw_coprocessor.h"
 #include "coprocessor/utils.h"
 #include "fmt/core.h"
+#include "gflags/gflags.h"
 #include "libexpr/src/expr/runner.h"
 #include "proto/error.pb.h"
 #include "proto/store.pb.h"
@@ -36,6 +38,9 @@
 
 namespace dingodb {
 
+DEFINE_bool(enable_coprocessor_late_materialization, true,
+            "decode the columns not referenced by the filter only for the rows passed the filter");
+
 Coprocessor::Coprocessor() : enable_expression_(true), end_of_group_by_(true) {}
 Coprocessor::~Coprocessor() { Close(); }
 
@@ -189,7 +194,14 @@ butil::Status Coprocessor::Open(const std::any& coprocessor) {
   }
   enable_expression_ = !coprocessor_.expression().empty();
 
-  DINGO_LOG(DEBUG) << fmt::format("Coprocessor::Open enable_expression_ : {}", enable_expression_);
+  filter_column_flags_.clear();
+  if (enable_expression_ && FLAGS_enable_coprocessor_late_materialization) {
+    ExprBytecode::CollectFilterColumns(coprocessor_.expression(), selection_column_indexes_.size(),
+                                       filter_column_flags_);
+  }
+
+  DINGO_LOG(DEBUG) << fmt::format("Coprocessor::Open enable_expression_ : {} late materialization : {}",
+                                  enable_expression_, !filter_column_flags_.empty());
 
   DINGO_LOG(DEBUG) << fmt::format("Coprocessor::Open Leave");
 
@@ -261,6 +273,41 @@ butil::Status Coprocessor::Filter(const pb::common::VectorScalardata& scalar_dat
   return RawCoprocessor::Filter(scalar_data, is_reserved);
 }
 
+butil::Status Coprocessor::Aggregate(IteratorPtr iter) {
+  if (!end_of_group_by_) {
+    return butil::Status(pb::error::EILLEGAL_PARAMTETERS, "Coprocessor::Aggregate not aggregation");
+  }
+
+  butil::Status status;
+  while (iter->Valid()) {
+    pb::common::KeyValue kv;
+    *kv.mutable_key() = iter->Key();
+    *kv.mutable_value() = iter->Value();
+    bool has_result_kv = false;
+    pb::common::KeyValue result_key_value;
+    status = DoExecute(kv, &has_result_kv, &result_key_value);
+    if (!status.ok()) {
+      DINGO_LOG(ERROR) << fmt::format("Coprocessor::Aggregate failed");
+      return status;
+    }
+    iter->Next();
+  }
+
+  return butil::Status();
+}
+
+butil::Status Coprocessor::MergeAggregation(const Coprocessor& other) {
+  if (!other.aggregation_manager_) {
+    return butil::Status();
+  }
+  if (!aggregation_manager_) {
+    aggregation_manager_ = other.aggregation_manager_;
+    return butil::Status();
+  }
+
+  return aggregation_manager_->Merge(*other.aggregation_manager_);
+}
+
 butil::Status Coprocessor::DoExecute(const pb::common::KeyValue& kv, bool* has_result_kv,
                                      pb::common::KeyValue* result_kv) {
   butil::Status status;
@@ -285,7 +332,13 @@ butil::Status Coprocessor::DoExecute(const pb::common::KeyValue& kv, bool* has_r
   int ret = 0;
   try {
     // decode some column. not decode all
-    ret = original_record_decoder.Decode(kv, selection_column_indexes_, original_record);
+    if (filter_column_flags_.empty()) {
+      ret = original_record_decoder.Decode(kv, selection_column_indexes_, original_record);
+    } else {
+      // only the columns of the expression, the others are decoded after the row passed.
+      ret = original_record_decoder.DecodePart(kv.key(), kv.value(), selection_column_indexes_, filter_column_flags_,
+                                               record_decode_cursor_, original_record);
+    }
   } catch (const std::exception& my_exception) {
     std::string error_message = fmt::format("serial::Decode failed exception : {}", my_exception.what());
     DINGO_LOG(ERROR) << error_message;
@@ -341,6 +394,22 @@ butil::Status Coprocessor::DoExecute(const pb::common::KeyValue& kv, bool* has_r
     return butil::Status();
   }
 
+  if (!filter_column_flags_.empty()) {
+    try {
+      ret = original_record_decoder.DecodeRest(filter_column_flags_, record_decode_cursor_, original_record);
+    } catch (const std::exception& my_exception) {
+      std::string error_message = fmt::format("serial::DecodeRest failed exception : {}", my_exception.what());
+      DINGO_LOG(ERROR) << error_message;
+      return butil::Status(pb::error::EILLEGAL_PARAMTETERS, error_message);
+    }
+
+    if (ret < 0) {
+      std::string error_message = fmt::format("serial::DecodeRest failed");
+      DINGO_LOG(ERROR) << error_message;
+      return butil::Status(pb::error::EILLEGAL_PARAMTETERS, error_message);
+    }
+  }
+
   if (end_of_group_by_) {  // group by
     status = DoExecuteForAggregation(original_record);
     if (!status.ok()) {
@@ -628,6 +697,7 @@ void Coprocessor::Close() {
 
   original_column_indexes_.clear();
   selection_column_indexes_.clear();
+  filter_column_flags_.clear();
 
   if (original_serial_schemas_sorted_) {
     original_serial_schemas_sorted_.reset();
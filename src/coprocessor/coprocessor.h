@@ -56,6 +56,15 @@ class Coprocessor : public RawCoprocessor {
 
   void Close() override;
 
+  // All rows are aggregated before any output, so a range can be aggregated by parts and merged.
+  bool IsAggregation() const { return end_of_group_by_; }
+
+  // Aggregate all rows of iter without output, e.g. the partial aggregation of a sub range.
+  butil::Status Aggregate(IteratorPtr iter);
+
+  // Merge the partial aggregation of other, which is opened with the same coprocessor.
+  butil::Status MergeAggregation(const Coprocessor& other);
+
  private:
   butil::Status DoExecute(const pb::common::KeyValue& kv, bool* has_result_kv, pb::common::KeyValue* result_kv);
 
@@ -89,6 +98,10 @@ class Coprocessor : public RawCoprocessor {
   std::shared_ptr<AggregationIterator> aggregation_iterator_;
   std::vector<int> original_column_indexes_;
   std::vector<int> selection_column_indexes_;
+  // Late materialization, array index = selection column index ; value = referenced by the expression.
+  // Empty means decode all selection columns before the expression.
+  std::vector<bool> filter_column_flags_;
+  RecordDecodeCursor record_decode_cursor_;
 
   std::shared_ptr<std::vector<std::shared_ptr<BaseSchema>>> original_serial_schemas_sorted_;
   std::shared_ptr<std::vector<std::shared_ptr<BaseSchema>>> selection_serial_schemas_sorted_;
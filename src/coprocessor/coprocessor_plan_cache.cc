@@ -0,0 +1,99 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "coprocessor/coprocessor_plan_cache.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+
+#include "bthread/mutex.h"
+#include "bvar/reducer.h"
+#include "gflags/gflags.h"
+
+namespace dingodb {
+
+DEFINE_int64(coprocessor_plan_cache_capacity, 1024, "max coprocessor plan cached, 0 means disable the cache");
+
+bvar::Adder<int64_t> g_coprocessor_plan_cache_hit("dingo_coprocessor_plan_cache_hit");
+bvar::Adder<int64_t> g_coprocessor_plan_cache_miss("dingo_coprocessor_plan_cache_miss");
+
+CoprocessorPlanCache::CoprocessorPlanCache() { bthread_mutex_init(&mutex_, nullptr); }
+
+CoprocessorPlanCache::~CoprocessorPlanCache() { bthread_mutex_destroy(&mutex_); }
+
+CoprocessorPlanCache& CoprocessorPlanCache::GetInstance() {
+  static CoprocessorPlanCache cache;
+  return cache;
+}
+
+CoprocessorV2PlanPtr CoprocessorPlanCache::Get(const std::string& key) {
+  if (FLAGS_coprocessor_plan_cache_capacity <= 0) {
+    return nullptr;
+  }
+
+  uint64_t hash = std::hash<std::string>()(key);
+
+  BAIDU_SCOPED_LOCK(mutex_);
+  auto it = index_.find(hash);
+  if (it == index_.end() || it->second->key != key) {
+    g_coprocessor_plan_cache_miss << 1;
+    return nullptr;
+  }
+
+  entries_.splice(entries_.begin(), entries_, it->second);
+  g_coprocessor_plan_cache_hit << 1;
+  return it->second->plan;
+}
+
+void CoprocessorPlanCache::Put(const std::string& key, CoprocessorV2PlanPtr plan) {
+  int64_t capacity = FLAGS_coprocessor_plan_cache_capacity;
+  if (capacity <= 0 || plan == nullptr) {
+    return;
+  }
+
+  uint64_t hash = std::hash<std::string>()(key);
+
+  BAIDU_SCOPED_LOCK(mutex_);
+  auto it = index_.find(hash);
+  if (it != index_.end()) {
+    // Same plan put by the concurrent request, or a hash collision replace the old one.
+    it->second->key = key;
+    it->second->plan = std::move(plan);
+    entries_.splice(entries_.begin(), entries_, it->second);
+  } else {
+    entries_.push_front(Entry{hash, key, std::move(plan)});
+    index_[hash] = entries_.begin();
+  }
+
+  while (static_cast<int64_t>(entries_.size()) > capacity) {
+    index_.erase(entries_.back().hash);
+    entries_.pop_back();
+  }
+}
+
+size_t CoprocessorPlanCache::Size() {
+  BAIDU_SCOPED_LOCK(mutex_);
+  return entries_.size();
+}
+
+void CoprocessorPlanCache::Clear() {
+  BAIDU_SCOPED_LOCK(mutex_);
+  index_.clear();
+  entries_.clear();
+}
+
+}  // namespace dingodb
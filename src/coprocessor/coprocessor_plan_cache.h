@@ -0,0 +1,83 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGODB_COPROCESSOR_COPROCESSOR_PLAN_CACHE_H_  // NOLINT
+#define DINGODB_COPROCESSOR_COPROCESSOR_PLAN_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "bthread/types.h"
+#include "serial/record_decoder.h"
+#include "serial/record_encoder.h"
+#include "serial/schema/base_schema.h"
+
+namespace dingodb {
+
+// The prepared part of CoprocessorV2::Open, immutable after built, so it is shared by all requests of the same plan.
+struct CoprocessorV2Plan {
+  std::shared_ptr<std::vector<std::shared_ptr<BaseSchema>>> original_serial_schemas;
+  std::vector<int> original_column_indexes;
+  std::vector<int> selection_column_indexes;
+  std::shared_ptr<std::vector<std::shared_ptr<BaseSchema>>> result_serial_schemas;
+  std::vector<int> result_column_indexes;
+  // The selection columns referenced by a pure filter rel expr, empty if late materialization is not applicable.
+  std::vector<bool> filter_column_flags;
+  std::shared_ptr<RecordDecoder> original_record_decoder;
+  std::shared_ptr<RecordEncoder> result_record_encoder;
+};
+
+using CoprocessorV2PlanPtr = std::shared_ptr<const CoprocessorV2Plan>;
+
+// Store-wide LRU cache of the prepared coprocessor plans, keyed by the hash of the serialized coprocessor.
+// The serialized coprocessor is kept to verify the hit, so a hash collision is only a miss.
+class CoprocessorPlanCache {
+ public:
+  static CoprocessorPlanCache& GetInstance();
+
+  CoprocessorPlanCache(const CoprocessorPlanCache& rhs) = delete;
+  CoprocessorPlanCache& operator=(const CoprocessorPlanCache& rhs) = delete;
+
+  // Return nullptr if miss, key is the serialized coprocessor.
+  CoprocessorV2PlanPtr Get(const std::string& key);
+  // Evict the least recently used plans over capacity, capacity 0 means disable the cache.
+  void Put(const std::string& key, CoprocessorV2PlanPtr plan);
+
+  size_t Size();
+  void Clear();
+
+ private:
+  CoprocessorPlanCache();
+  ~CoprocessorPlanCache();
+
+  struct Entry {
+    uint64_t hash;
+    std::string key;
+    CoprocessorV2PlanPtr plan;
+  };
+
+  bthread_mutex_t mutex_;
+  // The front is the most recently used.
+  std::list<Entry> entries_;
+  std::unordered_map<uint64_t, std::list<Entry>::iterator> index_;
+};
+
+}  // namespace dingodb
+
+#endif  // DINGODB_COPROCESSOR_COPROCESSOR_PLAN_CACHE_H_  // NOLINT
@@ -22,13 +22,18 @@
 #include <limits>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
 #include "common/logging.h"
+#include "coprocessor/coprocessor_plan_cache.h"
+#include "coprocessor/expr_bytecode.h"
 #include "coprocessor/rel_expr_helper.h"
+#include "coprocessor/top_n.h"
 #include "coprocessor/utils.h"
 #include "fmt/core.h"
+#include "gflags/gflags.h"
 #include "proto/error.pb.h"
 #include "proto/store.pb.h"
 #include "scan/scan_filter.h"
@@ -39,6 +44,9 @@ namespace dingodb {
 
 DECLARE_int64(max_scan_memory_size);
 DECLARE_int64(max_scan_line_limit);
+DECLARE_bool(enable_coprocessor_late_materialization);
+
+DEFINE_int64(coprocessor_v2_batch_size, 256, "coprocessor v2 execute batch size, 0 or 1 means execute row by row");
 
 CoprocessorV2::CoprocessorV2() = default;
 CoprocessorV2::~CoprocessorV2() { Close(); }
@@ -65,6 +73,86 @@ butil::Status CoprocessorV2::Open(const std::any& coprocessor) {
     return butil::Status(pb::error::EILLEGAL_PARAMTETERS, error_message);
   }
 
+  // The same coprocessor is sent again and again, reuse the prepared schemas, column indexes, decoder and encoder.
+  std::string plan_key = coprocessor_.SerializeAsString();
+  auto plan = CoprocessorPlanCache::GetInstance().Get(plan_key);
+  std::vector<bool> filter_column_flags;
+  if (plan != nullptr) {
+    original_serial_schemas_ = plan->original_serial_schemas;
+    original_column_indexes_ = plan->original_column_indexes;
+    selection_column_indexes_ = plan->selection_column_indexes;
+    result_serial_schemas_ = plan->result_serial_schemas;
+    result_column_indexes_ = plan->result_column_indexes;
+    filter_column_flags = plan->filter_column_flags;
+    original_record_decoder_ = plan->original_record_decoder;
+    result_record_encoder_ = plan->result_record_encoder;
+  } else {
+    status = PreparePlan();
+    if (!status.ok()) {
+      return status;
+    }
+
+    // Only a pure filter outputs the input tuple, so the other columns can be decoded after the row passed.
+    std::string_view rel_expr = coprocessor_.rel_expr();
+    if (!rel_expr.empty() && static_cast<uint8_t>(rel_expr[0]) == ExprBytecode::kRelFilter) {
+      ExprBytecode::CollectFilterColumns(rel_expr.substr(1), selection_column_indexes_.size(), filter_column_flags);
+    }
+
+    auto new_plan = std::make_shared<CoprocessorV2Plan>();
+    new_plan->original_serial_schemas = original_serial_schemas_;
+    new_plan->original_column_indexes = original_column_indexes_;
+    new_plan->selection_column_indexes = selection_column_indexes_;
+    new_plan->result_serial_schemas = result_serial_schemas_;
+    new_plan->result_column_indexes = result_column_indexes_;
+    new_plan->filter_column_flags = filter_column_flags;
+    new_plan->original_record_decoder = original_record_decoder_;
+    new_plan->result_record_encoder = result_record_encoder_;
+    CoprocessorPlanCache::GetInstance().Put(plan_key, new_plan);
+  }
+
+  filter_column_flags_.clear();
+  if (FLAGS_enable_coprocessor_late_materialization) {
+    filter_column_flags_ = std::move(filter_column_flags);
+  }
+
+  if (coprocessor_.top_n() > 0 && !coprocessor_.sort_columns().empty()) {
+    if (coprocessor_.top_n() > FLAGS_max_scan_line_limit) {
+      std::string error_message =
+          fmt::format("top_n : {} exceed max_scan_line_limit : {}", coprocessor_.top_n(), FLAGS_max_scan_line_limit);
+      DINGO_LOG(ERROR) << error_message;
+      return butil::Status(pb::error::EILLEGAL_PARAMTETERS, error_message);
+    }
+
+    top_n_ = std::make_shared<TopN>();
+    status = top_n_->Open(result_serial_schemas_, result_column_indexes_, coprocessor_.sort_columns(),
+                          coprocessor_.top_n());
+    if (!status.ok()) {
+      return status;
+    }
+  }
+
+  // RelRunner keeps the state of the request, decode a new one every time.
+#if defined(TEST_COPROCESSOR_V2_MOCK)
+  rel_runner_ = std::make_shared<rel::mock::RelRunner>();
+#else
+  rel_runner_ = std::make_shared<rel::RelRunner>();
+#endif
+
+  try {
+    rel_runner_->Decode(reinterpret_cast<const expr::Byte*>(coprocessor_.rel_expr().c_str()),
+                        coprocessor_.rel_expr().length());
+  } catch (const std::exception& my_exception) {
+    std::string error_message = fmt::format("rel::RelRunner Decode failed. exception : {}", my_exception.what());
+    DINGO_LOG(ERROR) << error_message;
+    return butil::Status(pb::error::EILLEGAL_PARAMTETERS, error_message);
+  }
+
+  return status;
+}
+
+butil::Status CoprocessorV2::PreparePlan() {
+  butil::Status status;
+
   Utils::DebugCoprocessorV2(coprocessor_);
 
   status = Utils::CheckPbSchema(coprocessor_.original_schema().schema());
@@ -131,26 +219,15 @@ butil::Status CoprocessorV2::Open(const std::any& coprocessor) {
   result_record_encoder_ = std::make_shared<RecordEncoder>(coprocessor_.schema_version(), result_serial_schemas_,
                                                            coprocessor_.result_schema().common_id());
 
-#if defined(TEST_COPROCESSOR_V2_MOCK)
-  rel_runner_ = std::make_shared<rel::mock::RelRunner>();
-#else
-  rel_runner_ = std::make_shared<rel::RelRunner>();
-#endif
-
-  try {
-    rel_runner_->Decode(reinterpret_cast<const expr::Byte*>(coprocessor_.rel_expr().c_str()),
-                        coprocessor_.rel_expr().length());
-  } catch (const std::exception& my_exception) {
-    std::string error_message = fmt::format("rel::RelRunner Decode failed. exception : {}", my_exception.what());
-    DINGO_LOG(ERROR) << error_message;
-    return butil::Status(pb::error::EILLEGAL_PARAMTETERS, error_message);
-  }
-
   return status;
 }
 
 butil::Status CoprocessorV2::Execute(IteratorPtr iter, bool key_only, size_t max_fetch_cnt, int64_t max_bytes_rpc,
                                      std::vector<pb::common::KeyValue>* kvs, bool& has_more) {
+  if (FLAGS_coprocessor_v2_batch_size > 1) {
+    return ExecuteBatch(iter, key_only, max_fetch_cnt, max_bytes_rpc, kvs, has_more);
+  }
+
   DINGO_LOG(DEBUG) << fmt::format("CoprocessorV2::Execute IteratorPtr Enter");
   ScanFilter scan_filter = ScanFilter(false, max_fetch_cnt, max_bytes_rpc);
   butil::Status status;
@@ -190,6 +267,9 @@ butil::Status CoprocessorV2::Execute(IteratorPtr iter, bool key_only, size_t max
   }
 
   status = GetKvFromExprEndOfFinish(key_only, max_fetch_cnt, max_bytes_rpc, kvs);
+  if (status.ok() && !has_more) {
+    status = GetKvFromTopN(key_only, kvs);
+  }
 
   DINGO_LOG(DEBUG) << fmt::format("CoprocessorV2::Execute IteratorPtr Leave");
 
@@ -199,6 +279,10 @@ butil::Status CoprocessorV2::Execute(IteratorPtr iter, bool key_only, size_t max
 butil::Status CoprocessorV2::Execute(TxnIteratorPtr iter, int64_t limit, bool key_only, bool /*is_reverse*/,
                                      pb::store::TxnResultInfo& txn_result_info, std::vector<pb::common::KeyValue>& kvs,
                                      bool& has_more, std::string& end_key) {
+  if (FLAGS_coprocessor_v2_batch_size > 1) {
+    return ExecuteBatch(iter, limit, key_only, txn_result_info, kvs, has_more, end_key);
+  }
+
   DINGO_LOG(DEBUG) << fmt::format("CoprocessorV2::Execute  TxnIteratorPtr Enter");
 
   butil::Status status;
@@ -244,12 +328,120 @@ butil::Status CoprocessorV2::Execute(TxnIteratorPtr iter, int64_t limit, bool ke
   }
 
   status = GetKvFromExprEndOfFinish(key_only, limit, FLAGS_max_scan_memory_size, &kvs);
+  if (status.ok()) {
+    // The txn coprocessor is closed after every request, the scanned part has its own top n.
+    status = GetKvFromTopN(key_only, &kvs);
+  }
 
   DINGO_LOG(DEBUG) << fmt::format("CoprocessorV2::Execute TxnIteratorPtr Leave");
 
   return status;
 }
 
+butil::Status CoprocessorV2::ExecuteBatch(IteratorPtr iter, bool key_only, size_t max_fetch_cnt,
+                                          int64_t max_bytes_rpc, std::vector<pb::common::KeyValue>* kvs,
+                                          bool& has_more) {
+  DINGO_LOG(DEBUG) << fmt::format("CoprocessorV2::ExecuteBatch IteratorPtr Enter");
+  ScanFilter scan_filter = ScanFilter(false, max_fetch_cnt, max_bytes_rpc);
+  butil::Status status;
+  has_more = false;
+  size_t batch_size = FLAGS_coprocessor_v2_batch_size;
+  if (batch_kvs_.size() < batch_size) {
+    batch_kvs_.resize(batch_size);
+  }
+
+  while (!has_more && iter->Valid()) {
+    size_t count = 0;
+    for (; count < batch_size && iter->Valid(); ++count) {
+      auto& kv = batch_kvs_[count];
+      kv.mutable_key()->assign(iter->Key());
+      kv.mutable_value()->assign(iter->Value());
+      iter->Next();
+
+      if (scan_filter.UptoLimit(kv)) {
+        has_more = true;
+        DINGO_LOG(WARNING) << fmt::format(
+            "CoprocessorV2 UptoLimit. key_only : {} max_fetch_cnt : {} max_bytes_rpc : {} cur_fetch_cnt : {} "
+            "cur_bytes_rpc : {}",
+            key_only, max_fetch_cnt, max_bytes_rpc, scan_filter.GetCurFetchCnt(), scan_filter.GetCurBytesRpc());
+        ++count;
+        break;
+      }
+    }
+
+    status = DoExecuteBatch(count, key_only, kvs);
+    if (!status.ok()) {
+      DINGO_LOG(ERROR) << fmt::format("CoprocessorV2::ExecuteBatch failed");
+      return status;
+    }
+  }
+
+  status = GetKvFromExprEndOfFinish(key_only, max_fetch_cnt, max_bytes_rpc, kvs);
+  if (status.ok() && !has_more) {
+    status = GetKvFromTopN(key_only, kvs);
+  }
+
+  DINGO_LOG(DEBUG) << fmt::format("CoprocessorV2::ExecuteBatch IteratorPtr Leave");
+
+  return status;
+}
+
+butil::Status CoprocessorV2::ExecuteBatch(TxnIteratorPtr iter, int64_t limit, bool key_only,
+                                          pb::store::TxnResultInfo& txn_result_info,
+                                          std::vector<pb::common::KeyValue>& kvs, bool& has_more,
+                                          std::string& end_key) {
+  DINGO_LOG(DEBUG) << fmt::format("CoprocessorV2::ExecuteBatch TxnIteratorPtr Enter");
+
+  butil::Status status;
+
+  ScanFilter scan_filter =
+      ScanFilter(false, std::min(limit, FLAGS_max_scan_line_limit), std::numeric_limits<int64_t>::max());
+  size_t batch_size = FLAGS_coprocessor_v2_batch_size;
+  if (batch_kvs_.size() < batch_size) {
+    batch_kvs_.resize(batch_size);
+  }
+
+  bool is_limit = false;
+  while (!is_limit && iter->Valid(txn_result_info)) {
+    size_t count = 0;
+    for (; count < batch_size && iter->Valid(txn_result_info); ++count) {
+      auto& kv = batch_kvs_[count];
+      *kv.mutable_key() = iter->Key();
+      *kv.mutable_value() = iter->Value();
+      end_key = kv.key();
+      iter->Next();
+
+      if (scan_filter.UptoLimit(kv)) {
+        is_limit = true;
+        has_more = true;
+        DINGO_LOG(WARNING) << fmt::format(
+            "CoprocessorV2 UptoLimit. key_only : {} max_fetch_cnt : {} max_bytes_rpc : {} cur_fetch_cnt : {} "
+            "cur_bytes_rpc : {}",
+            key_only, std::min(limit, FLAGS_max_scan_line_limit), std::numeric_limits<int64_t>::max(),
+            scan_filter.GetCurFetchCnt(), scan_filter.GetCurBytesRpc());
+        ++count;
+        break;
+      }
+    }
+
+    status = DoExecuteBatch(count, key_only, &kvs);
+    if (!status.ok()) {
+      DINGO_LOG(ERROR) << fmt::format("CoprocessorV2::ExecuteBatch failed");
+      return status;
+    }
+  }
+
+  status = GetKvFromExprEndOfFinish(key_only, limit, FLAGS_max_scan_memory_size, &kvs);
+  if (status.ok()) {
+    // The txn coprocessor is closed after every request, the scanned part has its own top n.
+    status = GetKvFromTopN(key_only, &kvs);
+  }
+
+  DINGO_LOG(DEBUG) << fmt::format("CoprocessorV2::ExecuteBatch TxnIteratorPtr Leave");
+
+  return status;
+}
+
 butil::Status CoprocessorV2::Filter(const std::string& key, const std::string& value, bool& is_reserved) {
   return DoFilter(key, value, &is_reserved);
 }
@@ -263,10 +455,16 @@ void CoprocessorV2::Close() {
   original_serial_schemas_.reset();
   original_column_indexes_.clear();
   selection_column_indexes_.clear();
+  filter_column_flags_.clear();
   result_serial_schemas_.reset();
   result_record_encoder_.reset();
   original_record_decoder_.reset();
   result_column_indexes_.clear();
+  batch_kvs_.clear();
+  batch_records_.clear();
+  batch_decode_cursors_.clear();
+  batch_result_records_.clear();
+  top_n_.reset();
   rel_runner_.reset();
 }
 
@@ -295,6 +493,12 @@ butil::Status CoprocessorV2::DoExecute(const std::string& key, const std::string
     return status;
   }
 
+  if (top_n_ != nullptr) {
+    top_n_->Put(std::move(result_record));
+    *has_result_kv = false;
+    return butil::Status();
+  }
+
   status = GetKvFromExpr(result_record, has_result_kv, result_kv);
   if (!status.ok()) {
     DINGO_LOG(ERROR) << status.error_cstr();
@@ -304,6 +508,145 @@ butil::Status CoprocessorV2::DoExecute(const std::string& key, const std::string
   return status;
 }
 
+butil::Status CoprocessorV2::DoExecuteBatch(size_t count, bool key_only, std::vector<pb::common::KeyValue>* kvs) {
+  butil::Status status;
+  if (count == 0) {
+    return status;
+  }
+
+  // Late materialization, the filter columns of the whole batch first, the others only for the passed rows.
+  bool is_late_materialization = !filter_column_flags_.empty();
+  if (batch_records_.size() < count) {
+    batch_records_.resize(count);
+  }
+  if (is_late_materialization && batch_decode_cursors_.size() < count) {
+    batch_decode_cursors_.resize(count);
+  }
+
+  for (size_t i = 0; i < count; ++i) {
+    int ret = 0;
+    try {
+      // decode some column. not decode all
+      if (is_late_materialization) {
+        ret = original_record_decoder_->DecodePart(batch_kvs_[i].key(), batch_kvs_[i].value(),
+                                                   selection_column_indexes_, filter_column_flags_,
+                                                   batch_decode_cursors_[i], batch_records_[i]);
+      } else {
+        ret = original_record_decoder_->Decode(batch_kvs_[i].key(), batch_kvs_[i].value(), selection_column_indexes_,
+                                               batch_records_[i]);
+      }
+    } catch (const std::exception& my_exception) {
+      std::string error_message = fmt::format("serial::Decode failed exception : {}", my_exception.what());
+      DINGO_LOG(ERROR) << error_message;
+      return butil::Status(pb::error::EILLEGAL_PARAMTETERS, error_message);
+    }
+
+    if (ret < 0) {
+      std::string error_message = fmt::format("serial::Decode failed");
+      DINGO_LOG(ERROR) << error_message;
+      return butil::Status(pb::error::EILLEGAL_PARAMTETERS, error_message);
+    }
+  }
+
+  std::vector<std::unique_ptr<std::vector<expr::Operand>>> operand_ptrs;
+  status = RelExprHelper::TransToOperandBatch(original_serial_schemas_, selection_column_indexes_, batch_records_,
+                                              count, operand_ptrs);
+  if (!status.ok()) {
+    DINGO_LOG(ERROR) << status.error_cstr();
+    return status;
+  }
+
+  // The rel expr is evaluated tuple by tuple, only the selected rows have result tuple.
+  std::vector<std::unique_ptr<std::vector<expr::Operand>>> result_operand_ptrs;
+  result_operand_ptrs.reserve(count);
+  std::vector<size_t> passed_rows;
+  try {
+    for (size_t i = 0; i < count; ++i) {
+      const expr::Tuple* result_tuple = rel_runner_->Put(operand_ptrs[i].release());
+      if (result_tuple != nullptr) {
+        result_operand_ptrs.emplace_back(const_cast<expr::Tuple*>(result_tuple));
+        passed_rows.push_back(i);
+      }
+    }
+  } catch (const std::exception& my_exception) {
+    std::string error_message = fmt::format("rel::RelRunner Put failed. exception : {}", my_exception.what());
+    DINGO_LOG(ERROR) << error_message;
+    return butil::Status(pb::error::EILLEGAL_PARAMTETERS, error_message);
+  }
+
+  if (result_operand_ptrs.empty()) {
+    return status;
+  }
+
+  // The filter passed the input tuples, rebuild them with all of the columns.
+  if (is_late_materialization) {
+    for (size_t j = 0; j < passed_rows.size(); ++j) {
+      size_t i = passed_rows[j];
+      int ret = 0;
+      try {
+        ret = original_record_decoder_->DecodeRest(filter_column_flags_, batch_decode_cursors_[i], batch_records_[i]);
+      } catch (const std::exception& my_exception) {
+        std::string error_message = fmt::format("serial::DecodeRest failed exception : {}", my_exception.what());
+        DINGO_LOG(ERROR) << error_message;
+        return butil::Status(pb::error::EILLEGAL_PARAMTETERS, error_message);
+      }
+
+      if (ret < 0) {
+        std::string error_message = fmt::format("serial::DecodeRest failed");
+        DINGO_LOG(ERROR) << error_message;
+        return butil::Status(pb::error::EILLEGAL_PARAMTETERS, error_message);
+      }
+
+      // Move the passed records to the front, j <= i.
+      if (i != j) {
+        std::swap(batch_records_[i], batch_records_[j]);
+      }
+    }
+
+    status = RelExprHelper::TransToOperandBatch(original_serial_schemas_, selection_column_indexes_, batch_records_,
+                                                passed_rows.size(), result_operand_ptrs);
+    if (!status.ok()) {
+      DINGO_LOG(ERROR) << status.error_cstr();
+      return status;
+    }
+  }
+
+  status = RelExprHelper::TransFromOperandBatch(result_operand_ptrs, result_serial_schemas_, result_column_indexes_,
+                                                batch_result_records_);
+  if (!status.ok()) {
+    DINGO_LOG(ERROR) << status.error_cstr();
+    return status;
+  }
+
+  if (top_n_ != nullptr) {
+    for (size_t i = 0; i < result_operand_ptrs.size(); ++i) {
+      top_n_->Put(std::move(batch_result_records_[i]));
+    }
+    return status;
+  }
+
+  kvs->reserve(kvs->size() + result_operand_ptrs.size());
+  for (size_t i = 0; i < result_operand_ptrs.size(); ++i) {
+    bool has_result_kv = false;
+    pb::common::KeyValue result_kv;
+    status = GetKvFromExpr(batch_result_records_[i], &has_result_kv, &result_kv);
+    if (!status.ok()) {
+      DINGO_LOG(ERROR) << status.error_cstr();
+      return status;
+    }
+
+    if (has_result_kv) {
+      if (key_only) {
+        result_kv.set_value("");
+      }
+
+      kvs->emplace_back(std::move(result_kv));
+    }
+  }
+
+  return status;
+}
+
 butil::Status CoprocessorV2::DoFilter(const std::string& key, const std::string& value, bool* is_reserved) {
   butil::Status status;
 
@@ -364,7 +707,13 @@ butil::Status CoprocessorV2::DoRelExprCoreWrapper(const std::string& key, const
   int ret = 0;
   try {
     // decode some column. not decode all
-    ret = original_record_decoder_->Decode(key, value, selection_column_indexes_, original_record);
+    if (filter_column_flags_.empty()) {
+      ret = original_record_decoder_->Decode(key, value, selection_column_indexes_, original_record);
+    } else {
+      // only the columns of the filter, the others are decoded after the row passed.
+      ret = original_record_decoder_->DecodePart(key, value, selection_column_indexes_, filter_column_flags_,
+                                                 record_decode_cursor_, original_record);
+    }
   } catch (const std::exception& my_exception) {
     std::string error_message = fmt::format("serial::Decode failed exception : {}", my_exception.what());
     DINGO_LOG(ERROR) << error_message;
@@ -377,7 +726,33 @@ butil::Status CoprocessorV2::DoRelExprCoreWrapper(const std::string& key, const
     return butil::Status(pb::error::EILLEGAL_PARAMTETERS, error_message);
   }
 
-  return DoRelExprCore(original_record, result_operand_ptr);
+  status = DoRelExprCore(original_record, result_operand_ptr);
+  if (!status.ok() || filter_column_flags_.empty() || !result_operand_ptr) {
+    return status;
+  }
+
+  try {
+    ret = original_record_decoder_->DecodeRest(filter_column_flags_, record_decode_cursor_, original_record);
+  } catch (const std::exception& my_exception) {
+    std::string error_message = fmt::format("serial::DecodeRest failed exception : {}", my_exception.what());
+    DINGO_LOG(ERROR) << error_message;
+    return butil::Status(pb::error::EILLEGAL_PARAMTETERS, error_message);
+  }
+
+  if (ret < 0) {
+    std::string error_message = fmt::format("serial::DecodeRest failed");
+    DINGO_LOG(ERROR) << error_message;
+    return butil::Status(pb::error::EILLEGAL_PARAMTETERS, error_message);
+  }
+
+  // The filter passed the input tuple, rebuild it with all of the columns.
+  result_operand_ptr = std::make_unique<std::vector<expr::Operand>>();
+  status = RelExprHelper::TransToOperandWrapper(original_serial_schemas_, selection_column_indexes_, original_record,
+                                                result_operand_ptr);
+  if (!status.ok()) {
+    DINGO_LOG(ERROR) << status.error_cstr();
+  }
+  return status;
 }
 
 butil::Status CoprocessorV2::GetKvFromExprEndOfFinish(bool /*key_only*/, size_t /*max_fetch_cnt*/,
@@ -408,6 +783,11 @@ butil::Status CoprocessorV2::GetKvFromExprEndOfFinish(bool /*key_only*/, size_t
       return status;
     }
 
+    if (top_n_ != nullptr) {
+      top_n_->Put(std::move(result_record));
+      continue;
+    }
+
     bool has_result_kv = false;
     pb::common::KeyValue result_kv;
 
@@ -425,6 +805,34 @@ butil::Status CoprocessorV2::GetKvFromExprEndOfFinish(bool /*key_only*/, size_t
   return status;
 }
 
+butil::Status CoprocessorV2::GetKvFromTopN(bool key_only, std::vector<pb::common::KeyValue>* kvs) {
+  if (top_n_ == nullptr) {
+    return butil::Status();
+  }
+
+  auto records = top_n_->Take();
+  kvs->reserve(kvs->size() + records.size());
+  for (const auto& record : records) {
+    bool has_result_kv = false;
+    pb::common::KeyValue result_kv;
+    butil::Status status = GetKvFromExpr(record, &has_result_kv, &result_kv);
+    if (!status.ok()) {
+      DINGO_LOG(ERROR) << status.error_cstr();
+      return status;
+    }
+
+    if (has_result_kv) {
+      if (key_only) {
+        result_kv.set_value("");
+      }
+
+      kvs->emplace_back(std::move(result_kv));
+    }
+  }
+
+  return butil::Status();
+}
+
 butil::Status CoprocessorV2::GetKvFromExpr(const std::vector<std::any>& record, bool* has_result_kv,
                                            pb::common::KeyValue* result_kv) {
   butil::Status status;
@@ -24,6 +24,7 @@
 
 #include "butil/status.h"
 #include "coprocessor/raw_coprocessor.h"
+#include "coprocessor/top_n.h"
 #include "engine/iterator.h"
 #include "libexpr/src/rel/rel_runner.h"
 #include "proto/common.pb.h"
@@ -59,6 +60,9 @@ class CoprocessorV2 : public RawCoprocessor {
   void Close() override;
 
  protected:
+  // Check the schemas and build the column indexes, decoder and encoder, the result is cached by CoprocessorPlanCache.
+  butil::Status PreparePlan();
+
   butil::Status DoExecute(const std::string& key, const std::string& value, bool* has_result_kv,
                           pb::common::KeyValue* result_kv);
   butil::Status DoFilter(const std::string& key, const std::string& value, bool* is_reserved);
@@ -70,6 +74,18 @@ class CoprocessorV2 : public RawCoprocessor {
                                          std::vector<pb::common::KeyValue>* kvs);
   butil::Status GetKvFromExpr(const std::vector<std::any>& record, bool* has_result_kv,
                               pb::common::KeyValue* result_kv);
+  // Output the kept rows of top n in order, the rows are only kept but not output before that.
+  butil::Status GetKvFromTopN(bool key_only, std::vector<pb::common::KeyValue>* kvs);
+
+  // Batch execution, pull batch_size kvs from the iterator and execute them at once.
+  butil::Status ExecuteBatch(IteratorPtr iter, bool key_only, size_t max_fetch_cnt, int64_t max_bytes_rpc,
+                             std::vector<pb::common::KeyValue>* kvs, bool& has_more);  // NOLINT
+  butil::Status ExecuteBatch(TxnIteratorPtr iter, int64_t limit, bool key_only,
+                             pb::store::TxnResultInfo& txn_result_info,  // NOLINT
+                             std::vector<pb::common::KeyValue>& kvs,     // NOLINT
+                             bool& has_more, std::string& end_key);      // NOLINT
+  // Decode the first count kvs of batch_kvs_ and put them to rel expr, encode only the selected result rows.
+  butil::Status DoExecuteBatch(size_t count, bool key_only, std::vector<pb::common::KeyValue>* kvs);
 
   void GetOriginalColumnIndexes();
   void GetSelectionColumnIndexes();
@@ -90,6 +106,19 @@ class CoprocessorV2 : public RawCoprocessor {
   std::shared_ptr<RecordDecoder> original_record_decoder_;                           // NOLINT
   // array index =  result schema member index field ; value = result schema array index
   std::vector<int> result_column_indexes_;  // NOLINT
+  // Late materialization, array index = selection column index ; value = referenced by the filter.
+  // Empty means decode all selection columns before the rel expr.
+  std::vector<bool> filter_column_flags_;     // NOLINT
+  RecordDecodeCursor record_decode_cursor_;  // NOLINT
+
+  // batch execution buffers, reused between batches to avoid reallocation.
+  std::vector<pb::common::KeyValue> batch_kvs_;               // NOLINT
+  std::vector<std::vector<std::any>> batch_records_;         // NOLINT
+  std::vector<RecordDecodeCursor> batch_decode_cursors_;     // NOLINT
+  std::vector<std::vector<std::any>> batch_result_records_;  // NOLINT
+
+  // ORDER BY ... LIMIT pushed down, nullptr if not.
+  std::shared_ptr<TopN> top_n_;  // NOLINT
 
 #if defined(TEST_COPROCESSOR_V2_MOCK)
   std::shared_ptr<rel::mock::RelRunner> rel_runner_;  // NOLINT
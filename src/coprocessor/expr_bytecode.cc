@@ -0,0 +1,115 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "coprocessor/expr_bytecode.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace dingodb {
+
+static bool ReadVarint(std::string_view expression, size_t& pos, uint64_t& value) {
+  value = 0;
+  for (int shift = 0; shift < 64 && pos < expression.size(); shift += 7) {
+    auto b = static_cast<uint8_t>(expression[pos++]);
+    value |= static_cast<uint64_t>(b & 0x7F) << shift;
+    if ((b & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool SkipConst(std::string_view expression, uint8_t type, bool negative, size_t& pos) {
+  uint64_t value = 0;
+  switch (type) {
+    case ExprBytecode::kTypeInt32:
+    case ExprBytecode::kTypeInt64:
+      return ReadVarint(expression, pos, value);
+    case ExprBytecode::kTypeBool:
+      return true;
+    case ExprBytecode::kTypeFloat:
+      pos += 4;
+      return pos <= expression.size();
+    case ExprBytecode::kTypeDouble:
+      pos += 8;
+      return pos <= expression.size();
+    case ExprBytecode::kTypeString:
+      if (negative || !ReadVarint(expression, pos, value) || value > expression.size() - pos) {
+        return false;
+      }
+      pos += value;
+      return true;
+    default:
+      return false;
+  }
+}
+
+size_t ExprBytecode::CollectVars(std::string_view expression, size_t tuple_size, std::vector<bool>& var_used) {
+  var_used.assign(tuple_size, false);
+
+  size_t pos = 0;
+  while (pos < expression.size()) {
+    auto code = static_cast<uint8_t>(expression[pos++]);
+    if (code == kEoe) {
+      return pos;
+    }
+
+    uint8_t prefix = code & 0xF0;
+    uint8_t type = code & 0x0F;
+    if (prefix == kNullPrefix) {
+      if (!IsKnownType(type)) {
+        return 0;
+      }
+    } else if (prefix == kConst || prefix == kConstN) {
+      if (!SkipConst(expression, type, prefix == kConstN, pos)) {
+        return 0;
+      }
+    } else if (prefix == kVarI) {
+      uint64_t index = 0;
+      if (!IsKnownType(type) || !ReadVarint(expression, pos, index) || index >= tuple_size) {
+        return 0;
+      }
+      var_used[index] = true;
+    } else if (code == kNot || code == kAnd || code == kOr) {
+      continue;
+    } else if (code == kPos || code == kNeg || (code >= kAdd && code <= kMod) || (code >= kEq && code <= kNe) ||
+               (code >= kIsNull && code <= kIsFalse)) {
+      if (pos >= expression.size() || !IsKnownType(static_cast<uint8_t>(expression[pos++]))) {
+        return 0;
+      }
+    } else {
+      // Unknown operator, the length of operand can not be determined.
+      return 0;
+    }
+  }
+
+  return 0;
+}
+
+bool ExprBytecode::CollectFilterColumns(std::string_view expression, size_t tuple_size,
+                                        std::vector<bool>& filter_columns) {
+  size_t length = CollectVars(expression, tuple_size, filter_columns);
+  if (length == 0 || length != expression.size() ||
+      std::all_of(filter_columns.begin(), filter_columns.end(), [](bool used) { return used; })) {
+    filter_columns.clear();
+    return false;
+  }
+  return true;
+}
+
+}  // namespace dingodb
@@ -0,0 +1,84 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGODB_COPROCESSOR_EXPR_BYTECODE_H_  // NOLINT
+#define DINGODB_COPROCESSOR_EXPR_BYTECODE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace dingodb {
+
+// The expression bytecode of libexpr, postfix order, an expression is end with kEoe.
+// Only the codes understood by the store side analysis are listed.
+class ExprBytecode {
+ public:
+  ExprBytecode() = delete;
+  ~ExprBytecode() = delete;
+
+  static constexpr uint8_t kEoe = 0x00;
+  // The high 4 bits of the code, the low 4 bits are the type.
+  static constexpr uint8_t kNullPrefix = 0x00;
+  static constexpr uint8_t kConst = 0x10;
+  static constexpr uint8_t kConstN = 0x20;
+  static constexpr uint8_t kVarI = 0x30;
+
+  static constexpr uint8_t kNot = 0x51;
+  static constexpr uint8_t kAnd = 0x52;
+  static constexpr uint8_t kOr = 0x53;
+
+  // The following operators are followed by the operand type.
+  static constexpr uint8_t kPos = 0x81;
+  static constexpr uint8_t kNeg = 0x82;
+  static constexpr uint8_t kAdd = 0x83;
+  static constexpr uint8_t kMod = 0x87;
+  static constexpr uint8_t kEq = 0x91;
+  static constexpr uint8_t kGe = 0x92;
+  static constexpr uint8_t kGt = 0x93;
+  static constexpr uint8_t kLe = 0x94;
+  static constexpr uint8_t kLt = 0x95;
+  static constexpr uint8_t kNe = 0x96;
+  static constexpr uint8_t kIsNull = 0xA1;
+  static constexpr uint8_t kIsFalse = 0xA3;
+
+  static constexpr uint8_t kTypeInt32 = 0x01;
+  static constexpr uint8_t kTypeInt64 = 0x02;
+  static constexpr uint8_t kTypeBool = 0x03;
+  static constexpr uint8_t kTypeFloat = 0x04;
+  static constexpr uint8_t kTypeDouble = 0x05;
+  static constexpr uint8_t kTypeString = 0x07;
+
+  // The rel operator filter, followed by the filter expression.
+  static constexpr uint8_t kRelFilter = 0x71;
+
+  static bool IsKnownType(uint8_t type) {
+    return type == kTypeInt32 || type == kTypeInt64 || type == kTypeBool || type == kTypeFloat ||
+           type == kTypeDouble || type == kTypeString;
+  }
+
+  // Collect the tuple variable indexes referenced by the expression, var_used is resized to tuple_size.
+  // Return the length of the expression including kEoe, or 0 if there is any code not understood or any variable
+  // out of the tuple, then the referenced variables are unknown.
+  static size_t CollectVars(std::string_view expression, size_t tuple_size, std::vector<bool>& var_used);
+
+  // For late materialization, collect the variables referenced by the whole filter expression.
+  // Return false if the filter can not be analyzed or references all of the tuple, then filter_columns is cleared.
+  static bool CollectFilterColumns(std::string_view expression, size_t tuple_size, std::vector<bool>& filter_columns);
+};
+
+}  // namespace dingodb
+
+#endif  // DINGODB_COPROCESSOR_EXPR_BYTECODE_H_  // NOLINT
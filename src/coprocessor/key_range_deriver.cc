@@ -0,0 +1,581 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "coprocessor/key_range_deriver.h"
+
+#include <any>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "bvar/reducer.h"
+#include "common/helper.h"
+#include "common/logging.h"
+#include "coprocessor/expr_bytecode.h"
+#include "coprocessor/utils.h"
+#include "fmt/core.h"
+#include "gflags/gflags.h"
+#include "serial/buf.h"
+#include "serial/schema/base_schema.h"
+#include "serial/schema/integer_schema.h"
+#include "serial/schema/long_schema.h"
+#include "serial/schema/string_schema.h"
+#include "serial/utils.h"
+
+namespace dingodb {
+
+DEFINE_bool(enable_coprocessor_key_range_derive, true, "derive the scan range from coprocessor filter on key columns");
+
+bvar::Adder<int64_t> g_coprocessor_key_range_derive_count("dingo_coprocessor_key_range_derive_count");
+
+namespace {
+
+// The encoded bound of one key column, empty optional is unbounded.
+struct ColumnBound {
+  std::optional<std::string> lower;
+  bool lower_inclusive{true};
+  std::optional<std::string> upper;
+  bool upper_inclusive{true};
+
+  void MergeLower(const std::string& value, bool inclusive) {
+    if (!lower.has_value() || lower.value() < value) {
+      lower = value;
+      lower_inclusive = inclusive;
+    } else if (lower.value() == value) {
+      lower_inclusive = lower_inclusive && inclusive;
+    }
+  }
+
+  void MergeUpper(const std::string& value, bool inclusive) {
+    if (!upper.has_value() || value < upper.value()) {
+      upper = value;
+      upper_inclusive = inclusive;
+    } else if (upper.value() == value) {
+      upper_inclusive = upper_inclusive && inclusive;
+    }
+  }
+
+  void Merge(const ColumnBound& other) {
+    if (other.lower.has_value()) {
+      MergeLower(other.lower.value(), other.lower_inclusive);
+    }
+    if (other.upper.has_value()) {
+      MergeUpper(other.upper.value(), other.upper_inclusive);
+    }
+  }
+
+  bool IsEqual() const {
+    return lower.has_value() && upper.has_value() && lower_inclusive && upper_inclusive && lower == upper;
+  }
+};
+
+// The node on the evaluation stack.
+struct Node {
+  enum Kind { kVar, kConst, kValue };
+
+  Kind kind{kValue};
+  uint8_t type{0};
+  // kVar: the tuple variable index.
+  int64_t var_index{-1};
+  // kConst: std::optional<T> of the type, no value means null constant.
+  std::any const_value;
+  // kValue: the bounds implied by the node if it is true, indexed by key column order.
+  std::map<int, ColumnBound> bounds;
+};
+
+class ExpressionAnalyzer {
+ public:
+  ExpressionAnalyzer(const std::shared_ptr<std::vector<std::shared_ptr<BaseSchema>>>& serial_schemas,
+                     const std::vector<int>& tuple_columns, const std::vector<int>& key_orders)
+      : serial_schemas_(serial_schemas), tuple_columns_(tuple_columns), key_orders_(key_orders) {}
+
+  // Return false if the expression can not be analyzed.
+  bool Analyze(std::string_view expression, std::map<int, ColumnBound>& bounds) {
+    expression_ = expression;
+    pos_ = 0;
+    stack_.clear();
+
+    while (true) {
+      uint8_t code = 0;
+      if (!ReadByte(code)) {
+        return false;
+      }
+      if (code == ExprBytecode::kEoe) {
+        break;
+      }
+      if (!Step(code)) {
+        return false;
+      }
+    }
+
+    if (stack_.size() != 1 || stack_.back().kind != Node::kValue) {
+      return false;
+    }
+
+    bounds = std::move(stack_.back().bounds);
+    return true;
+  }
+
+ private:
+  bool ReadByte(uint8_t& value) {
+    if (pos_ >= expression_.size()) {
+      return false;
+    }
+    value = static_cast<uint8_t>(expression_[pos_++]);
+    return true;
+  }
+
+  bool ReadVarint(uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      uint8_t b = 0;
+      if (!ReadByte(b)) {
+        return false;
+      }
+      value |= static_cast<uint64_t>(b & 0x7F) << shift;
+      if ((b & 0x80) == 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool Skip(size_t size) {
+    if (pos_ + size > expression_.size()) {
+      return false;
+    }
+    pos_ += size;
+    return true;
+  }
+
+  bool Pop(size_t count, std::vector<Node>& nodes) {
+    if (stack_.size() < count) {
+      return false;
+    }
+    nodes.assign(std::make_move_iterator(stack_.end() - count), std::make_move_iterator(stack_.end()));
+    stack_.resize(stack_.size() - count);
+    return true;
+  }
+
+  bool Step(uint8_t code) {
+    uint8_t prefix = code & 0xF0;
+    uint8_t type = code & 0x0F;
+
+    if (prefix == ExprBytecode::kNullPrefix) {
+      Node node;
+      node.kind = Node::kConst;
+      node.type = type;
+      stack_.push_back(std::move(node));
+      return ExprBytecode::IsKnownType(type);
+    }
+    if (prefix == ExprBytecode::kConst || prefix == ExprBytecode::kConstN) {
+      return ReadConst(type, prefix == ExprBytecode::kConstN);
+    }
+    if (prefix == ExprBytecode::kVarI) {
+      uint64_t index = 0;
+      if (!ExprBytecode::IsKnownType(type) || !ReadVarint(index) || index >= tuple_columns_.size()) {
+        return false;
+      }
+      // The variable type must be the same with the column, otherwise the bytecode is not understood.
+      if (GetTypeCode((*serial_schemas_)[tuple_columns_[index]]->GetType()) != type) {
+        return false;
+      }
+      Node node;
+      node.kind = Node::kVar;
+      node.type = type;
+      node.var_index = static_cast<int64_t>(index);
+      stack_.push_back(std::move(node));
+      return true;
+    }
+
+    std::vector<Node> operands;
+    if (code == ExprBytecode::kNot) {
+      return Pop(1, operands) && Push(Node());
+    }
+    if (code == ExprBytecode::kAnd || code == ExprBytecode::kOr) {
+      if (!Pop(2, operands) || operands[0].kind != Node::kValue || operands[1].kind != Node::kValue) {
+        return false;
+      }
+      Node node;
+      if (code == ExprBytecode::kAnd) {
+        node.bounds = std::move(operands[0].bounds);
+        for (const auto& [key_order, bound] : operands[1].bounds) {
+          node.bounds[key_order].Merge(bound);
+        }
+      }
+      return Push(std::move(node));
+    }
+
+    // The following operators are followed by the operand type.
+    uint8_t operand_type = 0;
+    if (!ReadByte(operand_type) || !ExprBytecode::IsKnownType(operand_type)) {
+      return false;
+    }
+    if (code == ExprBytecode::kPos || code == ExprBytecode::kNeg ||
+        (code >= ExprBytecode::kIsNull && code <= ExprBytecode::kIsFalse)) {
+      return Pop(1, operands) && Push(Node());
+    }
+    if (code >= ExprBytecode::kAdd && code <= ExprBytecode::kMod) {
+      return Pop(2, operands) && Push(Node());
+    }
+    if (code >= ExprBytecode::kEq && code <= ExprBytecode::kNe) {
+      if (!Pop(2, operands)) {
+        return false;
+      }
+      Node node;
+      Compare(code, operand_type, operands[0], operands[1], node.bounds);
+      return Push(std::move(node));
+    }
+
+    // Unknown operator, the length of operand can not be determined.
+    return false;
+  }
+
+  bool Push(Node&& node) {
+    stack_.push_back(std::move(node));
+    return true;
+  }
+
+  bool ReadConst(uint8_t type, bool negative) {
+    Node node;
+    node.kind = Node::kConst;
+    node.type = type;
+
+    uint64_t value = 0;
+    switch (type) {
+      case ExprBytecode::kTypeInt32:
+        if (!ReadVarint(value)) {
+          return false;
+        }
+        node.const_value =
+            std::optional<int32_t>(static_cast<int32_t>(negative ? -static_cast<int64_t>(value) : value));
+        break;
+      case ExprBytecode::kTypeInt64:
+        if (!ReadVarint(value)) {
+          return false;
+        }
+        node.const_value =
+            std::optional<int64_t>(negative ? -static_cast<int64_t>(value) : static_cast<int64_t>(value));
+        break;
+      case ExprBytecode::kTypeBool:
+        break;
+      case ExprBytecode::kTypeFloat:
+        if (!Skip(4)) {
+          return false;
+        }
+        break;
+      case ExprBytecode::kTypeDouble:
+        if (!Skip(8)) {
+          return false;
+        }
+        break;
+      case ExprBytecode::kTypeString: {
+        if (negative || !ReadVarint(value) || pos_ + value > expression_.size()) {
+          return false;
+        }
+        node.const_value = std::optional<std::shared_ptr<std::string>>(
+            std::make_shared<std::string>(expression_.substr(pos_, value)));
+        pos_ += value;
+        break;
+      }
+      default:
+        return false;
+    }
+
+    stack_.push_back(std::move(node));
+    return true;
+  }
+
+  // Only int, long and string key column, the float key encoding does not keep -0.0 == 0.0.
+  void Compare(uint8_t code, uint8_t operand_type, const Node& lhs, const Node& rhs,
+               std::map<int, ColumnBound>& bounds) {
+    const Node* var = &lhs;
+    const Node* constant = &rhs;
+    if (lhs.kind == Node::kConst && rhs.kind == Node::kVar) {
+      var = &rhs;
+      constant = &lhs;
+      // c < v equals to v > c.
+      switch (code) {
+        case ExprBytecode::kGe:
+          code = ExprBytecode::kLe;
+          break;
+        case ExprBytecode::kGt:
+          code = ExprBytecode::kLt;
+          break;
+        case ExprBytecode::kLe:
+          code = ExprBytecode::kGe;
+          break;
+        case ExprBytecode::kLt:
+          code = ExprBytecode::kGt;
+          break;
+        default:
+          break;
+      }
+    }
+
+    if (var->kind != Node::kVar || constant->kind != Node::kConst || code == ExprBytecode::kNe) {
+      return;
+    }
+    if (var->type != operand_type || constant->type != operand_type || !constant->const_value.has_value()) {
+      return;
+    }
+
+    int column = tuple_columns_[var->var_index];
+    int key_order = key_orders_[column];
+    if (key_order < 0) {
+      return;
+    }
+
+    std::string encoded;
+    if (!EncodeKeyColumn((*serial_schemas_)[column], constant->const_value, encoded)) {
+      return;
+    }
+
+    auto& bound = bounds[key_order];
+    if (code == ExprBytecode::kEq || code == ExprBytecode::kGe || code == ExprBytecode::kGt) {
+      bound.MergeLower(encoded, code != ExprBytecode::kGt);
+    }
+    if (code == ExprBytecode::kEq || code == ExprBytecode::kLe || code == ExprBytecode::kLt) {
+      bound.MergeUpper(encoded, code != ExprBytecode::kLt);
+    }
+  }
+
+  static bool EncodeKeyColumn(const std::shared_ptr<BaseSchema>& schema, const std::any& value, std::string& output) {
+    Buf buf(16, IsLE());
+    switch (schema->GetType()) {
+      case BaseSchema::kInteger: {
+        auto is = std::dynamic_pointer_cast<DingoSchema<std::optional<int32_t>>>(schema);
+        is->EncodeKeyPrefix(&buf, std::any_cast<std::optional<int32_t>>(value));
+        break;
+      }
+      case BaseSchema::kLong: {
+        auto ls = std::dynamic_pointer_cast<DingoSchema<std::optional<int64_t>>>(schema);
+        ls->EncodeKeyPrefix(&buf, std::any_cast<std::optional<int64_t>>(value));
+        break;
+      }
+      case BaseSchema::kString: {
+        auto ss = std::dynamic_pointer_cast<DingoSchema<std::optional<std::shared_ptr<std::string>>>>(schema);
+        ss->EncodeKeyPrefix(&buf, std::any_cast<std::optional<std::shared_ptr<std::string>>>(value));
+        break;
+      }
+      default:
+        return false;
+    }
+
+    return buf.GetBytes(output) >= 0;
+  }
+
+  static uint8_t GetTypeCode(BaseSchema::Type type) {
+    switch (type) {
+      case BaseSchema::kBool:
+        return ExprBytecode::kTypeBool;
+      case BaseSchema::kInteger:
+        return ExprBytecode::kTypeInt32;
+      case BaseSchema::kFloat:
+        return ExprBytecode::kTypeFloat;
+      case BaseSchema::kLong:
+        return ExprBytecode::kTypeInt64;
+      case BaseSchema::kDouble:
+        return ExprBytecode::kTypeDouble;
+      case BaseSchema::kString:
+        return ExprBytecode::kTypeString;
+      default:
+        return 0;
+    }
+  }
+
+  const std::shared_ptr<std::vector<std::shared_ptr<BaseSchema>>>& serial_schemas_;
+  const std::vector<int>& tuple_columns_;
+  const std::vector<int>& key_orders_;
+
+  std::string_view expression_;
+  size_t pos_{0};
+  std::vector<Node> stack_;
+};
+
+}  // namespace
+
+// The original column position of each tuple variable, selection_columns is the schema index.
+static bool GetTupleColumns(const google::protobuf::RepeatedPtrField<pb::common::Schema>& pb_schemas,
+                            const ::google::protobuf::RepeatedField<int32_t>& selection_columns,
+                            std::vector<int>& tuple_columns) {
+  std::vector<int> original_column_indexes(pb_schemas.size(), -1);
+  for (int i = 0; i < pb_schemas.size(); ++i) {
+    int index = pb_schemas[i].index();
+    if (index < 0 || index >= pb_schemas.size()) {
+      return false;
+    }
+    original_column_indexes[index] = i;
+  }
+
+  tuple_columns.clear();
+  if (selection_columns.empty()) {
+    tuple_columns = original_column_indexes;
+  } else {
+    for (auto index : selection_columns) {
+      if (index < 0 || index >= pb_schemas.size()) {
+        return false;
+      }
+      tuple_columns.push_back(original_column_indexes[index]);
+    }
+  }
+
+  for (auto column : tuple_columns) {
+    if (column < 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool KeyRangeDeriver::Derive(const pb::common::CoprocessorV2& coprocessor, pb::common::Range& range) {
+  const auto& rel_expr = coprocessor.rel_expr();
+  // Only the filter at the head of rel_expr sees the original tuple.
+  if (rel_expr.empty() || static_cast<uint8_t>(rel_expr[0]) != ExprBytecode::kRelFilter ||
+      coprocessor.selection_columns().empty()) {
+    return false;
+  }
+
+  std::vector<int> tuple_columns;
+  if (!GetTupleColumns(coprocessor.original_schema().schema(), coprocessor.selection_columns(), tuple_columns)) {
+    return false;
+  }
+
+  return Derive(coprocessor.original_schema().schema(), coprocessor.original_schema().common_id(), tuple_columns,
+                std::string_view(rel_expr).substr(1), range);
+}
+
+bool KeyRangeDeriver::Derive(const pb::store::Coprocessor& coprocessor, pb::common::Range& range) {
+  if (coprocessor.expression().empty()) {
+    return false;
+  }
+
+  std::vector<int> tuple_columns;
+  if (!GetTupleColumns(coprocessor.original_schema().schema(), coprocessor.selection_columns(), tuple_columns)) {
+    return false;
+  }
+
+  return Derive(coprocessor.original_schema().schema(), coprocessor.original_schema().common_id(), tuple_columns,
+                coprocessor.expression(), range);
+}
+
+bool KeyRangeDeriver::Derive(const google::protobuf::RepeatedPtrField<pb::common::Schema>& pb_schemas,
+                             int64_t common_id, const std::vector<int>& tuple_columns, std::string_view expression,
+                             pb::common::Range& range) {
+  if (!FLAGS_enable_coprocessor_key_range_derive || range.start_key().empty() || pb_schemas.empty()) {
+    return false;
+  }
+
+  auto serial_schemas = std::make_shared<std::vector<std::shared_ptr<BaseSchema>>>();
+  auto status = Utils::TransToSerialSchema(pb_schemas, &serial_schemas);
+  if (!status.ok()) {
+    return false;
+  }
+  FormatSchema(serial_schemas, IsLE());
+
+  // The key columns are encoded by the schema order.
+  std::vector<int> key_orders(serial_schemas->size(), -1);
+  int key_count = 0;
+  for (size_t i = 0; i < serial_schemas->size(); ++i) {
+    if ((*serial_schemas)[i]->IsKey()) {
+      key_orders[i] = key_count++;
+    }
+  }
+
+  std::map<int, ColumnBound> bounds;
+  ExpressionAnalyzer analyzer(serial_schemas, tuple_columns, key_orders);
+  if (!analyzer.Analyze(expression, bounds)) {
+    DINGO_LOG(DEBUG) << fmt::format("KeyRangeDeriver analyze expression failed, expression: {}",
+                                    Helper::StringToHex(expression));
+    return false;
+  }
+
+  // |namespace|common_id|, the namespace is the same with the request range.
+  Buf prefix_buf(9, IsLE());
+  prefix_buf.Write(range.start_key()[0]);
+  prefix_buf.WriteLong(common_id);
+  std::string prefix;
+  prefix_buf.GetBytes(prefix);
+
+  // Equal leading key columns extend the prefix, the first non-equal key column bounds the range.
+  std::string start_key;
+  std::string end_key;
+  bool has_bound = false;
+  for (int key_order = 0; key_order < key_count; ++key_order) {
+    auto it = bounds.find(key_order);
+    if (it == bounds.end()) {
+      break;
+    }
+    const auto& bound = it->second;
+    if (bound.IsEqual()) {
+      prefix += bound.lower.value();
+      has_bound = true;
+      continue;
+    }
+
+    if (bound.lower.has_value()) {
+      start_key = prefix + bound.lower.value();
+      if (!bound.lower_inclusive) {
+        start_key = Helper::PrefixNext(start_key);
+      }
+    }
+    if (bound.upper.has_value()) {
+      end_key = prefix + bound.upper.value();
+      if (bound.upper_inclusive) {
+        end_key = Helper::PrefixNext(end_key);
+      }
+    }
+    has_bound = true;
+    break;
+  }
+
+  if (!has_bound) {
+    return false;
+  }
+  if (start_key.empty()) {
+    start_key = prefix;
+  }
+  if (end_key.empty()) {
+    end_key = Helper::PrefixNext(prefix);
+  }
+
+  // Intersect with the request range.
+  if (start_key < range.start_key()) {
+    start_key = range.start_key();
+  }
+  if (!range.end_key().empty() && range.end_key() < end_key) {
+    end_key = range.end_key();
+  }
+  if (end_key < start_key) {
+    end_key = start_key;
+  }
+
+  DINGO_LOG(DEBUG) << fmt::format("KeyRangeDeriver derive range [{}, {}) from [{}, {})",
+                                  Helper::StringToHex(start_key), Helper::StringToHex(end_key),
+                                  Helper::StringToHex(range.start_key()), Helper::StringToHex(range.end_key()));
+
+  range.set_start_key(start_key);
+  range.set_end_key(end_key);
+  g_coprocessor_key_range_derive_count << 1;
+  return true;
+}
+
+}  // namespace dingodb
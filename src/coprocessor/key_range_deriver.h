@@ -0,0 +1,53 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGODB_COPROCESSOR_KEY_RANGE_DERIVER_H_  // NOLINT
+#define DINGODB_COPROCESSOR_KEY_RANGE_DERIVER_H_
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "proto/common.pb.h"
+#include "proto/store.pb.h"
+
+namespace dingodb {
+
+// Narrow the scan range by the coprocessor filter on the leading key columns.
+// The filter expression is analyzed for the conjunction of equality and range comparisons between a key column and
+// a constant, e.g. k0 = 1 AND k1 >= 'a' AND k1 < 'c'. Those comparisons are encoded with the key codec into seek
+// bounds and intersected with the request range, so the rows outside the predicate are never read.
+// The filter is still evaluated on every row, the derived range only covers a superset of the matched rows.
+class KeyRangeDeriver {
+ public:
+  KeyRangeDeriver() = delete;
+  ~KeyRangeDeriver() = delete;
+
+  KeyRangeDeriver(const KeyRangeDeriver& rhs) = delete;
+  KeyRangeDeriver& operator=(const KeyRangeDeriver& rhs) = delete;
+
+  // Return true if range is narrowed, an empty result is start_key == end_key.
+  // Return false and keep range if nothing can be derived.
+  static bool Derive(const pb::common::CoprocessorV2& coprocessor, pb::common::Range& range);  // NOLINT
+  static bool Derive(const pb::store::Coprocessor& coprocessor, pb::common::Range& range);     // NOLINT
+
+  // The expression is the filter bytecode, tuple_columns map the tuple variable index to the original column.
+  static bool Derive(const google::protobuf::RepeatedPtrField<pb::common::Schema>& pb_schemas, int64_t common_id,
+                     const std::vector<int>& tuple_columns, std::string_view expression,
+                     pb::common::Range& range);  // NOLINT
+};
+
+}  // namespace dingodb
+
+#endif  // DINGODB_COPROCESSOR_KEY_RANGE_DERIVER_H_  // NOLINT
@@ -14,7 +14,12 @@
 
 #include "coprocessor/rel_expr_helper.h"
 
+#include <any>
 #include <cstdint>
+#include <memory>
+#include <string>
+#include <variant>
+#include <vector>
 
 #include "common/logging.h"
 #include "fmt/core.h"
@@ -22,6 +27,81 @@
 
 namespace dingodb {
 
+using ToOperandFuncPointer = void (*)(const std::any& column, std::vector<expr::Operand>& operands);
+using FromOperandFuncPointer = std::any (*)(const expr::Operand& operand);
+
+template <typename T>
+static void ToOperandFunc(const std::any& column, std::vector<expr::Operand>& operands) {
+  operands.emplace_back(expr::any_optional_data_adaptor::ToOperand<T>(column));
+}
+
+template <typename T>
+static std::any FromOperandFunc(const expr::Operand& operand) {
+  return expr::any_optional_data_adaptor::FromOperand<T>(operand);
+}
+
+static ToOperandFuncPointer GetToOperandFunc(BaseSchema::Type type) {
+  switch (type) {
+    case BaseSchema::Type::kBool:
+      return ToOperandFunc<bool>;
+    case BaseSchema::Type::kInteger:
+      return ToOperandFunc<int32_t>;
+    case BaseSchema::Type::kFloat:
+      return ToOperandFunc<float>;
+    case BaseSchema::Type::kLong:
+      return ToOperandFunc<int64_t>;
+    case BaseSchema::Type::kDouble:
+      return ToOperandFunc<double>;
+    case BaseSchema::Type::kString:
+      return ToOperandFunc<std::shared_ptr<std::string>>;
+    case BaseSchema::Type::kBoolList:
+      return ToOperandFunc<std::shared_ptr<std::vector<bool>>>;
+    case BaseSchema::Type::kIntegerList:
+      return ToOperandFunc<std::shared_ptr<std::vector<int32_t>>>;
+    case BaseSchema::Type::kFloatList:
+      return ToOperandFunc<std::shared_ptr<std::vector<float>>>;
+    case BaseSchema::Type::kLongList:
+      return ToOperandFunc<std::shared_ptr<std::vector<int64_t>>>;
+    case BaseSchema::Type::kDoubleList:
+      return ToOperandFunc<std::shared_ptr<std::vector<double>>>;
+    case BaseSchema::Type::kStringList:
+      return ToOperandFunc<std::shared_ptr<std::vector<std::string>>>;
+    default:
+      return nullptr;
+  }
+}
+
+static FromOperandFuncPointer GetFromOperandFunc(BaseSchema::Type type) {
+  switch (type) {
+    case BaseSchema::Type::kBool:
+      return FromOperandFunc<bool>;
+    case BaseSchema::Type::kInteger:
+      return FromOperandFunc<int32_t>;
+    case BaseSchema::Type::kFloat:
+      return FromOperandFunc<float>;
+    case BaseSchema::Type::kLong:
+      return FromOperandFunc<int64_t>;
+    case BaseSchema::Type::kDouble:
+      return FromOperandFunc<double>;
+    case BaseSchema::Type::kString:
+      return FromOperandFunc<std::shared_ptr<std::string>>;
+    case BaseSchema::Type::kBoolList:
+      return FromOperandFunc<std::shared_ptr<std::vector<bool>>>;
+    case BaseSchema::Type::kIntegerList:
+      return FromOperandFunc<std::shared_ptr<std::vector<int32_t>>>;
+    case BaseSchema::Type::kFloatList:
+      return FromOperandFunc<std::shared_ptr<std::vector<float>>>;
+    case BaseSchema::Type::kLongList:
+      return FromOperandFunc<std::shared_ptr<std::vector<int64_t>>>;
+    case BaseSchema::Type::kDoubleList:
+      return FromOperandFunc<std::shared_ptr<std::vector<double>>>;
+    case BaseSchema::Type::kStringList:
+      return FromOperandFunc<std::shared_ptr<std::vector<std::string>>>;
+    default:
+      return nullptr;
+  }
+}
+
 butil::Status RelExprHelper::TransToOperand(BaseSchema::Type type, const std::any& column,
                                             std::unique_ptr<std::vector<expr::Operand>>& operand_ptr) {
   if (!operand_ptr) {
@@ -353,4 +433,74 @@ butil::Status RelExprHelper::TransFromOperandWrapper(
   return butil::Status();
 }
 
+butil::Status RelExprHelper::TransToOperandBatch(
+    const std::shared_ptr<std::vector<std::shared_ptr<BaseSchema>>>& original_serial_schemas,
+    const std::vector<int>& selection_column_indexes, const std::vector<std::vector<std::any>>& original_records,
+    size_t count, std::vector<std::unique_ptr<std::vector<expr::Operand>>>& operand_ptrs) {
+  operand_ptrs.clear();
+  operand_ptrs.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    auto& operand_ptr = operand_ptrs.emplace_back(std::make_unique<std::vector<expr::Operand>>());
+    operand_ptr->reserve(selection_column_indexes.size());
+  }
+
+  for (size_t column = 0; column < selection_column_indexes.size(); ++column) {
+    BaseSchema::Type type = (*original_serial_schemas)[selection_column_indexes[column]]->GetType();
+    auto to_operand_func = GetToOperandFunc(type);
+    if (to_operand_func == nullptr) {
+      std::string s = fmt::format("CloneColumn unsupported type  {}", BaseSchema::GetTypeString(type));
+      DINGO_LOG(ERROR) << s;
+      return butil::Status(pb::error::EILLEGAL_PARAMTETERS, s);
+    }
+
+    try {
+      for (size_t i = 0; i < count; ++i) {
+        to_operand_func(original_records[i].at(column), *operand_ptrs[i]);
+      }
+    } catch (const std::bad_any_cast& bad) {
+      std::string s = fmt::format("Trans to Operand failed, type {} {}", BaseSchema::GetTypeString(type), bad.what());
+      DINGO_LOG(ERROR) << s;
+      return butil::Status(pb::error::EILLEGAL_PARAMTETERS, s);
+    }
+  }
+
+  return butil::Status();
+}
+
+butil::Status RelExprHelper::TransFromOperandBatch(
+    const std::vector<std::unique_ptr<std::vector<expr::Operand>>>& operand_ptrs,
+    const std::shared_ptr<std::vector<std::shared_ptr<BaseSchema>>>& result_serial_schemas,
+    const std::vector<int>& result_column_indexes, std::vector<std::vector<std::any>>& result_records) {
+  result_records.resize(operand_ptrs.size());
+  for (size_t i = 0; i < operand_ptrs.size(); ++i) {
+    result_records[i].clear();
+    result_records[i].reserve(operand_ptrs[i]->size());
+  }
+
+  for (size_t column = 0; column < result_column_indexes.size(); ++column) {
+    BaseSchema::Type type = (*result_serial_schemas)[result_column_indexes[column]]->GetType();
+    auto from_operand_func = GetFromOperandFunc(type);
+    if (from_operand_func == nullptr) {
+      std::string s = fmt::format("CloneColumn unsupported type  {}", BaseSchema::GetTypeString(type));
+      DINGO_LOG(ERROR) << s;
+      return butil::Status(pb::error::EILLEGAL_PARAMTETERS, s);
+    }
+
+    try {
+      for (size_t i = 0; i < operand_ptrs.size(); ++i) {
+        // the result tuple may be shorter than the result schema, same as TransFromOperandWrapper.
+        if (column < operand_ptrs[i]->size()) {
+          result_records[i].emplace_back(from_operand_func((*operand_ptrs[i])[column]));
+        }
+      }
+    } catch (const std::bad_variant_access& bad) {
+      std::string s = fmt::format("Trans from operand failed, type {} {}", BaseSchema::GetTypeString(type), bad.what());
+      DINGO_LOG(ERROR) << s;
+      return butil::Status(pb::error::EILLEGAL_PARAMTETERS, s);
+    }
+  }
+
+  return butil::Status();
+}
+
 }  // namespace dingodb
@@ -98,6 +98,19 @@ class RelExprHelper {
       const std::unique_ptr<std::vector<expr::Operand>>& operand_ptr,
       const std::shared_ptr<std::vector<std::shared_ptr<BaseSchema>>>& result_serial_schemas,
       const std::vector<int>& result_column_indexes, std::vector<std::any>& result_record);
+
+  // Batch version of TransToOperandWrapper, convert the first count records column by column.
+  // The column type is dispatched once per column instead of once per cell.
+  static butil::Status TransToOperandBatch(
+      const std::shared_ptr<std::vector<std::shared_ptr<BaseSchema>>>& original_serial_schemas,
+      const std::vector<int>& selection_column_indexes, const std::vector<std::vector<std::any>>& original_records,
+      size_t count, std::vector<std::unique_ptr<std::vector<expr::Operand>>>& operand_ptrs);  // NOLINT
+
+  // Batch version of TransFromOperandWrapper.
+  static butil::Status TransFromOperandBatch(
+      const std::vector<std::unique_ptr<std::vector<expr::Operand>>>& operand_ptrs,
+      const std::shared_ptr<std::vector<std::shared_ptr<BaseSchema>>>& result_serial_schemas,
+      const std::vector<int>& result_column_indexes, std::vector<std::vector<std::any>>& result_records);  // NOLINT
 };
 
 }  // namespace dingodb
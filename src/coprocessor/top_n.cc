@@ -0,0 +1,170 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "coprocessor/top_n.h"
+
+#include <algorithm>
+#include <any>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/logging.h"
+#include "fmt/core.h"
+#include "proto/error.pb.h"
+
+namespace dingodb {
+
+using CompareColumnFuncPointer = int (*)(const std::any& lhs, const std::any& rhs);
+
+template <typename T>
+static int CompareValue(const T& lhs, const T& rhs) {
+  if (lhs < rhs) {
+    return -1;
+  }
+  return rhs < lhs ? 1 : 0;
+}
+
+template <>
+int CompareValue(const std::shared_ptr<std::string>& lhs, const std::shared_ptr<std::string>& rhs) {
+  if (lhs == nullptr || rhs == nullptr) {
+    return CompareValue(lhs != nullptr, rhs != nullptr);
+  }
+  return lhs->compare(*rhs);
+}
+
+// Null is less than any value, the missing value of a short record is null.
+template <typename T>
+static int CompareColumn(const std::any& lhs, const std::any& rhs) {
+  const auto* lhs_value = std::any_cast<std::optional<T>>(&lhs);
+  const auto* rhs_value = std::any_cast<std::optional<T>>(&rhs);
+  bool lhs_has_value = lhs_value != nullptr && lhs_value->has_value();
+  bool rhs_has_value = rhs_value != nullptr && rhs_value->has_value();
+  if (!lhs_has_value || !rhs_has_value) {
+    return CompareValue(lhs_has_value, rhs_has_value);
+  }
+  return CompareValue(lhs_value->value(), rhs_value->value());
+}
+
+static CompareColumnFuncPointer GetCompareColumnFunc(BaseSchema::Type type) {
+  switch (type) {
+    case BaseSchema::Type::kBool:
+      return CompareColumn<bool>;
+    case BaseSchema::Type::kInteger:
+      return CompareColumn<int32_t>;
+    case BaseSchema::Type::kFloat:
+      return CompareColumn<float>;
+    case BaseSchema::Type::kLong:
+      return CompareColumn<int64_t>;
+    case BaseSchema::Type::kDouble:
+      return CompareColumn<double>;
+    case BaseSchema::Type::kString:
+      return CompareColumn<std::shared_ptr<std::string>>;
+    default:
+      return nullptr;
+  }
+}
+
+butil::Status TopN::Open(const std::shared_ptr<std::vector<std::shared_ptr<BaseSchema>>>& result_serial_schemas,
+                         const std::vector<int>& result_column_indexes,
+                         const google::protobuf::RepeatedPtrField<pb::common::CoprocessorV2::SortColumn>& sort_columns,
+                         int64_t limit) {
+  if (limit <= 0 || sort_columns.empty()) {
+    std::string error_message = fmt::format("TopN limit : {} sort columns : {} invalid", limit, sort_columns.size());
+    DINGO_LOG(ERROR) << error_message;
+    return butil::Status(pb::error::EILLEGAL_PARAMTETERS, error_message);
+  }
+
+  sort_keys_.clear();
+  sort_keys_.reserve(sort_columns.size());
+  for (const auto& sort_column : sort_columns) {
+    int index = sort_column.index();
+    if (index < 0 || index >= static_cast<int>(result_column_indexes.size()) || result_column_indexes[index] < 0) {
+      std::string error_message = fmt::format("TopN sort column index : {} out of result schema", index);
+      DINGO_LOG(ERROR) << error_message;
+      return butil::Status(pb::error::EILLEGAL_PARAMTETERS, error_message);
+    }
+
+    BaseSchema::Type type = (*result_serial_schemas)[result_column_indexes[index]]->GetType();
+    auto compare_func = GetCompareColumnFunc(type);
+    if (compare_func == nullptr) {
+      std::string error_message =
+          fmt::format("TopN sort column index : {} type : {} not support", index, BaseSchema::GetTypeString(type));
+      DINGO_LOG(ERROR) << error_message;
+      return butil::Status(pb::error::ENOT_SUPPORT, error_message);
+    }
+
+    sort_keys_.push_back(SortKey{static_cast<size_t>(index), compare_func, sort_column.is_desc()});
+  }
+
+  limit_ = static_cast<size_t>(limit);
+  sequence_ = 0;
+  heap_.clear();
+  return butil::Status();
+}
+
+void TopN::Put(std::vector<std::any>&& record) {
+  auto less = [this](const Row& lhs, const Row& rhs) { return Less(lhs, rhs); };
+  Row row{std::move(record), sequence_++};
+  if (heap_.size() < limit_) {
+    heap_.push_back(std::move(row));
+    std::push_heap(heap_.begin(), heap_.end(), less);
+    return;
+  }
+
+  // Replace the last one of the kept records.
+  if (!Less(row, heap_.front())) {
+    return;
+  }
+  std::pop_heap(heap_.begin(), heap_.end(), less);
+  heap_.back() = std::move(row);
+  std::push_heap(heap_.begin(), heap_.end(), less);
+}
+
+std::vector<std::vector<std::any>> TopN::Take() {
+  std::sort_heap(heap_.begin(), heap_.end(), [this](const Row& lhs, const Row& rhs) { return Less(lhs, rhs); });
+
+  std::vector<std::vector<std::any>> records;
+  records.reserve(heap_.size());
+  for (auto& row : heap_) {
+    records.push_back(std::move(row.record));
+  }
+  heap_.clear();
+  return records;
+}
+
+void TopN::Close() {
+  heap_.clear();
+  heap_.shrink_to_fit();
+  sort_keys_.clear();
+}
+
+bool TopN::Less(const Row& lhs, const Row& rhs) const {
+  static const std::any kNull;
+  for (const auto& sort_key : sort_keys_) {
+    const auto& lhs_value = sort_key.index < lhs.record.size() ? lhs.record[sort_key.index] : kNull;
+    const auto& rhs_value = sort_key.index < rhs.record.size() ? rhs.record[sort_key.index] : kNull;
+    int result = sort_key.compare_func(lhs_value, rhs_value);
+    if (result != 0) {
+      return sort_key.is_desc ? result > 0 : result < 0;
+    }
+  }
+  return lhs.sequence < rhs.sequence;
+}
+
+}  // namespace dingodb
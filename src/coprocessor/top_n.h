@@ -0,0 +1,84 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGODB_COPROCESSOR_TOP_N_H_  // NOLINT
+#define DINGODB_COPROCESSOR_TOP_N_H_
+
+#include <any>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "butil/status.h"
+#include "proto/common.pb.h"
+#include "serial/schema/base_schema.h"
+
+namespace dingodb {
+
+// ORDER BY ... LIMIT n over the result records, keep the first n records in a bounded heap.
+// The records are compared by the typed sort columns, the equal records keep the order they are put.
+class TopN {
+ public:
+  TopN() = default;
+  ~TopN() = default;
+
+  TopN(const TopN& rhs) = delete;
+  TopN& operator=(const TopN& rhs) = delete;
+  TopN(TopN&& rhs) = delete;
+  TopN& operator=(TopN&& rhs) = delete;
+
+  // result_column_indexes: array index = result schema member index ; value = result schema array index.
+  butil::Status Open(const std::shared_ptr<std::vector<std::shared_ptr<BaseSchema>>>& result_serial_schemas,
+                     const std::vector<int>& result_column_indexes,
+                     const google::protobuf::RepeatedPtrField<pb::common::CoprocessorV2::SortColumn>& sort_columns,
+                     int64_t limit);
+
+  // The record is dropped if it is ordered after all of the n kept records.
+  void Put(std::vector<std::any>&& record);
+
+  // Take the kept records in order, the heap is empty after that.
+  std::vector<std::vector<std::any>> Take();
+
+  size_t Size() const { return heap_.size(); }
+
+  void Close();
+
+ private:
+  // Return <0 if lhs is ordered before rhs, 0 if equal, >0 otherwise.
+  using CompareFunc = int (*)(const std::any& lhs, const std::any& rhs);
+
+  struct SortKey {
+    size_t index;
+    CompareFunc compare_func;
+    bool is_desc;
+  };
+
+  struct Row {
+    std::vector<std::any> record;
+    int64_t sequence;
+  };
+
+  // The heap is ordered by Less, so the front is the last one of the kept records.
+  bool Less(const Row& lhs, const Row& rhs) const;
+
+  std::vector<SortKey> sort_keys_;
+  size_t limit_{0};
+  int64_t sequence_{0};
+  std::vector<Row> heap_;
+};
+
+}  // namespace dingodb
+
+#endif  // DINGODB_COPROCESSOR_TOP_N_H_  // NOLINT
@@ -44,6 +44,21 @@ class RawEngine : public std::enable_shared_from_this<RawEngine> {
     virtual butil::Status KvGet(const std::string& cf_name, std::shared_ptr<dingodb::Snapshot> snapshot,
                                 const std::string& key, std::string& value) = 0;
 
+    // Get multiple keys at once, values[i] is the value of keys[i], empty when not found.
+    // Default get one by one, engine can override it with a native multi get.
+    virtual butil::Status KvBatchGet(const std::string& cf_name, const std::vector<std::string>& keys,
+                                     std::vector<std::string>& values) {
+      values.clear();
+      values.resize(keys.size());
+      for (size_t i = 0; i < keys.size(); ++i) {
+        auto status = KvGet(cf_name, keys[i], values[i]);
+        if (!status.ok() && status.error_code() != pb::error::EKEY_NOT_FOUND) {
+          return status;
+        }
+      }
+      return butil::Status();
+    }
+
     virtual butil::Status KvScan(const std::string& cf_name, const std::string& start_key, const std::string& end_key,
                                  std::vector<pb::common::KeyValue>& kvs) = 0;
     virtual butil::Status KvScan(const std::string& cf_name, std::shared_ptr<dingodb::Snapshot> snapshot,
@@ -20,6 +20,7 @@
 #include <vector>
 
 #include "butil/compiler_specific.h"
+#include "butil/guid.h"
 #include "butil/status.h"
 #include "common/constant.h"
 #include "common/helper.h"
@@ -336,6 +337,41 @@ butil::Status Storage::KvScanReleaseV2(std::shared_ptr<Context> /*ctx*/, int64_t
   return status;
 }
 
+butil::Status Storage::KvScanStreamBegin(std::shared_ptr<Context> ctx, const std::string& cf_name, int64_t region_id,
+                                         const pb::common::Range& range, bool key_only, bool disable_coprocessor,
+                                         const pb::common::CoprocessorV2& coprocessor, std::string& scan_id,
+                                         std::shared_ptr<ScanContext>& scan) {
+  auto status = ValidateLeader(ctx->RegionId());
+  if (!status.ok()) {
+    return status;
+  }
+
+  // Only for the limits of every batch, the timeout is useless without ScanManager.
+  ScanManager& manager = ScanManager::GetInstance();
+  scan = std::make_shared<ScanContext>();
+  scan->Init(manager.GetTimeoutMs(), manager.GetMaxBytesRpc(), manager.GetMaxFetchCntByServer());
+
+  scan_id = butil::GenerateGUID();
+  auto raw_engine = engine_->GetRawEngine(ctx->RawEngineType());
+  status = scan->Open(scan_id, raw_engine, cf_name);
+  if (!status.ok()) {
+    DINGO_LOG(ERROR) << fmt::format("ScanContext::Open failed : {}", scan_id);
+    scan.reset();
+    return status;
+  }
+
+  // No data with the begin, the stream pushes all of the batches.
+  std::vector<pb::common::KeyValue> kvs;
+  status = ScanHandler::ScanBegin(scan, region_id, range, 0, key_only, true, disable_coprocessor, coprocessor, &kvs);
+  if (!status.ok()) {
+    DINGO_LOG(ERROR) << fmt::format("ScanContext::ScanBegin failed: {}", scan_id);
+    scan.reset();
+    return status;
+  }
+
+  return status;
+}
+
 butil::Status Storage::VectorAdd(std::shared_ptr<Context> ctx, bool is_sync,
                                  const std::vector<pb::common::VectorWithId>& vectors) {
   if (is_sync) {
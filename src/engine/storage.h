@@ -66,6 +66,12 @@ class Storage {
 
   static butil::Status KvScanReleaseV2(std::shared_ptr<Context> ctx, int64_t scan_id);
 
+  // The stream scan is not registered in ScanManager, it is owned by the stream and released with it.
+  butil::Status KvScanStreamBegin(std::shared_ptr<Context> ctx, const std::string& cf_name, int64_t region_id,
+                                  const pb::common::Range& range, bool key_only, bool disable_coprocessor,
+                                  const pb::common::CoprocessorV2& coprocessor, std::string& scan_id,
+                                  std::shared_ptr<ScanContext>& scan);
+
   // kv write
   butil::Status KvPut(std::shared_ptr<Context> ctx, const std::vector<pb::common::KeyValue>& kvs);
 
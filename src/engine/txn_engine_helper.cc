@@ -29,6 +29,7 @@
 #include "common/helper.h"
 #include "common/logging.h"
 #include "coprocessor/coprocessor_v2.h"
+#include "coprocessor/key_range_deriver.h"
 #include "fmt/core.h"
 #include "meta/store_meta_manager.h"
 #include "proto/common.pb.h"
@@ -925,17 +926,23 @@ butil::Status TxnEngineHelper::Scan(RawEnginePtr raw_engine, const pb::store::Is
     return butil::Status(pb::error::Errno::EILLEGAL_PARAMTETERS, "has_more or end_key is not empty");
   }
 
+  // Skip the rows out of the coprocessor filter on the leading key columns.
+  pb::common::Range scan_range = range;
+  if (!disable_coprocessor) {
+    KeyRangeDeriver::Derive(coprocessor, scan_range);
+  }
+
   std::shared_ptr<TxnIterator> txn_iter =
-      std::make_shared<TxnIterator>(raw_engine, range, start_ts, isolation_level, resolved_locks);
+      std::make_shared<TxnIterator>(raw_engine, scan_range, start_ts, isolation_level, resolved_locks);
   auto ret = txn_iter->Init();
   if (!ret.ok()) {
     DINGO_LOG(ERROR) << "[txn]Scan init txn_iter failed, start_ts: " << start_ts
-                     << ", range: " << range.ShortDebugString() << ", status: " << ret.error_str();
+                     << ", range: " << scan_range.ShortDebugString() << ", status: " << ret.error_str();
     return ret;
   }
 
   int64_t response_memory_size = 0;
-  txn_iter->Seek(range.start_key());
+  txn_iter->Seek(scan_range.start_key());
 
   if (!disable_coprocessor) {
     std::shared_ptr<RawCoprocessor> txn_coprocessor = std::make_shared<CoprocessorV2>();
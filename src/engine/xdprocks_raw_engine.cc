@@ -321,6 +321,47 @@ butil::Status Reader::KvGet(const std::string& cf_name, std::shared_ptr<dingodb:
   return KvGet(column_family, snapshot, key, value);
 }
 
+butil::Status Reader::KvBatchGet(const std::string& cf_name, const std::vector<std::string>& keys,
+                                 std::vector<std::string>& values) {
+  values.clear();
+  if (keys.empty()) {
+    return butil::Status();
+  }
+
+  auto column_family = GetColumnFamily(cf_name);
+  auto snapshot = GetSnapshot();
+
+  std::vector<xdprocks::Slice> key_slices;
+  key_slices.reserve(keys.size());
+  for (const auto& key : keys) {
+    if (BAIDU_UNLIKELY(key.empty())) {
+      DINGO_LOG(ERROR) << fmt::format("[xdprocks] not support empty key.");
+      return butil::Status(pb::error::EKEY_EMPTY, "Key is empty");
+    }
+    key_slices.emplace_back(key);
+  }
+
+  xdprocks::ReadOptions read_option;
+  read_option.snapshot = static_cast<const xdprocks::Snapshot*>(snapshot->Inner());
+
+  std::vector<xdprocks::PinnableSlice> pinnable_values(keys.size());
+  std::vector<xdprocks::Status> statuses(keys.size());
+  GetDB()->MultiGet(read_option, column_family->GetHandle(), keys.size(), key_slices.data(), pinnable_values.data(),
+                    statuses.data());
+
+  values.resize(keys.size());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    if (statuses[i].ok()) {
+      values[i].assign(pinnable_values[i].data(), pinnable_values[i].size());
+    } else if (!statuses[i].IsNotFound()) {
+      DINGO_LOG(ERROR) << fmt::format("[xdprocks] multi get key failed, error: {}", statuses[i].ToString());
+      return butil::Status(pb::error::EINTERNAL, "Internal multi get error");
+    }
+  }
+
+  return butil::Status();
+}
+
 butil::Status Reader::KvGet(ColumnFamilyPtr column_family, dingodb::SnapshotPtr snapshot, const std::string& key,
                             std::string& value) {
   if (BAIDU_UNLIKELY(key.empty())) {
@@ -1078,6 +1078,13 @@ int VectorAddHandler::Handle(std::shared_ptr<Context> ctx, store::RegionPtr regi
                                         vector_with_ids.size(), Helper::TimestampNs() - start_time);
         if (status.ok()) {
           vector_index_wrapper->SetApplyLogId(log_id);
+
+          // Retrain the ivf vector index in background once the train sample is enough.
+          vector_index_wrapper->AddTrainSample(vector_with_ids);
+          if (vector_index_wrapper->RebuildingNum() == 0 && !vector_index_wrapper->IsRebuildError() &&
+              vector_index_wrapper->NeedToRetrain()) {
+            VectorIndexManager::LaunchRebuildVectorIndex(vector_index_wrapper, 0, "train sample ready");
+          }
         } else {
           DINGO_LOG(WARNING) << fmt::format("[raft.apply][region({})] upsert vector failed, count: {} err: {}",
                                             vector_index_id, vector_with_ids.size(), Helper::PrintStatus(status));
@@ -1187,6 +1194,7 @@ int VectorDeleteHandler::Handle(std::shared_ptr<Context> ctx, store::RegionPtr r
         auto status = vector_index_wrapper->Delete(delete_ids);
         if (status.ok()) {
           vector_index_wrapper->SetApplyLogId(log_id);
+          vector_index_wrapper->DeleteTrainSample(delete_ids);
         } else {
           DINGO_LOG(WARNING) << fmt::format("[raft.apply][region({})] delete vector failed, count: {}, error: {}",
                                             vector_index_id, delete_ids.size(), Helper::PrintStatus(status));
@@ -19,19 +19,26 @@
 #include <algorithm>
 #include <cstdint>
 #include <memory>
+#include <numeric>
 #include <string>
+#include <variant>
 #include <vector>
 
 #include "bthread/mutex.h"
 #include "butil/compiler_specific.h"
 #include "butil/macros.h"     // IWYU pragma: keep
+#include "bvar/recorder.h"
+#include "bvar/reducer.h"
 #include "common/constant.h"  // IWYU pragma: keep
 #include "common/helper.h"    // IWYU pragma: keep
 #include "common/logging.h"
+#include "common/synchronization.h"
 #include "coprocessor/coprocessor.h"
 #include "coprocessor/coprocessor_v2.h"
+#include "coprocessor/key_range_deriver.h"
 #include "coprocessor/utils.h"
 #include "engine/write_data.h"  // IWYU pragma: keep
+#include "gflags/gflags.h"
 #include "proto/common.pb.h"
 #include "proto/error.pb.h"
 #include "scan/scan_filter.h"
@@ -41,6 +48,15 @@
 
 namespace dingodb {
 
+DEFINE_int32(coprocessor_scan_parallelism, 4, "max sub ranges aggregated in parallel of a scan, 1 means disable");
+DEFINE_int64(coprocessor_parallel_scan_min_size, 64 * 1024 * 1024, "min approximate bytes of a parallel sub range");
+
+bvar::Adder<int64_t> g_coprocessor_parallel_scan_count("dingo_coprocessor_parallel_scan_count");
+bvar::IntRecorder g_coprocessor_parallel_scan_degree("dingo_coprocessor_parallel_scan_degree");
+
+// Candidate ranges split by key for each sub range, merged by approximate size later.
+static const int kSplitRangeCandidateFactor = 4;
+
 ScanContext::ScanContext()
     : region_id_(0),
       max_fetch_cnt_(0),
@@ -401,21 +417,35 @@ butil::Status ScanHandler::ScanBegin(std::shared_ptr<ScanContext> context, int64
         DINGO_LOG(ERROR) << fmt::format("Coprocessor::Open failed");
         return status;
       }
+
+      // Skip the rows out of the filter on the leading key columns.
+      std::visit([&context](const auto& pb_coprocessor) { KeyRangeDeriver::Derive(pb_coprocessor, context->range_); },
+                 coprocessor);
+
+      status = ParallelAggregate(context, coprocessor);
+      if (!status.ok()) {
+        context->state_ = ScanState::kError;
+        DINGO_LOG(ERROR) << fmt::format("ScanHandler::ParallelAggregate failed");
+        return status;
+      }
     }
   }
 
-  auto reader = context->engine_->Reader();
+  // The iterator is already created and exhausted if aggregated in parallel.
+  if (!context->iter_) {
+    auto reader = context->engine_->Reader();
 
-  IteratorOptions options;
-  options.upper_bound = context->range_.end_key();
+    IteratorOptions options;
+    options.upper_bound = context->range_.end_key();
 
-  context->iter_ = reader->NewIterator(context->cf_name_, options);
-  if (!context->iter_) {
-    context->state_ = ScanState::kError;
-    DINGO_LOG(ERROR) << fmt::format("RawEngine::Reader::NewIterator failed");
-    return butil::Status(pb::error::EINTERNAL, "Internal error : create iter failed");
+    context->iter_ = reader->NewIterator(context->cf_name_, options);
+    if (!context->iter_) {
+      context->state_ = ScanState::kError;
+      DINGO_LOG(ERROR) << fmt::format("RawEngine::Reader::NewIterator failed");
+      return butil::Status(pb::error::EINTERNAL, "Internal error : create iter failed");
+    }
+    context->iter_->Seek(context->range_.start_key());
   }
-  context->iter_->Seek(context->range_.start_key());
 
   if (context->max_fetch_cnt_ > 0) {
     bool has_more = false;
@@ -541,4 +571,161 @@ butil::Status ScanHandler::ScanRelease(std::shared_ptr<ScanContext> context,
   return butil::Status();
 }
 
+std::vector<pb::common::Range> ScanHandler::SplitRange(std::shared_ptr<RawEngine> engine, const std::string& cf_name,
+                                                       const pb::common::Range& range, int count, int64_t min_size) {
+  std::vector<pb::common::Range> ranges = {range};
+  if (count <= 1) {
+    return ranges;
+  }
+
+  // Halve the ranges by key until enough candidates, the range too narrow to halve is kept.
+  while (static_cast<int>(ranges.size()) < count * kSplitRangeCandidateFactor) {
+    std::vector<pb::common::Range> halves;
+    for (const auto& sub_range : ranges) {
+      auto diff = Helper::StringSubtract(sub_range.start_key(), sub_range.end_key());
+      auto mid = Helper::StringAdd(sub_range.start_key(), Helper::StringDivideByTwo(diff));
+      auto middle_key = mid.substr(1, mid.size() - 1);
+      if (sub_range.start_key() < middle_key && middle_key < sub_range.end_key()) {
+        auto& left = halves.emplace_back();
+        left.set_start_key(sub_range.start_key());
+        left.set_end_key(middle_key);
+        auto& right = halves.emplace_back();
+        right.set_start_key(middle_key);
+        right.set_end_key(sub_range.end_key());
+      } else {
+        halves.push_back(sub_range);
+      }
+    }
+    if (halves.size() == ranges.size()) {
+      break;
+    }
+    ranges.swap(halves);
+  }
+
+  auto sizes = engine->GetApproximateSizes(cf_name, ranges);
+  if (sizes.size() != ranges.size()) {
+    return {range};
+  }
+
+  return MergeRangeBySize(ranges, sizes, count, min_size);
+}
+
+std::vector<pb::common::Range> ScanHandler::MergeRangeBySize(const std::vector<pb::common::Range>& ranges,
+                                                             const std::vector<int64_t>& sizes, int count,
+                                                             int64_t min_size) {
+  // Split by the count of candidates if the sizes are not available.
+  int64_t total_size = std::accumulate(sizes.begin(), sizes.end(), static_cast<int64_t>(0));
+  bool has_size = total_size > 0;
+  if (!has_size) {
+    total_size = static_cast<int64_t>(ranges.size());
+  }
+  int64_t target_size = std::max(total_size / std::max(count, 1), min_size);
+
+  std::vector<pb::common::Range> merged_ranges;
+  std::vector<int64_t> merged_sizes;
+  int64_t prefix_size = 0;
+  for (size_t i = 0; i < ranges.size() && i < sizes.size(); ++i) {
+    int64_t size = has_size ? sizes[i] : 1;
+    // Start the next one at the range whose middle is over the target boundary.
+    int64_t boundary = target_size * static_cast<int64_t>(merged_ranges.size());
+    if (merged_ranges.empty() || (static_cast<int>(merged_ranges.size()) < count &&
+                                  merged_sizes.back() >= min_size && prefix_size + size / 2 >= boundary)) {
+      merged_ranges.push_back(ranges[i]);
+      merged_sizes.push_back(size);
+    } else {
+      merged_ranges.back().set_end_key(ranges[i].end_key());
+      merged_sizes.back() += size;
+    }
+    prefix_size += size;
+  }
+
+  // The tail less than min_size is merged into the previous one.
+  if (merged_ranges.size() > 1 && merged_sizes.back() < min_size) {
+    merged_ranges[merged_ranges.size() - 2].set_end_key(merged_ranges.back().end_key());
+    merged_ranges.pop_back();
+  }
+
+  return merged_ranges;
+}
+
+butil::Status ScanHandler::ParallelAggregate(std::shared_ptr<ScanContext> context,
+                                             const CoprocessorPbWrapper& coprocessor) {
+  auto main_coprocessor = std::dynamic_pointer_cast<Coprocessor>(context->coprocessor_);
+  if (main_coprocessor == nullptr || !main_coprocessor->IsAggregation() || FLAGS_coprocessor_scan_parallelism <= 1 ||
+      context->range_.start_key() >= context->range_.end_key()) {
+    return butil::Status();
+  }
+
+  auto sub_ranges = SplitRange(context->engine_, context->cf_name_, context->range_,
+                               FLAGS_coprocessor_scan_parallelism, FLAGS_coprocessor_parallel_scan_min_size);
+  if (sub_ranges.size() <= 1) {
+    return butil::Status();
+  }
+
+  // All sub ranges read the same snapshot.
+  auto snapshot = context->engine_->GetSnapshot();
+  auto reader = context->engine_->Reader();
+  std::vector<IteratorPtr> iters;
+  std::vector<std::shared_ptr<Coprocessor>> coprocessors;
+  for (const auto& sub_range : sub_ranges) {
+    IteratorOptions options;
+    options.upper_bound = sub_range.end_key();
+    auto iter = reader->NewIterator(context->cf_name_, snapshot, options);
+    if (!iter) {
+      DINGO_LOG(ERROR) << fmt::format("RawEngine::Reader::NewIterator failed");
+      return butil::Status(pb::error::EINTERNAL, "Internal error : create iter failed");
+    }
+    iter->Seek(sub_range.start_key());
+    iters.push_back(iter);
+
+    if (coprocessors.empty()) {
+      coprocessors.push_back(main_coprocessor);
+      continue;
+    }
+    auto sub_coprocessor = std::make_shared<Coprocessor>();
+    butil::Status status = sub_coprocessor->Open(coprocessor);
+    if (!status.ok()) {
+      DINGO_LOG(ERROR) << fmt::format("Coprocessor::Open failed");
+      return status;
+    }
+    coprocessors.push_back(sub_coprocessor);
+  }
+
+  // The first sub range is aggregated by the current thread.
+  std::vector<butil::Status> statuses(sub_ranges.size());
+  std::vector<Bthread> workers;
+  workers.reserve(sub_ranges.size());
+  for (size_t i = 1; i < sub_ranges.size(); ++i) {
+    workers.emplace_back(
+        [&statuses, &coprocessors, &iters, i]() { statuses[i] = coprocessors[i]->Aggregate(iters[i]); });
+  }
+  statuses[0] = main_coprocessor->Aggregate(iters[0]);
+  for (auto& worker : workers) {
+    worker.Join();
+  }
+
+  for (size_t i = 0; i < sub_ranges.size(); ++i) {
+    if (!statuses[i].ok()) {
+      return statuses[i];
+    }
+    if (i > 0) {
+      butil::Status status = main_coprocessor->MergeAggregation(*coprocessors[i]);
+      if (!status.ok()) {
+        DINGO_LOG(ERROR) << fmt::format("Coprocessor::MergeAggregation failed");
+        return status;
+      }
+    }
+  }
+
+  g_coprocessor_parallel_scan_count << 1;
+  g_coprocessor_parallel_scan_degree << static_cast<int64_t>(sub_ranges.size());
+  DINGO_LOG(DEBUG) << fmt::format("[scan.parallel][region({})] aggregate {} sub ranges", context->region_id_,
+                                  sub_ranges.size());
+
+  // Exhausted, only the aggregation result is output.
+  context->iter_ = iters[0];
+
+  return butil::Status();
+}
+
 }  // namespace dingodb
@@ -160,6 +160,21 @@ class ScanHandler {
                                     int64_t max_fetch_cnt, std::vector<pb::common::KeyValue>* kvs, bool& has_more);
 
   static butil::Status ScanRelease(std::shared_ptr<ScanContext> context, [[maybe_unused]] const std::string& scan_id);
+
+  // Split range into at most count contiguous sub ranges of similar approximate size, each not less than min_size.
+  static std::vector<pb::common::Range> SplitRange(std::shared_ptr<RawEngine> engine, const std::string& cf_name,
+                                                   const pb::common::Range& range, int count, int64_t min_size);
+
+  // Merge the adjacent ranges by their approximate sizes, used by SplitRange.
+  static std::vector<pb::common::Range> MergeRangeBySize(const std::vector<pb::common::Range>& ranges,
+                                                         const std::vector<int64_t>& sizes, int count,
+                                                         int64_t min_size);
+
+ private:
+  // Aggregate the sub ranges of the region in parallel and merge into the coprocessor of context, then the
+  // iterator of context is exhausted and only the aggregation result is output.
+  // Only the v1 Coprocessor of ScanBegin, the CoprocessorV2 and the txn scan are always aggregated serially.
+  static butil::Status ParallelAggregate(std::shared_ptr<ScanContext> context, const CoprocessorPbWrapper& coprocessor);
 };
 
 }  // namespace dingodb
@@ -0,0 +1,179 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "scan/scan_stream.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "brpc/controller.h"
+#include "brpc/stream.h"
+#include "butil/iobuf.h"
+#include "butil/time.h"
+#include "bvar/reducer.h"
+#include "common/logging.h"
+#include "common/packed_kv.h"
+#include "common/synchronization.h"
+#include "fmt/core.h"
+#include "gflags/gflags.h"
+#include "proto/error.pb.h"
+#include "scan/scan_manager.h"
+
+namespace dingodb {
+
+DEFINE_int64(scan_stream_batch_size, 1024, "default max kvs of every stream scan message");
+DEFINE_int64(scan_stream_window_size, 2 * 1024 * 1024, "default bytes pushed but not consumed of a stream scan");
+DEFINE_int64(scan_stream_max_window_size, 64 * 1024 * 1024, "max bytes pushed but not consumed of a stream scan");
+
+bvar::Adder<int64_t> g_scan_stream_count("dingo_scan_stream_count");
+bvar::Adder<int64_t> g_scan_stream_running("dingo_scan_stream_running");
+bvar::Adder<int64_t> g_scan_stream_window_wait_count("dingo_scan_stream_window_wait_count");
+bvar::Adder<int64_t> g_scan_stream_timeout_count("dingo_scan_stream_timeout_count");
+
+ScanStream::ScanStream(std::shared_ptr<ScanContext> scan, const std::string& scan_id, int64_t batch_size)
+    : scan_(std::move(scan)),
+      scan_id_(scan_id),
+      batch_size_(batch_size),
+      timeout_ms_(ScanManager::GetInstance().GetTimeoutMs()),
+      stream_id_(brpc::INVALID_STREAM_ID),
+      closed_(false) {
+  g_scan_stream_running << 1;
+}
+
+ScanStream::~ScanStream() { g_scan_stream_running << -1; }
+
+butil::Status ScanStream::Start(brpc::Controller* cntl, std::shared_ptr<ScanContext> scan, const std::string& scan_id,
+                                int64_t batch_size, int64_t window_size) {
+  if (batch_size <= 0) {
+    batch_size = FLAGS_scan_stream_batch_size;
+  }
+  if (window_size <= 0) {
+    window_size = FLAGS_scan_stream_window_size;
+  }
+
+  auto stream = std::make_shared<ScanStream>(std::move(scan), scan_id, batch_size);
+
+  brpc::StreamOptions options;
+  options.handler = stream.get();
+  options.max_buf_size = std::min(window_size, FLAGS_scan_stream_max_window_size);
+  if (brpc::StreamAccept(&stream->stream_id_, *cntl, &options) != 0) {
+    std::string s = fmt::format("scan stream {} accept failed, the request has no stream", scan_id);
+    DINGO_LOG(ERROR) << s;
+    return butil::Status(pb::error::EILLEGAL_PARAMTETERS, s);
+  }
+
+  // The messages written before the response are sent after the stream is connected.
+  stream->self_ = stream;
+  g_scan_stream_count << 1;
+  Bthread bth(&BTHREAD_ATTR_NORMAL);
+  bth.Run([stream]() { stream->Run(); });
+
+  return butil::Status();
+}
+
+int ScanStream::on_received_messages(brpc::StreamId /*id*/, butil::IOBuf* const /*messages*/[], size_t /*size*/) {
+  // The client only consumes.
+  return 0;
+}
+
+void ScanStream::on_idle_timeout(brpc::StreamId id) {
+  // idle_timeout_ms is left unset as the client never sends, the window wait of Write has the deadline instead.
+  DINGO_LOG(WARNING) << fmt::format("scan stream {} stream_id {} idle timeout", scan_id_, id);
+  brpc::StreamClose(id);
+}
+
+void ScanStream::on_closed(brpc::StreamId id) {
+  DINGO_LOG(DEBUG) << fmt::format("scan stream {} stream_id {} closed", scan_id_, id);
+  closed_.store(true);
+  // The last callback of the stream, the running bthread holds its own reference.
+  self_.reset();
+}
+
+void ScanStream::Run() {
+  // Nothing to scan.
+  if (scan_ == nullptr) {
+    pb::store::KvScanStreamMessage message;
+    message.set_has_more(false);
+    Write(message);
+    brpc::StreamClose(stream_id_);
+    return;
+  }
+
+  while (!closed_.load()) {
+    std::vector<pb::common::KeyValue> kvs;
+    bool has_more = false;
+    butil::Status status = ScanHandler::ScanContinue(scan_, scan_id_, batch_size_, &kvs, has_more);
+
+    pb::store::KvScanStreamMessage message;
+    if (!status.ok()) {
+      DINGO_LOG(ERROR) << fmt::format("scan stream {} failed, error: {}", scan_id_, status.error_str());
+      message.mutable_error()->set_errcode(static_cast<pb::error::Errno>(status.error_code()));
+      message.mutable_error()->set_errmsg(status.error_str());
+    } else {
+      PackedKv::Encode(kvs, *message.mutable_packed_kvs());
+      message.set_packed_kv_count(kvs.size());
+      message.set_has_more(has_more);
+    }
+
+    if (!Write(message) || !status.ok() || !has_more) {
+      break;
+    }
+  }
+
+  // The scan context is released with the last reference of this stream.
+  brpc::StreamClose(stream_id_);
+}
+
+bool ScanStream::Write(const pb::store::KvScanStreamMessage& message) {
+  butil::IOBuf buf;
+  butil::IOBufAsZeroCopyOutputStream output(&buf);
+  if (!message.SerializeToZeroCopyStream(&output)) {
+    DINGO_LOG(ERROR) << fmt::format("scan stream {} serialize message failed", scan_id_);
+    return false;
+  }
+
+  while (true) {
+    int ret = brpc::StreamWrite(stream_id_, buf);
+    if (ret == 0) {
+      return true;
+    }
+    if (ret != EAGAIN) {
+      // EINVAL means the stream is closed by the client.
+      DINGO_LOG(INFO) << fmt::format("scan stream {} write failed, ret: {}", scan_id_, ret);
+      return false;
+    }
+
+    // The client is slower than the scan.
+    g_scan_stream_window_wait_count << 1;
+    timespec due_time = butil::milliseconds_from_now(timeout_ms_);
+    ret = brpc::StreamWait(stream_id_, &due_time);
+    if (ret == ETIMEDOUT) {
+      // The client holds the stream but stops consuming, the caller closes the stream.
+      g_scan_stream_timeout_count << 1;
+      DINGO_LOG(WARNING) << fmt::format("scan stream {} not consumed in {}ms, close it", scan_id_, timeout_ms_);
+      return false;
+    }
+    if (ret != 0) {
+      return false;
+    }
+  }
+}
+
+}  // namespace dingodb
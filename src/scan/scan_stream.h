@@ -0,0 +1,73 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGODB_SCAN_SCAN_STREAM_H_  // NOLINT
+#define DINGODB_SCAN_SCAN_STREAM_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "brpc/controller.h"
+#include "brpc/stream.h"
+#include "butil/status.h"
+#include "proto/store.pb.h"
+#include "scan/scan.h"
+
+namespace dingodb {
+
+// Server push scan over brpc streaming rpc, the scan context is owned by the stream instead of ScanManager.
+// The batches are pushed by a bthread, the next batch is scanned while the previous one is in flight, and the
+// writer only waits when the flow control window of the stream is full. The stream is closed if the client does
+// not consume within the scan timeout of ScanManager, which releases the scan context as the recycling does.
+class ScanStream : public brpc::StreamInputHandler, public std::enable_shared_from_this<ScanStream> {
+ public:
+  ScanStream(std::shared_ptr<ScanContext> scan, const std::string& scan_id, int64_t batch_size);
+  ~ScanStream() override;
+
+  ScanStream(const ScanStream& rhs) = delete;
+  ScanStream& operator=(const ScanStream& rhs) = delete;
+  ScanStream(ScanStream&& rhs) = delete;
+  ScanStream& operator=(ScanStream&& rhs) = delete;
+
+  // Accept the stream created by the client with the request, must be called before the response is sent.
+  // scan is nullptr if there is nothing to scan, window_size <= 0 means the default window.
+  static butil::Status Start(brpc::Controller* cntl, std::shared_ptr<ScanContext> scan, const std::string& scan_id,
+                             int64_t batch_size, int64_t window_size);
+
+  int on_received_messages(brpc::StreamId id, butil::IOBuf* const messages[], size_t size) override;
+  void on_idle_timeout(brpc::StreamId id) override;
+  void on_closed(brpc::StreamId id) override;
+
+ private:
+  void Run();
+
+  // Wait for the window if it is full, return false if the stream is closed or the wait timed out.
+  bool Write(const pb::store::KvScanStreamMessage& message);
+
+  std::shared_ptr<ScanContext> scan_;
+  std::string scan_id_;
+  int64_t batch_size_;
+  int64_t timeout_ms_;
+  brpc::StreamId stream_id_;
+  std::atomic<bool> closed_;
+  // Keep alive until the stream is closed.
+  std::shared_ptr<ScanStream> self_;
+};
+
+}  // namespace dingodb
+
+#endif  // DINGODB_SCAN_SCAN_STREAM_H_  // NOLINT
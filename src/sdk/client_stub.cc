@@ -17,6 +17,7 @@
 #include "sdk/common/param_config.h"
 #include "sdk/meta_cache.h"
 #include "sdk/rawkv/region_scanner_impl.h"
+#include "sdk/rawkv/region_stream_scanner_impl.h"
 #include "sdk/status.h"
 #include "sdk/transaction/txn_lock_resolver.h"
 #include "sdk/transaction/txn_region_scanner_impl.h"
@@ -43,7 +44,11 @@ Status ClientStub::Open(std::string naming_service_url) {
 
   meta_cache_.reset(new MetaCache(coordinator_proxy_));
 
-  region_scanner_factory_.reset(new RegionScannerFactoryImpl());
+  if (kRawkvStreamScan) {
+    region_scanner_factory_.reset(new RegionStreamScannerFactoryImpl());
+  } else {
+    region_scanner_factory_.reset(new RegionScannerFactoryImpl());
+  }
 
   txn_region_scanner_factory_.reset(new TxnRegionScannerFactoryImpl());
 
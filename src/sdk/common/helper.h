@@ -15,8 +15,15 @@
 #ifndef DINGODB_SDK_HELPER_H_
 #define DINGODB_SDK_HELPER_H_
 
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "common/logging.h"
+#include "common/packed_kv.h"
+#include "fmt/core.h"
 #include "glog/logging.h"
+#include "sdk/client.h"
 #include "sdk/client_stub.h"
 #include "sdk/store/store_rpc_controller.h"
 
@@ -31,6 +38,33 @@ static Status LogAndSendRpc(const ClientStub& stub, StoreClientRpc& rpc, std::sh
   return s;
 }
 
+// Read the scanned kvs of the response, packed in the response attachment or the repeated kvs.
+template <class StoreClientRpc>
+static Status GetScanResponseKvs(const StoreClientRpc& rpc, std::vector<KVPair>& kvs) {
+  const auto* response = rpc.Response();
+  kvs.clear();
+  if (response->packed_kv_count() == 0) {
+    kvs.reserve(response->kvs_size());
+    for (const auto& kv : response->kvs()) {
+      kvs.push_back({kv.key(), kv.value()});
+    }
+    return Status::OK();
+  }
+
+  const butil::IOBuf& attachment = rpc.Controller()->response_attachment();
+  std::vector<std::pair<std::string, std::string>> packed_kvs;
+  if (!PackedKv::Decode(attachment, response->packed_kv_count(), packed_kvs)) {
+    return Status::Corruption(fmt::format("packed kvs corrupted, count:{} attachment size:{}",
+                                          response->packed_kv_count(), attachment.size()));
+  }
+
+  kvs.reserve(packed_kvs.size());
+  for (auto& [key, value] : packed_kvs) {
+    kvs.push_back({std::move(key), std::move(value)});
+  }
+  return Status::OK();
+}
+
 }  // namespace sdk
 
 }  // namespace dingodb
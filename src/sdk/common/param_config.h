@@ -36,6 +36,15 @@ const int64_t kScanBatchSize = 10;
 const int64_t kMinScanBatchSize = 1;
 
 const int64_t kMaxScanBatchSize = 100;
+
+// ask the store to pack the scanned kvs in the response attachment
+const bool kScanPackedKvs = true;
+
+// scan the raw kv regions by the store pushed stream, the store must support KvScanStream
+const bool kRawkvStreamScan = false;
+
+// bytes pushed by the store but not consumed by the stream scanner
+const int64_t kScanStreamWindowSize = 2 * 1024 * 1024;
 // end: use for region scanner
 
 const int64_t kPrefetchRegionCount = 3;
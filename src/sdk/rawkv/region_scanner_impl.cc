@@ -17,6 +17,7 @@
 
 #include "fmt/core.h"
 #include "sdk/common/common.h"
+#include "sdk/common/helper.h"
 #include "sdk/common/param_config.h"
 #include "sdk/store/store_rpc_controller.h"
 #include "sdk/utils/async_util.h"
@@ -100,6 +101,7 @@ void RegionScannerImpl::PrepareScanContinueRpc(KvScanContinueRpc& rpc) {
   FillRpcContext(*request->mutable_context(), region->RegionId(), region->Epoch());
   request->set_scan_id(scan_id_);
   request->set_max_fetch_cnt(batch_size_);
+  request->set_packed_kvs(kScanPackedKvs);
 }
 
 void RegionScannerImpl::AsyncNextBatch(std::vector<KVPair>& kvs, StatusCallback cb) {
@@ -116,16 +118,21 @@ void RegionScannerImpl::AsyncNextBatch(std::vector<KVPair>& kvs, StatusCallback
 
 void RegionScannerImpl::KvScanContinueRpcCallback(Status status, StoreRpcController* controller, KvScanContinueRpc* rpc,
                                                   std::vector<KVPair>& kvs, StatusCallback cb) {
+  std::vector<KVPair> scan_kvs;
+  if (status.ok()) {
+    status = GetScanResponseKvs(*rpc, scan_kvs);
+  }
+
   if (status.ok()) {
-    const auto* response = rpc->Response();
     std::vector<KVPair> tmp_kvs;
-    if (response->kvs_size() == 0) {
+    if (scan_kvs.empty()) {
       // scan to region end_key
       has_more_ = false;
     } else {
-      for (const auto& kv : response->kvs()) {
-        if (kv.key() < end_key_) {
-          tmp_kvs.push_back({kv.key(), kv.value()});
+      tmp_kvs.reserve(scan_kvs.size());
+      for (auto& kv : scan_kvs) {
+        if (kv.key < end_key_) {
+          tmp_kvs.push_back(std::move(kv));
         } else {
           has_more_ = false;
         }
@@ -0,0 +1,268 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "sdk/rawkv/region_stream_scanner_impl.h"
+
+#include <memory>
+#include <mutex>
+#include <string_view>
+
+#include "common/packed_kv.h"
+#include "fmt/core.h"
+#include "sdk/common/common.h"
+#include "sdk/common/param_config.h"
+#include "sdk/store/store_rpc_controller.h"
+
+namespace dingodb {
+namespace sdk {
+
+ScanStreamReceiver::ScanStreamReceiver(int64_t max_queued_bytes)
+    : max_queued_bytes_(max_queued_bytes), queued_bytes_(0), blocked_count_(0) {}
+
+int ScanStreamReceiver::on_received_messages(brpc::StreamId id, butil::IOBuf* const messages[], size_t size) {
+  std::unique_lock<bthread::Mutex> lk(mutex_);
+  if (queued_bytes_ >= max_queued_bytes_ && closing_ids_.count(id) == 0) {
+    ++blocked_count_;
+    cv_.notify_all();
+  }
+  while (queued_bytes_ >= max_queued_bytes_ && closing_ids_.count(id) == 0) {
+    cv_.wait(lk);
+  }
+  if (closing_ids_.count(id) > 0) {
+    return 0;
+  }
+
+  for (size_t i = 0; i < size; ++i) {
+    butil::IOBuf message;
+    message.swap(*messages[i]);
+    queued_bytes_ += message.size();
+    messages_.emplace_back(id, std::move(message));
+  }
+  cv_.notify_all();
+  return 0;
+}
+
+void ScanStreamReceiver::on_idle_timeout(brpc::StreamId /*id*/) {}
+
+void ScanStreamReceiver::on_closed(brpc::StreamId id) {
+  std::unique_lock<bthread::Mutex> lk(mutex_);
+  closed_ids_.insert(id);
+  cv_.notify_all();
+}
+
+bool ScanStreamReceiver::Pop(brpc::StreamId id, butil::IOBuf& message) {
+  std::unique_lock<bthread::Mutex> lk(mutex_);
+  while (true) {
+    while (!messages_.empty()) {
+      auto& front = messages_.front();
+      queued_bytes_ -= front.second.size();
+      // Wake up the blocked on_received_messages.
+      cv_.notify_all();
+      if (front.first == id) {
+        message.swap(front.second);
+        messages_.pop_front();
+        return true;
+      }
+      messages_.pop_front();
+    }
+
+    if (closed_ids_.count(id) > 0) {
+      return false;
+    }
+    cv_.wait(lk);
+  }
+}
+
+void ScanStreamReceiver::WaitClosed(const std::vector<brpc::StreamId>& ids) {
+  std::unique_lock<bthread::Mutex> lk(mutex_);
+  // on_closed is called after the blocked on_received_messages returns.
+  closing_ids_.insert(ids.begin(), ids.end());
+  messages_.clear();
+  queued_bytes_ = 0;
+  cv_.notify_all();
+
+  for (auto id : ids) {
+    while (closed_ids_.count(id) == 0) {
+      cv_.wait(lk);
+    }
+  }
+}
+
+void ScanStreamReceiver::TEST_WaitBlocked(int64_t count) {  // NOLINT
+  std::unique_lock<bthread::Mutex> lk(mutex_);
+  while (blocked_count_ < count) {
+    cv_.wait(lk);
+  }
+}
+
+RegionStreamScannerImpl::RegionStreamScannerImpl(const ClientStub& stub, std::shared_ptr<Region> region,
+                                                 std::string start_key, std::string end_key)
+    : RegionScanner(stub, std::move(region)),
+      start_key_(std::move(start_key)),
+      end_key_(std::move(end_key)),
+      batch_size_(kScanBatchSize),
+      opened_(false),
+      has_more_(false),
+      receiver_(kScanStreamWindowSize),
+      stream_id_(brpc::INVALID_STREAM_ID) {}
+
+RegionStreamScannerImpl::~RegionStreamScannerImpl() { Close(); }
+
+void RegionStreamScannerImpl::PrepareScanStreamRpc(KvScanStreamRpc& rpc) {
+  auto* request = rpc.MutableRequest();
+  FillRpcContext(*request->mutable_context(), region->RegionId(), region->Epoch());
+  auto* range_with_option = request->mutable_range();
+  range_with_option->mutable_range()->set_start_key(start_key_);
+  range_with_option->mutable_range()->set_end_key(end_key_);
+  range_with_option->set_with_start(true);
+  range_with_option->set_with_end(false);
+
+  request->set_batch_size(batch_size_);
+  request->set_key_only(false);
+  request->set_window_size(kScanStreamWindowSize);
+
+  brpc::StreamOptions options;
+  options.handler = &receiver_;
+  rpc.SetStreamOptions(options);
+}
+
+Status RegionStreamScannerImpl::Open() {
+  CHECK(!opened_);
+  KvScanStreamRpc rpc;
+  PrepareScanStreamRpc(rpc);
+
+  StoreRpcController controller(stub, rpc, region);
+  Status call = controller.Call();
+  stream_ids_ = rpc.GetStreamIds();
+  if (call.IsOK()) {
+    CHECK(!stream_ids_.empty());
+    stream_id_ = stream_ids_.back();
+    has_more_ = true;
+    opened_ = true;
+  } else {
+    DINGO_LOG(WARNING) << "open stream scanner for region:" << region->RegionId() << ", fail:" << call.ToString();
+    CloseStreams();
+  }
+
+  return call;
+}
+
+void RegionStreamScannerImpl::CloseStreams() {
+  // The handler must outlive the streams, so wait for all of them closed.
+  for (auto id : stream_ids_) {
+    brpc::StreamClose(id);
+  }
+  receiver_.WaitClosed(stream_ids_);
+  stream_ids_.clear();
+  stream_id_ = brpc::INVALID_STREAM_ID;
+}
+
+void RegionStreamScannerImpl::Close() {
+  if (opened_) {
+    // The store stops scanning when the stream is closed by the client.
+    CloseStreams();
+    opened_ = false;
+  }
+}
+
+bool RegionStreamScannerImpl::HasMore() const { return has_more_; }
+
+Status RegionStreamScannerImpl::NextBatch(std::vector<KVPair>& kvs) {
+  CHECK(opened_);
+  kvs.clear();
+  if (!has_more_) {
+    return Status::OK();
+  }
+
+  butil::IOBuf buf;
+  if (!receiver_.Pop(stream_id_, buf)) {
+    has_more_ = false;
+    std::string msg = fmt::format("scan stream of region:{} closed before the scan finished", region->RegionId());
+    DINGO_LOG(WARNING) << msg;
+    return Status::Aborted(msg);
+  }
+
+  pb::store::KvScanStreamMessage message;
+  butil::IOBufAsZeroCopyInputStream input(buf);
+  if (!message.ParseFromZeroCopyStream(&input)) {
+    has_more_ = false;
+    return Status::Corruption(fmt::format("scan stream of region:{} parse message fail", region->RegionId()));
+  }
+
+  if (message.error().errcode() != pb::error::Errno::OK) {
+    has_more_ = false;
+    DINGO_LOG(WARNING) << "scan stream of region:" << region->RegionId() << " fail, error:" << message.error().errmsg();
+    return Status::Incomplete(message.error().errcode(), message.error().errmsg());
+  }
+
+  std::vector<std::pair<std::string_view, std::string_view>> packed_kvs;
+  if (!PackedKv::Decode(message.packed_kvs(), message.packed_kv_count(), packed_kvs)) {
+    has_more_ = false;
+    return Status::Corruption(fmt::format("packed kvs corrupted, count:{} size:{}", message.packed_kv_count(),
+                                          message.packed_kvs().size()));
+  }
+
+  has_more_ = message.has_more();
+  kvs.reserve(packed_kvs.size());
+  for (const auto& [key, value] : packed_kvs) {
+    if (key < end_key_) {
+      kvs.push_back({std::string(key), std::string(value)});
+    } else {
+      has_more_ = false;
+    }
+  }
+
+  return Status::OK();
+}
+
+void RegionStreamScannerImpl::AsyncNextBatch(std::vector<KVPair>& kvs, StatusCallback cb) {
+  CHECK(opened_);
+  stub.GetActuator()->Execute([this, &kvs, cb] { cb(NextBatch(kvs)); });
+}
+
+Status RegionStreamScannerImpl::SetBatchSize(int64_t size) {
+  int64_t to_size = size;
+  if (size <= kMinScanBatchSize) {
+    to_size = kMinScanBatchSize;
+  }
+
+  if (size > kMaxScanBatchSize) {
+    to_size = kMaxScanBatchSize;
+  }
+
+  batch_size_ = to_size;
+  return Status::OK();
+}
+
+RegionStreamScannerFactoryImpl::RegionStreamScannerFactoryImpl() = default;
+
+RegionStreamScannerFactoryImpl::~RegionStreamScannerFactoryImpl() = default;
+
+Status RegionStreamScannerFactoryImpl::NewRegionScanner(const ScannerOptions& options,
+                                                        std::shared_ptr<RegionScanner>& scanner) {
+  CHECK(options.start_key < options.end_key);
+  CHECK(options.start_key >= options.region->Range().start_key())
+      << fmt::format("start_key:{} should greater than region range start_key:{}", options.start_key,
+                     options.region->Range().start_key());
+  CHECK(options.end_key <= options.region->Range().end_key()) << fmt::format(
+      "end_key:{} should little than region range end_key:{}", options.end_key, options.region->Range().end_key());
+
+  std::shared_ptr<RegionScanner> tmp(
+      new RegionStreamScannerImpl(options.stub, options.region, options.start_key, options.end_key));
+  scanner = std::move(tmp);
+
+  return Status::OK();
+}
+
+}  // namespace sdk
+}  // namespace dingodb
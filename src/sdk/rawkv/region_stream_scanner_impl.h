@@ -0,0 +1,129 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGODB_SDK_REGION_STREAM_SCANNER_IMPL_H_
+#define DINGODB_SDK_REGION_STREAM_SCANNER_IMPL_H_
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "brpc/stream.h"
+#include "bthread/condition_variable.h"
+#include "bthread/mutex.h"
+#include "butil/iobuf.h"
+#include "sdk/client.h"
+#include "sdk/client_stub.h"
+#include "sdk/region.h"
+#include "sdk/region_scanner.h"
+#include "sdk/store/store_rpc.h"
+
+namespace dingodb {
+namespace sdk {
+
+// Queue the messages pushed by the store until the scanner consumes them.
+// The stream only gives the window back to the store when on_received_messages returns, so it blocks while
+// max_queued_bytes are queued, and the store waits for the window until the scanner catches up.
+// on_received_messages runs in a brpc bthread, so it waits on the bthread primitives to not block its worker.
+class ScanStreamReceiver : public brpc::StreamInputHandler {
+ public:
+  explicit ScanStreamReceiver(int64_t max_queued_bytes);
+  ~ScanStreamReceiver() override = default;
+
+  int on_received_messages(brpc::StreamId id, butil::IOBuf* const messages[], size_t size) override;
+  void on_idle_timeout(brpc::StreamId id) override;
+  void on_closed(brpc::StreamId id) override;
+
+  // Wait for the next message of the stream, return false if the stream is closed and no message left.
+  // The messages of the other streams, e.g. created by a failed send, are dropped.
+  bool Pop(brpc::StreamId id, butil::IOBuf& message);
+
+  // Drop the queued and the blocked messages of the streams, then wait for them closed.
+  void WaitClosed(const std::vector<brpc::StreamId>& ids);
+
+  // Wait until on_received_messages has been blocked by the full queue count times.
+  void TEST_WaitBlocked(int64_t count);  // NOLINT
+
+ private:
+  const int64_t max_queued_bytes_;
+  bthread::Mutex mutex_;
+  bthread::ConditionVariable cv_;
+  std::deque<std::pair<brpc::StreamId, butil::IOBuf>> messages_;
+  int64_t queued_bytes_;
+  int64_t blocked_count_;
+  std::set<brpc::StreamId> closing_ids_;
+  std::set<brpc::StreamId> closed_ids_;
+};
+
+// The store pushes the batches through KvScanStream, so the next batch is already in flight when it is consumed.
+class RegionStreamScannerImpl : public RegionScanner {
+ public:
+  explicit RegionStreamScannerImpl(const ClientStub& stub, std::shared_ptr<Region> region, std::string start_key,
+                                   std::string end_key);
+
+  ~RegionStreamScannerImpl() override;
+
+  Status Open() override;
+
+  void Close() override;
+
+  Status NextBatch(std::vector<KVPair>& kvs) override;
+
+  void AsyncNextBatch(std::vector<KVPair>& kvs, StatusCallback cb) override;
+
+  bool HasMore() const override;
+
+  Status SetBatchSize(int64_t size) override;
+
+  int64_t GetBatchSize() const override { return batch_size_; }
+
+  bool TEST_IsOpen() {  // NOLINT
+    return opened_;
+  }
+
+  ScanStreamReceiver& TEST_GetReceiver() {  // NOLINT
+    return receiver_;
+  }
+
+ private:
+  void PrepareScanStreamRpc(KvScanStreamRpc& rpc);
+
+  void CloseStreams();
+
+  std::string start_key_;
+  std::string end_key_;
+  int64_t batch_size_;
+  bool opened_;
+  bool has_more_;
+  ScanStreamReceiver receiver_;
+  std::vector<brpc::StreamId> stream_ids_;
+  brpc::StreamId stream_id_;
+};
+
+class RegionStreamScannerFactoryImpl final : public RegionScannerFactory {
+ public:
+  RegionStreamScannerFactoryImpl();
+
+  ~RegionStreamScannerFactoryImpl() override;
+
+  Status NewRegionScanner(const ScannerOptions& options, std::shared_ptr<RegionScanner>& scanner) override;
+};
+
+}  // namespace sdk
+}  // namespace dingodb
+#endif  // DINGODB_SDK_REGION_STREAM_SCANNER_IMPL_H_
@@ -43,6 +43,26 @@ DEFINE_STORE_RPC(KvScanBegin);
 DEFINE_STORE_RPC(KvScanContinue);
 DEFINE_STORE_RPC(KvScanRelease);
 
+KvScanStreamRpc::KvScanStreamRpc() : KvScanStreamRpc("") {}
+KvScanStreamRpc::KvScanStreamRpc(const std::string& cmd) : ClientRpc(cmd) {}
+KvScanStreamRpc::~KvScanStreamRpc() = default;
+
+void KvScanStreamRpc::Send(StoreService_Stub& stub, google::protobuf::Closure* done) {
+  // The controller is reset before every send, the stream must be created after that.
+  brpc::StreamId stream_id;
+  if (brpc::StreamCreate(&stream_id, *MutableController(), &stream_options_) != 0) {
+    MutableController()->SetFailed("create scan stream fail");
+    done->Run();
+    return;
+  }
+  stream_ids_.push_back(stream_id);
+  stub.KvScanStream(MutableController(), request, response, done);
+}
+
+std::string KvScanStreamRpc::ConstMethod() {
+  return fmt::format("{}.{}Rpc", StoreService::descriptor()->name(), "KvScanStream");
+}
+
 DEFINE_STORE_RPC(TxnGet);
 DEFINE_STORE_RPC(TxnBatchGet);
 DEFINE_STORE_RPC(TxnPrewrite);
@@ -15,6 +15,10 @@
 #ifndef DINGODB_SDK_STORE_RPC_H_
 #define DINGODB_SDK_STORE_RPC_H_
 
+#include <string>
+#include <vector>
+
+#include "brpc/stream.h"
 #include "proto/store.pb.h"
 #include "sdk/rpc/rpc.h"
 
@@ -52,6 +56,33 @@ DECLARE_STORE_RPC(KvScanBegin);
 DECLARE_STORE_RPC(KvScanContinue);
 DECLARE_STORE_RPC(KvScanRelease);
 
+// The client stream is created with the request, so a retried send creates a new stream.
+class KvScanStreamRpc final : public ClientRpc<pb::store::KvScanStreamRequest, pb::store::KvScanStreamResponse,
+                                               StoreService, StoreService_Stub> {
+ public:
+  KvScanStreamRpc(const KvScanStreamRpc &) = delete;
+  KvScanStreamRpc &operator=(const KvScanStreamRpc &) = delete;
+  explicit KvScanStreamRpc();
+  explicit KvScanStreamRpc(const std::string &cmd);
+  ~KvScanStreamRpc() override;
+  std::string Method() const override { return ConstMethod(); }
+  void Send(StoreService_Stub &stub, google::protobuf::Closure *done) override;
+  static std::string ConstMethod();
+
+  void SetStreamOptions(const brpc::StreamOptions &options) { stream_options_ = options; }
+
+  // The streams created by every send, the last one belongs to the responded request if the rpc succeeded.
+  const std::vector<brpc::StreamId> &GetStreamIds() const { return stream_ids_; }
+
+  void TEST_AddStreamId(brpc::StreamId stream_id) {  // NOLINT
+    stream_ids_.push_back(stream_id);
+  }
+
+ private:
+  brpc::StreamOptions stream_options_;
+  std::vector<brpc::StreamId> stream_ids_;
+};
+
 DECLARE_STORE_RPC(TxnGet);
 DECLARE_STORE_RPC(TxnBatchGet);
 DECLARE_STORE_RPC(TxnPrewrite);
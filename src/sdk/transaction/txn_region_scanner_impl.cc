@@ -64,6 +64,7 @@ std::unique_ptr<TxnScanRpc> TxnRegionScannerImpl::PrepareTxnScanRpc() {
   FillRpcContext(*rpc->MutableRequest()->mutable_context(), region->RegionId(), region->Epoch(),
                  TransactionIsolation2IsolationLevel(txn_options_.isolation));
   rpc->MutableRequest()->set_limit(batch_size_);
+  rpc->MutableRequest()->set_packed_kvs(kScanPackedKvs);
   auto* range_with_option = rpc->MutableRequest()->mutable_range();
   auto* range = range_with_option->mutable_range();
   CHECK(!next_key_.empty()) << "next_key should not be empty";
@@ -112,21 +113,26 @@ Status TxnRegionScannerImpl::NextBatch(std::vector<KVPair>& kvs) {
     }
   }
 
+  std::vector<KVPair> scan_kvs;
+  if (ret.ok()) {
+    ret = GetScanResponseKvs(*rpc, scan_kvs);
+  }
+
   if (ret.ok()) {
     const auto* response = rpc->Response();
     std::vector<KVPair> tmp_kvs;
     if (response->end_key().empty()) {
-      CHECK_EQ(response->kvs_size(), 0);
+      CHECK_EQ(scan_kvs.size(), 0);
       has_more_ = false;
     } else {
-      CHECK_NE(response->kvs_size(), 0);
+      CHECK_NE(scan_kvs.size(), 0);
       next_key_ = response->end_key();
       include_next_key_ = false;
-      for (const auto& kv : response->kvs()) {
-        DINGO_LOG(DEBUG) << "Success scan, key:" << kv.key() << ", value:" << kv.value() << ", next_key:" << next_key_
+      for (auto& kv : scan_kvs) {
+        DINGO_LOG(DEBUG) << "Success scan, key:" << kv.key << ", value:" << kv.value << ", next_key:" << next_key_
                          << ", end_key:" << end_key_;
-        if (kv.key() < end_key_) {
-          tmp_kvs.push_back({kv.key(), kv.value()});
+        if (kv.key < end_key_) {
+          tmp_kvs.push_back(std::move(kv));
         } else {
           has_more_ = false;
           break;
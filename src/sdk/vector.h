@@ -27,9 +27,19 @@ namespace sdk {
 
 class ClientStub;
 
-enum VectorIndexType : uint8_t { kNoneIndexType, kFlat, kIvfFlat, kIvfPq, kHnsw, kDiskAnn, kBruteForce };
+enum VectorIndexType : uint8_t {
+  kNoneIndexType,
+  kFlat,
+  kIvfFlat,
+  kIvfPq,
+  kHnsw,
+  kDiskAnn,
+  kBruteForce,
+  kBinaryFlat,
+  kBinaryIvfFlat
+};
 
-enum MetricType : uint8_t { kNoneMetricType, kL2, kInnerProduct, kCosine };
+enum MetricType : uint8_t { kNoneMetricType, kL2, kInnerProduct, kCosine, kHamming };
 
 struct FlatParam {
   explicit FlatParam(int32_t p_dimension, MetricType p_metric_type)
@@ -116,6 +126,30 @@ struct BruteForceParam {
   MetricType metric_type;
 };
 
+struct BinaryFlatParam {
+  explicit BinaryFlatParam(int32_t p_dimension) : dimension(p_dimension) {}
+
+  static VectorIndexType Type() { return VectorIndexType::kBinaryFlat; }
+
+  // number of bits, must be a multiple of 8. required
+  int32_t dimension;
+  // only Hamming is supported
+  MetricType metric_type{kHamming};
+};
+
+struct BinaryIvfFlatParam {
+  explicit BinaryIvfFlatParam(int32_t p_dimension) : dimension(p_dimension) {}
+
+  static VectorIndexType Type() { return VectorIndexType::kBinaryIvfFlat; }
+
+  // number of bits, must be a multiple of 8. required
+  int32_t dimension;
+  // only Hamming is supported
+  MetricType metric_type{kHamming};
+  // Number of cluster centers Default 2048 required
+  int32_t ncentroids{2048};
+};
+
 enum ValueType : uint8_t { kFloat, kUinT8 };
 
 struct Vector {
@@ -284,13 +318,16 @@ class VectorIndexCreator {
 
   VectorIndexCreator& SetReplicaNum(int64_t num);
 
-  // one of FlatParam/IvfFlatParam/HnswParam/DiskAnnParam/BruteForceParam, if set multiple, the last one will effective
+  // one of FlatParam/IvfFlatParam/HnswParam/DiskAnnParam/BruteForceParam/BinaryFlatParam/BinaryIvfFlatParam,
+  // if set multiple, the last one will effective
   VectorIndexCreator& SetFlatParam(const FlatParam& params);
   VectorIndexCreator& SetIvfFlatParam(const IvfFlatParam& params);
   VectorIndexCreator& SetIvfPqParam(const IvfPqParam& params);
   VectorIndexCreator& SetHnswParam(const HnswParam& params);
   // VectorIndexCreator& SetDiskAnnParam(DiskAnnParam& params);
   VectorIndexCreator& SetBruteForceParam(const BruteForceParam& params);
+  VectorIndexCreator& SetBinaryFlatParam(const BinaryFlatParam& params);
+  VectorIndexCreator& SetBinaryIvfFlatParam(const BinaryIvfFlatParam& params);
 
   // VectorIndexCreator& SetAutoIncrement(bool auto_incr);
 
@@ -36,6 +36,8 @@ static pb::common::MetricType MetricType2InternalMetricTypePB(MetricType metric_
       return pb::common::MetricType::METRIC_TYPE_INNER_PRODUCT;
     case MetricType::kCosine:
       return pb::common::MetricType::METRIC_TYPE_COSINE;
+    case MetricType::kHamming:
+      return pb::common::MetricType::METRIC_TYPE_HAMMING;
     default:
       CHECK(false) << "unsupported metric type:" << metric_type;
   }
@@ -57,6 +59,10 @@ static pb::common::VectorIndexType VectorIndexType2InternalVectorIndexTypePB(Vec
       return pb::common::VECTOR_INDEX_TYPE_DISKANN;
     case VectorIndexType::kBruteForce:
       return pb::common::VECTOR_INDEX_TYPE_BRUTEFORCE;
+    case VectorIndexType::kBinaryFlat:
+      return pb::common::VECTOR_INDEX_TYPE_BINARY_FLAT;
+    case VectorIndexType::kBinaryIvfFlat:
+      return pb::common::VECTOR_INDEX_TYPE_BINARY_IVF_FLAT;
     default:
       CHECK(false) << "unsupported vector index type:" << type;
   }
@@ -78,6 +84,10 @@ static VectorIndexType InternalVectorIndexTypePB2VectorIndexType(pb::common::Vec
       return VectorIndexType::kDiskAnn;
     case pb::common::VECTOR_INDEX_TYPE_BRUTEFORCE:
       return VectorIndexType::kBruteForce;
+    case pb::common::VECTOR_INDEX_TYPE_BINARY_FLAT:
+      return VectorIndexType::kBinaryFlat;
+    case pb::common::VECTOR_INDEX_TYPE_BINARY_IVF_FLAT:
+      return VectorIndexType::kBinaryIvfFlat;
     default:
       CHECK(false) << "unsupported vector index type:" << pb::common::VectorIndexType_Name(type);
   }
@@ -125,6 +135,21 @@ static void FillButeForceParmeter(pb::common::VectorIndexParameter* parameter, c
   bruteforce->set_metric_type(MetricType2InternalMetricTypePB(param.metric_type));
 }
 
+static void FillBinaryFlatParmeter(pb::common::VectorIndexParameter* parameter, const BinaryFlatParam& param) {
+  parameter->set_vector_index_type(pb::common::VECTOR_INDEX_TYPE_BINARY_FLAT);
+  auto* binary_flat = parameter->mutable_binary_flat_parameter();
+  binary_flat->set_dimension(param.dimension);
+  binary_flat->set_metric_type(MetricType2InternalMetricTypePB(param.metric_type));
+}
+
+static void FillBinaryIvfFlatParmeter(pb::common::VectorIndexParameter* parameter, const BinaryIvfFlatParam& param) {
+  parameter->set_vector_index_type(pb::common::VECTOR_INDEX_TYPE_BINARY_IVF_FLAT);
+  auto* binary_ivf_flat = parameter->mutable_binary_ivf_flat_parameter();
+  binary_ivf_flat->set_dimension(param.dimension);
+  binary_ivf_flat->set_metric_type(MetricType2InternalMetricTypePB(param.metric_type));
+  binary_ivf_flat->set_ncentroids(param.ncentroids);
+}
+
 static void FillRangePartitionRule(pb::meta::PartitionRule* partition_rule, const std::vector<int64_t>& seperator_ids,
                                    const std::vector<int64_t>& index_and_part_ids) {
   auto part_count = seperator_ids.size() + 1;
@@ -189,10 +214,12 @@ static void VectorIndexType2InternalVectorWithIdPB(pb::common::VectorWithId* pb,
   const auto& vector = vector_with_id.vector;
   vector_pb->set_dimension(vector.dimension);
   vector_pb->set_value_type(ValueType2InternalValueTypePB(vector.value_type));
-  // TODO: support uint
   for (const auto& float_value : vector.float_values) {
     vector_pb->add_float_values(float_value);
   }
+  for (const auto& binary_value : vector.binary_values) {
+    vector_pb->add_binary_values(binary_value);
+  }
 }
 
 }  // namespace sdk
@@ -79,6 +79,18 @@ VectorIndexCreator& VectorIndexCreator::SetBruteForceParam(const BruteForceParam
   return *this;
 }
 
+VectorIndexCreator& VectorIndexCreator::SetBinaryFlatParam(const BinaryFlatParam& params) {
+  data_->index_type = kBinaryFlat;
+  data_->binary_flat_param = params;
+  return *this;
+}
+
+VectorIndexCreator& VectorIndexCreator::SetBinaryIvfFlatParam(const BinaryIvfFlatParam& params) {
+  data_->index_type = kBinaryIvfFlat;
+  data_->binary_ivf_flat_param = params;
+  return *this;
+}
+
 // TODO: check partition is illegal
 // TODO: support hash partitions
 Status VectorIndexCreator::Create(int64_t& out_index_id) {
@@ -65,6 +65,14 @@ class VectorIndexCreator::Data {
       DCHECK(brute_force_param.has_value());
       auto& param = brute_force_param.value();
       FillButeForceParmeter(parameter, param);
+    } else if (index_type == kBinaryFlat) {
+      DCHECK(binary_flat_param.has_value());
+      auto& param = binary_flat_param.value();
+      FillBinaryFlatParmeter(parameter, param);
+    } else if (index_type == kBinaryIvfFlat) {
+      DCHECK(binary_ivf_flat_param.has_value());
+      auto& param = binary_ivf_flat_param.value();
+      FillBinaryIvfFlatParmeter(parameter, param);
     } else {
       CHECK(false) << "unsupported index type, " << index_type;
     }
@@ -85,6 +93,8 @@ class VectorIndexCreator::Data {
   std::optional<HnswParam> hnsw_param;
   std::optional<DiskAnnParam> diskann_param;
   std::optional<BruteForceParam> brute_force_param;
+  std::optional<BinaryFlatParam> binary_flat_param;
+  std::optional<BinaryIvfFlatParam> binary_ivf_flat_param;
 
   // TODO: Support
   bool auto_incr;
@@ -71,6 +71,10 @@ void Buf::SetForwardPos(int fp) { this->forward_pos_ = fp; }
 
 void Buf::SetReversePos(int rp) { this->reverse_pos_ = rp; }
 
+int Buf::GetForwardPos() const { return this->forward_pos_; }
+
+int Buf::GetReversePos() const { return this->reverse_pos_; }
+
 void Buf::Write(uint8_t b) { buf_.at(forward_pos_++) = b; }
 
 void Buf::WriteWithNegation(uint8_t b) { buf_.at(forward_pos_++) = ~b; }
@@ -42,6 +42,8 @@ class Buf {
   void Init(const std::string& buf);
   void SetForwardPos(int fp);
   void SetReversePos(int rp);
+  int GetForwardPos() const;
+  int GetReversePos() const;
   void Write(uint8_t b);
   void WriteWithNegation(uint8_t b);
   void Write(const std::string& data);
@@ -0,0 +1,113 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_BUF_VIEW_H_
+#define DINGO_SERIAL_BUF_VIEW_H_
+
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+
+namespace dingodb {
+
+// Read only cursor over an encoded key or value, same read semantics as Buf but not copy the data.
+// The viewed data must outlive the BufView and the string_view read from it.
+class BufView {
+ public:
+  BufView(std::string_view data, bool le)
+      : data_(data), forward_pos_(0), reverse_pos_(static_cast<int>(data.size()) - 1), le_(le) {}
+
+  uint8_t Read() { return At(forward_pos_++); }
+
+  int32_t ReadInt() { return ReadInt(le_); }
+  // Read with the given byte order, e.g. the float schema is always le.
+  int32_t ReadInt(bool le) {
+    uint32_t i = 0;
+    if (le) {
+      for (int n = 0; n < 4; ++n) {
+        i = (i << 8) | Read();
+      }
+    } else {
+      for (int n = 0; n < 4; ++n) {
+        i |= static_cast<uint32_t>(Read()) << (8 * n);
+      }
+    }
+    return static_cast<int32_t>(i);
+  }
+
+  int64_t ReadLong() { return ReadLong(le_); }
+  int64_t ReadLong(bool le) {
+    uint64_t l = 0;
+    if (le) {
+      for (int n = 0; n < 8; ++n) {
+        l = (l << 8) | Read();
+      }
+    } else {
+      for (int n = 0; n < 8; ++n) {
+        l |= static_cast<uint64_t>(Read()) << (8 * n);
+      }
+    }
+    return static_cast<int64_t>(l);
+  }
+
+  // Return the next size bytes without copy.
+  std::string_view ReadView(int size) {
+    if (size < 0 || forward_pos_ + size > static_cast<int>(data_.size())) {
+      throw std::out_of_range("BufView read view out of range");
+    }
+    auto view = data_.substr(forward_pos_, size);
+    forward_pos_ += size;
+    return view;
+  }
+
+  uint8_t ReverseRead() { return At(reverse_pos_--); }
+
+  int32_t ReverseReadInt() {
+    uint32_t i = 0;
+    if (le_) {
+      for (int n = 0; n < 4; ++n) {
+        i = (i << 8) | ReverseRead();
+      }
+    } else {
+      for (int n = 0; n < 4; ++n) {
+        i |= static_cast<uint32_t>(ReverseRead()) << (8 * n);
+      }
+    }
+    return static_cast<int32_t>(i);
+  }
+
+  void ReverseSkipInt() { reverse_pos_ -= 4; }
+  void Skip(int size) { forward_pos_ += size; }
+  void ReverseSkip(int size) { reverse_pos_ -= size; }
+
+  bool IsLe() const { return le_; }
+  bool IsEnd() const { return (reverse_pos_ - forward_pos_ + 1) == 0; }
+
+ private:
+  uint8_t At(int pos) const {
+    if (pos < 0 || pos >= static_cast<int>(data_.size())) {
+      throw std::out_of_range("BufView read out of range");
+    }
+    return static_cast<uint8_t>(data_[pos]);
+  }
+
+  std::string_view data_;
+  int forward_pos_;
+  int reverse_pos_;
+  bool le_;
+};
+
+}  // namespace dingodb
+
+#endif
@@ -79,6 +79,28 @@ CastAndDecodeOrSkipFuncPointer cast_and_decode_or_skip_func_ptrs[] = {
   CastAndDecodeOrSkip<std::shared_ptr<std::vector<std::string>>>,
 };
 
+template <typename T>
+void SetNull(std::vector<std::any>& record, int record_index) {
+  record.at(record_index) = std::optional<T>(std::nullopt);
+}
+
+using SetNullFuncPointer = void (*)(std::vector<std::any>& record, int record_index);
+
+SetNullFuncPointer set_null_func_ptrs[] = {
+  SetNull<bool>,
+  SetNull<int32_t>,
+  SetNull<float>,
+  SetNull<int64_t>,
+  SetNull<double>,
+  SetNull<std::shared_ptr<std::string>>,
+  SetNull<std::shared_ptr<std::vector<bool>>>,
+  SetNull<std::shared_ptr<std::vector<int32_t>>>,
+  SetNull<std::shared_ptr<std::vector<float>>>,
+  SetNull<std::shared_ptr<std::vector<int64_t>>>,
+  SetNull<std::shared_ptr<std::vector<double>>>,
+  SetNull<std::shared_ptr<std::vector<std::string>>>,
+};
+
 RecordDecoder::RecordDecoder(int schema_version, std::shared_ptr<std::vector<std::shared_ptr<BaseSchema>>> schemas,
                              long common_id) {
   this->le_ = IsLE();
@@ -281,4 +303,104 @@ int RecordDecoder::Decode(const pb::common::KeyValue& key_value, const std::vect
   return Decode(key_value.key(), key_value.value(), column_indexes, record);
 }
 
+int RecordDecoder::DecodePart(const std::string& key, const std::string& value, const std::vector<int>& column_indexes,
+                              const std::vector<bool>& is_part, RecordDecodeCursor& cursor,
+                              std::vector<std::any>& record) {
+  if (cursor.key_buf == nullptr) {
+    cursor.key_buf = std::make_unique<Buf>(0, this->le_);
+    cursor.value_buf = std::make_unique<Buf>(0, this->le_);
+  }
+  cursor.key_buf->Init(key);
+  cursor.key_buf->SetForwardPos(0);
+  cursor.value_buf->Init(value);
+  cursor.value_buf->SetForwardPos(0);
+  if (!CheckPrefix(cursor.key_buf.get()) || !CheckReverseTag(cursor.key_buf.get()) ||
+      !CheckSchemaVersion(cursor.value_buf.get())) {
+    return -1;
+  }
+
+  record.resize(column_indexes.size());
+  cursor.record_positions.assign(schemas_->size(), -1);
+  cursor.column_positions.resize(schemas_->size());
+  cursor.next_schema = 0;
+  cursor.rest_count = 0;
+
+  size_t part_count = 0;
+  for (size_t i = 0; i < column_indexes.size(); ++i) {
+    int schema_index = column_indexes[i];
+    if (schema_index < 0 || schema_index >= static_cast<int>(schemas_->size()) || !(*schemas_)[schema_index] ||
+        i >= is_part.size()) {
+      return -1;
+    }
+    cursor.record_positions[schema_index] = static_cast<int>(i);
+    if (is_part[i]) {
+      ++part_count;
+    } else {
+      ++cursor.rest_count;
+      set_null_func_ptrs[static_cast<int>((*schemas_)[schema_index]->GetType())](record, static_cast<int>(i));
+    }
+  }
+
+  DecodeByCursor(is_part, true, part_count, cursor, record);
+  return 0;
+}
+
+int RecordDecoder::DecodeRest(const std::vector<bool>& is_part, RecordDecodeCursor& cursor,
+                              std::vector<std::any>& record) {
+  if (cursor.rest_count == 0) {
+    return 0;
+  }
+  if (cursor.key_buf == nullptr || record.size() != is_part.size()) {
+    return -1;
+  }
+
+  Buf* key_buf = cursor.key_buf.get();
+  Buf* value_buf = cursor.value_buf.get();
+  std::array<int, 3> next_positions = {key_buf->GetForwardPos(), key_buf->GetReversePos(),
+                                       value_buf->GetForwardPos()};
+
+  // The columns walked over by DecodePart are decoded from their own positions.
+  size_t count = cursor.rest_count;
+  for (size_t schema_index = 0; schema_index < cursor.next_schema && count > 0; ++schema_index) {
+    int record_index = cursor.record_positions[schema_index];
+    if (record_index < 0 || is_part[record_index]) {
+      continue;
+    }
+    const auto& positions = cursor.column_positions[schema_index];
+    key_buf->SetForwardPos(positions[0]);
+    key_buf->SetReversePos(positions[1]);
+    value_buf->SetForwardPos(positions[2]);
+    DecodeOrSkip((*schemas_)[schema_index], key_buf, value_buf, record, record_index, false);
+    --count;
+  }
+
+  key_buf->SetForwardPos(next_positions[0]);
+  key_buf->SetReversePos(next_positions[1]);
+  value_buf->SetForwardPos(next_positions[2]);
+  DecodeByCursor(is_part, false, count, cursor, record);
+  cursor.rest_count = 0;
+  return 0;
+}
+
+void RecordDecoder::DecodeByCursor(const std::vector<bool>& is_part, bool part, size_t count,
+                                   RecordDecodeCursor& cursor, std::vector<std::any>& record) {
+  Buf* key_buf = cursor.key_buf.get();
+  Buf* value_buf = cursor.value_buf.get();
+  for (; count > 0 && cursor.next_schema < schemas_->size(); ++cursor.next_schema) {
+    const auto& schema = (*schemas_)[cursor.next_schema];
+    if (!schema) {
+      continue;
+    }
+
+    cursor.column_positions[cursor.next_schema] = {key_buf->GetForwardPos(), key_buf->GetReversePos(),
+                                                   value_buf->GetForwardPos()};
+    int record_index = cursor.record_positions[cursor.next_schema];
+    bool skip = record_index < 0 || is_part[record_index] != part;
+    DecodeOrSkip(schema, key_buf, value_buf, record, record_index, skip);
+    if (!skip) {
+      --count;
+    }
+  }
+}
+
 }  // namespace dingodb
@@ -15,9 +15,12 @@
 #ifndef DINGO_SERIAL_RECORD_DECODER_H_
 #define DINGO_SERIAL_RECORD_DECODER_H_
 
+#include <array>
 #include <memory>
+#include <vector>
 
 #include "any"
+#include "buf.h"
 #include "functional"
 #include "keyvalue.h"
 #include "optional"
@@ -38,6 +41,20 @@
 
 namespace dingodb {
 
+// The read positions of a record decoded in two phases by RecordDecoder, reused between records.
+struct RecordDecodeCursor {
+  std::unique_ptr<Buf> key_buf;
+  std::unique_ptr<Buf> value_buf;
+  // The next schema to walk.
+  size_t next_schema = 0;
+  // The column count left for DecodeRest.
+  size_t rest_count = 0;
+  // index = schema array index ; value = record position, -1 means not selected.
+  std::vector<int> record_positions;
+  // index = schema array index ; value = key forward, key reverse and value forward position of the column.
+  std::vector<std::array<int, 3>> column_positions;
+};
+
 class RecordDecoder {
  private:
   bool CheckPrefix(Buf* buf) const;
@@ -68,6 +85,20 @@ class RecordDecoder {
              std::vector<std::any>& record /*output*/);
   int Decode(const std::string& key, const std::string& value, const std::vector<int>& column_indexes,
              std::vector<std::any>& record /*output*/);
+
+  // Late materialization, decode the columns of column_indexes into the same position of record in two phases.
+  // DecodePart decodes the columns marked in is_part and set the others null, e.g. the columns of the filter.
+  // DecodeRest decodes the others, e.g. only for the records passed the filter, from the positions saved in cursor.
+  int DecodePart(const std::string& key, const std::string& value, const std::vector<int>& column_indexes,
+                 const std::vector<bool>& is_part, RecordDecodeCursor& cursor,
+                 std::vector<std::any>& record /*output*/);
+  int DecodeRest(const std::vector<bool>& is_part, RecordDecodeCursor& cursor,
+                 std::vector<std::any>& record /*output*/);
+
+ private:
+  // Walk the schemas from the cursor, decode count columns of the phase and skip the others.
+  void DecodeByCursor(const std::vector<bool>& is_part, bool part, size_t count, RecordDecodeCursor& cursor,
+                      std::vector<std::any>& record);
 };
 
 }  // namespace dingodb
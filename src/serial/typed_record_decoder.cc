@@ -0,0 +1,376 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "typed_record_decoder.h"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+#include "utils.h"
+
+namespace dingodb {
+
+namespace {
+
+constexpr uint8_t kNull = 0;
+
+// Fixed length field decode, must keep the same as DingoSchema<std::optional<T>>::DecodeKey/DecodeValue.
+template <typename T>
+struct FixedField;
+
+template <>
+struct FixedField<bool> {
+  static constexpr int kDataLength = 1;
+  static bool DecodeKey(BufView* buf, bool /*le*/) { return buf->Read() != 0; }
+  static bool DecodeValue(BufView* buf, bool /*le*/) { return buf->Read() != 0; }
+};
+
+template <>
+struct FixedField<int32_t> {
+  static constexpr int kDataLength = 4;
+  // The first written byte carry the flipped sign bit.
+  static int32_t DecodeKey(BufView* buf, bool le) {
+    uint32_t i = static_cast<uint32_t>(buf->ReadInt(le));
+    return static_cast<int32_t>(i ^ (le ? 0x80000000U : 0x80U));
+  }
+  static int32_t DecodeValue(BufView* buf, bool le) { return buf->ReadInt(le); }
+};
+
+template <>
+struct FixedField<int64_t> {
+  static constexpr int kDataLength = 8;
+  static int64_t DecodeKey(BufView* buf, bool le) {
+    uint64_t l = static_cast<uint64_t>(buf->ReadLong(le));
+    return static_cast<int64_t>(l ^ (le ? 0x8000000000000000ULL : 0x80ULL));
+  }
+  static int64_t DecodeValue(BufView* buf, bool le) { return buf->ReadLong(le); }
+};
+
+template <>
+struct FixedField<float> {
+  static constexpr int kDataLength = 4;
+  // Positive flip the sign bit, negative flip all bits.
+  static float DecodeKey(BufView* buf, bool le) {
+    uint32_t in = static_cast<uint32_t>(buf->ReadInt(le));
+    uint32_t sign_mask = le ? 0x80000000U : 0x80U;
+    in = (in & sign_mask) != 0 ? in ^ sign_mask : ~in;
+    float f;
+    memcpy(&f, &in, 4);
+    return f;
+  }
+  static float DecodeValue(BufView* buf, bool le) {
+    uint32_t in = static_cast<uint32_t>(buf->ReadInt(le));
+    float f;
+    memcpy(&f, &in, 4);
+    return f;
+  }
+};
+
+template <>
+struct FixedField<double> {
+  static constexpr int kDataLength = 8;
+  static double DecodeKey(BufView* buf, bool le) {
+    uint64_t l = static_cast<uint64_t>(buf->ReadLong(le));
+    uint64_t sign_mask = le ? 0x8000000000000000ULL : 0x80ULL;
+    l = (l & sign_mask) != 0 ? l ^ sign_mask : ~l;
+    double d;
+    memcpy(&d, &l, 8);
+    return d;
+  }
+  static double DecodeValue(BufView* buf, bool le) {
+    uint64_t l = static_cast<uint64_t>(buf->ReadLong(le));
+    double d;
+    memcpy(&d, &l, 8);
+    return d;
+  }
+};
+
+template <typename T, bool kIsKey>
+void DecodeFixed(const TypedRecordDecoder::DecodeStep& step, BufView* key_buf, BufView* value_buf,
+                 ColumnBuffer* column) {
+  BufView* buf = kIsKey ? key_buf : value_buf;
+  int length = step.allow_null ? FixedField<T>::kDataLength + 1 : FixedField<T>::kDataLength;
+  if (column == nullptr) {
+    if (kIsKey || !buf->IsEnd()) {
+      buf->Skip(length);
+    }
+    return;
+  }
+
+  auto& typed_column = std::get<TypedColumn<T>>(*column);
+  // Column added after the record written.
+  if (!kIsKey && buf->IsEnd()) {
+    typed_column.AppendNull();
+    return;
+  }
+  if (step.allow_null && buf->Read() == kNull) {
+    buf->Skip(FixedField<T>::kDataLength);
+    typed_column.AppendNull();
+    return;
+  }
+
+  if (kIsKey) {
+    typed_column.Append(FixedField<T>::DecodeKey(buf, step.le));
+  } else {
+    typed_column.Append(FixedField<T>::DecodeValue(buf, step.le));
+  }
+}
+
+// Memcomparable string key, 8 bytes group with a marker byte, the encoded length is reverse written at the key tail.
+void DecodeStringKey(BufView* buf, std::string& data) {
+  int length = buf->ReverseReadInt();
+  int group_num = length / 9;
+  buf->Skip(length - 1);
+  int remainder_zero = (255 - buf->Read()) & 0xFF;
+  buf->Skip(0 - length);
+
+  int ori_length = group_num * 8 - remainder_zero;
+  data.resize(ori_length);
+  if (ori_length != 0) {
+    char* dst = data.data();
+    for (int i = 0; i < group_num - 1; i++) {
+      auto group = buf->ReadView(8);
+      memcpy(dst, group.data(), 8);
+      dst += 8;
+      buf->Skip(1);
+    }
+    if (remainder_zero != 8) {
+      auto remainder = buf->ReadView(8 - remainder_zero);
+      memcpy(dst, remainder.data(), remainder.size());
+    }
+  }
+
+  buf->Skip(remainder_zero + 1);
+}
+
+template <bool kIsKey>
+void DecodeString(const TypedRecordDecoder::DecodeStep& step, BufView* key_buf, BufView* value_buf,
+                  ColumnBuffer* column) {
+  if (kIsKey) {
+    if (column == nullptr) {
+      key_buf->Skip(key_buf->ReverseReadInt() + (step.allow_null ? 1 : 0));
+      return;
+    }
+
+    auto& string_column = std::get<StringColumn>(*column);
+    if (step.allow_null && key_buf->Read() == kNull) {
+      key_buf->ReverseSkipInt();
+      string_column.AppendNull();
+      return;
+    }
+    auto& data = string_column.key_arena.emplace_back();
+    DecodeStringKey(key_buf, data);
+    string_column.Append(data);
+    return;
+  }
+
+  if (value_buf->IsEnd()) {
+    if (column != nullptr) {
+      std::get<StringColumn>(*column).AppendNull();
+    }
+    return;
+  }
+  if (step.allow_null && value_buf->Read() == kNull) {
+    if (column != nullptr) {
+      std::get<StringColumn>(*column).AppendNull();
+    }
+    return;
+  }
+
+  int length = value_buf->ReadInt();
+  if (column == nullptr) {
+    value_buf->Skip(length);
+  } else {
+    std::get<StringColumn>(*column).Append(value_buf->ReadView(length));
+  }
+}
+
+// List is only stored in value, skip it with the element width, 0 means string element.
+template <int kElementWidth>
+void SkipList(const TypedRecordDecoder::DecodeStep& step, BufView* /*key_buf*/, BufView* value_buf,
+              ColumnBuffer* /*column*/) {
+  if (value_buf->IsEnd()) {
+    return;
+  }
+  if (step.allow_null && value_buf->Read() == kNull) {
+    return;
+  }
+
+  int length = value_buf->ReadInt();
+  if (kElementWidth > 0) {
+    value_buf->Skip(length * kElementWidth);
+  } else {
+    for (int i = 0; i < length; i++) {
+      value_buf->Skip(value_buf->ReadInt());
+    }
+  }
+}
+
+template <bool kIsKey>
+TypedRecordDecoder::DecodeFunc GetDecodeFunc(BaseSchema::Type type) {
+  switch (type) {
+    case BaseSchema::kBool:
+      return DecodeFixed<bool, kIsKey>;
+    case BaseSchema::kInteger:
+      return DecodeFixed<int32_t, kIsKey>;
+    case BaseSchema::kFloat:
+      return DecodeFixed<float, kIsKey>;
+    case BaseSchema::kLong:
+      return DecodeFixed<int64_t, kIsKey>;
+    case BaseSchema::kDouble:
+      return DecodeFixed<double, kIsKey>;
+    case BaseSchema::kString:
+      return DecodeString<kIsKey>;
+    case BaseSchema::kBoolList:
+      return kIsKey ? nullptr : &SkipList<1>;
+    case BaseSchema::kIntegerList:
+    case BaseSchema::kFloatList:
+      return kIsKey ? nullptr : &SkipList<4>;
+    case BaseSchema::kLongList:
+    case BaseSchema::kDoubleList:
+      return kIsKey ? nullptr : &SkipList<8>;
+    case BaseSchema::kStringList:
+      return kIsKey ? nullptr : &SkipList<0>;
+    default:
+      return nullptr;
+  }
+}
+
+bool IsListType(BaseSchema::Type type) { return type >= BaseSchema::kBoolList; }
+
+}  // namespace
+
+TypedRecordDecoder::TypedRecordDecoder(int schema_version,
+                                       std::shared_ptr<std::vector<std::shared_ptr<BaseSchema>>> schemas,
+                                       long common_id)
+    : TypedRecordDecoder(schema_version, schemas, common_id, IsLE()) {}
+
+TypedRecordDecoder::TypedRecordDecoder(int schema_version,
+                                       std::shared_ptr<std::vector<std::shared_ptr<BaseSchema>>> schemas,
+                                       long common_id, bool le)
+    : schema_version_(schema_version), schemas_(schemas), common_id_(common_id), le_(le) {}
+
+int TypedRecordDecoder::Init(const std::vector<int>& column_indexes) {
+  steps_.clear();
+  column_types_.clear();
+
+  std::vector<int> output_indexes(schemas_->size(), -1);
+  for (int i = 0; i < column_indexes.size(); i++) {
+    int column_index = column_indexes[i];
+    if (column_index < 0 || column_index >= schemas_->size() || schemas_->at(column_index) == nullptr ||
+        output_indexes[column_index] != -1 || IsListType(schemas_->at(column_index)->GetType())) {
+      return -1;
+    }
+    output_indexes[column_index] = i;
+    column_types_.push_back(schemas_->at(column_index)->GetType());
+  }
+
+  int last_output_step = -1;
+  for (int i = 0; i < schemas_->size(); i++) {
+    const auto& bs = schemas_->at(i);
+    if (bs == nullptr) {
+      continue;
+    }
+
+    DecodeStep step;
+    step.func = bs->IsKey() ? GetDecodeFunc<true>(bs->GetType()) : GetDecodeFunc<false>(bs->GetType());
+    if (step.func == nullptr) {
+      steps_.clear();
+      column_types_.clear();
+      return -1;
+    }
+    step.output_index = output_indexes[i];
+    step.allow_null = bs->AllowNull();
+    // Float schema is not formatted by FormatSchema and always decode as le.
+    step.le = bs->GetType() == BaseSchema::kFloat ? true : le_;
+    steps_.push_back(step);
+
+    if (step.output_index != -1) {
+      last_output_step = steps_.size() - 1;
+    }
+  }
+
+  // The columns after the last selected one needn't to decode.
+  steps_.resize(last_output_step + 1);
+  return 0;
+}
+
+std::vector<ColumnBuffer> TypedRecordDecoder::NewColumns() const {
+  std::vector<ColumnBuffer> columns;
+  columns.reserve(column_types_.size());
+  for (auto type : column_types_) {
+    switch (type) {
+      case BaseSchema::kBool:
+        columns.emplace_back(std::in_place_type<TypedColumn<bool>>);
+        break;
+      case BaseSchema::kInteger:
+        columns.emplace_back(std::in_place_type<TypedColumn<int32_t>>);
+        break;
+      case BaseSchema::kFloat:
+        columns.emplace_back(std::in_place_type<TypedColumn<float>>);
+        break;
+      case BaseSchema::kLong:
+        columns.emplace_back(std::in_place_type<TypedColumn<int64_t>>);
+        break;
+      case BaseSchema::kDouble:
+        columns.emplace_back(std::in_place_type<TypedColumn<double>>);
+        break;
+      default:
+        columns.emplace_back(std::in_place_type<StringColumn>);
+        break;
+    }
+  }
+  return columns;
+}
+
+bool TypedRecordDecoder::CheckPrefix(BufView* buf) const {
+  // skip name space
+  buf->Skip(1);
+  return buf->ReadLong() == common_id_;
+}
+
+bool TypedRecordDecoder::CheckReverseTag(BufView* buf) const {
+  if (buf->ReverseRead() <= codec_version_) {
+    buf->ReverseSkip(3);
+    return true;
+  }
+  return false;
+}
+
+bool TypedRecordDecoder::CheckSchemaVersion(BufView* buf) const { return buf->ReadInt() <= schema_version_; }
+
+int TypedRecordDecoder::Decode(std::string_view key, std::string_view value, std::vector<ColumnBuffer>& columns) {
+  if (columns.size() != column_types_.size()) {
+    return -1;
+  }
+
+  BufView key_buf(key, le_);
+  BufView value_buf(value, le_);
+  if (!CheckPrefix(&key_buf) || !CheckReverseTag(&key_buf) || !CheckSchemaVersion(&value_buf)) {
+    return -1;
+  }
+
+  for (const auto& step : steps_) {
+    step.func(step, &key_buf, &value_buf, step.output_index == -1 ? nullptr : &columns[step.output_index]);
+  }
+
+  return 0;
+}
+
+}  // namespace dingodb
@@ -0,0 +1,125 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGO_SERIAL_TYPED_RECORD_DECODER_H_
+#define DINGO_SERIAL_TYPED_RECORD_DECODER_H_
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+#include "buf_view.h"
+#include "schema/base_schema.h"
+
+namespace dingodb {
+
+// Column buffer of one selected column, the decoder append one row on each decode.
+template <typename T>
+struct TypedColumn {
+  std::vector<T> values;
+  // 1 means the row is null, the value of null row is default constructed.
+  std::vector<uint8_t> nulls;
+
+  void Append(T value) {
+    values.push_back(value);
+    nulls.push_back(0);
+  }
+  void AppendNull() {
+    values.emplace_back();
+    nulls.push_back(1);
+  }
+
+  size_t Size() const { return values.size(); }
+  bool IsNull(size_t row) const { return nulls[row] != 0; }
+
+  void Reserve(size_t size) {
+    values.reserve(size);
+    nulls.reserve(size);
+  }
+  void Clear() {
+    values.clear();
+    nulls.clear();
+  }
+};
+
+// String column, the value is a view into the decoded source value.
+// Key string is memcomparable encoded and can't be viewed directly, it is decoded into key_arena,
+// deque keep the decoded string address stable while appending.
+struct StringColumn : public TypedColumn<std::string_view> {
+  std::deque<std::string> key_arena;
+
+  void Clear() {
+    TypedColumn<std::string_view>::Clear();
+    key_arena.clear();
+  }
+};
+
+using ColumnBuffer = std::variant<TypedColumn<bool>, TypedColumn<int32_t>, TypedColumn<float>, TypedColumn<int64_t>,
+                                  TypedColumn<double>, StringColumn>;
+
+// Decode record into caller provided typed column buffers, no std::any and no per field allocation.
+// The column selection is resolved once into a decode plan of type specialized steps, instead of per record.
+// List type column is only supported to skip, selecting it fail the Init, use RecordDecoder instead.
+class TypedRecordDecoder {
+ public:
+  TypedRecordDecoder(int schema_version, std::shared_ptr<std::vector<std::shared_ptr<BaseSchema>>> schemas,
+                     long common_id);
+  TypedRecordDecoder(int schema_version, std::shared_ptr<std::vector<std::shared_ptr<BaseSchema>>> schemas,
+                     long common_id, bool le);
+
+  // Build the decode plan of the selected columns, column_indexes is the schema index of the output columns.
+  // Return -1 if the column index is invalid or the column type is not supported.
+  int Init(const std::vector<int>& column_indexes);
+
+  // Create the column buffers matched the selected columns.
+  std::vector<ColumnBuffer> NewColumns() const;
+
+  // Append one row to each column, the string view of value column point into value, keep it alive.
+  int Decode(std::string_view key, std::string_view value, std::vector<ColumnBuffer>& columns /*output*/);
+
+  size_t ColumnSize() const { return column_types_.size(); }
+
+  struct DecodeStep;
+  using DecodeFunc = void (*)(const DecodeStep& step, BufView* key_buf, BufView* value_buf, ColumnBuffer* column);
+
+  struct DecodeStep {
+    DecodeFunc func;
+    // -1 means skip the column.
+    int output_index;
+    bool allow_null;
+    bool le;
+  };
+
+ private:
+  bool CheckPrefix(BufView* buf) const;
+  bool CheckReverseTag(BufView* buf) const;
+  bool CheckSchemaVersion(BufView* buf) const;
+
+  int codec_version_ = 1;
+  int schema_version_;
+  std::shared_ptr<std::vector<std::shared_ptr<BaseSchema>>> schemas_;
+  long common_id_;
+  bool le_;
+
+  std::vector<DecodeStep> steps_;
+  std::vector<BaseSchema::Type> column_types_;
+};
+
+}  // namespace dingodb
+
+#endif
@@ -39,6 +39,8 @@
 #include "server/server.h"
 #include "server/service_helper.h"
 #include "vector/codec.h"
+#include "vector/vector_index_memory_budget.h"
+#include "vector/vector_index_utils.h"
 
 using dingodb::pb::error::Errno;
 
@@ -214,6 +216,7 @@ static butil::Status ValidateVectorSearchRequest(StoragePtr storage, const pb::i
     return status;
   }
 
+  VectorIndexMemoryBudget::Access(region->VectorIndexWrapper());
   if (!region->VectorIndexWrapper()->IsReady()) {
     if (region->VectorIndexWrapper()->IsBuildError()) {
       return butil::Status(pb::error::EVECTOR_INDEX_BUILD_ERROR,
@@ -344,6 +347,7 @@ static butil::Status ValidateVectorAddRequest(StoragePtr storage, const pb::inde
   }
 
   auto vector_index_wrapper = region->VectorIndexWrapper();
+  VectorIndexMemoryBudget::Access(vector_index_wrapper);
   if (!vector_index_wrapper->IsReady()) {
     if (region->VectorIndexWrapper()->IsBuildError()) {
       return butil::Status(pb::error::EVECTOR_INDEX_BUILD_ERROR,
@@ -364,25 +368,22 @@ static butil::Status ValidateVectorAddRequest(StoragePtr storage, const pb::inde
                            "Param vector id is not allowed to be zero, INT64_MAX or negative");
     }
 
-    if (BAIDU_UNLIKELY(vector.vector().float_values().empty())) {
+    if (BAIDU_UNLIKELY(vector.vector().float_values().empty() && vector.vector().binary_values().empty())) {
       return butil::Status(pb::error::EVECTOR_EMPTY, "Vector is empty");
     }
   }
 
   auto dimension = vector_index_wrapper->GetDimension();
   for (const auto& vector : request->vectors()) {
-    if (vector_index_wrapper->Type() == pb::common::VectorIndexType::VECTOR_INDEX_TYPE_HNSW ||
-        vector_index_wrapper->Type() == pb::common::VectorIndexType::VECTOR_INDEX_TYPE_FLAT ||
-        vector_index_wrapper->Type() == pb::common::VectorIndexType::VECTOR_INDEX_TYPE_BRUTEFORCE ||
-        vector_index_wrapper->Type() == pb::common::VectorIndexType::VECTOR_INDEX_TYPE_IVF_FLAT ||
-        vector_index_wrapper->Type() == pb::common::VectorIndexType::VECTOR_INDEX_TYPE_IVF_PQ) {
+    if (!VectorIndexUtils::IsBinaryVectorIndexType(vector_index_wrapper->Type())) {
       if (vector.vector().float_values().size() != dimension) {
         return butil::Status(
             pb::error::EILLEGAL_PARAMTETERS,
             "Param vector float dimension is error, correct dimension is " + std::to_string(dimension));
       }
     } else {
-      if (vector.vector().binary_values().size() != dimension) {
+      // binary dimension is the number of bits
+      if (VectorIndexUtils::BinaryVectorSize(vector.vector()) * 8 != dimension) {
         return butil::Status(
             pb::error::EILLEGAL_PARAMTETERS,
             "Param vector binary dimension is error, correct dimension is " + std::to_string(dimension));
@@ -495,6 +496,7 @@ static butil::Status ValidateVectorDeleteRequest(StoragePtr storage, const pb::i
   }
 
   auto vector_index_wrapper = region->VectorIndexWrapper();
+  VectorIndexMemoryBudget::Access(vector_index_wrapper);
   if (!vector_index_wrapper->IsReady()) {
     if (region->VectorIndexWrapper()->IsBuildError()) {
       return butil::Status(pb::error::EVECTOR_INDEX_BUILD_ERROR,
@@ -992,6 +994,7 @@ static butil::Status ValidateVectorSearchDebugRequest(StoragePtr storage,
   }
 
   auto vector_index_wrapper = region->VectorIndexWrapper();
+  VectorIndexMemoryBudget::Access(vector_index_wrapper);
   if (!vector_index_wrapper->IsReady()) {
     if (region->VectorIndexWrapper()->IsBuildError()) {
       return butil::Status(pb::error::EVECTOR_INDEX_BUILD_ERROR,
@@ -1462,6 +1465,7 @@ static butil::Status ValidateIndexTxnPrewriteRequest(StoragePtr storage, const p
     return status;
   }
 
+  VectorIndexMemoryBudget::Access(region->VectorIndexWrapper());
   if (!region->VectorIndexWrapper()->IsReady()) {
     if (region->VectorIndexWrapper()->IsBuildError()) {
       return butil::Status(pb::error::EVECTOR_INDEX_BUILD_ERROR,
@@ -1508,23 +1512,20 @@ static butil::Status ValidateIndexTxnPrewriteRequest(StoragePtr storage, const p
                              "the mutation key and VectorWithId");
       }
 
-      if (BAIDU_UNLIKELY(vector.vector().float_values().empty())) {
+      if (BAIDU_UNLIKELY(vector.vector().float_values().empty() && vector.vector().binary_values().empty())) {
         return butil::Status(pb::error::EVECTOR_EMPTY, "Vector is empty");
       }
 
       // check vector dimension
-      if (vector_index_wrapper->Type() == pb::common::VectorIndexType::VECTOR_INDEX_TYPE_HNSW ||
-          vector_index_wrapper->Type() == pb::common::VectorIndexType::VECTOR_INDEX_TYPE_FLAT ||
-          vector_index_wrapper->Type() == pb::common::VectorIndexType::VECTOR_INDEX_TYPE_BRUTEFORCE ||
-          vector_index_wrapper->Type() == pb::common::VectorIndexType::VECTOR_INDEX_TYPE_IVF_FLAT ||
-          vector_index_wrapper->Type() == pb::common::VectorIndexType::VECTOR_INDEX_TYPE_IVF_PQ) {
+      if (!VectorIndexUtils::IsBinaryVectorIndexType(vector_index_wrapper->Type())) {
         if (BAIDU_UNLIKELY(vector.vector().float_values().size() != dimension)) {
           return butil::Status(
               pb::error::EILLEGAL_PARAMTETERS,
               "Param vector float dimension is error, correct dimension is " + std::to_string(dimension));
         }
       } else {
-        if (BAIDU_UNLIKELY(vector.vector().binary_values().size() != dimension)) {
+        // binary dimension is the number of bits
+        if (BAIDU_UNLIKELY(VectorIndexUtils::BinaryVectorSize(vector.vector()) * 8 != dimension)) {
           return butil::Status(
               pb::error::EILLEGAL_PARAMTETERS,
               "Param vector binary dimension is error, correct dimension is " + std::to_string(dimension));
@@ -20,12 +20,14 @@
 #include <string_view>
 #include <vector>
 
+#include "brpc/controller.h"
 #include "butil/compiler_specific.h"
 #include "butil/status.h"
 #include "butil/time.h"
 #include "common/constant.h"
 #include "common/context.h"
 #include "common/helper.h"
+#include "common/packed_kv.h"
 #include "common/synchronization.h"
 #include "common/tracker.h"
 #include "common/version.h"
@@ -35,6 +37,7 @@
 #include "proto/common.pb.h"
 #include "proto/error.pb.h"
 #include "proto/store.pb.h"
+#include "scan/scan_stream.h"
 #include "server/server.h"
 #include "server/service_helper.h"
 
@@ -1259,6 +1262,22 @@ static butil::Status ValidateKvScanContinueRequest(const dingodb::pb::store::KvS
   return butil::Status();
 }
 
+// The scanned kvs are packed into the response attachment if the client asks for it, see common/packed_kv.h.
+template <typename ResponseType>
+static void SetScanResponseKvs(brpc::Controller* cntl, bool packed_kvs, const std::vector<pb::common::KeyValue>& kvs,
+                               ResponseType* response) {
+  if (kvs.empty()) {
+    return;
+  }
+
+  if (packed_kvs) {
+    PackedKv::Encode(kvs, cntl->response_attachment());
+    response->set_packed_kv_count(kvs.size());
+  } else {
+    Helper::VectorToPbRepeated(kvs, response->mutable_kvs());
+  }
+}
+
 void DoKvScanContinue(StoragePtr storage, google::protobuf::RpcController* controller,
                       const dingodb::pb::store::KvScanContinueRequest* request,
                       dingodb::pb::store::KvScanContinueResponse* response, TrackClosure* done) {
@@ -1299,9 +1318,7 @@ void DoKvScanContinue(StoragePtr storage, google::protobuf::RpcController* contr
     return;
   }
 
-  if (!kvs.empty()) {
-    Helper::VectorToPbRepeated(kvs, response->mutable_kvs());
-  }
+  SetScanResponseKvs(cntl, request->packed_kvs(), kvs, response);
 }
 
 void StoreServiceImpl::KvScanContinue(google::protobuf::RpcController* controller,
@@ -1517,6 +1534,109 @@ void StoreServiceImpl::KvScanBeginV2(google::protobuf::RpcController* controller
   }
 }
 
+static butil::Status ValidateKvScanStreamRequest(const dingodb::pb::store::KvScanStreamRequest* request,
+                                                 store::RegionPtr region, const pb::common::Range& req_range) {
+  auto status = ServiceHelper::ValidateRegionEpoch(request->context().region_epoch(), region);
+  if (!status.ok()) {
+    return status;
+  }
+
+  status = ServiceHelper::ValidateRange(req_range);
+  if (!status.ok()) {
+    return status;
+  }
+
+  status = ServiceHelper::ValidateRangeInRange(region->Range(), req_range);
+  if (!status.ok()) {
+    return status;
+  }
+
+  status = ServiceHelper::ValidateRegionState(region);
+  if (!status.ok()) {
+    return status;
+  }
+
+  return butil::Status();
+}
+
+void DoKvScanStream(StoragePtr storage, google::protobuf::RpcController* controller,
+                    const dingodb::pb::store::KvScanStreamRequest* request,
+                    dingodb::pb::store::KvScanStreamResponse* response, TrackClosure* done) {
+  brpc::Controller* cntl = (brpc::Controller*)controller;
+  brpc::ClosureGuard done_guard(done);
+  auto tracker = done->Tracker();
+  tracker->SetServiceQueueWaitTime();
+
+  int64_t region_id = request->context().region_id();
+  auto region = Server::GetInstance().GetRegion(region_id);
+  if (region == nullptr) {
+    ServiceHelper::SetError(response->mutable_error(), pb::error::EREGION_NOT_FOUND,
+                            fmt::format("Not found region {} at server {}", region_id, Server::GetInstance().Id()));
+    return;
+  }
+
+  auto uniform_range = Helper::TransformRangeWithOptions(request->range());
+  butil::Status status = ValidateKvScanStreamRequest(request, region, uniform_range);
+  if (!status.ok()) {
+    if (pb::error::ERANGE_INVALID != static_cast<pb::error::Errno>(status.error_code())) {
+      ServiceHelper::SetError(response->mutable_error(), status.error_code(), status.error_str());
+      ServiceHelper::GetStoreRegionInfo(region, response->mutable_error());
+      return;
+    }
+
+    // Nothing to scan, the stream is finished with an empty message.
+    status = ScanStream::Start(cntl, nullptr, "", request->batch_size(), request->window_size());
+    if (!status.ok()) {
+      ServiceHelper::SetError(response->mutable_error(), status.error_code(), status.error_str());
+    }
+    return;
+  }
+
+  std::shared_ptr<Context> ctx = std::make_shared<Context>(cntl, done);
+  ctx->SetRegionId(region_id);
+  ctx->SetTracker(tracker);
+  ctx->SetCfName(Constant::kStoreDataCF);
+  ctx->SetRegionEpoch(request->context().region_epoch());
+  ctx->SetRawEngineType(region->GetRawEngineType());
+
+  auto correction_range = Helper::IntersectRange(region->Range(), uniform_range);
+
+  std::string scan_id;
+  std::shared_ptr<ScanContext> scan;
+  status = storage->KvScanStreamBegin(ctx, Constant::kStoreDataCF, region_id, correction_range, request->key_only(),
+                                      !request->has_coprocessor(), request->coprocessor(), scan_id, scan);
+  if (!status.ok()) {
+    ServiceHelper::SetError(response->mutable_error(), status.error_code(), status.error_str());
+    return;
+  }
+
+  status = ScanStream::Start(cntl, scan, scan_id, request->batch_size(), request->window_size());
+  if (!status.ok()) {
+    ServiceHelper::SetError(response->mutable_error(), status.error_code(), status.error_str());
+  }
+}
+
+void StoreServiceImpl::KvScanStream(google::protobuf::RpcController* controller,
+                                    const ::dingodb::pb::store::KvScanStreamRequest* request,
+                                    ::dingodb::pb::store::KvScanStreamResponse* response,
+                                    ::google::protobuf::Closure* done) {
+  auto* svr_done = new ServiceClosure(__func__, done, request, response);
+
+  if (!FLAGS_enable_async_store_operation) {
+    return DoKvScanStream(storage_, controller, request, response, svr_done);
+  }
+
+  // Run in queue.
+  StoragePtr storage = storage_;
+  auto task =
+      std::make_shared<ServiceTask>([=]() { DoKvScanStream(storage, controller, request, response, svr_done); });
+  bool ret = read_worker_set_->ExecuteRR(task);
+  if (!ret) {
+    brpc::ClosureGuard done_guard(svr_done);
+    ServiceHelper::SetError(response->mutable_error(), pb::error::EREQUEST_FULL, "Commit execute queue failed");
+  }
+}
+
 static butil::Status ValidateKvScanContinueRequestV2(const dingodb::pb::store::KvScanContinueRequestV2* request,
                                                      store::RegionPtr region) {
   // check if region_epoch is match
@@ -1577,9 +1697,7 @@ void DoKvScanContinueV2(StoragePtr storage, google::protobuf::RpcController* con
     return;
   }
 
-  if (!kvs.empty()) {
-    Helper::VectorToPbRepeated(kvs, response->mutable_kvs());
-  }
+  SetScanResponseKvs(cntl, request->packed_kvs(), kvs, response);
 
   response->set_has_more(has_more);
 }
@@ -1826,9 +1944,7 @@ void DoTxnScan(StoragePtr storage, google::protobuf::RpcController* controller,
     return;
   }
 
-  if (!kvs.empty()) {
-    Helper::VectorToPbRepeated(kvs, response->mutable_kvs());
-  }
+  SetScanResponseKvs(cntl, request->packed_kvs(), kvs, response);
 
   if (txn_result_info.ByteSizeLong() > 0) {
     *response->mutable_txn_result() = txn_result_info;
@@ -61,6 +61,10 @@ class StoreServiceImpl : public pb::store::StoreService {
                        ::dingodb::pb::store::KvScanReleaseResponseV2* response,
                        ::google::protobuf::Closure* done) override;
 
+  void KvScanStream(::google::protobuf::RpcController* controller,
+                    const ::dingodb::pb::store::KvScanStreamRequest* request,
+                    ::dingodb::pb::store::KvScanStreamResponse* response, ::google::protobuf::Closure* done) override;
+
   // rawkv write
   void KvPut(google::protobuf::RpcController* controller, const pb::store::KvPutRequest* request,
              pb::store::KvPutResponse* response, google::protobuf::Closure* done) override;
@@ -136,6 +136,8 @@ void HeartbeatTask::SendStoreHeartbeat(std::shared_ptr<CoordinatorInteraction> c
         auto* vector_index_status = tmp_region_metrics.mutable_vector_index_status();
         vector_index_status->set_is_stop(vector_index_wrapper->IsStop());
         vector_index_status->set_is_ready(vector_index_wrapper->IsReady());
+        // The evicted vector index is not ready, it is reloaded on next access.
+        vector_index_status->set_is_evicted(vector_index_wrapper->IsEvicted());
         vector_index_status->set_is_own_ready(vector_index_wrapper->IsOwnReady());
         vector_index_status->set_is_build_error(vector_index_wrapper->IsBuildError());
         vector_index_status->set_is_rebuild_error(vector_index_wrapper->IsRebuildError());
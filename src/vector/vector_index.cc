@@ -26,14 +26,18 @@
 #include "common/helper.h"
 #include "config/config_manager.h"
 #include "fmt/core.h"
+#include "gflags/gflags.h"
 #include "proto/common.pb.h"
 #include "proto/error.pb.h"
 #include "server/server.h"
 #include "vector/codec.h"
 #include "vector/vector_index_snapshot_manager.h"
+#include "vector/vector_search_coalescer.h"
 
 namespace dingodb {
 
+DEFINE_bool(enable_vector_search_coalesce, false, "enable coalesce concurrent vector search of one region");
+
 VectorIndex::VectorIndex(int64_t id, const pb::common::VectorIndexParameter& vector_index_parameter,
                          const pb::common::RegionEpoch& epoch, const pb::common::Range& range)
     : id(id),
@@ -103,6 +107,11 @@ butil::Status VectorIndex::GetMemorySize([[maybe_unused]] int64_t& memory_size)
   return butil::Status(pb::error::Errno::EVECTOR_NOT_SUPPORT, "this vector index do not implement get memory size");
 }
 
+butil::Status VectorIndex::DeriveTo([[maybe_unused]] int64_t begin_vector_id, [[maybe_unused]] int64_t end_vector_id,
+                                    [[maybe_unused]] VectorIndex* target) {
+  return butil::Status(pb::error::Errno::EVECTOR_NOT_SUPPORT, "this vector index do not implement derive");
+}
+
 VectorIndexWrapper::VectorIndexWrapper(int64_t id, pb::common::VectorIndexParameter index_parameter,
                                        int64_t save_snapshot_threshold_write_key_num)
     : id_(id),
@@ -120,6 +129,10 @@ VectorIndexWrapper::VectorIndexWrapper(int64_t id, pb::common::VectorIndexParame
       saving_num_(0),
       save_snapshot_threshold_write_key_num_(save_snapshot_threshold_write_key_num) {
   snapshot_set_ = vector_index::SnapshotMetaSet::New(id);
+  search_coalescer_ = VectorSearchCoalescer::New();
+  if (VectorIndexTrainSample::IsEnable()) {
+    train_sample_ = VectorIndexTrainSample::New(index_parameter);
+  }
   bthread_mutex_init(&vector_index_mutex_, nullptr);
   DINGO_LOG(DEBUG) << fmt::format("[new.VectorIndexWrapper][id({})]", id_);
 }
@@ -325,6 +338,11 @@ void VectorIndexWrapper::UpdateVectorIndex(VectorIndexPtr vector_index, const st
     ++version_;
 
     ready_.store(true);
+    if (evicted_.exchange(false)) {
+      reload_cond_.DecreaseBroadcast();
+    }
+    // A fresh loaded vector index is not cold, give it a chance to be accessed.
+    last_access_time_ms_.store(Helper::TimestampMs(), std::memory_order_relaxed);
 
     int64_t apply_log_id = ApplyLogId();
     int64_t snapshot_log_id = SnapshotLogId();
@@ -349,11 +367,62 @@ void VectorIndexWrapper::ClearVectorIndex(const std::string& trace) {
   BAIDU_SCOPED_LOCK(vector_index_mutex_);
 
   ready_.store(false);
+  if (evicted_.exchange(false)) {
+    reload_cond_.DecreaseBroadcast();
+  }
   vector_index_ = nullptr;
   share_vector_index_ = nullptr;
   sibling_vector_index_ = nullptr;
 }
 
+void VectorIndexWrapper::EvictVectorIndex(const std::string& trace) {
+  DINGO_LOG(INFO) << fmt::format("[vector_index.wrapper][index_id({})][trace({})] Evict vector index", Id(), trace);
+
+  BAIDU_SCOPED_LOCK(vector_index_mutex_);
+
+  // Mark evicted before not ready, so the access see it and reload.
+  if (!evicted_.exchange(true)) {
+    reload_cond_.Increase();
+  }
+  ready_.store(false);
+  vector_index_ = nullptr;
+}
+
+bool VectorIndexWrapper::WaitReload(int64_t timeout_ms) {
+  if (timeout_ms <= 0) {
+    return !IsEvicted();
+  }
+  return reload_cond_.TimedWait(timeout_ms * 1000) == 0;
+}
+
+VectorIndexTrainSamplePtr VectorIndexWrapper::TrainSample() {
+  BAIDU_SCOPED_LOCK(vector_index_mutex_);
+  return train_sample_;
+}
+
+void VectorIndexWrapper::SetTrainSample(VectorIndexTrainSamplePtr train_sample) {
+  if (!VectorIndexTrainSample::IsEnable()) {
+    return;
+  }
+
+  BAIDU_SCOPED_LOCK(vector_index_mutex_);
+  train_sample_ = train_sample;
+}
+
+void VectorIndexWrapper::AddTrainSample(const std::vector<pb::common::VectorWithId>& vector_with_ids) {
+  auto train_sample = TrainSample();
+  if (train_sample != nullptr) {
+    train_sample->Add(vector_with_ids);
+  }
+}
+
+void VectorIndexWrapper::DeleteTrainSample(const std::vector<int64_t>& vector_ids) {
+  auto train_sample = TrainSample();
+  if (train_sample != nullptr) {
+    train_sample->Delete(vector_ids);
+  }
+}
+
 VectorIndexPtr VectorIndexWrapper::GetOwnVectorIndex() {
   BAIDU_SCOPED_LOCK(vector_index_mutex_);
   return vector_index_;
@@ -410,6 +479,45 @@ int32_t VectorIndexWrapper::SavingNum() { return saving_num_.load(std::memory_or
 void VectorIndexWrapper::IncSavingNum() { saving_num_.fetch_add(1, std::memory_order_relaxed); }
 void VectorIndexWrapper::DecSavingNum() { saving_num_.fetch_sub(1, std::memory_order_relaxed); }
 
+void VectorIndexWrapper::ResetBuildProgress() {
+  build_vector_count_.store(0, std::memory_order_relaxed);
+  build_finish_time_ms_.store(0, std::memory_order_relaxed);
+  build_start_time_ms_.store(Helper::TimestampMs(), std::memory_order_relaxed);
+}
+
+void VectorIndexWrapper::IncBuildProgress(int64_t count) {
+  build_vector_count_.fetch_add(count, std::memory_order_relaxed);
+}
+
+void VectorIndexWrapper::FinishBuildProgress() {
+  build_finish_time_ms_.store(Helper::TimestampMs(), std::memory_order_relaxed);
+}
+
+std::string VectorIndexWrapper::BuildProgress() {
+  int64_t start_time_ms = build_start_time_ms_.load(std::memory_order_relaxed);
+  if (start_time_ms == 0) {
+    return "";
+  }
+
+  int64_t finish_time_ms = build_finish_time_ms_.load(std::memory_order_relaxed);
+  int64_t elapsed_time_ms = (finish_time_ms > 0 ? finish_time_ms : Helper::TimestampMs()) - start_time_ms;
+  int64_t count = build_vector_count_.load(std::memory_order_relaxed);
+  double speed = elapsed_time_ms > 0 ? static_cast<double>(count) * 1000 / elapsed_time_ms : 0;
+
+  return fmt::format("build_progress(count({}) speed({:.1f}/s) elapsed({}ms) finish({}))", count, speed,
+                     elapsed_time_ms, finish_time_ms > 0);
+}
+
+void VectorIndexWrapper::Touch() {
+  last_access_time_ms_.store(Helper::TimestampMs(), std::memory_order_relaxed);
+  access_count_.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Halve the access count, so the history frequency fade out for LFU.
+void VectorIndexWrapper::DecayAccessCount() {
+  access_count_.store(access_count_.load(std::memory_order_relaxed) / 2, std::memory_order_relaxed);
+}
+
 int32_t VectorIndexWrapper::GetDimension() {
   auto vector_index = GetVectorIndex();
   if (vector_index == nullptr) {
@@ -498,7 +606,14 @@ butil::Status VectorIndexWrapper::GetMemorySize(int64_t& memory_size) {
     }
   }
 
-  memory_size = own_memory_size + sibling_memory_size;
+  // The train sample is part of the vector index memory, so it is under the memory budget.
+  int64_t train_sample_memory_size = 0;
+  auto train_sample = TrainSample();
+  if (train_sample != nullptr) {
+    train_sample_memory_size = train_sample->MemorySize();
+  }
+
+  memory_size = own_memory_size + sibling_memory_size + train_sample_memory_size;
 
   return status;
 }
@@ -525,7 +640,26 @@ bool VectorIndexWrapper::NeedToRebuild() {
     return false;
   }
 
-  return vector_index->NeedToRebuild();
+  return vector_index->NeedToRebuild() || NeedToRetrain() || NeedToRetrainOnImbalance();
+}
+
+bool VectorIndexWrapper::NeedToRetrain() {
+  auto vector_index = GetOwnVectorIndex();
+  auto train_sample = TrainSample();
+  if (vector_index == nullptr || train_sample == nullptr) {
+    return false;
+  }
+
+  return vector_index->NeedToRetrain(train_sample->Size());
+}
+
+bool VectorIndexWrapper::NeedToRetrainOnImbalance() {
+  auto vector_index = GetOwnVectorIndex();
+  if (vector_index == nullptr) {
+    return false;
+  }
+
+  return vector_index->NeedToRetrainOnImbalance(imbalance_retrain_num_.load(std::memory_order_relaxed));
 }
 
 bool VectorIndexWrapper::SupportSave() {
@@ -537,6 +671,15 @@ bool VectorIndexWrapper::SupportSave() {
   return vector_index->SupportSave();
 }
 
+bool VectorIndexWrapper::NeedToCompact() {
+  auto vector_index = GetOwnVectorIndex();
+  if (vector_index == nullptr) {
+    return false;
+  }
+
+  return vector_index->NeedToCompact();
+}
+
 bool VectorIndexWrapper::NeedToSave(std::string& reason) {
   auto vector_index = GetOwnVectorIndex();
   if (vector_index == nullptr) {
@@ -861,6 +1004,20 @@ butil::Status VectorIndexWrapper::Search(std::vector<pb::common::VectorWithId> v
     VectorIndexWrapper::SetVectorIndexFilter(vector_index, filters, min_vector_id, max_vector_id);
   }
 
+  // Merge concurrent searches without filter into one batch, flat/ivf are much faster on large query batch.
+  if (FLAGS_enable_vector_search_coalesce && filters.empty() && VectorSearchCoalescer::IsSupportCoalesce(Type())) {
+    auto key = VectorSearchCoalescer::GenCoalesceKey(topk, reconstruct, parameter);
+    return search_coalescer_->Search(
+        key, vector_with_ids,
+        [&](const std::vector<pb::common::VectorWithId>& batch_vector_with_ids,
+            std::vector<pb::index::VectorWithDistanceResult>& batch_results) -> butil::Status {
+          std::vector<std::shared_ptr<VectorIndex::FilterFunctor>> empty_filters;
+          return vector_index->Search(batch_vector_with_ids, topk, empty_filters, reconstruct, parameter,
+                                      batch_results);
+        },
+        results);
+  }
+
   return vector_index->Search(vector_with_ids, topk, filters, reconstruct, parameter, results);
 }
 
@@ -954,6 +1111,11 @@ butil::Status VectorIndexWrapper::SetVectorIndexFilter(
     } else {
       // do nothing
     }
+  } else if (vector_index->VectorIndexType() == pb::common::VECTOR_INDEX_TYPE_DISKANN) {
+    filters.push_back(std::make_shared<VectorIndex::RangeFilterFunctor>(min_vector_id, max_vector_id));
+  } else if (vector_index->VectorIndexType() == pb::common::VECTOR_INDEX_TYPE_BINARY_FLAT ||
+             vector_index->VectorIndexType() == pb::common::VECTOR_INDEX_TYPE_BINARY_IVF_FLAT) {
+    filters.push_back(std::make_shared<VectorIndex::RangeFilterFunctor>(min_vector_id, max_vector_id));
   }
 
   return butil::Status::OK();
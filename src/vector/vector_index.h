@@ -25,11 +25,14 @@
 #include "bthread/types.h"
 #include "butil/status.h"
 #include "common/runnable.h"
+#include "common/synchronization.h"
 #include "faiss/MetricType.h"
 #include "faiss/impl/IDSelector.h"
 #include "proto/common.pb.h"
 #include "proto/index.pb.h"
 #include "vector/vector_index_snapshot.h"
+#include "vector/vector_index_train_sample.h"
+#include "vector/vector_search_coalescer.h"
 
 namespace dingodb {
 
@@ -130,6 +133,20 @@ class VectorIndex {
     ~IvfPqListFilterFunctor() override = default;
   };
 
+  // List filter just for diskann
+  class DiskAnnListFilterFunctor : public ConcreteFilterFunctor {
+   public:
+    explicit DiskAnnListFilterFunctor(const std::vector<int64_t>& vector_ids) : ConcreteFilterFunctor(vector_ids) {}
+    ~DiskAnnListFilterFunctor() override = default;
+  };
+
+  // List filter just for binary flat and binary ivf flat
+  class BinaryListFilterFunctor : public ConcreteFilterFunctor {
+   public:
+    explicit BinaryListFilterFunctor(const std::vector<int64_t>& vector_ids) : ConcreteFilterFunctor(vector_ids) {}
+    ~BinaryListFilterFunctor() override = default;
+  };
+
   virtual int32_t GetDimension() = 0;
   virtual pb::common::MetricType GetMetricType() = 0;
   virtual butil::Status GetCount(int64_t& count);
@@ -167,9 +184,26 @@ class VectorIndex {
   virtual bool NeedToRebuild() = 0;
   virtual bool NeedTrain() { return false; }
   virtual bool IsTrained() { return true; }
+  // Whether retrain on the train sample, e.g. ivf index trained with too few vectors.
+  virtual bool NeedToRetrain([[maybe_unused]] int64_t train_sample_count) { return false; }
+  // Whether retrain because the ivf inverted lists are imbalance, the check interval back off by retrain_num.
+  virtual bool NeedToRetrainOnImbalance([[maybe_unused]] int32_t retrain_num) { return false; }
   virtual bool NeedToSave(int64_t last_save_log_behind) = 0;
   virtual bool SupportSave() { return false; }
 
+  // Reclaim the space of deleted vectors in background, e.g. purge the tombstones of ivf index.
+  virtual bool NeedToCompact() { return false; }
+  virtual butil::Status Compact() { return butil::Status::OK(); }
+
+  // Copy the vectors in [begin_vector_id, end_vector_id) to the empty target with the same parameter,
+  // reuse the trained centroids/graph instead of rebuild from rocksdb, e.g. derive the child vector index at split.
+  virtual bool SupportDerive() { return false; }
+  virtual butil::Status DeriveTo(int64_t begin_vector_id, int64_t end_vector_id, VectorIndex* target);
+
+  // Called after all region data is added when build, for the index which stage the data and build once,
+  // e.g. diskann.
+  virtual butil::Status Build() { return butil::Status::OK(); }
+
   virtual uint32_t WriteOpParallelNum() { return 1; }
 
   int64_t Id() const { return id; }
@@ -333,6 +367,28 @@ class VectorIndexWrapper : public std::enable_shared_from_this<VectorIndexWrappe
   void IncSavingNum();
   void DecSavingNum();
 
+  // Build progress of the running build/rebuild, show in task trace.
+  void ResetBuildProgress();
+  void IncBuildProgress(int64_t count);
+  void FinishBuildProgress();
+  std::string BuildProgress();
+
+  // Access statistics and evict state for the memory budget, see VectorIndexMemoryBudget.
+  void Touch();
+  int64_t LastAccessTimeMs() { return last_access_time_ms_.load(std::memory_order_relaxed); }
+  int64_t AccessCount() { return access_count_.load(std::memory_order_relaxed); }
+  void DecayAccessCount();
+  bool IsEvicted() { return evicted_.load(); }
+  void EvictVectorIndex(const std::string& trace);
+  // Wait the evicted vector index reloaded, return false when timeout.
+  bool WaitReload(int64_t timeout_ms);
+
+  VectorIndexTrainSamplePtr TrainSample();
+  // Replace the train sample by the one collected by the build scan.
+  void SetTrainSample(VectorIndexTrainSamplePtr train_sample);
+  void AddTrainSample(const std::vector<pb::common::VectorWithId>& vector_with_ids);
+  void DeleteTrainSample(const std::vector<int64_t>& vector_ids);
+
   int32_t GetDimension();
   pb::common::MetricType GetMetricType();
   butil::Status GetCount(int64_t& count);
@@ -341,8 +397,14 @@ class VectorIndexWrapper : public std::enable_shared_from_this<VectorIndexWrappe
   bool IsExceedsMaxElements();
 
   bool NeedToRebuild();
+  // Retrain on the train sample, check on every vector add so the ivf index is retrained once the sample is ready.
+  bool NeedToRetrain();
+  // Retrain on imbalance, back off when the retrain not help, e.g. the data is skewed by nature.
+  bool NeedToRetrainOnImbalance();
+  void IncImbalanceRetrainNum() { imbalance_retrain_num_.fetch_add(1, std::memory_order_relaxed); }
   bool NeedToSave(std::string& reason);
   bool SupportSave();
+  bool NeedToCompact();
 
   butil::Status Add(const std::vector<pb::common::VectorWithId>& vector_with_ids);
   butil::Status Upsert(const std::vector<pb::common::VectorWithId>& vector_with_ids);
@@ -406,6 +468,14 @@ class VectorIndexWrapper : public std::enable_shared_from_this<VectorIndexWrappe
   // Snapshot set
   vector_index::SnapshotMetaSetPtr snapshot_set_;
 
+  // Coalesce concurrent search
+  VectorSearchCoalescerPtr search_coalescer_;
+
+  // Train sample of ivf vector index, nullptr when not need train.
+  VectorIndexTrainSamplePtr train_sample_;
+  // Retrain count on imbalance, the interval of next check is doubled for each.
+  std::atomic<int32_t> imbalance_retrain_num_{0};
+
   std::atomic<int32_t> pending_task_num_;
   // vector index loadorbuilding num
   std::atomic<int32_t> loadorbuilding_num_;
@@ -414,6 +484,19 @@ class VectorIndexWrapper : public std::enable_shared_from_this<VectorIndexWrappe
   // vector index saving num
   std::atomic<int32_t> saving_num_;
 
+  // build progress, build start/finish time and added vector count.
+  std::atomic<int64_t> build_start_time_ms_{0};
+  std::atomic<int64_t> build_finish_time_ms_{0};
+  std::atomic<int64_t> build_vector_count_{0};
+
+  // last search/write access time and access count, used by memory budget evict policy.
+  std::atomic<int64_t> last_access_time_ms_{0};
+  std::atomic<int64_t> access_count_{0};
+  // vector index is evicted by memory budget, reload on next access.
+  std::atomic<bool> evicted_{false};
+  // count is 1 while evicted, the reload signal the waiting access.
+  BthreadCond reload_cond_;
+
   // write(add/update/delete) key count
   int64_t write_key_count_{0};
   int64_t last_save_write_key_count_{0};
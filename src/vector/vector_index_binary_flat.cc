@@ -0,0 +1,454 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "vector/vector_index_binary_flat.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <queue>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "butil/status.h"
+#include "common/logging.h"
+#include "common/synchronization.h"
+#include "faiss/IndexBinary.h"
+#include "faiss/IndexBinaryFlat.h"
+#include "faiss/IndexIDMap.h"
+#include "faiss/impl/IDSelector.h"
+#include "faiss/index_io.h"
+#include "fmt/core.h"
+#include "proto/common.pb.h"
+#include "proto/error.pb.h"
+#include "proto/index.pb.h"
+#include "vector/vector_index_utils.h"
+
+namespace dingodb {
+
+DEFINE_int64(binary_flat_need_save_count, 10000, "binary flat need save count");
+
+bvar::LatencyRecorder g_binary_flat_upsert_latency("dingo_binary_flat_upsert_latency");
+bvar::LatencyRecorder g_binary_flat_search_latency("dingo_binary_flat_search_latency");
+bvar::LatencyRecorder g_binary_flat_range_search_latency("dingo_binary_flat_range_search_latency");
+bvar::LatencyRecorder g_binary_flat_delete_latency("dingo_binary_flat_delete_latency");
+bvar::LatencyRecorder g_binary_flat_load_latency("dingo_binary_flat_load_latency");
+
+VectorIndexBinaryFlat::VectorIndexBinaryFlat(int64_t id, const pb::common::VectorIndexParameter& vector_index_parameter,
+                                             const pb::common::RegionEpoch& epoch, const pb::common::Range& range)
+    : VectorIndex(id, vector_index_parameter, epoch, range) {
+  metric_type_ = vector_index_parameter.binary_flat_parameter().metric_type();
+  dimension_ = vector_index_parameter.binary_flat_parameter().dimension();
+
+  raw_index_ = std::make_unique<faiss::IndexBinaryFlat>(dimension_);
+  index_id_map2_ = std::make_unique<faiss::IndexBinaryIDMap2>(raw_index_.get());
+}
+
+VectorIndexBinaryFlat::~VectorIndexBinaryFlat() { index_id_map2_->reset(); }
+
+butil::Status VectorIndexBinaryFlat::AddOrUpsert(const std::vector<pb::common::VectorWithId>& vector_with_ids,
+                                                 bool is_upsert) {
+  if (vector_with_ids.empty()) {
+    return butil::Status::OK();
+  }
+
+  const auto& [ids, status_ids] = VectorIndexUtils::CheckAndCopyBinaryVectorId(vector_with_ids, dimension_);
+  if (!status_ids.ok()) {
+    DINGO_LOG(ERROR) << status_ids.error_cstr();
+    return status_ids;
+  }
+
+  // fix lambda can not capture rvalue. change rvalue -> lvalue.
+  // c++ 20 fix this bug.
+  const std::unique_ptr<faiss::idx_t[]>& ids2 = ids;
+
+  const auto& [vectors, status] = VectorIndexUtils::CheckAndCopyBinaryVectorData(vector_with_ids, dimension_);
+  if (!status.ok()) {
+    DINGO_LOG(ERROR) << status.error_cstr();
+    return status;
+  }
+
+  // fix lambda can not capture rvalue. change rvalue -> lvalue.
+  // c++ 20 fix this bug.
+  const std::unique_ptr<uint8_t[]>& vectors2 = vectors;
+
+  BvarLatencyGuard bvar_guard(&g_binary_flat_upsert_latency);
+  RWLockWriteGuard guard(&rw_lock_);
+  std::thread([&]() {
+    if (is_upsert) {
+      faiss::IDSelectorArray sel(vector_with_ids.size(), ids2.get());
+      index_id_map2_->remove_ids(sel);
+    }
+    index_id_map2_->add_with_ids(vector_with_ids.size(), vectors2.get(), ids2.get());
+  }).join();
+
+  return butil::Status::OK();
+}
+
+butil::Status VectorIndexBinaryFlat::Upsert(const std::vector<pb::common::VectorWithId>& vector_with_ids) {
+  return AddOrUpsert(vector_with_ids, true);
+}
+
+butil::Status VectorIndexBinaryFlat::Add(const std::vector<pb::common::VectorWithId>& vector_with_ids) {
+  return AddOrUpsert(vector_with_ids, false);
+}
+
+butil::Status VectorIndexBinaryFlat::Delete(const std::vector<int64_t>& delete_ids) {
+  if (delete_ids.empty()) {
+    return butil::Status::OK();
+  }
+
+  const auto& [ids, status] = VectorIndexUtils::CopyVectorId(delete_ids);
+  if (!status.ok()) {
+    DINGO_LOG(ERROR) << status.error_cstr();
+    return status;
+  }
+
+  faiss::IDSelectorArray sel(delete_ids.size(), ids.get());
+
+  size_t remove_count = 0;
+  {
+    BvarLatencyGuard bvar_guard(&g_binary_flat_delete_latency);
+    RWLockWriteGuard guard(&rw_lock_);
+    std::thread([&]() { remove_count = index_id_map2_->remove_ids(sel); }).join();
+  }
+
+  if (0 == remove_count) {
+    DINGO_LOG(ERROR) << fmt::format("not found id : {}", id);
+    return butil::Status(pb::error::Errno::EVECTOR_INVALID, fmt::format("not found : {}", id));
+  }
+
+  return butil::Status::OK();
+}
+
+butil::Status VectorIndexBinaryFlat::Search(std::vector<pb::common::VectorWithId> vector_with_ids, uint32_t topk,
+                                            std::vector<std::shared_ptr<FilterFunctor>> filters, bool,
+                                            const pb::common::VectorSearchParameter&,
+                                            std::vector<pb::index::VectorWithDistanceResult>& results) {
+  if (vector_with_ids.empty()) {
+    DINGO_LOG(WARNING) << "vector_with_ids is empty";
+    return butil::Status::OK();
+  }
+
+  if (topk == 0) {
+    DINGO_LOG(WARNING) << "topk is invalid";
+    return butil::Status::OK();
+  }
+
+  std::vector<int32_t> distances;
+  distances.resize(topk * vector_with_ids.size(), 0);
+  std::vector<faiss::idx_t> labels;
+  labels.resize(topk * vector_with_ids.size(), -1);
+
+  const auto& [vectors, status] = VectorIndexUtils::CheckAndCopyBinaryVectorData(vector_with_ids, dimension_);
+  if (!status.ok()) {
+    DINGO_LOG(ERROR) << status.error_cstr();
+    return status;
+  }
+
+  // fix lambda can not capture rvalue. change rvalue -> lvalue.
+  // c++ 20 fix this bug.
+  const std::unique_ptr<uint8_t[]>& vectors2 = vectors;
+
+  {
+    BvarLatencyGuard bvar_guard(&g_binary_flat_search_latency);
+    RWLockReadGuard guard(&rw_lock_);
+    // use std::thread to call faiss functions
+    std::thread t([&]() {
+      if (!filters.empty()) {
+        DoSearchWithFilter(vector_with_ids.size(), vectors2.get(), topk, distances.data(), labels.data(), filters);
+      } else {
+        index_id_map2_->search(vector_with_ids.size(), vectors2.get(), topk, distances.data(), labels.data());
+      }
+    });
+    t.join();
+  }
+
+  VectorIndexUtils::FillBinarySearchResult(vector_with_ids, topk, distances, labels, dimension_, results);
+
+  DINGO_LOG(DEBUG) << "result.size() = " << results.size();
+
+  return butil::Status::OK();
+}
+
+butil::Status VectorIndexBinaryFlat::RangeSearch(std::vector<pb::common::VectorWithId> vector_with_ids, float radius,
+                                                 std::vector<std::shared_ptr<VectorIndex::FilterFunctor>> filters,
+                                                 bool /*reconstruct*/,
+                                                 const pb::common::VectorSearchParameter& /*parameter*/,
+                                                 std::vector<pb::index::VectorWithDistanceResult>& results) {
+  if (vector_with_ids.empty()) {
+    DINGO_LOG(WARNING) << "vector_with_ids is empty";
+    return butil::Status::OK();
+  }
+
+  const auto& [vectors, status] = VectorIndexUtils::CheckAndCopyBinaryVectorData(vector_with_ids, dimension_);
+  if (!status.ok()) {
+    DINGO_LOG(ERROR) << status.error_cstr();
+    return status;
+  }
+
+  // fix lambda can not capture rvalue. change rvalue -> lvalue.
+  // c++ 20 fix this bug.
+  const std::unique_ptr<uint8_t[]>& vectors2 = vectors;
+
+  std::vector<std::vector<std::pair<int32_t, faiss::idx_t>>> range_results;
+
+  {
+    BvarLatencyGuard bvar_guard(&g_binary_flat_range_search_latency);
+    RWLockReadGuard guard(&rw_lock_);
+    // use std::thread to call faiss functions
+    std::thread t([&]() {
+      DoRangeSearch(vector_with_ids.size(), vectors2.get(), static_cast<int32_t>(radius), filters, range_results);
+    });
+    t.join();
+  }
+
+  for (const auto& range_result : range_results) {
+    auto& result = results.emplace_back();
+    for (const auto& [distance, label] : range_result) {
+      auto* vector_with_distance = result.add_vector_with_distances();
+
+      auto* vector_with_id = vector_with_distance->mutable_vector_with_id();
+      vector_with_id->set_id(label);
+      vector_with_id->mutable_vector()->set_dimension(dimension_);
+      vector_with_id->mutable_vector()->set_value_type(::dingodb::pb::common::ValueType::UINT8);
+      vector_with_distance->set_distance(static_cast<float>(distance));
+      vector_with_distance->set_metric_type(metric_type_);
+    }
+  }
+
+  DINGO_LOG(DEBUG) << "result.size() = " << results.size();
+
+  return butil::Status::OK();
+}
+
+void VectorIndexBinaryFlat::DoSearchWithFilter(
+    faiss::idx_t n, const uint8_t* x, faiss::idx_t k, int32_t* distances, faiss::idx_t* labels,
+    const std::vector<std::shared_ptr<VectorIndex::FilterFunctor>>& filters) {
+  const auto* flat_index = dynamic_cast<const faiss::IndexBinaryFlat*>(index_id_map2_->index);
+  const auto& id_map = index_id_map2_->id_map;
+  size_t code_size = index_id_map2_->code_size;
+
+  for (faiss::idx_t q = 0; q < n; ++q) {
+    const uint8_t* query = x + q * code_size;
+
+    // max heap, top is the farthest one
+    std::priority_queue<std::pair<int32_t, faiss::idx_t>> heap;
+    for (faiss::idx_t i = 0; i < flat_index->ntotal; ++i) {
+      faiss::idx_t vector_id = id_map[i];
+      bool pass = true;
+      for (const auto& filter : filters) {
+        if (!filter->Check(vector_id)) {
+          pass = false;
+          break;
+        }
+      }
+      if (!pass) {
+        continue;
+      }
+
+      int32_t distance = VectorIndexUtils::HammingDistance(query, flat_index->xb.data() + i * code_size, code_size);
+      if (heap.size() < static_cast<size_t>(k)) {
+        heap.emplace(distance, vector_id);
+      } else if (distance < heap.top().first) {
+        heap.pop();
+        heap.emplace(distance, vector_id);
+      }
+    }
+
+    // fill from the tail, the nearest one is the first
+    for (faiss::idx_t j = heap.size(); j > 0; --j) {
+      distances[q * k + j - 1] = heap.top().first;
+      labels[q * k + j - 1] = heap.top().second;
+      heap.pop();
+    }
+  }
+}
+
+void VectorIndexBinaryFlat::DoRangeSearch(faiss::idx_t n, const uint8_t* x, int32_t radius,
+                                          const std::vector<std::shared_ptr<VectorIndex::FilterFunctor>>& filters,
+                                          std::vector<std::vector<std::pair<int32_t, faiss::idx_t>>>& results) {
+  const auto* flat_index = dynamic_cast<const faiss::IndexBinaryFlat*>(index_id_map2_->index);
+  const auto& id_map = index_id_map2_->id_map;
+  size_t code_size = index_id_map2_->code_size;
+
+  results.resize(n);
+  for (faiss::idx_t q = 0; q < n; ++q) {
+    const uint8_t* query = x + q * code_size;
+    for (faiss::idx_t i = 0; i < flat_index->ntotal; ++i) {
+      // same as faiss, the distance must be strictly less than radius
+      int32_t distance = VectorIndexUtils::HammingDistance(query, flat_index->xb.data() + i * code_size, code_size);
+      if (distance >= radius) {
+        continue;
+      }
+
+      faiss::idx_t vector_id = id_map[i];
+      bool pass = true;
+      for (const auto& filter : filters) {
+        if (!filter->Check(vector_id)) {
+          pass = false;
+          break;
+        }
+      }
+      if (pass) {
+        results[q].emplace_back(distance, vector_id);
+      }
+    }
+  }
+}
+
+void VectorIndexBinaryFlat::LockWrite() { rw_lock_.LockWrite(); }
+
+void VectorIndexBinaryFlat::UnlockWrite() { rw_lock_.UnlockWrite(); }
+
+butil::Status VectorIndexBinaryFlat::Save(const std::string& path) {
+  // Warning : read me first !!!!
+  // Currently, the save function is executed in the fork child process.
+  // When calling glog,
+  // the child process will hang.
+  // Remove glog temporarily.
+  if (BAIDU_UNLIKELY(path.empty())) {
+    std::string s = fmt::format("path empty. not support");
+    return butil::Status(pb::error::Errno::EILLEGAL_PARAMTETERS, s);
+  }
+
+  // The outside has been locked. Remove the locking operation here.
+  std::promise<butil::Status> promise_status;
+  std::future<butil::Status> future_status = promise_status.get_future();
+  std::thread t(
+      [&](std::promise<butil::Status>& promise_status) {
+        try {
+          faiss::write_index_binary(index_id_map2_.get(), path.c_str());
+          promise_status.set_value(butil::Status());
+        } catch (std::exception& e) {
+          std::string s = fmt::format(
+              "VectorIndexBinaryFlat::Save faiss::write_index_binary failed. path : {} error : {}", path, e.what());
+          promise_status.set_value(butil::Status(pb::error::Errno::EINTERNAL, s));
+        }
+      },
+      std::ref(promise_status));
+
+  butil::Status status = future_status.get();
+  t.join();
+
+  return status;
+}
+
+butil::Status VectorIndexBinaryFlat::Load(const std::string& path) {
+  if (BAIDU_UNLIKELY(path.empty())) {
+    std::string s = fmt::format("path empty. not support");
+    DINGO_LOG(ERROR) << s;
+    return butil::Status(pb::error::Errno::EILLEGAL_PARAMTETERS, s);
+  }
+
+  BvarLatencyGuard bvar_guard(&g_binary_flat_load_latency);
+
+  // The outside has been locked. Remove the locking operation here.
+  std::promise<std::pair<faiss::IndexBinary*, butil::Status>> promise_status;
+  std::future<std::pair<faiss::IndexBinary*, butil::Status>> future_status = promise_status.get_future();
+  std::thread t(
+      [&](std::promise<std::pair<faiss::IndexBinary*, butil::Status>>& promise_status) {
+        try {
+          faiss::IndexBinary* internal_raw_index = faiss::read_index_binary(path.c_str(), 0);
+          promise_status.set_value(
+              std::pair<faiss::IndexBinary*, butil::Status>(internal_raw_index, butil::Status()));
+        } catch (std::exception& e) {
+          std::string s = fmt::format(
+              "VectorIndexBinaryFlat::Load faiss::read_index_binary failed. path : {} error : {}", path, e.what());
+          promise_status.set_value(
+              std::pair<faiss::IndexBinary*, butil::Status>(nullptr, butil::Status(pb::error::Errno::EINTERNAL, s)));
+        }
+      },
+      std::ref(promise_status));
+
+  auto [internal_raw_index, status] = future_status.get();
+  t.join();
+
+  if (!status.ok()) {
+    DINGO_LOG(ERROR) << status.error_cstr();
+    delete internal_raw_index;
+    return status;
+  }
+
+  auto* internal_index = dynamic_cast<faiss::IndexBinaryIDMap2*>(internal_raw_index);
+  if (BAIDU_UNLIKELY(!internal_index || !dynamic_cast<faiss::IndexBinaryFlat*>(internal_index->index))) {
+    delete internal_raw_index;
+    std::string s = fmt::format("VectorIndexBinaryFlat::Load faiss::read_index_binary failed. Maybe not binary flat. "
+                                "path : {} ",
+                                path);
+    DINGO_LOG(ERROR) << s;
+    return butil::Status(pb::error::Errno::EINTERNAL, s);
+  }
+
+  // avoid mem leak!!!
+  std::unique_ptr<faiss::IndexBinaryIDMap2> internal_index_id_map2(internal_index);
+
+  // double check
+  if (BAIDU_UNLIKELY(internal_index->d != dimension_)) {
+    std::string s = fmt::format("VectorIndexBinaryFlat::Load load dimension : {} != dimension_ : {}. path : {}",
+                                internal_index->d, dimension_, path);
+    DINGO_LOG(ERROR) << s;
+    return butil::Status(pb::error::Errno::EINTERNAL, s);
+  }
+
+  raw_index_.reset();
+  index_id_map2_ = std::move(internal_index_id_map2);
+
+  DINGO_LOG(INFO) << fmt::format("VectorIndexBinaryFlat::Load success. path : {}", path);
+
+  return butil::Status::OK();
+}
+
+int32_t VectorIndexBinaryFlat::GetDimension() { return this->dimension_; }
+
+pb::common::MetricType VectorIndexBinaryFlat::GetMetricType() { return this->metric_type_; }
+
+butil::Status VectorIndexBinaryFlat::GetCount(int64_t& count) {
+  RWLockReadGuard guard(&rw_lock_);
+  count = index_id_map2_->id_map.size();
+  return butil::Status::OK();
+}
+
+butil::Status VectorIndexBinaryFlat::GetDeletedCount(int64_t& deleted_count) {
+  deleted_count = 0;
+  return butil::Status::OK();
+}
+
+butil::Status VectorIndexBinaryFlat::GetMemorySize(int64_t& memory_size) {
+  RWLockReadGuard guard(&rw_lock_);
+  auto count = index_id_map2_->ntotal;
+  if (count == 0) {
+    memory_size = 0;
+    return butil::Status::OK();
+  }
+
+  memory_size = count * sizeof(faiss::idx_t) + count * index_id_map2_->code_size +
+                (sizeof(faiss::idx_t) + sizeof(faiss::idx_t)) * index_id_map2_->rev_map.size();
+  return butil::Status::OK();
+}
+
+bool VectorIndexBinaryFlat::NeedToSave(int64_t last_save_log_behind) {
+  RWLockReadGuard guard(&rw_lock_);
+
+  if (index_id_map2_->id_map.empty()) {
+    return false;
+  }
+
+  return last_save_log_behind > FLAGS_binary_flat_need_save_count;
+}
+
+}  // namespace dingodb
@@ -0,0 +1,113 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGODB_VECTOR_INDEX_BINARY_FLAT_H_  // NOLINT
+#define DINGODB_VECTOR_INDEX_BINARY_FLAT_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "butil/status.h"
+#include "common/synchronization.h"
+#include "faiss/IndexBinary.h"
+#include "faiss/IndexBinaryFlat.h"
+#include "faiss/IndexIDMap.h"
+#include "proto/common.pb.h"
+#include "vector/vector_index.h"
+
+namespace dingodb {
+
+// Brute force index of binary vector with hamming distance.
+// dimension is the number of bits, each vector takes dimension / 8 bytes.
+class VectorIndexBinaryFlat : public VectorIndex {
+ public:
+  explicit VectorIndexBinaryFlat(int64_t id, const pb::common::VectorIndexParameter& vector_index_parameter,
+                                 const pb::common::RegionEpoch& epoch, const pb::common::Range& range);
+
+  ~VectorIndexBinaryFlat() override;
+
+  VectorIndexBinaryFlat(const VectorIndexBinaryFlat& rhs) = delete;
+  VectorIndexBinaryFlat& operator=(const VectorIndexBinaryFlat& rhs) = delete;
+  VectorIndexBinaryFlat(VectorIndexBinaryFlat&& rhs) = delete;
+  VectorIndexBinaryFlat& operator=(VectorIndexBinaryFlat&& rhs) = delete;
+
+  butil::Status Save(const std::string& path) override;
+  butil::Status Load(const std::string& path) override;
+
+  butil::Status Add(const std::vector<pb::common::VectorWithId>& vector_with_ids) override;
+
+  butil::Status AddOrUpsert(const std::vector<pb::common::VectorWithId>& vector_with_ids, bool is_upsert);
+
+  butil::Status Upsert(const std::vector<pb::common::VectorWithId>& vector_with_ids) override;
+
+  butil::Status Delete(const std::vector<int64_t>& delete_ids) override;
+
+  butil::Status Search(std::vector<pb::common::VectorWithId> vector_with_ids, uint32_t topk,
+                       std::vector<std::shared_ptr<FilterFunctor>> filters, bool reconstruct,
+                       const pb::common::VectorSearchParameter& parameter,
+                       std::vector<pb::index::VectorWithDistanceResult>& results) override;
+
+  butil::Status RangeSearch(std::vector<pb::common::VectorWithId> vector_with_ids, float radius,
+                            std::vector<std::shared_ptr<VectorIndex::FilterFunctor>> filters, bool reconstruct,
+                            const pb::common::VectorSearchParameter& parameter,
+                            std::vector<pb::index::VectorWithDistanceResult>& results) override;
+
+  void LockWrite() override;
+  void UnlockWrite() override;
+  bool SupportSave() override { return true; }
+
+  int32_t GetDimension() override;
+  pb::common::MetricType GetMetricType() override;
+  butil::Status GetCount(int64_t& count) override;
+  butil::Status GetDeletedCount(int64_t& deleted_count) override;
+  butil::Status GetMemorySize(int64_t& memory_size) override;
+  bool IsExceedsMaxElements() override { return false; }
+
+  butil::Status Train([[maybe_unused]] const std::vector<float>& train_datas) override { return butil::Status::OK(); }
+  butil::Status Train([[maybe_unused]] const std::vector<pb::common::VectorWithId>& vectors) override {
+    return butil::Status::OK();
+  }
+
+  bool NeedToRebuild() override { return false; }
+
+  bool NeedToSave(int64_t last_save_log_behind) override;
+
+ private:
+  // faiss binary flat does not take search parameters, scan the codes when there are filters.
+  void DoSearchWithFilter(faiss::idx_t n, const uint8_t* x, faiss::idx_t k, int32_t* distances, faiss::idx_t* labels,
+                          const std::vector<std::shared_ptr<VectorIndex::FilterFunctor>>& filters);
+
+  void DoRangeSearch(faiss::idx_t n, const uint8_t* x, int32_t radius,
+                     const std::vector<std::shared_ptr<VectorIndex::FilterFunctor>>& filters,
+                     std::vector<std::vector<std::pair<int32_t, faiss::idx_t>>>& results);
+
+  // Dimension of the elements, number of bits
+  faiss::idx_t dimension_;
+
+  // only support hamming
+  pb::common::MetricType metric_type_;
+
+  std::unique_ptr<faiss::IndexBinaryFlat> raw_index_;
+
+  std::unique_ptr<faiss::IndexBinaryIDMap2> index_id_map2_;
+
+  RWLock rw_lock_;
+};
+
+}  // namespace dingodb
+
+#endif  // DINGODB_VECTOR_INDEX_BINARY_FLAT_H_  // NOLINT
@@ -0,0 +1,704 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "vector/vector_index_binary_ivf_flat.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <queue>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "butil/compiler_specific.h"
+#include "butil/status.h"
+#include "common/constant.h"
+#include "common/logging.h"
+#include "faiss/Clustering.h"
+#include "faiss/IndexBinary.h"
+#include "faiss/IndexBinaryFlat.h"
+#include "faiss/IndexBinaryIVF.h"
+#include "faiss/impl/IDSelector.h"
+#include "faiss/index_io.h"
+#include "faiss/invlists/InvertedLists.h"
+#include "fmt/core.h"
+#include "proto/common.pb.h"
+#include "proto/error.pb.h"
+#include "proto/index.pb.h"
+#include "vector/vector_index_utils.h"
+
+namespace dingodb {
+
+DEFINE_int64(binary_ivf_flat_need_save_count, 10000, "binary ivf flat need save count");
+
+bvar::LatencyRecorder g_binary_ivf_flat_upsert_latency("dingo_binary_ivf_flat_upsert_latency");
+bvar::LatencyRecorder g_binary_ivf_flat_search_latency("dingo_binary_ivf_flat_search_latency");
+bvar::LatencyRecorder g_binary_ivf_flat_range_search_latency("dingo_binary_ivf_flat_range_search_latency");
+bvar::LatencyRecorder g_binary_ivf_flat_delete_latency("dingo_binary_ivf_flat_delete_latency");
+bvar::LatencyRecorder g_binary_ivf_flat_load_latency("dingo_binary_ivf_flat_load_latency");
+bvar::LatencyRecorder g_binary_ivf_flat_train_latency("dingo_binary_ivf_flat_train_latency");
+
+VectorIndexBinaryIvfFlat::VectorIndexBinaryIvfFlat(int64_t id,
+                                                   const pb::common::VectorIndexParameter& vector_index_parameter,
+                                                   const pb::common::RegionEpoch& epoch,
+                                                   const pb::common::Range& range)
+    : VectorIndex(id, vector_index_parameter, epoch, range) {
+  metric_type_ = vector_index_parameter.binary_ivf_flat_parameter().metric_type();
+  dimension_ = vector_index_parameter.binary_ivf_flat_parameter().dimension();
+
+  nlist_org_ = vector_index_parameter.binary_ivf_flat_parameter().ncentroids();
+  if (0 == nlist_org_) {
+    nlist_org_ = Constant::kCreateIvfFlatParamNcentroids;
+  }
+
+  nlist_ = nlist_org_;
+
+  train_data_size_ = 0;
+  // Delay object creation.
+}
+
+VectorIndexBinaryIvfFlat::~VectorIndexBinaryIvfFlat() = default;
+
+butil::Status VectorIndexBinaryIvfFlat::AddOrUpsert(const std::vector<pb::common::VectorWithId>& vector_with_ids,
+                                                    bool is_upsert) {
+  if (vector_with_ids.empty()) {
+    return butil::Status::OK();
+  }
+
+  const auto& [ids, status_ids] = VectorIndexUtils::CheckAndCopyBinaryVectorId(vector_with_ids, dimension_);
+  if (!status_ids.ok()) {
+    DINGO_LOG(ERROR) << status_ids.error_cstr();
+    return status_ids;
+  }
+
+  // fix lambda can not capture rvalue. change rvalue -> lvalue.
+  // c++ 20 fix this bug.
+  const std::unique_ptr<faiss::idx_t[]>& ids2 = ids;
+
+  const auto& [vectors, status] = VectorIndexUtils::CheckAndCopyBinaryVectorData(vector_with_ids, dimension_);
+  if (!status.ok()) {
+    DINGO_LOG(ERROR) << status.error_cstr();
+    return status;
+  }
+
+  // fix lambda can not capture rvalue. change rvalue -> lvalue.
+  // c++ 20 fix this bug.
+  const std::unique_ptr<uint8_t[]>& vectors2 = vectors;
+
+  BvarLatencyGuard bvar_guard(&g_binary_ivf_flat_upsert_latency);
+  RWLockWriteGuard guard(&rw_lock_);
+  if (BAIDU_UNLIKELY(!DoIsTrained())) {
+    std::string s = fmt::format("binary ivf flat not train. train first.");
+    DINGO_LOG(WARNING) << s;
+    return butil::Status(pb::error::Errno::EVECTOR_NOT_TRAIN, s);
+  }
+
+  std::thread([&]() {
+    if (is_upsert) {
+      faiss::IDSelectorArray sel(vector_with_ids.size(), ids2.get());
+      index_->remove_ids(sel);
+    }
+    index_->add_with_ids(vector_with_ids.size(), vectors2.get(), ids2.get());
+  }).join();
+
+  return butil::Status::OK();
+}
+
+butil::Status VectorIndexBinaryIvfFlat::AddOrUpsertWrapper(const std::vector<pb::common::VectorWithId>& vector_with_ids,
+                                                           bool is_upsert) {
+  auto status = AddOrUpsert(vector_with_ids, is_upsert);
+  if (BAIDU_UNLIKELY(pb::error::Errno::EVECTOR_NOT_TRAIN == status.error_code())) {
+    status = Train(vector_with_ids);
+    if (BAIDU_LIKELY(status.ok())) {
+      // try again
+      status = AddOrUpsert(vector_with_ids, is_upsert);
+      if (BAIDU_LIKELY(!status.ok())) {
+        DINGO_LOG(ERROR) << status;
+        return status;
+      }
+    } else {  // Train failed
+      DINGO_LOG(ERROR) << status;
+      return status;
+    }
+  }
+
+  return status;
+}
+
+butil::Status VectorIndexBinaryIvfFlat::Upsert(const std::vector<pb::common::VectorWithId>& vector_with_ids) {
+  return AddOrUpsertWrapper(vector_with_ids, true);
+}
+
+butil::Status VectorIndexBinaryIvfFlat::Add(const std::vector<pb::common::VectorWithId>& vector_with_ids) {
+  return AddOrUpsertWrapper(vector_with_ids, false);
+}
+
+butil::Status VectorIndexBinaryIvfFlat::Delete(const std::vector<int64_t>& delete_ids) {
+  if (delete_ids.empty()) {
+    return butil::Status::OK();
+  }
+
+  const auto& [ids, status] = VectorIndexUtils::CopyVectorId(delete_ids);
+  if (!status.ok()) {
+    DINGO_LOG(ERROR) << status.error_cstr();
+    return status;
+  }
+
+  faiss::IDSelectorArray sel(delete_ids.size(), ids.get());
+
+  size_t remove_count = 0;
+  {
+    BvarLatencyGuard bvar_guard(&g_binary_ivf_flat_delete_latency);
+    RWLockWriteGuard guard(&rw_lock_);
+    if (BAIDU_UNLIKELY(!DoIsTrained())) {
+      std::string s = fmt::format("binary ivf flat not train. train first. ignored");
+      DINGO_LOG(WARNING) << s;
+      return butil::Status::OK();
+    }
+
+    std::thread([&]() { remove_count = index_->remove_ids(sel); }).join();
+  }
+
+  if (0 == remove_count) {
+    DINGO_LOG(ERROR) << fmt::format("not found id : {}", id);
+    return butil::Status(pb::error::Errno::EVECTOR_INVALID, fmt::format("not found : {}", id));
+  }
+
+  return butil::Status::OK();
+}
+
+butil::Status VectorIndexBinaryIvfFlat::Search(std::vector<pb::common::VectorWithId> vector_with_ids, uint32_t topk,
+                                               std::vector<std::shared_ptr<FilterFunctor>> filters, bool,
+                                               const pb::common::VectorSearchParameter& parameter,
+                                               std::vector<pb::index::VectorWithDistanceResult>& results) {  // NOLINT
+  if (vector_with_ids.empty()) {
+    DINGO_LOG(WARNING) << "vector_with_ids is empty";
+    return butil::Status::OK();
+  }
+
+  if (topk == 0) {
+    DINGO_LOG(WARNING) << "topk is invalid";
+    return butil::Status::OK();
+  }
+
+  int32_t nprobe = parameter.binary_ivf_flat().nprobe();
+  if (BAIDU_UNLIKELY(nprobe <= 0)) {
+    DINGO_LOG(WARNING) << fmt::format(
+        "pb::common::VectorSearchParameter binary_ivf_flat nprobe : {} <=0. use default", nprobe);
+    nprobe = Constant::kSearchIvfFlatParamNprobe;
+  }
+
+  const auto& [vectors, status] = VectorIndexUtils::CheckAndCopyBinaryVectorData(vector_with_ids, dimension_);
+  if (!status.ok()) {
+    DINGO_LOG(ERROR) << status.error_cstr();
+    return status;
+  }
+
+  // fix lambda can not capture rvalue. change rvalue -> lvalue.
+  // c++ 20 fix this bug.
+  const std::unique_ptr<uint8_t[]>& vectors2 = vectors;
+
+  std::vector<std::vector<std::pair<int32_t, faiss::idx_t>>> search_results;
+  {
+    BvarLatencyGuard bvar_guard(&g_binary_ivf_flat_search_latency);
+    RWLockReadGuard guard(&rw_lock_);
+    if (BAIDU_UNLIKELY(!DoIsTrained())) {
+      std::string s = fmt::format("binary ivf flat not train. train first. ignored");
+      DINGO_LOG(WARNING) << s;
+
+      for (size_t row = 0; row < vector_with_ids.size(); ++row) {
+        results.emplace_back();
+      }
+
+      return butil::Status::OK();
+    }
+
+    // Prevent users from passing parameters out of bounds.
+    size_t real_nprobe = std::min(static_cast<size_t>(nprobe), index_->nlist);
+
+    // use std::thread to call faiss functions
+    std::thread t([&]() {
+      DoSearch(vector_with_ids.size(), vectors2.get(), topk, 0, real_nprobe, filters, search_results);
+    });
+    t.join();
+  }
+
+  std::vector<int32_t> distances(topk * vector_with_ids.size(), 0);
+  std::vector<faiss::idx_t> labels(topk * vector_with_ids.size(), -1);
+  for (size_t row = 0; row < search_results.size(); ++row) {
+    for (size_t i = 0; i < search_results[row].size(); ++i) {
+      distances[row * topk + i] = search_results[row][i].first;
+      labels[row * topk + i] = search_results[row][i].second;
+    }
+  }
+
+  VectorIndexUtils::FillBinarySearchResult(vector_with_ids, topk, distances, labels, dimension_, results);
+
+  DINGO_LOG(DEBUG) << "result.size() = " << results.size();
+
+  return butil::Status::OK();
+}
+
+butil::Status VectorIndexBinaryIvfFlat::RangeSearch(std::vector<pb::common::VectorWithId> vector_with_ids,
+                                                    float radius,
+                                                    std::vector<std::shared_ptr<VectorIndex::FilterFunctor>> filters,
+                                                    bool /*reconstruct*/,
+                                                    const pb::common::VectorSearchParameter& parameter,
+                                                    std::vector<pb::index::VectorWithDistanceResult>& results) {
+  if (vector_with_ids.empty()) {
+    DINGO_LOG(WARNING) << "vector_with_ids is empty";
+    return butil::Status::OK();
+  }
+
+  int32_t nprobe = parameter.binary_ivf_flat().nprobe();
+  if (BAIDU_UNLIKELY(nprobe <= 0)) {
+    DINGO_LOG(WARNING) << fmt::format(
+        "pb::common::VectorSearchParameter binary_ivf_flat nprobe : {} <=0. use default", nprobe);
+    nprobe = Constant::kSearchIvfFlatParamNprobe;
+  }
+
+  const auto& [vectors, status] = VectorIndexUtils::CheckAndCopyBinaryVectorData(vector_with_ids, dimension_);
+  if (!status.ok()) {
+    DINGO_LOG(ERROR) << status.error_cstr();
+    return status;
+  }
+
+  // fix lambda can not capture rvalue. change rvalue -> lvalue.
+  // c++ 20 fix this bug.
+  const std::unique_ptr<uint8_t[]>& vectors2 = vectors;
+
+  std::vector<std::vector<std::pair<int32_t, faiss::idx_t>>> range_results;
+  {
+    BvarLatencyGuard bvar_guard(&g_binary_ivf_flat_range_search_latency);
+    RWLockReadGuard guard(&rw_lock_);
+    if (BAIDU_UNLIKELY(!DoIsTrained())) {
+      std::string s = fmt::format("binary ivf flat not train. train first. ignored");
+      DINGO_LOG(WARNING) << s;
+
+      for (size_t row = 0; row < vector_with_ids.size(); ++row) {
+        results.emplace_back();
+      }
+
+      return butil::Status::OK();
+    }
+
+    // Prevent users from passing parameters out of bounds.
+    size_t real_nprobe = std::min(static_cast<size_t>(nprobe), index_->nlist);
+
+    // use std::thread to call faiss functions
+    std::thread t([&]() {
+      DoSearch(vector_with_ids.size(), vectors2.get(), 0, static_cast<int32_t>(radius), real_nprobe, filters,
+               range_results);
+    });
+    t.join();
+  }
+
+  for (const auto& range_result : range_results) {
+    auto& result = results.emplace_back();
+    for (const auto& [distance, label] : range_result) {
+      auto* vector_with_distance = result.add_vector_with_distances();
+
+      auto* vector_with_id = vector_with_distance->mutable_vector_with_id();
+      vector_with_id->set_id(label);
+      vector_with_id->mutable_vector()->set_dimension(dimension_);
+      vector_with_id->mutable_vector()->set_value_type(::dingodb::pb::common::ValueType::UINT8);
+      vector_with_distance->set_distance(static_cast<float>(distance));
+      vector_with_distance->set_metric_type(metric_type_);
+    }
+  }
+
+  DINGO_LOG(DEBUG) << "result.size() = " << results.size();
+
+  return butil::Status::OK();
+}
+
+void VectorIndexBinaryIvfFlat::DoSearch(faiss::idx_t n, const uint8_t* x, faiss::idx_t k, int32_t radius,
+                                        size_t nprobe,
+                                        const std::vector<std::shared_ptr<VectorIndex::FilterFunctor>>& filters,
+                                        std::vector<std::vector<std::pair<int32_t, faiss::idx_t>>>& results) {
+  size_t code_size = index_->code_size;
+
+  std::vector<int32_t> coarse_distances(n * nprobe);
+  std::vector<faiss::idx_t> coarse_ids(n * nprobe);
+  index_->quantizer->search(n, x, nprobe, coarse_distances.data(), coarse_ids.data());
+
+  results.resize(n);
+  for (faiss::idx_t q = 0; q < n; ++q) {
+    const uint8_t* query = x + q * code_size;
+
+    // max heap, top is the farthest one
+    std::priority_queue<std::pair<int32_t, faiss::idx_t>> heap;
+    for (size_t p = 0; p < nprobe; ++p) {
+      faiss::idx_t list_no = coarse_ids[q * nprobe + p];
+      if (list_no < 0) {
+        continue;
+      }
+
+      size_t list_size = index_->invlists->list_size(list_no);
+      if (list_size == 0) {
+        continue;
+      }
+
+      faiss::InvertedLists::ScopedCodes codes(index_->invlists, list_no);
+      faiss::InvertedLists::ScopedIds ids(index_->invlists, list_no);
+      for (size_t j = 0; j < list_size; ++j) {
+        faiss::idx_t vector_id = ids[j];
+        bool pass = true;
+        for (const auto& filter : filters) {
+          if (!filter->Check(vector_id)) {
+            pass = false;
+            break;
+          }
+        }
+        if (!pass) {
+          continue;
+        }
+
+        int32_t distance = VectorIndexUtils::HammingDistance(query, codes.get() + j * code_size, code_size);
+        if (k <= 0) {
+          if (distance < radius) {
+            results[q].emplace_back(distance, vector_id);
+          }
+        } else if (heap.size() < static_cast<size_t>(k)) {
+          heap.emplace(distance, vector_id);
+        } else if (distance < heap.top().first) {
+          heap.pop();
+          heap.emplace(distance, vector_id);
+        }
+      }
+    }
+
+    // the nearest one is the first
+    if (k > 0) {
+      results[q].resize(heap.size());
+      for (size_t j = heap.size(); j > 0; --j) {
+        results[q][j - 1] = heap.top();
+        heap.pop();
+      }
+    }
+  }
+}
+
+void VectorIndexBinaryIvfFlat::LockWrite() { rw_lock_.LockWrite(); }
+
+void VectorIndexBinaryIvfFlat::UnlockWrite() { rw_lock_.UnlockWrite(); }
+
+butil::Status VectorIndexBinaryIvfFlat::Save(const std::string& path) {
+  // Warning : read me first !!!!
+  // Currently, the save function is executed in the fork child process.
+  // When calling glog,
+  // the child process will hang.
+  // Remove glog temporarily.
+  if (BAIDU_UNLIKELY(path.empty())) {
+    std::string s = fmt::format("path empty. not support");
+    return butil::Status(pb::error::Errno::EILLEGAL_PARAMTETERS, s);
+  }
+
+  // The outside has been locked. Remove the locking operation here.
+  std::promise<butil::Status> promise_status;
+  std::future<butil::Status> future_status = promise_status.get_future();
+  std::thread t(
+      [&](std::promise<butil::Status>& promise_status) {
+        try {
+          faiss::write_index_binary(index_.get(), path.c_str());
+          promise_status.set_value(butil::Status());
+        } catch (std::exception& e) {
+          std::string s = fmt::format(
+              "VectorIndexBinaryIvfFlat::Save faiss::write_index_binary failed. path : {} error : {}", path, e.what());
+          promise_status.set_value(butil::Status(pb::error::Errno::EINTERNAL, s));
+        }
+      },
+      std::ref(promise_status));
+
+  butil::Status status = future_status.get();
+  t.join();
+
+  return status;
+}
+
+butil::Status VectorIndexBinaryIvfFlat::Load(const std::string& path) {
+  if (BAIDU_UNLIKELY(path.empty())) {
+    std::string s = fmt::format("path empty. not support");
+    DINGO_LOG(ERROR) << s;
+    return butil::Status(pb::error::Errno::EILLEGAL_PARAMTETERS, s);
+  }
+
+  BvarLatencyGuard bvar_guard(&g_binary_ivf_flat_load_latency);
+
+  // The outside has been locked. Remove the locking operation here.
+  std::promise<std::pair<faiss::IndexBinary*, butil::Status>> promise_status;
+  std::future<std::pair<faiss::IndexBinary*, butil::Status>> future_status = promise_status.get_future();
+  std::thread t(
+      [&](std::promise<std::pair<faiss::IndexBinary*, butil::Status>>& promise_status) {
+        try {
+          faiss::IndexBinary* internal_raw_index = faiss::read_index_binary(path.c_str(), 0);
+          promise_status.set_value(
+              std::pair<faiss::IndexBinary*, butil::Status>(internal_raw_index, butil::Status()));
+        } catch (std::exception& e) {
+          std::string s = fmt::format(
+              "VectorIndexBinaryIvfFlat::Load faiss::read_index_binary failed. path : {} error : {}", path, e.what());
+          promise_status.set_value(
+              std::pair<faiss::IndexBinary*, butil::Status>(nullptr, butil::Status(pb::error::Errno::EINTERNAL, s)));
+        }
+      },
+      std::ref(promise_status));
+
+  auto [internal_raw_index, status] = future_status.get();
+  t.join();
+
+  if (!status.ok()) {
+    DINGO_LOG(ERROR) << status.error_cstr();
+    delete internal_raw_index;
+    return status;
+  }
+
+  auto* internal_index = dynamic_cast<faiss::IndexBinaryIVF*>(internal_raw_index);
+  if (BAIDU_UNLIKELY(!internal_index)) {
+    delete internal_raw_index;
+    std::string s = fmt::format(
+        "VectorIndexBinaryIvfFlat::Load faiss::read_index_binary failed. Maybe not IndexBinaryIVF. path : {} ", path);
+    DINGO_LOG(ERROR) << s;
+    return butil::Status(pb::error::Errno::EINTERNAL, s);
+  }
+
+  // avoid mem leak!!!
+  std::unique_ptr<faiss::IndexBinaryIVF> internal_index_binary_ivf(internal_index);
+
+  // double check
+  if (BAIDU_UNLIKELY(internal_index->d != dimension_)) {
+    std::string s = fmt::format("VectorIndexBinaryIvfFlat::Load load dimension : {} != dimension_ : {}. path : {}",
+                                internal_index->d, dimension_, path);
+    DINGO_LOG(ERROR) << s;
+    return butil::Status(pb::error::Errno::EINTERNAL, s);
+  }
+
+  if (BAIDU_UNLIKELY(!internal_index->is_trained)) {
+    std::string s = fmt::format("VectorIndexBinaryIvfFlat::Load load is not train. path : {}", path);
+    DINGO_LOG(ERROR) << s;
+    return butil::Status(pb::error::Errno::EINTERNAL, s);
+  }
+
+  if (BAIDU_UNLIKELY(internal_index->nlist != nlist_ && internal_index->nlist != nlist_org_)) {
+    std::string s =
+        fmt::format("VectorIndexBinaryIvfFlat::Load load list : {} != (nlist_:{} or nlist_org_ : {}). path : {}",
+                    internal_index->nlist, nlist_, nlist_org_, path);
+    DINGO_LOG(ERROR) << s;
+    return butil::Status(pb::error::Errno::EINTERNAL, s);
+  }
+
+  quantizer_.reset();
+  index_ = std::move(internal_index_binary_ivf);
+
+  nlist_ = index_->nlist;
+  train_data_size_ = index_->ntotal;
+
+  DINGO_LOG(INFO) << fmt::format("VectorIndexBinaryIvfFlat::Load success. path : {}", path);
+
+  return butil::Status::OK();
+}
+
+int32_t VectorIndexBinaryIvfFlat::GetDimension() { return this->dimension_; }
+
+pb::common::MetricType VectorIndexBinaryIvfFlat::GetMetricType() { return this->metric_type_; }
+
+butil::Status VectorIndexBinaryIvfFlat::GetCount(int64_t& count) {
+  RWLockReadGuard guard(&rw_lock_);
+  if (DoIsTrained()) {
+    count = index_->ntotal;
+  } else {
+    count = 0;
+  }
+  return butil::Status::OK();
+}
+
+butil::Status VectorIndexBinaryIvfFlat::GetDeletedCount(int64_t& deleted_count) {
+  deleted_count = 0;
+  return butil::Status::OK();
+}
+
+butil::Status VectorIndexBinaryIvfFlat::GetMemorySize(int64_t& memory_size) {
+  RWLockReadGuard guard(&rw_lock_);
+
+  if (BAIDU_UNLIKELY(!DoIsTrained())) {
+    memory_size = 0;
+    return butil::Status::OK();
+  }
+
+  auto count = index_->ntotal;
+  if (count == 0) {
+    memory_size = 0;
+    return butil::Status::OK();
+  }
+
+  memory_size = count * sizeof(faiss::idx_t) + count * index_->code_size + nlist_ * index_->code_size;
+  return butil::Status::OK();
+}
+
+butil::Status VectorIndexBinaryIvfFlat::Train([[maybe_unused]] const std::vector<float>& train_datas) {
+  std::string s = fmt::format("binary ivf flat not support train by float data");
+  DINGO_LOG(ERROR) << s;
+  return butil::Status(pb::error::Errno::EVECTOR_NOT_SUPPORT, s);
+}
+
+butil::Status VectorIndexBinaryIvfFlat::Train(const std::vector<pb::common::VectorWithId>& vectors) {
+  size_t data_size = vectors.size();
+  if (BAIDU_UNLIKELY(0 == data_size)) {
+    std::string s = fmt::format("train_datas zero not support ");
+    DINGO_LOG(ERROR) << s;
+    return butil::Status(pb::error::Errno::EINTERNAL, s);
+  }
+
+  const auto& [train_datas, status_copy] = VectorIndexUtils::CheckAndCopyBinaryVectorData(vectors, dimension_);
+  if (!status_copy.ok()) {
+    DINGO_LOG(ERROR) << status_copy.error_cstr();
+    return status_copy;
+  }
+
+  // fix lambda can not capture rvalue. change rvalue -> lvalue.
+  // c++ 20 fix this bug.
+  const std::unique_ptr<uint8_t[]>& train_datas2 = train_datas;
+
+  faiss::ClusteringParameters clustering_parameters;
+  if (BAIDU_UNLIKELY(data_size < (clustering_parameters.min_points_per_centroid * nlist_))) {
+    std::string s = fmt::format("train_datas size : {} not enough. suggest at least : {}.  ignore", data_size,
+                                clustering_parameters.min_points_per_centroid * nlist_);
+    DINGO_LOG(WARNING) << s;
+  }
+
+  BvarLatencyGuard bvar_guard(&g_binary_ivf_flat_train_latency);
+  RWLockWriteGuard guard(&rw_lock_);
+  if (BAIDU_UNLIKELY(DoIsTrained())) {
+    std::string s = fmt::format("already trained . ignore");
+    DINGO_LOG(WARNING) << s;
+    return butil::Status::OK();
+  }
+
+  // critical code
+  if (BAIDU_UNLIKELY(data_size < nlist_)) {
+    std::string s = fmt::format("train_datas size : {} too small. nlist : {} degenerate to 1", data_size, nlist_);
+    DINGO_LOG(WARNING) << s;
+    nlist_ = 1;
+  }
+
+  // init index
+  Init();
+
+  train_data_size_ = 0;
+
+  std::promise<butil::Status> promise_status;
+  std::future<butil::Status> future_status = promise_status.get_future();
+  std::thread t(
+      [&](std::promise<butil::Status>& promise_status) {
+        try {
+          index_->train(data_size, train_datas2.get());
+          promise_status.set_value(butil::Status());
+        } catch (std::exception& e) {
+          std::string s = fmt::format("binary ivf flat train failed data size : {} dimension : {} exception {}",
+                                      data_size, dimension_, e.what());
+          promise_status.set_value(butil::Status(pb::error::Errno::EINTERNAL, s));
+        }
+      },
+      std::ref(promise_status));
+
+  butil::Status status = future_status.get();
+  t.join();
+
+  if (!status.ok()) {
+    Reset();
+    DINGO_LOG(ERROR) << status.error_cstr();
+    return status;
+  }
+
+  // double check
+  if (BAIDU_UNLIKELY(!index_->is_trained)) {
+    Reset();
+    std::string s = fmt::format("binary ivf flat train failed. data size : {} dimension : {}. internal error",
+                                data_size, dimension_);
+    DINGO_LOG(ERROR) << s;
+    return butil::Status(pb::error::Errno::EINTERNAL, s);
+  }
+
+  train_data_size_ = data_size;
+
+  return butil::Status::OK();
+}
+
+bool VectorIndexBinaryIvfFlat::NeedToRebuild() {
+  RWLockReadGuard guard(&rw_lock_);
+
+  if (BAIDU_UNLIKELY(!DoIsTrained())) {
+    return false;
+  }
+
+  faiss::ClusteringParameters clustering_parameters;
+
+  // nlist always = 1 not train , flat actually.
+  if (BAIDU_UNLIKELY(nlist_ == nlist_org_ && 1 == nlist_)) {
+    return false;
+  }
+
+  if (BAIDU_UNLIKELY(nlist_ != nlist_org_ && 1 == nlist_ &&
+                     index_->ntotal >= clustering_parameters.max_points_per_centroid * nlist_org_)) {
+    return true;
+  }
+
+  if (BAIDU_UNLIKELY(nlist_ == nlist_org_ && 1 != nlist_ &&
+                     index_->ntotal >= clustering_parameters.max_points_per_centroid * nlist_org_)) {
+    return train_data_size_ <= (index_->ntotal / 2);
+  }
+
+  return false;
+}
+
+bool VectorIndexBinaryIvfFlat::IsTrained() {
+  RWLockReadGuard guard(&rw_lock_);
+  return DoIsTrained();
+}
+
+bool VectorIndexBinaryIvfFlat::NeedToSave(int64_t last_save_log_behind) {
+  RWLockReadGuard guard(&rw_lock_);
+  if (BAIDU_UNLIKELY(!DoIsTrained())) {
+    return false;
+  }
+
+  if (index_->ntotal == 0) {
+    return false;
+  }
+
+  return last_save_log_behind > FLAGS_binary_ivf_flat_need_save_count;
+}
+
+void VectorIndexBinaryIvfFlat::Init() {
+  quantizer_ = std::make_unique<faiss::IndexBinaryFlat>(dimension_);
+  index_ = std::make_unique<faiss::IndexBinaryIVF>(quantizer_.get(), dimension_, nlist_);
+}
+
+bool VectorIndexBinaryIvfFlat::DoIsTrained() {
+  if ((index_ && !quantizer_ && index_->own_fields) || (quantizer_ && index_ && !index_->own_fields)) {
+    return index_->is_trained;
+  }
+  return false;
+}
+
+void VectorIndexBinaryIvfFlat::Reset() {
+  quantizer_->reset();
+  index_->reset();
+  nlist_ = nlist_org_;
+}
+
+}  // namespace dingodb
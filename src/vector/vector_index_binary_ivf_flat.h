@@ -0,0 +1,127 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGODB_VECTOR_INDEX_BINARY_IVF_FLAT_H_  // NOLINT
+#define DINGODB_VECTOR_INDEX_BINARY_IVF_FLAT_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "butil/status.h"
+#include "common/synchronization.h"
+#include "faiss/IndexBinary.h"
+#include "faiss/IndexBinaryIVF.h"
+#include "proto/common.pb.h"
+#include "vector/vector_index.h"
+
+namespace dingodb {
+
+// Inverted file index of binary vector with hamming distance, the centroids are trained by binary kmeans.
+// Same lifecycle as ivf flat, the first add trains the index if it is not trained.
+class VectorIndexBinaryIvfFlat : public VectorIndex {
+ public:
+  explicit VectorIndexBinaryIvfFlat(int64_t id, const pb::common::VectorIndexParameter& vector_index_parameter,
+                                    const pb::common::RegionEpoch& epoch, const pb::common::Range& range);
+
+  ~VectorIndexBinaryIvfFlat() override;
+
+  VectorIndexBinaryIvfFlat(const VectorIndexBinaryIvfFlat& rhs) = delete;
+  VectorIndexBinaryIvfFlat& operator=(const VectorIndexBinaryIvfFlat& rhs) = delete;
+  VectorIndexBinaryIvfFlat(VectorIndexBinaryIvfFlat&& rhs) = delete;
+  VectorIndexBinaryIvfFlat& operator=(VectorIndexBinaryIvfFlat&& rhs) = delete;
+
+  butil::Status Save(const std::string& path) override;
+  butil::Status Load(const std::string& path) override;
+  bool SupportSave() override { return true; }
+
+  butil::Status Add(const std::vector<pb::common::VectorWithId>& vector_with_ids) override;
+
+  butil::Status AddOrUpsertWrapper(const std::vector<pb::common::VectorWithId>& vector_with_ids, bool is_upsert);
+
+  butil::Status Upsert(const std::vector<pb::common::VectorWithId>& vector_with_ids) override;
+
+  butil::Status Delete(const std::vector<int64_t>& delete_ids) override;
+
+  butil::Status Search(std::vector<pb::common::VectorWithId> vector_with_ids, uint32_t topk,
+                       std::vector<std::shared_ptr<FilterFunctor>> filters, bool reconstruct,
+                       const pb::common::VectorSearchParameter& parameter,
+                       std::vector<pb::index::VectorWithDistanceResult>& results) override;
+
+  butil::Status RangeSearch(std::vector<pb::common::VectorWithId> vector_with_ids, float radius,
+                            std::vector<std::shared_ptr<VectorIndex::FilterFunctor>> filters, bool reconstruct,
+                            const pb::common::VectorSearchParameter& parameter,
+                            std::vector<pb::index::VectorWithDistanceResult>& results) override;
+
+  void LockWrite() override;
+  void UnlockWrite() override;
+
+  int32_t GetDimension() override;
+  pb::common::MetricType GetMetricType() override;
+  butil::Status GetCount(int64_t& count) override;
+  butil::Status GetDeletedCount(int64_t& deleted_count) override;
+  butil::Status GetMemorySize(int64_t& memory_size) override;
+  bool IsExceedsMaxElements() override { return false; }
+
+  // binary vector can not be trained from float data
+  butil::Status Train(const std::vector<float>& train_datas) override;
+  butil::Status Train(const std::vector<pb::common::VectorWithId>& vectors) override;
+  bool NeedToRebuild() override;
+  bool NeedTrain() override { return true; }
+  bool IsTrained() override;
+  bool NeedToSave(int64_t last_save_log_behind) override;
+
+ private:
+  void Init();
+
+  bool DoIsTrained();
+
+  // train failed. reset
+  void Reset();
+
+  butil::Status AddOrUpsert(const std::vector<pb::common::VectorWithId>& vector_with_ids, bool is_upsert);
+
+  // scan the nprobe nearest lists of each query, filters are applied before computing distance.
+  // k > 0 keeps the k nearest ones, else keeps all the ones whose distance < radius.
+  void DoSearch(faiss::idx_t n, const uint8_t* x, faiss::idx_t k, int32_t radius, size_t nprobe,
+                const std::vector<std::shared_ptr<VectorIndex::FilterFunctor>>& filters,
+                std::vector<std::vector<std::pair<int32_t, faiss::idx_t>>>& results);
+
+  // Dimension of the elements, number of bits
+  faiss::idx_t dimension_;
+
+  // only support hamming
+  pb::common::MetricType metric_type_;
+
+  RWLock rw_lock_;
+
+  // maybe 1 or vector_index_parameter.binary_ivf_flat_parameter().ncentroids()
+  size_t nlist_;
+
+  // from vector_index_parameter.binary_ivf_flat_parameter().ncentroids()
+  size_t nlist_org_;
+
+  std::unique_ptr<faiss::IndexBinary> quantizer_;
+
+  std::unique_ptr<faiss::IndexBinaryIVF> index_;
+
+  // first train data size
+  faiss::idx_t train_data_size_;
+};
+
+}  // namespace dingodb
+
+#endif  // DINGODB_VECTOR_INDEX_BINARY_IVF_FLAT_H_  // NOLINT
@@ -0,0 +1,904 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifdef USE_DISKANN
+
+#include "vector/vector_index_diskann.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "butil/status.h"
+#include "common/helper.h"
+#include "common/logging.h"
+#include "common/synchronization.h"
+#include "disk_utils.h"
+#include "distance.h"
+#include "fmt/core.h"
+#include "gflags/gflags.h"
+#include "linux_aligned_file_reader.h"
+#include "pq_flash_index.h"
+#include "proto/common.pb.h"
+#include "proto/error.pb.h"
+#include "proto/index.pb.h"
+#include "vector/vector_index_flat.h"
+#include "vector/vector_index_utils.h"
+
+namespace dingodb {
+
+DEFINE_string(diskann_data_path, "./data/diskann", "diskann index file path, must be on local SSD");
+DEFINE_uint32(diskann_pq_bytes_per_vector, 32, "diskann in memory PQ code bytes per vector");
+DEFINE_double(diskann_build_dram_budget_gb, 4.0, "diskann build memory budget in GB");
+DEFINE_uint32(diskann_build_threads, 8, "diskann build threads, used when num_threads of parameter is 0");
+DEFINE_uint32(diskann_build_search_list_size, 100, "diskann build candidate list size");
+DEFINE_int64(diskann_min_build_count, 10000, "less than this count, vectors stay in the in-memory fresh index");
+DEFINE_uint32(diskann_search_threads, 16, "diskann max concurrent search per index");
+DEFINE_uint32(diskann_search_list_size, 100, "diskann default search candidate list size");
+DEFINE_uint32(diskann_search_beam_width, 4, "diskann default search beam width, max io requests per hop");
+DEFINE_uint32(diskann_cache_node_count, 10000, "diskann cached graph nodes around the medoid");
+DEFINE_int64(diskann_max_search_k, 4096, "diskann max k of beam search when over fetching for tombstones and filters");
+DEFINE_int64(diskann_max_fresh_vector_count, 100000, "diskann need rebuild when fresh vector count exceed");
+DEFINE_int64(diskann_need_save_count, 10000, "diskann need save count");
+
+bvar::LatencyRecorder g_diskann_upsert_latency("dingo_diskann_upsert_latency");
+bvar::LatencyRecorder g_diskann_search_latency("dingo_diskann_search_latency");
+bvar::LatencyRecorder g_diskann_delete_latency("dingo_diskann_delete_latency");
+bvar::LatencyRecorder g_diskann_build_latency("dingo_diskann_build_latency");
+bvar::LatencyRecorder g_diskann_load_latency("dingo_diskann_load_latency");
+
+namespace {
+
+constexpr uint32_t kDiskAnnMetaMagic = 0x44414e4e;  // DANN
+constexpr uint32_t kDiskAnnMetaVersion = 1;
+
+template <typename T>
+void WriteValue(std::ofstream& writer, const T& value) {
+  writer.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool ReadValue(std::ifstream& reader, T& value) {
+  reader.read(reinterpret_cast<char*>(&value), sizeof(T));
+  return reader.good();
+}
+
+// Hard link is enough, the index files are immutable. Fallback to copy when cross device.
+// No log here, it is called in the fork child process when save.
+bool LinkOrCopyFile(const std::string& from, const std::string& to) {
+  std::error_code ec;
+  std::filesystem::remove(to, ec);
+  std::filesystem::create_hard_link(from, to, ec);
+  if (!ec) {
+    return true;
+  }
+
+  ec.clear();
+  std::filesystem::copy_file(from, to, std::filesystem::copy_options::overwrite_existing, ec);
+  return !ec;
+}
+
+std::vector<std::string> ListFileNames(const std::string& dir, const std::string& prefix) {
+  std::vector<std::string> filenames;
+  std::error_code ec;
+  for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+    auto filename = entry.path().filename().string();
+    if (entry.is_regular_file() && filename.find(prefix) == 0) {
+      filenames.push_back(filename);
+    }
+  }
+
+  return filenames;
+}
+
+}  // namespace
+
+VectorIndexDiskAnn::VectorIndexDiskAnn(int64_t id, const pb::common::VectorIndexParameter& vector_index_parameter,
+                                       const pb::common::RegionEpoch& epoch, const pb::common::Range& range)
+    : VectorIndex(id, vector_index_parameter, epoch, range) {
+  const auto& diskann_parameter = vector_index_parameter.diskann_parameter();
+  dimension_ = diskann_parameter.dimension();
+  metric_type_ = diskann_parameter.metric_type();
+  max_degree_ = diskann_parameter.num_neighbors();
+  build_threads_ =
+      diskann_parameter.num_threads() > 0 ? diskann_parameter.num_threads() : FLAGS_diskann_build_threads;
+
+  work_dir_ = fmt::format("{}/{}/{}", FLAGS_diskann_data_path, id, Helper::TimestampNs());
+  staging_path_ = fmt::format("{}/staging.bin", work_dir_);
+
+  auto status = Helper::CreateDirectories(work_dir_);
+  if (!status.ok()) {
+    DINGO_LOG(ERROR) << fmt::format("[vector_index.diskann][id({})] create work dir {} failed, error: {}", id,
+                                    work_dir_, status.error_str());
+  }
+
+  pb::common::VectorIndexParameter flat_parameter;
+  flat_parameter.set_vector_index_type(pb::common::VectorIndexType::VECTOR_INDEX_TYPE_FLAT);
+  flat_parameter.mutable_flat_parameter()->set_dimension(dimension_);
+  flat_parameter.mutable_flat_parameter()->set_metric_type(metric_type_);
+  fresh_index_ = std::make_shared<VectorIndexFlat>(id, flat_parameter, epoch, range);
+}
+
+VectorIndexDiskAnn::~VectorIndexDiskAnn() {
+  disk_index_.reset();
+  if (staging_file_.is_open()) {
+    staging_file_.close();
+  }
+  Helper::RemoveAllFileOrDirectory(work_dir_);
+}
+
+std::string VectorIndexDiskAnn::Prefix() const { return fmt::format("{}/{}", work_dir_, generation_); }
+
+bool VectorIndexDiskAnn::IsDiskId(int64_t vector_id) const {
+  return std::binary_search(disk_ids_.begin(), disk_ids_.end(), vector_id);
+}
+
+// Keep the same distance semantic as flat index, L2 is squared l2, inner product and cosine are 1 - ip.
+float VectorIndexDiskAnn::ConvertDistance(float distance) const {
+  switch (metric_type_) {
+    case pb::common::MetricType::METRIC_TYPE_INNER_PRODUCT:
+      // diskann return ip for inner product
+      return 1.0F - distance;
+    case pb::common::MetricType::METRIC_TYPE_COSINE:
+      // cosine is built as l2 on normalized vectors, |a - b|^2 = 2 - 2 * cos
+      return distance / 2.0F;
+    default:
+      return distance;
+  }
+}
+
+butil::Status VectorIndexDiskAnn::OpenStagingFile() {
+  if (staging_file_.is_open()) {
+    return butil::Status::OK();
+  }
+
+  staging_file_.open(staging_path_, std::ios::binary | std::ios::out | std::ios::trunc);
+  if (!staging_file_.is_open()) {
+    return butil::Status(pb::error::Errno::EINTERNAL, fmt::format("open staging file {} failed", staging_path_));
+  }
+
+  return butil::Status::OK();
+}
+
+butil::Status VectorIndexDiskAnn::ReadStagingVector(std::ifstream& reader, int64_t offset,
+                                                    std::vector<float>& values) {
+  int64_t record_size = sizeof(int64_t) + dimension_ * sizeof(float);
+  values.resize(dimension_);
+  reader.seekg(offset * record_size + sizeof(int64_t));
+  reader.read(reinterpret_cast<char*>(values.data()), dimension_ * sizeof(float));
+  if (!reader.good()) {
+    return butil::Status(pb::error::Errno::EINTERNAL, fmt::format("read staging file failed, offset: {}", offset));
+  }
+
+  return butil::Status::OK();
+}
+
+butil::Status VectorIndexDiskAnn::AddOrUpsert(const std::vector<pb::common::VectorWithId>& vector_with_ids) {
+  if (vector_with_ids.empty()) {
+    return butil::Status::OK();
+  }
+
+  for (const auto& vector_with_id : vector_with_ids) {
+    if (vector_with_id.vector().float_values_size() != static_cast<int32_t>(dimension_)) {
+      std::string s = fmt::format("vector dimension not match, {} {}", vector_with_id.vector().float_values_size(),
+                                  dimension_);
+      DINGO_LOG(ERROR) << fmt::format("[vector_index.diskann][id({})] {}", Id(), s);
+      return butil::Status(pb::error::Errno::EVECTOR_INVALID, s);
+    }
+  }
+
+  BvarLatencyGuard bvar_guard(&g_diskann_upsert_latency);
+  RWLockWriteGuard guard(&rw_lock_);
+
+  if (!built_) {
+    auto status = OpenStagingFile();
+    if (!status.ok()) {
+      DINGO_LOG(ERROR) << fmt::format("[vector_index.diskann][id({})] {}", Id(), status.error_str());
+      return status;
+    }
+
+    for (const auto& vector_with_id : vector_with_ids) {
+      WriteValue(staging_file_, vector_with_id.id());
+      staging_file_.write(reinterpret_cast<const char*>(vector_with_id.vector().float_values().data()),
+                          dimension_ * sizeof(float));
+      staging_offsets_[vector_with_id.id()] = staging_count_++;
+    }
+
+    if (!staging_file_.good()) {
+      std::string s = fmt::format("write staging file {} failed", staging_path_);
+      DINGO_LOG(ERROR) << fmt::format("[vector_index.diskann][id({})] {}", Id(), s);
+      return butil::Status(pb::error::Errno::EINTERNAL, s);
+    }
+
+    return butil::Status::OK();
+  }
+
+  for (const auto& vector_with_id : vector_with_ids) {
+    if (IsDiskId(vector_with_id.id())) {
+      deleted_ids_.insert(vector_with_id.id());
+    }
+    const auto& values = vector_with_id.vector().float_values();
+    fresh_vectors_[vector_with_id.id()] = std::vector<float>(values.begin(), values.end());
+  }
+
+  return fresh_index_->Upsert(vector_with_ids);
+}
+
+butil::Status VectorIndexDiskAnn::Add(const std::vector<pb::common::VectorWithId>& vector_with_ids) {
+  return AddOrUpsert(vector_with_ids);
+}
+
+butil::Status VectorIndexDiskAnn::Upsert(const std::vector<pb::common::VectorWithId>& vector_with_ids) {
+  return AddOrUpsert(vector_with_ids);
+}
+
+butil::Status VectorIndexDiskAnn::Delete(const std::vector<int64_t>& delete_ids) {
+  if (delete_ids.empty()) {
+    return butil::Status::OK();
+  }
+
+  BvarLatencyGuard bvar_guard(&g_diskann_delete_latency);
+  RWLockWriteGuard guard(&rw_lock_);
+
+  if (!built_) {
+    for (auto delete_id : delete_ids) {
+      staging_offsets_.erase(delete_id);
+    }
+    return butil::Status::OK();
+  }
+
+  std::vector<int64_t> fresh_delete_ids;
+  for (auto delete_id : delete_ids) {
+    if (IsDiskId(delete_id)) {
+      deleted_ids_.insert(delete_id);
+    }
+    if (fresh_vectors_.erase(delete_id) > 0) {
+      fresh_delete_ids.push_back(delete_id);
+    }
+  }
+
+  if (fresh_delete_ids.empty()) {
+    return butil::Status::OK();
+  }
+
+  return fresh_index_->Delete(fresh_delete_ids);
+}
+
+butil::Status VectorIndexDiskAnn::SearchDiskIndex(const float* query, uint32_t topk, uint32_t search_list_size,
+                                                  uint32_t beam_width,
+                                                  std::vector<std::shared_ptr<FilterFunctor>>& filters,
+                                                  std::vector<std::pair<float, int64_t>>& result) {
+  int64_t disk_count = disk_ids_.size();
+  int64_t k = topk;
+  std::vector<uint64_t> labels;
+  std::vector<float> distances;
+
+  // tombstones and filters are checked after beam search, over fetch until enough results survive.
+  for (;;) {
+    int64_t k_search = std::min(k, disk_count);
+    labels.resize(k_search);
+    distances.resize(k_search);
+    disk_index_->cached_beam_search(query, k_search, std::max(static_cast<int64_t>(search_list_size), k_search),
+                                    labels.data(), distances.data(), beam_width);
+
+    result.clear();
+    for (int64_t i = 0; i < k_search && result.size() < topk; ++i) {
+      if (labels[i] >= static_cast<uint64_t>(disk_count)) {
+        continue;
+      }
+      int64_t vector_id = disk_ids_[labels[i]];
+      if (deleted_ids_.count(vector_id) > 0) {
+        continue;
+      }
+
+      bool is_member = true;
+      for (const auto& filter : filters) {
+        if (!filter->Check(vector_id)) {
+          is_member = false;
+          break;
+        }
+      }
+      if (is_member) {
+        result.emplace_back(ConvertDistance(distances[i]), vector_id);
+      }
+    }
+
+    if (result.size() >= topk || k_search >= disk_count || k >= FLAGS_diskann_max_search_k) {
+      break;
+    }
+    k = std::min(k * 2, FLAGS_diskann_max_search_k);
+  }
+
+  return butil::Status::OK();
+}
+
+butil::Status VectorIndexDiskAnn::Search(std::vector<pb::common::VectorWithId> vector_with_ids, uint32_t topk,
+                                         std::vector<std::shared_ptr<FilterFunctor>> filters, bool,
+                                         const pb::common::VectorSearchParameter& parameter,
+                                         std::vector<pb::index::VectorWithDistanceResult>& results) {
+  if (vector_with_ids.empty()) {
+    DINGO_LOG(WARNING) << "vector_with_ids is empty";
+    return butil::Status::OK();
+  }
+
+  if (topk == 0) {
+    DINGO_LOG(WARNING) << "topk is invalid";
+    return butil::Status::OK();
+  }
+
+  bool normalize = metric_type_ == pb::common::MetricType::METRIC_TYPE_COSINE;
+  const auto& [vectors, status] = VectorIndexUtils::CheckAndCopyVectorData(vector_with_ids, dimension_, normalize);
+  if (!status.ok()) {
+    DINGO_LOG(ERROR) << status.error_cstr();
+    return status;
+  }
+
+  // fix lambda can not capture rvalue. change rvalue -> lvalue.
+  // c++ 20 fix this bug.
+  const std::unique_ptr<float[]>& vectors2 = vectors;
+
+  uint32_t search_list_size = parameter.diskann().search_list_size() > 0 ? parameter.diskann().search_list_size()
+                                                                         : FLAGS_diskann_search_list_size;
+  uint32_t beam_width =
+      parameter.diskann().beam_width() > 0 ? parameter.diskann().beam_width() : FLAGS_diskann_search_beam_width;
+
+  BvarLatencyGuard bvar_guard(&g_diskann_search_latency);
+  RWLockReadGuard guard(&rw_lock_);
+
+  if (!built_) {
+    return butil::Status(pb::error::Errno::EVECTOR_NOT_SUPPORT, "diskann index not built, use brute force");
+  }
+
+  std::vector<pb::index::VectorWithDistanceResult> fresh_results;
+  if (!fresh_vectors_.empty()) {
+    auto fresh_status = fresh_index_->Search(vector_with_ids, topk, filters, false, parameter, fresh_results);
+    if (!fresh_status.ok()) {
+      DINGO_LOG(ERROR) << fmt::format("[vector_index.diskann][id({})] search fresh index failed, error: {}", Id(),
+                                      fresh_status.error_str());
+      return fresh_status;
+    }
+  }
+
+  std::vector<std::vector<std::pair<float, int64_t>>> disk_results(vector_with_ids.size());
+  if (disk_index_ != nullptr) {
+    std::promise<butil::Status> promise_status;
+    std::future<butil::Status> future_status = promise_status.get_future();
+    // use std::thread to call diskann functions
+    std::thread t(
+        [&](std::promise<butil::Status>& promise_status) {
+          try {
+            for (size_t row = 0; row < vector_with_ids.size(); ++row) {
+              SearchDiskIndex(vectors2.get() + row * dimension_, topk, search_list_size, beam_width, filters,
+                              disk_results[row]);
+            }
+            promise_status.set_value(butil::Status());
+          } catch (std::exception& e) {
+            std::string s = fmt::format("VectorIndexDiskAnn::Search failed. error : {}", e.what());
+            promise_status.set_value(butil::Status(pb::error::Errno::EINTERNAL, s));
+          }
+        },
+        std::ref(promise_status));
+
+    butil::Status status2 = future_status.get();
+    t.join();
+
+    if (!status2.ok()) {
+      DINGO_LOG(ERROR) << status2.error_cstr();
+      return status2;
+    }
+  }
+
+  for (size_t row = 0; row < vector_with_ids.size(); ++row) {
+    auto& candidates = disk_results[row];
+    if (row < fresh_results.size()) {
+      for (const auto& vector_with_distance : fresh_results[row].vector_with_distances()) {
+        candidates.emplace_back(vector_with_distance.distance(), vector_with_distance.vector_with_id().id());
+      }
+    }
+    std::sort(candidates.begin(), candidates.end());
+    if (candidates.size() > topk) {
+      candidates.resize(topk);
+    }
+
+    auto& result = results.emplace_back();
+    for (const auto& [distance, vector_id] : candidates) {
+      auto* vector_with_distance = result.add_vector_with_distances();
+      auto* vector_with_id = vector_with_distance->mutable_vector_with_id();
+      vector_with_id->set_id(vector_id);
+      vector_with_id->mutable_vector()->set_dimension(dimension_);
+      vector_with_id->mutable_vector()->set_value_type(::dingodb::pb::common::ValueType::FLOAT);
+      vector_with_distance->set_distance(distance);
+      vector_with_distance->set_metric_type(metric_type_);
+    }
+  }
+
+  return butil::Status::OK();
+}
+
+butil::Status VectorIndexDiskAnn::RangeSearch(std::vector<pb::common::VectorWithId> /*vector_with_ids*/,
+                                              float /*radius*/,
+                                              std::vector<std::shared_ptr<VectorIndex::FilterFunctor>> /*filters*/,
+                                              bool /*reconstruct*/,
+                                              const pb::common::VectorSearchParameter& /*parameter*/,
+                                              std::vector<pb::index::VectorWithDistanceResult>& /*results*/) {
+  return butil::Status(pb::error::Errno::EVECTOR_NOT_SUPPORT, "diskann not support range search, use brute force");
+}
+
+butil::Status VectorIndexDiskAnn::WriteBuildData(const std::string& prefix, std::vector<int64_t>& ids) {
+  staging_file_.flush();
+
+  std::ifstream reader(staging_path_, std::ios::binary);
+  std::ofstream data_writer(prefix + "_data.bin", std::ios::binary | std::ios::trunc);
+  if (!reader.is_open() || !data_writer.is_open()) {
+    return butil::Status(pb::error::Errno::EINTERNAL, fmt::format("open build data file failed, prefix: {}", prefix));
+  }
+
+  // diskann bin format: int32 npts | int32 dim | T[npts * dim]
+  int32_t npts = staging_offsets_.size();
+  int32_t dim = dimension_;
+  WriteValue(data_writer, npts);
+  WriteValue(data_writer, dim);
+
+  ids.clear();
+  ids.reserve(npts);
+  std::vector<float> values;
+  for (const auto& [vector_id, offset] : staging_offsets_) {
+    auto status = ReadStagingVector(reader, offset, values);
+    if (!status.ok()) {
+      return status;
+    }
+    if (metric_type_ == pb::common::MetricType::METRIC_TYPE_COSINE) {
+      VectorIndexUtils::NormalizeVectorForFaiss(values.data(), dimension_);
+    }
+    data_writer.write(reinterpret_cast<const char*>(values.data()), dimension_ * sizeof(float));
+    ids.push_back(vector_id);
+  }
+
+  // staging_offsets_ is ordered, so the ids are sorted
+  std::ofstream ids_writer(prefix + "_ids.bin", std::ios::binary | std::ios::trunc);
+  int32_t ids_dim = 1;
+  WriteValue(ids_writer, npts);
+  WriteValue(ids_writer, ids_dim);
+  ids_writer.write(reinterpret_cast<const char*>(ids.data()), ids.size() * sizeof(int64_t));
+
+  if (!data_writer.good() || !ids_writer.good()) {
+    return butil::Status(pb::error::Errno::EINTERNAL, fmt::format("write build data failed, prefix: {}", prefix));
+  }
+
+  return butil::Status::OK();
+}
+
+butil::Status VectorIndexDiskAnn::LoadDiskIds(const std::string& prefix, std::vector<int64_t>& ids) {
+  std::ifstream reader(prefix + "_ids.bin", std::ios::binary);
+  int32_t npts = 0;
+  int32_t ids_dim = 0;
+  if (!ReadValue(reader, npts) || !ReadValue(reader, ids_dim) || npts < 0 || ids_dim != 1) {
+    return butil::Status(pb::error::Errno::EINTERNAL, fmt::format("read ids file failed, prefix: {}", prefix));
+  }
+
+  ids.resize(npts);
+  reader.read(reinterpret_cast<char*>(ids.data()), npts * sizeof(int64_t));
+  if (!reader.good()) {
+    return butil::Status(pb::error::Errno::EINTERNAL, fmt::format("read ids file failed, prefix: {}", prefix));
+  }
+
+  return butil::Status::OK();
+}
+
+butil::Status VectorIndexDiskAnn::LoadDiskIndex(const std::string& prefix,
+                                                std::unique_ptr<diskann::PQFlashIndex<float>>& disk_index) {
+  auto metric = metric_type_ == pb::common::MetricType::METRIC_TYPE_INNER_PRODUCT ? diskann::Metric::INNER_PRODUCT
+                                                                                  : diskann::Metric::L2;
+
+  std::promise<butil::Status> promise_status;
+  std::future<butil::Status> future_status = promise_status.get_future();
+  std::thread t(
+      [&](std::promise<butil::Status>& promise_status) {
+        try {
+          std::shared_ptr<AlignedFileReader> file_reader = std::make_shared<LinuxAlignedFileReader>();
+          auto new_disk_index = std::make_unique<diskann::PQFlashIndex<float>>(file_reader, metric);
+          int ret = new_disk_index->load(FLAGS_diskann_search_threads, prefix.c_str());
+          if (ret != 0) {
+            std::string s = fmt::format("diskann load failed, prefix: {} ret: {}", prefix, ret);
+            promise_status.set_value(butil::Status(pb::error::Errno::EINTERNAL, s));
+            return;
+          }
+
+          // cache the nodes near the medoid, the first hops of every search hit memory.
+          if (FLAGS_diskann_cache_node_count > 0) {
+            std::vector<uint32_t> node_list;
+            new_disk_index->cache_bfs_levels(FLAGS_diskann_cache_node_count, node_list);
+            new_disk_index->load_cache_list(node_list);
+          }
+
+          disk_index = std::move(new_disk_index);
+          promise_status.set_value(butil::Status());
+        } catch (std::exception& e) {
+          std::string s = fmt::format("diskann load failed, prefix: {} error: {}", prefix, e.what());
+          promise_status.set_value(butil::Status(pb::error::Errno::EINTERNAL, s));
+        }
+      },
+      std::ref(promise_status));
+
+  butil::Status status = future_status.get();
+  t.join();
+
+  return status;
+}
+
+butil::Status VectorIndexDiskAnn::MoveStagingToFresh() {
+  staging_file_.flush();
+
+  std::ifstream reader(staging_path_, std::ios::binary);
+  if (!reader.is_open()) {
+    return butil::Status(pb::error::Errno::EINTERNAL, fmt::format("open staging file {} failed", staging_path_));
+  }
+
+  std::vector<pb::common::VectorWithId> vector_with_ids;
+  vector_with_ids.reserve(staging_offsets_.size());
+  std::vector<float> values;
+  for (const auto& [vector_id, offset] : staging_offsets_) {
+    auto status = ReadStagingVector(reader, offset, values);
+    if (!status.ok()) {
+      return status;
+    }
+
+    auto& vector_with_id = vector_with_ids.emplace_back();
+    vector_with_id.set_id(vector_id);
+    vector_with_id.mutable_vector()->set_dimension(dimension_);
+    vector_with_id.mutable_vector()->set_value_type(::dingodb::pb::common::ValueType::FLOAT);
+    vector_with_id.mutable_vector()->mutable_float_values()->Add(values.begin(), values.end());
+    fresh_vectors_[vector_id] = values;
+  }
+
+  return fresh_index_->Upsert(vector_with_ids);
+}
+
+butil::Status VectorIndexDiskAnn::Build() {
+  BvarLatencyGuard bvar_guard(&g_diskann_build_latency);
+  RWLockWriteGuard guard(&rw_lock_);
+
+  if (built_) {
+    return butil::Status::OK();
+  }
+
+  int64_t start_time = Helper::TimestampMs();
+  int64_t count = staging_offsets_.size();
+
+  // too few vectors for PQ training and graph build, keep them in memory.
+  if (count < FLAGS_diskann_min_build_count) {
+    auto status = MoveStagingToFresh();
+    if (!status.ok()) {
+      DINGO_LOG(ERROR) << fmt::format("[vector_index.diskann][id({})] move staging to fresh failed, error: {}", Id(),
+                                      status.error_str());
+      return status;
+    }
+  } else {
+    ++generation_;
+    std::string prefix = Prefix();
+
+    std::vector<int64_t> ids;
+    auto status = WriteBuildData(prefix, ids);
+    if (!status.ok()) {
+      DINGO_LOG(ERROR) << fmt::format("[vector_index.diskann][id({})] write build data failed, error: {}", Id(),
+                                      status.error_str());
+      return status;
+    }
+
+    // R L B M T, B is the memory budget of PQ codes in GB.
+    uint32_t search_list_size = std::max(max_degree_, FLAGS_diskann_build_search_list_size);
+    double pq_budget_gb = static_cast<double>(count) * FLAGS_diskann_pq_bytes_per_vector / (1024.0 * 1024 * 1024);
+    std::string build_parameters = fmt::format("{} {} {:.9f} {} {}", max_degree_, search_list_size, pq_budget_gb,
+                                               FLAGS_diskann_build_dram_budget_gb, build_threads_);
+    auto metric = metric_type_ == pb::common::MetricType::METRIC_TYPE_INNER_PRODUCT ? diskann::Metric::INNER_PRODUCT
+                                                                                    : diskann::Metric::L2;
+
+    std::string data_path = prefix + "_data.bin";
+    int ret = -1;
+    std::thread([&]() {
+      try {
+        ret = diskann::build_disk_index<float>(data_path.c_str(), prefix.c_str(), build_parameters.c_str(), metric);
+      } catch (std::exception& e) {
+        LOG(ERROR) << fmt::format("[vector_index.diskann][id({})] build disk index exception: {}", Id(), e.what());
+      }
+    }).join();
+
+    // full precision vectors are kept in disk index file, the data file is useless now.
+    Helper::RemoveFileOrDirectory(data_path);
+
+    if (ret != 0) {
+      std::string s = fmt::format("build disk index failed, prefix: {} parameters: {} ret: {}", prefix,
+                                  build_parameters, ret);
+      DINGO_LOG(ERROR) << fmt::format("[vector_index.diskann][id({})] {}", Id(), s);
+      return butil::Status(pb::error::Errno::EINTERNAL, s);
+    }
+
+    status = LoadDiskIndex(prefix, disk_index_);
+    if (!status.ok()) {
+      DINGO_LOG(ERROR) << fmt::format("[vector_index.diskann][id({})] {}", Id(), status.error_str());
+      return status;
+    }
+    disk_ids_.swap(ids);
+  }
+
+  staging_file_.close();
+  Helper::RemoveFileOrDirectory(staging_path_);
+  staging_offsets_.clear();
+  staging_count_ = 0;
+  built_ = true;
+
+  DINGO_LOG(INFO) << fmt::format(
+      "[vector_index.diskann][id({})] build finish, count({}) disk_count({}) fresh_count({}) elapsed time({}ms)", Id(),
+      count, disk_ids_.size(), fresh_vectors_.size(), Helper::TimestampMs() - start_time);
+
+  return butil::Status::OK();
+}
+
+void VectorIndexDiskAnn::LockWrite() { rw_lock_.LockWrite(); }
+
+void VectorIndexDiskAnn::UnlockWrite() { rw_lock_.UnlockWrite(); }
+
+// Snapshot layout:
+//   {path}          meta: magic | version | dimension | disk_count | tombstones | fresh vectors
+//   {path}.{suffix} disk index files, e.g. {path}.disk.index {path}.pq_compressed.bin
+butil::Status VectorIndexDiskAnn::Save(const std::string& path) {
+  // Warning : read me first !!!!
+  // Currently, the save function is executed in the fork child process.
+  // When calling glog, the child process will hang.
+  // The outside has been locked. Remove the locking operation here.
+  if (BAIDU_UNLIKELY(path.empty())) {
+    return butil::Status(pb::error::Errno::EILLEGAL_PARAMTETERS, "path empty. not support");
+  }
+
+  if (BAIDU_UNLIKELY(!built_)) {
+    return butil::Status(pb::error::Errno::EVECTOR_INDEX_NOT_READY, "diskann index not built");
+  }
+
+  if (disk_index_ != nullptr) {
+    std::string file_prefix = fmt::format("{}_", generation_);
+    for (const auto& filename : ListFileNames(work_dir_, file_prefix)) {
+      std::string from = fmt::format("{}/{}", work_dir_, filename);
+      std::string to = fmt::format("{}.{}", path, filename.substr(file_prefix.size()));
+      if (!LinkOrCopyFile(from, to)) {
+        return butil::Status(pb::error::Errno::EINTERNAL, fmt::format("link file {} to {} failed", from, to));
+      }
+    }
+  }
+
+  std::ofstream writer(path, std::ios::binary | std::ios::trunc);
+  if (!writer.is_open()) {
+    return butil::Status(pb::error::Errno::EINTERNAL, fmt::format("open file {} failed", path));
+  }
+
+  WriteValue(writer, kDiskAnnMetaMagic);
+  WriteValue(writer, kDiskAnnMetaVersion);
+  WriteValue(writer, dimension_);
+  WriteValue(writer, static_cast<int64_t>(disk_ids_.size()));
+
+  WriteValue(writer, static_cast<int64_t>(deleted_ids_.size()));
+  for (auto deleted_id : deleted_ids_) {
+    WriteValue(writer, deleted_id);
+  }
+
+  WriteValue(writer, static_cast<int64_t>(fresh_vectors_.size()));
+  for (const auto& [vector_id, values] : fresh_vectors_) {
+    WriteValue(writer, vector_id);
+    writer.write(reinterpret_cast<const char*>(values.data()), dimension_ * sizeof(float));
+  }
+
+  writer.flush();
+  if (!writer.good()) {
+    return butil::Status(pb::error::Errno::EINTERNAL, fmt::format("write file {} failed", path));
+  }
+
+  return butil::Status::OK();
+}
+
+butil::Status VectorIndexDiskAnn::Load(const std::string& path) {
+  if (BAIDU_UNLIKELY(path.empty())) {
+    std::string s = fmt::format("path empty. not support");
+    DINGO_LOG(ERROR) << s;
+    return butil::Status(pb::error::Errno::EILLEGAL_PARAMTETERS, s);
+  }
+
+  BvarLatencyGuard bvar_guard(&g_diskann_load_latency);
+
+  std::ifstream reader(path, std::ios::binary);
+  uint32_t magic = 0;
+  uint32_t version = 0;
+  uint32_t dimension = 0;
+  int64_t disk_count = 0;
+  if (!ReadValue(reader, magic) || !ReadValue(reader, version) || !ReadValue(reader, dimension) ||
+      !ReadValue(reader, disk_count) || magic != kDiskAnnMetaMagic || version != kDiskAnnMetaVersion) {
+    std::string s = fmt::format("invalid diskann meta file, path: {}", path);
+    DINGO_LOG(ERROR) << fmt::format("[vector_index.diskann][id({})] {}", Id(), s);
+    return butil::Status(pb::error::Errno::EINTERNAL, s);
+  }
+
+  if (dimension != dimension_) {
+    std::string s = fmt::format("load dimension {} != dimension_ {}, path: {}", dimension, dimension_, path);
+    DINGO_LOG(ERROR) << fmt::format("[vector_index.diskann][id({})] {}", Id(), s);
+    return butil::Status(pb::error::Errno::EINTERNAL, s);
+  }
+
+  if (disk_count > 0) {
+    ++generation_;
+    std::string prefix = Prefix();
+
+    std::filesystem::path snapshot_path(path);
+    std::string file_prefix = snapshot_path.filename().string() + ".";
+    for (const auto& filename : ListFileNames(snapshot_path.parent_path().string(), file_prefix)) {
+      std::string from = fmt::format("{}/{}", snapshot_path.parent_path().string(), filename);
+      std::string to = fmt::format("{}_{}", prefix, filename.substr(file_prefix.size()));
+      if (!LinkOrCopyFile(from, to)) {
+        std::string s = fmt::format("link file {} to {} failed", from, to);
+        DINGO_LOG(ERROR) << fmt::format("[vector_index.diskann][id({})] {}", Id(), s);
+        return butil::Status(pb::error::Errno::EINTERNAL, s);
+      }
+    }
+
+    auto status = LoadDiskIds(prefix, disk_ids_);
+    if (!status.ok() || static_cast<int64_t>(disk_ids_.size()) != disk_count) {
+      std::string s = fmt::format("load disk ids failed, count {} expect {}, error: {}", disk_ids_.size(),
+                                  disk_count, status.error_str());
+      DINGO_LOG(ERROR) << fmt::format("[vector_index.diskann][id({})] {}", Id(), s);
+      return butil::Status(pb::error::Errno::EINTERNAL, s);
+    }
+
+    status = LoadDiskIndex(prefix, disk_index_);
+    if (!status.ok()) {
+      DINGO_LOG(ERROR) << fmt::format("[vector_index.diskann][id({})] {}", Id(), status.error_str());
+      return status;
+    }
+  }
+
+  int64_t deleted_count = 0;
+  if (!ReadValue(reader, deleted_count)) {
+    return butil::Status(pb::error::Errno::EINTERNAL, fmt::format("read deleted ids failed, path: {}", path));
+  }
+  for (int64_t i = 0; i < deleted_count; ++i) {
+    int64_t deleted_id = 0;
+    if (!ReadValue(reader, deleted_id)) {
+      return butil::Status(pb::error::Errno::EINTERNAL, fmt::format("read deleted ids failed, path: {}", path));
+    }
+    deleted_ids_.insert(deleted_id);
+  }
+
+  int64_t fresh_count = 0;
+  if (!ReadValue(reader, fresh_count)) {
+    return butil::Status(pb::error::Errno::EINTERNAL, fmt::format("read fresh vectors failed, path: {}", path));
+  }
+  std::vector<pb::common::VectorWithId> vector_with_ids;
+  vector_with_ids.reserve(fresh_count);
+  for (int64_t i = 0; i < fresh_count; ++i) {
+    int64_t vector_id = 0;
+    std::vector<float> values(dimension_);
+    if (!ReadValue(reader, vector_id)) {
+      return butil::Status(pb::error::Errno::EINTERNAL, fmt::format("read fresh vectors failed, path: {}", path));
+    }
+    reader.read(reinterpret_cast<char*>(values.data()), dimension_ * sizeof(float));
+    if (!reader.good()) {
+      return butil::Status(pb::error::Errno::EINTERNAL, fmt::format("read fresh vectors failed, path: {}", path));
+    }
+
+    auto& vector_with_id = vector_with_ids.emplace_back();
+    vector_with_id.set_id(vector_id);
+    vector_with_id.mutable_vector()->set_dimension(dimension_);
+    vector_with_id.mutable_vector()->set_value_type(::dingodb::pb::common::ValueType::FLOAT);
+    vector_with_id.mutable_vector()->mutable_float_values()->Add(values.begin(), values.end());
+    fresh_vectors_[vector_id] = std::move(values);
+  }
+
+  auto status = fresh_index_->Upsert(vector_with_ids);
+  if (!status.ok()) {
+    DINGO_LOG(ERROR) << fmt::format("[vector_index.diskann][id({})] load fresh vectors failed, error: {}", Id(),
+                                    status.error_str());
+    return status;
+  }
+
+  built_ = true;
+
+  DINGO_LOG(INFO) << fmt::format(
+      "[vector_index.diskann][id({})] load success, path: {} disk_count({}) deleted_count({}) fresh_count({})", Id(),
+      path, disk_count, deleted_count, fresh_count);
+
+  return butil::Status::OK();
+}
+
+int32_t VectorIndexDiskAnn::GetDimension() { return this->dimension_; }
+
+pb::common::MetricType VectorIndexDiskAnn::GetMetricType() { return this->metric_type_; }
+
+butil::Status VectorIndexDiskAnn::GetCount(int64_t& count) {
+  RWLockReadGuard guard(&rw_lock_);
+  if (!built_) {
+    count = staging_offsets_.size();
+  } else {
+    count = disk_ids_.size() - deleted_ids_.size() + fresh_vectors_.size();
+  }
+  return butil::Status::OK();
+}
+
+butil::Status VectorIndexDiskAnn::GetDeletedCount(int64_t& deleted_count) {
+  RWLockReadGuard guard(&rw_lock_);
+  deleted_count = deleted_ids_.size();
+  return butil::Status::OK();
+}
+
+// Only the memory resident part: PQ codes, PQ pivots, cached nodes, id mapping and fresh vectors.
+butil::Status VectorIndexDiskAnn::GetMemorySize(int64_t& memory_size) {
+  RWLockReadGuard guard(&rw_lock_);
+  if (!built_) {
+    memory_size = staging_offsets_.size() * (sizeof(int64_t) + sizeof(int64_t));
+    return butil::Status::OK();
+  }
+
+  memory_size = 0;
+  if (disk_index_ != nullptr) {
+    memory_size += Helper::GetFileSize(Prefix() + "_pq_compressed.bin");
+    memory_size += Helper::GetFileSize(Prefix() + "_pq_pivots.bin");
+    int64_t cache_node_count =
+        std::min(static_cast<int64_t>(FLAGS_diskann_cache_node_count), static_cast<int64_t>(disk_ids_.size()));
+    memory_size += cache_node_count * (dimension_ * sizeof(float) + (max_degree_ + 1) * sizeof(uint32_t));
+    memory_size += disk_ids_.size() * sizeof(int64_t) + deleted_ids_.size() * sizeof(int64_t);
+  }
+
+  int64_t fresh_memory_size = 0;
+  fresh_index_->GetMemorySize(fresh_memory_size);
+  memory_size += fresh_memory_size + fresh_vectors_.size() * (sizeof(int64_t) + dimension_ * sizeof(float));
+
+  return butil::Status::OK();
+}
+
+bool VectorIndexDiskAnn::IsTrained() {
+  RWLockReadGuard guard(&rw_lock_);
+  return built_;
+}
+
+bool VectorIndexDiskAnn::NeedToRebuild() {
+  RWLockReadGuard guard(&rw_lock_);
+  if (!built_) {
+    return false;
+  }
+
+  if (static_cast<int64_t>(fresh_vectors_.size()) > FLAGS_diskann_max_fresh_vector_count) {
+    return true;
+  }
+
+  // half of the disk vectors are dead, search wastes too much io on them.
+  return !disk_ids_.empty() && deleted_ids_.size() * 2 > disk_ids_.size();
+}
+
+bool VectorIndexDiskAnn::NeedToSave(int64_t last_save_log_behind) {
+  RWLockReadGuard guard(&rw_lock_);
+  if (!built_) {
+    return false;
+  }
+
+  return last_save_log_behind > FLAGS_diskann_need_save_count;
+}
+
+}  // namespace dingodb
+
+#endif  // USE_DISKANN
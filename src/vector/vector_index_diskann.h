@@ -0,0 +1,159 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGODB_VECTOR_INDEX_DISKANN_H_  // NOLINT
+#define DINGODB_VECTOR_INDEX_DISKANN_H_
+
+#ifdef USE_DISKANN
+
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "butil/status.h"
+#include "common/synchronization.h"
+#include "gflags/gflags_declare.h"
+#include "pq_flash_index.h"
+#include "proto/common.pb.h"
+#include "proto/index.pb.h"
+#include "vector/vector_index.h"
+
+namespace dingodb {
+
+DECLARE_string(diskann_data_path);
+
+// DiskANN index, the PQ compressed vectors and the cached graph nodes stay in memory,
+// the full precision vectors and the graph live in the index file on local SSD.
+//
+// The disk index is immutable, so the lifecycle is:
+//   1. before Build(), Add/Upsert/Delete are staged into a file on SSD, Search is not supported
+//      and the caller falls back to brute force.
+//   2. Build() writes the staged vectors into the disk index.
+//   3. after Build(), writes go to an in-memory fresh flat index and deletes of disk vectors are kept as
+//      tombstones, search merges both. NeedToRebuild() asks for a rebuild when the fresh part grows too big.
+class VectorIndexDiskAnn : public VectorIndex {
+ public:
+  explicit VectorIndexDiskAnn(int64_t id, const pb::common::VectorIndexParameter& vector_index_parameter,
+                              const pb::common::RegionEpoch& epoch, const pb::common::Range& range);
+
+  ~VectorIndexDiskAnn() override;
+
+  VectorIndexDiskAnn(const VectorIndexDiskAnn& rhs) = delete;
+  VectorIndexDiskAnn& operator=(const VectorIndexDiskAnn& rhs) = delete;
+  VectorIndexDiskAnn(VectorIndexDiskAnn&& rhs) = delete;
+  VectorIndexDiskAnn& operator=(VectorIndexDiskAnn&& rhs) = delete;
+
+  butil::Status Save(const std::string& path) override;
+  butil::Status Load(const std::string& path) override;
+
+  butil::Status Add(const std::vector<pb::common::VectorWithId>& vector_with_ids) override;
+  butil::Status Upsert(const std::vector<pb::common::VectorWithId>& vector_with_ids) override;
+  butil::Status Delete(const std::vector<int64_t>& delete_ids) override;
+
+  butil::Status Search(std::vector<pb::common::VectorWithId> vector_with_ids, uint32_t topk,
+                       std::vector<std::shared_ptr<FilterFunctor>> filters, bool reconstruct,
+                       const pb::common::VectorSearchParameter& parameter,
+                       std::vector<pb::index::VectorWithDistanceResult>& results) override;
+
+  butil::Status RangeSearch(std::vector<pb::common::VectorWithId> vector_with_ids, float radius,
+                            std::vector<std::shared_ptr<VectorIndex::FilterFunctor>> filters, bool reconstruct,
+                            const pb::common::VectorSearchParameter& parameter,
+                            std::vector<pb::index::VectorWithDistanceResult>& results) override;
+
+  // Build disk index from the staged vectors, only the first call does the work.
+  butil::Status Build() override;
+
+  void LockWrite() override;
+  void UnlockWrite() override;
+  bool SupportSave() override { return true; }
+
+  int32_t GetDimension() override;
+  pb::common::MetricType GetMetricType() override;
+  butil::Status GetCount(int64_t& count) override;
+  butil::Status GetDeletedCount(int64_t& deleted_count) override;
+  butil::Status GetMemorySize(int64_t& memory_size) override;
+  bool IsExceedsMaxElements() override { return false; }
+
+  butil::Status Train([[maybe_unused]] const std::vector<float>& train_datas) override { return butil::Status::OK(); }
+  butil::Status Train([[maybe_unused]] const std::vector<pb::common::VectorWithId>& vectors) override {
+    return butil::Status::OK();
+  }
+
+  bool IsTrained() override;
+  bool NeedToRebuild() override;
+  bool NeedToSave(int64_t last_save_log_behind) override;
+
+ private:
+  butil::Status AddOrUpsert(const std::vector<pb::common::VectorWithId>& vector_with_ids);
+
+  butil::Status OpenStagingFile();
+  butil::Status ReadStagingVector(std::ifstream& reader, int64_t offset, std::vector<float>& values);
+  butil::Status WriteBuildData(const std::string& prefix, std::vector<int64_t>& ids);
+  butil::Status MoveStagingToFresh();
+  butil::Status LoadDiskIndex(const std::string& prefix, std::unique_ptr<diskann::PQFlashIndex<float>>& disk_index);
+  butil::Status LoadDiskIds(const std::string& prefix, std::vector<int64_t>& ids);
+
+  butil::Status SearchDiskIndex(const float* query, uint32_t topk, uint32_t search_list_size, uint32_t beam_width,
+                                std::vector<std::shared_ptr<FilterFunctor>>& filters,
+                                std::vector<std::pair<float, int64_t>>& result);
+
+  bool IsDiskId(int64_t vector_id) const;
+  float ConvertDistance(float distance) const;
+  std::string Prefix() const;
+
+  // Dimension of the elements
+  uint32_t dimension_;
+
+  pb::common::MetricType metric_type_;
+
+  // max degree of the graph, maps to num_neighbors
+  uint32_t max_degree_;
+  uint32_t build_threads_;
+
+  // {diskann_data_path}/{id}/{create_time}, all files of the index live here
+  std::string work_dir_;
+
+  // staging vectors before the first build, record: int64 id | float[dimension]
+  std::string staging_path_;
+  std::ofstream staging_file_;
+  int64_t staging_count_{0};
+  // vector id -> latest record index in staging file
+  std::map<int64_t, int64_t> staging_offsets_;
+
+  bool built_{false};
+  // build or load creates a new generation, file prefix is {work_dir}/{generation}_
+  int64_t generation_{0};
+  std::unique_ptr<diskann::PQFlashIndex<float>> disk_index_;
+  // sorted vector ids in disk index, the position is the diskann internal id
+  std::vector<int64_t> disk_ids_;
+  // deleted or updated vector ids of the disk index
+  std::set<int64_t> deleted_ids_;
+
+  // vectors written after build
+  std::map<int64_t, std::vector<float>> fresh_vectors_;
+  std::shared_ptr<VectorIndex> fresh_index_;
+
+  RWLock rw_lock_;
+};
+
+}  // namespace dingodb
+
+#endif  // USE_DISKANN
+
+#endif  // DINGODB_VECTOR_INDEX_DISKANN_H_  // NOLINT
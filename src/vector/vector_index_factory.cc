@@ -21,7 +21,10 @@
 #include "proto/common.pb.h"
 #include "server/server.h"
 #include "vector/vector_index.h"
+#include "vector/vector_index_binary_flat.h"
+#include "vector/vector_index_binary_ivf_flat.h"
 #include "vector/vector_index_bruteforce.h"
+#include "vector/vector_index_diskann.h"
 #include "vector/vector_index_flat.h"
 #include "vector/vector_index_hnsw.h"
 #include "vector/vector_index_ivf_flat.h"
@@ -56,9 +59,22 @@ std::shared_ptr<VectorIndex> VectorIndexFactory::New(int64_t id,
       vector_index = NewHnsw(id, index_parameter, epoch, range, Server::GetInstance().GetVectorIndexThreadPool());
       break;
     }
+    case pb::common::VECTOR_INDEX_TYPE_BINARY_FLAT: {
+      vector_index = NewBinaryFlat(id, index_parameter, epoch, range);
+      break;
+    }
+    case pb::common::VECTOR_INDEX_TYPE_BINARY_IVF_FLAT: {
+      vector_index = NewBinaryIvfFlat(id, index_parameter, epoch, range);
+      break;
+    }
     case pb::common::VECTOR_INDEX_TYPE_DISKANN: {
-      DINGO_LOG(ERROR) << "vector_index_parameter = diskann not implement, type=" << index_parameter.vector_index_type()
-                       << ", id=" << id << ", parameter=" << index_parameter.ShortDebugString();
+#ifdef USE_DISKANN
+      vector_index = NewDiskAnn(id, index_parameter, epoch, range);
+#else
+      DINGO_LOG(ERROR) << "vector_index_parameter = diskann not build with diskann, type="
+                       << index_parameter.vector_index_type() << ", id=" << id
+                       << ", parameter=" << index_parameter.ShortDebugString();
+#endif
       break;
     }
     case pb::common::VectorIndexType_INT_MIN_SENTINEL_DO_NOT_USE_:
@@ -103,6 +119,11 @@ std::shared_ptr<VectorIndex> VectorIndexFactory::NewHnsw(int64_t id,
     DINGO_LOG(ERROR) << "vector_index_parameter is illegal, nlinks is 0";
     return nullptr;
   }
+  if (!pb::common::HnswQuantizerType_IsValid(hnsw_parameter.quantizer_type())) {
+    DINGO_LOG(ERROR) << "vector_index_parameter is illegal, quantizer_type is invalid, quantizer_type="
+                     << hnsw_parameter.quantizer_type();
+    return nullptr;
+  }
 
   // create index may throw exeception, so we need to catch it
   try {
@@ -317,4 +338,113 @@ std::shared_ptr<VectorIndex> VectorIndexFactory::NewIvfPq(int64_t id,
   }
 }
 
+std::shared_ptr<VectorIndex> VectorIndexFactory::NewBinaryFlat(int64_t id,
+                                                               const pb::common::VectorIndexParameter& index_parameter,
+                                                               const pb::common::RegionEpoch& epoch,
+                                                               const pb::common::Range& range) {
+  const auto& binary_flat_parameter = index_parameter.binary_flat_parameter();
+
+  if (binary_flat_parameter.dimension() <= 0 || binary_flat_parameter.dimension() % 8 != 0) {
+    DINGO_LOG(ERROR) << "vector_index_parameter is illegal, dimension must be a positive multiple of 8 : "
+                     << binary_flat_parameter.dimension();
+    return nullptr;
+  }
+  if (binary_flat_parameter.metric_type() != pb::common::MetricType::METRIC_TYPE_HAMMING) {
+    DINGO_LOG(ERROR) << "vector_index_parameter is illegal, binary flat only support METRIC_TYPE_HAMMING";
+    return nullptr;
+  }
+
+  // create index may throw exeception, so we need to catch it
+  try {
+    auto new_binary_flat_index = std::make_shared<VectorIndexBinaryFlat>(id, index_parameter, epoch, range);
+    if (new_binary_flat_index == nullptr) {
+      DINGO_LOG(ERROR) << "create binary flat index failed of new_binary_flat_index is nullptr"
+                       << ", id=" << id << ", parameter=" << index_parameter.ShortDebugString();
+      return nullptr;
+    } else {
+      DINGO_LOG(INFO) << "create binary flat index success, id=" << id
+                      << ", parameter=" << index_parameter.ShortDebugString();
+    }
+    return new_binary_flat_index;
+  } catch (std::exception& e) {
+    DINGO_LOG(ERROR) << "create binary flat index failed of exception occured, " << e.what() << ", id=" << id
+                     << ", parameter=" << index_parameter.ShortDebugString();
+    return nullptr;
+  }
+}
+
+std::shared_ptr<VectorIndex> VectorIndexFactory::NewBinaryIvfFlat(
+    int64_t id, const pb::common::VectorIndexParameter& index_parameter, const pb::common::RegionEpoch& epoch,
+    const pb::common::Range& range) {
+  const auto& binary_ivf_flat_parameter = index_parameter.binary_ivf_flat_parameter();
+
+  if (binary_ivf_flat_parameter.dimension() <= 0 || binary_ivf_flat_parameter.dimension() % 8 != 0) {
+    DINGO_LOG(ERROR) << "vector_index_parameter is illegal, dimension must be a positive multiple of 8 : "
+                     << binary_ivf_flat_parameter.dimension();
+    return nullptr;
+  }
+  if (binary_ivf_flat_parameter.metric_type() != pb::common::MetricType::METRIC_TYPE_HAMMING) {
+    DINGO_LOG(ERROR) << "vector_index_parameter is illegal, binary ivf flat only support METRIC_TYPE_HAMMING";
+    return nullptr;
+  }
+
+  // create index may throw exception, so we need to catch it
+  try {
+    auto new_binary_ivf_flat_index = std::make_shared<VectorIndexBinaryIvfFlat>(id, index_parameter, epoch, range);
+    if (new_binary_ivf_flat_index == nullptr) {
+      DINGO_LOG(ERROR) << "create binary ivf flat index failed of new_binary_ivf_flat_index is nullptr"
+                       << ", id=" << id << ", parameter=" << index_parameter.ShortDebugString();
+      return nullptr;
+    } else {
+      DINGO_LOG(INFO) << "create binary ivf flat index success, id=" << id
+                      << ", parameter=" << index_parameter.ShortDebugString();
+    }
+    return new_binary_ivf_flat_index;
+  } catch (std::exception& e) {
+    DINGO_LOG(ERROR) << "create binary ivf flat index failed of exception occurred, " << e.what() << ", id=" << id
+                     << ", parameter=" << index_parameter.ShortDebugString();
+    return nullptr;
+  }
+}
+
+#ifdef USE_DISKANN
+std::shared_ptr<VectorIndex> VectorIndexFactory::NewDiskAnn(int64_t id,
+                                                            const pb::common::VectorIndexParameter& index_parameter,
+                                                            const pb::common::RegionEpoch& epoch,
+                                                            const pb::common::Range& range) {
+  const auto& diskann_parameter = index_parameter.diskann_parameter();
+
+  if (diskann_parameter.dimension() <= 0) {
+    DINGO_LOG(ERROR) << "vector_index_parameter is illegal, dimension <= 0 : " << diskann_parameter.dimension();
+    return nullptr;
+  }
+  if (diskann_parameter.metric_type() == pb::common::MetricType::METRIC_TYPE_NONE) {
+    DINGO_LOG(ERROR) << "vector_index_parameter is illegal, METRIC_TYPE_NONE";
+    return nullptr;
+  }
+  if (diskann_parameter.num_neighbors() <= 0) {
+    DINGO_LOG(ERROR) << "vector_index_parameter is illegal, num_neighbors <= 0 : " << diskann_parameter.num_neighbors();
+    return nullptr;
+  }
+
+  // create index may throw exeception, so we need to catch it
+  try {
+    auto new_diskann_index = std::make_shared<VectorIndexDiskAnn>(id, index_parameter, epoch, range);
+    if (new_diskann_index == nullptr) {
+      DINGO_LOG(ERROR) << "create diskann index failed of new_diskann_index is nullptr"
+                       << ", id=" << id << ", parameter=" << index_parameter.ShortDebugString();
+      return nullptr;
+    } else {
+      DINGO_LOG(INFO) << "create diskann index success, id=" << id
+                      << ", parameter=" << index_parameter.ShortDebugString();
+    }
+    return new_diskann_index;
+  } catch (std::exception& e) {
+    DINGO_LOG(ERROR) << "create diskann index failed of exception occured, " << e.what() << ", id=" << id
+                     << ", parameter=" << index_parameter.ShortDebugString();
+    return nullptr;
+  }
+}
+#endif
+
 }  // namespace dingodb
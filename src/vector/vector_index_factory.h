@@ -53,6 +53,20 @@ class VectorIndexFactory {
   static std::shared_ptr<VectorIndex> NewBruteForce(int64_t id, const pb::common::VectorIndexParameter& index_parameter,
                                                     const pb::common::RegionEpoch& epoch,
                                                     const pb::common::Range& range);
+
+  static std::shared_ptr<VectorIndex> NewBinaryFlat(int64_t id, const pb::common::VectorIndexParameter& index_parameter,
+                                                    const pb::common::RegionEpoch& epoch,
+                                                    const pb::common::Range& range);
+
+  static std::shared_ptr<VectorIndex> NewBinaryIvfFlat(int64_t id,
+                                                       const pb::common::VectorIndexParameter& index_parameter,
+                                                       const pb::common::RegionEpoch& epoch,
+                                                       const pb::common::Range& range);
+
+#ifdef USE_DISKANN
+  static std::shared_ptr<VectorIndex> NewDiskAnn(int64_t id, const pb::common::VectorIndexParameter& index_parameter,
+                                                 const pb::common::RegionEpoch& epoch, const pb::common::Range& range);
+#endif
 };
 
 }  // namespace dingodb
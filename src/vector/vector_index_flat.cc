@@ -14,8 +14,10 @@
 
 #include "vector/vector_index_flat.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <future>
 #include <memory>
 #include <string>
@@ -69,10 +71,9 @@ VectorIndexFlat::VectorIndexFlat(int64_t id, const pb::common::VectorIndexParame
     raw_index_ = std::make_unique<faiss::IndexFlatL2>(dimension_);
   }
 
-  index_id_map2_ = std::make_unique<faiss::IndexIDMap2>(raw_index_.get());
 }
 
-VectorIndexFlat::~VectorIndexFlat() { index_id_map2_->reset(); }
+VectorIndexFlat::~VectorIndexFlat() = default;
 
 // const float kFloatAccuracy = 0.00001;
 
@@ -119,13 +120,19 @@ butil::Status VectorIndexFlat::AddOrUpsert(const std::vector<pb::common::VectorW
 
   BvarLatencyGuard bvar_guard(&g_flat_upsert_latency);
   RWLockWriteGuard guard(&rw_lock_);
-  std::thread([&]() {
-    if (is_upsert) {
-      faiss::IDSelectorArray sel(vector_with_ids.size(), ids2.get());
-      index_id_map2_->remove_ids(sel);
+  // The exist id is overwritten in place whether is_upsert or not, the new id is put at the tail.
+  const size_t code_size = raw_index_->code_size;
+  raw_index_->codes.resize((raw_index_->ntotal + vector_with_ids.size()) * code_size);
+  uint8_t* codes = raw_index_->codes.data();
+  for (size_t i = 0; i < vector_with_ids.size(); ++i) {
+    int64_t slot = id_slot_map_.GetSlot(ids2[i]);
+    if (slot < 0) {
+      slot = id_slot_map_.Append(ids2[i]);
     }
-    index_id_map2_->add_with_ids(vector_with_ids.size(), vectors2.get(), ids2.get());
-  }).join();
+    memcpy(codes + slot * code_size, vectors2.get() + i * dimension_, code_size);
+  }
+  raw_index_->codes.resize(id_slot_map_.Size() * code_size);
+  raw_index_->ntotal = id_slot_map_.Size();
 
   return butil::Status::OK();
 }
@@ -143,19 +150,26 @@ butil::Status VectorIndexFlat::Delete(const std::vector<int64_t>& delete_ids) {
     return butil::Status::OK();
   }
 
-  const auto& [ids, status] = VectorIndexUtils::CopyVectorId(delete_ids);
-  if (!status.ok()) {
-    DINGO_LOG(ERROR) << status.error_cstr();
-    return status;
-  }
-
-  faiss::IDSelectorArray sel(delete_ids.size(), ids.get());
-
   size_t remove_count = 0;
   {
     BvarLatencyGuard bvar_guard(&g_flat_delete_latency);
     RWLockWriteGuard guard(&rw_lock_);
-    std::thread([&]() { remove_count = index_id_map2_->remove_ids(sel); }).join();
+    // Move the last vector into the hole, keep the storage dense.
+    const size_t code_size = raw_index_->code_size;
+    uint8_t* codes = raw_index_->codes.data();
+    for (auto delete_id : delete_ids) {
+      int64_t last_slot = id_slot_map_.Size() - 1;
+      int64_t slot = id_slot_map_.Remove(delete_id);
+      if (slot < 0) {
+        continue;
+      }
+      if (slot != last_slot) {
+        memcpy(codes + slot * code_size, codes + last_slot * code_size, code_size);
+      }
+      ++remove_count;
+    }
+    raw_index_->codes.resize(id_slot_map_.Size() * code_size);
+    raw_index_->ntotal = id_slot_map_.Size();
   }
 
   if (0 == remove_count) {
@@ -203,21 +217,18 @@ butil::Status VectorIndexFlat::Search(std::vector<pb::common::VectorWithId> vect
     // use std::thread to call faiss functions
     std::thread t([&]() {
       if (!filters.empty()) {
-        //   // Build array index list.
-        //   for (auto& filter : filters) {
-        //     filter->Build(index_id_map2_->id_map);
-        //   }
-        //   auto flat_filter = filters.empty() ? nullptr : std::make_shared<FlatIDSelector>(filters);
-        //   SearchWithParam(vector_with_ids.size(), vectors.get(), topk, distances.data(), labels.data(),
-        //   flat_filter);
-
-        // use faiss's search_param to do pre-filter
-        auto flat_filter = filters.empty() ? nullptr : std::make_shared<FlatIDSelector>(filters);
+        // use faiss's search_param to do pre-filter, the selector see the slot.
+        auto flat_filter = std::make_shared<FlatIDSelector>(filters, &id_slot_map_.SlotIds());
         flat_search_parameters.sel = flat_filter.get();
-        index_id_map2_->search(vector_with_ids.size(), vectors2.get(), topk, distances.data(), labels.data(),
-                               &flat_search_parameters);
+        raw_index_->search(vector_with_ids.size(), vectors2.get(), topk, distances.data(), labels.data(),
+                           &flat_search_parameters);
       } else {
-        index_id_map2_->search(vector_with_ids.size(), vectors2.get(), topk, distances.data(), labels.data());
+        raw_index_->search(vector_with_ids.size(), vectors2.get(), topk, distances.data(), labels.data());
+      }
+
+      // slot -> vector id
+      for (auto& label : labels) {
+        label = label < 0 ? label : id_slot_map_.GetId(label);
       }
     });
     t.join();
@@ -267,11 +278,7 @@ butil::Status VectorIndexFlat::RangeSearch(std::vector<pb::common::VectorWithId>
     std::thread t(
         [&](std::promise<butil::Status>& promise_status) {
           try {
-            if (!filters.empty()) {
-              DoRangeSearch(vector_with_ids.size(), vectors2.get(), radius, range_search_result.get(), filters);
-            } else {
-              index_id_map2_->range_search(vector_with_ids.size(), vectors2.get(), radius, range_search_result.get());
-            }
+            DoRangeSearch(vector_with_ids.size(), vectors2.get(), radius, range_search_result.get(), filters);
             promise_status.set_value(butil::Status());
           } catch (std::exception& e) {
             std::string s = fmt::format("VectorIndexFlat::RangeSearch failed. error : {}", e.what());
@@ -297,6 +304,110 @@ butil::Status VectorIndexFlat::RangeSearch(std::vector<pb::common::VectorWithId>
   return butil::Status::OK();
 }
 
+namespace {
+
+// splitmix64 finalizer, vector ids are mostly sequential, need scatter them.
+inline uint64_t HashVectorId(faiss::idx_t id) {
+  uint64_t x = static_cast<uint64_t>(id);
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+}  // namespace
+
+size_t FlatIdSlotMap::FindBucket(faiss::idx_t id) const {
+  size_t mask = buckets_.size() - 1;
+  size_t pos = HashVectorId(id) & mask;
+  while (buckets_[pos] != kEmptyBucket && slot_ids_[buckets_[pos]] != id) {
+    pos = (pos + 1) & mask;
+  }
+  return pos;
+}
+
+int64_t FlatIdSlotMap::GetSlot(faiss::idx_t id) const {
+  if (buckets_.empty()) {
+    return -1;
+  }
+  uint32_t slot = buckets_[FindBucket(id)];
+  return slot == kEmptyBucket ? -1 : static_cast<int64_t>(slot);
+}
+
+int64_t FlatIdSlotMap::Append(faiss::idx_t id) {
+  if ((slot_ids_.size() + 1) * 2 > buckets_.size()) {
+    Rehash(std::max(kMinBucketNum, buckets_.size() * 2));
+  }
+
+  int64_t slot = slot_ids_.size();
+  buckets_[FindBucket(id)] = slot;
+  slot_ids_.push_back(id);
+  return slot;
+}
+
+int64_t FlatIdSlotMap::Remove(faiss::idx_t id) {
+  if (buckets_.empty()) {
+    return -1;
+  }
+  size_t pos = FindBucket(id);
+  if (buckets_[pos] == kEmptyBucket) {
+    return -1;
+  }
+
+  int64_t slot = buckets_[pos];
+  EraseBucket(pos);
+
+  int64_t last_slot = slot_ids_.size() - 1;
+  if (slot != last_slot) {
+    faiss::idx_t last_id = slot_ids_[last_slot];
+    buckets_[FindBucket(last_id)] = slot;
+    slot_ids_[slot] = last_id;
+  }
+  slot_ids_.pop_back();
+
+  return slot;
+}
+
+void FlatIdSlotMap::EraseBucket(size_t pos) {
+  size_t mask = buckets_.size() - 1;
+  size_t hole = pos;
+  for (size_t next = (pos + 1) & mask; buckets_[next] != kEmptyBucket; next = (next + 1) & mask) {
+    size_t home = HashVectorId(slot_ids_[buckets_[next]]) & mask;
+    // The entry can fill the hole only if the hole is between its home and itself.
+    if (((next - home) & mask) >= ((next - hole) & mask)) {
+      buckets_[hole] = buckets_[next];
+      hole = next;
+    }
+  }
+  buckets_[hole] = kEmptyBucket;
+}
+
+void FlatIdSlotMap::Rehash(size_t bucket_num) {
+  buckets_.assign(bucket_num, kEmptyBucket);
+  for (size_t slot = 0; slot < slot_ids_.size(); ++slot) {
+    buckets_[FindBucket(slot_ids_[slot])] = slot;
+  }
+}
+
+void FlatIdSlotMap::Reserve(int64_t count) {
+  slot_ids_.reserve(count);
+  size_t bucket_num = kMinBucketNum;
+  while (bucket_num < static_cast<size_t>(count) * 2) {
+    bucket_num *= 2;
+  }
+  if (bucket_num > buckets_.size()) {
+    Rehash(bucket_num);
+  }
+}
+
+void FlatIdSlotMap::Clear() {
+  slot_ids_.clear();
+  buckets_.clear();
+}
+
+int64_t FlatIdSlotMap::GetMemorySize() const {
+  return slot_ids_.capacity() * sizeof(faiss::idx_t) + buckets_.capacity() * sizeof(uint32_t);
+}
+
 void VectorIndexFlat::LockWrite() { rw_lock_.LockWrite(); }
 
 void VectorIndexFlat::UnlockWrite() { rw_lock_.UnlockWrite(); }
@@ -322,7 +433,16 @@ butil::Status VectorIndexFlat::Save(const std::string& path) {
   std::thread t(
       [&](std::promise<butil::Status>& promise_status) {
         try {
-          faiss::write_index(index_id_map2_.get(), path.c_str());
+          // Write as faiss::IndexIDMap2 for compatibility, borrow the flat storage, only the id_map is copied.
+          faiss::IndexIDMap2 index_id_map2;
+          index_id_map2.index = raw_index_.get();
+          index_id_map2.own_fields = false;
+          index_id_map2.d = raw_index_->d;
+          index_id_map2.ntotal = raw_index_->ntotal;
+          index_id_map2.metric_type = raw_index_->metric_type;
+          index_id_map2.is_trained = raw_index_->is_trained;
+          index_id_map2.id_map = id_slot_map_.SlotIds();
+          faiss::write_index(&index_id_map2, path.c_str());
           promise_status.set_value(butil::Status());
         } catch (std::exception& e) {
           std::string s =
@@ -454,8 +574,37 @@ butil::Status VectorIndexFlat::Load(const std::string& path) {
     }
   }
 
-  raw_index_.reset();
-  index_id_map2_ = std::move(internal_index_id_map2);
+  auto* internal_flat_index = dynamic_cast<faiss::IndexFlat*>(internal_index->index);
+  if (BAIDU_UNLIKELY(!internal_flat_index)) {
+    std::string s = fmt::format("VectorIndexFlat::Load load internal index is not IndexFlat. path : {}", path);
+    DINGO_LOG(ERROR) << s;
+    return butil::Status(pb::error::Errno::EINTERNAL, s);
+  }
+
+  // Take over the flat storage from IndexIDMap2.
+  internal_index->own_fields = false;
+  std::unique_ptr<faiss::IndexFlat> flat_index(internal_flat_index);
+
+  // Rebuild the id slot map, the duplicate id of old snapshot keep the last vector.
+  FlatIdSlotMap id_slot_map;
+  const auto& id_map = internal_index->id_map;
+  const size_t code_size = flat_index->code_size;
+  uint8_t* codes = flat_index->codes.data();
+  id_slot_map.Reserve(id_map.size());
+  for (size_t i = 0; i < id_map.size(); ++i) {
+    int64_t slot = id_slot_map.GetSlot(id_map[i]);
+    if (slot < 0) {
+      slot = id_slot_map.Append(id_map[i]);
+    }
+    if (static_cast<size_t>(slot) != i) {
+      memcpy(codes + slot * code_size, codes + i * code_size, code_size);
+    }
+  }
+  flat_index->codes.resize(id_slot_map.Size() * code_size);
+  flat_index->ntotal = id_slot_map.Size();
+
+  raw_index_ = std::move(flat_index);
+  id_slot_map_ = std::move(id_slot_map);
 
   if (pb::common::MetricType::METRIC_TYPE_COSINE == metric_type_) {
     normalize_ = true;
@@ -472,7 +621,7 @@ pb::common::MetricType VectorIndexFlat::GetMetricType() { return this->metric_ty
 
 butil::Status VectorIndexFlat::GetCount(int64_t& count) {
   RWLockReadGuard guard(&rw_lock_);
-  count = index_id_map2_->id_map.size();
+  count = id_slot_map_.Size();
   return butil::Status::OK();
 }
 
@@ -483,14 +632,13 @@ butil::Status VectorIndexFlat::GetDeletedCount(int64_t& deleted_count) {
 
 butil::Status VectorIndexFlat::GetMemorySize(int64_t& memory_size) {
   RWLockReadGuard guard(&rw_lock_);
-  auto count = index_id_map2_->ntotal;
+  auto count = raw_index_->ntotal;
   if (count == 0) {
     memory_size = 0;
     return butil::Status::OK();
   }
 
-  memory_size = count * sizeof(faiss::idx_t) + count * dimension_ * sizeof(faiss::Index::component_t) +
-                (sizeof(faiss::idx_t) + sizeof(faiss::idx_t)) * index_id_map2_->rev_map.size();
+  memory_size = count * dimension_ * sizeof(faiss::Index::component_t) + id_slot_map_.GetMemorySize();
   return butil::Status::OK();
 }
 
@@ -508,7 +656,7 @@ void VectorIndexFlat::SearchWithParam(faiss::idx_t n, const faiss::Index::compon
   // please run by root, or adjust ulimit for regular user, then you can increase FLAGS_omp_num_threads
 #pragma omp parallel for
   for (faiss::idx_t i = 0; i < n * k; ++i) {
-    li[i] = li[i] < 0 ? li[i] : index_id_map2_->id_map[li[i]];
+    li[i] = li[i] < 0 ? li[i] : id_slot_map_.GetId(li[i]);
   }
 }
 
@@ -517,7 +665,7 @@ bool VectorIndexFlat::NeedToSave(int64_t last_save_log_behind) {
 
   int64_t element_count = 0;
 
-  element_count = index_id_map2_->id_map.size();
+  element_count = id_slot_map_.Size();
 
   if (element_count == 0) {
     return false;
@@ -530,19 +678,62 @@ bool VectorIndexFlat::NeedToSave(int64_t last_save_log_behind) {
   return false;
 }
 
+butil::Status VectorIndexFlat::DeriveTo(int64_t begin_vector_id, int64_t end_vector_id, VectorIndex* target) {
+  auto* target_flat = dynamic_cast<VectorIndexFlat*>(target);
+  if (target_flat == nullptr || target_flat == this || target_flat->dimension_ != dimension_ ||
+      target_flat->raw_index_->metric_type != raw_index_->metric_type) {
+    return butil::Status(pb::error::Errno::EILLEGAL_PARAMTETERS, "derive target is not the same flat index");
+  }
+
+  RWLockReadGuard guard(&rw_lock_);
+  RWLockWriteGuard target_guard(&target_flat->rw_lock_);
+
+  auto& target_index = target_flat->raw_index_;
+  auto& target_id_slot_map = target_flat->id_slot_map_;
+
+  int64_t count = 0;
+  for (int64_t slot = 0; slot < id_slot_map_.Size(); ++slot) {
+    auto vector_id = id_slot_map_.GetId(slot);
+    count += (vector_id >= begin_vector_id && vector_id < end_vector_id) ? 1 : 0;
+  }
+
+  const size_t code_size = raw_index_->code_size;
+  const uint8_t* codes = raw_index_->codes.data();
+  target_id_slot_map.Reserve(target_id_slot_map.Size() + count);
+  target_index->codes.resize((target_index->ntotal + count) * code_size);
+  uint8_t* target_codes = target_index->codes.data();
+  for (int64_t slot = 0; slot < id_slot_map_.Size(); ++slot) {
+    auto vector_id = id_slot_map_.GetId(slot);
+    if (vector_id < begin_vector_id || vector_id >= end_vector_id) {
+      continue;
+    }
+    int64_t target_slot = target_id_slot_map.GetSlot(vector_id);
+    if (target_slot < 0) {
+      target_slot = target_id_slot_map.Append(vector_id);
+    }
+    memcpy(target_codes + target_slot * code_size, codes + slot * code_size, code_size);
+  }
+  target_index->codes.resize(target_id_slot_map.Size() * code_size);
+  target_index->ntotal = target_id_slot_map.Size();
+
+  return butil::Status::OK();
+}
+
 void VectorIndexFlat::DoRangeSearch(faiss::idx_t n, const faiss::Index::component_t* x, faiss::Index::distance_t radius,
                                     faiss::RangeSearchResult* result,
                                     std::vector<std::shared_ptr<VectorIndex::FilterFunctor>> filters) {
-  faiss::SearchParameters flat_search_parameters;
-  auto flat_filter = std::make_shared<FlatIDSelector>(filters);
-  auto flat_filter_wrapper = std::make_shared<faiss::IDSelectorTranslated>(index_id_map2_->id_map, flat_filter.get());
-  flat_search_parameters.sel = flat_filter_wrapper.get();
-
-  index_id_map2_->index->range_search(n, x, radius, result, &flat_search_parameters);
+  if (!filters.empty()) {
+    faiss::SearchParameters flat_search_parameters;
+    auto flat_filter = std::make_shared<FlatIDSelector>(filters, &id_slot_map_.SlotIds());
+    flat_search_parameters.sel = flat_filter.get();
+    raw_index_->range_search(n, x, radius, result, &flat_search_parameters);
+  } else {
+    raw_index_->range_search(n, x, radius, result);
+  }
 
 #pragma omp parallel for
   for (faiss::idx_t i = 0; i < result->lims[result->nq]; i++) {
-    result->labels[i] = result->labels[i] < 0 ? result->labels[i] : index_id_map2_->id_map[result->labels[i]];
+    result->labels[i] = result->labels[i] < 0 ? result->labels[i] : id_slot_map_.GetId(result->labels[i]);
   }
 }
 
@@ -23,7 +23,7 @@
 #include "butil/status.h"
 #include "common/synchronization.h"
 #include "faiss/Index.h"
-#include "faiss/IndexIDMap.h"
+#include "faiss/IndexFlat.h"
 #include "faiss/MetricType.h"
 #include "faiss/impl/IDSelector.h"
 #include "faiss/utils/distances.h"
@@ -33,14 +33,20 @@
 namespace dingodb {
 
 // Filter vector id
+// If slot_ids is set, the input is the slot of the flat storage and translate to vector id by slot_ids.
 class FlatIDSelector : public faiss::IDSelector {
  public:
-  FlatIDSelector(std::vector<std::shared_ptr<VectorIndex::FilterFunctor>> filters) : filters_(filters) {}
+  FlatIDSelector(std::vector<std::shared_ptr<VectorIndex::FilterFunctor>> filters,
+                 const std::vector<faiss::idx_t>* slot_ids = nullptr)
+      : filters_(filters), slot_ids_(slot_ids) {}
   ~FlatIDSelector() override = default;
   bool is_member(faiss::idx_t id) const override {  // NOLINT
     if (filters_.empty()) {
       return true;
     }
+    if (slot_ids_ != nullptr) {
+      id = (*slot_ids_)[id];
+    }
     for (const auto& filter : filters_) {
       if (!filter->Check(id)) {
         return false;
@@ -52,6 +58,49 @@ class FlatIDSelector : public faiss::IDSelector {
 
  private:
   std::vector<std::shared_ptr<VectorIndex::FilterFunctor>> filters_;
+  const std::vector<faiss::idx_t>* slot_ids_;
+};
+
+// Map vector id to the slot of the flat storage, the slot is the row of the vector in faiss::IndexFlat.
+// Slots are dense, delete move the last slot into the hole, so both directions are O(1).
+// The id to slot table is open addressing with linear probing and only store the slot,
+// the id is read back from slot_ids_, the overhead is about 8 + 4 / load_factor bytes per vector.
+class FlatIdSlotMap {
+ public:
+  FlatIdSlotMap() = default;
+
+  int64_t Size() const { return slot_ids_.size(); }
+  faiss::idx_t GetId(int64_t slot) const { return slot_ids_[slot]; }
+  const std::vector<faiss::idx_t>& SlotIds() const { return slot_ids_; }
+
+  // Return -1 if the id not exist.
+  int64_t GetSlot(faiss::idx_t id) const;
+
+  // Put the id at the last slot, the caller make sure the id not exist.
+  int64_t Append(faiss::idx_t id);
+
+  // Move the id of last slot into the slot of removed id, return the removed slot, -1 if the id not exist.
+  int64_t Remove(faiss::idx_t id);
+
+  void Reserve(int64_t count);
+  void Clear();
+
+  int64_t GetMemorySize() const;
+
+ private:
+  static constexpr uint32_t kEmptyBucket = UINT32_MAX;
+  static constexpr size_t kMinBucketNum = 16;
+
+  // Return the bucket hold the id, or the empty bucket where the id should be put.
+  size_t FindBucket(faiss::idx_t id) const;
+  // Backward shift the following buckets, so no tombstone is need.
+  void EraseBucket(size_t pos);
+  void Rehash(size_t bucket_num);
+
+  // slot -> vector id
+  std::vector<faiss::idx_t> slot_ids_;
+  // hash(vector id) -> slot, bucket number is power of 2 and load factor <= 0.5
+  std::vector<uint32_t> buckets_;
 };
 
 class VectorIndexFlat : public VectorIndex {
@@ -69,7 +118,7 @@ class VectorIndexFlat : public VectorIndex {
   butil::Status Save(const std::string& path) override;
   butil::Status Load(const std::string& path) override;
 
-  // in FLAT index, add two vector with same id will cause data conflict
+  // in FLAT index, add the exist id will overwrite the vector
   butil::Status Add(const std::vector<pb::common::VectorWithId>& vector_with_ids) override;
 
   butil::Status AddOrUpsert(const std::vector<pb::common::VectorWithId>& vector_with_ids, bool is_upsert);
@@ -110,6 +159,9 @@ class VectorIndexFlat : public VectorIndex {
 
   bool NeedToSave(int64_t last_save_log_behind) override;
 
+  bool SupportDerive() override { return true; }
+  butil::Status DeriveTo(int64_t begin_vector_id, int64_t end_vector_id, VectorIndex* target) override;
+
  private:
   [[deprecated("faiss fix bug. never use.")]] void SearchWithParam(faiss::idx_t n, const faiss::Index::component_t* x,
                                                                    faiss::idx_t k, faiss::Index::distance_t* distances,
@@ -126,9 +178,10 @@ class VectorIndexFlat : public VectorIndex {
   // only support L2 and IP
   pb::common::MetricType metric_type_;
 
-  std::unique_ptr<faiss::Index> raw_index_;
+  // contiguous vector storage, the row is the slot in id_slot_map_
+  std::unique_ptr<faiss::IndexFlat> raw_index_;
 
-  std::unique_ptr<faiss::IndexIDMap2> index_id_map2_;
+  FlatIdSlotMap id_slot_map_;
 
   RWLock rw_lock_;
 
@@ -18,9 +18,15 @@
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <limits>
 #include <memory>
+#include <queue>
 #include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "butil/status.h"
@@ -47,6 +53,7 @@ DEFINE_uint32(hnsw_max_init_max_elements, 100000, "hnsw max init max elements");
 DEFINE_uint32(hnsw_vector_batch_size_per_task, 64, "hnsw vector batch size per task");
 
 DECLARE_int64(vector_max_batch_count);
+DECLARE_int64(vector_index_max_range_search_result_count);
 
 bvar::LatencyRecorder g_hnsw_upsert_latency("dingo_hnsw_upsert_latency");
 bvar::LatencyRecorder g_hnsw_search_latency("dingo_hnsw_search_latency");
@@ -129,6 +136,7 @@ VectorIndexHnsw::VectorIndexHnsw(int64_t id, const pb::common::VectorIndexParame
                                  ThreadPoolPtr thread_pool)
     : VectorIndex(id, vector_index_parameter, epoch, range),
       hnsw_space_(nullptr),
+      quantized_space_(nullptr),
       hnsw_index_(nullptr),
       thread_pool_(thread_pool) {
   if (vector_index_type == pb::common::VectorIndexType::VECTOR_INDEX_TYPE_HNSW) {
@@ -141,12 +149,15 @@ VectorIndexHnsw::VectorIndexHnsw(int64_t id, const pb::common::VectorIndexParame
 
     this->dimension_ = hnsw_parameter.dimension();
 
-    normalize_ = false;
+    normalize_ = hnsw_parameter.metric_type() == pb::common::MetricType::METRIC_TYPE_COSINE;
 
-    if (hnsw_parameter.metric_type() == pb::common::MetricType::METRIC_TYPE_INNER_PRODUCT) {
+    quantized_space_ = HnswQuantizedSpace::New(hnsw_parameter.quantizer_type(), hnsw_parameter.dimension(),
+                                               hnsw_parameter.metric_type());
+    if (quantized_space_ != nullptr) {
+      hnsw_space_ = quantized_space_;
+    } else if (hnsw_parameter.metric_type() == pb::common::MetricType::METRIC_TYPE_INNER_PRODUCT) {
       hnsw_space_ = new hnswlib::InnerProductSpace(hnsw_parameter.dimension());
     } else if (hnsw_parameter.metric_type() == pb::common::MetricType::METRIC_TYPE_COSINE) {
-      normalize_ = true;
       hnsw_space_ = new hnswlib::InnerProductSpace(hnsw_parameter.dimension());
     } else if (hnsw_parameter.metric_type() == pb::common::MetricType::METRIC_TYPE_L2) {
       hnsw_space_ = new hnswlib::L2Space(hnsw_parameter.dimension());
@@ -159,10 +170,10 @@ VectorIndexHnsw::VectorIndexHnsw(int64_t id, const pb::common::VectorIndexParame
     DINGO_LOG(INFO) << fmt::format(
         "[vector_index.hnsw][id({})] create index, init_max_elements={} max_element_limit={} nlinks={} "
         "efconstruction={} "
-        "metric_type={} dimension={}",
+        "metric_type={} dimension={} quantizer_type={}",
         Id(), FLAGS_hnsw_max_init_max_elements, max_element_limit_, hnsw_parameter.nlinks(),
         hnsw_parameter.efconstruction(), pb::common::MetricType_Name(hnsw_parameter.metric_type()),
-        hnsw_parameter.dimension());
+        hnsw_parameter.dimension(), pb::common::HnswQuantizerType_Name(hnsw_parameter.quantizer_type()));
 
     hnsw_index_ =
         new hnswlib::HierarchicalNSW<float>(hnsw_space_, FLAGS_hnsw_max_init_max_elements, hnsw_parameter.nlinks(),
@@ -175,6 +186,24 @@ VectorIndexHnsw::~VectorIndexHnsw() {
   delete hnsw_space_;
 }
 
+const void* VectorIndexHnsw::PrepareVectorData(const float* data, std::vector<float>& norm_buffer,
+                                               std::vector<uint8_t>& code_buffer) const {
+  const float* vector_data = data;
+  if (normalize_) {
+    norm_buffer.resize(dimension_);
+    VectorIndexUtils::NormalizeVectorForHnsw(data, dimension_, norm_buffer.data());
+    vector_data = norm_buffer.data();
+  }
+
+  if (quantized_space_ == nullptr) {
+    return vector_data;
+  }
+
+  code_buffer.resize(quantized_space_->CodeSize());
+  quantized_space_->Encode(vector_data, code_buffer.data());
+  return code_buffer.data();
+}
+
 butil::Status VectorIndexHnsw::Add(const std::vector<pb::common::VectorWithId>& vector_with_ids) {
   return Upsert(vector_with_ids, true);
 }
@@ -216,21 +245,14 @@ butil::Status VectorIndexHnsw::Upsert(const std::vector<pb::common::VectorWithId
       hnsw_index_->resizeIndex(new_max_elements);
     }
 
-    if (!normalize_) {
-      ParallelFor(thread_pool_, 0, vector_with_ids.size(), is_priority, [&](size_t row) {
-        this->hnsw_index_->addPoint((void*)vector_with_ids[row].vector().float_values().data(),
-                                    vector_with_ids[row].id(), false);
-      });
-    } else {
-      ParallelFor(thread_pool_, 0, vector_with_ids.size(), is_priority, [&](size_t row) {
-        // normalize vector
-        std::vector<float> norm_array(dimension_);
-        VectorIndexUtils::NormalizeVectorForHnsw((float*)vector_with_ids[row].vector().float_values().data(),
-                                                 dimension_, norm_array.data());
+    ParallelFor(thread_pool_, 0, vector_with_ids.size(), is_priority, [&](size_t row) {
+      std::vector<float> norm_buffer;
+      std::vector<uint8_t> code_buffer;
+      const void* data =
+          PrepareVectorData(vector_with_ids[row].vector().float_values().data(), norm_buffer, code_buffer);
 
-        this->hnsw_index_->addPoint((void*)norm_array.data(), vector_with_ids[row].id(), false);
-      });
-    }
+      this->hnsw_index_->addPoint(data, vector_with_ids[row].id(), false);
+    });
     return butil::Status();
   } catch (std::runtime_error& e) {
     int64_t current_element_count = hnsw_index_->getCurrentElementCount();
@@ -429,51 +451,131 @@ butil::Status VectorIndexHnsw::Search(std::vector<pb::common::VectorWithId> vect
     hnsw_index_->setEf(search_parameter.hnsw().efsearch());
   }
 
-  if (!normalize_) {
-    ParallelFor(thread_pool_, 0, vector_with_ids.size(), true, [&](size_t row) {
-      std::priority_queue<std::pair<float, hnswlib::labeltype>> result;
+  // the data in graph is normalized or quantized, force reconstruct false, caller will read the raw vector.
+  if (normalize_ || quantized_space_ != nullptr) {
+    reconstruct = false;
+  }
 
-      try {
-        result = hnsw_index_->searchKnn(data.get() + dimension_ * row, topk, hnsw_filter.get());
-      } catch (std::runtime_error& e) {
-        std::string s = fmt::format("parallel search vector failed, error: {}", e.what());
-        LOG(ERROR) << fmt::format("[vector_index.hnsw][id({})] {}", Id(), s);
-        statuses[row] = butil::Status(pb::error::Errno::EINTERNAL, s);
-        return;
-      }
+  ParallelFor(thread_pool_, 0, vector_with_ids.size(), true, [&](size_t row) {
+    std::vector<float> norm_buffer;
+    std::vector<uint8_t> code_buffer;
+    const void* query = PrepareVectorData(data.get() + dimension_ * row, norm_buffer, code_buffer);
 
-      statuses[row] = lambda_reverse_rse_result_function(result, row, topk);
-      if (statuses[row].ok()) {
-        statuses[row] = lambda_fill_results_function(row, topk, reconstruct);
-      }
-    });
-  } else {  // normalize_
-    ParallelFor(thread_pool_, 0, vector_with_ids.size(), true, [&](size_t row) {
-      std::vector<float> norm_array(dimension_);
-      VectorIndexUtils::NormalizeVectorForHnsw((float*)(data.get() + dimension_ * row), dimension_,  // NOLINT
-                                               norm_array.data());
-
-      std::priority_queue<std::pair<float, hnswlib::labeltype>> result;
-
-      try {
-        result = hnsw_index_->searchKnn(norm_array.data(), topk, hnsw_filter.get());
-      } catch (std::runtime_error& e) {
-        std::string s = fmt::format("parallel search vector failed, error: {}", e.what());
-        LOG(ERROR) << fmt::format("[vector_index.hnsw][id({})] {}", Id(), s);
-        statuses[row] = butil::Status(pb::error::Errno::EINTERNAL, s);
-        return;
+    std::priority_queue<std::pair<float, hnswlib::labeltype>> result;
+
+    try {
+      result = hnsw_index_->searchKnn(query, topk, hnsw_filter.get());
+    } catch (std::runtime_error& e) {
+      std::string s = fmt::format("parallel search vector failed, error: {}", e.what());
+      LOG(ERROR) << fmt::format("[vector_index.hnsw][id({})] {}", Id(), s);
+      statuses[row] = butil::Status(pb::error::Errno::EINTERNAL, s);
+      return;
+    }
+
+    statuses[row] = lambda_reverse_rse_result_function(result, row, topk);
+    if (statuses[row].ok()) {
+      statuses[row] = lambda_fill_results_function(row, topk, reconstruct);
+    }
+  });
+
+  // check
+  for (const auto& status : statuses) {
+    if (!status.ok()) {
+      DINGO_LOG(ERROR) << status.error_cstr();
+      return status;
+    }
+  }
+
+  return butil::Status::OK();
+}
+
+butil::Status VectorIndexHnsw::RangeSearch(std::vector<pb::common::VectorWithId> vector_with_ids, float radius,
+                                           std::vector<std::shared_ptr<VectorIndex::FilterFunctor>> filters,
+                                           bool reconstruct, const pb::common::VectorSearchParameter& search_parameter,
+                                           std::vector<pb::index::VectorWithDistanceResult>& results) {
+  if (vector_with_ids.empty()) {
+    return butil::Status::OK();
+  }
+
+  if (vector_index_type != pb::common::VectorIndexType::VECTOR_INDEX_TYPE_HNSW) {
+    return butil::Status(pb::error::Errno::EINTERNAL, "vector index type is not supported");
+  }
+
+  for (const auto& vector_with_id : vector_with_ids) {
+    if (vector_with_id.vector().float_values_size() != this->dimension_) {
+      return butil::Status(pb::error::Errno::EVECTOR_INVALID, "vector dimension is not match, input=%d, index=%d",
+                           vector_with_id.vector().float_values_size(), this->dimension_);
+    }
+  }
+
+  if (search_parameter.hnsw().efsearch() < 0 || search_parameter.hnsw().efsearch() > 1024) {
+    std::string s = fmt::format("efsearch is illegal, {}, must between 0 and 1024", search_parameter.hnsw().efsearch());
+    DINGO_LOG(ERROR) << fmt::format("[vector_index.hnsw][id({})] {}", Id(), s);
+    return butil::Status(pb::error::Errno::EILLEGAL_PARAMTETERS, s);
+  }
+
+  // the data in graph is normalized or quantized, force reconstruct false, caller will read the raw vector.
+  if (normalize_ || quantized_space_ != nullptr) {
+    reconstruct = false;
+  }
+
+  auto hnsw_filter = filters.empty() ? nullptr : std::make_shared<HnswRangeFilterFunctor>(filters);
+
+  results.resize(vector_with_ids.size());
+  std::vector<butil::Status> statuses(vector_with_ids.size(), butil::Status::OK());
+
+  BvarLatencyGuard bvar_guard(&g_hnsw_range_search_latency);
+  RWLockReadGuard guard(&rw_lock_);
+
+  size_t ef = search_parameter.hnsw().efsearch() > 0 ? search_parameter.hnsw().efsearch() : hnsw_index_->ef_;
+
+  ParallelFor(thread_pool_, 0, vector_with_ids.size(), true, [&](size_t row) {
+    std::vector<float> norm_buffer;
+    std::vector<uint8_t> code_buffer;
+    const void* query =
+        PrepareVectorData(vector_with_ids[row].vector().float_values().data(), norm_buffer, code_buffer);
+
+    std::vector<std::pair<float, hnswlib::labeltype>> result;
+    try {
+      if (SearchRadius(query, radius, ef, hnsw_filter.get(), result)) {
+        DINGO_LOG(WARNING) << fmt::format(
+            "[vector_index.hnsw][id({})] RangeSearch result count exceed limit, limit: {}, radius: {}, the rest "
+            "within radius are dropped",
+            Id(), FLAGS_vector_index_max_range_search_result_count, radius);
       }
+    } catch (std::exception& e) {
+      std::string s = fmt::format("parallel range search vector failed, error: {}", e.what());
+      LOG(ERROR) << fmt::format("[vector_index.hnsw][id({})] {}", Id(), s);
+      statuses[row] = butil::Status(pb::error::Errno::EINTERNAL, s);
+      return;
+    }
 
-      statuses[row] = lambda_reverse_rse_result_function(result, row, topk);
+    for (const auto& [distance, label] : result) {
+      auto* vector_with_distance = results[row].add_vector_with_distances();
+      vector_with_distance->set_distance(distance);
+      vector_with_distance->set_metric_type(this->vector_index_parameter.hnsw_parameter().metric_type());
 
-      // force  reconstruct false
-      if (statuses[row].ok()) {
-        statuses[row] = lambda_fill_results_function(row, topk, false);
+      auto* vector_with_id = vector_with_distance->mutable_vector_with_id();
+      vector_with_id->set_id(label);
+      vector_with_id->mutable_vector()->set_dimension(dimension_);
+      vector_with_id->mutable_vector()->set_value_type(::dingodb::pb::common::ValueType::FLOAT);
+
+      if (reconstruct) {
+        try {
+          std::vector<float> data = hnsw_index_->getDataByLabel<float>(label);
+          for (auto& value : data) {
+            vector_with_id->mutable_vector()->add_float_values(value);
+          }
+        } catch (std::exception& e) {
+          std::string s = fmt::format("getDataByLabel failed, label: {}  err: {}", label, e.what());
+          LOG(ERROR) << fmt::format("[vector_index.hnsw][id({})] {}", Id(), s);
+          statuses[row] = butil::Status(pb::error::Errno::EINTERNAL, s);
+          return;
+        }
       }
-    });
-  }
+    }
+  });
 
-  // check
   for (const auto& status : statuses) {
     if (!status.ok()) {
       DINGO_LOG(ERROR) << status.error_cstr();
@@ -484,11 +586,106 @@ butil::Status VectorIndexHnsw::Search(std::vector<pb::common::VectorWithId> vect
   return butil::Status::OK();
 }
 
-butil::Status VectorIndexHnsw::RangeSearch(std::vector<pb::common::VectorWithId> /*vector_with_ids*/, float /*radius*/,
-                                           std::vector<std::shared_ptr<VectorIndex::FilterFunctor>> /*filters*/,
-                                           bool /*reconstruct*/, const pb::common::VectorSearchParameter& /*parameter*/,
-                                           std::vector<pb::index::VectorWithDistanceResult>& /*results*/) {
-  return butil::Status(pb::error::Errno::EVECTOR_NOT_SUPPORT, "RangeSearch not support in Hnsw!!!");
+// Same as the knn search, greedy search on upper levels to get entry point of level 0.
+// On level 0 it is a beam search, a candidate is expanded when it is inside the radius or inside the ef beam,
+// so the search keeps going until the best unexplored candidate is outside both.
+// The distance is hnsw distance, l2 is squared l2, ip and cosine are 1 - ip, same as flat range search result.
+bool VectorIndexHnsw::SearchRadius(const void* query, float radius, size_t ef, hnswlib::BaseFilterFunctor* filter,
+                                   std::vector<std::pair<float, hnswlib::labeltype>>& result) {
+  using hnswlib::labeltype;
+  using hnswlib::linklistsizeint;
+  using hnswlib::tableint;
+
+  if (hnsw_index_->cur_element_count == 0) {
+    return false;
+  }
+
+  auto dist_func = hnsw_index_->fstdistfunc_;
+  auto* dist_func_param = hnsw_index_->dist_func_param_;
+
+  tableint curr_obj = hnsw_index_->enterpoint_node_;
+  float curr_dist = dist_func(query, hnsw_index_->getDataByInternalId(curr_obj), dist_func_param);
+
+  for (int level = hnsw_index_->maxlevel_; level > 0; level--) {
+    bool changed = true;
+    while (changed) {
+      changed = false;
+      auto* data = reinterpret_cast<linklistsizeint*>(hnsw_index_->get_linklist(curr_obj, level));
+      int size = hnsw_index_->getListCount(data);
+      auto* neighbors = reinterpret_cast<tableint*>(data + 1);
+      for (int i = 0; i < size; i++) {
+        tableint candidate = neighbors[i];
+        float dist = dist_func(query, hnsw_index_->getDataByInternalId(candidate), dist_func_param);
+        if (dist < curr_dist) {
+          curr_dist = dist;
+          curr_obj = candidate;
+          changed = true;
+        }
+      }
+    }
+  }
+
+  auto* visited_list = hnsw_index_->visited_list_pool_->getFreeVisitedList();
+  auto* visited = visited_list->mass;
+  auto visited_tag = visited_list->curV;
+
+  // min heap of unexplored candidates, max heap of ef nearest.
+  using DistanceId = std::pair<float, tableint>;
+  std::priority_queue<DistanceId, std::vector<DistanceId>, std::greater<DistanceId>> candidates;
+  std::priority_queue<DistanceId> top_candidates;
+
+  auto lambda_visit = [&](tableint id, float dist) {
+    if (dist < radius && (filter == nullptr || (*filter)(hnsw_index_->getExternalLabel(id))) &&
+        !hnsw_index_->isMarkedDeleted(id)) {
+      result.emplace_back(dist, hnsw_index_->getExternalLabel(id));
+    }
+
+    if (top_candidates.size() < ef || dist < top_candidates.top().first || dist < radius) {
+      candidates.emplace(dist, id);
+      top_candidates.emplace(dist, id);
+      if (top_candidates.size() > ef) {
+        top_candidates.pop();
+      }
+    }
+  };
+
+  visited[curr_obj] = visited_tag;
+  lambda_visit(curr_obj, curr_dist);
+
+  while (!candidates.empty() &&
+         static_cast<int64_t>(result.size()) < FLAGS_vector_index_max_range_search_result_count) {
+    auto [dist, id] = candidates.top();
+    if (dist >= radius && top_candidates.size() >= ef && dist > top_candidates.top().first) {
+      break;
+    }
+    candidates.pop();
+
+    auto* data = hnsw_index_->get_linklist0(id);
+    int size = hnsw_index_->getListCount(data);
+    auto* neighbors = reinterpret_cast<tableint*>(data + 1);
+    for (int i = 0; i < size; i++) {
+      tableint neighbor = neighbors[i];
+      if (visited[neighbor] == visited_tag) {
+        continue;
+      }
+      visited[neighbor] = visited_tag;
+
+      lambda_visit(neighbor, dist_func(query, hnsw_index_->getDataByInternalId(neighbor), dist_func_param));
+    }
+  }
+
+  hnsw_index_->visited_list_pool_->releaseVisitedList(visited_list);
+
+  // Stopped by the limit with candidates left, or the last expansion went over the limit.
+  int64_t limit = FLAGS_vector_index_max_range_search_result_count;
+  bool truncated = static_cast<int64_t>(result.size()) > limit ||
+                   (static_cast<int64_t>(result.size()) == limit && !candidates.empty());
+
+  std::sort(result.begin(), result.end());
+  if (static_cast<int64_t>(result.size()) > limit) {
+    result.resize(limit);
+  }
+  return truncated;
 }
 
 void VectorIndexHnsw::LockWrite() { rw_lock_.LockWrite(); }
@@ -537,6 +734,10 @@ bool VectorIndexHnsw::IsExceedsMaxElements() {
 
 hnswlib::HierarchicalNSW<float>* VectorIndexHnsw::GetHnswIndex() { return this->hnsw_index_; }
 
+pb::common::HnswQuantizerType VectorIndexHnsw::QuantizerType() {
+  return quantized_space_ != nullptr ? quantized_space_->Type() : pb::common::HnswQuantizerType::HNSW_QUANTIZER_NONE;
+}
+
 int32_t VectorIndexHnsw::GetDimension() { return this->dimension_; }
 
 pb::common::MetricType VectorIndexHnsw::GetMetricType() {
@@ -558,6 +759,7 @@ butil::Status VectorIndexHnsw::GetDeletedCount(int64_t& deleted_count) {
 }
 
 butil::Status VectorIndexHnsw::GetMemorySize(int64_t& memory_size) {
+  // element size in hnswlib include the vector data size of space, so quantized index is counted by code size.
   memory_size = hnsw_index_->indexFileSize();
   return butil::Status::OK();
 }
@@ -595,13 +797,138 @@ bool VectorIndexHnsw::NeedToSave(int64_t last_save_log_behind) {
   return false;
 }
 
+// Copy the sub graph of [begin_vector_id, end_vector_id) to the empty target instead of insert one by one.
+// The level and data of element are kept, the edges to the outside of range are dropped, then the elements which
+// lose too many neighbors are re-linked by searching the sub graph, same as hnswlib update point.
+butil::Status VectorIndexHnsw::DeriveTo(int64_t begin_vector_id, int64_t end_vector_id, VectorIndex* target) {
+  using hnswlib::labeltype;
+  using hnswlib::linklistsizeint;
+  using hnswlib::tableint;
+
+  auto* target_hnsw = dynamic_cast<VectorIndexHnsw*>(target);
+  if (target_hnsw == nullptr || target_hnsw == this || target_hnsw->dimension_ != dimension_) {
+    return butil::Status(pb::error::Errno::EILLEGAL_PARAMTETERS, "derive target is not the same hnsw index");
+  }
+
+  RWLockReadGuard guard(&rw_lock_);
+  RWLockWriteGuard target_guard(&target_hnsw->rw_lock_);
+
+  auto* src = hnsw_index_;
+  auto* dst = target_hnsw->hnsw_index_;
+  if (dst->cur_element_count != 0 || dst->M_ != src->M_ || dst->maxM0_ != src->maxM0_ ||
+      dst->size_data_per_element_ != src->size_data_per_element_) {
+    return butil::Status(pb::error::Errno::EILLEGAL_PARAMTETERS, "derive target hnsw parameter mismatch or not empty");
+  }
+
+  // source internal id -> target internal id
+  constexpr tableint kInvalidId = std::numeric_limits<tableint>::max();
+  std::vector<tableint> id_map(src->cur_element_count, kInvalidId);
+  std::vector<tableint> src_ids;
+  for (tableint src_id = 0; src_id < src->cur_element_count; ++src_id) {
+    auto label = static_cast<int64_t>(src->getExternalLabel(src_id));
+    if (src->isMarkedDeleted(src_id) || label < begin_vector_id || label >= end_vector_id) {
+      continue;
+    }
+    id_map[src_id] = src_ids.size();
+    src_ids.push_back(src_id);
+  }
+  if (src_ids.empty()) {
+    return butil::Status::OK();
+  }
+
+  // Keep the edges inside range and translate to target internal id, return the dropped count.
+  auto filter_link_list = [&](linklistsizeint* link_list) {
+    int size = dst->getListCount(link_list);
+    auto* neighbors = reinterpret_cast<tableint*>(link_list + 1);
+    int keep = 0;
+    for (int i = 0; i < size; i++) {
+      if (id_map[neighbors[i]] != kInvalidId) {
+        neighbors[keep++] = id_map[neighbors[i]];
+      }
+    }
+    dst->setListCount(link_list, keep);
+    return size - keep;
+  };
+
+  std::vector<tableint> repair_ids;
+  try {
+    size_t max_elements = src_ids.size() + FLAGS_vector_max_batch_count * 2;
+    if (max_elements > dst->max_elements_) {
+      dst->resizeIndex(max_elements);
+    }
+    dst->label_lookup_.reserve(src_ids.size());
+
+    int max_level = -1;
+    tableint enterpoint = 0;
+    for (tableint dst_id = 0; dst_id < src_ids.size(); ++dst_id) {
+      tableint src_id = src_ids[dst_id];
+      // level 0 links, data and label
+      memcpy(dst->data_level0_memory_ + dst_id * dst->size_data_per_element_,
+             src->data_level0_memory_ + src_id * src->size_data_per_element_, src->size_data_per_element_);
+      auto* link_list0 = dst->get_linklist0(dst_id);
+      bool need_repair = filter_link_list(link_list0) > 0 && dst->getListCount(link_list0) < dst->M_;
+
+      int level = src->element_levels_[src_id];
+      dst->element_levels_[dst_id] = level;
+      if (level > 0) {
+        size_t size = dst->size_links_per_element_ * level;
+        dst->linkLists_[dst_id] = static_cast<char*>(malloc(size));
+        if (dst->linkLists_[dst_id] == nullptr) {
+          throw std::runtime_error("not enough memory for link list");
+        }
+        memcpy(dst->linkLists_[dst_id], src->linkLists_[src_id], size);
+        for (int l = 1; l <= level; ++l) {
+          auto* link_list = dst->get_linklist(dst_id, l);
+          if (filter_link_list(link_list) > 0 && dst->getListCount(link_list) == 0) {
+            need_repair = true;
+          }
+        }
+      }
+
+      // Count the copied element, so the link list is released by target on failure.
+      dst->cur_element_count = dst_id + 1;
+      dst->label_lookup_[dst->getExternalLabel(dst_id)] = dst_id;
+      if (level > max_level) {
+        max_level = level;
+        enterpoint = dst_id;
+      }
+      if (need_repair) {
+        repair_ids.push_back(dst_id);
+      }
+    }
+
+    dst->maxlevel_ = max_level;
+    dst->enterpoint_node_ = enterpoint;
+
+    if (src_ids.size() > 1) {
+      ParallelFor(target_hnsw->thread_pool_, 0, repair_ids.size(), false, [&](size_t i) {
+        tableint id = repair_ids[i];
+        dst->repairConnectionsForUpdate(dst->getDataByInternalId(id), dst->enterpoint_node_, id,
+                                        dst->element_levels_[id], dst->maxlevel_);
+      });
+    }
+  } catch (std::exception& e) {
+    std::string s = fmt::format("derive hnsw failed, error: {}", e.what());
+    DINGO_LOG(ERROR) << fmt::format("[vector_index.hnsw][id({})] {}", Id(), s);
+    return butil::Status(pb::error::Errno::EINTERNAL, s);
+  }
+
+  DINGO_LOG(INFO) << fmt::format("[vector_index.hnsw][id({})] derive to id({}), range[{}-{}) count({}) repair({})",
+                                 Id(), target->Id(), begin_vector_id, end_vector_id, src_ids.size(),
+                                 repair_ids.size());
+
+  return butil::Status::OK();
+}
+
 // calc hnsw count from memory
-uint32_t VectorIndexHnsw::CalcHnswCountFromMemory(int64_t memory_size_limit, int64_t dimension, int64_t nlinks) {
+uint32_t VectorIndexHnsw::CalcHnswCountFromMemory(int64_t memory_size_limit, int64_t dimension, int64_t nlinks,
+                                                  pb::common::HnswQuantizerType quantizer_type) {
   // size_links_level0_ = maxM0_ * sizeof(tableint) + sizeof(linklistsizeint);
   int64_t size_links_level0 = nlinks * 2 + sizeof(int64_t) + sizeof(int64_t);
 
   // int64_t size_data_per_element_ = size_links_level0_ + data_size_ + sizeof(labeltype);
-  int64_t size_data_per_element = size_links_level0 + sizeof(float_t) * dimension + sizeof(int64_t);
+  int64_t data_size = HnswQuantizedSpace::CodeSize(quantizer_type, dimension);
+  int64_t size_data_per_element = size_links_level0 + data_size + sizeof(int64_t);
 
   // int64_t size_link_list_per_element =  sizeof(void*);
   int64_t size_link_list_per_element = sizeof(int64_t);
@@ -629,7 +956,7 @@ butil::Status VectorIndexHnsw::CheckAndSetHnswParameter(pb::common::CreateHnswPa
   }
 
   auto max_element_limit = CalcHnswCountFromMemory(FLAGS_max_hnsw_memory_size_of_region, hnsw_parameter.dimension(),
-                                                   hnsw_parameter.nlinks());
+                                                   hnsw_parameter.nlinks(), hnsw_parameter.quantizer_type());
   hnsw_parameter.set_max_elements(max_element_limit);
   DINGO_LOG(INFO) << fmt::format(
       "[vector_index.hnsw] calc max element limit is {}, paramiter max_hnsw_memory_size_of_region({}) dimension({}) "
@@ -18,6 +18,7 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "butil/status.h"
@@ -26,6 +27,7 @@
 #include "hnswlib/hnswlib.h"
 #include "proto/common.pb.h"
 #include "vector/vector_index.h"
+#include "vector/vector_index_hnsw_quantizer.h"
 
 namespace dingodb {
 
@@ -37,7 +39,9 @@ class VectorIndexHnsw : public VectorIndex {
 
   ~VectorIndexHnsw() override;
 
-  static uint32_t CalcHnswCountFromMemory(int64_t memory_size_limit, int64_t dimension, int64_t nlinks);
+  static uint32_t CalcHnswCountFromMemory(
+      int64_t memory_size_limit, int64_t dimension, int64_t nlinks,
+      pb::common::HnswQuantizerType quantizer_type = pb::common::HnswQuantizerType::HNSW_QUANTIZER_NONE);
   static butil::Status CheckAndSetHnswParameter(pb::common::CreateHnswParam& hnsw_parameter);
 
   VectorIndexHnsw(const VectorIndexHnsw& rhs) = delete;
@@ -89,15 +93,33 @@ class VectorIndexHnsw : public VectorIndex {
   bool NeedToSave(int64_t last_save_log_behind) override;
   bool SupportSave() override;
 
+  bool SupportDerive() override { return true; }
+  butil::Status DeriveTo(int64_t begin_vector_id, int64_t end_vector_id, VectorIndex* target) override;
+
   hnswlib::HierarchicalNSW<float>* GetHnswIndex();
 
+  pb::common::HnswQuantizerType QuantizerType();
+
   // void NormalizeVector(const float* data, float* norm_array) const;
 
  private:
+  // Convert vector to the format stored in hnsw graph, normalize for cosine and encode for quantized index.
+  // The buffers must live until the returned data is used.
+  const void* PrepareVectorData(const float* data, std::vector<float>& norm_buffer,
+                                std::vector<uint8_t>& code_buffer) const;
+
+  // Range search on graph of one query, result is (distance, label) which distance < radius.
+  // Return true if the result is cut by vector_index_max_range_search_result_count.
+  bool SearchRadius(const void* query, float radius, size_t ef, hnswlib::BaseFilterFunctor* filter,
+                    std::vector<std::pair<float, hnswlib::labeltype>>& result);
+
   // hnsw members
   hnswlib::HierarchicalNSW<float>* hnsw_index_;
   hnswlib::SpaceInterface<float>* hnsw_space_;
 
+  // Same object as hnsw_space_ when the index is quantized, otherwise nullptr.
+  HnswQuantizedSpace* quantized_space_;
+
   // Dimension of the elements
   uint32_t dimension_;
 
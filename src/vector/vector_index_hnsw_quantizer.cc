@@ -0,0 +1,244 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "vector/vector_index_hnsw_quantizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "proto/common.pb.h"
+
+namespace dingodb {
+
+namespace {
+
+constexpr size_t kSq8HeaderSize = 2 * sizeof(float);
+
+inline void ReadSq8Header(const uint8_t* code, float& vmin, float& scale) {
+  memcpy(&vmin, code, sizeof(float));
+  memcpy(&scale, code + sizeof(float), sizeof(float));
+}
+
+float Sq8L2Distance(const void* left, const void* right, const void* param) {
+  size_t dimension = *static_cast<const size_t*>(param);
+  const auto* left_code = static_cast<const uint8_t*>(left);
+  const auto* right_code = static_cast<const uint8_t*>(right);
+
+  float left_min, left_scale, right_min, right_scale;
+  ReadSq8Header(left_code, left_min, left_scale);
+  ReadSq8Header(right_code, right_min, right_scale);
+  left_code += kSq8HeaderSize;
+  right_code += kSq8HeaderSize;
+
+  float result = 0.0f;
+  for (size_t i = 0; i < dimension; ++i) {
+    float diff = (left_min + left_scale * left_code[i]) - (right_min + right_scale * right_code[i]);
+    result += diff * diff;
+  }
+  return result;
+}
+
+float Sq8InnerProductDistance(const void* left, const void* right, const void* param) {
+  size_t dimension = *static_cast<const size_t*>(param);
+  const auto* left_code = static_cast<const uint8_t*>(left);
+  const auto* right_code = static_cast<const uint8_t*>(right);
+
+  float left_min, left_scale, right_min, right_scale;
+  ReadSq8Header(left_code, left_min, left_scale);
+  ReadSq8Header(right_code, right_min, right_scale);
+  left_code += kSq8HeaderSize;
+  right_code += kSq8HeaderSize;
+
+  float result = 0.0f;
+  for (size_t i = 0; i < dimension; ++i) {
+    result += (left_min + left_scale * left_code[i]) * (right_min + right_scale * right_code[i]);
+  }
+  return 1.0f - result;
+}
+
+float Fp16L2Distance(const void* left, const void* right, const void* param) {
+  size_t dimension = *static_cast<const size_t*>(param);
+  const auto* left_code = static_cast<const uint16_t*>(left);
+  const auto* right_code = static_cast<const uint16_t*>(right);
+
+  float result = 0.0f;
+  for (size_t i = 0; i < dimension; ++i) {
+    float diff = HnswFp16Space::HalfToFloat(left_code[i]) - HnswFp16Space::HalfToFloat(right_code[i]);
+    result += diff * diff;
+  }
+  return result;
+}
+
+float Fp16InnerProductDistance(const void* left, const void* right, const void* param) {
+  size_t dimension = *static_cast<const size_t*>(param);
+  const auto* left_code = static_cast<const uint16_t*>(left);
+  const auto* right_code = static_cast<const uint16_t*>(right);
+
+  float result = 0.0f;
+  for (size_t i = 0; i < dimension; ++i) {
+    result += HnswFp16Space::HalfToFloat(left_code[i]) * HnswFp16Space::HalfToFloat(right_code[i]);
+  }
+  return 1.0f - result;
+}
+
+}  // namespace
+
+HnswQuantizedSpace* HnswQuantizedSpace::New(pb::common::HnswQuantizerType quantizer_type, size_t dimension,
+                                            pb::common::MetricType metric_type) {
+  switch (quantizer_type) {
+    case pb::common::HnswQuantizerType::HNSW_QUANTIZER_SQ8:
+      return new HnswSq8Space(dimension, metric_type);
+    case pb::common::HnswQuantizerType::HNSW_QUANTIZER_FP16:
+      return new HnswFp16Space(dimension, metric_type);
+    default:
+      return nullptr;
+  }
+}
+
+size_t HnswQuantizedSpace::CodeSize(pb::common::HnswQuantizerType quantizer_type, size_t dimension) {
+  switch (quantizer_type) {
+    case pb::common::HnswQuantizerType::HNSW_QUANTIZER_SQ8:
+      return kSq8HeaderSize + dimension * sizeof(uint8_t);
+    case pb::common::HnswQuantizerType::HNSW_QUANTIZER_FP16:
+      return dimension * sizeof(uint16_t);
+    default:
+      return dimension * sizeof(float);
+  }
+}
+
+HnswSq8Space::HnswSq8Space(size_t dimension, pb::common::MetricType metric_type)
+    : HnswQuantizedSpace(dimension, CodeSize(pb::common::HnswQuantizerType::HNSW_QUANTIZER_SQ8, dimension)) {
+  dist_func_ = metric_type == pb::common::MetricType::METRIC_TYPE_L2 ? Sq8L2Distance : Sq8InnerProductDistance;
+}
+
+void HnswSq8Space::Encode(const float* x, uint8_t* code) const {
+  float vmin = x[0], vmax = x[0];
+  for (size_t i = 1; i < dimension_; ++i) {
+    vmin = std::min(vmin, x[i]);
+    vmax = std::max(vmax, x[i]);
+  }
+
+  float scale = (vmax - vmin) / 255.0f;
+  memcpy(code, &vmin, sizeof(float));
+  memcpy(code + sizeof(float), &scale, sizeof(float));
+
+  uint8_t* codes = code + kSq8HeaderSize;
+  for (size_t i = 0; i < dimension_; ++i) {
+    float value = scale > 0.0f ? std::round((x[i] - vmin) / scale) : 0.0f;
+    codes[i] = static_cast<uint8_t>(std::clamp(value, 0.0f, 255.0f));
+  }
+}
+
+void HnswSq8Space::Decode(const uint8_t* code, float* x) const {
+  float vmin, scale;
+  ReadSq8Header(code, vmin, scale);
+
+  const uint8_t* codes = code + kSq8HeaderSize;
+  for (size_t i = 0; i < dimension_; ++i) {
+    x[i] = vmin + scale * codes[i];
+  }
+}
+
+HnswFp16Space::HnswFp16Space(size_t dimension, pb::common::MetricType metric_type)
+    : HnswQuantizedSpace(dimension, CodeSize(pb::common::HnswQuantizerType::HNSW_QUANTIZER_FP16, dimension)) {
+  dist_func_ = metric_type == pb::common::MetricType::METRIC_TYPE_L2 ? Fp16L2Distance : Fp16InnerProductDistance;
+}
+
+void HnswFp16Space::Encode(const float* x, uint8_t* code) const {
+  auto* codes = reinterpret_cast<uint16_t*>(code);
+  for (size_t i = 0; i < dimension_; ++i) {
+    codes[i] = FloatToHalf(x[i]);
+  }
+}
+
+void HnswFp16Space::Decode(const uint8_t* code, float* x) const {
+  const auto* codes = reinterpret_cast<const uint16_t*>(code);
+  for (size_t i = 0; i < dimension_; ++i) {
+    x[i] = HalfToFloat(codes[i]);
+  }
+}
+
+uint16_t HnswFp16Space::FloatToHalf(float value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+
+  uint32_t sign = (bits >> 16) & 0x8000;
+  uint32_t float_exp = (bits >> 23) & 0xff;
+  uint32_t mantissa = bits & 0x7fffff;
+
+  // inf or nan
+  if (float_exp == 0xff) {
+    return sign | 0x7c00 | (mantissa != 0 ? 0x200 : 0);
+  }
+
+  int32_t exp = static_cast<int32_t>(float_exp) - 127 + 15;
+  // overflow, saturate to inf
+  if (exp >= 31) {
+    return sign | 0x7c00;
+  }
+
+  // subnormal or zero
+  if (exp <= 0) {
+    if (exp < -10) {
+      return sign;
+    }
+    mantissa |= 0x800000;
+    uint32_t shift = 14 - exp;
+    uint32_t half = mantissa >> shift;
+    uint32_t round = (mantissa >> (shift - 1)) & 1;
+    return sign | (half + round);
+  }
+
+  uint32_t half = sign | (static_cast<uint32_t>(exp) << 10) | (mantissa >> 13);
+  // round half up, carry into exponent is expected
+  if (mantissa & 0x1000) {
+    ++half;
+  }
+  return static_cast<uint16_t>(half);
+}
+
+float HnswFp16Space::HalfToFloat(uint16_t value) {
+  uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+  uint32_t exp = (value >> 10) & 0x1f;
+  uint32_t mantissa = value & 0x3ff;
+
+  uint32_t bits;
+  if (exp == 0) {
+    if (mantissa == 0) {
+      bits = sign;
+    } else {
+      // normalize subnormal
+      exp = 127 - 15 + 1;
+      while ((mantissa & 0x400) == 0) {
+        mantissa <<= 1;
+        --exp;
+      }
+      mantissa &= 0x3ff;
+      bits = sign | (exp << 23) | (mantissa << 13);
+    }
+  } else if (exp == 31) {
+    bits = sign | 0x7f800000 | (mantissa << 13);
+  } else {
+    bits = sign | ((exp + 127 - 15) << 23) | (mantissa << 13);
+  }
+
+  float result;
+  memcpy(&result, &bits, sizeof(result));
+  return result;
+}
+
+}  // namespace dingodb
@@ -0,0 +1,92 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGODB_VECTOR_INDEX_HNSW_QUANTIZER_H_  // NOLINT
+#define DINGODB_VECTOR_INDEX_HNSW_QUANTIZER_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "hnswlib/hnswlib.h"
+#include "proto/common.pb.h"
+
+namespace dingodb {
+
+// Hnswlib space which stores quantized codes instead of float32 vectors.
+// Both the stored vectors and the query are encoded, the distance is computed between codes.
+// The distance semantic is the same as hnswlib, L2 is squared l2, inner product is 1 - ip.
+class HnswQuantizedSpace : public hnswlib::SpaceInterface<float> {
+ public:
+  HnswQuantizedSpace(size_t dimension, size_t code_size) : dimension_(dimension), code_size_(code_size) {}
+  ~HnswQuantizedSpace() override = default;
+
+  HnswQuantizedSpace(const HnswQuantizedSpace& rhs) = delete;
+  HnswQuantizedSpace& operator=(const HnswQuantizedSpace& rhs) = delete;
+  HnswQuantizedSpace(HnswQuantizedSpace&& rhs) = delete;
+  HnswQuantizedSpace& operator=(HnswQuantizedSpace&& rhs) = delete;
+
+  // Return nullptr if quantizer_type is NONE or unknown.
+  static HnswQuantizedSpace* New(pb::common::HnswQuantizerType quantizer_type, size_t dimension,
+                                 pb::common::MetricType metric_type);
+
+  // Bytes of one encoded vector.
+  static size_t CodeSize(pb::common::HnswQuantizerType quantizer_type, size_t dimension);
+
+  virtual pb::common::HnswQuantizerType Type() const = 0;
+  virtual void Encode(const float* x, uint8_t* code) const = 0;
+  virtual void Decode(const uint8_t* code, float* x) const = 0;
+
+  size_t get_data_size() override { return code_size_; }
+  hnswlib::DISTFUNC<float> get_dist_func() override { return dist_func_; }
+  // Keep dimension as the first field, hnswlib read it as size_t.
+  void* get_dist_func_param() override { return &dimension_; }
+
+  size_t Dimension() const { return dimension_; }
+  size_t CodeSize() const { return code_size_; }
+
+ protected:
+  size_t dimension_;
+  size_t code_size_;
+  hnswlib::DISTFUNC<float> dist_func_{nullptr};
+};
+
+// 8 bit scalar quantizer, code layout: float min | float scale | uint8 codes[dimension].
+// Min and scale are kept per vector, so no training is required.
+class HnswSq8Space : public HnswQuantizedSpace {
+ public:
+  HnswSq8Space(size_t dimension, pb::common::MetricType metric_type);
+  ~HnswSq8Space() override = default;
+
+  pb::common::HnswQuantizerType Type() const override { return pb::common::HnswQuantizerType::HNSW_QUANTIZER_SQ8; }
+  void Encode(const float* x, uint8_t* code) const override;
+  void Decode(const uint8_t* code, float* x) const override;
+};
+
+// Half precision float, code layout: uint16 codes[dimension].
+class HnswFp16Space : public HnswQuantizedSpace {
+ public:
+  HnswFp16Space(size_t dimension, pb::common::MetricType metric_type);
+  ~HnswFp16Space() override = default;
+
+  pb::common::HnswQuantizerType Type() const override { return pb::common::HnswQuantizerType::HNSW_QUANTIZER_FP16; }
+  void Encode(const float* x, uint8_t* code) const override;
+  void Decode(const uint8_t* code, float* x) const override;
+
+  static uint16_t FloatToHalf(float value);
+  static float HalfToFloat(uint16_t value);
+};
+
+}  // namespace dingodb
+
+#endif  // DINGODB_VECTOR_INDEX_HNSW_QUANTIZER_H_
@@ -27,6 +27,7 @@
 #include "butil/compiler_specific.h"
 #include "butil/status.h"
 #include "common/constant.h"
+#include "common/helper.h"
 #include "common/logging.h"
 #include "faiss/Index.h"
 #include "faiss/IndexFlat.h"
@@ -38,6 +39,7 @@
 #include "proto/debug.pb.h"
 #include "proto/error.pb.h"
 #include "proto/index.pb.h"
+#include "vector/vector_index_train_sample.h"
 #include "vector/vector_index_utils.h"
 
 namespace dingodb {
@@ -109,13 +111,28 @@ butil::Status VectorIndexIvfFlat::AddOrUpsert(const std::vector<pb::common::Vect
     return butil::Status(pb::error::Errno::EVECTOR_NOT_TRAIN, s);
   }
 
+  // The deleted vector still in the inverted lists, remove it physically before add again.
+  std::vector<faiss::idx_t> revive_ids;
+  for (size_t i = 0; i < vector_with_ids.size() && !tombstones_.empty(); ++i) {
+    if (tombstones_.erase(ids2[i]) > 0) {
+      revive_ids.push_back(ids2[i]);
+    }
+  }
+
+  VectorIndexUtils::MaterializeInvertedLists(index_.get());
   std::thread([&]() {
     if (is_upsert) {
       faiss::IDSelectorArray sel(vector_with_ids.size(), ids2.get());
       index_->remove_ids(sel);
+    } else if (!revive_ids.empty()) {
+      faiss::IDSelectorArray sel(revive_ids.size(), revive_ids.data());
+      index_->remove_ids(sel);
     }
     index_->add_with_ids(vector_with_ids.size(), vectors2.get(), ids2.get());
   }).join();
+  for (size_t i = 0; i < vector_with_ids.size(); ++i) {
+    vector_ids_.insert(ids2[i]);
+  }
 
   return butil::Status::OK();
 }
@@ -154,30 +171,20 @@ butil::Status VectorIndexIvfFlat::Delete(const std::vector<int64_t>& delete_ids)
     return butil::Status::OK();
   }
 
-  const auto& [ids, status] = VectorIndexUtils::CopyVectorId(delete_ids);
-  if (!status.ok()) {
-    DINGO_LOG(ERROR) << status.error_cstr();
-    return status;
+  // Only mark the tombstone, remove_ids move the codes of all the inverted lists, it is done by Compact in background.
+  BvarLatencyGuard bvar_guard(&g_ivf_flat_delete_latency);
+  RWLockWriteGuard guard(&rw_lock_);
+  if (BAIDU_UNLIKELY(!DoIsTrained())) {
+    std::string s = fmt::format("ivf flat not train. train first. ignored");
+    DINGO_LOG(WARNING) << s;
+    return butil::Status::OK();
   }
 
-  faiss::IDSelectorArray sel(delete_ids.size(), ids.get());
-
-  size_t remove_count = 0;
-  {
-    BvarLatencyGuard bvar_guard(&g_ivf_flat_delete_latency);
-    RWLockWriteGuard guard(&rw_lock_);
-    if (BAIDU_UNLIKELY(!DoIsTrained())) {
-      std::string s = fmt::format("ivf flat not train. train first. ignored");
-      DINGO_LOG(WARNING) << s;
-      return butil::Status::OK();
+  // Only tombstone the vector in the inverted lists, else it is never purged and inflates the deleted count.
+  for (auto delete_id : delete_ids) {
+    if (vector_ids_.count(delete_id) > 0) {
+      tombstones_.insert(delete_id);
     }
-
-    std::thread([&]() { remove_count = index_->remove_ids(sel); }).join();
-  }
-
-  if (0 == remove_count) {
-    DINGO_LOG(ERROR) << fmt::format("not found id : {}", id);
-    return butil::Status(pb::error::Errno::EVECTOR_INVALID, fmt::format("not found : {}", id));
   }
 
   return butil::Status::OK();
@@ -247,8 +254,8 @@ butil::Status VectorIndexIvfFlat::Search(std::vector<pb::common::VectorWithId> v
 
     // use std::thread to call faiss functions
     std::thread t([&]() {
-      if (!filters.empty()) {
-        auto ivf_flat_filter = filters.empty() ? nullptr : std::make_shared<IvfFlatIDSelector>(filters);
+      if (!filters.empty() || !tombstones_.empty()) {
+        auto ivf_flat_filter = std::make_shared<IvfFlatIDSelector>(filters, &tombstones_);
         ivf_search_parameters.sel = ivf_flat_filter.get();
         index_->search(vector_with_ids.size(), vectors2.get(), topk, distances.data(), labels.data(),
                        &ivf_search_parameters);
@@ -333,8 +340,8 @@ butil::Status VectorIndexIvfFlat::RangeSearch(std::vector<pb::common::VectorWith
     std::thread t(
         [&](std::promise<butil::Status>& promise_status) {
           try {
-            if (!filters.empty()) {
-              auto ivf_flat_filter = filters.empty() ? nullptr : std::make_shared<IvfFlatIDSelector>(filters);
+            if (!filters.empty() || !tombstones_.empty()) {
+              auto ivf_flat_filter = std::make_shared<IvfFlatIDSelector>(filters, &tombstones_);
               ivf_search_parameters.sel = ivf_flat_filter.get();
               index_->range_search(vector_with_ids.size(), vectors2.get(), radius, range_search_result.get(),
                                    &ivf_search_parameters);
@@ -392,6 +399,9 @@ butil::Status VectorIndexIvfFlat::Save(const std::string& path) {
   std::thread t(
       [&](std::promise<butil::Status>& promise_status) {
         try {
+          // snapshot must be self-contained, not refer to the mmap file and the tombstones.
+          VectorIndexUtils::MaterializeInvertedLists(index_.get());
+          VectorIndexUtils::PurgeTombstones(index_.get(), tombstones_, vector_ids_);
           faiss::write_index(index_.get(), path.c_str());
           promise_status.set_value(butil::Status());
         } catch (std::exception& e) {
@@ -432,7 +442,7 @@ butil::Status VectorIndexIvfFlat::Load(const std::string& path) {
       [&](std::promise<std::pair<faiss::Index*, butil::Status>>& promise_status) {
         faiss::Index* internal_raw_index = nullptr;
         try {
-          internal_raw_index = faiss::read_index(path.c_str(), 0);
+          internal_raw_index = faiss::read_index(path.c_str(), VectorIndexUtils::FaissReadIndexIoFlags());
           promise_status.set_value(std::pair<faiss::Index*, butil::Status>(internal_raw_index, butil::Status()));
         } catch (std::exception& e) {
           std::string s =
@@ -529,9 +539,12 @@ butil::Status VectorIndexIvfFlat::Load(const std::string& path) {
 
   quantizer_.reset();
   index_ = std::move(internal_index_ivf_flat);
+  tombstones_.clear();
+  vector_ids_ = VectorIndexUtils::GetIvfIds(index_.get());
 
   nlist_ = index_->nlist;
   train_data_size_ = index_->ntotal;
+  train_time_ms_ = Helper::TimestampMs();
 
   // this is important.
   if (pb::common::MetricType::METRIC_TYPE_COSINE == metric_type_) {
@@ -558,7 +571,8 @@ butil::Status VectorIndexIvfFlat::GetCount(int64_t& count) {
 }
 
 butil::Status VectorIndexIvfFlat::GetDeletedCount(int64_t& deleted_count) {
-  deleted_count = 0;
+  RWLockReadGuard guard(&rw_lock_);
+  deleted_count = tombstones_.size();
   return butil::Status::OK();
 }
 
@@ -690,6 +704,7 @@ butil::Status VectorIndexIvfFlat::Train(const std::vector<float>& train_datas) {
   }
 
   train_data_size_ = data_size;
+  train_time_ms_ = Helper::TimestampMs();
 
   return butil::Status::OK();
 }
@@ -732,14 +747,37 @@ bool VectorIndexIvfFlat::NeedToRebuild() {
     return true;
   }
 
+  // The train data is capped by the train sample, retrain with more data not help.
   if (BAIDU_UNLIKELY(nlist_ == nlist_org_ && 1 != nlist_ &&
-                     index_->ntotal >= clustering_parameters.max_points_per_centroid * nlist_org_)) {
+                     index_->ntotal >= clustering_parameters.max_points_per_centroid * nlist_org_ &&
+                     train_data_size_ < VectorIndexTrainSample::GetCapacity(vector_index_parameter))) {
     return train_data_size_ <= (index_->ntotal / 2);
   }
 
   return false;
 }
 
+bool VectorIndexIvfFlat::NeedToRetrain(int64_t train_sample_count) {
+  RWLockReadGuard guard(&rw_lock_);
+
+  if (BAIDU_UNLIKELY(!DoIsTrained())) {
+    return false;
+  }
+
+  return VectorIndexUtils::NeedRetrainOnSample(train_data_size_, train_sample_count, nlist_org_,
+                                               VectorIndexTrainSample::GetCapacity(vector_index_parameter));
+}
+
+bool VectorIndexIvfFlat::NeedToRetrainOnImbalance(int32_t retrain_num) {
+  RWLockReadGuard guard(&rw_lock_);
+
+  if (BAIDU_UNLIKELY(!DoIsTrained())) {
+    return false;
+  }
+
+  return VectorIndexUtils::NeedRetrainOnImbalance(index_.get(), train_time_ms_, retrain_num);
+}
+
 bool VectorIndexIvfFlat::IsTrained() {
   RWLockReadGuard guard(&rw_lock_);
   return DoIsTrained();
@@ -768,6 +806,66 @@ bool VectorIndexIvfFlat::NeedToSave(int64_t last_save_log_behind) {
   return false;
 }
 
+bool VectorIndexIvfFlat::NeedToCompact() {
+  RWLockReadGuard guard(&rw_lock_);
+  if (BAIDU_UNLIKELY(!DoIsTrained())) {
+    return false;
+  }
+
+  return VectorIndexUtils::NeedPurgeTombstones(tombstones_.size(), index_->ntotal);
+}
+
+butil::Status VectorIndexIvfFlat::Compact() {
+  RWLockWriteGuard guard(&rw_lock_);
+  if (BAIDU_UNLIKELY(!DoIsTrained())) {
+    return butil::Status::OK();
+  }
+
+  size_t tombstone_count = tombstones_.size();
+  size_t remove_count = 0;
+  std::thread([&]() {
+    remove_count = VectorIndexUtils::PurgeTombstones(index_.get(), tombstones_, vector_ids_);
+  }).join();
+
+  DINGO_LOG(INFO) << fmt::format("[vector_index.ivf_flat][id({})] compact, tombstone count({}) remove count({})", Id(),
+                                 tombstone_count, remove_count);
+
+  return butil::Status::OK();
+}
+
+butil::Status VectorIndexIvfFlat::DeriveTo(int64_t begin_vector_id, int64_t end_vector_id, VectorIndex* target) {
+  auto* target_ivf_flat = dynamic_cast<VectorIndexIvfFlat*>(target);
+  if (target_ivf_flat == nullptr || target_ivf_flat == this || target_ivf_flat->dimension_ != dimension_ ||
+      target_ivf_flat->metric_type_ != metric_type_) {
+    return butil::Status(pb::error::Errno::EILLEGAL_PARAMTETERS, "derive target is not the same ivf flat index");
+  }
+
+  RWLockReadGuard guard(&rw_lock_);
+  if (BAIDU_UNLIKELY(!DoIsTrained())) {
+    return butil::Status(pb::error::Errno::EVECTOR_NOT_TRAIN, "ivf flat not train, can't derive");
+  }
+
+  RWLockWriteGuard target_guard(&target_ivf_flat->rw_lock_);
+  // Keep the degenerated nlist of source.
+  target_ivf_flat->nlist_ = index_->nlist;
+  target_ivf_flat->Init();
+
+  butil::Status status;
+  std::thread([&]() {
+    status = VectorIndexUtils::DeriveIvfIndex(index_.get(), begin_vector_id, end_vector_id, tombstones_,
+                                              target_ivf_flat->index_.get());
+  }).join();
+  if (!status.ok()) {
+    target_ivf_flat->Reset();
+    return status;
+  }
+  target_ivf_flat->train_data_size_ = train_data_size_;
+  target_ivf_flat->train_time_ms_ = train_time_ms_;
+  target_ivf_flat->vector_ids_ = VectorIndexUtils::GetIvfIds(target_ivf_flat->index_.get());
+
+  return butil::Status::OK();
+}
+
 void VectorIndexIvfFlat::Init() {
   if (pb::common::MetricType::METRIC_TYPE_L2 == metric_type_) {
     quantizer_ = std::make_unique<faiss::IndexFlatL2>(dimension_);
@@ -797,7 +895,10 @@ bool VectorIndexIvfFlat::DoIsTrained() {
 }
 
 void VectorIndexIvfFlat::Reset() {
+  tombstones_.clear();
+  vector_ids_.clear();
   quantizer_->reset();
+  VectorIndexUtils::MaterializeInvertedLists(index_.get());
   index_->reset();
   nlist_ = nlist_org_;
 }
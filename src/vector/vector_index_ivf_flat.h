@@ -18,6 +18,7 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 #include "butil/status.h"
@@ -32,12 +33,17 @@
 
 namespace dingodb {
 
-// Filter vector id
+// Filter vector id, and skip the deleted vector by tombstones.
 class IvfFlatIDSelector : public faiss::IDSelector {
  public:
-  explicit IvfFlatIDSelector(std::vector<std::shared_ptr<VectorIndex::FilterFunctor>> filters) : filters_(filters) {}
+  explicit IvfFlatIDSelector(std::vector<std::shared_ptr<VectorIndex::FilterFunctor>> filters,
+                             const std::unordered_set<int64_t>* tombstones = nullptr)
+      : filters_(filters), tombstones_(tombstones) {}
   ~IvfFlatIDSelector() override = default;
   bool is_member(faiss::idx_t id) const override {  // NOLINT
+    if (tombstones_ != nullptr && tombstones_->count(id) > 0) {
+      return false;
+    }
     if (filters_.empty()) {
       return true;
     }
@@ -52,6 +58,7 @@ class IvfFlatIDSelector : public faiss::IDSelector {
 
  private:
   std::vector<std::shared_ptr<VectorIndex::FilterFunctor>> filters_;
+  const std::unordered_set<int64_t>* tombstones_;
 };
 
 class VectorIndexIvfFlat : public VectorIndex {
@@ -104,8 +111,14 @@ class VectorIndexIvfFlat : public VectorIndex {
   butil::Status Train([[maybe_unused]] const std::vector<pb::common::VectorWithId>& vectors) override;
   bool NeedToRebuild() override;
   bool NeedTrain() override { return true; }
+  bool NeedToRetrain(int64_t train_sample_count) override;
+  bool NeedToRetrainOnImbalance(int32_t retrain_num) override;
   bool IsTrained() override;
   bool NeedToSave(int64_t last_save_log_behind) override;
+  bool NeedToCompact() override;
+  butil::Status Compact() override;
+  bool SupportDerive() override { return true; }
+  butil::Status DeriveTo(int64_t begin_vector_id, int64_t end_vector_id, VectorIndex* target) override;
 
  private:
   void Init();
@@ -141,6 +154,13 @@ class VectorIndexIvfFlat : public VectorIndex {
 
   // first  train data size
   faiss::idx_t train_data_size_;
+  // last train time, limit the retrain frequency by imbalance
+  int64_t train_time_ms_{0};
+
+  // deleted vector ids, skipped by search and purged from the inverted lists by Compact/Save.
+  std::unordered_set<int64_t> tombstones_;
+  // vector ids of the inverted lists include the tombstones, check the deleted vector exist in O(1).
+  std::unordered_set<int64_t> vector_ids_;
 };
 
 }  // namespace dingodb
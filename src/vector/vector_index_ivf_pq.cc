@@ -294,6 +294,11 @@ butil::Status VectorIndexIvfPq::GetCount(int64_t& count) {
 }
 
 butil::Status VectorIndexIvfPq::GetDeletedCount(int64_t& deleted_count) {
+  RWLockReadGuard guard(&rw_lock_);
+  if (DoIsTrained() && index_type_in_ivf_pq_ == IndexTypeInIvfPq::kIvfPq) {
+    return index_raw_ivf_pq_->GetDeletedCount(deleted_count);
+  }
+
   deleted_count = 0;
   return butil::Status::OK();
 }
@@ -488,6 +493,27 @@ bool VectorIndexIvfPq::NeedToRebuild() {
   return false;
 }
 
+bool VectorIndexIvfPq::NeedToRetrain(int64_t train_sample_count) {
+  RWLockReadGuard guard(&rw_lock_);
+
+  // The flat stage is rebuilt to ivf pq by count, see NeedToRebuild.
+  if (index_type_in_ivf_pq_ == IndexTypeInIvfPq::kIvfPq) {
+    return index_raw_ivf_pq_->NeedToRetrain(train_sample_count);
+  }
+
+  return false;
+}
+
+bool VectorIndexIvfPq::NeedToRetrainOnImbalance(int32_t retrain_num) {
+  RWLockReadGuard guard(&rw_lock_);
+
+  if (index_type_in_ivf_pq_ == IndexTypeInIvfPq::kIvfPq) {
+    return index_raw_ivf_pq_->NeedToRetrainOnImbalance(retrain_num);
+  }
+
+  return false;
+}
+
 bool VectorIndexIvfPq::IsTrained() {
   RWLockReadGuard guard(&rw_lock_);
   return DoIsTrained();
@@ -520,6 +546,54 @@ bool VectorIndexIvfPq::NeedToSave(int64_t last_save_log_behind) {
   return false;
 }
 
+bool VectorIndexIvfPq::NeedToCompact() {
+  RWLockReadGuard guard(&rw_lock_);
+  if (DoIsTrained() && index_type_in_ivf_pq_ == IndexTypeInIvfPq::kIvfPq) {
+    return index_raw_ivf_pq_->NeedToCompact();
+  }
+
+  return false;
+}
+
+butil::Status VectorIndexIvfPq::Compact() {
+  RWLockWriteGuard guard(&rw_lock_);
+  if (DoIsTrained() && index_type_in_ivf_pq_ == IndexTypeInIvfPq::kIvfPq) {
+    return index_raw_ivf_pq_->Compact();
+  }
+
+  return butil::Status::OK();
+}
+
+butil::Status VectorIndexIvfPq::DeriveTo(int64_t begin_vector_id, int64_t end_vector_id, VectorIndex* target) {
+  auto* target_ivf_pq = dynamic_cast<VectorIndexIvfPq*>(target);
+  if (target_ivf_pq == nullptr || target_ivf_pq == this || target_ivf_pq->dimension_ != dimension_ ||
+      target_ivf_pq->metric_type_ != metric_type_) {
+    return butil::Status(pb::error::Errno::EILLEGAL_PARAMTETERS, "derive target is not the same ivf pq index");
+  }
+
+  RWLockReadGuard guard(&rw_lock_);
+  if (BAIDU_UNLIKELY(!DoIsTrained())) {
+    return butil::Status(pb::error::Errno::EVECTOR_NOT_TRAIN, "ivf pq not train, can't derive");
+  }
+
+  RWLockWriteGuard target_guard(&target_ivf_pq->rw_lock_);
+  // The target use the same internal index type, flat or ivf pq.
+  target_ivf_pq->index_type_in_ivf_pq_ = index_type_in_ivf_pq_;
+  target_ivf_pq->Init();
+
+  butil::Status status;
+  if (index_type_in_ivf_pq_ == IndexTypeInIvfPq::kFlat) {
+    status = index_flat_->DeriveTo(begin_vector_id, end_vector_id, target_ivf_pq->index_flat_.get());
+  } else {
+    status = index_raw_ivf_pq_->DeriveTo(begin_vector_id, end_vector_id, target_ivf_pq->index_raw_ivf_pq_.get());
+  }
+  if (!status.ok()) {
+    target_ivf_pq->Reset();
+  }
+
+  return status;
+}
+
 pb::common::VectorIndexType VectorIndexIvfPq::VectorIndexSubType() {
   RWLockReadGuard guard(&rw_lock_);
   if (BAIDU_UNLIKELY(!DoIsTrained())) {
@@ -79,9 +79,15 @@ class VectorIndexIvfPq : public VectorIndex {
   butil::Status Train(const std::vector<float>& train_datas) override;
   butil::Status Train([[maybe_unused]] const std::vector<pb::common::VectorWithId>& vectors) override;
   bool NeedToRebuild() override;
+  bool NeedToRetrain(int64_t train_sample_count) override;
+  bool NeedToRetrainOnImbalance(int32_t retrain_num) override;
   bool NeedTrain() override { return true; }
   bool IsTrained() override;
   bool NeedToSave(int64_t last_save_log_behind) override;
+  bool NeedToCompact() override;
+  butil::Status Compact() override;
+  bool SupportDerive() override { return true; }
+  butil::Status DeriveTo(int64_t begin_vector_id, int64_t end_vector_id, VectorIndex* target) override;
 
   pb::common::VectorIndexType VectorIndexSubType() override;
 
@@ -14,11 +14,15 @@
 
 #include "vector/vector_index_manager.h"
 
+#include <algorithm>
 #include <atomic>
 #include <cassert>
 #include <cstdint>
+#include <deque>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "braft/util.h"
@@ -40,8 +44,11 @@
 #include "vector/codec.h"
 #include "vector/vector_index.h"
 #include "vector/vector_index_factory.h"
+#include "vector/vector_index_memory_budget.h"
 #include "vector/vector_index_snapshot.h"
 #include "vector/vector_index_snapshot_manager.h"
+#include "vector/vector_index_train_sample.h"
+#include "vector/vector_index_utils.h"
 
 namespace dingodb {
 
@@ -50,10 +57,16 @@ DEFINE_int32(vector_background_worker_num, 16, "vector index background worker n
 DEFINE_int32(vector_fast_background_worker_num, 8, "vector index fast background worker num");
 DEFINE_int64(vector_fast_build_log_gap, 50, "vector index fast build log gap");
 DEFINE_int64(vector_pull_snapshot_min_log_gap, 66, "vector index pull snapshot min log gap");
+DEFINE_int32(vector_index_build_decode_parallel_num, 4, "vector index build decode vector data parallel num");
+DEFINE_int32(vector_index_build_chunk_size, 4096, "vector index build scan chunk size, unit vector count");
+DEFINE_int64(vector_index_replay_wal_window_size, 1024, "vector index replay wal window size, unit log entry");
+DEFINE_int32(vector_index_replay_wal_decode_parallel_num, 4, "vector index replay wal decode parallel num");
+DEFINE_bool(vector_index_enable_split_derive, true,
+            "derive vector index from the in-memory parent vector index at split, instead of build from rocksdb");
 
 std::string RebuildVectorIndexTask::Trace() {
-  return fmt::format("[vector_index.rebuild][id({}).start_time({}).job_id({})] {}", vector_index_wrapper_->Id(),
-                     Helper::FormatMsTime(start_time_), job_id_, trace_);
+  return fmt::format("[vector_index.rebuild][id({}).start_time({}).job_id({})] {} {}", vector_index_wrapper_->Id(),
+                     Helper::FormatMsTime(start_time_), job_id_, trace_, vector_index_wrapper_->BuildProgress());
 }
 
 void RebuildVectorIndexTask::Run() {
@@ -123,6 +136,10 @@ void RebuildVectorIndexTask::Run() {
           vector_index_wrapper_->Id(), trace_);
       return;
     }
+    // Back off the next imbalance check, the retrain not help when the data is skewed by nature.
+    if (vector_index_wrapper_->NeedToRetrainOnImbalance()) {
+      vector_index_wrapper_->IncImbalanceRetrainNum();
+    }
   } else {
     // Compare vector index snapshot epoch and region epoch.
     auto snapshot_set = vector_index_wrapper_->SnapshotSet();
@@ -225,9 +242,45 @@ void SaveVectorIndexTask::Run() {
   }
 }
 
+std::string CompactVectorIndexTask::Trace() {
+  return fmt::format("[vector_index.compact][id({}).start_time({})] {}", vector_index_wrapper_->Id(),
+                     Helper::FormatMsTime(start_time_), trace_);
+}
+
+void CompactVectorIndexTask::Run() {
+  int64_t start_time = Helper::TimestampMs();
+  ON_SCOPE_EXIT([&]() {
+    vector_index_wrapper_->DecPendingTaskNum();
+    DINGO_LOG(INFO) << fmt::format("[vector_index.compact][index_id({})][trace({})] run finish, run_time({}).",
+                                   vector_index_wrapper_->Id(), trace_, Helper::TimestampMs() - start_time);
+  });
+
+  if (vector_index_wrapper_->IsStop()) {
+    DINGO_LOG(INFO) << fmt::format(
+        "[vector_index.compact][index_id({})][trace({})] vector index is stop, gave up compact vector index.",
+        vector_index_wrapper_->Id(), trace_);
+    return;
+  }
+
+  auto vector_index = vector_index_wrapper_->GetOwnVectorIndex();
+  if (vector_index == nullptr) {
+    DINGO_LOG(INFO) << fmt::format(
+        "[vector_index.compact][index_id({})][trace({})] vector index is not ready, gave up compact vector index.",
+        vector_index_wrapper_->Id(), trace_);
+    return;
+  }
+
+  auto status = vector_index->Compact();
+  if (!status.ok()) {
+    DINGO_LOG(ERROR) << fmt::format(
+        "[vector_index.compact][index_id({})][trace({})] compact vector index failed, error {}",
+        vector_index_wrapper_->Id(), trace_, status.error_str());
+  }
+}
+
 std::string LoadOrBuildVectorIndexTask::Trace() {
-  return fmt::format("[vector_index.loadorbuild][id({}).start_time({}).job_id({})] {}", vector_index_wrapper_->Id(),
-                     Helper::FormatMsTime(start_time_), job_id_, trace_);
+  return fmt::format("[vector_index.loadorbuild][id({}).start_time({}).job_id({})] {} {}", vector_index_wrapper_->Id(),
+                     Helper::FormatMsTime(start_time_), job_id_, trace_, vector_index_wrapper_->BuildProgress());
 }
 
 void LoadOrBuildVectorIndexTask::Run() {
@@ -448,8 +501,8 @@ void LoadAsyncBuildVectorIndexTask::Run() {
 }
 
 std::string BuildVectorIndexTask::Trace() {
-  return fmt::format("[vector_index.build][id({}).start_time({}).job_id({})] {}", vector_index_wrapper_->Id(),
-                     Helper::FormatMsTime(start_time_), job_id_, trace_);
+  return fmt::format("[vector_index.build][id({}).start_time({}).job_id({})] {} {}", vector_index_wrapper_->Id(),
+                     Helper::FormatMsTime(start_time_), job_id_, trace_, vector_index_wrapper_->BuildProgress());
 }
 
 void BuildVectorIndexTask::Run() {
@@ -986,10 +1039,6 @@ butil::Status VectorIndexManager::ReplayWalToVectorIndex(VectorIndexPtr vector_i
     return butil::Status();
   }
 
-  DINGO_LOG(INFO) << fmt::format("[vector_index.replaywal][index_id({})] replay wal log({}-{})", vector_index->Id(),
-                                 start_log_id, end_log_id);
-
-  int64_t start_time = Helper::TimestampMs();
   auto raft_kv_engine = Server::GetInstance().GetRaftStoreEngine();
   auto node = raft_kv_engine->GetNode(vector_index->Id());
   if (node == nullptr) {
@@ -1001,6 +1050,22 @@ butil::Status VectorIndexManager::ReplayWalToVectorIndex(VectorIndexPtr vector_i
     return butil::Status(pb::error::Errno::EINTERNAL, fmt::format("Not found log stroage {}", vector_index->Id()));
   }
 
+  return ReplayWalToVectorIndex(log_stroage, vector_index, start_log_id, end_log_id);
+}
+
+butil::Status VectorIndexManager::ReplayWalToVectorIndex(std::shared_ptr<SegmentLogStorage> log_stroage,
+                                                         VectorIndexPtr vector_index, int64_t start_log_id,
+                                                         int64_t end_log_id) {
+  assert(vector_index != nullptr);
+
+  if (start_log_id >= end_log_id) {
+    return butil::Status();
+  }
+
+  DINGO_LOG(INFO) << fmt::format("[vector_index.replaywal][index_id({})] replay wal log({}-{})", vector_index->Id(),
+                                 start_log_id, end_log_id);
+
+  int64_t start_time = Helper::TimestampMs();
   if (end_log_id < log_stroage->FirstLogIndex()) {
     DINGO_LOG(FATAL) << fmt::format("[vector_index.replaywal][index_id({})] abnormal end_log_id({}) first_log_id({})",
                                     vector_index->Id(), end_log_id, log_stroage->FirstLogIndex());
@@ -1010,80 +1075,197 @@ butil::Status VectorIndexManager::ReplayWalToVectorIndex(VectorIndexPtr vector_i
   int64_t min_vector_id = 0, max_vector_id = 0;
   VectorCodec::DecodeRangeToVectorId(vector_index->Range(), min_vector_id, max_vector_id);
 
-  std::vector<pb::common::VectorWithId> vectors;
-  vectors.reserve(Constant::kBuildVectorIndexBatchSize);
-  std::vector<int64_t> ids;
-  ids.reserve(Constant::kBuildVectorIndexBatchSize);
+  // Coalesce add/delete of same vector id with last-writer-wins, the upsert and delete set are disjoint,
+  // so apply them in any order get the same result as replay one by one.
+  std::unordered_map<int64_t, pb::common::VectorWithId> upsert_vectors;
+  std::unordered_set<int64_t> delete_ids;
+  auto apply_func = [&]() {
+    if (!delete_ids.empty()) {
+      std::vector<int64_t> ids;
+      ids.reserve(std::min(delete_ids.size(), static_cast<size_t>(Constant::kBuildVectorIndexBatchSize)));
+      for (auto vector_id : delete_ids) {
+        ids.push_back(vector_id);
+        if (ids.size() >= Constant::kBuildVectorIndexBatchSize) {
+          vector_index->Delete(ids, false);
+          ids.clear();
+        }
+      }
+      if (!ids.empty()) {
+        vector_index->Delete(ids, false);
+      }
+      delete_ids.clear();
+    }
+
+    if (!upsert_vectors.empty()) {
+      std::vector<pb::common::VectorWithId> vectors;
+      vectors.reserve(std::min(upsert_vectors.size(), static_cast<size_t>(Constant::kBuildVectorIndexBatchSize)));
+      for (auto& [_, vector] : upsert_vectors) {
+        vectors.push_back(std::move(vector));
+        if (vectors.size() >= Constant::kBuildVectorIndexBatchSize) {
+          vector_index->Upsert(vectors, false);
+          vectors.clear();
+        }
+      }
+      if (!vectors.empty()) {
+        vector_index->Upsert(vectors, false);
+      }
+      upsert_vectors.clear();
+    }
+  };
 
   int64_t last_log_id = vector_index->ApplyLogId();
-  auto log_entrys = log_stroage->GetEntrys(start_log_id, end_log_id);
-  for (const auto& log_entry : log_entrys) {
-    auto raft_cmd = std::make_shared<pb::raft::RaftCmdRequest>();
-    butil::IOBufAsZeroCopyInputStream wrapper(log_entry->data);
-    CHECK(raft_cmd->ParseFromZeroCopyStream(&wrapper));
-    for (auto& request : *raft_cmd->mutable_requests()) {
-      switch (request.cmd_type()) {
-        case pb::raft::VECTOR_ADD: {
-          if (!ids.empty()) {
-            vector_index->Delete(ids, false);
-            ids.clear();
-          }
+  int64_t window_size = std::max(static_cast<int64_t>(1), FLAGS_vector_index_replay_wal_window_size);
+  int decode_parallel_num = std::max(1, FLAGS_vector_index_replay_wal_decode_parallel_num);
+  int64_t entry_count = 0;
+  // Stream the log by window, only one window entries is in memory.
+  for (int64_t window_start_log_id = start_log_id; window_start_log_id <= end_log_id;
+       window_start_log_id += window_size) {
+    int64_t window_end_log_id = std::min(window_start_log_id + window_size - 1, end_log_id);
+    auto log_entrys = log_stroage->GetEntrys(window_start_log_id, window_end_log_id);
+    if (log_entrys.empty()) {
+      continue;
+    }
+    entry_count += log_entrys.size();
+
+    // parallel decode raft cmd
+    std::vector<pb::raft::RaftCmdRequest> raft_cmds(log_entrys.size());
+    auto decode_func = [&](size_t start, size_t end) {
+      for (size_t i = start; i < end; ++i) {
+        butil::IOBufAsZeroCopyInputStream wrapper(log_entrys[i]->data);
+        CHECK(raft_cmds[i].ParseFromZeroCopyStream(&wrapper));
+      }
+    };
+    size_t slice_size = (log_entrys.size() + decode_parallel_num - 1) / decode_parallel_num;
+    if (decode_parallel_num <= 1 || log_entrys.size() <= slice_size) {
+      decode_func(0, log_entrys.size());
+    } else {
+      std::vector<Bthread> decoders;
+      for (size_t start = 0; start < log_entrys.size(); start += slice_size) {
+        size_t end = std::min(start + slice_size, log_entrys.size());
+        decoders.emplace_back([&decode_func, start, end]() { decode_func(start, end); });
+      }
+      for (auto& decoder : decoders) {
+        decoder.Join();
+      }
+    }
 
-          for (auto& vector : *request.mutable_vector_add()->mutable_vectors()) {
-            if (vector.id() >= min_vector_id && vector.id() < max_vector_id) {
-              vectors.push_back(vector);
+    // coalesce in log order
+    for (size_t i = 0; i < raft_cmds.size(); ++i) {
+      for (auto& request : *raft_cmds[i].mutable_requests()) {
+        switch (request.cmd_type()) {
+          case pb::raft::VECTOR_ADD: {
+            for (auto& vector : *request.mutable_vector_add()->mutable_vectors()) {
+              if (vector.id() >= min_vector_id && vector.id() < max_vector_id) {
+                delete_ids.erase(vector.id());
+                upsert_vectors[vector.id()] = std::move(vector);
+              }
             }
+            break;
           }
-
-          if (vectors.size() >= Constant::kBuildVectorIndexBatchSize) {
-            vector_index->Upsert(vectors, false);
-            vectors.clear();
-          }
-          break;
-        }
-        case pb::raft::VECTOR_DELETE: {
-          if (!vectors.empty()) {
-            vector_index->Upsert(vectors, false);
-            vectors.clear();
-          }
-
-          for (auto vector_id : request.vector_delete().ids()) {
-            if (vector_id >= min_vector_id && vector_id < max_vector_id) {
-              ids.push_back(vector_id);
+          case pb::raft::VECTOR_DELETE: {
+            for (auto vector_id : request.vector_delete().ids()) {
+              if (vector_id >= min_vector_id && vector_id < max_vector_id) {
+                upsert_vectors.erase(vector_id);
+                delete_ids.insert(vector_id);
+              }
             }
+            break;
           }
-          if (ids.size() >= Constant::kBuildVectorIndexBatchSize) {
-            vector_index->Delete(ids, false);
-            ids.clear();
-          }
-          break;
+          default:
+            break;
         }
-        default:
-          break;
       }
+
+      last_log_id = log_entrys[i]->index;
     }
 
-    last_log_id = log_entry->index;
-  }
-  if (!vectors.empty()) {
-    vector_index->Upsert(vectors, false);
-  } else if (!ids.empty()) {
-    vector_index->Delete(ids, false);
+    if (upsert_vectors.size() + delete_ids.size() >= Constant::kBuildVectorIndexBatchSize) {
+      apply_func();
+    }
   }
 
+  apply_func();
+
   if (last_log_id > vector_index->ApplyLogId()) {
     vector_index->SetApplyLogId(last_log_id);
   }
 
   DINGO_LOG(INFO) << fmt::format(
-      "[vector_index.replaywal][index_id({})] replay wal finish, log({}-{}) last_log_id({}) vector_id({}-{}) elapsed "
-      "time({}ms)",
-      vector_index->Id(), start_log_id, end_log_id, last_log_id, min_vector_id, max_vector_id,
+      "[vector_index.replaywal][index_id({})] replay wal finish, log({}-{}) last_log_id({}) entry_count({}) "
+      "vector_id({}-{}) elapsed time({}ms)",
+      vector_index->Id(), start_log_id, end_log_id, last_log_id, entry_count, min_vector_id, max_vector_id,
       Helper::TimestampMs() - start_time);
 
   return butil::Status();
 }
 
+VectorIndexPtr VectorIndexManager::DeriveVectorIndex(VectorIndexWrapperPtr vector_index_wrapper,
+                                                     const std::string& trace) {
+  assert(vector_index_wrapper != nullptr);
+  int64_t vector_index_id = vector_index_wrapper->Id();
+
+  auto region = Server::GetInstance().GetRegion(vector_index_id);
+  if (region == nullptr) {
+    return nullptr;
+  }
+
+  auto source_vector_index = vector_index_wrapper->ShareVectorIndex();
+  if (source_vector_index == nullptr) {
+    source_vector_index = vector_index_wrapper->GetOwnVectorIndex();
+  }
+  if (source_vector_index == nullptr || !source_vector_index->SupportDerive()) {
+    return nullptr;
+  }
+
+  // Only derive when the region range shrink, e.g. split. Other rebuild need rebuild from original data.
+  auto range = region->Range();
+  auto source_range = source_vector_index->Range();
+  if (!Helper::IsContainRange(source_range, range) ||
+      (source_range.start_key() == range.start_key() && source_range.end_key() == range.end_key())) {
+    return nullptr;
+  }
+
+  auto vector_index =
+      VectorIndexFactory::New(vector_index_id, vector_index_wrapper->IndexParameter(), region->Epoch(), range);
+  if (vector_index == nullptr) {
+    return nullptr;
+  }
+
+  // Get the applied log id before copy, the log applied after it will be caught up by replay wal.
+  auto raft_store_engine = Server::GetInstance().GetRaftStoreEngine();
+  auto raft_node = raft_store_engine != nullptr ? raft_store_engine->GetNode(vector_index_id) : nullptr;
+  if (raft_node == nullptr) {
+    return nullptr;
+  }
+  auto raft_status = raft_node->GetStatus();
+  if (raft_status->known_applied_index() > 0) {
+    vector_index->SetApplyLogId(raft_status->known_applied_index());
+  }
+
+  int64_t begin_vector_id = 0, end_vector_id = 0;
+  VectorCodec::DecodeRangeToVectorId(range, begin_vector_id, end_vector_id);
+
+  int64_t start_time = Helper::TimestampMs();
+  auto status = source_vector_index->DeriveTo(begin_vector_id, end_vector_id, vector_index.get());
+  if (!status.ok()) {
+    DINGO_LOG(WARNING) << fmt::format(
+        "[vector_index.derive][index_id({})][trace({})] derive from vector index({}) failed, build from original data, "
+        "error: {}",
+        vector_index_id, trace, source_vector_index->Id(), Helper::PrintStatus(status));
+    return nullptr;
+  }
+
+  int64_t count = 0;
+  vector_index->GetCount(count);
+  DINGO_LOG(INFO) << fmt::format(
+      "[vector_index.derive][index_id({})][trace({})] derive from vector index({}) finish, vector_id({}-{}) count({}) "
+      "elapsed time({}ms)",
+      vector_index_id, trace, source_vector_index->Id(), begin_vector_id, end_vector_id, count,
+      Helper::TimestampMs() - start_time);
+
+  return vector_index;
+}
+
 // Build vector index with original all data.
 VectorIndexPtr VectorIndexManager::BuildVectorIndex(VectorIndexWrapperPtr vector_index_wrapper,
                                                     const std::string& trace) {
@@ -1132,7 +1314,6 @@ VectorIndexPtr VectorIndexManager::BuildVectorIndex(VectorIndexWrapperPtr vector
       vector_index_id, trace, Helper::StringToHex(start_key), VectorCodec::DecodeVectorId(start_key),
       Helper::StringToHex(end_key), VectorCodec::DecodeVectorId(end_key), vector_index->WriteOpParallelNum());
 
-  int64_t start_time = Helper::TimestampMs();
   // load vector data to vector index
   IteratorOptions options;
   options.upper_bound = end_key;
@@ -1143,6 +1324,23 @@ VectorIndexPtr VectorIndexManager::BuildVectorIndex(VectorIndexWrapperPtr vector
     DINGO_LOG(FATAL) << fmt::format("[vector_index.build][index_id({})] NewIterator failed.", vector_index_id);
   }
 
+  auto status = BuildVectorIndexWithData(vector_index_wrapper, vector_index, iter, start_key, end_key, trace);
+  if (!status.ok()) {
+    return nullptr;
+  }
+
+  return vector_index;
+}
+
+butil::Status VectorIndexManager::BuildVectorIndexWithData(VectorIndexWrapperPtr vector_index_wrapper,
+                                                           VectorIndexPtr vector_index, std::shared_ptr<Iterator> iter,
+                                                           const std::string& start_key, const std::string& end_key,
+                                                           const std::string& trace) {
+  int64_t vector_index_id = vector_index->Id();
+  int64_t start_time = Helper::TimestampMs();
+  vector_index_wrapper->ResetBuildProgress();
+  ON_SCOPE_EXIT([&]() { vector_index_wrapper->FinishBuildProgress(); });
+
   // Note: This is iterated 2 times for the following reasons:
   // ivf_flat must train first before adding data
   // train requires full data. If you just traverse it once, it will consume a huge amount of memory.
@@ -1151,67 +1349,36 @@ VectorIndexPtr VectorIndexManager::BuildVectorIndex(VectorIndexWrapperPtr vector
   // build if need
   if (BAIDU_UNLIKELY(vector_index->NeedTrain())) {
     if (!vector_index->IsTrained()) {
-      auto status = TrainForBuild(vector_index, iter, start_key, end_key);
+      VectorIndexTrainSamplePtr train_sample;
+      auto status = TrainForBuild(vector_index, iter, start_key, end_key, train_sample);
       if (!status.ok()) {
         DINGO_LOG(ERROR) << fmt::format(
             "[vector_index.build][index_id({})][trace({})] TrainForBuild failed, error: {} {}", vector_index_id, trace,
             status.error_code(), status.error_cstr());
-        return {};
+        return status;
+      }
+      if (train_sample != nullptr) {
+        vector_index_wrapper->SetTrainSample(train_sample);
       }
     }
   }
 
   int64_t count = 0;
   int64_t upsert_use_time = 0;
-  std::vector<pb::common::VectorWithId> vectors;
-  vectors.reserve(Constant::kBuildVectorIndexBatchSize);
-  for (iter->Seek(start_key); iter->Valid(); iter->Next()) {
-    pb::common::VectorWithId vector;
-
-    std::string key(iter->Key());
-    vector.set_id(VectorCodec::DecodeVectorId(key));
-
-    std::string value(iter->Value());
-    if (!vector.mutable_vector()->ParseFromString(value)) {
-      DINGO_LOG(WARNING) << fmt::format(
-          "[vector_index.build][index_id({})][trace({})] vector with id ParseFromString failed.", vector_index_id,
-          trace);
-      continue;
-    }
-
-    if (vector.vector().float_values_size() <= 0) {
-      DINGO_LOG(WARNING) << fmt::format("[vector_index.build][index_id({})][trace({})] vector values_size error.",
-                                        vector_index_id, trace);
-      continue;
-    }
-
-    ++count;
-
-    vectors.push_back(vector);
-    if ((count + 1) % Constant::kBuildVectorIndexBatchSize == 0) {
-      int64_t upsert_start_time = Helper::TimestampMs();
-
-      vector_index->Add(vectors, false);
-
-      int32_t this_upsert_time = Helper::TimestampMs() - upsert_start_time;
-      upsert_use_time += this_upsert_time;
-
-      DINGO_LOG(INFO) << fmt::format(
-          "[vector_index.build][index_id({})][trace({})] Build vector index progress, speed({:.3}) count({}) elapsed "
-          "time({}/{}ms)",
-          vector_index_id, trace, static_cast<double>(this_upsert_time) / vectors.size(), count, upsert_use_time,
-          Helper::TimestampMs() - start_time);
-
-      vectors.clear();
-      // yield, for other bthread run.
-      bthread_yield();
-    }
+  auto status =
+      PipelineAddForBuild(vector_index_wrapper, vector_index, iter, start_key, trace, count, upsert_use_time);
+  if (!status.ok()) {
+    DINGO_LOG(ERROR) << fmt::format(
+        "[vector_index.build][index_id({})][trace({})] PipelineAddForBuild failed, error: {} {}", vector_index_id,
+        trace, status.error_code(), status.error_cstr());
+    return status;
   }
 
-  if (!vectors.empty()) {
-    int64_t upsert_start_time = Helper::TimestampMs();
-    vector_index->Add(vectors, false);
-    upsert_use_time += (Helper::TimestampMs() - upsert_start_time);
+  status = vector_index->Build();
+  if (!status.ok()) {
+    DINGO_LOG(ERROR) << fmt::format("[vector_index.build][index_id({})][trace({})] Build failed, error: {} {}",
+                                    vector_index_id, trace, status.error_code(), status.error_cstr());
+    return status;
   }
 
   DINGO_LOG(INFO) << fmt::format(
@@ -1222,7 +1389,7 @@ VectorIndexPtr VectorIndexManager::BuildVectorIndex(VectorIndexWrapperPtr vector
       Helper::RegionEpochToString(vector_index->Epoch()), VectorCodec::DecodeRangeToString(vector_index->Range()),
       upsert_use_time, Helper::TimestampMs() - start_time);
 
-  return vector_index;
+  return butil::Status::OK();
 }
 
 void VectorIndexManager::LaunchRebuildVectorIndex(VectorIndexWrapperPtr vector_index_wrapper, int64_t job_id,
@@ -1287,8 +1454,14 @@ butil::Status VectorIndexManager::RebuildVectorIndex(VectorIndexWrapperPtr vecto
                                  vector_index_id, vector_index_wrapper->Version(), trace);
 
   int64_t start_time = Helper::TimestampMs();
+  VectorIndexPtr vector_index = nullptr;
+  if (FLAGS_vector_index_enable_split_derive) {
+    vector_index = DeriveVectorIndex(vector_index_wrapper, trace);
+  }
   // Build vector index with original data.
-  auto vector_index = BuildVectorIndex(vector_index_wrapper, trace);
+  if (vector_index == nullptr) {
+    vector_index = BuildVectorIndex(vector_index_wrapper, trace);
+  }
   if (vector_index == nullptr) {
     DINGO_LOG(WARNING) << fmt::format("[vector_index.rebuild][index_id({})][trace({})] Build vector index failed.",
                                       vector_index_id, trace);
@@ -1501,6 +1674,25 @@ void VectorIndexManager::LaunchSaveVectorIndex(VectorIndexWrapperPtr vector_inde
   }
 }
 
+void VectorIndexManager::LaunchCompactVectorIndex(VectorIndexWrapperPtr vector_index_wrapper,
+                                                  const std::string& trace) {
+  assert(vector_index_wrapper != nullptr);
+
+  DINGO_LOG(INFO) << fmt::format(
+      "[vector_index.launch][index_id({})][trace({})] Launch compact vector index, pending tasks({}) total "
+      "running({}).",
+      vector_index_wrapper->Id(), trace, vector_index_wrapper->PendingTaskNum(), GetVectorIndexTaskRunningNum());
+
+  auto task = std::make_shared<CompactVectorIndexTask>(vector_index_wrapper, trace);
+  if (!Server::GetInstance().GetVectorIndexManager()->ExecuteTask(vector_index_wrapper->Id(), task)) {
+    DINGO_LOG(ERROR) << fmt::format(
+        "[vector_index.launch][index_id({})][trace({})] Launch compact vector index failed", vector_index_wrapper->Id(),
+        trace);
+  } else {
+    vector_index_wrapper->IncPendingTaskNum();
+  }
+}
+
 butil::Status VectorIndexManager::ScrubVectorIndex() {
   auto regions = Server::GetInstance().GetAllAliveRegion();
   if (regions.empty()) {
@@ -1545,36 +1737,328 @@ butil::Status VectorIndexManager::ScrubVectorIndex() {
                                      trace);
 
       LaunchSaveVectorIndex(vector_index_wrapper, fmt::format("scrub-{}", trace));
+      continue;
+    }
+
+    // Save also purge the deleted vectors, so only compact when not save.
+    if (vector_index_wrapper->PendingTaskNum() == 0 && vector_index_wrapper->NeedToCompact()) {
+      DINGO_LOG(INFO) << fmt::format("[vector_index.scrub][index_id({})] need compact.", vector_index_id);
+      LaunchCompactVectorIndex(vector_index_wrapper, "scrub");
     }
   }
 
+  // Evict cold vector index when exceed memory budget.
+  auto status = VectorIndexMemoryBudget::Evict(regions);
+  if (!status.ok()) {
+    DINGO_LOG(ERROR) << fmt::format("[vector_index.scrub][index_id()] evict vector index failed, error: {}",
+                                    Helper::PrintStatus(status));
+  }
+
   return butil::Status::OK();
 }
 
+// Bounded blocking queue between the build pipeline stages.
+template <typename T>
+class BuildPipelineQueue {
+ public:
+  explicit BuildPipelineQueue(size_t capacity) : capacity_(capacity) {
+    bthread_mutex_init(&mutex_, nullptr);
+    bthread_cond_init(&not_empty_cond_, nullptr);
+    bthread_cond_init(&not_full_cond_, nullptr);
+  }
+  ~BuildPipelineQueue() {
+    bthread_mutex_destroy(&mutex_);
+    bthread_cond_destroy(&not_empty_cond_);
+    bthread_cond_destroy(&not_full_cond_);
+  }
+
+  // Block when the queue is full, return false when the queue is closed.
+  bool Push(T&& item) {
+    BAIDU_SCOPED_LOCK(mutex_);
+    while (queue_.size() >= capacity_ && !closed_) {
+      bthread_cond_wait(&not_full_cond_, &mutex_);
+    }
+    if (closed_) {
+      return false;
+    }
+
+    queue_.push_back(std::move(item));
+    bthread_cond_signal(&not_empty_cond_);
+    return true;
+  }
+
+  // Block when the queue is empty, return false when the queue is closed and drained.
+  bool Pop(T& item) {
+    BAIDU_SCOPED_LOCK(mutex_);
+    while (queue_.empty() && !closed_) {
+      bthread_cond_wait(&not_empty_cond_, &mutex_);
+    }
+    if (queue_.empty()) {
+      return false;
+    }
+
+    item = std::move(queue_.front());
+    queue_.pop_front();
+    bthread_cond_signal(&not_full_cond_);
+    return true;
+  }
+
+  // Not block, return false when the queue is empty.
+  bool TryPop(T& item) {
+    BAIDU_SCOPED_LOCK(mutex_);
+    if (queue_.empty()) {
+      return false;
+    }
+
+    item = std::move(queue_.front());
+    queue_.pop_front();
+    bthread_cond_signal(&not_full_cond_);
+    return true;
+  }
+
+  // No more push, the left items still can be popped.
+  void Close() {
+    BAIDU_SCOPED_LOCK(mutex_);
+    closed_ = true;
+    bthread_cond_broadcast(&not_empty_cond_);
+    bthread_cond_broadcast(&not_full_cond_);
+  }
+
+  // Close and drop the left items, used when the pipeline fails.
+  void Abort() {
+    BAIDU_SCOPED_LOCK(mutex_);
+    closed_ = true;
+    queue_.clear();
+    bthread_cond_broadcast(&not_empty_cond_);
+    bthread_cond_broadcast(&not_full_cond_);
+  }
+
+ private:
+  size_t capacity_;
+  bool closed_{false};
+  std::deque<T> queue_;
+
+  bthread_mutex_t mutex_;
+  bthread_cond_t not_empty_cond_;
+  bthread_cond_t not_full_cond_;
+};
+
+// Scan producer -> decoders -> adder.
+// The producer cuts the region data into continuous key chunks, because the vector id of region may be very sparse,
+// split the region by vector id is unbalanced.
+// Add holds the write lock of vector index, so there is only one adder, it merges the decoded chunks into one Add
+// of up to WriteOpParallelNum chunks, and the index parallelizes the insert of the batch itself.
+butil::Status VectorIndexManager::PipelineAddForBuild(VectorIndexWrapperPtr vector_index_wrapper,
+                                                      std::shared_ptr<VectorIndex> vector_index,
+                                                      std::shared_ptr<Iterator> iter, const std::string& start_key,
+                                                      const std::string& trace, int64_t& count,
+                                                      int64_t& add_use_time) {
+  struct RawChunk {
+    std::vector<std::string> keys;
+    std::vector<std::string> values;
+  };
+  using VectorChunk = std::vector<pb::common::VectorWithId>;
+
+  int64_t vector_index_id = vector_index->Id();
+  int decode_parallel_num = std::max(1, FLAGS_vector_index_build_decode_parallel_num);
+  size_t add_batch_chunk_num = std::max(1U, vector_index->WriteOpParallelNum());
+  size_t chunk_size = std::max(1, FLAGS_vector_index_build_chunk_size);
+
+  BuildPipelineQueue<RawChunk> raw_queue(decode_parallel_num * 2);
+  size_t vector_queue_capacity = std::max(static_cast<size_t>(decode_parallel_num), add_batch_chunk_num) * 2;
+  BuildPipelineQueue<VectorChunk> vector_queue(vector_queue_capacity);
+
+  int64_t total_count = 0;
+  int64_t total_add_use_time = 0;
+  butil::Status add_status;
+
+  // decode vector data
+  std::vector<Bthread> decoders;
+  decoders.reserve(decode_parallel_num);
+  for (int i = 0; i < decode_parallel_num; ++i) {
+    decoders.emplace_back([&]() {
+      RawChunk raw_chunk;
+      while (raw_queue.Pop(raw_chunk)) {
+        VectorChunk vectors;
+        vectors.reserve(raw_chunk.keys.size());
+        for (size_t j = 0; j < raw_chunk.keys.size(); ++j) {
+          pb::common::VectorWithId vector;
+          vector.set_id(VectorCodec::DecodeVectorId(raw_chunk.keys[j]));
+          if (!vector.mutable_vector()->ParseFromString(raw_chunk.values[j])) {
+            DINGO_LOG(WARNING) << fmt::format(
+                "[vector_index.build][index_id({})][trace({})] vector with id ParseFromString failed.",
+                vector_index_id, trace);
+            continue;
+          }
+
+          if (vector.vector().float_values_size() <= 0 && vector.vector().binary_values_size() <= 0) {
+            DINGO_LOG(WARNING) << fmt::format("[vector_index.build][index_id({})][trace({})] vector values_size error.",
+                                              vector_index_id, trace);
+            continue;
+          }
+
+          vectors.push_back(std::move(vector));
+        }
+
+        if (!vectors.empty() && !vector_queue.Push(std::move(vectors))) {
+          break;
+        }
+      }
+    });
+  }
+
+  // add vector to vector index
+  Bthread adder([&]() {
+    VectorChunk vectors;
+    while (vector_queue.Pop(vectors)) {
+      // merge the already decoded chunks into one batch
+      VectorChunk more_vectors;
+      for (size_t i = 1; i < add_batch_chunk_num && vector_queue.TryPop(more_vectors); ++i) {
+        vectors.insert(vectors.end(), std::make_move_iterator(more_vectors.begin()),
+                       std::make_move_iterator(more_vectors.end()));
+      }
+
+      int64_t add_start_time = Helper::TimestampMs();
+      auto status = vector_index->Add(vectors, false);
+      if (!status.ok()) {
+        add_status = status;
+        raw_queue.Abort();
+        vector_queue.Abort();
+        break;
+      }
+      total_add_use_time += Helper::TimestampMs() - add_start_time;
+
+      int64_t prev_count = total_count;
+      total_count += vectors.size();
+      vector_index_wrapper->IncBuildProgress(vectors.size());
+      if (prev_count / Constant::kBuildVectorIndexBatchSize != total_count / Constant::kBuildVectorIndexBatchSize) {
+        DINGO_LOG(INFO) << fmt::format("[vector_index.build][index_id({})][trace({})] Build vector index {}",
+                                       vector_index_id, trace, vector_index_wrapper->BuildProgress());
+      }
+    }
+  });
+
+  // scan vector data
+  RawChunk raw_chunk;
+  raw_chunk.keys.reserve(chunk_size);
+  raw_chunk.values.reserve(chunk_size);
+  for (iter->Seek(start_key); iter->Valid(); iter->Next()) {
+    raw_chunk.keys.emplace_back(iter->Key());
+    raw_chunk.values.emplace_back(iter->Value());
+    if (raw_chunk.keys.size() >= chunk_size) {
+      if (!raw_queue.Push(std::move(raw_chunk))) {
+        break;
+      }
+      raw_chunk = RawChunk();
+      raw_chunk.keys.reserve(chunk_size);
+      raw_chunk.values.reserve(chunk_size);
+    }
+  }
+  if (!raw_chunk.keys.empty()) {
+    raw_queue.Push(std::move(raw_chunk));
+  }
+
+  raw_queue.Close();
+  for (auto& decoder : decoders) {
+    decoder.Join();
+  }
+  vector_queue.Close();
+  adder.Join();
+
+  count = total_count;
+  add_use_time = total_add_use_time;
+
+  return add_status;
+}
+
 butil::Status VectorIndexManager::TrainForBuild(std::shared_ptr<VectorIndex> vector_index,
                                                 std::shared_ptr<Iterator> iter, const std::string& start_key,
-                                                [[maybe_unused]] const std::string& end_key) {
+                                                [[maybe_unused]] const std::string& end_key,
+                                                VectorIndexTrainSamplePtr& train_sample) {
+  if (VectorIndexUtils::IsBinaryVectorIndexType(vector_index->VectorIndexType())) {
+    return TrainBinaryForBuild(vector_index, iter, start_key, end_key);
+  }
+
+  // Train on the whole region data when the sample is disabled, else the train data size is bounded by
+  // the sample capacity instead of the region size.
+  std::vector<float> all_train_vectors;
+  if (VectorIndexTrainSample::IsEnable()) {
+    train_sample = VectorIndexTrainSample::New(vector_index->VectorIndexParameter());
+    if (train_sample == nullptr) {
+      train_sample = VectorIndexTrainSample::New(VectorIndexTrainSample::GetCapacity(INT64_MAX),
+                                                 vector_index->GetDimension());
+    }
+  } else {
+    all_train_vectors.reserve(100000 * vector_index->GetDimension());  // todo opt
+  }
+
   int64_t count = 0;
-  std::vector<float> train_vectors;
-  train_vectors.reserve(100000 * vector_index->GetDimension());  // todo opt
   for (iter->Seek(start_key); iter->Valid(); iter->Next()) {
     pb::common::VectorWithId vector;
 
     std::string value(iter->Value());
     if (!vector.mutable_vector()->ParseFromString(value)) {
-      std::string s = fmt::format("[vector_index.build][index_id({})] vector with id ParseFromString failed.");
+      std::string s =
+          fmt::format("[vector_index.build][index_id({})] vector with id ParseFromString failed.", vector_index->Id());
       DINGO_LOG(WARNING) << s;
       continue;
     }
 
-    if (vector.vector().float_values_size() <= 0) {
+    if (vector.vector().float_values_size() != vector_index->GetDimension()) {
       std::string s = fmt::format("[vector_index.build][index_id({})] vector values_size error.", vector.id());
       DINGO_LOG(WARNING) << s;
       continue;
     }
 
-    train_vectors.insert(train_vectors.end(), vector.vector().float_values().begin(),
-                         vector.vector().float_values().end());
+    ++count;
+    if (train_sample != nullptr) {
+      train_sample->Add(VectorCodec::DecodeVectorId(std::string(iter->Key())), vector.vector().float_values().data());
+    } else {
+      all_train_vectors.insert(all_train_vectors.end(), vector.vector().float_values().begin(),
+                               vector.vector().float_values().end());
+    }
+  }
+
+  // if empty. ignore
+  auto train_vectors = train_sample != nullptr ? train_sample->GetTrainData() : std::move(all_train_vectors);
+  if (!train_vectors.empty()) {
+    auto status = vector_index->Train(train_vectors);
+    if (!status.ok()) {
+      std::string s = fmt::format("vector_index::Train failed train_vectors.size() : {}", train_vectors.size());
+      DINGO_LOG(ERROR) << s;
+      return status;
+    }
+  }
+
+  DINGO_LOG(INFO) << fmt::format("[vector_index.build][index_id({})] train vector count({}/{}).", vector_index->Id(),
+                                 train_vectors.size() / vector_index->GetDimension(), count);
+
+  return butil::Status::OK();
+}
+
+butil::Status VectorIndexManager::TrainBinaryForBuild(std::shared_ptr<VectorIndex> vector_index,
+                                                      std::shared_ptr<Iterator> iter, const std::string& start_key,
+                                                      [[maybe_unused]] const std::string& end_key) {
+  std::vector<pb::common::VectorWithId> train_vectors;
+  for (iter->Seek(start_key); iter->Valid(); iter->Next()) {
+    pb::common::VectorWithId vector;
+
+    std::string value(iter->Value());
+    if (!vector.mutable_vector()->ParseFromString(value)) {
+      std::string s = fmt::format("[vector_index.build][index_id({})] vector with id ParseFromString failed.",
+                                  vector_index->Id());
+      DINGO_LOG(WARNING) << s;
+      continue;
+    }
+
+    if (vector.vector().binary_values_size() <= 0) {
+      std::string s = fmt::format("[vector_index.build][index_id({})] vector binary values_size error.",
+                                  vector_index->Id());
+      DINGO_LOG(WARNING) << s;
+      continue;
+    }
+
+    train_vectors.push_back(std::move(vector));
   }
 
   // if empty. ignore
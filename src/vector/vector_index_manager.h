@@ -24,6 +24,7 @@
 #include "butil/status.h"
 #include "bvar/latency_recorder.h"
 #include "common/helper.h"
+#include "log/segment_log_storage.h"
 #include "meta/store_meta_manager.h"
 #include "proto/common.pb.h"
 #include "vector/vector_index.h"
@@ -74,6 +75,27 @@ class SaveVectorIndexTask : public TaskRunnable {
   int64_t start_time_;
 };
 
+// Compact vector index task, reclaim the deleted vectors space.
+class CompactVectorIndexTask : public TaskRunnable {
+ public:
+  CompactVectorIndexTask(VectorIndexWrapperPtr vector_index_wrapper, const std::string& trace)
+      : vector_index_wrapper_(vector_index_wrapper), trace_(trace) {
+    start_time_ = Helper::TimestampMs();
+  }
+  ~CompactVectorIndexTask() override = default;
+
+  std::string Type() override { return "COMPACT_VECTOR_INDEX"; }
+
+  void Run() override;
+
+  std::string Trace() override;
+
+ private:
+  VectorIndexWrapperPtr vector_index_wrapper_;
+  std::string trace_;
+  int64_t start_time_;
+};
+
 // Load or build vector index task
 class LoadOrBuildVectorIndexTask : public TaskRunnable {
  public:
@@ -193,6 +215,9 @@ class VectorIndexManager {
   // Launch save vector index at execute queue.
   static void LaunchSaveVectorIndex(VectorIndexWrapperPtr vector_index_wrapper, const std::string& trace);
 
+  // Launch compact vector index task.
+  static void LaunchCompactVectorIndex(VectorIndexWrapperPtr vector_index_wrapper, const std::string& trace);
+
   // Invoke when server running.
   static butil::Status RebuildVectorIndex(VectorIndexWrapperPtr vector_index_wrapper, const std::string& trace);
   // Launch rebuild vector index at execute queue.
@@ -273,6 +298,12 @@ class VectorIndexManager {
 
   std::vector<std::vector<std::string>> GetPendingTaskTrace();
 
+  // Train/add the data of iter to vector index and build it, the apply log id of vector index is not changed.
+  static butil::Status BuildVectorIndexWithData(VectorIndexWrapperPtr vector_index_wrapper,
+                                                std::shared_ptr<VectorIndex> vector_index,
+                                                std::shared_ptr<Iterator> iter, const std::string& start_key,
+                                                const std::string& end_key, const std::string& trace);
+
  private:
   static butil::Status LoadVectorIndex(VectorIndexWrapperPtr vector_index_wrapper, const pb::common::RegionEpoch& epoch,
                                        const std::string& trace);
@@ -280,15 +311,35 @@ class VectorIndexManager {
   // Invoke when server starting.
   static std::shared_ptr<VectorIndex> BuildVectorIndex(VectorIndexWrapperPtr vector_index_wrapper,
                                                        const std::string& trace);
+  // Derive vector index from the in-memory vector index which range contains the region range, e.g. after split
+  // the child derive from the shared parent vector index, the parent derive from its own vector index.
+  // Return nullptr when can't derive, then build with original data.
+  static std::shared_ptr<VectorIndex> DeriveVectorIndex(VectorIndexWrapperPtr vector_index_wrapper,
+                                                        const std::string& trace);
   // Catch up vector index.
   static butil::Status CatchUpLogToVectorIndex(VectorIndexWrapperPtr vector_index_wrapper,
                                                std::shared_ptr<VectorIndex> vector_index, const std::string& trace);
   // Replay log to vector index.
   static butil::Status ReplayWalToVectorIndex(std::shared_ptr<VectorIndex> vector_index, int64_t start_log_id,
                                               int64_t end_log_id);
+  // Replay log [start_log_id, end_log_id] of the log storage to vector index.
+  static butil::Status ReplayWalToVectorIndex(std::shared_ptr<SegmentLogStorage> log_storage,
+                                              std::shared_ptr<VectorIndex> vector_index, int64_t start_log_id,
+                                              int64_t end_log_id);
+
+  // Scan/decode/add vector data to vector index with a multi-thread pipeline.
+  static butil::Status PipelineAddForBuild(VectorIndexWrapperPtr vector_index_wrapper,
+                                           std::shared_ptr<VectorIndex> vector_index, std::shared_ptr<Iterator> iter,
+                                           const std::string& start_key, const std::string& trace, int64_t& count,
+                                           int64_t& add_use_time);
 
+  // Train on a reservoir sample of the region data, output the sample to keep update by vector add.
   static butil::Status TrainForBuild(std::shared_ptr<VectorIndex> vector_index, std::shared_ptr<Iterator> iter,
-                                     const std::string& start_key, [[maybe_unused]] const std::string& end_key);
+                                     const std::string& start_key, [[maybe_unused]] const std::string& end_key,
+                                     VectorIndexTrainSamplePtr& train_sample);
+  // binary vector index can not train from float, train it with the whole binary vectors.
+  static butil::Status TrainBinaryForBuild(std::shared_ptr<VectorIndex> vector_index, std::shared_ptr<Iterator> iter,
+                                           const std::string& start_key, [[maybe_unused]] const std::string& end_key);
 
   // Execute all vector index load/build/rebuild/save task.
   WorkerSetPtr background_workers_;
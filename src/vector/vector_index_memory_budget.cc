@@ -0,0 +1,241 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "vector/vector_index_memory_budget.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "butil/status.h"
+#include "bvar/reducer.h"
+#include "bvar/status.h"
+#include "common/helper.h"
+#include "common/logging.h"
+#include "fmt/core.h"
+#include "gflags/gflags.h"
+#include "proto/common.pb.h"
+#include "server/server.h"
+#include "vector/vector_index_manager.h"
+
+namespace dingodb {
+
+DEFINE_int64(vector_index_memory_budget, 0, "resident vector index memory budget of the store, 0 means unlimited");
+DEFINE_string(vector_index_memory_budget_evict_policy, "lru", "vector index evict policy, lru or lfu");
+DEFINE_int64(vector_index_memory_budget_min_idle_s, 300, "only evict the vector index not accessed for a while");
+DEFINE_int64(vector_index_memory_budget_max_log_gap, 10000,
+             "only evict the vector index whose snapshot behind apply log less than the gap, else save first");
+DEFINE_int64(vector_index_memory_budget_reload_wait_ms, 3000,
+             "wait evicted vector index reload time on access, 0 means reject immediately");
+
+bvar::Adder<int64_t> g_vector_index_memory_budget_hit_count("dingo_vector_index_memory_budget_hit_count");
+bvar::Adder<int64_t> g_vector_index_memory_budget_miss_count("dingo_vector_index_memory_budget_miss_count");
+bvar::Adder<int64_t> g_vector_index_memory_budget_evict_count("dingo_vector_index_memory_budget_evict_count");
+bvar::Adder<int64_t> g_vector_index_memory_budget_evict_bytes("dingo_vector_index_memory_budget_evict_bytes");
+bvar::Status<int64_t> g_vector_index_memory_budget_resident_bytes("dingo_vector_index_memory_budget_resident_bytes",
+                                                                  0);
+
+bool VectorIndexMemoryBudget::IsEnable() { return FLAGS_vector_index_memory_budget > 0; }
+
+VectorIndexMemoryBudget::EvictPolicy VectorIndexMemoryBudget::GetEvictPolicy() {
+  return FLAGS_vector_index_memory_budget_evict_policy == "lfu" ? EvictPolicy::kLFU : EvictPolicy::kLRU;
+}
+
+void VectorIndexMemoryBudget::Access(VectorIndexWrapperPtr vector_index_wrapper) {
+  if (vector_index_wrapper == nullptr) {
+    return;
+  }
+
+  vector_index_wrapper->Touch();
+  if (vector_index_wrapper->IsReady()) {
+    g_vector_index_memory_budget_hit_count << 1;
+    return;
+  }
+  if (!vector_index_wrapper->IsEvicted()) {
+    return;
+  }
+
+  g_vector_index_memory_budget_miss_count << 1;
+  VectorIndexManager::LaunchLoadAsyncBuildVectorIndex(vector_index_wrapper, false, true, 0, "reload evicted");
+
+  // The reload signal the waiter when the vector index is switched in, a failed reload run out the wait time.
+  int64_t start_time_ms = Helper::TimestampMs();
+  vector_index_wrapper->WaitReload(FLAGS_vector_index_memory_budget_reload_wait_ms);
+
+  DINGO_LOG(INFO) << fmt::format(
+      "[vector_index.budget][index_id({})] reload evicted vector index, ready({}) wait({}ms)",
+      vector_index_wrapper->Id(), vector_index_wrapper->IsReady(), Helper::TimestampMs() - start_time_ms);
+}
+
+bool VectorIndexMemoryBudget::CanEvict(VectorIndexWrapperPtr vector_index_wrapper, bool is_leader,
+                                       std::string& reason) {
+  if (vector_index_wrapper->IsStop() || !vector_index_wrapper->IsReady()) {
+    reason = "not ready";
+    return false;
+  }
+  if (!is_leader) {
+    reason = "not leader";
+    return false;
+  }
+  if (vector_index_wrapper->PendingTaskNum() > 0 || vector_index_wrapper->IsSwitchingVectorIndex()) {
+    reason = "exist pending task";
+    return false;
+  }
+  // Share/sibling vector index only exist during split/merge, can't reload from own snapshot.
+  if (vector_index_wrapper->ShareVectorIndex() != nullptr || vector_index_wrapper->SiblingVectorIndex() != nullptr) {
+    reason = "exist share or sibling vector index";
+    return false;
+  }
+  if (!vector_index_wrapper->SupportSave()) {
+    reason = "not support save";
+    return false;
+  }
+  if (Helper::TimestampMs() - vector_index_wrapper->LastAccessTimeMs() <
+      FLAGS_vector_index_memory_budget_min_idle_s * 1000) {
+    reason = "recently accessed";
+    return false;
+  }
+
+  auto snapshot_set = vector_index_wrapper->SnapshotSet();
+  if (snapshot_set == nullptr || snapshot_set->GetLastSnapshot() == nullptr) {
+    reason = "no snapshot";
+    return false;
+  }
+
+  // Too many log need to catch up on reload, save a new snapshot first.
+  int64_t log_gap = vector_index_wrapper->ApplyLogId() - vector_index_wrapper->SnapshotLogId();
+  if (log_gap > FLAGS_vector_index_memory_budget_max_log_gap) {
+    if (vector_index_wrapper->SavingNum() == 0 && vector_index_wrapper->RebuildingNum() == 0) {
+      VectorIndexManager::LaunchSaveVectorIndex(vector_index_wrapper, "memory budget evict");
+    }
+    reason = fmt::format("snapshot log gap({}) too large", log_gap);
+    return false;
+  }
+
+  return true;
+}
+
+std::vector<int64_t> VectorIndexMemoryBudget::SelectEvictCandidates(std::vector<Candidate> candidates,
+                                                                    int64_t total_memory_size, int64_t budget,
+                                                                    EvictPolicy policy) {
+  std::vector<int64_t> evict_ids;
+  if (total_memory_size <= budget) {
+    return evict_ids;
+  }
+
+  if (policy == EvictPolicy::kLFU) {
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate& lhs, const Candidate& rhs) {
+      return lhs.access_count != rhs.access_count ? lhs.access_count < rhs.access_count
+                                                  : lhs.last_access_time_ms < rhs.last_access_time_ms;
+    });
+  } else {
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate& lhs, const Candidate& rhs) {
+      return lhs.last_access_time_ms < rhs.last_access_time_ms;
+    });
+  }
+
+  for (const auto& candidate : candidates) {
+    if (total_memory_size <= budget) {
+      break;
+    }
+    evict_ids.push_back(candidate.id);
+    total_memory_size -= candidate.memory_size;
+  }
+
+  return evict_ids;
+}
+
+butil::Status VectorIndexMemoryBudget::Evict(const std::vector<store::RegionPtr>& regions) {
+  int64_t total_memory_size = 0;
+  std::vector<std::pair<store::RegionPtr, int64_t>> resident_regions;
+  for (const auto& region : regions) {
+    auto vector_index_wrapper = region->VectorIndexWrapper();
+    if (vector_index_wrapper == nullptr) {
+      continue;
+    }
+    // The evicted vector index don't apply log, the wal is kept since its snapshot.
+    // Reload it when the log is too long, the save after reload advance the wal truncate point.
+    if (vector_index_wrapper->IsEvicted()) {
+      auto raft_meta = Server::GetInstance().GetRaftMeta(region->Id());
+      int64_t log_gap = raft_meta != nullptr ? raft_meta->AppliedId() - vector_index_wrapper->SnapshotLogId() : 0;
+      if (log_gap > FLAGS_vector_index_memory_budget_max_log_gap) {
+        DINGO_LOG(INFO) << fmt::format("[vector_index.budget][index_id({})] reload evicted vector index, log gap({})",
+                                       vector_index_wrapper->Id(), log_gap);
+        VectorIndexManager::LaunchLoadAsyncBuildVectorIndex(vector_index_wrapper, false, true, 0,
+                                                            "reload evicted for log gap");
+      }
+      continue;
+    }
+    if (!vector_index_wrapper->IsReady()) {
+      continue;
+    }
+
+    int64_t memory_size = 0;
+    auto status = vector_index_wrapper->GetMemorySize(memory_size);
+    if (status.ok()) {
+      total_memory_size += memory_size;
+      resident_regions.emplace_back(region, memory_size);
+    }
+    vector_index_wrapper->DecayAccessCount();
+  }
+
+  g_vector_index_memory_budget_resident_bytes.set_value(total_memory_size);
+  if (!IsEnable() || total_memory_size <= FLAGS_vector_index_memory_budget) {
+    return butil::Status::OK();
+  }
+
+  std::vector<Candidate> candidates;
+  std::map<int64_t, VectorIndexWrapperPtr> vector_index_wrappers;
+  for (const auto& [region, memory_size] : resident_regions) {
+    auto vector_index_wrapper = region->VectorIndexWrapper();
+    std::string reason;
+    if (region->State() != pb::common::NORMAL ||
+        !CanEvict(vector_index_wrapper, Server::GetInstance().IsLeader(region->Id()), reason)) {
+      DINGO_LOG(DEBUG) << fmt::format("[vector_index.budget][index_id({})] can't evict, reason: {}",
+                                      vector_index_wrapper->Id(), reason);
+      continue;
+    }
+
+    candidates.push_back({vector_index_wrapper->Id(), memory_size, vector_index_wrapper->LastAccessTimeMs(),
+                          vector_index_wrapper->AccessCount()});
+    vector_index_wrappers[vector_index_wrapper->Id()] = vector_index_wrapper;
+  }
+
+  auto evict_ids =
+      SelectEvictCandidates(candidates, total_memory_size, FLAGS_vector_index_memory_budget, GetEvictPolicy());
+  for (const auto& candidate : candidates) {
+    if (std::find(evict_ids.begin(), evict_ids.end(), candidate.id) == evict_ids.end()) {
+      continue;
+    }
+
+    vector_index_wrappers[candidate.id]->EvictVectorIndex(
+        fmt::format("memory budget, resident({}) budget({})", total_memory_size, FLAGS_vector_index_memory_budget));
+    total_memory_size -= candidate.memory_size;
+
+    g_vector_index_memory_budget_evict_count << 1;
+    g_vector_index_memory_budget_evict_bytes << candidate.memory_size;
+  }
+
+  g_vector_index_memory_budget_resident_bytes.set_value(total_memory_size);
+  DINGO_LOG(INFO) << fmt::format(
+      "[vector_index.budget] evict vector index count({}/{}) resident({}) budget({})", evict_ids.size(),
+      resident_regions.size(), total_memory_size, FLAGS_vector_index_memory_budget);
+
+  return butil::Status::OK();
+}
+
+}  // namespace dingodb
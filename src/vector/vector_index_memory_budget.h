@@ -0,0 +1,68 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGODB_VECTOR_INDEX_MEMORY_BUDGET_H_  // NOLINT
+#define DINGODB_VECTOR_INDEX_MEMORY_BUDGET_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "butil/status.h"
+#include "meta/store_meta_manager.h"
+#include "vector/vector_index.h"
+
+namespace dingodb {
+
+// Keep the resident vector index memory of the store under a budget.
+// Cold vector indexes of the leader are evicted to their latest snapshot by scrub, the write path keeps
+// going on the raft log, and the next access reloads the index from the snapshot and catches up the log.
+// An evicted index whose log grows too long is reloaded by scrub, so the following save can truncate the log.
+class VectorIndexMemoryBudget {
+ public:
+  enum class EvictPolicy {
+    kLRU = 0,
+    kLFU = 1,
+  };
+
+  struct Candidate {
+    int64_t id{0};
+    int64_t memory_size{0};
+    int64_t last_access_time_ms{0};
+    int64_t access_count{0};
+  };
+
+  static bool IsEnable();
+
+  static EvictPolicy GetEvictPolicy();
+
+  // Record a request access the vector index, reload it when evicted.
+  // Wait the reload signal for a while, the caller still need check the vector index is ready.
+  static void Access(VectorIndexWrapperPtr vector_index_wrapper);
+
+  // Evict cold vector indexes when the resident memory exceed the budget, called by scrub.
+  static butil::Status Evict(const std::vector<store::RegionPtr>& regions);
+
+  // Pick the vector indexes to evict until total_memory_size is under budget, the coldest first.
+  static std::vector<int64_t> SelectEvictCandidates(std::vector<Candidate> candidates, int64_t total_memory_size,
+                                                    int64_t budget, EvictPolicy policy);
+
+  // Whether the vector index can be dropped and reload from snapshot later.
+  // Only the leader is evicted, the follower don't serve request so nothing would reload it.
+  static bool CanEvict(VectorIndexWrapperPtr vector_index_wrapper, bool is_leader, std::string& reason);
+};
+
+}  // namespace dingodb
+
+#endif  // DINGODB_VECTOR_INDEX_MEMORY_BUDGET_H_  // NOLINT
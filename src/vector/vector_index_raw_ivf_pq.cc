@@ -29,6 +29,7 @@
 #include "butil/compiler_specific.h"
 #include "butil/status.h"
 #include "common/constant.h"
+#include "common/helper.h"
 #include "common/logging.h"
 #include "faiss/Index.h"
 #include "faiss/IndexFlat.h"
@@ -40,6 +41,7 @@
 #include "proto/debug.pb.h"
 #include "proto/error.pb.h"
 #include "proto/index.pb.h"
+#include "vector/vector_index_train_sample.h"
 #include "vector/vector_index_utils.h"
 
 namespace dingodb {
@@ -119,13 +121,28 @@ butil::Status VectorIndexRawIvfPq::AddOrUpsert(const std::vector<pb::common::Vec
     return butil::Status(pb::error::Errno::EVECTOR_NOT_TRAIN, s);
   }
 
+  // The deleted vector still in the inverted lists, remove it physically before add again.
+  std::vector<faiss::idx_t> revive_ids;
+  for (size_t i = 0; i < vector_with_ids.size() && !tombstones_.empty(); ++i) {
+    if (tombstones_.erase(ids2[i]) > 0) {
+      revive_ids.push_back(ids2[i]);
+    }
+  }
+
+  VectorIndexUtils::MaterializeInvertedLists(index_.get());
   std::thread([&]() {
     if (is_upsert) {
       faiss::IDSelectorArray sel(vector_with_ids.size(), ids2.get());
       index_->remove_ids(sel);
+    } else if (!revive_ids.empty()) {
+      faiss::IDSelectorArray sel(revive_ids.size(), revive_ids.data());
+      index_->remove_ids(sel);
     }
     index_->add_with_ids(vector_with_ids.size(), vectors2.get(), ids2.get());
   }).join();
+  for (size_t i = 0; i < vector_with_ids.size(); ++i) {
+    vector_ids_.insert(ids2[i]);
+  }
 
   return butil::Status::OK();
 }
@@ -164,29 +181,19 @@ butil::Status VectorIndexRawIvfPq::Delete(const std::vector<int64_t>& delete_ids
     return butil::Status::OK();
   }
 
-  const auto& [ids, status] = VectorIndexUtils::CopyVectorId(delete_ids);
-  if (!status.ok()) {
-    DINGO_LOG(ERROR) << status.error_cstr();
-    return status;
+  // Only mark the tombstone, remove_ids move the codes of all the inverted lists, it is done by Compact in background.
+  BAIDU_SCOPED_LOCK(mutex_);
+  if (BAIDU_UNLIKELY(!DoIsTrained())) {
+    std::string s = fmt::format("ivf pq not train. train first. ignored");
+    DINGO_LOG(WARNING) << s;
+    return butil::Status::OK();
   }
 
-  faiss::IDSelectorArray sel(delete_ids.size(), ids.get());
-
-  size_t remove_count = 0;
-  {
-    BAIDU_SCOPED_LOCK(mutex_);
-    if (BAIDU_UNLIKELY(!DoIsTrained())) {
-      std::string s = fmt::format("ivf pq not train. train first. ignored");
-      DINGO_LOG(WARNING) << s;
-      return butil::Status::OK();
+  // Only tombstone the vector in the inverted lists, else it is never purged and inflates the deleted count.
+  for (auto delete_id : delete_ids) {
+    if (vector_ids_.count(delete_id) > 0) {
+      tombstones_.insert(delete_id);
     }
-
-    std::thread([&]() { remove_count = index_->remove_ids(sel); }).join();
-  }
-
-  if (0 == remove_count) {
-    DINGO_LOG(ERROR) << fmt::format("not found id : {}", id);
-    return butil::Status(pb::error::Errno::EVECTOR_INVALID, fmt::format("not found : {}", id));
   }
 
   return butil::Status::OK();
@@ -252,8 +259,8 @@ butil::Status VectorIndexRawIvfPq::Search(std::vector<pb::common::VectorWithId>
 
     // use std::thread to call faiss functions
     std::thread t([&]() {
-      if (!filters.empty()) {
-        auto ivf_pq_filter = filters.empty() ? nullptr : std::make_shared<RawIvfPqIDSelector>(filters);
+      if (!filters.empty() || !tombstones_.empty()) {
+        auto ivf_pq_filter = std::make_shared<RawIvfPqIDSelector>(filters, &tombstones_);
         ivf_search_parameters.sel = ivf_pq_filter.get();
         index_->search(vector_with_ids.size(), vectors2.get(), topk, distances.data(), labels.data(),
                        &ivf_search_parameters);
@@ -336,8 +343,8 @@ butil::Status VectorIndexRawIvfPq::RangeSearch(std::vector<pb::common::VectorWit
     std::thread t(
         [&](std::promise<butil::Status>& promise_status) {
           try {
-            if (!filters.empty()) {
-              auto ivf_pq_filter = filters.empty() ? nullptr : std::make_shared<RawIvfPqIDSelector>(filters);
+            if (!filters.empty() || !tombstones_.empty()) {
+              auto ivf_pq_filter = std::make_shared<RawIvfPqIDSelector>(filters, &tombstones_);
               ivf_search_parameters.sel = ivf_pq_filter.get();
 
               index_->range_search(vector_with_ids.size(), vectors2.get(), radius, range_search_result.get(),
@@ -396,6 +403,9 @@ butil::Status VectorIndexRawIvfPq::Save(const std::string& path) {
   std::thread t(
       [&](std::promise<butil::Status>& promise_status) {
         try {
+          // snapshot must be self-contained, not refer to the mmap file and the tombstones.
+          VectorIndexUtils::MaterializeInvertedLists(index_.get());
+          VectorIndexUtils::PurgeTombstones(index_.get(), tombstones_, vector_ids_);
           faiss::write_index(index_.get(), path.c_str());
           promise_status.set_value(butil::Status());
         } catch (std::exception& e) {
@@ -434,7 +444,7 @@ butil::Status VectorIndexRawIvfPq::Load(const std::string& path) {
       [&](std::promise<std::pair<faiss::Index*, butil::Status>>& promise_status) {
         faiss::Index* internal_raw_index = nullptr;
         try {
-          internal_raw_index = faiss::read_index(path.c_str(), 0);
+          internal_raw_index = faiss::read_index(path.c_str(), VectorIndexUtils::FaissReadIndexIoFlags());
           promise_status.set_value(std::pair<faiss::Index*, butil::Status>(internal_raw_index, butil::Status()));
         } catch (std::exception& e) {
           std::string s =
@@ -549,8 +559,11 @@ butil::Status VectorIndexRawIvfPq::Load(const std::string& path) {
 
   quantizer_.reset();
   index_ = std::move(internal_index_ivf_pq);
+  tombstones_.clear();
+  vector_ids_ = VectorIndexUtils::GetIvfIds(index_.get());
 
   train_data_size_ = index_->ntotal;
+  train_time_ms_ = Helper::TimestampMs();
 
   if (pb::common::MetricType::METRIC_TYPE_COSINE == metric_type_) {
     normalize_ = true;
@@ -576,7 +589,8 @@ butil::Status VectorIndexRawIvfPq::GetCount(int64_t& count) {
 }
 
 butil::Status VectorIndexRawIvfPq::GetDeletedCount(int64_t& deleted_count) {
-  deleted_count = 0;
+  BAIDU_SCOPED_LOCK(mutex_);
+  deleted_count = tombstones_.size();
   return butil::Status::OK();
 }
 
@@ -699,6 +713,7 @@ butil::Status VectorIndexRawIvfPq::Train(const std::vector<float>& train_datas)
   }
 
   train_data_size_ = data_size;
+  train_time_ms_ = Helper::TimestampMs();
 
   return butil::Status::OK();
 }
@@ -728,7 +743,34 @@ bool VectorIndexRawIvfPq::NeedToRebuild() {
     return false;
   }
 
-  return (index_->ntotal / 2) >= train_data_size_;
+  // The train data is capped by the train sample, retrain with more data not help.
+  if ((index_->ntotal / 2) >= train_data_size_ &&
+      train_data_size_ < VectorIndexTrainSample::GetCapacity(vector_index_parameter)) {
+    return true;
+  }
+
+  return false;
+}
+
+bool VectorIndexRawIvfPq::NeedToRetrain(int64_t train_sample_count) {
+  BAIDU_SCOPED_LOCK(mutex_);
+
+  if (BAIDU_UNLIKELY(!DoIsTrained())) {
+    return false;
+  }
+
+  return VectorIndexUtils::NeedRetrainOnSample(train_data_size_, train_sample_count, nlist_,
+                                               VectorIndexTrainSample::GetCapacity(vector_index_parameter));
+}
+
+bool VectorIndexRawIvfPq::NeedToRetrainOnImbalance(int32_t retrain_num) {
+  BAIDU_SCOPED_LOCK(mutex_);
+
+  if (BAIDU_UNLIKELY(!DoIsTrained())) {
+    return false;
+  }
+
+  return VectorIndexUtils::NeedRetrainOnImbalance(index_.get(), train_time_ms_, retrain_num);
 }
 
 bool VectorIndexRawIvfPq::IsTrained() {
@@ -759,6 +801,76 @@ bool VectorIndexRawIvfPq::NeedToSave(int64_t last_save_log_behind) {
   return false;
 }
 
+bool VectorIndexRawIvfPq::NeedToCompact() {
+  BAIDU_SCOPED_LOCK(mutex_);
+  if (BAIDU_UNLIKELY(!DoIsTrained())) {
+    return false;
+  }
+
+  return VectorIndexUtils::NeedPurgeTombstones(tombstones_.size(), index_->ntotal);
+}
+
+butil::Status VectorIndexRawIvfPq::Compact() {
+  BAIDU_SCOPED_LOCK(mutex_);
+  if (BAIDU_UNLIKELY(!DoIsTrained())) {
+    return butil::Status::OK();
+  }
+
+  size_t tombstone_count = tombstones_.size();
+  size_t remove_count = 0;
+  std::thread([&]() {
+    remove_count = VectorIndexUtils::PurgeTombstones(index_.get(), tombstones_, vector_ids_);
+  }).join();
+
+  DINGO_LOG(INFO) << fmt::format("[vector_index.raw_ivf_pq][id({})] compact, tombstone count({}) remove count({})",
+                                 Id(), tombstone_count, remove_count);
+
+  return butil::Status::OK();
+}
+
+butil::Status VectorIndexRawIvfPq::DeriveTo(int64_t begin_vector_id, int64_t end_vector_id, VectorIndex* target) {
+  auto* target_raw_ivf_pq = dynamic_cast<VectorIndexRawIvfPq*>(target);
+  if (target_raw_ivf_pq == nullptr || target_raw_ivf_pq == this || target_raw_ivf_pq->dimension_ != dimension_ ||
+      target_raw_ivf_pq->metric_type_ != metric_type_) {
+    return butil::Status(pb::error::Errno::EILLEGAL_PARAMTETERS, "derive target is not the same ivf pq index");
+  }
+
+  BAIDU_SCOPED_LOCK(mutex_);
+  if (BAIDU_UNLIKELY(!DoIsTrained())) {
+    return butil::Status(pb::error::Errno::EVECTOR_NOT_TRAIN, "ivf pq not train, can't derive");
+  }
+
+  BAIDU_SCOPED_LOCK(target_raw_ivf_pq->mutex_);
+  target_raw_ivf_pq->nlist_ = index_->nlist;
+  target_raw_ivf_pq->nsubvector_ = index_->pq.M;
+  target_raw_ivf_pq->nbits_per_idx_ = index_->pq.nbits;
+  target_raw_ivf_pq->Init();
+
+  butil::Status status;
+  std::thread([&]() {
+    try {
+      // Same codebook, so the pq codes can be copied directly.
+      target_raw_ivf_pq->index_->pq = index_->pq;
+      status = VectorIndexUtils::DeriveIvfIndex(index_.get(), begin_vector_id, end_vector_id, tombstones_,
+                                                target_raw_ivf_pq->index_.get());
+      if (status.ok()) {
+        target_raw_ivf_pq->index_->precompute_table();
+      }
+    } catch (std::exception& e) {
+      status = butil::Status(pb::error::Errno::EINTERNAL, fmt::format("derive ivf pq failed, error: {}", e.what()));
+    }
+  }).join();
+  if (!status.ok()) {
+    target_raw_ivf_pq->Reset();
+    return status;
+  }
+  target_raw_ivf_pq->train_data_size_ = train_data_size_;
+  target_raw_ivf_pq->train_time_ms_ = train_time_ms_;
+  target_raw_ivf_pq->vector_ids_ = VectorIndexUtils::GetIvfIds(target_raw_ivf_pq->index_.get());
+
+  return butil::Status::OK();
+}
+
 void VectorIndexRawIvfPq::Init() {
   if (pb::common::MetricType::METRIC_TYPE_L2 == metric_type_) {
     quantizer_ = std::make_unique<faiss::IndexFlatL2>(dimension_);
@@ -790,7 +902,10 @@ bool VectorIndexRawIvfPq::DoIsTrained() {
 }
 
 void VectorIndexRawIvfPq::Reset() {
+  tombstones_.clear();
+  vector_ids_.clear();
   quantizer_->reset();
+  VectorIndexUtils::MaterializeInvertedLists(index_.get());
   index_->reset();
 }
 
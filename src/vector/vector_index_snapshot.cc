@@ -16,6 +16,7 @@
 
 #include <sys/wait.h>  // Add this include
 
+#include <algorithm>
 #include <cstdint>
 #include <cstdlib>
 #include <filesystem>
@@ -79,6 +80,7 @@ bool SnapshotMeta::Init() {
 
   epoch_ = meta.epoch();
   range_ = meta.range();
+  base_snapshot_log_id_ = meta.base_snapshot_log_id() > 0 ? meta.base_snapshot_log_id() : snapshot_log_id_;
 
   DINGO_LOG(INFO) << fmt::format(
       "[vector_index.snapshot][index_id({})] Load snapshot meta, epoch: {} snapshot_index_id: {}, path: {}",
@@ -90,7 +92,18 @@ bool SnapshotMeta::Init() {
 std::string SnapshotMeta::MetaPath() { return fmt::format("{}/meta", path_); }
 
 std::string SnapshotMeta::IndexDataPath() {
-  return fmt::format("{}/index_{}_{}.idx", path_, vector_index_id_, snapshot_log_id_);
+  return fmt::format("{}/index_{}_{}.idx", path_, vector_index_id_, base_snapshot_log_id_);
+}
+
+std::vector<std::string> SnapshotMeta::DeltaPaths() {
+  std::vector<std::string> delta_paths;
+  for (const auto& filename : Helper::TraverseDirectory(path_, "delta_", true)) {
+    delta_paths.push_back(fmt::format("{}/{}", path_, filename));
+  }
+
+  // delta file name has fixed width log id, so string order is log order.
+  std::sort(delta_paths.begin(), delta_paths.end());
+  return delta_paths;
 }
 
 std::vector<std::string> SnapshotMeta::ListFileNames() { return Helper::TraverseDirectory(path_); }
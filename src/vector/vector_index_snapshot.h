@@ -41,9 +41,14 @@ class SnapshotMeta {
 
   int64_t VectorIndexId() const { return vector_index_id_; }
   int64_t SnapshotLogId() const { return snapshot_log_id_; }
+  // incremental snapshot, the index data file is saved at base snapshot log id.
+  int64_t BaseSnapshotLogId() const { return base_snapshot_log_id_; }
+  bool IsIncremental() const { return base_snapshot_log_id_ != snapshot_log_id_; }
   std::string Path() const { return path_; }
   std::string MetaPath();
   std::string IndexDataPath();
+  // delta files of incremental snapshot, order by log id.
+  std::vector<std::string> DeltaPaths();
   std::vector<std::string> ListFileNames();
 
   pb::common::RegionEpoch Epoch() const { return epoch_; }
@@ -52,6 +57,7 @@ class SnapshotMeta {
  private:
   int64_t vector_index_id_;
   int64_t snapshot_log_id_;
+  int64_t base_snapshot_log_id_{0};
   std::string path_;
 
   pb::common::RegionEpoch epoch_;
@@ -24,6 +24,8 @@
 #include <fstream>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "braft/protobuf_file.h"
@@ -40,14 +42,21 @@
 #include "proto/error.pb.h"
 #include "proto/file_service.pb.h"
 #include "proto/node.pb.h"
+#include "proto/raft.pb.h"
 #include "proto/store_internal.pb.h"
 #include "server/file_service.h"
 #include "server/server.h"
+#include "vector/codec.h"
 #include "vector/vector_index_factory.h"
 
 namespace dingodb {
 
 DEFINE_bool(vector_index_snapshot_use_fork, true, "Use fork to save vector index snapshot.");
+DEFINE_bool(enable_vector_index_incremental_snapshot, false, "Enable save vector index incremental snapshot.");
+DEFINE_int32(vector_index_snapshot_max_delta_num, 8, "Max delta num of incremental snapshot, then save full one.");
+DEFINE_double(vector_index_snapshot_max_delta_ratio, 0.5,
+              "Max delta files size ratio of base index file, then save full one.");
+DEFINE_int64(vector_index_snapshot_delta_window_size, 1024, "Read wal window size when gen snapshot delta.");
 
 // Get all snapshot path, except tmp dir.
 static std::vector<std::string> GetSnapshotPaths(std::string path) {
@@ -425,11 +434,22 @@ butil::Status VectorIndexSnapshotManager::DownloadSnapshotFile(const std::string
     Helper::CreateDirectory(tmp_snapshot_path);
   }
 
+  // The incremental snapshot share the base index file and deltas with local snapshot, just link them.
+  auto local_snapshot = snapshot_set->GetLastSnapshot();
   for (const auto& filename : meta.filenames()) {
     int64_t offset = 0;
     std::ofstream ofile;
 
     std::string filepath = fmt::format("{}/{}", tmp_snapshot_path, filename);
+    if (local_snapshot != nullptr && (filename.find("index_") == 0 || filename.find("delta_") == 0)) {
+      std::string local_filepath = fmt::format("{}/{}", local_snapshot->Path(), filename);
+      if (Helper::IsExistPath(local_filepath) && Helper::Link(local_filepath, filepath)) {
+        DINGO_LOG(INFO) << fmt::format("[vector_index.snapshot][index({})] link local vector index snapshot file: {}",
+                                       meta.vector_index_id(), local_filepath);
+        continue;
+      }
+    }
+
     ofile.open(filepath, std::ofstream::out | std::ofstream::binary);
     DINGO_LOG(INFO) << fmt::format("[vector_index.snapshot][index({})] get vector index snapshot file: {}",
                                    meta.vector_index_id(), filepath);
@@ -531,6 +551,18 @@ butil::Status VectorIndexSnapshotManager::SaveVectorIndexSnapshot(VectorIndexWra
 
   int64_t vector_index_id = vector_index_wrapper->Id();
 
+  if (FLAGS_enable_vector_index_incremental_snapshot) {
+    auto status = SaveIncrementalVectorIndexSnapshot(vector_index_wrapper, vector_index, snapshot_log_index);
+    if (status.ok()) {
+      return status;
+    }
+
+    // Fallback save full snapshot, it's also the compaction of base and deltas.
+    DINGO_LOG(INFO) << fmt::format(
+        "[vector_index.save_snapshot][index_id({})] Not save incremental snapshot, save full snapshot, reason: {}",
+        vector_index_id, status.error_str());
+  }
+
   int64_t start_time = Helper::TimestampMs();
 
   // lock write for atomic ops
@@ -830,6 +862,234 @@ butil::Status VectorIndexSnapshotManager::SaveVectorIndexSnapshot(VectorIndexWra
   return butil::Status::OK();
 }
 
+butil::Status VectorIndexSnapshotManager::GenSnapshotDelta(std::shared_ptr<SegmentLogStorage> log_storage,
+                                                           const pb::common::Range& range, int64_t start_log_id,
+                                                           int64_t end_log_id,
+                                                           pb::store_internal::VectorIndexSnapshotDelta& delta) {
+  if (log_storage->FirstLogIndex() > start_log_id + 1) {
+    return butil::Status(pb::error::EVECTOR_SNAPSHOT_INVALID,
+                         fmt::format("wal already truncated, first_log_id({}) start_log_id({})",
+                                     log_storage->FirstLogIndex(), start_log_id));
+  }
+
+  int64_t min_vector_id = 0, max_vector_id = 0;
+  VectorCodec::DecodeRangeToVectorId(range, min_vector_id, max_vector_id);
+
+  std::unordered_map<int64_t, pb::common::VectorWithId> upsert_vectors;
+  std::unordered_set<int64_t> delete_ids;
+  int64_t window_size = std::max(static_cast<int64_t>(1), FLAGS_vector_index_snapshot_delta_window_size);
+  for (int64_t window_start_log_id = start_log_id + 1; window_start_log_id <= end_log_id;
+       window_start_log_id += window_size) {
+    int64_t window_end_log_id = std::min(window_start_log_id + window_size - 1, end_log_id);
+    for (const auto& log_entry : log_storage->GetEntrys(window_start_log_id, window_end_log_id)) {
+      pb::raft::RaftCmdRequest raft_cmd;
+      butil::IOBufAsZeroCopyInputStream wrapper(log_entry->data);
+      if (!raft_cmd.ParseFromZeroCopyStream(&wrapper)) {
+        return butil::Status(pb::error::EINTERNAL, fmt::format("parse raft cmd failed, log_id({})", log_entry->index));
+      }
+
+      for (auto& request : *raft_cmd.mutable_requests()) {
+        if (request.cmd_type() == pb::raft::VECTOR_ADD) {
+          for (auto& vector : *request.mutable_vector_add()->mutable_vectors()) {
+            if (vector.id() >= min_vector_id && vector.id() < max_vector_id) {
+              delete_ids.erase(vector.id());
+              upsert_vectors[vector.id()] = std::move(vector);
+            }
+          }
+        } else if (request.cmd_type() == pb::raft::VECTOR_DELETE) {
+          for (auto vector_id : request.vector_delete().ids()) {
+            if (vector_id >= min_vector_id && vector_id < max_vector_id) {
+              upsert_vectors.erase(vector_id);
+              delete_ids.insert(vector_id);
+            }
+          }
+        }
+      }
+    }
+  }
+
+  delta.set_start_log_id(start_log_id);
+  delta.set_end_log_id(end_log_id);
+  for (auto& [_, vector] : upsert_vectors) {
+    *delta.add_upsert_vectors() = std::move(vector);
+  }
+  for (auto vector_id : delete_ids) {
+    delta.add_delete_ids(vector_id);
+  }
+
+  return butil::Status::OK();
+}
+
+butil::Status VectorIndexSnapshotManager::SaveIncrementalVectorIndexSnapshot(VectorIndexWrapperPtr vector_index_wrapper,
+                                                                             VectorIndexPtr vector_index,
+                                                                             int64_t& snapshot_log_index) {
+  int64_t vector_index_id = vector_index_wrapper->Id();
+  int64_t start_time = Helper::TimestampMs();
+
+  auto snapshot_set = vector_index_wrapper->SnapshotSet();
+  auto last_snapshot = snapshot_set->GetLastSnapshot();
+  if (last_snapshot == nullptr) {
+    return butil::Status(pb::error::EVECTOR_SNAPSHOT_NOT_FOUND, "not found base snapshot");
+  }
+
+  // region split/merge change the vector index range, need a new base.
+  if (last_snapshot->Epoch().version() != vector_index->Epoch().version() ||
+      last_snapshot->Range().start_key() != vector_index->Range().start_key() ||
+      last_snapshot->Range().end_key() != vector_index->Range().end_key()) {
+    return butil::Status(pb::error::EVECTOR_SNAPSHOT_INVALID, "region epoch/range changed");
+  }
+
+  // compact base and deltas when deltas are too many or too large.
+  auto delta_paths = last_snapshot->DeltaPaths();
+  if (static_cast<int32_t>(delta_paths.size()) >= FLAGS_vector_index_snapshot_max_delta_num) {
+    return butil::Status(pb::error::EVECTOR_SNAPSHOT_INVALID, "too many deltas, need compact");
+  }
+  // The index may save companion files {index file}.{suffix} beside the index file, e.g. diskann, they are all
+  // part of the base.
+  std::vector<std::string> base_paths;
+  std::string base_filename = std::filesystem::path(last_snapshot->IndexDataPath()).filename().string();
+  for (const auto& filename : Helper::TraverseDirectory(last_snapshot->Path(), base_filename, true)) {
+    base_paths.push_back(fmt::format("{}/{}", last_snapshot->Path(), filename));
+  }
+  if (base_paths.empty()) {
+    return butil::Status(pb::error::EVECTOR_SNAPSHOT_INVALID, "not found base index file");
+  }
+
+  std::error_code ec;
+  int64_t base_size = 0;
+  for (const auto& base_path : base_paths) {
+    base_size += std::filesystem::file_size(base_path, ec);
+    if (ec) {
+      return butil::Status(pb::error::EVECTOR_SNAPSHOT_INVALID, "get base index file size failed");
+    }
+  }
+  int64_t delta_size = 0;
+  for (const auto& delta_path : delta_paths) {
+    delta_size += std::filesystem::file_size(delta_path, ec);
+  }
+  if (delta_size > base_size * FLAGS_vector_index_snapshot_max_delta_ratio) {
+    return butil::Status(pb::error::EVECTOR_SNAPSHOT_INVALID, "deltas too large, need compact");
+  }
+
+  int64_t start_log_id = last_snapshot->SnapshotLogId();
+  int64_t end_log_id = vector_index_wrapper->ApplyLogId();
+  if (snapshot_set->IsExistSnapshot(end_log_id)) {
+    snapshot_log_index = end_log_id;
+    return butil::Status();
+  }
+
+  auto log_storage = Server::GetInstance().GetLogStorageManager()->GetLogStorage(vector_index_id);
+  if (log_storage == nullptr) {
+    return butil::Status(pb::error::EINTERNAL, fmt::format("Not found log storage {}", vector_index_id));
+  }
+
+  // No need lock vector index, the delta is generated from wal.
+  pb::store_internal::VectorIndexSnapshotDelta delta;
+  auto status = GenSnapshotDelta(log_storage, vector_index->Range(), start_log_id, end_log_id, delta);
+  if (!status.ok()) {
+    return status;
+  }
+
+  std::string tmp_snapshot_path = GetSnapshotTmpPath(vector_index_id);
+  if (std::filesystem::exists(tmp_snapshot_path)) {
+    Helper::RemoveAllFileOrDirectory(tmp_snapshot_path);
+  }
+  if (!Helper::CreateDirectory(tmp_snapshot_path)) {
+    return butil::Status(pb::error::EINTERNAL, "Create tmp snapshot path failed");
+  }
+
+  // link base index files and deltas of last snapshot
+  std::vector<std::string> link_paths = delta_paths;
+  link_paths.insert(link_paths.end(), base_paths.begin(), base_paths.end());
+  for (const auto& link_path : link_paths) {
+    std::string filename = std::filesystem::path(link_path).filename().string();
+    if (!Helper::Link(link_path, fmt::format("{}/{}", tmp_snapshot_path, filename))) {
+      Helper::RemoveAllFileOrDirectory(tmp_snapshot_path);
+      return butil::Status(pb::error::EINTERNAL, "Link snapshot file failed");
+    }
+  }
+
+  std::string delta_filepath = fmt::format("{}/delta_{:020}_{:020}", tmp_snapshot_path, start_log_id, end_log_id);
+  braft::ProtoBufFile pb_file_delta(delta_filepath);
+  if (pb_file_delta.save(&delta, true) != 0) {
+    Helper::RemoveAllFileOrDirectory(tmp_snapshot_path);
+    return butil::Status(pb::error::EINTERNAL, "Save snapshot delta file failed");
+  }
+
+  pb::store_internal::VectorIndexSnapshotMeta meta;
+  meta.set_vector_index_id(vector_index_id);
+  meta.set_snapshot_log_id(end_log_id);
+  meta.set_base_snapshot_log_id(last_snapshot->BaseSnapshotLogId());
+  *(meta.mutable_range()) = vector_index->Range();
+  *(meta.mutable_epoch()) = vector_index->Epoch();
+  braft::ProtoBufFile pb_file_meta(fmt::format("{}/meta", tmp_snapshot_path));
+  if (pb_file_meta.save(&meta, true) != 0) {
+    Helper::RemoveAllFileOrDirectory(tmp_snapshot_path);
+    return butil::Status(pb::error::EINTERNAL, "Save snapshot meta file failed");
+  }
+
+  std::string new_snapshot_path = GetSnapshotNewPath(vector_index_id, end_log_id);
+  status = Helper::Rename(tmp_snapshot_path, new_snapshot_path);
+  if (!status.ok()) {
+    return status;
+  }
+
+  auto new_snapshot = vector_index::SnapshotMeta::New(vector_index_id, new_snapshot_path);
+  if (!new_snapshot->Init()) {
+    return butil::Status(pb::error::EINTERNAL, "Init snapshot failed, path: %s", new_snapshot_path.c_str());
+  }
+
+  // the old snapshot directory is deleted, the linked files are still kept by the new one.
+  if (!snapshot_set->AddSnapshot(new_snapshot)) {
+    return butil::Status(pb::error::EVECTOR_SNAPSHOT_EXIST, "Already exist vector index snapshot, path: %s",
+                         new_snapshot_path.c_str());
+  }
+
+  log_storage->TruncateVectorIndexPrefix(end_log_id);
+
+  snapshot_log_index = end_log_id;
+
+  DINGO_LOG(INFO) << fmt::format(
+      "[vector_index.save_snapshot][index_id({})] Save vector index incremental snapshot snapshot_{:020} base({}) "
+      "delta_num({}) upsert({}) delete({}) elapsed time {}ms",
+      vector_index_id, end_log_id, last_snapshot->BaseSnapshotLogId(), delta_paths.size() + 1,
+      delta.upsert_vectors_size(), delta.delete_ids_size(), Helper::TimestampMs() - start_time);
+
+  return butil::Status::OK();
+}
+
+butil::Status VectorIndexSnapshotManager::ApplySnapshotDelta(VectorIndexPtr vector_index,
+                                                             const std::string& delta_path) {
+  pb::store_internal::VectorIndexSnapshotDelta delta;
+  braft::ProtoBufFile pb_file_delta(delta_path);
+  if (pb_file_delta.load(&delta) != 0) {
+    return butil::Status(pb::error::EVECTOR_SNAPSHOT_INVALID, "Load snapshot delta file failed");
+  }
+
+  // upsert and delete ids are disjoint, the order is not matter.
+  if (delta.delete_ids_size() > 0) {
+    std::vector<int64_t> delete_ids(delta.delete_ids().begin(), delta.delete_ids().end());
+    // the vector maybe not exist in the base index, ignore error.
+    vector_index->Delete(delete_ids, false);
+  }
+
+  if (delta.upsert_vectors_size() > 0) {
+    std::vector<pb::common::VectorWithId> vectors(std::make_move_iterator(delta.mutable_upsert_vectors()->begin()),
+                                                  std::make_move_iterator(delta.mutable_upsert_vectors()->end()));
+    auto status = vector_index->Upsert(vectors, false);
+    if (!status.ok()) {
+      return status;
+    }
+  }
+
+  DINGO_LOG(INFO) << fmt::format(
+      "[vector_index.load_snapshot][index_id({})] apply snapshot delta log({}-{}) upsert({}) delete({})",
+      vector_index->Id(), delta.start_log_id(), delta.end_log_id(), delta.upsert_vectors_size(),
+      delta.delete_ids_size());
+
+  return butil::Status::OK();
+}
+
 // Load vector index for already exist vector index at bootstrap.
 std::shared_ptr<VectorIndex> VectorIndexSnapshotManager::LoadVectorIndexSnapshot(
     VectorIndexWrapperPtr vector_index_wrapper, const pb::common::RegionEpoch& epoch) {
@@ -900,6 +1160,17 @@ std::shared_ptr<VectorIndex> VectorIndexSnapshotManager::LoadVectorIndexSnapshot
     return nullptr;
   }
 
+  // apply incremental snapshot deltas
+  for (const auto& delta_path : last_snapshot->DeltaPaths()) {
+    status = ApplySnapshotDelta(vector_index, delta_path);
+    if (!status.ok()) {
+      DINGO_LOG(WARNING) << fmt::format(
+          "[vector_index.load_snapshot][index_id({}).snapshot_log_id({})] apply snapshot delta {} failed, error: {}.",
+          vector_index_id, last_snapshot->SnapshotLogId(), delta_path, Helper::PrintStatus(status));
+      return nullptr;
+    }
+  }
+
   // set vector_index apply log id
   vector_index->SetSnapshotLogId(last_snapshot->SnapshotLogId());
   vector_index->SetApplyLogId(last_snapshot->SnapshotLogId());
@@ -22,7 +22,9 @@
 
 #include "butil/endpoint.h"
 #include "butil/status.h"
+#include "log/segment_log_storage.h"
 #include "proto/node.pb.h"
+#include "proto/store_internal.pb.h"
 #include "vector/vector_index.h"
 
 namespace dingodb {
@@ -63,11 +65,24 @@ class VectorIndexSnapshotManager {
 
   static std::vector<std::string> GetSnapshotList(int64_t vector_index_id);
 
+  // Collect vector changes of wal (start_log_id, end_log_id] into delta, add/delete of same vector id is
+  // last-writer-wins.
+  static butil::Status GenSnapshotDelta(std::shared_ptr<SegmentLogStorage> log_storage, const pb::common::Range& range,
+                                        int64_t start_log_id, int64_t end_log_id,
+                                        pb::store_internal::VectorIndexSnapshotDelta& delta);
+  // Apply incremental snapshot delta file to vector index.
+  static butil::Status ApplySnapshotDelta(VectorIndexPtr vector_index, const std::string& delta_path);
+
  private:
   static std::string GetSnapshotTmpPath(int64_t vector_index_id);
   static std::string GetSnapshotNewPath(int64_t vector_index_id, int64_t snapshot_log_id);
   static butil::Status DownloadSnapshotFile(const std::string& uri, const pb::node::VectorIndexSnapshotMeta& meta,
                                             vector_index::SnapshotMetaSetPtr snapshot_set);
+
+  // Save incremental snapshot, link the base index file and deltas of last snapshot,
+  // add a delta file with the vector changes of wal since last snapshot.
+  static butil::Status SaveIncrementalVectorIndexSnapshot(VectorIndexWrapperPtr vector_index_wrapper,
+                                                          VectorIndexPtr vector_index, int64_t& snapshot_log_index);
 };
 
 }  // namespace dingodb
@@ -0,0 +1,225 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "vector/vector_index_train_sample.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "bthread/mutex.h"
+#include "common/constant.h"
+#include "faiss/Clustering.h"
+#include "gflags/gflags.h"
+#include "proto/common.pb.h"
+
+namespace dingodb {
+
+DEFINE_bool(enable_vector_index_train_sample, false,
+            "enable keep train sample for ivf vector index, the sample is charged to the vector index memory");
+DEFINE_int64(vector_index_train_sample_max_count, 65536,
+             "max sample vector count of per region, the sample memory is max_count * dimension * 4 bytes, "
+             "0 means no limit");
+
+VectorIndexTrainSample::VectorIndexTrainSample(int64_t capacity, int32_t dimension, uint64_t seed)
+    : capacity_(std::max(capacity, static_cast<int64_t>(0))), dimension_(dimension), generator_(seed) {
+  bthread_mutex_init(&mutex_, nullptr);
+}
+
+VectorIndexTrainSample::~VectorIndexTrainSample() { bthread_mutex_destroy(&mutex_); }
+
+VectorIndexTrainSamplePtr VectorIndexTrainSample::New(const pb::common::VectorIndexParameter& parameter) {
+  int64_t capacity = GetCapacity(parameter);
+  if (capacity == 0) {
+    return nullptr;
+  }
+
+  int32_t dimension = parameter.vector_index_type() == pb::common::VECTOR_INDEX_TYPE_IVF_FLAT
+                          ? parameter.ivf_flat_parameter().dimension()
+                          : parameter.ivf_pq_parameter().dimension();
+  return New(capacity, dimension);
+}
+
+bool VectorIndexTrainSample::IsEnable() { return FLAGS_enable_vector_index_train_sample; }
+
+int64_t VectorIndexTrainSample::GetCapacity(const pb::common::VectorIndexParameter& parameter) {
+  faiss::ClusteringParameters clustering_parameters;
+  switch (parameter.vector_index_type()) {
+    case pb::common::VECTOR_INDEX_TYPE_IVF_FLAT: {
+      int64_t nlist = parameter.ivf_flat_parameter().ncentroids();
+      if (nlist == 0) {
+        nlist = Constant::kCreateIvfFlatParamNcentroids;
+      }
+      return std::max(GetCapacity(clustering_parameters.max_points_per_centroid * nlist),
+                      clustering_parameters.min_points_per_centroid * nlist);
+    }
+    case pb::common::VECTOR_INDEX_TYPE_IVF_PQ: {
+      int64_t nlist = parameter.ivf_pq_parameter().ncentroids();
+      if (nlist == 0) {
+        nlist = Constant::kCreateIvfPqParamNcentroids;
+      }
+      int32_t nbits_per_idx = parameter.ivf_pq_parameter().nbits_per_idx() % 64;
+      if (nbits_per_idx == 0) {
+        nbits_per_idx = Constant::kCreateIvfPqParamNbitsPerIdx;
+      }
+      // Both the coarse quantizer and the product quantizer train on the sample, the pq codebook is small
+      // and faiss samples it down to max_points_per_centroid * ksub, so never cap it.
+      int64_t pq_count = clustering_parameters.max_points_per_centroid * (static_cast<int64_t>(1) << nbits_per_idx);
+      return std::max({GetCapacity(std::max(clustering_parameters.max_points_per_centroid * nlist, pq_count)),
+                       clustering_parameters.min_points_per_centroid * nlist, pq_count});
+    }
+    default:
+      return 0;
+  }
+}
+
+int64_t VectorIndexTrainSample::GetCapacity(int64_t expect_count) {
+  if (FLAGS_vector_index_train_sample_max_count <= 0) {
+    return expect_count;
+  }
+
+  return std::min(expect_count, FLAGS_vector_index_train_sample_max_count);
+}
+
+double VectorIndexTrainSample::ImbalanceFactor(const std::vector<int64_t>& list_sizes) {
+  double total = 0;
+  double square_sum = 0;
+  for (auto list_size : list_sizes) {
+    total += list_size;
+    square_sum += static_cast<double>(list_size) * list_size;
+  }
+
+  if (total == 0) {
+    return 1.0;
+  }
+
+  return square_sum * list_sizes.size() / (total * total);
+}
+
+void VectorIndexTrainSample::Add(const std::vector<pb::common::VectorWithId>& vector_with_ids) {
+  if (capacity_ == 0) {
+    return;
+  }
+
+  BAIDU_SCOPED_LOCK(mutex_);
+  for (const auto& vector_with_id : vector_with_ids) {
+    const auto& float_values = vector_with_id.vector().float_values();
+    if (float_values.size() != dimension_) {
+      continue;
+    }
+    AddUnlock(vector_with_id.id(), float_values.data());
+  }
+}
+
+void VectorIndexTrainSample::Add(int64_t vector_id, const float* vector) {
+  if (capacity_ == 0) {
+    return;
+  }
+
+  BAIDU_SCOPED_LOCK(mutex_);
+  AddUnlock(vector_id, vector);
+}
+
+void VectorIndexTrainSample::AddUnlock(int64_t vector_id, const float* vector) {
+  auto it = id_slots_.find(vector_id);
+  if (it != id_slots_.end()) {
+    memcpy(data_.data() + it->second * dimension_, vector, dimension_ * sizeof(float));
+    return;
+  }
+
+  ++seen_count_;
+
+  int64_t slot = size_;
+  if (size_ < capacity_) {
+    ++size_;
+    data_.resize(size_ * dimension_);
+    ids_.push_back(vector_id);
+  } else {
+    // Keep the new vector with probability capacity/seen_count, replace a random one.
+    slot = std::uniform_int_distribution<int64_t>(0, seen_count_ - 1)(generator_);
+    if (slot >= capacity_) {
+      return;
+    }
+    id_slots_.erase(ids_[slot]);
+    ids_[slot] = vector_id;
+  }
+
+  id_slots_[vector_id] = slot;
+  memcpy(data_.data() + slot * dimension_, vector, dimension_ * sizeof(float));
+}
+
+void VectorIndexTrainSample::Delete(const std::vector<int64_t>& vector_ids) {
+  if (capacity_ == 0) {
+    return;
+  }
+
+  BAIDU_SCOPED_LOCK(mutex_);
+  for (auto vector_id : vector_ids) {
+    auto it = id_slots_.find(vector_id);
+    if (it == id_slots_.end()) {
+      continue;
+    }
+
+    // Move the last vector into the hole, keep the sample dense.
+    int64_t slot = it->second;
+    id_slots_.erase(it);
+    int64_t last_slot = size_ - 1;
+    if (slot != last_slot) {
+      memcpy(data_.data() + slot * dimension_, data_.data() + last_slot * dimension_, dimension_ * sizeof(float));
+      ids_[slot] = ids_[last_slot];
+      id_slots_[ids_[slot]] = slot;
+    }
+
+    --size_;
+    ids_.pop_back();
+    data_.resize(size_ * dimension_);
+    // The deleted vector leave the stream, the left ones keep the probability size/seen_count.
+    --seen_count_;
+  }
+}
+
+std::vector<float> VectorIndexTrainSample::GetTrainData() {
+  BAIDU_SCOPED_LOCK(mutex_);
+  return data_;
+}
+
+int64_t VectorIndexTrainSample::Size() {
+  BAIDU_SCOPED_LOCK(mutex_);
+  return size_;
+}
+
+int64_t VectorIndexTrainSample::SeenCount() {
+  BAIDU_SCOPED_LOCK(mutex_);
+  return seen_count_;
+}
+
+int64_t VectorIndexTrainSample::MemorySize() {
+  BAIDU_SCOPED_LOCK(mutex_);
+  return data_.capacity() * sizeof(float) + ids_.capacity() * sizeof(int64_t) +
+         id_slots_.bucket_count() * sizeof(void*) + id_slots_.size() * (2 * sizeof(int64_t) + sizeof(void*));
+}
+
+void VectorIndexTrainSample::Clear() {
+  BAIDU_SCOPED_LOCK(mutex_);
+  size_ = 0;
+  seen_count_ = 0;
+  data_.clear();
+  data_.shrink_to_fit();
+  ids_.clear();
+  ids_.shrink_to_fit();
+  id_slots_.clear();
+}
+
+}  // namespace dingodb
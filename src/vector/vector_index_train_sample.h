@@ -0,0 +1,100 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGODB_VECTOR_INDEX_TRAIN_SAMPLE_H_  // NOLINT
+#define DINGODB_VECTOR_INDEX_TRAIN_SAMPLE_H_
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "bthread/mutex.h"
+#include "proto/common.pb.h"
+
+namespace dingodb {
+
+// Bounded uniform sample of the vectors written to a region, kept by reservoir sampling(Algorithm R).
+// IVF indexes train on the sample instead of the whole region data, the sample is filled by the build scan
+// and then updated on every apply of vector add/delete, so it follows the data distribution drift.
+// The sample is charged to the vector index memory size, so it is under the store memory budget.
+class VectorIndexTrainSample {
+ public:
+  VectorIndexTrainSample(int64_t capacity, int32_t dimension, uint64_t seed);
+  ~VectorIndexTrainSample();
+
+  VectorIndexTrainSample(const VectorIndexTrainSample&) = delete;
+  const VectorIndexTrainSample& operator=(const VectorIndexTrainSample&) = delete;
+
+  static std::shared_ptr<VectorIndexTrainSample> New(int64_t capacity, int32_t dimension,
+                                                     uint64_t seed = std::random_device()()) {
+    return std::make_shared<VectorIndexTrainSample>(capacity, dimension, seed);
+  }
+
+  // Return nullptr when the vector index not need train.
+  static std::shared_ptr<VectorIndexTrainSample> New(const pb::common::VectorIndexParameter& parameter);
+
+  static bool IsEnable();
+
+  // The sample capacity of the vector index, 0 means the vector index not need train.
+  // The max sample count never cut it below what faiss needs, min_points_per_centroid per centroid.
+  static int64_t GetCapacity(const pb::common::VectorIndexParameter& parameter);
+  // Cap the expected train data size by the max sample count.
+  static int64_t GetCapacity(int64_t expect_count);
+
+  // Cluster imbalance factor of the inverted list sizes, 1.0 means perfectly balanced.
+  static double ImbalanceFactor(const std::vector<int64_t>& list_sizes);
+
+  // Offer vectors to the sample, the vector with mismatch dimension is ignored.
+  // The sampled vector of the same id is updated in place.
+  void Add(const std::vector<pb::common::VectorWithId>& vector_with_ids);
+  void Add(int64_t vector_id, const float* vector);
+
+  // Drop the deleted vectors from the sample, so they are not learned by the next train.
+  void Delete(const std::vector<int64_t>& vector_ids);
+
+  // Copy out the sampled vectors, row major.
+  std::vector<float> GetTrainData();
+
+  int64_t Capacity() const { return capacity_; }
+  int32_t Dimension() const { return dimension_; }
+  int64_t Size();
+  // The total vector count offered to the sample.
+  int64_t SeenCount();
+  int64_t MemorySize();
+
+  void Clear();
+
+ private:
+  void AddUnlock(int64_t vector_id, const float* vector);
+
+  const int64_t capacity_;
+  const int32_t dimension_;
+
+  bthread_mutex_t mutex_;
+  int64_t size_{0};
+  int64_t seen_count_{0};
+  std::vector<float> data_;
+  std::vector<int64_t> ids_;
+  // vector id -> slot of data_
+  std::unordered_map<int64_t, int64_t> id_slots_;
+  std::mt19937_64 generator_;
+};
+
+using VectorIndexTrainSamplePtr = std::shared_ptr<VectorIndexTrainSample>;
+
+}  // namespace dingodb
+
+#endif  // DINGODB_VECTOR_INDEX_TRAIN_SAMPLE_H_  // NOLINT
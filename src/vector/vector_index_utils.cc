@@ -14,26 +14,48 @@
 
 #include "vector/vector_index_utils.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <memory>
 #include <string>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
 #include "butil/status.h"
 #include "common/constant.h"
+#include "common/helper.h"
 #include "common/logging.h"
+#include "faiss/Clustering.h"
 #include "faiss/MetricType.h"
+#include "faiss/impl/IDSelector.h"
+#include "faiss/index_io.h"
+#include "faiss/invlists/InvertedLists.h"
+#include "faiss/invlists/OnDiskInvertedLists.h"
 #include "faiss/utils/extra_distances-inl.h"
 #include "fmt/core.h"
+#include "gflags/gflags.h"
 #include "hnswlib/hnswlib.h"
 #include "hnswlib/space_ip.h"
 #include "hnswlib/space_l2.h"
 #include "proto/common.pb.h"
 #include "proto/error.pb.h"
+#include "vector/vector_index_train_sample.h"
 
 namespace dingodb {
 
+DEFINE_bool(vector_index_load_mmap, false,
+            "load ivf vector index snapshot with mmap, the inverted lists are paged in on demand");
+DEFINE_double(vector_index_ivf_purge_tombstone_ratio, 0.1,
+              "purge the ivf index tombstones when the deleted ratio exceed the threshold");
+DEFINE_int64(vector_index_ivf_purge_tombstone_min_count, 1024, "purge the ivf index tombstones at least count");
+DEFINE_double(vector_index_ivf_retrain_imbalance_factor, 3.0,
+              "retrain the ivf index when the inverted lists imbalance factor exceed, 0 means disable");
+DEFINE_int64(vector_index_ivf_retrain_interval_s, 3600, "min interval of retrain the ivf index by imbalance");
+DEFINE_int32(vector_index_ivf_retrain_max_backoff, 6,
+             "max times of doubling the imbalance retrain interval, the interval is doubled after each retrain");
+
 butil::Status VectorIndexUtils::CalcDistanceEntry(
     const ::dingodb::pb::index::VectorCalcDistanceRequest& request,
     std::vector<std::vector<float>>& distances,                             // NOLINT
@@ -132,6 +154,10 @@ butil::Status VectorIndexUtils::CalcDistanceByFaiss(
       return CalcCosineDistanceByFaiss(op_left_vectors, op_right_vectors, is_return_normlize, distances,
                                        result_op_left_vectors, result_op_right_vectors);
     }
+    case pb::common::METRIC_TYPE_HAMMING: {
+      return CalcHammingDistance(op_left_vectors, op_right_vectors, is_return_normlize, distances,
+                                 result_op_left_vectors, result_op_right_vectors);
+    }
     case pb::common::METRIC_TYPE_NONE:
     case pb::common::MetricType_INT_MIN_SENTINEL_DO_NOT_USE_:
     case pb::common::MetricType_INT_MAX_SENTINEL_DO_NOT_USE_: {
@@ -163,6 +189,10 @@ butil::Status VectorIndexUtils::CalcDistanceByHnswlib(
       return CalcCosineDistanceByHnswlib(op_left_vectors, op_right_vectors, is_return_normlize, distances,
                                          result_op_left_vectors, result_op_right_vectors);
     }
+    case pb::common::METRIC_TYPE_HAMMING: {
+      return CalcHammingDistance(op_left_vectors, op_right_vectors, is_return_normlize, distances,
+                                 result_op_left_vectors, result_op_right_vectors);
+    }
     case pb::common::METRIC_TYPE_NONE:
     case pb::common::MetricType_INT_MIN_SENTINEL_DO_NOT_USE_:
     case pb::common::MetricType_INT_MAX_SENTINEL_DO_NOT_USE_: {
@@ -239,6 +269,32 @@ butil::Status VectorIndexUtils::CalcCosineDistanceByHnswlib(
                           result_op_right_vectors, DoCalcCosineDistanceByHnswlib);
 }
 
+butil::Status VectorIndexUtils::CalcHammingDistance(
+    const google::protobuf::RepeatedPtrField<::dingodb::pb::common::Vector>& op_left_vectors,
+    const google::protobuf::RepeatedPtrField<::dingodb::pb::common::Vector>& op_right_vectors, bool is_return_normlize,
+    std::vector<std::vector<float>>& distances,                           // NOLINT
+    std::vector<::dingodb::pb::common::Vector>& result_op_left_vectors,   // NOLINT
+    std::vector<::dingodb::pb::common::Vector>& result_op_right_vectors)  // NOLINT
+{                                                                         // NOLINT
+  if (op_left_vectors.empty() || op_right_vectors.empty()) {
+    return butil::Status(pb::error::EILLEGAL_PARAMTETERS, "op_left_vectors empty or op_right_vectors empty");
+  }
+
+  for (const auto& vector : op_left_vectors) {
+    if (BinaryVectorSize(vector) != BinaryVectorSize(op_left_vectors[0])) {
+      return butil::Status(pb::error::EILLEGAL_PARAMTETERS, "binary vector size not match");
+    }
+  }
+  for (const auto& vector : op_right_vectors) {
+    if (BinaryVectorSize(vector) != BinaryVectorSize(op_left_vectors[0])) {
+      return butil::Status(pb::error::EILLEGAL_PARAMTETERS, "binary vector size not match");
+    }
+  }
+
+  return CalcDistanceCore(op_left_vectors, op_right_vectors, is_return_normlize, distances, result_op_left_vectors,
+                          result_op_right_vectors, DoCalcHammingDistance);
+}
+
 butil::Status VectorIndexUtils::DoCalcL2DistanceByFaiss(const ::dingodb::pb::common::Vector& op_left_vectors,
                                                         const ::dingodb::pb::common::Vector& op_right_vectors,
                                                         bool is_return_normlize,
@@ -372,6 +428,38 @@ butil::Status VectorIndexUtils::DoCalcCosineDistanceByHnswlib(
   return butil::Status();
 }
 
+butil::Status VectorIndexUtils::DoCalcHammingDistance(const ::dingodb::pb::common::Vector& op_left_vectors,
+                                                      const ::dingodb::pb::common::Vector& op_right_vectors,
+                                                      bool is_return_normlize,
+                                                      float& distance,                                       // NOLINT
+                                                      dingodb::pb::common::Vector& result_op_left_vectors,   // NOLINT
+                                                      dingodb::pb::common::Vector& result_op_right_vectors)  // NOLINT
+{                                                                                                            // NOLINT
+  size_t code_size = BinaryVectorSize(op_left_vectors);
+  std::vector<uint8_t> left(code_size);
+  std::vector<uint8_t> right(code_size);
+  CopyBinaryVector(op_left_vectors, left.data());
+  CopyBinaryVector(op_right_vectors, right.data());
+
+  distance = static_cast<float>(HammingDistance(left.data(), right.data(), code_size));
+
+  // binary vector has nothing to normalize, return the origin vector
+  if (is_return_normlize) {
+    if (result_op_left_vectors.binary_values().empty()) {
+      result_op_left_vectors = op_left_vectors;
+      result_op_left_vectors.set_dimension(code_size * 8);
+      result_op_left_vectors.set_value_type(::dingodb::pb::common::ValueType::UINT8);
+    }
+    if (result_op_right_vectors.binary_values().empty()) {
+      result_op_right_vectors = op_right_vectors;
+      result_op_right_vectors.set_dimension(code_size * 8);
+      result_op_right_vectors.set_value_type(::dingodb::pb::common::ValueType::UINT8);
+    }
+  }
+
+  return butil::Status();
+}
+
 void VectorIndexUtils::ResultOpVectorAssignment(dingodb::pb::common::Vector& result_op_vectors,
                                                 const ::dingodb::pb::common::Vector& op_vectors) {
   result_op_vectors = op_vectors;
@@ -526,6 +614,296 @@ std::pair<std::unique_ptr<float[]>, butil::Status> VectorIndexUtils::CheckAndCop
   return {std::move(vectors), butil::Status::OK()};
 }
 
+bool VectorIndexUtils::IsBinaryVectorIndexType(pb::common::VectorIndexType vector_index_type) {
+  return vector_index_type == pb::common::VectorIndexType::VECTOR_INDEX_TYPE_BINARY_FLAT ||
+         vector_index_type == pb::common::VectorIndexType::VECTOR_INDEX_TYPE_BINARY_IVF_FLAT;
+}
+
+int VectorIndexUtils::FaissReadIndexIoFlags() { return FLAGS_vector_index_load_mmap ? faiss::IO_FLAG_MMAP : 0; }
+
+bool VectorIndexUtils::MaterializeInvertedLists(faiss::IndexIVF* index) {
+  auto* mmap_invlists = dynamic_cast<faiss::OnDiskInvertedLists*>(index->invlists);
+  if (mmap_invlists == nullptr) {
+    return false;
+  }
+
+  auto* array_invlists = new faiss::ArrayInvertedLists(mmap_invlists->nlist, mmap_invlists->code_size);
+  for (size_t list_no = 0; list_no < mmap_invlists->nlist; ++list_no) {
+    size_t list_size = mmap_invlists->list_size(list_no);
+    if (list_size == 0) {
+      continue;
+    }
+
+    faiss::InvertedLists::ScopedIds ids(mmap_invlists, list_no);
+    faiss::InvertedLists::ScopedCodes codes(mmap_invlists, list_no);
+    array_invlists->add_entries(list_no, list_size, ids.get(), codes.get());
+  }
+
+  // own the new inverted lists and release the mmap one.
+  index->replace_invlists(array_invlists, true);
+
+  return true;
+}
+
+bool VectorIndexUtils::NeedPurgeTombstones(int64_t tombstone_count, int64_t total_count) {
+  if (tombstone_count < FLAGS_vector_index_ivf_purge_tombstone_min_count) {
+    return false;
+  }
+
+  return total_count <= 0 ||
+         static_cast<double>(tombstone_count) / total_count >= FLAGS_vector_index_ivf_purge_tombstone_ratio;
+}
+
+size_t VectorIndexUtils::PurgeTombstones(faiss::IndexIVF* index, std::unordered_set<int64_t>& tombstones,
+                                         std::unordered_set<int64_t>& vector_ids) {
+  if (index == nullptr || tombstones.empty()) {
+    return 0;
+  }
+
+  std::vector<faiss::idx_t> ids(tombstones.begin(), tombstones.end());
+  faiss::IDSelectorBatch sel(ids.size(), ids.data());
+
+  MaterializeInvertedLists(index);
+  size_t remove_count = index->remove_ids(sel);
+  for (auto id : ids) {
+    vector_ids.erase(id);
+  }
+  tombstones.clear();
+
+  return remove_count;
+}
+
+std::unordered_set<int64_t> VectorIndexUtils::GetIvfIds(faiss::IndexIVF* index) {
+  std::unordered_set<int64_t> vector_ids;
+  if (index == nullptr || index->ntotal == 0) {
+    return vector_ids;
+  }
+
+  vector_ids.reserve(index->ntotal);
+  for (size_t list_no = 0; list_no < index->nlist; ++list_no) {
+    size_t list_size = index->invlists->list_size(list_no);
+    if (list_size == 0) {
+      continue;
+    }
+
+    faiss::InvertedLists::ScopedIds list_ids(index->invlists, list_no);
+    for (size_t i = 0; i < list_size; ++i) {
+      vector_ids.insert(list_ids[i]);
+    }
+  }
+
+  return vector_ids;
+}
+
+bool VectorIndexUtils::NeedRetrainOnSample(int64_t train_data_size, int64_t train_sample_count, int64_t nlist,
+                                           int64_t train_sample_capacity) {
+  if (nlist <= 1 || train_data_size >= train_sample_capacity) {
+    return false;
+  }
+
+  // Enough to train all the centroids, and at least double of the last train to avoid retrain frequently.
+  faiss::ClusteringParameters clustering_parameters;
+  return train_sample_count >= std::min(clustering_parameters.min_points_per_centroid * nlist, train_sample_capacity) &&
+         train_sample_count >= 2 * train_data_size;
+}
+
+bool VectorIndexUtils::NeedRetrainOnImbalance(faiss::IndexIVF* index, int64_t train_time_ms, int32_t retrain_num) {
+  if (index == nullptr || index->nlist <= 1 || FLAGS_vector_index_ivf_retrain_imbalance_factor <= 0) {
+    return false;
+  }
+  // Double the interval for each retrain, the retrain not help when the data is skewed by nature.
+  int64_t interval_ms = (FLAGS_vector_index_ivf_retrain_interval_s * 1000)
+                        << std::clamp(retrain_num, 0, FLAGS_vector_index_ivf_retrain_max_backoff);
+  if (Helper::TimestampMs() - train_time_ms < interval_ms) {
+    return false;
+  }
+
+  faiss::ClusteringParameters clustering_parameters;
+  if (index->ntotal < static_cast<faiss::idx_t>(clustering_parameters.min_points_per_centroid * index->nlist)) {
+    return false;
+  }
+
+  std::vector<int64_t> list_sizes(index->nlist);
+  for (size_t list_no = 0; list_no < index->nlist; ++list_no) {
+    list_sizes[list_no] = index->invlists->list_size(list_no);
+  }
+
+  double imbalance_factor = VectorIndexTrainSample::ImbalanceFactor(list_sizes);
+  if (imbalance_factor < FLAGS_vector_index_ivf_retrain_imbalance_factor) {
+    return false;
+  }
+
+  DINGO_LOG(INFO) << fmt::format("[vector_index.ivf] inverted lists imbalance factor({:.2f}) exceed threshold({:.2f}).",
+                                 imbalance_factor, FLAGS_vector_index_ivf_retrain_imbalance_factor);
+  return true;
+}
+
+butil::Status VectorIndexUtils::DeriveIvfIndex(faiss::IndexIVF* index, int64_t begin_vector_id, int64_t end_vector_id,
+                                              const std::unordered_set<int64_t>& tombstones,
+                                              faiss::IndexIVF* target_index) {
+  if (index->d != target_index->d || index->nlist != target_index->nlist ||
+      index->code_size != target_index->code_size || index->metric_type != target_index->metric_type) {
+    return butil::Status(pb::error::Errno::EILLEGAL_PARAMTETERS,
+                         fmt::format("derive ivf index mismatch, d({}/{}) nlist({}/{}) code_size({}/{})", index->d,
+                                     target_index->d, index->nlist, target_index->nlist, index->code_size,
+                                     target_index->code_size));
+  }
+
+  try {
+    // Same centroids, so the entries stay in the same list.
+    std::vector<float> centroids(index->nlist * index->d);
+    index->quantizer->reconstruct_n(0, index->nlist, centroids.data());
+    target_index->quantizer->reset();
+    target_index->quantizer->add(index->nlist, centroids.data());
+    target_index->is_trained = true;
+
+    const size_t code_size = index->code_size;
+    std::vector<faiss::idx_t> ids;
+    std::vector<uint8_t> codes;
+    for (size_t list_no = 0; list_no < index->nlist; ++list_no) {
+      size_t list_size = index->invlists->list_size(list_no);
+      if (list_size == 0) {
+        continue;
+      }
+
+      faiss::InvertedLists::ScopedIds list_ids(index->invlists, list_no);
+      faiss::InvertedLists::ScopedCodes list_codes(index->invlists, list_no);
+      ids.clear();
+      codes.clear();
+      for (size_t i = 0; i < list_size; ++i) {
+        faiss::idx_t id = list_ids.get()[i];
+        if (id < begin_vector_id || id >= end_vector_id || tombstones.count(id) > 0) {
+          continue;
+        }
+        ids.push_back(id);
+        codes.insert(codes.end(), list_codes.get() + i * code_size, list_codes.get() + (i + 1) * code_size);
+      }
+
+      if (!ids.empty()) {
+        target_index->invlists->add_entries(list_no, ids.size(), ids.data(), codes.data());
+        target_index->ntotal += ids.size();
+      }
+    }
+  } catch (std::exception& e) {
+    return butil::Status(pb::error::Errno::EINTERNAL, fmt::format("derive ivf index failed, error: {}", e.what()));
+  }
+
+  return butil::Status::OK();
+}
+
+size_t VectorIndexUtils::BinaryVectorSize(const pb::common::Vector& vector) {
+  size_t size = 0;
+  for (const auto& binary_value : vector.binary_values()) {
+    size += binary_value.size();
+  }
+  return size;
+}
+
+void VectorIndexUtils::CopyBinaryVector(const pb::common::Vector& vector, uint8_t* dest) {
+  for (const auto& binary_value : vector.binary_values()) {
+    memcpy(dest, binary_value.data(), binary_value.size());
+    dest += binary_value.size();
+  }
+}
+
+std::pair<std::unique_ptr<faiss::idx_t[]>, butil::Status> VectorIndexUtils::CheckAndCopyBinaryVectorId(
+    const std::vector<pb::common::VectorWithId>& vector_with_ids, faiss::idx_t dimension) {
+  size_t code_size = dimension / 8;
+  for (size_t i = 0; i < vector_with_ids.size(); ++i) {
+    size_t input_size = BinaryVectorSize(vector_with_ids[i].vector());
+    if (input_size != code_size) {
+      std::string s = fmt::format("id.no : {}: binary size : {} not equal to dimension(create) / 8 : {}", i,
+                                  input_size, code_size);
+      DINGO_LOG(ERROR) << s;
+      return {nullptr, butil::Status(pb::error::Errno::EVECTOR_INVALID, s)};
+    }
+  }
+
+  std::unique_ptr<faiss::idx_t[]> ids;
+  try {
+    ids = std::make_unique<faiss::idx_t[]>(vector_with_ids.size());  // do not modify reset method. this fast and safe.
+  } catch (std::bad_alloc& e) {
+    std::string s = fmt::format("Failed to allocate memory for ids: {}", e.what());
+    DINGO_LOG(ERROR) << s;
+    return {nullptr, butil::Status(pb::error::Errno::EVECTOR_INVALID, s)};
+  }
+
+  for (size_t i = 0; i < vector_with_ids.size(); ++i) {
+    ids[i] = static_cast<faiss::idx_t>(vector_with_ids[i].id());
+  }
+
+  return {std::move(ids), butil::Status::OK()};
+}
+
+std::pair<std::unique_ptr<uint8_t[]>, butil::Status> VectorIndexUtils::CheckAndCopyBinaryVectorData(
+    const std::vector<pb::common::VectorWithId>& vector_with_ids, faiss::idx_t dimension) {
+  size_t code_size = dimension / 8;
+  std::unique_ptr<uint8_t[]> vectors;
+  try {
+    vectors = std::make_unique<uint8_t[]>(vector_with_ids.size() * code_size);
+  } catch (std::bad_alloc& e) {
+    std::string s = fmt::format("Failed to allocate memory for vectors: {}", e.what());
+    DINGO_LOG(ERROR) << s;
+    return {nullptr, butil::Status(pb::error::Errno::EVECTOR_INVALID, s)};
+  }
+
+  for (size_t i = 0; i < vector_with_ids.size(); ++i) {
+    size_t input_size = BinaryVectorSize(vector_with_ids[i].vector());
+    if (input_size != code_size) {
+      std::string s = fmt::format(
+          "vector dimension is not equal to index dimension, vector id : {}, binary size: {}, index dimension: {}",
+          vector_with_ids[i].id(), input_size, dimension);
+      DINGO_LOG(ERROR) << s;
+      return {nullptr, butil::Status(pb::error::Errno::EVECTOR_INVALID, s)};
+    }
+
+    CopyBinaryVector(vector_with_ids[i].vector(), vectors.get() + i * code_size);
+  }
+
+  return {std::move(vectors), butil::Status::OK()};
+}
+
+int32_t VectorIndexUtils::HammingDistance(const uint8_t* left, const uint8_t* right, size_t code_size) {
+  int32_t distance = 0;
+  size_t i = 0;
+  for (; i + 8 <= code_size; i += 8) {
+    uint64_t left_word = 0;
+    uint64_t right_word = 0;
+    memcpy(&left_word, left + i, 8);
+    memcpy(&right_word, right + i, 8);
+    distance += __builtin_popcountll(left_word ^ right_word);
+  }
+  for (; i < code_size; ++i) {
+    distance += __builtin_popcount(left[i] ^ right[i]);
+  }
+  return distance;
+}
+
+butil::Status VectorIndexUtils::FillBinarySearchResult(const std::vector<pb::common::VectorWithId>& vector_with_ids,
+                                                       uint32_t topk, const std::vector<int32_t>& distances,
+                                                       const std::vector<faiss::idx_t>& labels, faiss::idx_t dimension,
+                                                       std::vector<pb::index::VectorWithDistanceResult>& results) {
+  for (size_t row = 0; row < vector_with_ids.size(); ++row) {
+    auto& result = results.emplace_back();
+
+    for (size_t i = 0; i < topk; i++) {
+      size_t pos = row * topk + i;
+      if (labels[pos] < 0) {
+        continue;
+      }
+      auto* vector_with_distance = result.add_vector_with_distances();
+
+      auto* vector_with_id = vector_with_distance->mutable_vector_with_id();
+      vector_with_id->set_id(labels[pos]);
+      vector_with_id->mutable_vector()->set_dimension(dimension);
+      vector_with_id->mutable_vector()->set_value_type(::dingodb::pb::common::ValueType::UINT8);
+      vector_with_distance->set_distance(static_cast<float>(distances[pos]));
+      vector_with_distance->set_metric_type(pb::common::MetricType::METRIC_TYPE_HAMMING);
+    }
+  }
+  return butil::Status::OK();
+}
+
 butil::Status VectorIndexUtils::FillSearchResult(const std::vector<pb::common::VectorWithId>& vector_with_ids,
                                                  uint32_t topk, const std::vector<faiss::Index::distance_t>& distances,
                                                  const std::vector<faiss::idx_t>& labels,
@@ -625,6 +1003,11 @@ butil::Status VectorIndexUtils::CheckVectorIndexParameterCompatibility(const pb:
       return butil::Status(pb::error::EMERGE_VECTOR_INDEX_PARAMETER_NOT_MATCH,
                            "source_hnsw_parameter.metric_type() != target_hnsw_parameter.metric_type()");
     }
+    if (source_hnsw_parameter.quantizer_type() != target_hnsw_parameter.quantizer_type()) {
+      DINGO_LOG(INFO) << "source_hnsw_parameter.quantizer_type() != target_hnsw_parameter.quantizer_type()";
+      return butil::Status(pb::error::EMERGE_VECTOR_INDEX_PARAMETER_NOT_MATCH,
+                           "source_hnsw_parameter.quantizer_type() != target_hnsw_parameter.quantizer_type()");
+    }
     return butil::Status::OK();
   } else if (source.vector_index_type() == pb::common::VectorIndexType::VECTOR_INDEX_TYPE_IVF_FLAT) {
     const auto& source_ivf_flat_parameter = source.ivf_flat_parameter();
@@ -664,12 +1047,73 @@ butil::Status VectorIndexUtils::CheckVectorIndexParameterCompatibility(const pb:
                            "source_ivf_pq_parameter.ncentroids() != target_ivf_pq_parameter.ncentroids()");
     }
     return butil::Status::OK();
+  } else if (source.vector_index_type() == pb::common::VectorIndexType::VECTOR_INDEX_TYPE_BINARY_FLAT) {
+    const auto& source_binary_flat_parameter = source.binary_flat_parameter();
+    const auto& target_binary_flat_parameter = target.binary_flat_parameter();
+    if (source_binary_flat_parameter.dimension() != target_binary_flat_parameter.dimension()) {
+      DINGO_LOG(INFO) << "source_binary_flat_parameter.dimension() != target_binary_flat_parameter.dimension()";
+      return butil::Status(pb::error::EMERGE_VECTOR_INDEX_PARAMETER_NOT_MATCH,
+                           "source_binary_flat_parameter.dimension() != target_binary_flat_parameter.dimension()");
+    }
+    if (source_binary_flat_parameter.metric_type() != target_binary_flat_parameter.metric_type()) {
+      DINGO_LOG(INFO) << "source_binary_flat_parameter.metric_type() != target_binary_flat_parameter.metric_type()";
+      return butil::Status(pb::error::EMERGE_VECTOR_INDEX_PARAMETER_NOT_MATCH,
+                           "source_binary_flat_parameter.metric_type() != target_binary_flat_parameter.metric_type()");
+    }
+    return butil::Status::OK();
+  } else if (source.vector_index_type() == pb::common::VectorIndexType::VECTOR_INDEX_TYPE_BINARY_IVF_FLAT) {
+    const auto& source_parameter = source.binary_ivf_flat_parameter();
+    const auto& target_parameter = target.binary_ivf_flat_parameter();
+    if (source_parameter.dimension() != target_parameter.dimension()) {
+      DINGO_LOG(INFO) << "source_binary_ivf_flat_parameter.dimension() != target_binary_ivf_flat_parameter.dimension()";
+      return butil::Status(
+          pb::error::EMERGE_VECTOR_INDEX_PARAMETER_NOT_MATCH,
+          "source_binary_ivf_flat_parameter.dimension() != target_binary_ivf_flat_parameter.dimension()");
+    }
+    if (source_parameter.metric_type() != target_parameter.metric_type()) {
+      DINGO_LOG(INFO)
+          << "source_binary_ivf_flat_parameter.metric_type() != target_binary_ivf_flat_parameter.metric_type()";
+      return butil::Status(
+          pb::error::EMERGE_VECTOR_INDEX_PARAMETER_NOT_MATCH,
+          "source_binary_ivf_flat_parameter.metric_type() != target_binary_ivf_flat_parameter.metric_type()");
+    }
+    if (source_parameter.ncentroids() != target_parameter.ncentroids()) {
+      DINGO_LOG(INFO)
+          << "source_binary_ivf_flat_parameter.ncentroids() != target_binary_ivf_flat_parameter.ncentroids()";
+      return butil::Status(
+          pb::error::EMERGE_VECTOR_INDEX_PARAMETER_NOT_MATCH,
+          "source_binary_ivf_flat_parameter.ncentroids() != target_binary_ivf_flat_parameter.ncentroids()");
+    }
+    return butil::Status::OK();
   } else {
     DINGO_LOG(ERROR) << "source.vector_index_type() is not supported";
     return butil::Status(pb::error::EMERGE_VECTOR_INDEX_TYPE_NOT_MATCH, "source.vector_index_type() is not supported");
   }
 }
 
+static pb::common::MetricType GetMetricTypeFromParameter(const pb::common::VectorIndexParameter& parameter) {
+  switch (parameter.vector_index_parameter_case()) {
+    case pb::common::VectorIndexParameter::kFlatParameter:
+      return parameter.flat_parameter().metric_type();
+    case pb::common::VectorIndexParameter::kIvfFlatParameter:
+      return parameter.ivf_flat_parameter().metric_type();
+    case pb::common::VectorIndexParameter::kIvfPqParameter:
+      return parameter.ivf_pq_parameter().metric_type();
+    case pb::common::VectorIndexParameter::kHnswParameter:
+      return parameter.hnsw_parameter().metric_type();
+    case pb::common::VectorIndexParameter::kDiskannParameter:
+      return parameter.diskann_parameter().metric_type();
+    case pb::common::VectorIndexParameter::kBruteforceParameter:
+      return parameter.bruteforce_parameter().metric_type();
+    case pb::common::VectorIndexParameter::kBinaryFlatParameter:
+      return parameter.binary_flat_parameter().metric_type();
+    case pb::common::VectorIndexParameter::kBinaryIvfFlatParameter:
+      return parameter.binary_ivf_flat_parameter().metric_type();
+    default:
+      return pb::common::METRIC_TYPE_NONE;
+  }
+}
+
 // validate vector index parameter
 // in: vector_index_parameter
 // return: errno
@@ -681,6 +1125,14 @@ butil::Status VectorIndexUtils::ValidateVectorIndexParameter(
     return butil::Status(pb::error::Errno::EILLEGAL_PARAMTETERS, "vector_index_parameter.index_type is NONE");
   }
 
+  // hamming is only for binary vector
+  if (!IsBinaryVectorIndexType(vector_index_parameter.vector_index_type()) &&
+      GetMetricTypeFromParameter(vector_index_parameter) == pb::common::METRIC_TYPE_HAMMING) {
+    DINGO_LOG(ERROR) << "METRIC_TYPE_HAMMING only support binary vector index";
+    return butil::Status(pb::error::Errno::EILLEGAL_PARAMTETERS,
+                         "METRIC_TYPE_HAMMING only support binary vector index");
+  }
+
   // if vector_index_type is HNSW, check hnsw_parameter is set
   if (vector_index_parameter.vector_index_type() == pb::common::VectorIndexType::VECTOR_INDEX_TYPE_HNSW) {
     if (!vector_index_parameter.has_hnsw_parameter()) {
@@ -739,6 +1191,14 @@ butil::Status VectorIndexUtils::ValidateVectorIndexParameter(
       return butil::Status(pb::error::Errno::EILLEGAL_PARAMTETERS,
                            "hnsw_parameter.nlinks is illegal " + std::to_string(hnsw_parameter.nlinks()));
     }
+
+    // check hnsw_parameter.quantizer_type
+    // SQ8 and FP16 store codes in the graph, rerank_factor is only a hint for search, no need to check.
+    if (!pb::common::HnswQuantizerType_IsValid(hnsw_parameter.quantizer_type())) {
+      DINGO_LOG(ERROR) << "hnsw_parameter.quantizer_type is illegal " << hnsw_parameter.quantizer_type();
+      return butil::Status(pb::error::Errno::EILLEGAL_PARAMTETERS, "hnsw_parameter.quantizer_type is illegal " +
+                                                                       std::to_string(hnsw_parameter.quantizer_type()));
+    }
   }
 
   // if vector_index_type is FLAT, check flat_parameter is set
@@ -954,6 +1414,52 @@ butil::Status VectorIndexUtils::ValidateVectorIndexParameter(
     return butil::Status::OK();
   }
 
+  // if vector_index_type is BINARY_FLAT or BINARY_IVF_FLAT, check the binary parameter is set
+  if (vector_index_parameter.vector_index_type() == pb::common::VectorIndexType::VECTOR_INDEX_TYPE_BINARY_FLAT ||
+      vector_index_parameter.vector_index_type() == pb::common::VectorIndexType::VECTOR_INDEX_TYPE_BINARY_IVF_FLAT) {
+    uint32_t dimension = 0;
+    pb::common::MetricType metric_type = pb::common::METRIC_TYPE_NONE;
+    if (vector_index_parameter.has_binary_flat_parameter()) {
+      dimension = vector_index_parameter.binary_flat_parameter().dimension();
+      metric_type = vector_index_parameter.binary_flat_parameter().metric_type();
+    } else if (vector_index_parameter.has_binary_ivf_flat_parameter()) {
+      dimension = vector_index_parameter.binary_ivf_flat_parameter().dimension();
+      metric_type = vector_index_parameter.binary_ivf_flat_parameter().metric_type();
+
+      // check binary_ivf_flat_parameter.ncentroids, same as ivf flat
+      if (vector_index_parameter.binary_ivf_flat_parameter().ncentroids() <= 0) {
+        std::string s = fmt::format("binary_ivf_flat_parameter.ncentroids is illegal : {}  default : {}",
+                                    vector_index_parameter.binary_ivf_flat_parameter().ncentroids(),
+                                    Constant::kCreateIvfFlatParamNcentroids);
+        DINGO_LOG(ERROR) << s;
+        return butil::Status(pb::error::Errno::EILLEGAL_PARAMTETERS, s);
+      }
+    } else {
+      DINGO_LOG(ERROR) << "vector_index_type is BINARY, but binary parameter is not set";
+      return butil::Status(pb::error::Errno::EILLEGAL_PARAMTETERS,
+                           "vector_index_type is BINARY, but binary parameter is not set");
+    }
+
+    // check dimension
+    // The dimension is the number of bits, it must be a multiple of 8.
+    if (dimension <= 0 || dimension > Constant::kVectorMaxDimension * 8 || dimension % 8 != 0) {
+      DINGO_LOG(ERROR) << "binary parameter dimension is illegal " << dimension;
+      return butil::Status(pb::error::Errno::EILLEGAL_PARAMTETERS,
+                           "binary parameter dimension is illegal " + std::to_string(dimension));
+    }
+
+    // check metric_type
+    // Binary vector only support hamming distance.
+    if (metric_type != pb::common::METRIC_TYPE_HAMMING) {
+      DINGO_LOG(ERROR) << "binary parameter metric_type is illegal " << metric_type;
+      return butil::Status(pb::error::Errno::EILLEGAL_PARAMTETERS,
+                           "binary parameter metric_type is illegal " + std::to_string(metric_type));
+    }
+
+    // If all checks pass, return a butil::Status object with no error.
+    return butil::Status::OK();
+  }
+
   return butil::Status::OK();
 }
 
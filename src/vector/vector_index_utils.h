@@ -17,11 +17,13 @@
 
 #include <cstdint>
 #include <memory>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
 #include "butil/status.h"
 #include "faiss/Index.h"
+#include "faiss/IndexIVF.h"
 #include "faiss/impl/AuxIndexStructures.h"
 #include "proto/index.pb.h"
 
@@ -110,6 +112,14 @@ class VectorIndexUtils {
       std::vector<::dingodb::pb::common::Vector>& result_op_left_vectors,
       std::vector<::dingodb::pb::common::Vector>& result_op_right_vectors);
 
+  // hamming distance of binary vector, same for faiss and hnswlib
+  static butil::Status CalcHammingDistance(
+      const google::protobuf::RepeatedPtrField<::dingodb::pb::common::Vector>& op_left_vectors,
+      const google::protobuf::RepeatedPtrField<::dingodb::pb::common::Vector>& op_right_vectors,
+      bool is_return_normlize, std::vector<std::vector<float>>& distances,
+      std::vector<::dingodb::pb::common::Vector>& result_op_left_vectors,
+      std::vector<::dingodb::pb::common::Vector>& result_op_right_vectors);
+
   // internal api
 
   static butil::Status DoCalcL2DistanceByFaiss(const ::dingodb::pb::common::Vector& op_left_vectors,
@@ -147,6 +157,12 @@ class VectorIndexUtils {
                                                      dingodb::pb::common::Vector& result_op_left_vectors,
                                                      dingodb::pb::common::Vector& result_op_right_vectors);
 
+  static butil::Status DoCalcHammingDistance(const ::dingodb::pb::common::Vector& op_left_vectors,
+                                             const ::dingodb::pb::common::Vector& op_right_vectors,
+                                             bool is_return_normlize, float& distance,
+                                             dingodb::pb::common::Vector& result_op_left_vectors,
+                                             dingodb::pb::common::Vector& result_op_right_vectors);
+
   static void ResultOpVectorAssignment(dingodb::pb::common::Vector& result_op_vectors,
                                        const ::dingodb::pb::common::Vector& op_vectors);
 
@@ -170,6 +186,54 @@ class VectorIndexUtils {
   static std::pair<std::unique_ptr<float[]>, butil::Status> CheckAndCopyVectorData(
       const std::vector<pb::common::VectorWithId>& vector_with_ids, faiss::idx_t dimension, bool normalize);
 
+  // binary vector, dimension is the number of bits, the bytes are the concatenation of binary_values.
+  static bool IsBinaryVectorIndexType(pb::common::VectorIndexType vector_index_type);
+
+  static size_t BinaryVectorSize(const pb::common::Vector& vector);
+
+  static void CopyBinaryVector(const pb::common::Vector& vector, uint8_t* dest);
+
+  static std::pair<std::unique_ptr<faiss::idx_t[]>, butil::Status> CheckAndCopyBinaryVectorId(
+      const std::vector<pb::common::VectorWithId>& vector_with_ids, faiss::idx_t dimension);
+
+  static std::pair<std::unique_ptr<uint8_t[]>, butil::Status> CheckAndCopyBinaryVectorData(
+      const std::vector<pb::common::VectorWithId>& vector_with_ids, faiss::idx_t dimension);
+
+  static int32_t HammingDistance(const uint8_t* left, const uint8_t* right, size_t code_size);
+
+  // faiss read index io flags, mmap the inverted lists of ivf index when enable vector_index_load_mmap.
+  static int FaissReadIndexIoFlags();
+
+  // The mmap inverted lists is read only, copy it to memory before modify the ivf index.
+  // Return true when copied.
+  static bool MaterializeInvertedLists(faiss::IndexIVF* index);
+
+  // Ivf index delete vector by tombstone, purge them from the inverted lists when the deleted ratio is high.
+  static bool NeedPurgeTombstones(int64_t tombstone_count, int64_t total_count);
+  // Remove the tombstone vectors from the inverted lists and vector_ids, clear the tombstones,
+  // return the removed count.
+  static size_t PurgeTombstones(faiss::IndexIVF* index, std::unordered_set<int64_t>& tombstones,
+                                std::unordered_set<int64_t>& vector_ids);
+  // Return the ids of the inverted lists, only the ids of the lists are scanned, the codes are not touched.
+  static std::unordered_set<int64_t> GetIvfIds(faiss::IndexIVF* index);
+
+  // Retrain the ivf index on the train sample when it was trained with too few vectors,
+  // e.g. the first batch of vector add, and the sample has grown enough.
+  static bool NeedRetrainOnSample(int64_t train_data_size, int64_t train_sample_count, int64_t nlist,
+                                  int64_t train_sample_capacity);
+  // Retrain the ivf index when the inverted lists are imbalanced by the data distribution drift.
+  static bool NeedRetrainOnImbalance(faiss::IndexIVF* index, int64_t train_time_ms, int32_t retrain_num);
+
+  // Copy the centroids and the live entries with id in [begin_vector_id, end_vector_id) of the trained source to
+  // the target, the target has the same nlist and code size but not trained, the codes are copied without re-encode.
+  static butil::Status DeriveIvfIndex(faiss::IndexIVF* index, int64_t begin_vector_id, int64_t end_vector_id,
+                                      const std::unordered_set<int64_t>& tombstones, faiss::IndexIVF* target_index);
+
+  static butil::Status FillBinarySearchResult(const std::vector<pb::common::VectorWithId>& vector_with_ids,
+                                              uint32_t topk, const std::vector<int32_t>& distances,
+                                              const std::vector<faiss::idx_t>& labels, faiss::idx_t dimension,
+                                              std::vector<pb::index::VectorWithDistanceResult>& results);
+
   static butil::Status FillSearchResult(const std::vector<pb::common::VectorWithId>& vector_with_ids, uint32_t topk,
                                         const std::vector<faiss::Index::distance_t>& distances,
                                         const std::vector<faiss::idx_t>& labels, pb::common::MetricType metric_type,
@@ -14,13 +14,17 @@
 
 #include "vector/vector_reader.h"
 
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include "butil/status.h"
+#include "bvar/reducer.h"
 #include "common/constant.h"
 #include "common/helper.h"
 #include "coprocessor/coprocessor_v2.h"
@@ -30,6 +34,7 @@
 #include "proto/error.pb.h"
 #include "vector/codec.h"
 #include "vector/vector_index.h"
+#include "vector/vector_index_binary_flat.h"
 #include "vector/vector_index_flat.h"
 
 namespace dingodb {
@@ -41,9 +46,15 @@ namespace dingodb {
 
 DEFINE_int64(vector_index_max_range_search_result_count, 1024, "max range search result count");
 DEFINE_int64(vector_index_bruteforce_batch_count, 2048, "bruteforce batch count");
+DEFINE_int64(vector_scalar_post_filter_init_expand_times, 4,
+             "scalar post filter search top_n * init_expand_times candidates at first");
+DEFINE_int64(vector_scalar_post_filter_max_expand_times, 100,
+             "scalar post filter search at most top_n * max_expand_times candidates");
 
 bvar::LatencyRecorder g_bruteforce_search_latency("dingo_bruteforce_search_latency");
 bvar::LatencyRecorder g_bruteforce_range_search_latency("dingo_bruteforce_range_search_latency");
+bvar::LatencyRecorder g_vector_rerank_latency("dingo_vector_rerank_latency");
+bvar::Adder<int64_t> g_vector_scalar_post_filter_expand_count("dingo_vector_scalar_post_filter_expand_count");
 
 butil::Status VectorReader::QueryVectorWithId(const pb::common::Range& region_range, int64_t partition_id,
                                               int64_t vector_id, bool with_vector_data,
@@ -83,13 +94,11 @@ butil::Status VectorReader::SearchVector(
   auto vector_filter_type = parameter.vector_filter_type();
 
   bool with_vector_data = !(parameter.without_vector_data());
-  std::vector<pb::index::VectorWithDistanceResult> tmp_results;
 
   // scalar post filter
   if (dingodb::pb::common::VectorFilter::SCALAR_FILTER == vector_filter &&
       dingodb::pb::common::VectorFilterType::QUERY_POST == vector_filter_type) {
     uint32_t top_n = parameter.top_n();
-    bool enable_range_search = parameter.enable_range_search();
 
     if (BAIDU_UNLIKELY(vector_with_ids[0].scalar_data().scalar_data_size() == 0)) {
       butil::Status status = VectorReader::SearchAndRangeSearchWrapper(
@@ -100,39 +109,12 @@ butil::Status VectorReader::SearchVector(
       }
 
     } else {
-      top_n *= 10;
-      butil::Status status = VectorReader::SearchAndRangeSearchWrapper(vector_index, region_range, vector_with_ids,
-                                                                       parameter, tmp_results, top_n, {});
+      butil::Status status = DoVectorSearchForScalarPostFilter(
+          partition_id, vector_index, region_range, vector_with_ids, parameter, vector_with_distance_results);
       if (!status.ok()) {
-        DINGO_LOG(ERROR) << status.error_cstr();
+        DINGO_LOG(ERROR) << fmt::format("DoVectorSearchForScalarPostFilter failed, error: {}", status.error_str());
         return status;
       }
-
-      for (auto& vector_with_distance_result : tmp_results) {
-        pb::index::VectorWithDistanceResult new_vector_with_distance_result;
-
-        for (auto& temp_vector_with_distance : *vector_with_distance_result.mutable_vector_with_distances()) {
-          int64_t temp_id = temp_vector_with_distance.vector_with_id().id();
-          bool compare_result = false;
-          butil::Status status = CompareVectorScalarData(region_range, partition_id, temp_id,
-                                                         vector_with_ids[0].scalar_data(), compare_result);
-          if (!status.ok()) {
-            return status;
-          }
-          if (!compare_result) {
-            continue;
-          }
-
-          new_vector_with_distance_result.add_vector_with_distances()->Swap(&temp_vector_with_distance);
-          // topk
-          if (!enable_range_search) {
-            if (new_vector_with_distance_result.vector_with_distances_size() >= parameter.top_n()) {
-              break;
-            }
-          }
-        }
-        vector_with_distance_results.emplace_back(std::move(new_vector_with_distance_result));
-      }
     }
   } else if (dingodb::pb::common::VectorFilter::VECTOR_ID_FILTER == vector_filter) {  // vector id array search
     butil::Status status = DoVectorSearchForVectorIdPreFilter(vector_index, vector_with_ids, parameter, region_range,
@@ -306,20 +288,189 @@ butil::Status VectorReader::CompareVectorScalarData(const pb::common::Range& reg
     return butil::Status(pb::error::EINTERNAL, "Decode vector scalar data failed");
   }
 
+  compare_result = IsMatchVectorScalarData(source_scalar_data, vector_scalar);
+  return butil::Status();
+}
+
+bool VectorReader::IsMatchVectorScalarData(const pb::common::VectorScalardata& source_scalar_data,
+                                           const pb::common::VectorScalardata& vector_scalar) {
   for (const auto& [key, value] : source_scalar_data.scalar_data()) {
     auto it = vector_scalar.scalar_data().find(key);
     if (it == vector_scalar.scalar_data().end()) {
-      compare_result = false;
-      return butil::Status();
+      return false;
     }
 
-    compare_result = Helper::IsEqualVectorScalarValue(value, it->second);
-    if (!compare_result) {
-      return butil::Status();
+    if (!Helper::IsEqualVectorScalarValue(value, it->second)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+butil::Status VectorReader::BatchCompareVectorScalarData(
+    const pb::common::Range& region_range, int64_t partition_id,
+    const std::vector<pb::index::VectorWithDistanceResult>& vector_with_distance_results,
+    const pb::common::VectorScalardata& source_scalar_data, std::unordered_map<int64_t, bool>& compare_results) {
+  // only fetch the ones not compared yet
+  std::vector<int64_t> vector_ids;
+  std::vector<std::string> keys;
+  for (const auto& result : vector_with_distance_results) {
+    for (const auto& vector_with_distance : result.vector_with_distances()) {
+      int64_t vector_id = vector_with_distance.vector_with_id().id();
+      if (!compare_results.emplace(vector_id, false).second) {
+        continue;
+      }
+
+      std::string key;
+      VectorCodec::EncodeVectorKey(region_range.start_key()[0], partition_id, vector_id, key);
+      vector_ids.push_back(vector_id);
+      keys.push_back(std::move(key));
+    }
+  }
+
+  if (keys.empty()) {
+    return butil::Status();
+  }
+
+  std::vector<std::string> values;
+  auto status = reader_->KvBatchGet(Constant::kVectorScalarCF, keys, values);
+  if (!status.ok()) {
+    DINGO_LOG(WARNING) << fmt::format("Batch get vector scalar data failed, count: {} error: {}", keys.size(),
+                                      status.error_str());
+    return status;
+  }
+
+  for (size_t i = 0; i < vector_ids.size(); ++i) {
+    // not exist scalar data, not match
+    if (values[i].empty()) {
+      continue;
+    }
+
+    pb::common::VectorScalardata vector_scalar;
+    if (!vector_scalar.ParseFromString(values[i])) {
+      return butil::Status(pb::error::EINTERNAL, "Decode vector scalar data failed");
+    }
+
+    compare_results[vector_ids[i]] = IsMatchVectorScalarData(source_scalar_data, vector_scalar);
+  }
+
+  return butil::Status();
+}
+
+butil::Status VectorReader::DoVectorSearchForScalarPostFilter(
+    int64_t partition_id, VectorIndexWrapperPtr vector_index, pb::common::Range region_range,
+    const std::vector<pb::common::VectorWithId>& vector_with_ids, const pb::common::VectorSearchParameter& parameter,
+    std::vector<pb::index::VectorWithDistanceResult>& vector_with_distance_results) {
+  const auto& source_scalar_data = vector_with_ids[0].scalar_data();
+  uint32_t top_n = parameter.top_n();
+
+  // vector id -> scalar matched or not, shared by all queries and rounds.
+  std::unordered_map<int64_t, bool> compare_results;
+
+  // range search is limited by radius, no need to expand.
+  if (parameter.enable_range_search()) {
+    std::vector<pb::index::VectorWithDistanceResult> tmp_results;
+    auto status =
+        SearchAndRangeSearchWrapper(vector_index, region_range, vector_with_ids, parameter, tmp_results, top_n, {});
+    if (!status.ok()) {
+      return status;
+    }
+
+    status = BatchCompareVectorScalarData(region_range, partition_id, tmp_results, source_scalar_data, compare_results);
+    if (!status.ok()) {
+      return status;
+    }
+
+    for (auto& tmp_result : tmp_results) {
+      auto& result = vector_with_distance_results.emplace_back();
+      for (auto& vector_with_distance : *tmp_result.mutable_vector_with_distances()) {
+        if (compare_results[vector_with_distance.vector_with_id().id()]) {
+          result.add_vector_with_distances()->Swap(&vector_with_distance);
+        }
+      }
+    }
+
+    return butil::Status();
+  }
+
+  int64_t max_candidate_count = static_cast<int64_t>(top_n) * FLAGS_vector_scalar_post_filter_max_expand_times;
+  int64_t candidate_count =
+      std::min(max_candidate_count, static_cast<int64_t>(top_n) * FLAGS_vector_scalar_post_filter_init_expand_times);
+
+  vector_with_distance_results.resize(vector_with_ids.size());
+
+  // the queries not get enough matched results
+  std::vector<size_t> pending_queries(vector_with_ids.size());
+  for (size_t i = 0; i < pending_queries.size(); ++i) {
+    pending_queries[i] = i;
+  }
+
+  while (!pending_queries.empty()) {
+    std::vector<pb::common::VectorWithId> queries;
+    queries.reserve(pending_queries.size());
+    for (auto query_index : pending_queries) {
+      queries.push_back(vector_with_ids[query_index]);
+    }
+
+    std::vector<pb::index::VectorWithDistanceResult> tmp_results;
+    auto status =
+        SearchAndRangeSearchWrapper(vector_index, region_range, queries, parameter, tmp_results, candidate_count, {});
+    if (!status.ok()) {
+      return status;
+    }
+
+    if (BAIDU_UNLIKELY(tmp_results.size() != queries.size())) {
+      return butil::Status(pb::error::EINTERNAL, fmt::format("Search result size({}) not match query size({})",
+                                                             tmp_results.size(), queries.size()));
     }
+
+    status = BatchCompareVectorScalarData(region_range, partition_id, tmp_results, source_scalar_data, compare_results);
+    if (!status.ok()) {
+      return status;
+    }
+
+    // the lowest pass ratio of the unsatisfied queries, used to estimate next candidate count.
+    double min_selectivity = 1.0;
+    std::vector<size_t> next_pending_queries;
+    for (size_t i = 0; i < tmp_results.size(); ++i) {
+      auto& result = vector_with_distance_results[pending_queries[i]];
+      result.Clear();
+
+      int64_t matched_count = 0;
+      auto* tmp_vector_with_distances = tmp_results[i].mutable_vector_with_distances();
+      for (auto& vector_with_distance : *tmp_vector_with_distances) {
+        if (!compare_results[vector_with_distance.vector_with_id().id()]) {
+          continue;
+        }
+
+        ++matched_count;
+        if (result.vector_with_distances_size() < top_n) {
+          result.add_vector_with_distances()->Swap(&vector_with_distance);
+        }
+      }
+
+      // index may have more candidates, search again with more ones.
+      if (result.vector_with_distances_size() < top_n && tmp_vector_with_distances->size() >= candidate_count &&
+          candidate_count < max_candidate_count) {
+        next_pending_queries.push_back(pending_queries[i]);
+        min_selectivity = std::min(min_selectivity, static_cast<double>(std::max(matched_count, int64_t(1))) /
+                                                        tmp_vector_with_distances->size());
+      }
+    }
+
+    if (next_pending_queries.empty()) {
+      break;
+    }
+
+    // expect top_n matched by the estimated selectivity, at least double the candidates.
+    int64_t estimate_count = static_cast<int64_t>(std::ceil(top_n / min_selectivity * 1.2));
+    candidate_count = std::min(max_candidate_count, std::max(candidate_count * 2, estimate_count));
+    pending_queries.swap(next_pending_queries);
+
+    g_vector_scalar_post_filter_expand_count << 1;
   }
 
-  compare_result = true;
   return butil::Status();
 }
 
@@ -1253,6 +1404,11 @@ butil::Status VectorReader::SetVectorIndexFilter(VectorIndexWrapperPtr vector_in
     } else {
       // do nothing
     }
+  } else if (vector_index->Type() == pb::common::VECTOR_INDEX_TYPE_DISKANN) {
+    filters.push_back(std::make_shared<VectorIndex::DiskAnnListFilterFunctor>(vector_ids));
+  } else if (vector_index->Type() == pb::common::VECTOR_INDEX_TYPE_BINARY_FLAT ||
+             vector_index->Type() == pb::common::VECTOR_INDEX_TYPE_BINARY_IVF_FLAT) {
+    filters.push_back(std::make_shared<VectorIndex::BinaryListFilterFunctor>(vector_ids));
   }
   return butil::Status::OK();
 }
@@ -1302,8 +1458,18 @@ butil::Status VectorReader::SearchAndRangeSearchWrapper(
         return status;
       }
     } else {
-      status = vector_index->Search(vector_with_ids, topk, region_range, filters, with_vector_data, parameter,
-                                    vector_with_distance_results);
+      // quantized hnsw only hold codes, search more candidates and re-rank them with the raw vectors.
+      uint32_t rerank_factor = 1;
+      if (vector_index->Type() == pb::common::VECTOR_INDEX_TYPE_HNSW) {
+        const auto& hnsw_parameter = vector_index->IndexParameter().hnsw_parameter();
+        if (hnsw_parameter.quantizer_type() != pb::common::HnswQuantizerType::HNSW_QUANTIZER_NONE &&
+            hnsw_parameter.rerank_factor() > 1) {
+          rerank_factor = hnsw_parameter.rerank_factor();
+        }
+      }
+
+      status = vector_index->Search(vector_with_ids, topk * rerank_factor, region_range, filters, with_vector_data,
+                                    parameter, vector_with_distance_results);
       if (status.error_code() == pb::error::Errno::EVECTOR_NOT_SUPPORT) {
         DINGO_LOG(INFO) << "Search vector index not support, try brute force, id: " << vector_index->Id();
         return BruteForceSearch(vector_index, vector_with_ids, topk, region_range, filters, with_vector_data, parameter,
@@ -1313,6 +1479,111 @@ butil::Status VectorReader::SearchAndRangeSearchWrapper(
                                         status.error_str());
         return status;
       }
+
+      if (rerank_factor > 1) {
+        status = ReRankSearchResult(vector_index, region_range, vector_with_ids, topk, with_vector_data,
+                                    vector_with_distance_results);
+        if (!status.ok()) {
+          DINGO_LOG(ERROR) << fmt::format("ReRank search result failed, error: {} {}", status.error_code(),
+                                          status.error_str());
+          return status;
+        }
+      }
+    }
+  }
+
+  return butil::Status::OK();
+}
+
+// Same distance semantic as hnswlib, l2 is squared l2, inner product and cosine are 1 - ip.
+static float CalcExactDistance(pb::common::MetricType metric_type,
+                               const google::protobuf::RepeatedField<float>& left_values,
+                               const google::protobuf::RepeatedField<float>& right_values) {
+  int dimension = std::min(left_values.size(), right_values.size());
+  if (metric_type == pb::common::MetricType::METRIC_TYPE_L2) {
+    float distance = 0.0f;
+    for (int i = 0; i < dimension; ++i) {
+      float diff = left_values[i] - right_values[i];
+      distance += diff * diff;
+    }
+    return distance;
+  }
+
+  float ip = 0.0f, left_norm = 0.0f, right_norm = 0.0f;
+  for (int i = 0; i < dimension; ++i) {
+    ip += left_values[i] * right_values[i];
+    left_norm += left_values[i] * left_values[i];
+    right_norm += right_values[i] * right_values[i];
+  }
+
+  if (metric_type == pb::common::MetricType::METRIC_TYPE_COSINE) {
+    float norm = std::sqrt(left_norm) * std::sqrt(right_norm);
+    ip = norm > 0.0f ? ip / norm : 0.0f;
+  }
+
+  return 1.0f - ip;
+}
+
+butil::Status VectorReader::ReRankSearchResult(VectorIndexWrapperPtr vector_index,
+                                               const pb::common::Range& region_range,
+                                               const std::vector<pb::common::VectorWithId>& vector_with_ids,
+                                               uint32_t topk, bool with_vector_data,
+                                               std::vector<pb::index::VectorWithDistanceResult>& results) {
+  BvarLatencyGuard bvar_guard(&g_vector_rerank_latency);
+
+  auto metric_type = vector_index->GetMetricType();
+  int64_t partition_id = VectorCodec::DecodePartitionId(region_range.start_key());
+
+  size_t row_count = std::min(results.size(), vector_with_ids.size());
+
+  // fetch the raw vectors of all candidates in one batch
+  std::vector<std::string> keys;
+  for (size_t row = 0; row < row_count; ++row) {
+    for (const auto& vector_with_distance : results[row].vector_with_distances()) {
+      int64_t vector_id = vector_with_distance.vector_with_id().id();
+      std::string key;
+      VectorCodec::EncodeVectorKey(region_range.start_key()[0], partition_id, vector_id, key);
+      keys.push_back(std::move(key));
+    }
+  }
+
+  std::vector<std::string> values;
+  auto status = reader_->KvBatchGet(Constant::kStoreDataCF, keys, values);
+  if (!status.ok()) {
+    DINGO_LOG(WARNING) << fmt::format("Batch get raw vector failed, count: {} error: {}", keys.size(),
+                                      status.error_str());
+    return status;
+  }
+
+  size_t pos = 0;
+  for (size_t row = 0; row < row_count; ++row) {
+    const auto& query_values = vector_with_ids[row].vector().float_values();
+    auto* vector_with_distances = results[row].mutable_vector_with_distances();
+
+    for (auto& vector_with_distance : *vector_with_distances) {
+      const auto& value = values[pos++];
+      if (value.empty()) {
+        return butil::Status(pb::error::EKEY_NOT_FOUND,
+                             fmt::format("Not found raw vector {}", vector_with_distance.vector_with_id().id()));
+      }
+
+      pb::common::Vector raw_vector;
+      if (!raw_vector.ParseFromString(value)) {
+        return butil::Status(pb::error::EINTERNAL, "Parse proto from string error");
+      }
+
+      vector_with_distance.set_distance(CalcExactDistance(metric_type, query_values, raw_vector.float_values()));
+      if (with_vector_data) {
+        vector_with_distance.mutable_vector_with_id()->mutable_vector()->Swap(&raw_vector);
+      }
+    }
+
+    std::sort(vector_with_distances->begin(), vector_with_distances->end(),
+              [](const pb::common::VectorWithDistance& lhs, const pb::common::VectorWithDistance& rhs) {
+                return lhs.distance() < rhs.distance();
+              });
+    if (vector_with_distances->size() > static_cast<int>(topk)) {
+      vector_with_distances->DeleteSubrange(topk, vector_with_distances->size() - topk);
     }
   }
 
@@ -1347,6 +1618,24 @@ bool operator>(const DistanceResult& result1, const DistanceResult& result2) {
   }
 }
 
+// Binary vector is scanned by binary flat index, others by flat index.
+static std::shared_ptr<VectorIndex> NewBruteForceIndex(pb::common::MetricType metric_type, int32_t dimension,
+                                                       const pb::common::RegionEpoch& epoch,
+                                                       const pb::common::Range& region_range) {
+  pb::common::VectorIndexParameter index_parameter;
+  if (metric_type == pb::common::MetricType::METRIC_TYPE_HAMMING) {
+    index_parameter.set_vector_index_type(pb::common::VectorIndexType::VECTOR_INDEX_TYPE_BINARY_FLAT);
+    index_parameter.mutable_binary_flat_parameter()->set_dimension(dimension);
+    index_parameter.mutable_binary_flat_parameter()->set_metric_type(metric_type);
+    return std::make_shared<VectorIndexBinaryFlat>(INT64_MAX, index_parameter, epoch, region_range);
+  }
+
+  index_parameter.set_vector_index_type(pb::common::VectorIndexType::VECTOR_INDEX_TYPE_FLAT);
+  index_parameter.mutable_flat_parameter()->set_dimension(dimension);
+  index_parameter.mutable_flat_parameter()->set_metric_type(metric_type);
+  return std::make_shared<VectorIndexFlat>(INT64_MAX, index_parameter, epoch, region_range);
+}
+
 // ScanData from raw engine, build vector index and search
 butil::Status VectorReader::BruteForceSearch(VectorIndexWrapperPtr vector_index,
                                              std::vector<pb::common::VectorWithId> vector_with_ids, uint32_t topk,
@@ -1358,9 +1647,6 @@ butil::Status VectorReader::BruteForceSearch(VectorIndexWrapperPtr vector_index,
   auto dimension = vector_index->GetDimension();
 
   pb::common::RegionEpoch epoch;
-  pb::common::VectorIndexParameter index_parameter;
-  index_parameter.mutable_flat_parameter()->set_dimension(dimension);
-  index_parameter.mutable_flat_parameter()->set_metric_type(metric_type);
 
   IteratorOptions options;
   options.lower_bound = region_range.start_key();
@@ -1404,7 +1690,7 @@ butil::Status VectorReader::BruteForceSearch(VectorIndexWrapperPtr vector_index,
     vector_with_id_batch.push_back(vector_with_id);
 
     if (vector_with_id_batch.size() == FLAGS_vector_index_bruteforce_batch_count) {
-      auto flat_index = std::make_shared<VectorIndexFlat>(INT64_MAX, index_parameter, epoch, region_range);
+      auto flat_index = NewBruteForceIndex(metric_type, dimension, epoch, region_range);
       if (flat_index == nullptr) {
         DINGO_LOG(FATAL) << "flat_index is nullptr";
       }
@@ -1449,7 +1735,7 @@ butil::Status VectorReader::BruteForceSearch(VectorIndexWrapperPtr vector_index,
   }
 
   if (!vector_with_id_batch.empty()) {
-    auto flat_index = std::make_shared<VectorIndexFlat>(INT64_MAX, index_parameter, epoch, region_range);
+    auto flat_index = NewBruteForceIndex(metric_type, dimension, epoch, region_range);
     if (flat_index == nullptr) {
       DINGO_LOG(FATAL) << "flat_index is nullptr";
     }
@@ -1519,9 +1805,6 @@ butil::Status VectorReader::BruteForceRangeSearch(VectorIndexWrapperPtr vector_i
   auto dimension = vector_index->GetDimension();
 
   pb::common::RegionEpoch epoch;
-  pb::common::VectorIndexParameter index_parameter;
-  index_parameter.mutable_flat_parameter()->set_dimension(dimension);
-  index_parameter.mutable_flat_parameter()->set_metric_type(metric_type);
 
   IteratorOptions options;
   options.lower_bound = region_range.start_key();
@@ -1565,7 +1848,7 @@ butil::Status VectorReader::BruteForceRangeSearch(VectorIndexWrapperPtr vector_i
     vector_with_id_batch.push_back(vector_with_id);
 
     if (vector_with_id_batch.size() == FLAGS_vector_index_bruteforce_batch_count) {
-      auto flat_index = std::make_shared<VectorIndexFlat>(INT64_MAX, index_parameter, epoch, region_range);
+      auto flat_index = NewBruteForceIndex(metric_type, dimension, epoch, region_range);
       if (flat_index == nullptr) {
         DINGO_LOG(FATAL) << "flat_index is nullptr";
       }
@@ -1610,7 +1893,7 @@ butil::Status VectorReader::BruteForceRangeSearch(VectorIndexWrapperPtr vector_i
   }
 
   if (!vector_with_id_batch.empty()) {
-    auto flat_index = std::make_shared<VectorIndexFlat>(INT64_MAX, index_parameter, epoch, region_range);
+    auto flat_index = NewBruteForceIndex(metric_type, dimension, epoch, region_range);
     if (flat_index == nullptr) {
       DINGO_LOG(FATAL) << "flat_index is nullptr";
     }
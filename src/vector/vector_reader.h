@@ -19,6 +19,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
 #include "butil/status.h"
@@ -82,6 +83,15 @@ class VectorReader {
   butil::Status CompareVectorScalarData(const pb::common::Range& region_range, int64_t partition_id, int64_t vector_id,
                                         const pb::common::VectorScalardata& source_scalar_data, bool& compare_result);
 
+  // Compare the scalar data of all the result vectors by one batch get, skip the ones already in compare_results.
+  butil::Status BatchCompareVectorScalarData(
+      const pb::common::Range& region_range, int64_t partition_id,
+      const std::vector<pb::index::VectorWithDistanceResult>& vector_with_distance_results,
+      const pb::common::VectorScalardata& source_scalar_data, std::unordered_map<int64_t, bool>& compare_results);
+
+  static bool IsMatchVectorScalarData(const pb::common::VectorScalardata& source_scalar_data,
+                                      const pb::common::VectorScalardata& vector_scalar);
+
   butil::Status QueryVectorTableData(const pb::common::Range& region_range, int64_t partition_id,
                                      pb::common::VectorWithId& vector_with_id);
   butil::Status QueryVectorTableData(const pb::common::Range& region_range, int64_t partition_id,
@@ -97,6 +107,12 @@ class VectorReader {
       const pb::common::VectorSearchParameter& parameter, const pb::common::Range& region_range,
       std::vector<pb::index::VectorWithDistanceResult>& vector_with_distance_results);
 
+  // Search candidates then filter by scalar, expand the candidates until top_n matched or reach the limit.
+  butil::Status DoVectorSearchForScalarPostFilter(
+      int64_t partition_id, VectorIndexWrapperPtr vector_index, pb::common::Range region_range,
+      const std::vector<pb::common::VectorWithId>& vector_with_ids, const pb::common::VectorSearchParameter& parameter,
+      std::vector<pb::index::VectorWithDistanceResult>& vector_with_distance_results);
+
   butil::Status DoVectorSearchForScalarPreFilter(
       VectorIndexWrapperPtr vector_index, pb::common::Range region_range,
       const std::vector<pb::common::VectorWithId>& vector_with_ids, const pb::common::VectorSearchParameter& parameter,
@@ -141,6 +157,12 @@ class VectorReader {
       std::vector<pb::index::VectorWithDistanceResult>& vector_with_distance_results, uint32_t topk,  // NOLINT
       std::vector<std::shared_ptr<VectorIndex::FilterFunctor>> filters);
 
+  // Re-rank the candidates of quantized index with the raw vectors, keep topk of each result.
+  butil::Status ReRankSearchResult(VectorIndexWrapperPtr vector_index, const pb::common::Range& region_range,
+                                   const std::vector<pb::common::VectorWithId>& vector_with_ids, uint32_t topk,
+                                   bool with_vector_data,
+                                   std::vector<pb::index::VectorWithDistanceResult>& results);  // NOLINT
+
   butil::Status BruteForceSearch(VectorIndexWrapperPtr vector_index,
                                  std::vector<pb::common::VectorWithId> vector_with_ids, uint32_t topk,
                                  const pb::common::Range& region_range,
@@ -0,0 +1,196 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "vector/vector_search_coalescer.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bthread/bthread.h"
+#include "butil/status.h"
+#include "bvar/latency_recorder.h"
+#include "bvar/recorder.h"
+#include "bvar/reducer.h"
+#include "common/helper.h"
+#include "common/logging.h"
+#include "common/synchronization.h"
+#include "fmt/core.h"
+#include "gflags/gflags.h"
+#include "proto/error.pb.h"
+
+namespace dingodb {
+
+DEFINE_int64(vector_search_coalesce_window_us, 200, "vector search coalesce wait window, unit us");
+DEFINE_int64(vector_search_coalesce_max_batch_size, 512, "vector search coalesce max query vector count of one batch");
+
+bvar::LatencyRecorder g_vector_search_coalesce_queue_latency("dingo_vector_search_coalesce_queue_latency");
+bvar::IntRecorder g_vector_search_coalesce_batch_request_count("dingo_vector_search_coalesce_batch_request_count");
+bvar::IntRecorder g_vector_search_coalesce_batch_vector_count("dingo_vector_search_coalesce_batch_vector_count");
+bvar::Adder<int64_t> g_vector_search_coalesce_batch_total("dingo_vector_search_coalesce_batch_total");
+
+struct VectorSearchCoalescer::Request {
+  const std::vector<pb::common::VectorWithId>* vector_with_ids{nullptr};
+  std::vector<pb::index::VectorWithDistanceResult>* results{nullptr};
+  butil::Status status;
+  // leader notify follower when the batch is done.
+  BthreadCond cond{1};
+  int64_t enqueue_time_us{0};
+};
+
+struct VectorSearchCoalescer::Batch {
+  // the first one is the leader
+  std::vector<Request*> requests;
+  size_t vector_count{0};
+};
+
+VectorSearchCoalescer::VectorSearchCoalescer() { bthread_mutex_init(&mutex_, nullptr); }
+
+VectorSearchCoalescer::~VectorSearchCoalescer() { bthread_mutex_destroy(&mutex_); }
+
+bool VectorSearchCoalescer::IsSupportCoalesce(pb::common::VectorIndexType vector_index_type) {
+  switch (vector_index_type) {
+    case pb::common::VectorIndexType::VECTOR_INDEX_TYPE_FLAT:
+    case pb::common::VectorIndexType::VECTOR_INDEX_TYPE_IVF_FLAT:
+    case pb::common::VectorIndexType::VECTOR_INDEX_TYPE_IVF_PQ:
+    case pb::common::VectorIndexType::VECTOR_INDEX_TYPE_BRUTEFORCE:
+    case pb::common::VectorIndexType::VECTOR_INDEX_TYPE_BINARY_FLAT:
+    case pb::common::VectorIndexType::VECTOR_INDEX_TYPE_BINARY_IVF_FLAT:
+      return true;
+    default:
+      return false;
+  }
+}
+
+std::string VectorSearchCoalescer::GenCoalesceKey(uint32_t topk, bool reconstruct,
+                                                  const pb::common::VectorSearchParameter& parameter) {
+  // Only the parameters used by the vector index, other ones are handled by the caller per request.
+  pb::common::VectorSearchParameter index_parameter;
+  *index_parameter.mutable_flat() = parameter.flat();
+  *index_parameter.mutable_ivf_flat() = parameter.ivf_flat();
+  *index_parameter.mutable_ivf_pq() = parameter.ivf_pq();
+  *index_parameter.mutable_binary_ivf_flat() = parameter.binary_ivf_flat();
+
+  return fmt::format("{}_{}_{}", topk, reconstruct, index_parameter.SerializeAsString());
+}
+
+butil::Status VectorSearchCoalescer::Search(const std::string& key,
+                                            const std::vector<pb::common::VectorWithId>& vector_with_ids,
+                                            SearchFunc search_func,
+                                            std::vector<pb::index::VectorWithDistanceResult>& results) {
+  inflight_count_.fetch_add(1, std::memory_order_relaxed);
+  ScopeGuard guard([this]() { inflight_count_.fetch_sub(1, std::memory_order_relaxed); });
+
+  // No concurrent search or the request is big enough, waiting the window is pointless.
+  if (inflight_count_.load(std::memory_order_relaxed) <= 1 ||
+      vector_with_ids.size() >= static_cast<size_t>(FLAGS_vector_search_coalesce_max_batch_size)) {
+    return search_func(vector_with_ids, results);
+  }
+
+  Request request;
+  request.vector_with_ids = &vector_with_ids;
+  request.results = &results;
+  request.enqueue_time_us = Helper::TimestampUs();
+
+  BatchPtr batch;
+  bool is_leader = false;
+  {
+    BAIDU_SCOPED_LOCK(mutex_);
+    auto it = pending_batches_.find(key);
+    if (it != pending_batches_.end() &&
+        it->second->vector_count + vector_with_ids.size() <=
+            static_cast<size_t>(FLAGS_vector_search_coalesce_max_batch_size)) {
+      batch = it->second;
+      batch->requests.push_back(&request);
+      batch->vector_count += vector_with_ids.size();
+      // batch is full, stop collecting.
+      if (batch->vector_count >= static_cast<size_t>(FLAGS_vector_search_coalesce_max_batch_size)) {
+        pending_batches_.erase(it);
+      }
+    } else {
+      // replace the full one, its leader still execute it.
+      batch = std::make_shared<Batch>();
+      batch->requests.push_back(&request);
+      batch->vector_count = vector_with_ids.size();
+      pending_batches_[key] = batch;
+      is_leader = true;
+    }
+  }
+
+  if (!is_leader) {
+    request.cond.Wait();
+    return request.status;
+  }
+
+  bthread_usleep(FLAGS_vector_search_coalesce_window_us);
+
+  {
+    BAIDU_SCOPED_LOCK(mutex_);
+    auto it = pending_batches_.find(key);
+    if (it != pending_batches_.end() && it->second == batch) {
+      pending_batches_.erase(it);
+    }
+  }
+
+  ExecuteBatch(batch, search_func);
+
+  return request.status;
+}
+
+void VectorSearchCoalescer::ExecuteBatch(BatchPtr batch, SearchFunc& search_func) {
+  int64_t start_time_us = Helper::TimestampUs();
+
+  std::vector<pb::common::VectorWithId> vector_with_ids;
+  vector_with_ids.reserve(batch->vector_count);
+  for (auto* request : batch->requests) {
+    vector_with_ids.insert(vector_with_ids.end(), request->vector_with_ids->begin(), request->vector_with_ids->end());
+    g_vector_search_coalesce_queue_latency << (start_time_us - request->enqueue_time_us);
+  }
+
+  g_vector_search_coalesce_batch_request_count << batch->requests.size();
+  g_vector_search_coalesce_batch_vector_count << vector_with_ids.size();
+  g_vector_search_coalesce_batch_total << 1;
+
+  std::vector<pb::index::VectorWithDistanceResult> results;
+  auto status = search_func(vector_with_ids, results);
+  if (status.ok() && results.size() != vector_with_ids.size()) {
+    std::string s = fmt::format("coalesced search result size({}) not match query size({})", results.size(),
+                                vector_with_ids.size());
+    DINGO_LOG(ERROR) << s;
+    status = butil::Status(pb::error::EINTERNAL, s);
+  }
+
+  // split results back to every request by the query order
+  size_t offset = 0;
+  for (auto* request : batch->requests) {
+    size_t count = request->vector_with_ids->size();
+    if (status.ok()) {
+      request->results->reserve(request->results->size() + count);
+      for (size_t i = 0; i < count; ++i) {
+        request->results->push_back(std::move(results[offset + i]));
+      }
+    }
+    offset += count;
+    request->status = status;
+  }
+
+  // wake up followers, the leader is the first one.
+  for (size_t i = 1; i < batch->requests.size(); ++i) {
+    batch->requests[i]->cond.DecreaseSignal();
+  }
+}
+
+}  // namespace dingodb
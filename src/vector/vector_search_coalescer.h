@@ -0,0 +1,80 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DINGODB_VECTOR_SEARCH_COALESCER_H_  // NOLINT
+#define DINGODB_VECTOR_SEARCH_COALESCER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "bthread/mutex.h"
+#include "butil/status.h"
+#include "proto/common.pb.h"
+#include "proto/index.pb.h"
+
+namespace dingodb {
+
+// Coalesce concurrent searches of one region into one batched index search.
+// The first request of a batch is the leader, it waits a small window for compatible requests,
+// then searches all the query vectors at once and splits the results back to every request.
+// Only requests with the same coalesce key are compatible, see GenCoalesceKey.
+class VectorSearchCoalescer {
+ public:
+  using SearchFunc = std::function<butil::Status(const std::vector<pb::common::VectorWithId>& vector_with_ids,
+                                                 std::vector<pb::index::VectorWithDistanceResult>& results)>;
+
+  VectorSearchCoalescer();
+  ~VectorSearchCoalescer();
+
+  VectorSearchCoalescer(const VectorSearchCoalescer&) = delete;
+  const VectorSearchCoalescer& operator=(const VectorSearchCoalescer&) = delete;
+
+  static std::shared_ptr<VectorSearchCoalescer> New() { return std::make_shared<VectorSearchCoalescer>(); }
+
+  // Whether the index type benefits from batched search, e.g. flat/ivf use blas on large query batch.
+  static bool IsSupportCoalesce(pb::common::VectorIndexType vector_index_type);
+
+  // Requests with same topk/reconstruct/index search parameter can be merged.
+  static std::string GenCoalesceKey(uint32_t topk, bool reconstruct,
+                                    const pb::common::VectorSearchParameter& parameter);
+
+  // Search directly when there is no other concurrent search, else join or lead a batch.
+  butil::Status Search(const std::string& key, const std::vector<pb::common::VectorWithId>& vector_with_ids,
+                       SearchFunc search_func, std::vector<pb::index::VectorWithDistanceResult>& results);
+
+ private:
+  struct Request;
+  struct Batch;
+  using BatchPtr = std::shared_ptr<Batch>;
+
+  void ExecuteBatch(BatchPtr batch, SearchFunc& search_func);
+
+  // inflight search count, the window is only waited when there are concurrent searches.
+  std::atomic<int64_t> inflight_count_{0};
+
+  bthread_mutex_t mutex_;
+  // key: coalesce key, value: the batch is collecting requests.
+  std::map<std::string, BatchPtr> pending_batches_;
+};
+
+using VectorSearchCoalescerPtr = std::shared_ptr<VectorSearchCoalescer>;
+
+}  // namespace dingodb
+
+#endif  // DINGODB_VECTOR_SEARCH_COALESCER_H_  // NOLINT
@@ -0,0 +1,185 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Restart time benchmark of vector index snapshot load, heap load vs mmap load(vector_index_load_mmap).
+// e.g. ./dingodb_vector_index_bench --bench_index_type=ivf_flat --bench_vector_count=1000000 --bench_dimension=128
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "common/helper.h"
+#include "fmt/core.h"
+#include "gflags/gflags.h"
+#include "glog/logging.h"
+#include "proto/common.pb.h"
+#include "proto/index.pb.h"
+#include "vector/vector_index.h"
+#include "vector/vector_index_factory.h"
+
+DEFINE_string(bench_index_type, "ivf_flat", "vector index type, ivf_flat/ivf_pq/flat/hnsw");
+DEFINE_int64(bench_vector_count, 100000, "vector count of the index");
+DEFINE_int32(bench_dimension, 128, "vector dimension");
+DEFINE_int32(bench_ncentroids, 1024, "ivf centroid count");
+DEFINE_int32(bench_nsubvector, 16, "ivf pq sub vector count");
+DEFINE_int32(bench_repeat, 3, "load repeat times of each mode");
+DEFINE_string(bench_snapshot_path, "./vector_index_bench_snapshot", "snapshot path");
+
+namespace dingodb {
+
+DECLARE_bool(vector_index_load_mmap);
+
+static pb::common::VectorIndexParameter GenIndexParameter() {
+  pb::common::VectorIndexParameter index_parameter;
+  auto metric_type = pb::common::MetricType::METRIC_TYPE_L2;
+  if (FLAGS_bench_index_type == "ivf_pq") {
+    index_parameter.set_vector_index_type(pb::common::VectorIndexType::VECTOR_INDEX_TYPE_IVF_PQ);
+    auto* parameter = index_parameter.mutable_ivf_pq_parameter();
+    parameter->set_dimension(FLAGS_bench_dimension);
+    parameter->set_metric_type(metric_type);
+    parameter->set_ncentroids(FLAGS_bench_ncentroids);
+    parameter->set_nsubvector(FLAGS_bench_nsubvector);
+    parameter->set_nbits_per_idx(8);
+  } else if (FLAGS_bench_index_type == "flat") {
+    index_parameter.set_vector_index_type(pb::common::VectorIndexType::VECTOR_INDEX_TYPE_FLAT);
+    index_parameter.mutable_flat_parameter()->set_dimension(FLAGS_bench_dimension);
+    index_parameter.mutable_flat_parameter()->set_metric_type(metric_type);
+  } else if (FLAGS_bench_index_type == "hnsw") {
+    index_parameter.set_vector_index_type(pb::common::VectorIndexType::VECTOR_INDEX_TYPE_HNSW);
+    auto* parameter = index_parameter.mutable_hnsw_parameter();
+    parameter->set_dimension(FLAGS_bench_dimension);
+    parameter->set_metric_type(metric_type);
+    parameter->set_efconstruction(40);
+    parameter->set_max_elements(FLAGS_bench_vector_count);
+    parameter->set_nlinks(16);
+  } else {
+    index_parameter.set_vector_index_type(pb::common::VectorIndexType::VECTOR_INDEX_TYPE_IVF_FLAT);
+    index_parameter.mutable_ivf_flat_parameter()->set_dimension(FLAGS_bench_dimension);
+    index_parameter.mutable_ivf_flat_parameter()->set_metric_type(metric_type);
+    index_parameter.mutable_ivf_flat_parameter()->set_ncentroids(FLAGS_bench_ncentroids);
+  }
+  return index_parameter;
+}
+
+static std::shared_ptr<VectorIndex> NewVectorIndex(const pb::common::VectorIndexParameter& index_parameter) {
+  pb::common::RegionEpoch epoch;
+  epoch.set_conf_version(1);
+  epoch.set_version(1);
+  if (index_parameter.vector_index_type() == pb::common::VectorIndexType::VECTOR_INDEX_TYPE_HNSW) {
+    return VectorIndexFactory::NewHnsw(1, index_parameter, epoch, pb::common::Range(), nullptr);
+  }
+  return VectorIndexFactory::New(1, index_parameter, epoch, pb::common::Range());
+}
+
+static bool BuildSnapshot(const pb::common::VectorIndexParameter& index_parameter) {
+  auto vector_index = NewVectorIndex(index_parameter);
+  if (vector_index == nullptr) {
+    std::cerr << "new vector index failed" << '\n';
+    return false;
+  }
+
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<> distrib;
+  const int64_t batch_size = 10000;
+  for (int64_t start = 0; start < FLAGS_bench_vector_count; start += batch_size) {
+    std::vector<pb::common::VectorWithId> vector_with_ids;
+    for (int64_t id = start; id < std::min(start + batch_size, FLAGS_bench_vector_count); ++id) {
+      auto& vector_with_id = vector_with_ids.emplace_back();
+      vector_with_id.set_id(id + 1);
+      for (int i = 0; i < FLAGS_bench_dimension; ++i) {
+        vector_with_id.mutable_vector()->add_float_values(distrib(rng));
+      }
+    }
+
+    // train with the first batch
+    if (start == 0 && vector_index->NeedTrain()) {
+      auto status = vector_index->Train(vector_with_ids);
+      if (!status.ok()) {
+        std::cerr << fmt::format("train failed, error: {}", status.error_str()) << '\n';
+        return false;
+      }
+    }
+
+    auto status = vector_index->Add(vector_with_ids);
+    if (!status.ok()) {
+      std::cerr << fmt::format("add failed, error: {}", status.error_str()) << '\n';
+      return false;
+    }
+  }
+
+  auto status = vector_index->Save(FLAGS_bench_snapshot_path);
+  if (!status.ok()) {
+    std::cerr << fmt::format("save failed, error: {}", status.error_str()) << '\n';
+    return false;
+  }
+  return true;
+}
+
+// Load time plus the first search, the mmap load pages in the touched lists on the first search.
+static void BenchLoad(const pb::common::VectorIndexParameter& index_parameter, bool use_mmap) {
+  FLAGS_vector_index_load_mmap = use_mmap;
+
+  pb::common::VectorWithId query;
+  for (int i = 0; i < FLAGS_bench_dimension; ++i) {
+    query.mutable_vector()->add_float_values(0.5f);
+  }
+
+  for (int i = 0; i < FLAGS_bench_repeat; ++i) {
+    auto vector_index = NewVectorIndex(index_parameter);
+    int64_t start_time_us = Helper::TimestampUs();
+    auto status = vector_index->Load(FLAGS_bench_snapshot_path);
+    int64_t load_time_us = Helper::TimestampUs() - start_time_us;
+    if (!status.ok()) {
+      std::cerr << fmt::format("load failed, error: {}", status.error_str()) << '\n';
+      return;
+    }
+
+    std::vector<pb::index::VectorWithDistanceResult> results;
+    start_time_us = Helper::TimestampUs();
+    status = vector_index->Search({query}, 10, {}, false, {}, results);
+    int64_t search_time_us = Helper::TimestampUs() - start_time_us;
+    if (!status.ok()) {
+      std::cerr << fmt::format("search failed, error: {}", status.error_str()) << '\n';
+      return;
+    }
+
+    std::cout << fmt::format("{} {} load: {}us first search: {}us", FLAGS_bench_index_type, use_mmap ? "mmap" : "heap",
+                             load_time_us, search_time_us)
+              << '\n';
+  }
+}
+
+}  // namespace dingodb
+
+int main(int argc, char* argv[]) {
+  google::ParseCommandLineFlags(&argc, &argv, true);
+  FLAGS_minloglevel = google::GLOG_ERROR;
+  google::InitGoogleLogging(argv[0]);
+
+  auto index_parameter = dingodb::GenIndexParameter();
+  if (!dingodb::BuildSnapshot(index_parameter)) {
+    return -1;
+  }
+
+  dingodb::BenchLoad(index_parameter, false);
+  // flat and hnsw snapshot is always loaded to heap, the mmap flag is ignored.
+  dingodb::BenchLoad(index_parameter, true);
+
+  dingodb::Helper::RemoveAllFileOrDirectory(FLAGS_bench_snapshot_path);
+  return 0;
+}
@@ -12,18 +12,24 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "butil/iobuf.h"
+#include "common/packed_kv.h"
 #include "mock_region_scanner.h"
 #include "proto/error.pb.h"
 #include "sdk/client.h"
 #include "sdk/common/common.h"
 #include "sdk/common/param_config.h"
 #include "sdk/rawkv/region_scanner_impl.h"
+#include "sdk/rawkv/region_stream_scanner_impl.h"
 #include "sdk/store/store_rpc.h"
 #include "test_base.h"
 #include "test_common.h"
@@ -381,6 +387,294 @@ TEST_F(RegionScannerImplTest, NextBatchWithData) {
   }
 }
 
+TEST_F(RegionScannerImplTest, NextBatchWithPackedKvs) {
+  testing::InSequence s;
+
+  std::shared_ptr<Region> region;
+  CHECK(meta_cache->LookupRegionBetweenRange("a", "c", region).IsOK());
+  CHECK_NOTNULL(region.get());
+
+  std::string scan_id = "101";
+
+  std::vector<pb::common::KeyValue> fake_kvs(3);
+  fake_kvs[0].set_key("a001");
+  fake_kvs[0].set_value("v001");
+  fake_kvs[1].set_key("a002");
+  fake_kvs[2].set_key("c001");
+  fake_kvs[2].set_value("v003");
+
+  EXPECT_CALL(*store_rpc_interaction, SendRpc)
+      .WillOnce([&](Rpc& rpc, std::function<void()> cb) {
+        auto* kv_rpc = dynamic_cast<KvScanBeginRpc*>(&rpc);
+        CHECK_NOTNULL(kv_rpc);
+
+        kv_rpc->MutableResponse()->set_scan_id(scan_id);
+        cb();
+      })
+      .WillOnce([&](Rpc& rpc, std::function<void()> cb) {
+        auto* kv_rpc = dynamic_cast<KvScanContinueRpc*>(&rpc);
+        CHECK_NOTNULL(kv_rpc);
+
+        EXPECT_TRUE(kv_rpc->Request()->packed_kvs());
+
+        PackedKv::Encode(fake_kvs, kv_rpc->MutableController()->response_attachment());
+        kv_rpc->MutableResponse()->set_packed_kv_count(fake_kvs.size());
+        cb();
+      })
+      .WillOnce([&](Rpc& rpc, std::function<void()> cb) {
+        auto* kv_rpc = dynamic_cast<KvScanReleaseRpc*>(&rpc);
+        CHECK_NOTNULL(kv_rpc);
+
+        cb();
+      });
+
+  RegionScannerImpl scanner(*stub, region, region->Range().start_key(), region->Range().end_key());
+  Status ret = scanner.Open();
+  EXPECT_TRUE(ret.IsOK());
+
+  std::vector<KVPair> kvs;
+  ret = scanner.NextBatch(kvs);
+  EXPECT_TRUE(ret.IsOK());
+
+  // The key out of the end key is dropped.
+  ASSERT_EQ(kvs.size(), 2);
+  EXPECT_EQ(kvs[0].key, "a001");
+  EXPECT_EQ(kvs[0].value, "v001");
+  EXPECT_EQ(kvs[1].key, "a002");
+  EXPECT_EQ(kvs[1].value, "");
+  EXPECT_FALSE(scanner.HasMore());
+}
+
+TEST_F(RegionScannerImplTest, NextBatchWithCorruptedPackedKvs) {
+  testing::InSequence s;
+
+  std::shared_ptr<Region> region;
+  CHECK(meta_cache->LookupRegionBetweenRange("a", "c", region).IsOK());
+  CHECK_NOTNULL(region.get());
+
+  std::string scan_id = "101";
+
+  std::vector<pb::common::KeyValue> fake_kvs(2);
+  fake_kvs[0].set_key("a001");
+  fake_kvs[0].set_value("v001");
+  fake_kvs[1].set_key("a002");
+  fake_kvs[1].set_value("v002");
+
+  EXPECT_CALL(*store_rpc_interaction, SendRpc)
+      .WillOnce([&](Rpc& rpc, std::function<void()> cb) {
+        auto* kv_rpc = dynamic_cast<KvScanBeginRpc*>(&rpc);
+        CHECK_NOTNULL(kv_rpc);
+
+        kv_rpc->MutableResponse()->set_scan_id(scan_id);
+        cb();
+      })
+      .WillOnce([&](Rpc& rpc, std::function<void()> cb) {
+        auto* kv_rpc = dynamic_cast<KvScanContinueRpc*>(&rpc);
+        CHECK_NOTNULL(kv_rpc);
+
+        // Truncated attachment.
+        std::string packed;
+        PackedKv::Encode(fake_kvs, packed);
+        packed.pop_back();
+        kv_rpc->MutableController()->response_attachment().append(packed);
+        kv_rpc->MutableResponse()->set_packed_kv_count(fake_kvs.size());
+        cb();
+      })
+      .WillOnce([&](Rpc& rpc, std::function<void()> cb) {
+        auto* kv_rpc = dynamic_cast<KvScanReleaseRpc*>(&rpc);
+        CHECK_NOTNULL(kv_rpc);
+
+        cb();
+      });
+
+  RegionScannerImpl scanner(*stub, region, region->Range().start_key(), region->Range().end_key());
+  Status ret = scanner.Open();
+  EXPECT_TRUE(ret.IsOK());
+
+  std::vector<KVPair> kvs;
+  ret = scanner.NextBatch(kvs);
+  EXPECT_TRUE(ret.IsCorruption());
+  EXPECT_EQ(kvs.size(), 0);
+}
+
+class RegionStreamScannerImplTest : public TestBase {
+ public:
+  RegionStreamScannerImplTest() = default;
+
+  ~RegionStreamScannerImplTest() override = default;
+
+  void SetUp() override {
+    meta_cache->MaybeAddRegion(RegionA2C());
+    meta_cache->MaybeAddRegion(RegionE2G());
+  }
+
+ protected:
+  // The stream is created by KvScanStreamRpc::Send, which is skipped by the mocked SendRpc.
+  static constexpr brpc::StreamId kStreamId = 1001;
+
+  void ExpectOpen() {
+    EXPECT_CALL(*store_rpc_interaction, SendRpc).WillOnce([&](Rpc& rpc, std::function<void()> cb) {
+      auto* kv_rpc = dynamic_cast<KvScanStreamRpc*>(&rpc);
+      CHECK_NOTNULL(kv_rpc);
+
+      EXPECT_EQ(kv_rpc->Request()->window_size(), kScanStreamWindowSize);
+      kv_rpc->TEST_AddStreamId(kStreamId);
+      cb();
+    });
+  }
+
+  static void Push(ScanStreamReceiver& receiver, const pb::store::KvScanStreamMessage& message) {
+    butil::IOBuf buf;
+    buf.append(message.SerializeAsString());
+    butil::IOBuf* messages[] = {&buf};
+    receiver.on_received_messages(kStreamId, messages, 1);
+  }
+
+  static pb::store::KvScanStreamMessage GenMessage(const std::vector<std::string>& keys, bool has_more) {
+    std::vector<pb::common::KeyValue> kvs;
+    for (const auto& key : keys) {
+      auto& kv = kvs.emplace_back();
+      kv.set_key(key);
+      kv.set_value("v" + key);
+    }
+
+    pb::store::KvScanStreamMessage message;
+    PackedKv::Encode(kvs, *message.mutable_packed_kvs());
+    message.set_packed_kv_count(kvs.size());
+    message.set_has_more(has_more);
+    return message;
+  }
+};
+
+TEST_F(RegionStreamScannerImplTest, NextBatch) {
+  std::shared_ptr<Region> region;
+  CHECK(meta_cache->LookupRegionBetweenRange("a", "c", region).IsOK());
+  CHECK_NOTNULL(region.get());
+
+  ExpectOpen();
+
+  RegionStreamScannerImpl scanner(*stub, region, region->Range().start_key(), region->Range().end_key());
+  Status ret = scanner.Open();
+  EXPECT_TRUE(ret.IsOK());
+  EXPECT_TRUE(scanner.HasMore());
+
+  auto& receiver = scanner.TEST_GetReceiver();
+  Push(receiver, GenMessage({"a001", "a002"}, true));
+  // The key out of the end key is dropped.
+  Push(receiver, GenMessage({"a003", "c001"}, true));
+
+  std::vector<KVPair> kvs;
+  ret = scanner.NextBatch(kvs);
+  EXPECT_TRUE(ret.IsOK());
+  ASSERT_EQ(kvs.size(), 2);
+  EXPECT_EQ(kvs[0].key, "a001");
+  EXPECT_EQ(kvs[0].value, "va001");
+  EXPECT_EQ(kvs[1].key, "a002");
+  EXPECT_TRUE(scanner.HasMore());
+
+  ret = scanner.NextBatch(kvs);
+  EXPECT_TRUE(ret.IsOK());
+  ASSERT_EQ(kvs.size(), 1);
+  EXPECT_EQ(kvs[0].key, "a003");
+  EXPECT_FALSE(scanner.HasMore());
+
+  ret = scanner.NextBatch(kvs);
+  EXPECT_TRUE(ret.IsOK());
+  EXPECT_TRUE(kvs.empty());
+
+  receiver.on_closed(kStreamId);
+  scanner.Close();
+  EXPECT_FALSE(scanner.TEST_IsOpen());
+}
+
+TEST_F(RegionStreamScannerImplTest, NextBatchError) {
+  std::shared_ptr<Region> region;
+  CHECK(meta_cache->LookupRegionBetweenRange("a", "c", region).IsOK());
+  CHECK_NOTNULL(region.get());
+
+  ExpectOpen();
+
+  RegionStreamScannerImpl scanner(*stub, region, region->Range().start_key(), region->Range().end_key());
+  Status ret = scanner.Open();
+  EXPECT_TRUE(ret.IsOK());
+
+  auto& receiver = scanner.TEST_GetReceiver();
+  pb::store::KvScanStreamMessage message;
+  message.mutable_error()->set_errcode(pb::error::EINTERNAL);
+  message.mutable_error()->set_errmsg("scan fail");
+  Push(receiver, message);
+
+  std::vector<KVPair> kvs;
+  ret = scanner.NextBatch(kvs);
+  EXPECT_TRUE(ret.IsIncomplete());
+  EXPECT_TRUE(kvs.empty());
+  EXPECT_FALSE(scanner.HasMore());
+
+  receiver.on_closed(kStreamId);
+}
+
+TEST_F(RegionStreamScannerImplTest, ClosedBeforeFinished) {
+  std::shared_ptr<Region> region;
+  CHECK(meta_cache->LookupRegionBetweenRange("a", "c", region).IsOK());
+  CHECK_NOTNULL(region.get());
+
+  ExpectOpen();
+
+  RegionStreamScannerImpl scanner(*stub, region, region->Range().start_key(), region->Range().end_key());
+  Status ret = scanner.Open();
+  EXPECT_TRUE(ret.IsOK());
+
+  auto& receiver = scanner.TEST_GetReceiver();
+  Push(receiver, GenMessage({"a001"}, true));
+  receiver.on_closed(kStreamId);
+
+  // The queued message is still consumed.
+  std::vector<KVPair> kvs;
+  ret = scanner.NextBatch(kvs);
+  EXPECT_TRUE(ret.IsOK());
+  ASSERT_EQ(kvs.size(), 1);
+  EXPECT_TRUE(scanner.HasMore());
+
+  ret = scanner.NextBatch(kvs);
+  EXPECT_TRUE(ret.IsAborted());
+  EXPECT_FALSE(scanner.HasMore());
+}
+
+TEST_F(RegionStreamScannerImplTest, ReceiverBackPressure) {
+  const brpc::StreamId stream_id = 1;
+  ScanStreamReceiver receiver(10);
+
+  std::atomic<int> received_count = 0;
+  std::thread sender([&]() {
+    for (int i = 0; i < 3; ++i) {
+      butil::IOBuf buf;
+      buf.append(std::string(10, 'a' + i));
+      butil::IOBuf* messages[] = {&buf};
+      receiver.on_received_messages(stream_id, messages, 1);
+      received_count++;
+    }
+  });
+
+  // Blocked until the queued message is consumed.
+  receiver.TEST_WaitBlocked(1);
+  EXPECT_EQ(received_count.load(), 1);
+
+  butil::IOBuf message;
+  EXPECT_TRUE(receiver.Pop(stream_id, message));
+  EXPECT_EQ(message.to_string(), std::string(10, 'a'));
+  // The second is queued, then the third is blocked.
+  receiver.TEST_WaitBlocked(2);
+  EXPECT_EQ(received_count.load(), 2);
+
+  // Closing wakes up and drops the blocked message, then the stream calls on_closed.
+  std::thread closer([&]() { receiver.WaitClosed({stream_id}); });
+  sender.join();
+  EXPECT_EQ(received_count.load(), 3);
+  receiver.on_closed(stream_id);
+  closer.join();
+  EXPECT_FALSE(receiver.Pop(stream_id, message));
+}
+
 }  // namespace sdk
 
 }  // namespace dingodb
\ No newline at end of file
@@ -27,6 +27,8 @@ TEST(VectorCommonTest, TestMetricType2InternalMetricTypePB) {
             pb::common::MetricType::METRIC_TYPE_INNER_PRODUCT);
 
   EXPECT_EQ(MetricType2InternalMetricTypePB(MetricType::kCosine), pb::common::MetricType::METRIC_TYPE_COSINE);
+
+  EXPECT_EQ(MetricType2InternalMetricTypePB(MetricType::kHamming), pb::common::MetricType::METRIC_TYPE_HAMMING);
 }
 
 TEST(VectorCommonTest, TestVectorIndexType2InternalVectorIndexTypePB) {
@@ -47,6 +49,12 @@ TEST(VectorCommonTest, TestVectorIndexType2InternalVectorIndexTypePB) {
 
   EXPECT_EQ(VectorIndexType2InternalVectorIndexTypePB(VectorIndexType::kBruteForce),
             pb::common::VECTOR_INDEX_TYPE_BRUTEFORCE);
+
+  EXPECT_EQ(VectorIndexType2InternalVectorIndexTypePB(VectorIndexType::kBinaryFlat),
+            pb::common::VECTOR_INDEX_TYPE_BINARY_FLAT);
+
+  EXPECT_EQ(VectorIndexType2InternalVectorIndexTypePB(VectorIndexType::kBinaryIvfFlat),
+            pb::common::VECTOR_INDEX_TYPE_BINARY_IVF_FLAT);
 }
 
 TEST(VectorCommonTest, TestInternalVectorIndexTypePB2VectorIndexType) {
@@ -67,6 +75,12 @@ TEST(VectorCommonTest, TestInternalVectorIndexTypePB2VectorIndexType) {
 
   EXPECT_EQ(InternalVectorIndexTypePB2VectorIndexType(pb::common::VECTOR_INDEX_TYPE_BRUTEFORCE),
             VectorIndexType::kBruteForce);
+
+  EXPECT_EQ(InternalVectorIndexTypePB2VectorIndexType(pb::common::VECTOR_INDEX_TYPE_BINARY_FLAT),
+            VectorIndexType::kBinaryFlat);
+
+  EXPECT_EQ(InternalVectorIndexTypePB2VectorIndexType(pb::common::VECTOR_INDEX_TYPE_BINARY_IVF_FLAT),
+            VectorIndexType::kBinaryIvfFlat);
 }
 
 TEST(VectorCommonTest, TestFillFlatParmeter) {
@@ -130,6 +144,29 @@ TEST(VectorCommonTest, TestFillButeForceParmeter) {
   EXPECT_EQ(parameter.bruteforce_parameter().metric_type(), MetricType2InternalMetricTypePB(param.metric_type));
 }
 
+TEST(VectorCommonTest, TestFillBinaryFlatParmeter) {
+  pb::common::VectorIndexParameter parameter;
+  BinaryFlatParam param{128};
+
+  FillBinaryFlatParmeter(&parameter, param);
+
+  EXPECT_EQ(parameter.vector_index_type(), pb::common::VECTOR_INDEX_TYPE_BINARY_FLAT);
+  EXPECT_EQ(parameter.binary_flat_parameter().dimension(), param.dimension);
+  EXPECT_EQ(parameter.binary_flat_parameter().metric_type(), pb::common::MetricType::METRIC_TYPE_HAMMING);
+}
+
+TEST(VectorCommonTest, TestFillBinaryIvfFlatParmeter) {
+  pb::common::VectorIndexParameter parameter;
+  BinaryIvfFlatParam param{128};
+
+  FillBinaryIvfFlatParmeter(&parameter, param);
+
+  EXPECT_EQ(parameter.vector_index_type(), pb::common::VECTOR_INDEX_TYPE_BINARY_IVF_FLAT);
+  EXPECT_EQ(parameter.binary_ivf_flat_parameter().dimension(), param.dimension);
+  EXPECT_EQ(parameter.binary_ivf_flat_parameter().metric_type(), pb::common::MetricType::METRIC_TYPE_HAMMING);
+  EXPECT_EQ(parameter.binary_ivf_flat_parameter().ncentroids(), param.ncentroids);
+}
+
 TEST(VectorCommonTest, TestFillRangePartitionRule) {
   pb::meta::PartitionRule partition_rule;
   std::vector<int64_t> seperator_ids = {10, 20, 30};
@@ -0,0 +1,233 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <any>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "coprocessor/aggregation_hash_table.h"
+#include "coprocessor/aggregation_manager.h"
+#include "proto/store.pb.h"
+#include "serial/schema/long_schema.h"
+#include "serial/schema/string_schema.h"
+
+namespace dingodb {
+
+class CoprocessorAggregationHashTableTest : public testing::Test {
+ protected:
+  static std::shared_ptr<std::vector<std::shared_ptr<BaseSchema>>> GenSchemas(
+      const std::vector<BaseSchema::Type>& types) {
+    auto schemas = std::make_shared<std::vector<std::shared_ptr<BaseSchema>>>();
+    for (auto type : types) {
+      if (type == BaseSchema::kString) {
+        schemas->push_back(std::make_shared<DingoSchema<std::optional<std::shared_ptr<std::string>>>>());
+      } else {
+        schemas->push_back(std::make_shared<DingoSchema<std::optional<int64_t>>>());
+      }
+    }
+    return schemas;
+  }
+};
+
+TEST_F(CoprocessorAggregationHashTableTest, FindOrInsert) {
+  AggregationHashTable hash_table;
+
+  // Enough keys to grow the table several times.
+  int64_t key_count = 10000;
+  for (int round = 0; round < 2; ++round) {
+    for (int64_t i = 0; i < key_count; ++i) {
+      bool is_new = false;
+      int64_t group_index = hash_table.FindOrInsert("key_" + std::to_string(i), is_new);
+      EXPECT_EQ(is_new, round == 0);
+      EXPECT_EQ(group_index, i);
+    }
+  }
+  EXPECT_EQ(hash_table.Size(), key_count);
+  EXPECT_EQ(hash_table.GetKey(123), "key_123");
+
+  // Empty key is a valid group.
+  bool is_new = false;
+  EXPECT_EQ(hash_table.FindOrInsert("", is_new), key_count);
+  EXPECT_TRUE(is_new);
+  EXPECT_EQ(hash_table.FindOrInsert("", is_new), key_count);
+  EXPECT_FALSE(is_new);
+
+  auto sorted_group_indexes = hash_table.SortedGroupIndexes();
+  ASSERT_EQ(sorted_group_indexes.size(), key_count + 1);
+  EXPECT_EQ(sorted_group_indexes[0], key_count);
+  for (size_t i = 1; i < sorted_group_indexes.size(); ++i) {
+    EXPECT_LT(hash_table.GetKey(sorted_group_indexes[i - 1]), hash_table.GetKey(sorted_group_indexes[i]));
+  }
+
+  hash_table.Clear();
+  EXPECT_EQ(hash_table.Size(), 0);
+}
+
+TEST_F(CoprocessorAggregationHashTableTest, AggregationManager) {
+  ::google::protobuf::RepeatedPtrField<pb::store::AggregationOperator> aggregation_operators;
+  std::vector<std::pair<pb::store::AggregationType, int32_t>> opers = {{pb::store::SUM, 0},
+                                                                       {pb::store::SUM0, 0},
+                                                                       {pb::store::COUNT, 0},
+                                                                       {pb::store::COUNT, -1},
+                                                                       {pb::store::MAX, 0},
+                                                                       {pb::store::MIN, 1}};
+  for (const auto& [oper, index_of_column] : opers) {
+    auto* aggregation_operator = aggregation_operators.Add();
+    aggregation_operator->set_oper(oper);
+    aggregation_operator->set_index_of_column(index_of_column);
+  }
+
+  auto operator_schemas = GenSchemas({BaseSchema::kLong, BaseSchema::kLong, BaseSchema::kLong, BaseSchema::kLong,
+                                      BaseSchema::kLong, BaseSchema::kString});
+  auto result_schemas = GenSchemas({BaseSchema::kString, BaseSchema::kLong, BaseSchema::kLong, BaseSchema::kLong,
+                                    BaseSchema::kLong, BaseSchema::kLong, BaseSchema::kString});
+
+  AggregationManager aggregation_manager;
+  ASSERT_TRUE(aggregation_manager.Open(operator_schemas, aggregation_operators, result_schemas, true).ok());
+
+  // group key: value, 4 groups in reverse order, every third value null.
+  std::map<std::string, std::vector<std::optional<int64_t>>> expect_values;
+  for (int64_t i = 0; i < 100; ++i) {
+    std::string group_by_key = "group_" + std::to_string(3 - i % 4);
+    std::optional<int64_t> value = i % 3 == 0 ? std::nullopt : std::optional<int64_t>(i);
+    expect_values[group_by_key].push_back(value);
+
+    std::vector<std::any> record;
+    for (int j = 0; j < 5; ++j) {
+      record.emplace_back(value);
+    }
+    record.emplace_back(std::optional<std::shared_ptr<std::string>>(std::make_shared<std::string>(std::to_string(i))));
+    ASSERT_TRUE(aggregation_manager.Execute(group_by_key, record).ok());
+  }
+
+  // Mismatch type.
+  std::vector<std::any> invalid_record = {std::optional<int32_t>(1)};
+  EXPECT_FALSE(aggregation_manager.Execute("group_0", invalid_record).ok());
+
+  auto iter = aggregation_manager.CreateIterator();
+  auto expect_iter = expect_values.begin();
+  while (iter->HasNext()) {
+    ASSERT_NE(expect_iter, expect_values.end());
+    EXPECT_EQ(iter->GetKey(), expect_iter->first);
+
+    int64_t sum = 0;
+    int64_t count = 0;
+    int64_t max = INT64_MIN;
+    for (const auto& value : expect_iter->second) {
+      if (value.has_value()) {
+        sum += value.value();
+        ++count;
+        max = std::max(max, value.value());
+      }
+    }
+
+    const auto& result = *iter->GetValue();
+    ASSERT_EQ(result.size(), 6);
+    EXPECT_EQ(std::any_cast<std::optional<int64_t>>(result[0]).value(), sum);
+    EXPECT_EQ(std::any_cast<std::optional<int64_t>>(result[1]).value(), sum);
+    EXPECT_EQ(std::any_cast<std::optional<int64_t>>(result[2]).value(), count);
+    EXPECT_EQ(std::any_cast<std::optional<int64_t>>(result[3]).value(), expect_iter->second.size());
+    EXPECT_EQ(std::any_cast<std::optional<int64_t>>(result[4]).value(), max);
+    EXPECT_TRUE(std::any_cast<std::optional<std::shared_ptr<std::string>>>(result[5]).has_value());
+
+    iter->Next();
+    ++expect_iter;
+  }
+  EXPECT_EQ(expect_iter, expect_values.end());
+
+  aggregation_manager.Close();
+}
+
+TEST_F(CoprocessorAggregationHashTableTest, Merge) {
+  ::google::protobuf::RepeatedPtrField<pb::store::AggregationOperator> aggregation_operators;
+  std::vector<std::pair<pb::store::AggregationType, int32_t>> opers = {
+      {pb::store::SUM, 0}, {pb::store::COUNT, 0}, {pb::store::COUNT, -1}, {pb::store::MAX, 0}, {pb::store::MIN, 0}};
+  for (const auto& [oper, index_of_column] : opers) {
+    auto* aggregation_operator = aggregation_operators.Add();
+    aggregation_operator->set_oper(oper);
+    aggregation_operator->set_index_of_column(index_of_column);
+  }
+
+  auto schemas =
+      GenSchemas({BaseSchema::kLong, BaseSchema::kLong, BaseSchema::kLong, BaseSchema::kLong, BaseSchema::kLong});
+
+  // The whole rows aggregated by one manager, and the partial rows aggregated by two managers then merged.
+  AggregationManager whole;
+  AggregationManager left;
+  AggregationManager right;
+  for (auto* aggregation_manager : {&whole, &left, &right}) {
+    ASSERT_TRUE(aggregation_manager->Open(schemas, aggregation_operators, schemas, true).ok());
+  }
+
+  for (int64_t i = 0; i < 100; ++i) {
+    // group_3 only in the right, and all null in the left.
+    std::string group_by_key = "group_" + std::to_string(i < 50 ? i % 3 : i % 4);
+    std::optional<int64_t> value = (i % 5 == 0 || (i < 50 && i % 3 == 2)) ? std::nullopt : std::optional<int64_t>(i);
+    std::vector<std::any> record(opers.size(), value);
+    ASSERT_TRUE(whole.Execute(group_by_key, record).ok());
+    ASSERT_TRUE((i < 50 ? left : right).Execute(group_by_key, record).ok());
+  }
+
+  ASSERT_TRUE(left.Merge(right).ok());
+
+  auto expect_iter = whole.CreateIterator();
+  auto iter = left.CreateIterator();
+  while (expect_iter->HasNext()) {
+    ASSERT_TRUE(iter->HasNext());
+    EXPECT_EQ(iter->GetKey(), expect_iter->GetKey());
+    const auto& expect_result = *expect_iter->GetValue();
+    const auto& result = *iter->GetValue();
+    ASSERT_EQ(result.size(), expect_result.size());
+    for (size_t i = 0; i < result.size(); ++i) {
+      EXPECT_EQ(std::any_cast<std::optional<int64_t>>(result[i]),
+                std::any_cast<std::optional<int64_t>>(expect_result[i]))
+          << iter->GetKey() << " " << i;
+    }
+    expect_iter->Next();
+    iter->Next();
+  }
+  EXPECT_FALSE(iter->HasNext());
+
+  // Mismatch aggregations.
+  ::google::protobuf::RepeatedPtrField<pb::store::AggregationOperator> other_operators;
+  other_operators.Add()->set_oper(pb::store::COUNT);
+  other_operators[0].set_index_of_column(-1);
+  AggregationManager other;
+  auto other_schemas = GenSchemas({BaseSchema::kLong});
+  ASSERT_TRUE(other.Open(other_schemas, other_operators, other_schemas, true).ok());
+  ASSERT_TRUE(other.Execute("group_0", {std::optional<int64_t>(1)}).ok());
+  EXPECT_FALSE(left.Merge(other).ok());
+}
+
+TEST_F(CoprocessorAggregationHashTableTest, NotSupport) {
+  ::google::protobuf::RepeatedPtrField<pb::store::AggregationOperator> aggregation_operators;
+  auto* aggregation_operator = aggregation_operators.Add();
+  aggregation_operator->set_oper(pb::store::SUM);
+  aggregation_operator->set_index_of_column(0);
+
+  auto schemas = GenSchemas({BaseSchema::kString});
+  AggregationManager aggregation_manager;
+  auto status = aggregation_manager.Open(schemas, aggregation_operators, schemas);
+  EXPECT_EQ(status.error_code(), pb::error::ENOT_SUPPORT);
+}
+
+}  // namespace dingodb
@@ -0,0 +1,60 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "common/helper.h"
+#include "coprocessor/expr_bytecode.h"
+
+namespace dingodb {
+
+TEST(ExprBytecodeTest, CollectVars) {
+  std::vector<bool> var_used;
+
+  // var(2) int64 > 100 AND var(0) string = 'ab'
+  std::string expression = Helper::HexToString("32021264930237001702616291075200");
+  EXPECT_EQ(ExprBytecode::CollectVars(expression, 4, var_used), expression.size());
+  EXPECT_EQ(var_used, std::vector<bool>({true, false, true, false}));
+
+  // The trailing bytes are not part of the expression.
+  EXPECT_EQ(ExprBytecode::CollectVars(expression + "ab", 4, var_used), expression.size());
+
+  // var(5) out of the tuple.
+  EXPECT_EQ(ExprBytecode::CollectVars(Helper::HexToString("3205126493020500"), 4, var_used), 0);
+  // Unknown operator.
+  EXPECT_EQ(ExprBytecode::CollectVars(Helper::HexToString("3201F000"), 4, var_used), 0);
+  // No kEoe.
+  EXPECT_EQ(ExprBytecode::CollectVars(Helper::HexToString("32011264930205"), 4, var_used), 0);
+}
+
+TEST(ExprBytecodeTest, CollectFilterColumns) {
+  std::vector<bool> filter_columns;
+
+  // var(1) int64 is null
+  EXPECT_TRUE(ExprBytecode::CollectFilterColumns(Helper::HexToString("3201A10200"), 3, filter_columns));
+  EXPECT_EQ(filter_columns, std::vector<bool>({false, true, false}));
+
+  // var(0) bool AND var(1) bool, all of the columns are referenced.
+  EXPECT_FALSE(ExprBytecode::CollectFilterColumns(Helper::HexToString("330033015200"), 2, filter_columns));
+  EXPECT_TRUE(filter_columns.empty());
+
+  // Trailing bytes after the expression.
+  EXPECT_FALSE(ExprBytecode::CollectFilterColumns(Helper::HexToString("3201A1020000"), 3, filter_columns));
+  EXPECT_TRUE(filter_columns.empty());
+}
+
+}  // namespace dingodb
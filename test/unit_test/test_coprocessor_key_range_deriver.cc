@@ -0,0 +1,166 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <any>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "common/helper.h"
+#include "coprocessor/key_range_deriver.h"
+#include "coprocessor/utils.h"
+#include "proto/common.pb.h"
+#include "serial/record_encoder.h"
+
+namespace dingodb {
+
+class CoprocessorKeyRangeDeriverTest : public testing::Test {
+ protected:
+  static void AddSchema(pb::common::CoprocessorV2& coprocessor, pb::common::Schema::Type type, bool is_key) {
+    auto* schema = coprocessor.mutable_original_schema()->add_schema();
+    schema->set_type(type);
+    schema->set_is_key(is_key);
+    schema->set_is_nullable(true);
+    schema->set_index(coprocessor.original_schema().schema_size() - 1);
+    coprocessor.add_selection_columns(schema->index());
+  }
+
+  // k0 long key, k1 string key, v2 int value.
+  static pb::common::CoprocessorV2 GenCoprocessor(const std::string& hex_rel_expr) {
+    pb::common::CoprocessorV2 coprocessor;
+    coprocessor.set_schema_version(1);
+    coprocessor.mutable_original_schema()->set_common_id(kCommonId);
+    AddSchema(coprocessor, pb::common::Schema::LONG, true);
+    AddSchema(coprocessor, pb::common::Schema::STRING, true);
+    AddSchema(coprocessor, pb::common::Schema::INTEGER, false);
+    coprocessor.set_rel_expr(Helper::HexToString(hex_rel_expr));
+    return coprocessor;
+  }
+
+  static pb::common::Range GenRange() {
+    pb::common::Range range;
+    range.set_start_key(std::string("r") + std::string(7, '\0') + std::string(1, kCommonId));
+    range.set_end_key(std::string("r") + std::string(7, '\0') + std::string(1, kCommonId + 1));
+    return range;
+  }
+
+  // All rows in the derived range are the rows matched the filter.
+  static void ExpectRange(const pb::common::CoprocessorV2& coprocessor, const pb::common::Range& range,
+                          const std::function<bool(int64_t, const std::string&)>& filter) {
+    auto schemas = std::make_shared<std::vector<std::shared_ptr<BaseSchema>>>();
+    ASSERT_TRUE(Utils::TransToSerialSchema(coprocessor.original_schema().schema(), &schemas).ok());
+    RecordEncoder encoder(1, schemas, kCommonId);
+
+    for (int64_t k0 = -3; k0 <= 3; ++k0) {
+      for (const auto* k1 : {"", "a", "b", "bb", "c", "ccccccccc", "d", "e"}) {
+        std::vector<std::any> record = {
+            std::optional<int64_t>(k0),
+            std::optional<std::shared_ptr<std::string>>(std::make_shared<std::string>(k1)),
+            std::optional<int32_t>(1)};
+        std::string key;
+        std::string value;
+        ASSERT_EQ(encoder.Encode(record, key, value), 0);
+
+        bool in_range = range.start_key() <= key && key < range.end_key();
+        EXPECT_EQ(in_range, filter(k0, k1)) << "k0: " << k0 << ", k1: " << k1;
+      }
+    }
+  }
+
+  static constexpr int64_t kCommonId = 100;
+};
+
+TEST_F(CoprocessorKeyRangeDeriverTest, EqualAndRange) {
+  // filter(k0 = 2 AND k1 >= 'b' AND k1 < 'd')
+  auto coprocessor =
+      GenCoprocessor("71" "3200" "1202" "9102" "3701" "170162" "9207" "52" "3701" "170164" "9507" "52" "00");
+  auto range = GenRange();
+  ASSERT_TRUE(KeyRangeDeriver::Derive(coprocessor, range));
+  ExpectRange(coprocessor, range,
+              [](int64_t k0, const std::string& k1) { return k0 == 2 && k1 >= "b" && k1 < "d"; });
+
+  // filter(k0 = 2 AND k1 = 'c')
+  coprocessor = GenCoprocessor("71" "3200" "1202" "9102" "3701" "170163" "9107" "52" "00");
+  range = GenRange();
+  ASSERT_TRUE(KeyRangeDeriver::Derive(coprocessor, range));
+  ExpectRange(coprocessor, range, [](int64_t k0, const std::string& k1) { return k0 == 2 && k1 == "c"; });
+}
+
+TEST_F(CoprocessorKeyRangeDeriverTest, LeadingColumnRange) {
+  // filter(-2 < k0 AND k0 <= 1 AND v2 > 0), the constant at left and negative constant.
+  auto coprocessor =
+      GenCoprocessor("71" "2202" "3200" "9502" "3200" "1201" "9402" "52" "3102" "1100" "9301" "52" "00");
+  auto range = GenRange();
+  ASSERT_TRUE(KeyRangeDeriver::Derive(coprocessor, range));
+  ExpectRange(coprocessor, range, [](int64_t k0, const std::string&) { return k0 > -2 && k0 <= 1; });
+
+  // filter(k0 > 1 AND k0 < 0) is empty.
+  coprocessor = GenCoprocessor("71" "3200" "1201" "9302" "3200" "1200" "9502" "52" "00");
+  range = GenRange();
+  ASSERT_TRUE(KeyRangeDeriver::Derive(coprocessor, range));
+  EXPECT_EQ(range.start_key(), range.end_key());
+}
+
+TEST_F(CoprocessorKeyRangeDeriverTest, NotDerived) {
+  auto origin_range = GenRange();
+  std::vector<std::string> rel_exprs = {
+      // filter(k0 = 1 OR k0 = 2)
+      "71" "3200" "1201" "9102" "3200" "1202" "9102" "53" "00",
+      // filter(k1 = 'c'), not the leading key column.
+      "71" "3701" "170163" "9107" "00",
+      // filter(v2 > 0)
+      "71" "3102" "1100" "9301" "00",
+      // filter(k0 <> 1)
+      "71" "3200" "1201" "9602" "00",
+      // type mismatch with the schema.
+      "71" "3100" "1101" "9101" "00",
+      // unknown operator.
+      "71" "3200" "1201" "F102" "00",
+      // truncated.
+      "71" "3200" "1201" "91",
+      // not start with filter.
+      "72" "3200" "00",
+  };
+  for (const auto& rel_expr : rel_exprs) {
+    auto coprocessor = GenCoprocessor(rel_expr);
+    auto range = origin_range;
+    EXPECT_FALSE(KeyRangeDeriver::Derive(coprocessor, range)) << rel_expr;
+    EXPECT_EQ(range.start_key(), origin_range.start_key());
+    EXPECT_EQ(range.end_key(), origin_range.end_key());
+  }
+}
+
+TEST_F(CoprocessorKeyRangeDeriverTest, IntersectRequestRange) {
+  // filter(k0 >= 0)
+  auto coprocessor = GenCoprocessor("71" "3200" "1200" "9202" "00");
+  auto range = GenRange();
+  ASSERT_TRUE(KeyRangeDeriver::Derive(coprocessor, range));
+  auto derived_range = range;
+
+  // The request range is inside the derived range.
+  range.set_start_key(derived_range.start_key() + "x");
+  range.set_end_key(Helper::PrefixNext(range.start_key()));
+  auto request_range = range;
+  ASSERT_TRUE(KeyRangeDeriver::Derive(coprocessor, range));
+  EXPECT_EQ(range.start_key(), request_range.start_key());
+  EXPECT_EQ(range.end_key(), request_range.end_key());
+}
+
+}  // namespace dingodb
@@ -0,0 +1,148 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "butil/status.h"
+#include "common/helper.h"
+#include "coprocessor/coprocessor_plan_cache.h"
+#include "coprocessor/coprocessor_v2.h"
+#include "gflags/gflags.h"
+#include "proto/common.pb.h"
+#include "proto/error.pb.h"
+
+namespace dingodb {
+
+DECLARE_int64(coprocessor_plan_cache_capacity);
+
+class CoprocessorPlanCacheTest : public testing::Test {
+ protected:
+  void SetUp() override { CoprocessorPlanCache::GetInstance().Clear(); }
+
+  void TearDown() override { CoprocessorPlanCache::GetInstance().Clear(); }
+
+  static CoprocessorV2PlanPtr GenPlan(int column_count) {
+    auto plan = std::make_shared<CoprocessorV2Plan>();
+    plan->original_column_indexes.resize(column_count, 0);
+    return plan;
+  }
+
+  static pb::common::CoprocessorV2 GenCoprocessor() {
+    pb::common::CoprocessorV2 pb_coprocessor;
+    pb_coprocessor.set_schema_version(1);
+
+    auto* original_schema = pb_coprocessor.mutable_original_schema();
+    original_schema->set_common_id(1);
+
+    auto add_schema = [original_schema](pb::common::Schema::Type type, bool is_key, const std::string& name) {
+      auto* schema = original_schema->add_schema();
+      schema->set_type(type);
+      schema->set_is_key(is_key);
+      schema->set_is_nullable(true);
+      schema->set_index(original_schema->schema_size() - 1);
+      schema->set_name(name);
+    };
+    add_schema(pb::common::Schema::BOOL, true, "name_bool");
+    add_schema(pb::common::Schema::INTEGER, false, "name_int");
+    add_schema(pb::common::Schema::FLOAT, false, "name_float");
+    add_schema(pb::common::Schema::LONG, false, "name_int64");
+    add_schema(pb::common::Schema::DOUBLE, true, "name_double");
+    add_schema(pb::common::Schema::STRING, true, "name_string");
+
+    pb_coprocessor.set_rel_expr(Helper::StringToHex(std::string_view("7134021442480000930400")));
+    return pb_coprocessor;
+  }
+};
+
+TEST_F(CoprocessorPlanCacheTest, GetAndPut) {
+  auto& cache = CoprocessorPlanCache::GetInstance();
+  EXPECT_EQ(cache.Get("plan_1"), nullptr);
+
+  auto plan = GenPlan(1);
+  cache.Put("plan_1", plan);
+  EXPECT_EQ(cache.Get("plan_1"), plan);
+  EXPECT_EQ(cache.Get("plan_2"), nullptr);
+
+  // Put again replace the old one.
+  auto new_plan = GenPlan(2);
+  cache.Put("plan_1", new_plan);
+  EXPECT_EQ(cache.Get("plan_1"), new_plan);
+  EXPECT_EQ(cache.Size(), 1);
+}
+
+TEST_F(CoprocessorPlanCacheTest, EvictLeastRecentlyUsed) {
+  gflags::FlagSaver flag_saver;
+  FLAGS_coprocessor_plan_cache_capacity = 2;
+  auto& cache = CoprocessorPlanCache::GetInstance();
+
+  cache.Put("plan_1", GenPlan(1));
+  cache.Put("plan_2", GenPlan(2));
+  // plan_1 is used recently, plan_2 is evicted.
+  EXPECT_NE(cache.Get("plan_1"), nullptr);
+  cache.Put("plan_3", GenPlan(3));
+
+  EXPECT_EQ(cache.Size(), 2);
+  EXPECT_NE(cache.Get("plan_1"), nullptr);
+  EXPECT_EQ(cache.Get("plan_2"), nullptr);
+  EXPECT_NE(cache.Get("plan_3"), nullptr);
+}
+
+TEST_F(CoprocessorPlanCacheTest, Disable) {
+  gflags::FlagSaver flag_saver;
+  FLAGS_coprocessor_plan_cache_capacity = 0;
+  auto& cache = CoprocessorPlanCache::GetInstance();
+
+  cache.Put("plan_1", GenPlan(1));
+  EXPECT_EQ(cache.Get("plan_1"), nullptr);
+  EXPECT_EQ(cache.Size(), 0);
+}
+
+TEST_F(CoprocessorPlanCacheTest, OpenHitAndMiss) {
+  auto& cache = CoprocessorPlanCache::GetInstance();
+  auto pb_coprocessor = GenCoprocessor();
+
+  // The first open prepares the plan and caches it.
+  auto coprocessor = std::make_shared<CoprocessorV2>();
+  auto status = coprocessor->Open(CoprocessorPbWrapper{pb_coprocessor});
+  ASSERT_EQ(status.error_code(), pb::error::Errno::OK);
+  EXPECT_EQ(cache.Size(), 1);
+  auto plan = cache.Get(pb_coprocessor.SerializeAsString());
+  ASSERT_NE(plan, nullptr);
+
+  // The same coprocessor hits the cached plan.
+  auto hit_coprocessor = std::make_shared<CoprocessorV2>();
+  status = hit_coprocessor->Open(CoprocessorPbWrapper{pb_coprocessor});
+  ASSERT_EQ(status.error_code(), pb::error::Errno::OK);
+  EXPECT_EQ(cache.Size(), 1);
+  EXPECT_EQ(cache.Get(pb_coprocessor.SerializeAsString()), plan);
+
+  // The schema changed, miss and prepare a new plan.
+  auto changed_pb_coprocessor = GenCoprocessor();
+  changed_pb_coprocessor.mutable_original_schema()->mutable_schema(3)->set_name("name_long");
+  auto miss_coprocessor = std::make_shared<CoprocessorV2>();
+  status = miss_coprocessor->Open(CoprocessorPbWrapper{changed_pb_coprocessor});
+  ASSERT_EQ(status.error_code(), pb::error::Errno::OK);
+  EXPECT_EQ(cache.Size(), 2);
+  auto changed_plan = cache.Get(changed_pb_coprocessor.SerializeAsString());
+  ASSERT_NE(changed_plan, nullptr);
+  EXPECT_NE(changed_plan, plan);
+  EXPECT_EQ(cache.Get(pb_coprocessor.SerializeAsString()), plan);
+}
+
+}  // namespace dingodb
@@ -0,0 +1,137 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <any>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "coprocessor/top_n.h"
+#include "proto/common.pb.h"
+#include "proto/error.pb.h"
+#include "serial/schema/double_schema.h"
+#include "serial/schema/long_list_schema.h"
+#include "serial/schema/long_schema.h"
+#include "serial/schema/string_schema.h"
+
+namespace dingodb {
+
+class CoprocessorTopNTest : public testing::Test {
+ protected:
+  // c0 long, c1 string, c2 double, c3 long list not support sort.
+  void SetUp() override {
+    schemas_ = std::make_shared<std::vector<std::shared_ptr<BaseSchema>>>();
+    schemas_->push_back(std::make_shared<DingoSchema<std::optional<int64_t>>>());
+    schemas_->push_back(std::make_shared<DingoSchema<std::optional<std::shared_ptr<std::string>>>>());
+    schemas_->push_back(std::make_shared<DingoSchema<std::optional<double>>>());
+    schemas_->push_back(std::make_shared<DingoSchema<std::optional<std::shared_ptr<std::vector<int64_t>>>>>());
+    result_column_indexes_ = {0, 1, 2, 3};
+  }
+
+  static ::google::protobuf::RepeatedPtrField<pb::common::CoprocessorV2::SortColumn> GenSortColumns(
+      const std::vector<std::pair<int, bool>>& columns) {
+    ::google::protobuf::RepeatedPtrField<pb::common::CoprocessorV2::SortColumn> sort_columns;
+    for (const auto& [index, is_desc] : columns) {
+      auto* sort_column = sort_columns.Add();
+      sort_column->set_index(index);
+      sort_column->set_is_desc(is_desc);
+    }
+    return sort_columns;
+  }
+
+  static std::vector<std::any> GenRecord(std::optional<int64_t> c0, const std::string& c1, double c2) {
+    return {c0, std::optional<std::shared_ptr<std::string>>(std::make_shared<std::string>(c1)),
+            std::optional<double>(c2)};
+  }
+
+  std::shared_ptr<std::vector<std::shared_ptr<BaseSchema>>> schemas_;
+  std::vector<int> result_column_indexes_;
+};
+
+TEST_F(CoprocessorTopNTest, Order) {
+  // ORDER BY c0 DESC, c1 LIMIT 5
+  TopN top_n;
+  ASSERT_TRUE(top_n.Open(schemas_, result_column_indexes_, GenSortColumns({{0, true}, {1, false}}), 5).ok());
+
+  std::vector<std::tuple<std::optional<int64_t>, std::string, double>> rows;
+  for (int64_t i = 0; i < 100; ++i) {
+    std::optional<int64_t> c0 = i % 7 == 0 ? std::nullopt : std::optional<int64_t>(i % 10);
+    std::string c1 = std::to_string((i * 37) % 100);
+    rows.emplace_back(c0, c1, static_cast<double>(i));
+    top_n.Put(GenRecord(c0, c1, static_cast<double>(i)));
+  }
+  EXPECT_EQ(top_n.Size(), 5);
+
+  // Null is less than any value, so the last of DESC.
+  std::stable_sort(rows.begin(), rows.end(), [](const auto& lhs, const auto& rhs) {
+    if (std::get<0>(lhs) != std::get<0>(rhs)) {
+      return std::get<0>(lhs) > std::get<0>(rhs);
+    }
+    return std::get<1>(lhs) < std::get<1>(rhs);
+  });
+
+  auto records = top_n.Take();
+  ASSERT_EQ(records.size(), 5);
+  for (size_t i = 0; i < records.size(); ++i) {
+    EXPECT_EQ(std::any_cast<std::optional<int64_t>>(records[i][0]), std::get<0>(rows[i]));
+    EXPECT_EQ(*std::any_cast<std::optional<std::shared_ptr<std::string>>>(records[i][1]).value(), std::get<1>(rows[i]));
+  }
+  EXPECT_EQ(top_n.Size(), 0);
+}
+
+TEST_F(CoprocessorTopNTest, StableAndNull) {
+  // ORDER BY c0 LIMIT 3, null first and the equal rows keep the put order.
+  TopN top_n;
+  ASSERT_TRUE(top_n.Open(schemas_, result_column_indexes_, GenSortColumns({{0, false}}), 3).ok());
+
+  top_n.Put(GenRecord(1, "a", 1.0));
+  top_n.Put(GenRecord(1, "b", 2.0));
+  top_n.Put(GenRecord(std::nullopt, "c", 3.0));
+  top_n.Put(GenRecord(0, "d", 4.0));
+  top_n.Put(GenRecord(1, "e", 5.0));
+  // The short record has null c0.
+  top_n.Put(std::vector<std::any>{});
+
+  auto records = top_n.Take();
+  ASSERT_EQ(records.size(), 3);
+  EXPECT_EQ(*std::any_cast<std::optional<std::shared_ptr<std::string>>>(records[0][1]).value(), "c");
+  EXPECT_TRUE(records[1].empty());
+  EXPECT_EQ(*std::any_cast<std::optional<std::shared_ptr<std::string>>>(records[2][1]).value(), "d");
+
+  // Less than limit.
+  top_n.Put(GenRecord(2, "f", 6.0));
+  top_n.Put(GenRecord(1, "g", 7.0));
+  records = top_n.Take();
+  ASSERT_EQ(records.size(), 2);
+  EXPECT_EQ(std::any_cast<std::optional<double>>(records[0][2]).value(), 7.0);
+  EXPECT_EQ(std::any_cast<std::optional<double>>(records[1][2]).value(), 6.0);
+}
+
+TEST_F(CoprocessorTopNTest, Invalid) {
+  TopN top_n;
+  EXPECT_FALSE(top_n.Open(schemas_, result_column_indexes_, GenSortColumns({{0, false}}), 0).ok());
+  EXPECT_FALSE(top_n.Open(schemas_, result_column_indexes_, GenSortColumns({}), 10).ok());
+  EXPECT_FALSE(top_n.Open(schemas_, result_column_indexes_, GenSortColumns({{4, false}}), 10).ok());
+  EXPECT_EQ(top_n.Open(schemas_, result_column_indexes_, GenSortColumns({{3, false}}), 10).error_code(),
+            pb::error::ENOT_SUPPORT);
+}
+
+}  // namespace dingodb
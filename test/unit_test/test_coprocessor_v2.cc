@@ -28,21 +28,27 @@
 #include <random>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "butil/status.h"
 #include "common/constant.h"
 #include "common/helper.h"
+#include "common/logging.h"
 #include "config/config.h"
 #include "config/yaml_config.h"
 #include "coordinator/tso_control.h"
 #include "coprocessor/coprocessor_scalar.h"
 #include "coprocessor/coprocessor_v2.h"
+#include "coprocessor/utils.h"
 #include "engine/rocks_raw_engine.h"
 #include "engine/txn_engine_helper.h"
+#include "fmt/core.h"
+#include "gflags/gflags.h"
 #include "proto/common.pb.h"
 #include "proto/error.pb.h"
 #include "proto/store_internal.pb.h"
+#include "serial/record_decoder.h"
 #include "serial/record_encoder.h"
 #include "serial/schema/boolean_schema.h"
 #include "serial/schema/float_schema.h"
@@ -52,6 +58,8 @@
 
 namespace dingodb {
 
+DECLARE_int64(coprocessor_v2_batch_size);
+
 static const std::string kDefaultCf = "default";
 
 static const std::vector<std::string> kAllCFs = {Constant::kTxnWriteCF, Constant::kTxnDataCF, Constant::kTxnLockCF,
@@ -145,6 +153,8 @@ class CoprocessorTestV2 : public testing::Test {
   void TearDown() override {}
 
   static void DeleteRange();
+  // Execute all the rows round times with the batch size, return the elapsed time in us.
+  static int64_t ExecuteRounds(int64_t batch_size, int round, std::vector<pb::common::KeyValue> &kvs);
 
   static inline std::shared_ptr<RocksRawEngine> engine;
   static inline std::shared_ptr<CoprocessorV2> coprocessor;
@@ -159,6 +169,24 @@ static int64_t Tso2Timestamp(pb::meta::TsoTimestamp tso) {
   return (tso.physical() << ::dingodb::kLogicalBits) + tso.logical();
 }
 
+int64_t CoprocessorTestV2::ExecuteRounds(int64_t batch_size, int round, std::vector<pb::common::KeyValue> &kvs) {
+  IteratorOptions options;
+  options.upper_bound = Helper::PrefixNext(keys.back());
+
+  FLAGS_coprocessor_v2_batch_size = batch_size;
+  int64_t start_time = Helper::TimestampUs();
+  for (int i = 0; i < round; ++i) {
+    kvs.clear();
+    auto iter = engine->Reader()->NewIterator(kDefaultCf, options);
+    iter->Seek(keys.front());
+    bool has_more = false;
+    auto ok = coprocessor->Execute(iter, false, 1000000, 1000000000000000, &kvs, has_more);
+    EXPECT_EQ(ok.error_code(), pb::error::OK);
+    EXPECT_FALSE(has_more);
+  }
+  return Helper::TimestampUs() - start_time;
+}
+
 void CoprocessorTestV2::DeleteRange() {
   const std::string &cf_name = kDefaultCf;
   auto writer = engine->Writer();
@@ -989,6 +1017,108 @@ TEST_F(CoprocessorTestV2, ExecuteTxn) {
   EXPECT_EQ(cnt, keys.size());
 }
 
+// The batch execute get the same rows as the row by row execute.
+TEST_F(CoprocessorTestV2, ExecuteBatch) {
+  gflags::FlagSaver flag_saver;
+  std::sort(keys.begin(), keys.end());
+
+  std::vector<pb::common::KeyValue> row_kvs;
+  ExecuteRounds(0, 1, row_kvs);
+  // Small batch, so the rows are decoded in several batches.
+  std::vector<pb::common::KeyValue> batch_kvs;
+  ExecuteRounds(3, 1, batch_kvs);
+
+  ASSERT_EQ(row_kvs.size(), batch_kvs.size());
+  for (size_t i = 0; i < row_kvs.size(); ++i) {
+    EXPECT_EQ(row_kvs[i].key(), batch_kvs[i].key());
+    EXPECT_EQ(row_kvs[i].value(), batch_kvs[i].value());
+  }
+}
+
+// Run by --gtest_also_run_disabled_tests --gtest_filter=*ExecuteBatchBenchmark.
+TEST_F(CoprocessorTestV2, DISABLED_ExecuteBatchBenchmark) {
+  gflags::FlagSaver flag_saver;
+  std::sort(keys.begin(), keys.end());
+
+  const int round = 1000;
+  int64_t batch_size = FLAGS_coprocessor_v2_batch_size;
+  std::vector<pb::common::KeyValue> row_kvs;
+  int64_t row_time = ExecuteRounds(0, round, row_kvs);
+  std::vector<pb::common::KeyValue> batch_kvs;
+  int64_t batch_time = ExecuteRounds(batch_size, round, batch_kvs);
+
+  DINGO_LOG(INFO) << fmt::format("ExecuteBatchBenchmark rows({}) round({}) row({}us) batch({}us)", keys.size(), round,
+                                 row_time, batch_time);
+  EXPECT_EQ(row_kvs.size(), batch_kvs.size());
+}
+
+// The top n rows are output only once after the last batch of the scan.
+TEST_F(CoprocessorTestV2, ExecuteTopN) {
+  gflags::FlagSaver flag_saver;
+  std::sort(keys.begin(), keys.end());
+
+  pb::common::CoprocessorV2 pb_coprocessor;
+  pb_coprocessor.set_schema_version(1);
+  for (auto *schemas : {pb_coprocessor.mutable_original_schema(), pb_coprocessor.mutable_result_schema()}) {
+    schemas->set_common_id(1);
+    const std::vector<std::pair<pb::common::Schema::Type, bool>> types = {
+        {pb::common::Schema::BOOL, true},    {pb::common::Schema::INTEGER, false}, {pb::common::Schema::FLOAT, false},
+        {pb::common::Schema::LONG, false},   {pb::common::Schema::DOUBLE, true},   {pb::common::Schema::STRING, true}};
+    for (const auto &[type, is_key] : types) {
+      auto *schema = schemas->add_schema();
+      schema->set_type(type);
+      schema->set_is_key(is_key);
+      schema->set_is_nullable(true);
+      schema->set_index(schemas->schema_size() - 1);
+    }
+  }
+  for (int i = 0; i < 6; ++i) {
+    pb_coprocessor.add_selection_columns(i);
+  }
+  pb_coprocessor.set_rel_expr(Helper::StringToHex(std::string_view("7134021442480000930400")));
+  // ORDER BY name_int64 DESC LIMIT 3
+  auto *sort_column = pb_coprocessor.add_sort_columns();
+  sort_column->set_index(3);
+  sort_column->set_is_desc(true);
+  pb_coprocessor.set_top_n(3);
+
+  auto serial_schemas = std::make_shared<std::vector<std::shared_ptr<BaseSchema>>>();
+  ASSERT_TRUE(Utils::TransToSerialSchema(pb_coprocessor.result_schema().schema(), &serial_schemas).ok());
+  RecordDecoder decoder(1, serial_schemas, 1);
+
+  IteratorOptions options;
+  options.upper_bound = Helper::PrefixNext(keys.back());
+  for (int64_t batch_size : {0, 3}) {
+    FLAGS_coprocessor_v2_batch_size = batch_size;
+    auto top_n_coprocessor = std::make_shared<CoprocessorV2>();
+    ASSERT_EQ(top_n_coprocessor->Open(CoprocessorPbWrapper{pb_coprocessor}).error_code(), pb::error::OK);
+
+    auto iter = engine->Reader()->NewIterator(kDefaultCf, options);
+    iter->Seek(keys.front());
+
+    // 2 rows each time, nothing output until the scan finished.
+    std::vector<pb::common::KeyValue> kvs;
+    int execute_count = 0;
+    bool has_more = true;
+    while (has_more) {
+      ASSERT_TRUE(kvs.empty());
+      auto status = top_n_coprocessor->Execute(iter, false, 2, 1000000000000000, &kvs, has_more);
+      ASSERT_EQ(status.error_code(), pb::error::OK);
+      ++execute_count;
+    }
+    EXPECT_GT(execute_count, 1);
+
+    ASSERT_EQ(kvs.size(), 3);
+    std::vector<int64_t> long_values;
+    for (const auto &kv : kvs) {
+      std::vector<std::any> record;
+      ASSERT_EQ(decoder.Decode(kv, record), 0);
+      long_values.push_back(std::any_cast<std::optional<int64_t>>(record[3]).value());
+    }
+    EXPECT_EQ(long_values, std::vector<int64_t>({800, 700, 600}));
+  }
+}
+
 TEST_F(CoprocessorTestV2, FilterKV) {
   butil::Status ok;
   // std::string my_min_key;
@@ -0,0 +1,129 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "butil/iobuf.h"
+#include "common/packed_kv.h"
+#include "proto/common.pb.h"
+
+namespace dingodb {
+
+class PackedKvTest : public testing::Test {
+ protected:
+  static std::vector<pb::common::KeyValue> GenKvs(int count) {
+    std::vector<pb::common::KeyValue> kvs;
+    for (int i = 0; i < count; ++i) {
+      pb::common::KeyValue kv;
+      kv.set_key("key_" + std::to_string(i));
+      // Empty and binary values.
+      kv.set_value(i % 3 == 0 ? std::string() : std::string("\0value_", 7) + std::to_string(i));
+      kvs.push_back(kv);
+    }
+    return kvs;
+  }
+};
+
+TEST_F(PackedKvTest, EncodeDecode) {
+  auto kvs = GenKvs(100);
+  std::string packed;
+  PackedKv::Encode(kvs, packed);
+
+  std::vector<std::pair<std::string_view, std::string_view>> decoded_kvs;
+  ASSERT_TRUE(PackedKv::Decode(packed, kvs.size(), decoded_kvs));
+  ASSERT_EQ(decoded_kvs.size(), kvs.size());
+  for (size_t i = 0; i < kvs.size(); ++i) {
+    EXPECT_EQ(decoded_kvs[i].first, kvs[i].key());
+    EXPECT_EQ(decoded_kvs[i].second, kvs[i].value());
+  }
+
+  // Empty.
+  packed.clear();
+  PackedKv::Encode({}, packed);
+  EXPECT_TRUE(packed.empty());
+  EXPECT_TRUE(PackedKv::Decode(packed, 0, decoded_kvs));
+  EXPECT_TRUE(decoded_kvs.empty());
+}
+
+TEST_F(PackedKvTest, EncodeToIOBuf) {
+  auto kvs = GenKvs(100);
+  std::string packed;
+  PackedKv::Encode(kvs, packed);
+
+  butil::IOBuf buf;
+  buf.append("prefix");
+  PackedKv::Encode(kvs, buf);
+  EXPECT_EQ(buf.to_string(), "prefix" + packed);
+
+  buf.clear();
+  PackedKv::Encode({}, buf);
+  EXPECT_TRUE(buf.empty());
+}
+
+TEST_F(PackedKvTest, DecodeIOBuf) {
+  // Large enough to be split into several blocks.
+  auto kvs = GenKvs(10000);
+  butil::IOBuf buf;
+  PackedKv::Encode(kvs, buf);
+  ASSERT_GT(buf.backing_block_num(), 1);
+
+  std::vector<std::pair<std::string, std::string>> decoded_kvs;
+  ASSERT_TRUE(PackedKv::Decode(buf, kvs.size(), decoded_kvs));
+  ASSERT_EQ(decoded_kvs.size(), kvs.size());
+  for (size_t i = 0; i < kvs.size(); ++i) {
+    EXPECT_EQ(decoded_kvs[i].first, kvs[i].key());
+    EXPECT_EQ(decoded_kvs[i].second, kvs[i].value());
+  }
+
+  // Count mismatch.
+  EXPECT_FALSE(PackedKv::Decode(buf, kvs.size() - 1, decoded_kvs));
+  EXPECT_FALSE(PackedKv::Decode(buf, kvs.size() + 1, decoded_kvs));
+  // Truncated.
+  butil::IOBuf truncated = buf;
+  truncated.pop_back(1);
+  EXPECT_FALSE(PackedKv::Decode(truncated, kvs.size(), decoded_kvs));
+  EXPECT_TRUE(decoded_kvs.empty());
+
+  buf.clear();
+  EXPECT_TRUE(PackedKv::Decode(buf, 0, decoded_kvs));
+  EXPECT_TRUE(decoded_kvs.empty());
+}
+
+TEST_F(PackedKvTest, Corrupted) {
+  auto kvs = GenKvs(10);
+  std::string packed;
+  PackedKv::Encode(kvs, packed);
+
+  std::vector<std::pair<std::string_view, std::string_view>> decoded_kvs;
+  // Count mismatch.
+  EXPECT_FALSE(PackedKv::Decode(packed, 9, decoded_kvs));
+  EXPECT_FALSE(PackedKv::Decode(packed, 11, decoded_kvs));
+  EXPECT_FALSE(PackedKv::Decode(packed, -1, decoded_kvs));
+  // Truncated.
+  EXPECT_FALSE(PackedKv::Decode(std::string_view(packed).substr(0, packed.size() - 1), 10, decoded_kvs));
+  EXPECT_TRUE(decoded_kvs.empty());
+
+  // Offset out of the data.
+  std::string bad = packed;
+  bad[3] = '\x7F';
+  EXPECT_FALSE(PackedKv::Decode(bad, 10, decoded_kvs));
+}
+
+}  // namespace dingodb
@@ -587,6 +587,36 @@ TEST_F(RawRocksEngineTest, KvGet) {
   }
 }
 
+TEST_F(RawRocksEngineTest, KvBatchGetValues) {
+  const std::string &cf_name = kDefaultCf;
+  auto reader = RawRocksEngineTest::engine->Reader();
+
+  // key empty
+  {
+    std::vector<std::string> keys{"key1", ""};
+    std::vector<std::string> values;
+
+    butil::Status ok = reader->KvBatchGet(cf_name, keys, values);
+    EXPECT_EQ(ok.error_code(), pb::error::Errno::EKEY_EMPTY);
+  }
+
+  // same order as keys, empty value when not found
+  {
+    std::vector<std::string> keys{"key1", "key_not_exist_for_batch_get", "key1"};
+    std::vector<std::string> values;
+
+    butil::Status ok = reader->KvBatchGet(cf_name, keys, values);
+    EXPECT_EQ(ok.error_code(), pb::error::Errno::OK);
+    ASSERT_EQ(values.size(), keys.size());
+
+    std::string value;
+    reader->KvGet(cf_name, "key1", value);
+    EXPECT_EQ(values[0], value);
+    EXPECT_TRUE(values[1].empty());
+    EXPECT_EQ(values[2], value);
+  }
+}
+
 #ifdef TEST_KV_BATCH_GET_SWITCH
 TEST_F(RawRocksEngineTest, KvBatchGet) {
   const std::string &cf_name = kDefaultCf;
@@ -18,15 +18,19 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <any>
 #include <cstddef>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <exception>
 #include <iostream>
+#include <map>
 #include <memory>
+#include <optional>
 #include <string>
 #include <thread>
+#include <utility>
 #include <vector>
 
 #include "butil/status.h"
@@ -35,12 +39,21 @@
 #include "config/yaml_config.h"
 #include "crontab/crontab.h"
 #include "engine/rocks_raw_engine.h"
+#include "gflags/gflags.h"
 #include "proto/common.pb.h"
+#include "proto/error.pb.h"
+#include "proto/store.pb.h"
 #include "scan/scan.h"
 #include "scan/scan_manager.h"
+#include "serial/record_decoder.h"
+#include "serial/record_encoder.h"
+#include "serial/schema/long_schema.h"
 
 namespace dingodb {
 
+DECLARE_int32(coprocessor_scan_parallelism);
+DECLARE_int64(coprocessor_parallel_scan_min_size);
+
 static const std::string &kDefaultCf = "default";  // NOLINT
 
 static const std::vector<std::string> kAllCFs = {kDefaultCf};
@@ -957,4 +970,150 @@ TEST_F(ScanTest, KvDeleteRange) {
   }
 }
 
+TEST_F(ScanTest, MergeRangeBySize) {
+  std::vector<dingodb::pb::common::Range> ranges;
+  for (char c = 'a'; c < 'i'; ++c) {
+    auto &range = ranges.emplace_back();
+    range.set_start_key(std::string(1, c));
+    range.set_end_key(std::string(1, c + 1));
+  }
+
+  // Similar sizes.
+  auto merged_ranges = ScanHandler::MergeRangeBySize(ranges, {10, 10, 10, 10, 10, 10, 10, 10}, 4, 0);
+  ASSERT_EQ(merged_ranges.size(), 4);
+  EXPECT_EQ(merged_ranges[0].start_key(), "a");
+  EXPECT_EQ(merged_ranges[0].end_key(), "c");
+  EXPECT_EQ(merged_ranges[3].start_key(), "g");
+  EXPECT_EQ(merged_ranges[3].end_key(), "i");
+
+  // Skewed sizes.
+  merged_ranges = ScanHandler::MergeRangeBySize(ranges, {100, 1, 1, 1, 1, 1, 1, 100}, 2, 0);
+  ASSERT_EQ(merged_ranges.size(), 2);
+  EXPECT_EQ(merged_ranges[0].end_key(), "e");
+  EXPECT_EQ(merged_ranges[1].start_key(), "e");
+
+  // Too small to split.
+  merged_ranges = ScanHandler::MergeRangeBySize(ranges, {10, 10, 10, 10, 10, 10, 10, 10}, 4, 100);
+  ASSERT_EQ(merged_ranges.size(), 1);
+  EXPECT_EQ(merged_ranges[0].start_key(), "a");
+  EXPECT_EQ(merged_ranges[0].end_key(), "i");
+
+  // No size, split by count.
+  merged_ranges = ScanHandler::MergeRangeBySize(ranges, {0, 0, 0, 0, 0, 0, 0, 0}, 2, 0);
+  ASSERT_EQ(merged_ranges.size(), 2);
+  EXPECT_EQ(merged_ranges[0].end_key(), "e");
+}
+
+static const int64_t kAggregationCommonId = 10001;
+
+static std::shared_ptr<std::vector<std::shared_ptr<BaseSchema>>> GenLongSchemas(int count, int key_count) {
+  auto schemas = std::make_shared<std::vector<std::shared_ptr<BaseSchema>>>();
+  for (int i = 0; i < count; ++i) {
+    auto schema = std::make_shared<DingoSchema<std::optional<int64_t>>>();
+    schema->SetIsKey(i < key_count);
+    schema->SetAllowNull(true);
+    schema->SetIndex(i);
+    schemas->push_back(schema);
+  }
+  return schemas;
+}
+
+// Aggregate SUM(value) and COUNT(value) group by group of the rows (id, group, value), group = id % 3, value = id.
+static std::map<int64_t, std::pair<int64_t, int64_t>> ScanAggregation(std::shared_ptr<RocksRawEngine> engine,
+                                                                      const pb::common::Range &range) {
+  pb::store::Coprocessor pb_coprocessor;
+  pb_coprocessor.set_schema_version(1);
+
+  auto *original_schema = pb_coprocessor.mutable_original_schema();
+  original_schema->set_common_id(kAggregationCommonId);
+  for (int i = 0; i < 3; ++i) {
+    auto *schema = original_schema->add_schema();
+    schema->set_type(pb::common::Schema::LONG);
+    schema->set_is_key(i == 0);
+    schema->set_is_nullable(true);
+    schema->set_index(i);
+  }
+  pb_coprocessor.add_selection_columns(0);
+  pb_coprocessor.add_selection_columns(1);
+  pb_coprocessor.add_selection_columns(2);
+  pb_coprocessor.add_group_by_columns(1);
+
+  auto *sum_operator = pb_coprocessor.add_aggregation_operators();
+  sum_operator->set_oper(pb::store::AggregationType::SUM);
+  sum_operator->set_index_of_column(2);
+  auto *count_operator = pb_coprocessor.add_aggregation_operators();
+  count_operator->set_oper(pb::store::AggregationType::COUNT);
+  count_operator->set_index_of_column(2);
+
+  auto *result_schema = pb_coprocessor.mutable_result_schema();
+  result_schema->set_common_id(kAggregationCommonId);
+  for (int i = 0; i < 3; ++i) {
+    auto *schema = result_schema->add_schema();
+    schema->set_type(pb::common::Schema::LONG);
+    schema->set_is_key(i == 0);
+    schema->set_is_nullable(true);
+    schema->set_index(i);
+  }
+
+  std::string scan_id;
+  auto scan = ScanManager::GetInstance().CreateScan(&scan_id);
+  EXPECT_TRUE(scan->Open(scan_id, engine, kDefaultCf).ok());
+
+  std::vector<pb::common::KeyValue> kvs;
+  auto status = ScanHandler::ScanBegin(scan, 1, range, 100, false, true, false, CoprocessorPbWrapper{pb_coprocessor},
+                                       &kvs);
+  EXPECT_EQ(status.error_code(), pb::error::Errno::OK) << status.error_str();
+  ScanManager::GetInstance().DeleteScan(scan_id);
+
+  RecordDecoder decoder(1, GenLongSchemas(3, 1), kAggregationCommonId);
+  std::map<int64_t, std::pair<int64_t, int64_t>> results;
+  for (const auto &kv : kvs) {
+    std::vector<std::any> record;
+    EXPECT_EQ(decoder.Decode(kv, record), 0);
+    results[std::any_cast<std::optional<int64_t>>(record[0]).value()] = {
+        std::any_cast<std::optional<int64_t>>(record[1]).value(),
+        std::any_cast<std::optional<int64_t>>(record[2]).value()};
+  }
+  return results;
+}
+
+TEST_F(ScanTest, ParallelAggregate) {
+  gflags::FlagSaver flag_saver;
+  auto raw_rocks_engine = this->GetRawRocksEngine();
+
+  const int64_t row_count = 3000;
+  RecordEncoder encoder(1, GenLongSchemas(3, 1), kAggregationCommonId);
+  std::vector<pb::common::KeyValue> kvs;
+  std::map<int64_t, std::pair<int64_t, int64_t>> expect_results;
+  for (int64_t id = 0; id < row_count; ++id) {
+    std::vector<std::any> record = {std::optional<int64_t>(id), std::optional<int64_t>(id % 3),
+                                    std::optional<int64_t>(id)};
+    ASSERT_EQ(encoder.Encode(record, kvs.emplace_back()), 0);
+    expect_results[id % 3].first += id;
+    expect_results[id % 3].second += 1;
+  }
+  ASSERT_TRUE(raw_rocks_engine->Writer()->KvBatchPutAndDelete(kDefaultCf, kvs, {}).ok());
+
+  pb::common::Range range;
+  std::string key_prefix;
+  ASSERT_EQ(encoder.EncodeMinKeyPrefix(key_prefix), 0);
+  range.set_start_key(key_prefix);
+  ASSERT_EQ(encoder.EncodeMaxKeyPrefix(key_prefix), 0);
+  range.set_end_key(key_prefix);
+
+  // Serial.
+  FLAGS_coprocessor_scan_parallelism = 1;
+  auto serial_results = ScanAggregation(raw_rocks_engine, range);
+  EXPECT_EQ(serial_results, expect_results);
+
+  // Parallel, the range is split into several sub ranges.
+  FLAGS_coprocessor_scan_parallelism = 4;
+  FLAGS_coprocessor_parallel_scan_min_size = 0;
+  ASSERT_GT(ScanHandler::SplitRange(raw_rocks_engine, kDefaultCf, range, 4, 0).size(), 1);
+  auto parallel_results = ScanAggregation(raw_rocks_engine, range);
+  EXPECT_EQ(parallel_results, serial_results);
+
+  ASSERT_TRUE(raw_rocks_engine->Writer()->KvDeleteRange(kDefaultCf, range).ok());
+}
+
 }  // namespace dingodb
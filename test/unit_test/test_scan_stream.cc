@@ -0,0 +1,314 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "brpc/channel.h"
+#include "brpc/controller.h"
+#include "brpc/server.h"
+#include "brpc/stream.h"
+#include "bthread/bthread.h"
+#include "bthread/condition_variable.h"
+#include "bthread/mutex.h"
+#include "butil/iobuf.h"
+#include "butil/time.h"
+#include "common/helper.h"
+#include "common/packed_kv.h"
+#include "config/yaml_config.h"
+#include "engine/rocks_raw_engine.h"
+#include "fmt/core.h"
+#include "proto/common.pb.h"
+#include "proto/error.pb.h"
+#include "proto/store.pb.h"
+#include "scan/scan.h"
+#include "scan/scan_manager.h"
+#include "scan/scan_stream.h"
+
+namespace dingodb {
+
+static const std::string kScanStreamCf = "default";
+static const std::string kScanStreamRootPath = "./unit_test_scan_stream";
+static const std::string kScanStreamLogPath = kScanStreamRootPath + "/log";
+static const std::string kScanStreamStorePath = kScanStreamRootPath + "/db";
+static const std::string kScanStreamYamlConfigContent =
+    "cluster:\n"
+    "  name: dingodb\n"
+    "  instance_id: 12345\n"
+    "server:\n"
+    "  host: 127.0.0.1\n"
+    "  port: 23000\n"
+    "log:\n"
+    "  path: " +
+    kScanStreamLogPath +
+    "\n"
+    "store:\n"
+    "  path: " +
+    kScanStreamStorePath + "\n";
+static const int kScanStreamPort = 20301;
+
+// Serve KvScanStream of the range over the engine as the store does, without region and raft.
+class ScanStreamTestService : public pb::store::StoreService {
+ public:
+  explicit ScanStreamTestService(std::shared_ptr<RocksRawEngine> engine) : engine_(std::move(engine)) {}
+
+  void KvScanStream(google::protobuf::RpcController* controller, const pb::store::KvScanStreamRequest* request,
+                    pb::store::KvScanStreamResponse* response, google::protobuf::Closure* done) override {
+    brpc::ClosureGuard done_guard(done);
+    auto* cntl = static_cast<brpc::Controller*>(controller);
+
+    // Nothing to scan if the range is empty.
+    std::shared_ptr<ScanContext> scan;
+    std::string scan_id;
+    const auto& range = request->range().range();
+    if (range.start_key() < range.end_key()) {
+      ScanManager& manager = ScanManager::GetInstance();
+      scan = std::make_shared<ScanContext>();
+      scan->Init(manager.GetTimeoutMs(), manager.GetMaxBytesRpc(), manager.GetMaxFetchCntByServer());
+      scan_id = fmt::format("scan_stream_{}", ++scan_count_);
+      auto status = scan->Open(scan_id, engine_, kScanStreamCf);
+      if (status.ok()) {
+        std::vector<pb::common::KeyValue> kvs;
+        status = ScanHandler::ScanBegin(scan, 1, range, 0, request->key_only(), true, true, {}, &kvs);
+      }
+      if (!status.ok()) {
+        response->mutable_error()->set_errcode(static_cast<pb::error::Errno>(status.error_code()));
+        return;
+      }
+      last_scan_ = scan;
+    }
+
+    auto status = ScanStream::Start(cntl, scan, scan_id, request->batch_size(), request->window_size());
+    if (!status.ok()) {
+      response->mutable_error()->set_errcode(static_cast<pb::error::Errno>(status.error_code()));
+    }
+  }
+
+  // The scan context of the last request, released when its stream is finished.
+  std::weak_ptr<ScanContext> LastScan() const { return last_scan_; }
+
+ private:
+  std::shared_ptr<RocksRawEngine> engine_;
+  int64_t scan_count_{0};
+  std::weak_ptr<ScanContext> last_scan_;
+};
+
+// Collect the pushed messages of the client stream.
+class ScanStreamTestHandler : public brpc::StreamInputHandler {
+ public:
+  // hold_first: the first call of on_received_messages is held until Release.
+  explicit ScanStreamTestHandler(bool hold_first = false) : hold_first_(hold_first) {}
+
+  int on_received_messages(brpc::StreamId /*id*/, butil::IOBuf* const messages[], size_t size) override {
+    std::unique_lock<bthread::Mutex> lk(mutex_);
+    for (size_t i = 0; i < size; ++i) {
+      pb::store::KvScanStreamMessage message;
+      butil::IOBufAsZeroCopyInputStream input(*messages[i]);
+      EXPECT_TRUE(message.ParseFromZeroCopyStream(&input));
+      messages_.push_back(std::move(message));
+    }
+    cv_.notify_all();
+
+    // The window is not given back to the store until the held handler returns.
+    while (hold_first_) {
+      cv_.wait(lk);
+    }
+    return 0;
+  }
+
+  void on_idle_timeout(brpc::StreamId /*id*/) override {}
+
+  void on_closed(brpc::StreamId /*id*/) override {
+    std::unique_lock<bthread::Mutex> lk(mutex_);
+    closed_ = true;
+    cv_.notify_all();
+  }
+
+  void WaitMessages(size_t count) {
+    std::unique_lock<bthread::Mutex> lk(mutex_);
+    while (messages_.size() < count && !closed_) {
+      cv_.wait(lk);
+    }
+  }
+
+  void Release() {
+    std::unique_lock<bthread::Mutex> lk(mutex_);
+    hold_first_ = false;
+    cv_.notify_all();
+  }
+
+  std::vector<pb::store::KvScanStreamMessage> WaitClosed() {
+    std::unique_lock<bthread::Mutex> lk(mutex_);
+    while (!closed_) {
+      cv_.wait(lk);
+    }
+    return messages_;
+  }
+
+ private:
+  bthread::Mutex mutex_;
+  bthread::ConditionVariable cv_;
+  bool hold_first_;
+  bool closed_{false};
+  std::vector<pb::store::KvScanStreamMessage> messages_;
+};
+
+class ScanStreamTest : public testing::Test {
+ protected:
+  static void SetUpTestSuite() {
+    Helper::CreateDirectories(kScanStreamStorePath);
+
+    std::shared_ptr<Config> config = std::make_shared<YamlConfig>();
+    if (config->Load(kScanStreamYamlConfigContent) != 0) {
+      std::cout << "Load config failed" << '\n';
+      return;
+    }
+
+    engine = std::make_shared<RocksRawEngine>();
+    if (!engine->Init(config, {kScanStreamCf})) {
+      std::cout << "RocksRawEngine init failed" << '\n';
+      return;
+    }
+
+    std::vector<pb::common::KeyValue> kvs;
+    for (int i = 0; i < kKvCount; ++i) {
+      auto& kv = kvs.emplace_back();
+      kv.set_key(fmt::format("key_{:04}", i));
+      kv.set_value(fmt::format("value_{}", i));
+    }
+    engine->Writer()->KvBatchPutAndDelete(kScanStreamCf, kvs, {});
+
+    service = std::make_unique<ScanStreamTestService>(engine);
+    server = std::make_unique<brpc::Server>();
+    if (server->AddService(service.get(), brpc::SERVER_DOESNT_OWN_SERVICE) != 0) {
+      std::cout << "Add scan stream service failed" << '\n';
+      return;
+    }
+    if (server->Start(kScanStreamPort, nullptr) != 0) {
+      std::cout << "Start scan stream server failed" << '\n';
+    }
+  }
+
+  static void TearDownTestSuite() {
+    server->Stop(0);
+    server->Join();
+    server.reset();
+    service.reset();
+    engine->Close();
+    engine->Destroy();
+    Helper::RemoveAllFileOrDirectory(kScanStreamRootPath);
+  }
+
+  // Send KvScanStream with a new client stream of handler.
+  static void StartScan(const std::string& start_key, const std::string& end_key, int64_t batch_size,
+                        int64_t window_size, ScanStreamTestHandler& handler, brpc::StreamId& stream_id) {
+    brpc::Channel channel;
+    ASSERT_EQ(channel.Init(fmt::format("127.0.0.1:{}", kScanStreamPort).c_str(), nullptr), 0);
+    pb::store::StoreService_Stub stub(&channel);
+
+    brpc::Controller cntl;
+    brpc::StreamOptions options;
+    options.handler = &handler;
+    ASSERT_EQ(brpc::StreamCreate(&stream_id, cntl, &options), 0);
+
+    pb::store::KvScanStreamRequest request;
+    request.mutable_range()->mutable_range()->set_start_key(start_key);
+    request.mutable_range()->mutable_range()->set_end_key(end_key);
+    request.set_batch_size(batch_size);
+    request.set_window_size(window_size);
+    pb::store::KvScanStreamResponse response;
+    stub.KvScanStream(&cntl, &request, &response, nullptr);
+    ASSERT_FALSE(cntl.Failed()) << cntl.ErrorText();
+    ASSERT_EQ(response.error().errcode(), pb::error::Errno::OK);
+  }
+
+  static constexpr int kKvCount = 100;
+
+  static inline std::shared_ptr<RocksRawEngine> engine;
+  static inline std::unique_ptr<ScanStreamTestService> service;
+  static inline std::unique_ptr<brpc::Server> server;
+};
+
+TEST_F(ScanStreamTest, NothingToScan) {
+  ScanStreamTestHandler handler;
+  brpc::StreamId stream_id = brpc::INVALID_STREAM_ID;
+  StartScan("key_0010", "key_0010", 10, 0, handler, stream_id);
+
+  // Only an empty message, then the store closes the stream.
+  auto messages = handler.WaitClosed();
+  ASSERT_EQ(messages.size(), 1);
+  EXPECT_EQ(messages[0].error().errcode(), pb::error::Errno::OK);
+  EXPECT_EQ(messages[0].packed_kv_count(), 0);
+  EXPECT_FALSE(messages[0].has_more());
+}
+
+TEST_F(ScanStreamTest, ScanAll) {
+  ScanStreamTestHandler handler;
+  brpc::StreamId stream_id = brpc::INVALID_STREAM_ID;
+  StartScan("key_0000", "key_9999", 10, 0, handler, stream_id);
+
+  auto messages = handler.WaitClosed();
+  ASSERT_GE(messages.size(), static_cast<size_t>(kKvCount / 10));
+  EXPECT_FALSE(messages.back().has_more());
+
+  int i = 0;
+  for (const auto& message : messages) {
+    ASSERT_EQ(message.error().errcode(), pb::error::Errno::OK);
+    EXPECT_LE(message.packed_kv_count(), 10);
+    std::vector<std::pair<std::string_view, std::string_view>> kvs;
+    ASSERT_TRUE(PackedKv::Decode(message.packed_kvs(), message.packed_kv_count(), kvs));
+    for (const auto& [key, value] : kvs) {
+      EXPECT_EQ(key, fmt::format("key_{:04}", i));
+      EXPECT_EQ(value, fmt::format("value_{}", i));
+      ++i;
+    }
+  }
+  EXPECT_EQ(i, kKvCount);
+}
+
+TEST_F(ScanStreamTest, ClientCloseMidScan) {
+  // The first message fills the window and is held, so the store waits for the window.
+  ScanStreamTestHandler handler(true);
+  brpc::StreamId stream_id = brpc::INVALID_STREAM_ID;
+  StartScan("key_0000", "key_9999", 1, 1, handler, stream_id);
+  handler.WaitMessages(1);
+  auto scan = service->LastScan();
+  EXPECT_FALSE(scan.expired());
+
+  brpc::StreamClose(stream_id);
+  handler.Release();
+  auto messages = handler.WaitClosed();
+  ASSERT_GE(messages.size(), 1);
+  EXPECT_LT(messages.size(), static_cast<size_t>(kKvCount));
+  EXPECT_EQ(messages[0].packed_kv_count(), 1);
+  EXPECT_TRUE(messages[0].has_more());
+
+  // The store stops scanning and releases the scan context.
+  int64_t deadline_ms = butil::gettimeofday_ms() + 10 * 1000;
+  while (!scan.expired() && butil::gettimeofday_ms() < deadline_ms) {
+    bthread_usleep(10 * 1000);
+  }
+  EXPECT_TRUE(scan.expired());
+}
+
+}  // namespace dingodb
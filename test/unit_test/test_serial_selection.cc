@@ -276,4 +276,47 @@ TEST_F(DingoSerialTest, keyvaluecodeStringLoopTest) {
 //   auto decode_s_duration = std::chrono::duration_cast<std::chrono::milliseconds>(decode_s_end_time -
 //   decode_s_s_end_time); std::cout << "Decode selection Time taken: " << decode_s_duration.count() << " milliseconds"
 //   << '\n'; std::cout << "Decode selection output records size:" << decoded_s_records.size() << '\n';
-// }
\ No newline at end of file
+// }
+TEST_F(DingoSerialTest, decodePartAndRestTest) {
+  InitVector();
+  InitRecord();
+  auto schemas = GetSchemas();
+  RecordEncoder re(0, schemas, 0L, this->le);
+  pb::common::KeyValue kv;
+  ASSERT_EQ(re.Encode(*GetRecord(), kv), 0);
+
+  RecordDecoder rd(0, schemas, 0L, this->le);
+  // Key and value columns out of the schema order, the part columns are walked over by the rest columns.
+  std::vector<int> column_indexes = {8, 1, 4, 3, 10, 6, 0};
+  std::vector<bool> is_part = {true, false, false, true, false, false, false};
+  std::vector<std::any> expected_record;
+  ASSERT_EQ(rd.Decode(kv, column_indexes, expected_record), 0);
+
+  RecordDecodeCursor cursor;
+  for (int loop = 0; loop < 2; ++loop) {
+    std::vector<std::any> record;
+    ASSERT_EQ(rd.DecodePart(kv.key(), kv.value(), column_indexes, is_part, cursor, record), 0);
+    ASSERT_EQ(record.size(), column_indexes.size());
+    EXPECT_EQ(any_cast<optional<int32_t>>(record[0]), any_cast<optional<int32_t>>(expected_record[0]));
+    EXPECT_EQ(any_cast<optional<int64_t>>(record[3]), any_cast<optional<int64_t>>(expected_record[3]));
+    EXPECT_FALSE(any_cast<optional<shared_ptr<string>>>(record[1]).has_value());
+    EXPECT_FALSE(any_cast<optional<double>>(record[4]).has_value());
+    EXPECT_FALSE(any_cast<optional<int32_t>>(record[6]).has_value());
+
+    ASSERT_EQ(rd.DecodeRest(is_part, cursor, record), 0);
+    EXPECT_EQ(*any_cast<optional<shared_ptr<string>>>(record[1]).value(),
+              *any_cast<optional<shared_ptr<string>>>(expected_record[1]).value());
+    EXPECT_EQ(*any_cast<optional<shared_ptr<string>>>(record[2]).value(),
+              *any_cast<optional<shared_ptr<string>>>(expected_record[2]).value());
+    EXPECT_EQ(any_cast<optional<double>>(record[4]), any_cast<optional<double>>(expected_record[4]));
+    EXPECT_FALSE(any_cast<optional<shared_ptr<string>>>(record[5]).has_value());
+    EXPECT_EQ(any_cast<optional<int32_t>>(record[6]), any_cast<optional<int32_t>>(expected_record[6]));
+  }
+
+  std::vector<std::any> record;
+  EXPECT_EQ(rd.DecodePart(kv.key(), kv.value(), {11}, {true}, cursor, record), -1);
+
+  DeleteRecords();
+  delete GetRecord();
+  DeleteSchemas();
+}
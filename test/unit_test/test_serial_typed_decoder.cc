@@ -0,0 +1,226 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <any>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "proto/common.pb.h"
+#include "serial/record_decoder.h"
+#include "serial/record_encoder.h"
+#include "serial/typed_record_decoder.h"
+#include "serial/utils.h"
+
+namespace dingodb {
+
+class DingoSerialTypedDecoderTest : public testing::Test {
+ protected:
+  template <typename T>
+  static void AddSchema(std::shared_ptr<std::vector<std::shared_ptr<BaseSchema>>>& schemas, bool is_key,
+                        bool allow_null) {
+    auto schema = std::make_shared<DingoSchema<std::optional<T>>>();
+    schema->SetIndex(schemas->size());
+    schema->SetIsKey(is_key);
+    schema->SetAllowNull(allow_null);
+    schemas->push_back(schema);
+  }
+
+  static std::shared_ptr<std::vector<std::shared_ptr<BaseSchema>>> GenSchemas() {
+    auto schemas = std::make_shared<std::vector<std::shared_ptr<BaseSchema>>>();
+    AddSchema<int32_t>(schemas, true, false);                           // 0
+    AddSchema<std::shared_ptr<std::string>>(schemas, true, true);       // 1
+    AddSchema<int64_t>(schemas, true, false);                           // 2
+    AddSchema<double>(schemas, true, false);                            // 3
+    AddSchema<float>(schemas, true, false);                             // 4
+    AddSchema<std::shared_ptr<std::string>>(schemas, false, true);      // 5
+    AddSchema<bool>(schemas, false, false);                             // 6
+    AddSchema<int32_t>(schemas, false, true);                           // 7
+    AddSchema<std::shared_ptr<std::vector<double>>>(schemas, false, true);  // 8
+    AddSchema<float>(schemas, false, false);                            // 9
+    AddSchema<int64_t>(schemas, false, true);                           // 10
+    AddSchema<std::shared_ptr<std::string>>(schemas, false, false);     // 11
+    return schemas;
+  }
+
+  static std::vector<std::any> GenRecord(int i) {
+    std::vector<std::any> record(12);
+    record[0] = std::optional<int32_t>(i % 2 == 0 ? i : -i);
+    // Cover the empty, full group and partial group key string.
+    record[1] = i % 5 == 0 ? std::optional<std::shared_ptr<std::string>>(std::nullopt)
+                           : std::optional<std::shared_ptr<std::string>>(
+                                 std::make_shared<std::string>(std::string(i % 19, 'a' + i % 26)));
+    record[2] = std::optional<int64_t>(i % 3 == 0 ? -214748364700L * i : 214748364700L * i);
+    record[3] = std::optional<double>(i % 2 == 0 ? i * 1.5 : -i * 1.5);
+    record[4] = std::optional<float>(i % 2 == 0 ? i * 0.25F : -i * 0.25F);
+    record[5] = i % 4 == 0 ? std::optional<std::shared_ptr<std::string>>(std::nullopt)
+                           : std::optional<std::shared_ptr<std::string>>(
+                                 std::make_shared<std::string>("value_" + std::to_string(i)));
+    record[6] = std::optional<bool>(i % 2 == 0);
+    record[7] = i % 3 == 0 ? std::optional<int32_t>(std::nullopt) : std::optional<int32_t>(-i);
+    record[8] = std::optional<std::shared_ptr<std::vector<double>>>(
+        std::make_shared<std::vector<double>>(i % 4, 1.0 * i));
+    record[9] = std::optional<float>(i * 3.5F);
+    record[10] = std::optional<int64_t>(i * 1000L);
+    record[11] = std::optional<std::shared_ptr<std::string>>(std::make_shared<std::string>(std::to_string(i)));
+    return record;
+  }
+
+  template <typename T>
+  static void ExpectFixedEqual(const ColumnBuffer& column, size_t row, const std::any& expect) {
+    const auto& typed_column = std::get<TypedColumn<T>>(column);
+    auto value = std::any_cast<std::optional<T>>(expect);
+    ASSERT_EQ(typed_column.IsNull(row), !value.has_value());
+    if (value.has_value()) {
+      EXPECT_EQ(typed_column.values[row], value.value());
+    }
+  }
+
+  static void ExpectStringEqual(const ColumnBuffer& column, size_t row, const std::any& expect) {
+    const auto& string_column = std::get<StringColumn>(column);
+    auto value = std::any_cast<std::optional<std::shared_ptr<std::string>>>(expect);
+    ASSERT_EQ(string_column.IsNull(row), !value.has_value());
+    if (value.has_value()) {
+      EXPECT_EQ(string_column.values[row], *value.value());
+    }
+  }
+
+  static constexpr int64_t kCommonId = 1001;
+};
+
+TEST_F(DingoSerialTypedDecoderTest, DecodeSameAsRecordDecoder) {
+  auto schemas = GenSchemas();
+  RecordEncoder encoder(1, schemas, kCommonId);
+  RecordDecoder decoder(1, schemas, kCommonId);
+  TypedRecordDecoder typed_decoder(1, schemas, kCommonId);
+
+  // Out of order selection and skip the list column.
+  std::vector<int> column_indexes = {11, 0, 1, 2, 3, 4, 5, 6, 7, 9, 10};
+  ASSERT_EQ(typed_decoder.Init(column_indexes), 0);
+  auto columns = typed_decoder.NewColumns();
+  ASSERT_EQ(columns.size(), column_indexes.size());
+
+  int row_count = 100;
+  std::vector<pb::common::KeyValue> kvs(row_count);
+  for (int i = 0; i < row_count; ++i) {
+    ASSERT_EQ(encoder.Encode(GenRecord(i), kvs[i]), 0);
+    ASSERT_EQ(typed_decoder.Decode(kvs[i].key(), kvs[i].value(), columns), 0);
+  }
+
+  for (int i = 0; i < row_count; ++i) {
+    std::vector<std::any> record;
+    ASSERT_EQ(decoder.Decode(kvs[i], column_indexes, record), 0);
+
+    ExpectStringEqual(columns[0], i, record[0]);
+    ExpectFixedEqual<int32_t>(columns[1], i, record[1]);
+    ExpectStringEqual(columns[2], i, record[2]);
+    ExpectFixedEqual<int64_t>(columns[3], i, record[3]);
+    ExpectFixedEqual<double>(columns[4], i, record[4]);
+    ExpectFixedEqual<float>(columns[5], i, record[5]);
+    ExpectStringEqual(columns[6], i, record[6]);
+    ExpectFixedEqual<bool>(columns[7], i, record[7]);
+    ExpectFixedEqual<int32_t>(columns[8], i, record[8]);
+    ExpectFixedEqual<float>(columns[9], i, record[9]);
+    ExpectFixedEqual<int64_t>(columns[10], i, record[10]);
+  }
+
+  // Value string is a view into the source value.
+  const auto& value = kvs[1].value();
+  auto view = std::get<StringColumn>(columns[0]).values[1];
+  EXPECT_GE(view.data(), value.data());
+  EXPECT_LE(view.data() + view.size(), value.data() + value.size());
+
+  for (auto& column : columns) {
+    std::visit([](auto& typed_column) { typed_column.Clear(); }, column);
+  }
+  EXPECT_EQ(std::get<StringColumn>(columns[0]).Size(), 0);
+}
+
+// The float schema is always le, the other fixed columns follow the byte order of the decoder.
+TEST_F(DingoSerialTypedDecoderTest, DecodeBigEndian) {
+  auto schemas = GenSchemas();
+  RecordEncoder encoder(1, schemas, kCommonId, false);
+  RecordDecoder decoder(1, schemas, kCommonId, false);
+  TypedRecordDecoder typed_decoder(1, schemas, kCommonId, false);
+
+  std::vector<int> column_indexes = {0, 2, 3, 4, 7, 9, 10};
+  ASSERT_EQ(typed_decoder.Init(column_indexes), 0);
+  auto columns = typed_decoder.NewColumns();
+
+  int row_count = 20;
+  std::vector<pb::common::KeyValue> kvs(row_count);
+  for (int i = 0; i < row_count; ++i) {
+    ASSERT_EQ(encoder.Encode(GenRecord(i), kvs[i]), 0);
+    ASSERT_EQ(typed_decoder.Decode(kvs[i].key(), kvs[i].value(), columns), 0);
+  }
+
+  for (int i = 0; i < row_count; ++i) {
+    std::vector<std::any> record;
+    ASSERT_EQ(decoder.Decode(kvs[i], column_indexes, record), 0);
+
+    ExpectFixedEqual<int32_t>(columns[0], i, record[0]);
+    ExpectFixedEqual<int64_t>(columns[1], i, record[1]);
+    ExpectFixedEqual<double>(columns[2], i, record[2]);
+    ExpectFixedEqual<float>(columns[3], i, record[3]);
+    ExpectFixedEqual<int32_t>(columns[4], i, record[4]);
+    ExpectFixedEqual<float>(columns[5], i, record[5]);
+    ExpectFixedEqual<int64_t>(columns[6], i, record[6]);
+  }
+}
+
+TEST_F(DingoSerialTypedDecoderTest, NewColumnIsNull) {
+  auto schemas = GenSchemas();
+  RecordEncoder encoder(1, schemas, kCommonId);
+  pb::common::KeyValue kv;
+  ASSERT_EQ(encoder.Encode(GenRecord(7), kv), 0);
+
+  // Column added after the record written.
+  AddSchema<double>(schemas, false, true);
+  TypedRecordDecoder typed_decoder(2, schemas, kCommonId);
+  ASSERT_EQ(typed_decoder.Init({0, 12}), 0);
+  auto columns = typed_decoder.NewColumns();
+  ASSERT_EQ(typed_decoder.Decode(kv.key(), kv.value(), columns), 0);
+  EXPECT_EQ(std::get<TypedColumn<int32_t>>(columns[0]).values[0], -7);
+  EXPECT_TRUE(std::get<TypedColumn<double>>(columns[1]).IsNull(0));
+}
+
+TEST_F(DingoSerialTypedDecoderTest, InvalidSelection) {
+  auto schemas = GenSchemas();
+  TypedRecordDecoder typed_decoder(1, schemas, kCommonId);
+
+  // List column not supported.
+  EXPECT_EQ(typed_decoder.Init({8}), -1);
+  // Out of range and duplicated column.
+  EXPECT_EQ(typed_decoder.Init({12}), -1);
+  EXPECT_EQ(typed_decoder.Init({1, 1}), -1);
+
+  ASSERT_EQ(typed_decoder.Init({0}), 0);
+  RecordEncoder encoder(1, schemas, kCommonId);
+  pb::common::KeyValue kv;
+  ASSERT_EQ(encoder.Encode(GenRecord(2), kv), 0);
+
+  // Mismatch column buffers and wrong common id.
+  std::vector<ColumnBuffer> columns;
+  EXPECT_EQ(typed_decoder.Decode(kv.key(), kv.value(), columns), -1);
+  TypedRecordDecoder other_decoder(1, schemas, kCommonId + 1);
+  ASSERT_EQ(other_decoder.Init({0}), 0);
+  columns = other_decoder.NewColumns();
+  EXPECT_EQ(other_decoder.Decode(kv.key(), kv.value(), columns), -1);
+}
+
+}  // namespace dingodb
@@ -0,0 +1,307 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "butil/status.h"
+#include "proto/common.pb.h"
+#include "proto/error.pb.h"
+#include "proto/index.pb.h"
+#include "vector/vector_index.h"
+#include "vector/vector_index_factory.h"
+#include "vector/vector_index_utils.h"
+
+namespace dingodb {
+
+class VectorIndexBinaryTest : public testing::Test {
+ protected:
+  static void SetUpTestSuite() {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<> distrib(0, 255);
+
+    data_base.resize(data_base_size, std::string(dimension / 8, '\0'));
+    for (int i = 0; i < data_base_size; i++) {
+      for (int j = 0; j < dimension / 8; j++) {
+        data_base[i][j] = static_cast<char>(distrib(rng));
+      }
+    }
+  }
+
+  static void TearDownTestSuite() {
+    data_base.clear();
+    std::filesystem::remove_all(kDataPath);
+  }
+
+  static std::shared_ptr<VectorIndex> NewBinaryFlat(int64_t id) {
+    static const pb::common::Range kRange;
+    pb::common::VectorIndexParameter index_parameter;
+    index_parameter.set_vector_index_type(::dingodb::pb::common::VectorIndexType::VECTOR_INDEX_TYPE_BINARY_FLAT);
+    index_parameter.mutable_binary_flat_parameter()->set_dimension(dimension);
+    index_parameter.mutable_binary_flat_parameter()->set_metric_type(
+        ::dingodb::pb::common::MetricType::METRIC_TYPE_HAMMING);
+
+    pb::common::RegionEpoch epoch;
+    epoch.set_conf_version(1);
+    epoch.set_version(10);
+
+    return VectorIndexFactory::NewBinaryFlat(id, index_parameter, epoch, kRange);
+  }
+
+  static std::shared_ptr<VectorIndex> NewBinaryIvfFlat(int64_t id) {
+    static const pb::common::Range kRange;
+    pb::common::VectorIndexParameter index_parameter;
+    index_parameter.set_vector_index_type(::dingodb::pb::common::VectorIndexType::VECTOR_INDEX_TYPE_BINARY_IVF_FLAT);
+    index_parameter.mutable_binary_ivf_flat_parameter()->set_dimension(dimension);
+    index_parameter.mutable_binary_ivf_flat_parameter()->set_metric_type(
+        ::dingodb::pb::common::MetricType::METRIC_TYPE_HAMMING);
+    index_parameter.mutable_binary_ivf_flat_parameter()->set_ncentroids(ncentroids);
+
+    pb::common::RegionEpoch epoch;
+    epoch.set_conf_version(1);
+    epoch.set_version(10);
+
+    return VectorIndexFactory::NewBinaryIvfFlat(id, index_parameter, epoch, kRange);
+  }
+
+  static std::vector<pb::common::VectorWithId> MakeVectorWithIds() {
+    std::vector<pb::common::VectorWithId> vector_with_ids;
+    for (int id = 0; id < data_base_size; id++) {
+      pb::common::VectorWithId vector_with_id;
+      vector_with_id.set_id(id + 1);
+      vector_with_id.mutable_vector()->set_dimension(dimension);
+      vector_with_id.mutable_vector()->set_value_type(::dingodb::pb::common::ValueType::UINT8);
+      vector_with_id.mutable_vector()->add_binary_values(data_base[id]);
+      vector_with_ids.push_back(vector_with_id);
+    }
+    return vector_with_ids;
+  }
+
+  inline static const std::string kDataPath = "./unit_test_vector_index_binary";
+  inline static int dimension = 64;
+  inline static int data_base_size = 1000;
+  inline static int ncentroids = 10;
+  inline static std::vector<std::string> data_base;
+};
+
+TEST_F(VectorIndexBinaryTest, HammingDistance) {
+  uint8_t left[8] = {0xff, 0x00, 0x0f, 0x00, 0x00, 0x00, 0x00, 0x01};
+  uint8_t right[8] = {0x00, 0x00, 0x0f, 0x00, 0x00, 0x00, 0x00, 0x00};
+  EXPECT_EQ(VectorIndexUtils::HammingDistance(left, right, 8), 9);
+  EXPECT_EQ(VectorIndexUtils::HammingDistance(left, left, 8), 0);
+
+  // binary_values may be split into pieces
+  pb::common::Vector vector;
+  vector.add_binary_values(std::string(3, '\x01'));
+  vector.add_binary_values(std::string(5, '\x02'));
+  EXPECT_EQ(VectorIndexUtils::BinaryVectorSize(vector), 8);
+}
+
+TEST_F(VectorIndexBinaryTest, CalcHammingDistance) {
+  google::protobuf::RepeatedPtrField<pb::common::Vector> left_vectors;
+  google::protobuf::RepeatedPtrField<pb::common::Vector> right_vectors;
+  std::vector<std::vector<float>> distances;
+  std::vector<pb::common::Vector> result_left_vectors;
+  std::vector<pb::common::Vector> result_right_vectors;
+
+  // empty
+  auto status = VectorIndexUtils::CalcDistanceByFaiss(pb::common::METRIC_TYPE_HAMMING, left_vectors, right_vectors,
+                                                      false, distances, result_left_vectors, result_right_vectors);
+  EXPECT_EQ(status.error_code(), pb::error::Errno::EILLEGAL_PARAMTETERS);
+
+  left_vectors.Add()->add_binary_values(std::string(2, '\x0f'));
+  status = VectorIndexUtils::CalcDistanceByFaiss(pb::common::METRIC_TYPE_HAMMING, left_vectors, right_vectors, false,
+                                                 distances, result_left_vectors, result_right_vectors);
+  EXPECT_EQ(status.error_code(), pb::error::Errno::EILLEGAL_PARAMTETERS);
+
+  right_vectors.Add()->add_binary_values(std::string(2, '\x00'));
+  status = VectorIndexUtils::CalcDistanceByFaiss(pb::common::METRIC_TYPE_HAMMING, left_vectors, right_vectors, false,
+                                                 distances, result_left_vectors, result_right_vectors);
+  ASSERT_TRUE(status.ok()) << status.error_str();
+  ASSERT_EQ(distances.size(), 1);
+  ASSERT_EQ(distances[0].size(), 1);
+  EXPECT_EQ(distances[0][0], 8);
+
+  // size mismatch
+  right_vectors.Add()->add_binary_values(std::string(3, '\x00'));
+  status = VectorIndexUtils::CalcDistanceByFaiss(pb::common::METRIC_TYPE_HAMMING, left_vectors, right_vectors, false,
+                                                 distances, result_left_vectors, result_right_vectors);
+  EXPECT_EQ(status.error_code(), pb::error::Errno::EILLEGAL_PARAMTETERS);
+}
+
+TEST_F(VectorIndexBinaryTest, BinaryFlat) {
+  auto vector_index = NewBinaryFlat(1);
+  ASSERT_NE(vector_index, nullptr);
+
+  auto vector_with_ids = MakeVectorWithIds();
+  EXPECT_EQ(vector_index->Add(vector_with_ids).error_code(), pb::error::Errno::OK);
+
+  int64_t count = 0;
+  vector_index->GetCount(count);
+  EXPECT_EQ(count, data_base_size);
+
+  // dimension mismatch
+  pb::common::VectorWithId bad_vector;
+  bad_vector.set_id(data_base_size + 1);
+  bad_vector.mutable_vector()->add_binary_values(std::string(dimension / 8 - 1, '\0'));
+  EXPECT_EQ(vector_index->Add({bad_vector}).error_code(), pb::error::Errno::EVECTOR_INVALID);
+
+  pb::common::VectorSearchParameter parameter;
+  std::vector<pb::index::VectorWithDistanceResult> results;
+  EXPECT_EQ(vector_index->Search({vector_with_ids[10]}, 5, {}, false, parameter, results).error_code(),
+            pb::error::Errno::OK);
+  ASSERT_EQ(results.size(), 1);
+  ASSERT_EQ(results[0].vector_with_distances_size(), 5);
+  EXPECT_EQ(results[0].vector_with_distances(0).vector_with_id().id(), vector_with_ids[10].id());
+  EXPECT_EQ(results[0].vector_with_distances(0).distance(), 0);
+  for (int i = 1; i < results[0].vector_with_distances_size(); ++i) {
+    EXPECT_LE(results[0].vector_with_distances(i - 1).distance(), results[0].vector_with_distances(i).distance());
+  }
+
+  // filter out the exact one
+  std::vector<int64_t> filter_ids;
+  for (int i = 0; i < data_base_size; ++i) {
+    if (vector_with_ids[i].id() != vector_with_ids[10].id()) {
+      filter_ids.push_back(vector_with_ids[i].id());
+    }
+  }
+  std::vector<std::shared_ptr<VectorIndex::FilterFunctor>> filters;
+  filters.push_back(std::make_shared<VectorIndex::BinaryListFilterFunctor>(filter_ids));
+  results.clear();
+  EXPECT_EQ(vector_index->Search({vector_with_ids[10]}, 5, filters, false, parameter, results).error_code(),
+            pb::error::Errno::OK);
+  ASSERT_EQ(results.size(), 1);
+  ASSERT_EQ(results[0].vector_with_distances_size(), 5);
+  for (const auto& vector_with_distance : results[0].vector_with_distances()) {
+    EXPECT_NE(vector_with_distance.vector_with_id().id(), vector_with_ids[10].id());
+  }
+
+  // only the exact one is in range 1
+  results.clear();
+  EXPECT_EQ(vector_index->RangeSearch({vector_with_ids[10]}, 1, {}, false, parameter, results).error_code(),
+            pb::error::Errno::OK);
+  ASSERT_EQ(results.size(), 1);
+  ASSERT_EQ(results[0].vector_with_distances_size(), 1);
+  EXPECT_EQ(results[0].vector_with_distances(0).vector_with_id().id(), vector_with_ids[10].id());
+
+  EXPECT_EQ(vector_index->Delete({vector_with_ids[10].id()}).error_code(), pb::error::Errno::OK);
+  vector_index->GetCount(count);
+  EXPECT_EQ(count, data_base_size - 1);
+
+  results.clear();
+  EXPECT_EQ(vector_index->Search({vector_with_ids[10]}, 5, {}, false, parameter, results).error_code(),
+            pb::error::Errno::OK);
+  ASSERT_EQ(results.size(), 1);
+  EXPECT_NE(results[0].vector_with_distances(0).vector_with_id().id(), vector_with_ids[10].id());
+}
+
+TEST_F(VectorIndexBinaryTest, BinaryFlatSaveAndLoad) {
+  auto vector_index = NewBinaryFlat(2);
+  ASSERT_NE(vector_index, nullptr);
+
+  auto vector_with_ids = MakeVectorWithIds();
+  EXPECT_EQ(vector_index->Add(vector_with_ids).error_code(), pb::error::Errno::OK);
+
+  std::filesystem::create_directories(kDataPath);
+  std::string index_path = kDataPath + "/binary_flat.idx";
+  EXPECT_EQ(vector_index->Save(index_path).error_code(), pb::error::Errno::OK);
+
+  auto loaded_index = NewBinaryFlat(2);
+  EXPECT_EQ(loaded_index->Load(index_path).error_code(), pb::error::Errno::OK);
+
+  int64_t count = 0;
+  loaded_index->GetCount(count);
+  EXPECT_EQ(count, data_base_size);
+
+  pb::common::VectorSearchParameter parameter;
+  std::vector<pb::index::VectorWithDistanceResult> results;
+  EXPECT_EQ(loaded_index->Search({vector_with_ids[20]}, 1, {}, false, parameter, results).error_code(),
+            pb::error::Errno::OK);
+  ASSERT_EQ(results.size(), 1);
+  ASSERT_EQ(results[0].vector_with_distances_size(), 1);
+  EXPECT_EQ(results[0].vector_with_distances(0).vector_with_id().id(), vector_with_ids[20].id());
+}
+
+TEST_F(VectorIndexBinaryTest, BinaryIvfFlat) {
+  auto vector_index = NewBinaryIvfFlat(3);
+  ASSERT_NE(vector_index, nullptr);
+
+  auto vector_with_ids = MakeVectorWithIds();
+
+  // not trained, search return empty
+  EXPECT_FALSE(vector_index->IsTrained());
+  pb::common::VectorSearchParameter parameter;
+  std::vector<pb::index::VectorWithDistanceResult> results;
+  EXPECT_EQ(vector_index->Search({vector_with_ids[10]}, 5, {}, false, parameter, results).error_code(),
+            pb::error::Errno::OK);
+  ASSERT_EQ(results.size(), 1);
+  EXPECT_EQ(results[0].vector_with_distances_size(), 0);
+
+  std::vector<float> float_datas(dimension, 0.0f);
+  EXPECT_EQ(vector_index->Train(float_datas).error_code(), pb::error::Errno::EVECTOR_NOT_SUPPORT);
+
+  // the first add trains the index
+  EXPECT_EQ(vector_index->Add(vector_with_ids).error_code(), pb::error::Errno::OK);
+  EXPECT_TRUE(vector_index->IsTrained());
+
+  int64_t count = 0;
+  vector_index->GetCount(count);
+  EXPECT_EQ(count, data_base_size);
+
+  // probe all lists, same as brute force
+  parameter.mutable_binary_ivf_flat()->set_nprobe(ncentroids);
+  results.clear();
+  EXPECT_EQ(vector_index->Search({vector_with_ids[10]}, 5, {}, false, parameter, results).error_code(),
+            pb::error::Errno::OK);
+  ASSERT_EQ(results.size(), 1);
+  ASSERT_EQ(results[0].vector_with_distances_size(), 5);
+  EXPECT_EQ(results[0].vector_with_distances(0).vector_with_id().id(), vector_with_ids[10].id());
+  EXPECT_EQ(results[0].vector_with_distances(0).distance(), 0);
+
+  results.clear();
+  EXPECT_EQ(vector_index->RangeSearch({vector_with_ids[10]}, 1, {}, false, parameter, results).error_code(),
+            pb::error::Errno::OK);
+  ASSERT_EQ(results.size(), 1);
+  ASSERT_EQ(results[0].vector_with_distances_size(), 1);
+  EXPECT_EQ(results[0].vector_with_distances(0).vector_with_id().id(), vector_with_ids[10].id());
+
+  EXPECT_EQ(vector_index->Delete({vector_with_ids[10].id()}).error_code(), pb::error::Errno::OK);
+  vector_index->GetCount(count);
+  EXPECT_EQ(count, data_base_size - 1);
+
+  std::filesystem::create_directories(kDataPath);
+  std::string index_path = kDataPath + "/binary_ivf_flat.idx";
+  EXPECT_EQ(vector_index->Save(index_path).error_code(), pb::error::Errno::OK);
+
+  auto loaded_index = NewBinaryIvfFlat(3);
+  EXPECT_EQ(loaded_index->Load(index_path).error_code(), pb::error::Errno::OK);
+  EXPECT_TRUE(loaded_index->IsTrained());
+  loaded_index->GetCount(count);
+  EXPECT_EQ(count, data_base_size - 1);
+
+  results.clear();
+  EXPECT_EQ(loaded_index->Search({vector_with_ids[20]}, 1, {}, false, parameter, results).error_code(),
+            pb::error::Errno::OK);
+  ASSERT_EQ(results.size(), 1);
+  ASSERT_EQ(results[0].vector_with_distances_size(), 1);
+  EXPECT_EQ(results[0].vector_with_distances(0).vector_with_id().id(), vector_with_ids[20].id());
+}
+
+}  // namespace dingodb
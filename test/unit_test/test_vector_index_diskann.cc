@@ -0,0 +1,186 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifdef USE_DISKANN
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "butil/status.h"
+#include "gflags/gflags.h"
+#include "proto/common.pb.h"
+#include "proto/error.pb.h"
+#include "proto/index.pb.h"
+#include "vector/vector_index.h"
+#include "vector/vector_index_diskann.h"
+#include "vector/vector_index_factory.h"
+
+namespace dingodb {
+
+DECLARE_int64(diskann_min_build_count);
+
+class VectorIndexDiskAnnTest : public testing::Test {
+ protected:
+  static void SetUpTestSuite() {
+    FLAGS_diskann_data_path = kDataPath;
+    FLAGS_diskann_min_build_count = 1000;
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<> distrib(-1.0, 1.0);
+
+    data_base.resize(dimension * data_base_size, 0.0f);
+    for (int i = 0; i < data_base_size; i++) {
+      for (int j = 0; j < dimension; j++) {
+        data_base[dimension * i + j] = distrib(rng);
+      }
+    }
+  }
+
+  static void TearDownTestSuite() {
+    data_base.clear();
+    std::filesystem::remove_all(kDataPath);
+  }
+
+  static std::shared_ptr<VectorIndex> NewIndex(int64_t id) {
+    static const pb::common::Range kRange;
+    pb::common::VectorIndexParameter index_parameter;
+    index_parameter.set_vector_index_type(::dingodb::pb::common::VectorIndexType::VECTOR_INDEX_TYPE_DISKANN);
+    index_parameter.mutable_diskann_parameter()->set_dimension(dimension);
+    index_parameter.mutable_diskann_parameter()->set_metric_type(::dingodb::pb::common::MetricType::METRIC_TYPE_L2);
+    index_parameter.mutable_diskann_parameter()->set_num_trees(1);
+    index_parameter.mutable_diskann_parameter()->set_num_neighbors(32);
+    index_parameter.mutable_diskann_parameter()->set_num_threads(4);
+
+    pb::common::RegionEpoch epoch;
+    epoch.set_conf_version(1);
+    epoch.set_version(10);
+
+    return VectorIndexFactory::NewDiskAnn(id, index_parameter, epoch, kRange);
+  }
+
+  static std::vector<pb::common::VectorWithId> MakeVectorWithIds() {
+    std::vector<pb::common::VectorWithId> vector_with_ids;
+    for (int id = 0; id < data_base_size; id++) {
+      pb::common::VectorWithId vector_with_id;
+      vector_with_id.set_id(id + 1);
+      for (int i = 0; i < dimension; i++) {
+        vector_with_id.mutable_vector()->add_float_values(data_base[id * dimension + i]);
+      }
+      vector_with_ids.push_back(vector_with_id);
+    }
+    return vector_with_ids;
+  }
+
+  static int64_t SearchFirstId(std::shared_ptr<VectorIndex> vector_index, const pb::common::VectorWithId& query) {
+    pb::common::VectorSearchParameter parameter;
+    std::vector<pb::index::VectorWithDistanceResult> results;
+    auto status = vector_index->Search({query}, 5, {}, false, parameter, results);
+    EXPECT_EQ(status.error_code(), pb::error::Errno::OK);
+    if (results.size() != 1 || results[0].vector_with_distances_size() == 0) {
+      return -1;
+    }
+    return results[0].vector_with_distances(0).vector_with_id().id();
+  }
+
+  inline static const std::string kDataPath = "./unit_test_diskann";
+  inline static int dimension = 32;
+  inline static int data_base_size = 2000;
+  inline static std::vector<float> data_base;
+};
+
+TEST_F(VectorIndexDiskAnnTest, BuildAndSearch) {
+  auto vector_index = NewIndex(1);
+  ASSERT_NE(vector_index, nullptr);
+
+  auto vector_with_ids = MakeVectorWithIds();
+  EXPECT_EQ(vector_index->Add(vector_with_ids).error_code(), pb::error::Errno::OK);
+
+  // not built, caller fallback to brute force
+  EXPECT_FALSE(vector_index->IsTrained());
+  pb::common::VectorSearchParameter parameter;
+  std::vector<pb::index::VectorWithDistanceResult> results;
+  auto status = vector_index->Search({vector_with_ids[10]}, 5, {}, false, parameter, results);
+  EXPECT_EQ(status.error_code(), pb::error::Errno::EVECTOR_NOT_SUPPORT);
+
+  EXPECT_EQ(vector_index->Build().error_code(), pb::error::Errno::OK);
+  EXPECT_TRUE(vector_index->IsTrained());
+
+  int64_t count = 0;
+  vector_index->GetCount(count);
+  EXPECT_EQ(count, data_base_size);
+  EXPECT_EQ(SearchFirstId(vector_index, vector_with_ids[10]), vector_with_ids[10].id());
+
+  // update after build goes to the fresh index, the disk one is tombstoned
+  auto updated = vector_with_ids[20];
+  updated.set_id(vector_with_ids[10].id());
+  EXPECT_EQ(vector_index->Upsert({updated}).error_code(), pb::error::Errno::OK);
+  EXPECT_EQ(SearchFirstId(vector_index, vector_with_ids[20]), vector_with_ids[10].id());
+
+  EXPECT_EQ(vector_index->Delete({vector_with_ids[10].id()}).error_code(), pb::error::Errno::OK);
+  EXPECT_EQ(SearchFirstId(vector_index, vector_with_ids[20]), vector_with_ids[20].id());
+
+  int64_t deleted_count = 0;
+  vector_index->GetDeletedCount(deleted_count);
+  EXPECT_EQ(deleted_count, 1);
+  vector_index->GetCount(count);
+  EXPECT_EQ(count, data_base_size - 1);
+}
+
+TEST_F(VectorIndexDiskAnnTest, SaveAndLoad) {
+  auto vector_index = NewIndex(2);
+  ASSERT_NE(vector_index, nullptr);
+
+  auto vector_with_ids = MakeVectorWithIds();
+  EXPECT_EQ(vector_index->Add(vector_with_ids).error_code(), pb::error::Errno::OK);
+  EXPECT_EQ(vector_index->Build().error_code(), pb::error::Errno::OK);
+  EXPECT_EQ(vector_index->Delete({vector_with_ids[0].id()}).error_code(), pb::error::Errno::OK);
+
+  pb::common::VectorWithId fresh = vector_with_ids[30];
+  fresh.set_id(data_base_size + 100);
+  EXPECT_EQ(vector_index->Upsert({fresh}).error_code(), pb::error::Errno::OK);
+
+  std::string snapshot_path = kDataPath + "/snapshot";
+  std::filesystem::create_directories(snapshot_path);
+  std::string index_path = snapshot_path + "/index_2_100.idx";
+  EXPECT_EQ(vector_index->Save(index_path).error_code(), pb::error::Errno::OK);
+
+  auto loaded_index = NewIndex(2);
+  ASSERT_NE(loaded_index, nullptr);
+  EXPECT_EQ(loaded_index->Load(index_path).error_code(), pb::error::Errno::OK);
+  EXPECT_TRUE(loaded_index->IsTrained());
+
+  int64_t count = 0;
+  loaded_index->GetCount(count);
+  EXPECT_EQ(count, data_base_size);
+  int64_t deleted_count = 0;
+  loaded_index->GetDeletedCount(deleted_count);
+  EXPECT_EQ(deleted_count, 1);
+
+  EXPECT_EQ(SearchFirstId(loaded_index, vector_with_ids[10]), vector_with_ids[10].id());
+  EXPECT_NE(SearchFirstId(loaded_index, vector_with_ids[0]), vector_with_ids[0].id());
+
+  int64_t memory_size = 0;
+  loaded_index->GetMemorySize(memory_size);
+  EXPECT_GT(memory_size, 0);
+}
+
+}  // namespace dingodb
+
+#endif  // USE_DISKANN
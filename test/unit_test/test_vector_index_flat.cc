@@ -1787,4 +1787,109 @@ TEST_F(VectorIndexFlatTest, RangeSearchAfterLoad) {
   }
 }
 
+TEST_F(VectorIndexFlatTest, DeleteMoveLastSlot) {
+  static const pb::common::Range kRange;
+  static pb::common::RegionEpoch kEpoch;  // NOLINT
+  pb::common::VectorIndexParameter index_parameter;
+  index_parameter.set_vector_index_type(::dingodb::pb::common::VectorIndexType::VECTOR_INDEX_TYPE_FLAT);
+  index_parameter.mutable_flat_parameter()->set_dimension(dimension);
+  index_parameter.mutable_flat_parameter()->set_metric_type(::dingodb::pb::common::MetricType::METRIC_TYPE_L2);
+  auto vector_index = VectorIndexFactory::New(2, index_parameter, kEpoch, kRange);
+  ASSERT_NE(vector_index.get(), nullptr);
+
+  auto gen_vector_with_id = [](int64_t id, float value) {
+    pb::common::VectorWithId vector_with_id;
+    vector_with_id.set_id(id);
+    for (int i = 0; i < dimension; i++) {
+      vector_with_id.mutable_vector()->add_float_values(value);
+    }
+    return vector_with_id;
+  };
+
+  // vector of id is {id, id, ...}
+  std::vector<pb::common::VectorWithId> vector_with_ids;
+  for (int64_t id = 100; id < 110; id++) {
+    vector_with_ids.push_back(gen_vector_with_id(id, id));
+  }
+  EXPECT_TRUE(vector_index->Add(vector_with_ids).ok());
+
+  // delete the first and middle one, the last vector move into the hole.
+  EXPECT_TRUE(vector_index->Delete({100, 105}).ok());
+  EXPECT_EQ(vector_index->Delete({100}).error_code(), pb::error::Errno::EVECTOR_INVALID);
+  EXPECT_TRUE(vector_index->Add({gen_vector_with_id(105, 105)}).ok());
+  EXPECT_TRUE(vector_index->Upsert({gen_vector_with_id(109, 109)}).ok());
+
+  int64_t count = 0;
+  EXPECT_TRUE(vector_index->GetCount(count).ok());
+  EXPECT_EQ(count, 9);
+
+  auto check_search = [&](std::shared_ptr<VectorIndex> index) {
+    for (int64_t id = 101; id < 110; id++) {
+      std::vector<pb::index::VectorWithDistanceResult> results;
+      EXPECT_TRUE(index->Search({gen_vector_with_id(0, id)}, 1, {}, false, {}, results).ok());
+      ASSERT_EQ(results.size(), 1);
+      ASSERT_EQ(results[0].vector_with_distances_size(), 1);
+      EXPECT_EQ(results[0].vector_with_distances(0).vector_with_id().id(), id);
+    }
+
+    // filter see the vector id, not the slot.
+    std::vector<int64_t> filter_ids = {103};
+    auto filter = std::make_shared<VectorIndex::FlatListFilterFunctor>(filter_ids);
+    std::vector<pb::index::VectorWithDistanceResult> results;
+    EXPECT_TRUE(index->Search({gen_vector_with_id(0, 109)}, 3, {filter}, false, {}, results).ok());
+    ASSERT_EQ(results.size(), 1);
+    ASSERT_EQ(results[0].vector_with_distances_size(), 1);
+    EXPECT_EQ(results[0].vector_with_distances(0).vector_with_id().id(), 103);
+  };
+  check_search(vector_index);
+
+  // snapshot is still IndexIDMap2 format.
+  std::string path = "./flat_delete_move_last_slot.idx";
+  EXPECT_TRUE(vector_index->Save(path).ok());
+  auto load_vector_index = VectorIndexFactory::New(2, index_parameter, kEpoch, kRange);
+  EXPECT_TRUE(load_vector_index->Load(path).ok());
+  EXPECT_TRUE(load_vector_index->GetCount(count).ok());
+  EXPECT_EQ(count, 9);
+  check_search(load_vector_index);
+  std::remove(path.c_str());
+}
+
+TEST_F(VectorIndexFlatTest, DeriveTo) {
+  static const pb::common::Range kRange;
+  static pb::common::RegionEpoch kEpoch;  // NOLINT
+  pb::common::VectorIndexParameter index_parameter;
+  index_parameter.set_vector_index_type(::dingodb::pb::common::VectorIndexType::VECTOR_INDEX_TYPE_FLAT);
+  index_parameter.mutable_flat_parameter()->set_dimension(dimension);
+  index_parameter.mutable_flat_parameter()->set_metric_type(::dingodb::pb::common::MetricType::METRIC_TYPE_L2);
+  auto parent_vector_index = VectorIndexFactory::New(3, index_parameter, kEpoch, kRange);
+  auto child_vector_index = VectorIndexFactory::New(4, index_parameter, kEpoch, kRange);
+  ASSERT_NE(parent_vector_index.get(), nullptr);
+  ASSERT_NE(child_vector_index.get(), nullptr);
+
+  std::vector<pb::common::VectorWithId> vector_with_ids;
+  for (int64_t id = 1; id <= 20; id++) {
+    pb::common::VectorWithId vector_with_id;
+    vector_with_id.set_id(id);
+    for (int i = 0; i < dimension; i++) {
+      vector_with_id.mutable_vector()->add_float_values(id);
+    }
+    vector_with_ids.push_back(vector_with_id);
+  }
+  EXPECT_TRUE(parent_vector_index->Add(vector_with_ids).ok());
+  EXPECT_TRUE(parent_vector_index->Delete({12}).ok());
+
+  // child range [11, 21)
+  ASSERT_TRUE(parent_vector_index->DeriveTo(11, 21, child_vector_index.get()).ok());
+
+  int64_t count = 0;
+  EXPECT_TRUE(child_vector_index->GetCount(count).ok());
+  EXPECT_EQ(count, 9);
+
+  std::vector<pb::index::VectorWithDistanceResult> results;
+  EXPECT_TRUE(child_vector_index->Search({vector_with_ids[0], vector_with_ids[14]}, 1, {}, false, {}, results).ok());
+  ASSERT_EQ(results.size(), 2);
+  EXPECT_EQ(results[0].vector_with_distances(0).vector_with_id().id(), 11);
+  EXPECT_EQ(results[1].vector_with_distances(0).vector_with_id().id(), 15);
+}
+
 }  // namespace dingodb
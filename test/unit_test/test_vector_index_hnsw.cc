@@ -14,7 +14,9 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <array>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
 #include <cstdio>
@@ -27,6 +29,7 @@
 #include "butil/status.h"
 #include "faiss/MetricType.h"
 #include "fmt/core.h"
+#include "gflags/gflags.h"
 #include "proto/common.pb.h"
 #include "proto/error.pb.h"
 #include "proto/index.pb.h"
@@ -37,6 +40,8 @@
 
 namespace dingodb {
 
+DECLARE_int64(vector_index_max_range_search_result_count);
+
 class VectorIndexHnswTest : public testing::Test {
  protected:
   static void SetUpTestSuite() {}
@@ -345,6 +350,157 @@ TEST_F(VectorIndexHnswTest, EfSearch) {
   }
 }
 
+// The vector of id k is (cos(k * 9), sin(k * 9), 0, ...) * scale, scale is k for l2 and ip.
+static std::shared_ptr<VectorIndex> NewRangeSearchHnsw(pb::common::MetricType metric_type, int dimension) {
+  static const pb::common::Range kRange;
+  pb::common::RegionEpoch epoch;
+  pb::common::VectorIndexParameter index_parameter;
+  index_parameter.set_vector_index_type(::dingodb::pb::common::VectorIndexType::VECTOR_INDEX_TYPE_HNSW);
+  index_parameter.mutable_hnsw_parameter()->set_dimension(dimension);
+  index_parameter.mutable_hnsw_parameter()->set_metric_type(metric_type);
+  index_parameter.mutable_hnsw_parameter()->set_efconstruction(200);
+  index_parameter.mutable_hnsw_parameter()->set_max_elements(100);
+  index_parameter.mutable_hnsw_parameter()->set_nlinks(16);
+
+  auto vector_index = VectorIndexFactory::NewHnsw(1, index_parameter, epoch, kRange, nullptr);
+  if (vector_index == nullptr) {
+    return nullptr;
+  }
+
+  std::vector<pb::common::VectorWithId> vector_with_ids;
+  for (int64_t id = 1; id <= 10; id++) {
+    pb::common::VectorWithId vector_with_id;
+    vector_with_id.set_id(id);
+    double angle = id * 9.0 * M_PI / 180.0;
+    float scale = metric_type == pb::common::MetricType::METRIC_TYPE_COSINE ? 1.0F : static_cast<float>(id);
+    for (int i = 0; i < dimension; i++) {
+      float value = 0.0F;
+      if (i == 0) {
+        value = metric_type == pb::common::MetricType::METRIC_TYPE_COSINE ? std::cos(angle) : scale;
+      } else if (i == 1 && metric_type == pb::common::MetricType::METRIC_TYPE_COSINE) {
+        value = std::sin(angle);
+      }
+      vector_with_id.mutable_vector()->add_float_values(value);
+    }
+    vector_with_ids.push_back(vector_with_id);
+  }
+  if (!vector_index->Upsert(vector_with_ids).ok()) {
+    return nullptr;
+  }
+  return vector_index;
+}
+
+static std::vector<pb::common::VectorWithId> GenRangeSearchQuery(float x, int dimension) {
+  pb::common::VectorWithId vector_with_id;
+  for (int i = 0; i < dimension; i++) {
+    vector_with_id.mutable_vector()->add_float_values(i == 0 ? x : 0.0F);
+  }
+  return {vector_with_id};
+}
+
+static std::vector<int64_t> GetResultIds(const pb::index::VectorWithDistanceResult &result) {
+  std::vector<int64_t> ids;
+  for (const auto &vector_with_distance : result.vector_with_distances()) {
+    ids.push_back(vector_with_distance.vector_with_id().id());
+  }
+  std::sort(ids.begin(), ids.end());
+  return ids;
+}
+
+TEST_F(VectorIndexHnswTest, RangeSearch) {
+  // id k is (k, 0, ...), the distance to (3, 0, ...) is the squared l2 (k - 3)^2.
+  auto vector_index = NewRangeSearchHnsw(pb::common::MetricType::METRIC_TYPE_L2, dimension);
+  ASSERT_NE(vector_index, nullptr);
+  auto query = GenRangeSearchQuery(3.0F, dimension);
+
+  // only itself
+  {
+    std::vector<pb::index::VectorWithDistanceResult> results;
+    auto status = vector_index->RangeSearch(query, 1.0F, {}, false, {}, results);
+    ASSERT_TRUE(status.ok()) << status.error_str();
+    ASSERT_EQ(results.size(), 1);
+    EXPECT_EQ(GetResultIds(results[0]), std::vector<int64_t>({3}));
+    EXPECT_FLOAT_EQ(results[0].vector_with_distances(0).distance(), 0.0F);
+  }
+
+  // ids 1 to 5
+  {
+    std::vector<pb::index::VectorWithDistanceResult> results;
+    auto status = vector_index->RangeSearch(query, 4.5F, {}, true, {}, results);
+    ASSERT_TRUE(status.ok()) << status.error_str();
+    ASSERT_EQ(results.size(), 1);
+    EXPECT_EQ(GetResultIds(results[0]), std::vector<int64_t>({1, 2, 3, 4, 5}));
+    for (const auto &vector_with_distance : results[0].vector_with_distances()) {
+      EXPECT_LT(vector_with_distance.distance(), 4.5F);
+      EXPECT_EQ(vector_with_distance.vector_with_id().vector().float_values_size(), dimension);
+    }
+  }
+
+  // filter ids 4, 5
+  {
+    std::vector<pb::index::VectorWithDistanceResult> results;
+    auto filter = std::make_shared<VectorIndex::RangeFilterFunctor>(4, INT64_MAX);
+    auto status = vector_index->RangeSearch(query, 4.5F, {filter}, false, {}, results);
+    ASSERT_TRUE(status.ok()) << status.error_str();
+    ASSERT_EQ(results.size(), 1);
+    EXPECT_EQ(GetResultIds(results[0]), std::vector<int64_t>({4, 5}));
+  }
+}
+
+TEST_F(VectorIndexHnswTest, RangeSearchInnerProduct) {
+  // id k is (k, 0, ...), the distance to (1, 0, ...) is 1 - k.
+  auto vector_index = NewRangeSearchHnsw(pb::common::MetricType::METRIC_TYPE_INNER_PRODUCT, dimension);
+  ASSERT_NE(vector_index, nullptr);
+  auto query = GenRangeSearchQuery(1.0F, dimension);
+
+  std::vector<pb::index::VectorWithDistanceResult> results;
+  auto status = vector_index->RangeSearch(query, -5.5F, {}, false, {}, results);
+  ASSERT_TRUE(status.ok()) << status.error_str();
+  ASSERT_EQ(results.size(), 1);
+  EXPECT_EQ(GetResultIds(results[0]), std::vector<int64_t>({7, 8, 9, 10}));
+  for (const auto &vector_with_distance : results[0].vector_with_distances()) {
+    EXPECT_FLOAT_EQ(vector_with_distance.distance(), 1.0F - vector_with_distance.vector_with_id().id());
+  }
+}
+
+TEST_F(VectorIndexHnswTest, RangeSearchCosine) {
+  // id k is at k * 9 degrees, the distance to (1, 0, ...) is 1 - cos(k * 9).
+  auto vector_index = NewRangeSearchHnsw(pb::common::MetricType::METRIC_TYPE_COSINE, dimension);
+  ASSERT_NE(vector_index, nullptr);
+  // The query is normalized too.
+  auto query = GenRangeSearchQuery(2.0F, dimension);
+
+  std::vector<pb::index::VectorWithDistanceResult> results;
+  float radius = 1.0F - std::cos(30.0 * M_PI / 180.0);
+  auto status = vector_index->RangeSearch(query, radius, {}, false, {}, results);
+  ASSERT_TRUE(status.ok()) << status.error_str();
+  ASSERT_EQ(results.size(), 1);
+  EXPECT_EQ(GetResultIds(results[0]), std::vector<int64_t>({1, 2, 3}));
+  for (const auto &vector_with_distance : results[0].vector_with_distances()) {
+    double angle = vector_with_distance.vector_with_id().id() * 9.0 * M_PI / 180.0;
+    EXPECT_NEAR(vector_with_distance.distance(), 1.0 - std::cos(angle), 1e-5);
+  }
+}
+
+TEST_F(VectorIndexHnswTest, RangeSearchExceedLimit) {
+  gflags::FlagSaver flag_saver;
+  FLAGS_vector_index_max_range_search_result_count = 3;
+
+  auto vector_index = NewRangeSearchHnsw(pb::common::MetricType::METRIC_TYPE_L2, dimension);
+  ASSERT_NE(vector_index, nullptr);
+  auto query = GenRangeSearchQuery(3.0F, dimension);
+
+  // All the 10 vectors are inside the radius, the result is cut to the limit.
+  std::vector<pb::index::VectorWithDistanceResult> results;
+  auto status = vector_index->RangeSearch(query, 1000.0F, {}, false, {}, results);
+  ASSERT_TRUE(status.ok()) << status.error_str();
+  ASSERT_EQ(results.size(), 1);
+  ASSERT_EQ(results[0].vector_with_distances_size(), 3);
+  for (int i = 1; i < results[0].vector_with_distances_size(); i++) {
+    EXPECT_LE(results[0].vector_with_distances(i - 1).distance(), results[0].vector_with_distances(i).distance());
+  }
+}
+
 TEST_F(VectorIndexHnswTest, CreateCosine) {
   static const pb::common::Range kRange;
   // valid param L2
@@ -607,4 +763,56 @@ TEST_F(VectorIndexHnswTest, EfSearchCosine) {
   }
 }
 
+TEST_F(VectorIndexHnswTest, DeriveTo) {
+  static const pb::common::Range kRange;
+  pb::common::RegionEpoch epoch;
+  pb::common::VectorIndexParameter index_parameter;
+  index_parameter.set_vector_index_type(::dingodb::pb::common::VectorIndexType::VECTOR_INDEX_TYPE_HNSW);
+  index_parameter.mutable_hnsw_parameter()->set_dimension(dimension);
+  index_parameter.mutable_hnsw_parameter()->set_metric_type(::dingodb::pb::common::MetricType::METRIC_TYPE_L2);
+  index_parameter.mutable_hnsw_parameter()->set_efconstruction(efconstruction);
+  index_parameter.mutable_hnsw_parameter()->set_max_elements(1000);
+  index_parameter.mutable_hnsw_parameter()->set_nlinks(16);
+
+  auto parent_vector_index = VectorIndexFactory::NewHnsw(1, index_parameter, epoch, kRange, nullptr);
+  auto child_vector_index = VectorIndexFactory::NewHnsw(2, index_parameter, epoch, kRange, nullptr);
+  ASSERT_NE(parent_vector_index.get(), nullptr);
+  ASSERT_NE(child_vector_index.get(), nullptr);
+
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<> distrib;
+  std::vector<pb::common::VectorWithId> vector_with_ids;
+  for (int64_t id = 1; id <= 200; id++) {
+    pb::common::VectorWithId vector_with_id;
+    vector_with_id.set_id(id);
+    for (int i = 0; i < dimension; i++) {
+      vector_with_id.mutable_vector()->add_float_values(distrib(rng));
+    }
+    vector_with_ids.push_back(vector_with_id);
+  }
+  ASSERT_TRUE(parent_vector_index->Upsert(vector_with_ids).ok());
+  ASSERT_TRUE(parent_vector_index->Delete({5}).ok());
+
+  ASSERT_TRUE(parent_vector_index->SupportDerive());
+  ASSERT_TRUE(parent_vector_index->DeriveTo(1, 101, child_vector_index.get()).ok());
+
+  int64_t count = 0;
+  EXPECT_TRUE(child_vector_index->GetCount(count).ok());
+  EXPECT_EQ(count, 99);
+
+  // Every vector inside the range find itself, the vector outside the range find the one inside.
+  for (const auto &vector_with_id : vector_with_ids) {
+    std::vector<pb::index::VectorWithDistanceResult> results;
+    EXPECT_TRUE(child_vector_index->Search({vector_with_id}, 1, {}, false, {}, results).ok());
+    ASSERT_EQ(results.size(), 1);
+    ASSERT_EQ(results[0].vector_with_distances_size(), 1);
+    int64_t result_id = results[0].vector_with_distances(0).vector_with_id().id();
+    EXPECT_LT(result_id, 101);
+    EXPECT_NE(result_id, 5);
+    if (vector_with_id.id() < 101 && vector_with_id.id() != 5) {
+      EXPECT_EQ(result_id, vector_with_id.id());
+    }
+  }
+}
+
 }  // namespace dingodb
@@ -0,0 +1,187 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "butil/status.h"
+#include "proto/common.pb.h"
+#include "proto/error.pb.h"
+#include "proto/index.pb.h"
+#include "vector/vector_index.h"
+#include "vector/vector_index_factory.h"
+#include "vector/vector_index_hnsw.h"
+#include "vector/vector_index_hnsw_quantizer.h"
+
+namespace dingodb {
+
+class VectorIndexHnswQuantizerTest : public testing::Test {
+ protected:
+  static void SetUpTestSuite() {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<> distrib(-1.0, 1.0);
+
+    data_base.resize(dimension * data_base_size, 0.0f);
+    for (int i = 0; i < data_base_size; i++) {
+      for (int j = 0; j < dimension; j++) {
+        data_base[dimension * i + j] = distrib(rng);
+      }
+    }
+  }
+
+  static void TearDownTestSuite() { data_base.clear(); }
+
+  static std::shared_ptr<VectorIndex> NewIndex(int64_t id, pb::common::HnswQuantizerType quantizer_type,
+                                               pb::common::MetricType metric_type) {
+    static const pb::common::Range kRange;
+    pb::common::VectorIndexParameter index_parameter;
+    index_parameter.set_vector_index_type(::dingodb::pb::common::VectorIndexType::VECTOR_INDEX_TYPE_HNSW);
+    index_parameter.mutable_hnsw_parameter()->set_dimension(dimension);
+    index_parameter.mutable_hnsw_parameter()->set_metric_type(metric_type);
+    index_parameter.mutable_hnsw_parameter()->set_efconstruction(efconstruction);
+    index_parameter.mutable_hnsw_parameter()->set_max_elements(data_base_size);
+    index_parameter.mutable_hnsw_parameter()->set_nlinks(nlinks);
+    index_parameter.mutable_hnsw_parameter()->set_quantizer_type(quantizer_type);
+
+    pb::common::RegionEpoch epoch;
+    epoch.set_conf_version(1);
+    epoch.set_version(10);
+
+    return VectorIndexFactory::NewHnsw(id, index_parameter, epoch, kRange, nullptr);
+  }
+
+  static std::vector<pb::common::VectorWithId> MakeVectorWithIds() {
+    std::vector<pb::common::VectorWithId> vector_with_ids;
+    for (int id = 0; id < data_base_size; id++) {
+      pb::common::VectorWithId vector_with_id;
+      vector_with_id.set_id(id + 1);
+      for (int i = 0; i < dimension; i++) {
+        vector_with_id.mutable_vector()->add_float_values(data_base[id * dimension + i]);
+      }
+      vector_with_ids.push_back(vector_with_id);
+    }
+    return vector_with_ids;
+  }
+
+  inline static int dimension = 64;
+  inline static int data_base_size = 1000;
+  inline static std::vector<float> data_base;
+  inline static uint32_t efconstruction = 200;
+  inline static int32_t nlinks = 16;
+};
+
+TEST_F(VectorIndexHnswQuantizerTest, Sq8EncodeDecode) {
+  HnswSq8Space space(dimension, pb::common::MetricType::METRIC_TYPE_L2);
+  EXPECT_EQ(space.get_data_size(), dimension + 2 * sizeof(float));
+
+  std::vector<uint8_t> code(space.CodeSize());
+  std::vector<float> decoded(dimension);
+  space.Encode(data_base.data(), code.data());
+  space.Decode(code.data(), decoded.data());
+
+  // max error is half of the quantization step, range is (-1, 1)
+  for (int i = 0; i < dimension; i++) {
+    EXPECT_NEAR(data_base[i], decoded[i], 2.0f / 255.0f);
+  }
+
+  // constant vector
+  std::vector<float> constant(dimension, 0.5f);
+  space.Encode(constant.data(), code.data());
+  space.Decode(code.data(), decoded.data());
+  for (int i = 0; i < dimension; i++) {
+    EXPECT_FLOAT_EQ(0.5f, decoded[i]);
+  }
+}
+
+TEST_F(VectorIndexHnswQuantizerTest, Fp16EncodeDecode) {
+  EXPECT_EQ(HnswFp16Space::HalfToFloat(HnswFp16Space::FloatToHalf(0.0f)), 0.0f);
+  EXPECT_EQ(HnswFp16Space::HalfToFloat(HnswFp16Space::FloatToHalf(1.0f)), 1.0f);
+  EXPECT_EQ(HnswFp16Space::HalfToFloat(HnswFp16Space::FloatToHalf(-2.5f)), -2.5f);
+  EXPECT_EQ(HnswFp16Space::HalfToFloat(HnswFp16Space::FloatToHalf(65504.0f)), 65504.0f);
+  EXPECT_TRUE(std::isinf(HnswFp16Space::HalfToFloat(HnswFp16Space::FloatToHalf(1e6f))));
+  EXPECT_NEAR(HnswFp16Space::HalfToFloat(HnswFp16Space::FloatToHalf(1e-6f)), 1e-6f, 1e-7f);
+
+  HnswFp16Space space(dimension, pb::common::MetricType::METRIC_TYPE_L2);
+  EXPECT_EQ(space.get_data_size(), dimension * sizeof(uint16_t));
+
+  std::vector<uint8_t> code(space.CodeSize());
+  std::vector<float> decoded(dimension);
+  space.Encode(data_base.data(), code.data());
+  space.Decode(code.data(), decoded.data());
+  for (int i = 0; i < dimension; i++) {
+    EXPECT_NEAR(data_base[i], decoded[i], 1e-3f);
+  }
+}
+
+TEST_F(VectorIndexHnswQuantizerTest, SearchAndMemorySize) {
+  auto vector_with_ids = MakeVectorWithIds();
+
+  int64_t id = 1;
+  std::vector<int64_t> memory_sizes;
+  for (auto quantizer_type :
+       {pb::common::HnswQuantizerType::HNSW_QUANTIZER_NONE, pb::common::HnswQuantizerType::HNSW_QUANTIZER_FP16,
+        pb::common::HnswQuantizerType::HNSW_QUANTIZER_SQ8}) {
+    auto vector_index = NewIndex(id++, quantizer_type, pb::common::MetricType::METRIC_TYPE_L2);
+    ASSERT_NE(vector_index, nullptr);
+
+    butil::Status ok = vector_index->Add(vector_with_ids);
+    EXPECT_EQ(ok.error_code(), pb::error::Errno::OK);
+
+    int64_t count = 0;
+    vector_index->GetCount(count);
+    EXPECT_EQ(count, data_base_size);
+
+    // self search must hit itself
+    pb::common::VectorSearchParameter parameter;
+    parameter.mutable_hnsw()->set_efsearch(64);
+    std::vector<pb::index::VectorWithDistanceResult> results;
+    ok = vector_index->Search({vector_with_ids[10]}, 5, {}, true, parameter, results);
+    EXPECT_EQ(ok.error_code(), pb::error::Errno::OK);
+    ASSERT_EQ(results.size(), 1);
+    ASSERT_GT(results[0].vector_with_distances_size(), 0);
+    EXPECT_EQ(results[0].vector_with_distances(0).vector_with_id().id(), vector_with_ids[10].id());
+
+    // quantized index does not reconstruct vector
+    if (quantizer_type != pb::common::HnswQuantizerType::HNSW_QUANTIZER_NONE) {
+      EXPECT_EQ(results[0].vector_with_distances(0).vector_with_id().vector().float_values_size(), 0);
+    }
+
+    int64_t memory_size = 0;
+    vector_index->GetMemorySize(memory_size);
+    memory_sizes.push_back(memory_size);
+  }
+
+  // fp32 > fp16 > sq8
+  EXPECT_GT(memory_sizes[0], memory_sizes[1]);
+  EXPECT_GT(memory_sizes[1], memory_sizes[2]);
+}
+
+TEST_F(VectorIndexHnswQuantizerTest, CalcHnswCountFromMemory) {
+  int64_t memory = 1024L * 1024L * 1024L;
+  auto count_fp32 = VectorIndexHnsw::CalcHnswCountFromMemory(memory, 768, 32);
+  auto count_fp16 =
+      VectorIndexHnsw::CalcHnswCountFromMemory(memory, 768, 32, pb::common::HnswQuantizerType::HNSW_QUANTIZER_FP16);
+  auto count_sq8 =
+      VectorIndexHnsw::CalcHnswCountFromMemory(memory, 768, 32, pb::common::HnswQuantizerType::HNSW_QUANTIZER_SQ8);
+  EXPECT_LT(count_fp32, count_fp16);
+  EXPECT_LT(count_fp16, count_sq8);
+}
+
+}  // namespace dingodb
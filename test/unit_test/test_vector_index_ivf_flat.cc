@@ -26,8 +26,11 @@
 #include <vector>
 
 #include "butil/status.h"
+#include "common/helper.h"
 #include "common/logging.h"
 #include "faiss/MetricType.h"
+#include "fmt/core.h"
+#include "gflags/gflags.h"
 #include "proto/common.pb.h"
 #include "proto/error.pb.h"
 #include "proto/index.pb.h"
@@ -35,6 +38,8 @@
 
 namespace dingodb {
 
+DECLARE_bool(vector_index_load_mmap);
+
 class VectorIndexIvfFlatTest : public testing::Test {
  protected:
   static void SetUpTestSuite() {}
@@ -1643,4 +1648,243 @@ TEST_F(VectorIndexIvfFlatTest, RangeSearchAfterLoad) {
   }
 }
 
+// The mmap load index must be searchable like the heap load one and writable.
+// Use its own index instances, the shared ones are used by the later tests.
+TEST_F(VectorIndexIvfFlatTest, LoadMmap) {
+  gflags::FlagSaver flag_saver;
+  butil::Status ok;
+
+  const std::string path = "./mmap_ivf_flat";
+  pb::common::VectorIndexParameter index_parameter;
+  index_parameter.set_vector_index_type(::dingodb::pb::common::VectorIndexType::VECTOR_INDEX_TYPE_IVF_FLAT);
+  index_parameter.mutable_ivf_flat_parameter()->set_dimension(dimension);
+  index_parameter.mutable_ivf_flat_parameter()->set_metric_type(::dingodb::pb::common::MetricType::METRIC_TYPE_L2);
+  index_parameter.mutable_ivf_flat_parameter()->set_ncentroids(ncentroids);
+  pb::common::RegionEpoch epoch;
+  epoch.set_conf_version(1);
+  epoch.set_version(10);
+  auto new_vector_index = [&]() { return VectorIndexFactory::New(2, index_parameter, epoch, pb::common::Range()); };
+
+  std::mt19937 rng;
+  std::uniform_real_distribution<> distrib;
+  std::vector<pb::common::VectorWithId> vector_with_ids(data_base_size);
+  for (int i = 0; i < data_base_size; ++i) {
+    vector_with_ids[i].set_id(start_id + i);
+    for (int j = 0; j < dimension; ++j) {
+      vector_with_ids[i].mutable_vector()->add_float_values(distrib(rng));
+    }
+  }
+
+  auto source_vector_index = new_vector_index();
+  ASSERT_NE(source_vector_index, nullptr);
+  ok = source_vector_index->Train(vector_with_ids);
+  ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+  ok = source_vector_index->Add(vector_with_ids);
+  ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+  ok = source_vector_index->Save(path);
+  ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+
+  FLAGS_vector_index_load_mmap = false;
+  auto heap_vector_index = new_vector_index();
+  ok = heap_vector_index->Load(path);
+  ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+
+  FLAGS_vector_index_load_mmap = true;
+  auto mmap_vector_index = new_vector_index();
+  ok = mmap_vector_index->Load(path);
+  ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+
+  pb::common::VectorWithId query = vector_with_ids[0];
+  uint32_t topk = 10;
+  std::vector<pb::index::VectorWithDistanceResult> heap_results;
+  ok = heap_vector_index->Search({query}, topk, {}, false, {}, heap_results);
+  EXPECT_EQ(ok.error_code(), pb::error::Errno::OK);
+  std::vector<pb::index::VectorWithDistanceResult> mmap_results;
+  ok = mmap_vector_index->Search({query}, topk, {}, false, {}, mmap_results);
+  EXPECT_EQ(ok.error_code(), pb::error::Errno::OK);
+  ASSERT_EQ(heap_results.size(), mmap_results.size());
+  for (size_t i = 0; i < heap_results.size(); ++i) {
+    ASSERT_EQ(heap_results[i].vector_with_distances_size(), mmap_results[i].vector_with_distances_size());
+    for (int j = 0; j < heap_results[i].vector_with_distances_size(); ++j) {
+      EXPECT_EQ(heap_results[i].vector_with_distances(j).vector_with_id().id(),
+                mmap_results[i].vector_with_distances(j).vector_with_id().id());
+    }
+  }
+
+  // write copy the mmap inverted lists to memory
+  int64_t count_before = 0;
+  ok = mmap_vector_index->GetCount(count_before);
+  EXPECT_EQ(ok.error_code(), pb::error::Errno::OK);
+  EXPECT_EQ(count_before, data_base_size);
+
+  pb::common::VectorWithId vector_with_id = query;
+  vector_with_id.set_id(start_id + data_base_size + 1);
+  ok = mmap_vector_index->Add({vector_with_id});
+  EXPECT_EQ(ok.error_code(), pb::error::Errno::OK);
+
+  int64_t count_after = 0;
+  ok = mmap_vector_index->GetCount(count_after);
+  EXPECT_EQ(ok.error_code(), pb::error::Errno::OK);
+  EXPECT_EQ(count_after, count_before + 1);
+
+  ok = mmap_vector_index->Delete({vector_with_id.id()});
+  EXPECT_EQ(ok.error_code(), pb::error::Errno::OK);
+
+  mmap_vector_index.reset();
+  Helper::RemoveFileOrDirectory(path);
+}
+
+// Delete only mark tombstone, the deleted vector is skipped by search and purged by compact.
+TEST_F(VectorIndexIvfFlatTest, DeleteTombstone) {
+  butil::Status ok;
+
+  ok = vector_index_ivf_flat_l2->Load(path_l2);
+  EXPECT_EQ(ok.error_code(), pb::error::Errno::OK);
+
+  pb::common::VectorWithId query;
+  query.set_id(start_id);
+  for (size_t i = 0; i < dimension; i++) {
+    query.mutable_vector()->add_float_values(data_base[i]);
+  }
+  uint32_t topk = 10;
+
+  auto is_in_results = [](const std::vector<pb::index::VectorWithDistanceResult>& results, int64_t id) {
+    for (const auto& result : results) {
+      for (const auto& vector_with_distance : result.vector_with_distances()) {
+        if (vector_with_distance.vector_with_id().id() == id) {
+          return true;
+        }
+      }
+    }
+    return false;
+  };
+
+  int64_t count_before = 0;
+  ok = vector_index_ivf_flat_l2->GetCount(count_before);
+  EXPECT_EQ(ok.error_code(), pb::error::Errno::OK);
+
+  ok = vector_index_ivf_flat_l2->Delete({start_id});
+  EXPECT_EQ(ok.error_code(), pb::error::Errno::OK);
+
+  int64_t deleted_count = 0;
+  ok = vector_index_ivf_flat_l2->GetDeletedCount(deleted_count);
+  EXPECT_EQ(ok.error_code(), pb::error::Errno::OK);
+  EXPECT_EQ(deleted_count, 1);
+
+  // The deleted again or never added vector is not tombstoned.
+  ok = vector_index_ivf_flat_l2->Delete({start_id, start_id + data_base_size + 100});
+  EXPECT_EQ(ok.error_code(), pb::error::Errno::OK);
+  ok = vector_index_ivf_flat_l2->GetDeletedCount(deleted_count);
+  EXPECT_EQ(ok.error_code(), pb::error::Errno::OK);
+  EXPECT_EQ(deleted_count, 1);
+
+  std::vector<pb::index::VectorWithDistanceResult> results;
+  ok = vector_index_ivf_flat_l2->Search({query}, topk, {}, false, {}, results);
+  EXPECT_EQ(ok.error_code(), pb::error::Errno::OK);
+  EXPECT_FALSE(is_in_results(results, start_id));
+
+  ok = vector_index_ivf_flat_l2->Compact();
+  EXPECT_EQ(ok.error_code(), pb::error::Errno::OK);
+  ok = vector_index_ivf_flat_l2->GetDeletedCount(deleted_count);
+  EXPECT_EQ(ok.error_code(), pb::error::Errno::OK);
+  EXPECT_EQ(deleted_count, 0);
+
+  int64_t count_after = 0;
+  ok = vector_index_ivf_flat_l2->GetCount(count_after);
+  EXPECT_EQ(ok.error_code(), pb::error::Errno::OK);
+  EXPECT_EQ(count_after, count_before - 1);
+
+  // Delete then add again, the vector is visible again.
+  ok = vector_index_ivf_flat_l2->Delete({start_id});
+  EXPECT_EQ(ok.error_code(), pb::error::Errno::OK);
+  ok = vector_index_ivf_flat_l2->Add({query});
+  EXPECT_EQ(ok.error_code(), pb::error::Errno::OK);
+  ok = vector_index_ivf_flat_l2->GetDeletedCount(deleted_count);
+  EXPECT_EQ(ok.error_code(), pb::error::Errno::OK);
+  EXPECT_EQ(deleted_count, 0);
+
+  results.clear();
+  ok = vector_index_ivf_flat_l2->Search({query}, topk, {}, false, {}, results);
+  EXPECT_EQ(ok.error_code(), pb::error::Errno::OK);
+  EXPECT_TRUE(is_in_results(results, start_id));
+}
+
+// Delete a small batch from a large index, only the existing ids are tombstoned, also after reload.
+TEST_F(VectorIndexIvfFlatTest, DeleteSmallBatchFromLargeIndex) {
+  const int64_t vector_count = 100000;
+  const int64_t base_id = 1;
+  const std::string path = "./large_ivf_flat";
+
+  static const pb::common::Range kRange;
+  pb::common::RegionEpoch epoch;
+  epoch.set_conf_version(1);
+  epoch.set_version(10);
+  pb::common::VectorIndexParameter index_parameter;
+  index_parameter.set_vector_index_type(::dingodb::pb::common::VectorIndexType::VECTOR_INDEX_TYPE_IVF_FLAT);
+  index_parameter.mutable_ivf_flat_parameter()->set_dimension(dimension);
+  index_parameter.mutable_ivf_flat_parameter()->set_metric_type(::dingodb::pb::common::MetricType::METRIC_TYPE_L2);
+  index_parameter.mutable_ivf_flat_parameter()->set_ncentroids(64);
+  auto vector_index = VectorIndexFactory::New(2, index_parameter, epoch, kRange);
+  ASSERT_NE(vector_index, nullptr);
+
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<> distrib;
+  std::vector<pb::common::VectorWithId> vector_with_ids(vector_count);
+  for (int64_t i = 0; i < vector_count; ++i) {
+    vector_with_ids[i].set_id(base_id + i);
+    for (int j = 0; j < dimension; ++j) {
+      vector_with_ids[i].mutable_vector()->add_float_values(distrib(rng));
+    }
+  }
+  butil::Status ok = vector_index->Add(vector_with_ids);
+  ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+
+  // 5 existing ids, 5 unknown ids and a repeated id.
+  std::vector<int64_t> delete_ids = {base_id,
+                                     base_id + 1,
+                                     base_id + vector_count / 2,
+                                     base_id + vector_count - 2,
+                                     base_id + vector_count - 1,
+                                     base_id - 1,
+                                     base_id + vector_count,
+                                     base_id + vector_count + 1,
+                                     base_id + vector_count * 10,
+                                     -1,
+                                     base_id};
+  ok = vector_index->Delete(delete_ids);
+  ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+  int64_t deleted_count = 0;
+  ASSERT_EQ(vector_index->GetDeletedCount(deleted_count).error_code(), pb::error::Errno::OK);
+  EXPECT_EQ(deleted_count, 5);
+
+  // Delete the tombstoned ids again changes nothing.
+  ok = vector_index->Delete(delete_ids);
+  ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+  ASSERT_EQ(vector_index->GetDeletedCount(deleted_count).error_code(), pb::error::Errno::OK);
+  EXPECT_EQ(deleted_count, 5);
+
+  // Save purge the tombstones, the purged ids are unknown after that.
+  ok = vector_index->Save(path);
+  ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+  int64_t count = 0;
+  ASSERT_EQ(vector_index->GetCount(count).error_code(), pb::error::Errno::OK);
+  EXPECT_EQ(count, vector_count - 5);
+  ok = vector_index->Delete({base_id, base_id + 2});
+  ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+  ASSERT_EQ(vector_index->GetDeletedCount(deleted_count).error_code(), pb::error::Errno::OK);
+  EXPECT_EQ(deleted_count, 1);
+
+  // The loaded index know its ids too.
+  auto loaded_vector_index = VectorIndexFactory::New(3, index_parameter, epoch, kRange);
+  ASSERT_NE(loaded_vector_index, nullptr);
+  ok = loaded_vector_index->Load(path);
+  ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+  ok = loaded_vector_index->Delete({base_id, base_id + 2, base_id + 3});
+  ASSERT_EQ(ok.error_code(), pb::error::Errno::OK);
+  ASSERT_EQ(loaded_vector_index->GetDeletedCount(deleted_count).error_code(), pb::error::Errno::OK);
+  EXPECT_EQ(deleted_count, 2);
+
+  Helper::RemoveAllFileOrDirectory(path);
+}
+
 }  // namespace dingodb
@@ -0,0 +1,280 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "braft/configuration_manager.h"
+#include "braft/log_entry.h"
+#include "butil/iobuf.h"
+#include "common/constant.h"
+#include "common/helper.h"
+#include "config/yaml_config.h"
+#include "engine/rocks_raw_engine.h"
+#include "gflags/gflags.h"
+#include "log/segment_log_storage.h"
+#include "proto/common.pb.h"
+#include "proto/raft.pb.h"
+#include "vector/codec.h"
+#include "vector/vector_index.h"
+#include "vector/vector_index_factory.h"
+#include "vector/vector_index_manager.h"
+
+namespace dingodb {  // NOLINT
+
+DECLARE_int32(vector_index_build_chunk_size);
+DECLARE_int64(vector_index_replay_wal_window_size);
+DECLARE_int32(vector_index_replay_wal_decode_parallel_num);
+
+static const std::string kVectorIndexManagerRootPath = "./unit_test_vector_index_manager";
+static const std::string kVectorIndexManagerLogPath = kVectorIndexManagerRootPath + "/log";
+static const std::string kVectorIndexManagerStorePath = kVectorIndexManagerRootPath + "/db";
+static const std::string kVectorIndexManagerYamlConfigContent =
+    "cluster:\n"
+    "  name: dingodb\n"
+    "  instance_id: 666\n"
+    "server:\n"
+    "  host: 127.0.0.1\n"
+    "  port: 23000\n"
+    "log:\n"
+    "  path: " +
+    kVectorIndexManagerLogPath +
+    "\n"
+    "store:\n"
+    "  path: " +
+    kVectorIndexManagerStorePath + "\n";
+
+class VectorIndexManagerTest : public testing::Test {
+ protected:
+  static void SetUpTestSuite() {
+    Helper::CreateDirectories(kVectorIndexManagerLogPath);
+    Helper::CreateDirectories(kVectorIndexManagerStorePath);
+
+    std::shared_ptr<Config> config = std::make_shared<YamlConfig>();
+    if (config->Load(kVectorIndexManagerYamlConfigContent) != 0) {
+      std::cout << "Load config failed" << '\n';
+      return;
+    }
+
+    engine = std::make_shared<RocksRawEngine>();
+    if (!engine->Init(config, {Constant::kVectorDataCF})) {
+      std::cout << "RocksRawEngine init failed" << '\n';
+    }
+  }
+
+  static void TearDownTestSuite() {
+    engine->Close();
+    engine->Destroy();
+    Helper::RemoveAllFileOrDirectory(kVectorIndexManagerRootPath);
+  }
+
+  static std::string EncodeKey(int64_t vector_id) {
+    std::string key;
+    VectorCodec::EncodeVectorKey('r', kPartitionId, vector_id, key);
+    return key;
+  }
+
+  static pb::common::VectorWithId GenVectorWithId(int64_t vector_id, float value) {
+    pb::common::VectorWithId vector_with_id;
+    vector_with_id.set_id(vector_id);
+    vector_with_id.mutable_vector()->set_dimension(kDimension);
+    vector_with_id.mutable_vector()->set_value_type(pb::common::ValueType::FLOAT);
+    for (int i = 0; i < kDimension; ++i) {
+      vector_with_id.mutable_vector()->add_float_values(value);
+    }
+    return vector_with_id;
+  }
+
+  static void AppendVectorLogEntry(std::shared_ptr<SegmentLogStorage> log_storage,
+                                   const std::vector<pb::common::VectorWithId>& add_vectors,
+                                   const std::vector<int64_t>& delete_ids) {
+    pb::raft::RaftCmdRequest raft_cmd;
+    if (!add_vectors.empty()) {
+      auto* request = raft_cmd.add_requests();
+      request->set_cmd_type(pb::raft::VECTOR_ADD);
+      for (const auto& vector : add_vectors) {
+        *request->mutable_vector_add()->add_vectors() = vector;
+      }
+    }
+    if (!delete_ids.empty()) {
+      auto* request = raft_cmd.add_requests();
+      request->set_cmd_type(pb::raft::VECTOR_DELETE);
+      for (auto vector_id : delete_ids) {
+        request->mutable_vector_delete()->add_ids(vector_id);
+      }
+    }
+
+    auto* log_entry = new braft::LogEntry();
+    log_entry->AddRef();
+    log_entry->type = braft::ENTRY_TYPE_DATA;
+    log_entry->id.term = 1;
+    log_entry->id.index = log_storage->LastLogIndex() + 1;
+    butil::IOBufAsZeroCopyOutputStream wrapper(&log_entry->data);
+    raft_cmd.SerializeToZeroCopyStream(&wrapper);
+
+    log_storage->AppendEntry(log_entry);
+    log_entry->Release();
+  }
+
+  static constexpr int64_t kPartitionId = 1000;
+  static constexpr int kDimension = 16;
+
+  static std::shared_ptr<RocksRawEngine> engine;
+};
+
+std::shared_ptr<RocksRawEngine> VectorIndexManagerTest::engine = nullptr;
+
+TEST_F(VectorIndexManagerTest, BuildVectorIndexWithData) {
+  gflags::FlagSaver flag_saver;
+  // Many small chunks, so the adder merges the chunks decoded in parallel.
+  FLAGS_vector_index_build_chunk_size = 64;
+
+  const int64_t start_id = 1;
+  const int64_t end_id = 5001;
+  const int64_t invalid_id = 100;
+
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<> distrib;
+  std::vector<pb::common::KeyValue> kvs;
+  for (int64_t id = start_id; id < end_id; ++id) {
+    pb::common::Vector vector;
+    // The vector without value is skipped.
+    if (id != invalid_id) {
+      for (int i = 0; i < kDimension; ++i) {
+        vector.add_float_values(distrib(rng));
+      }
+    }
+
+    auto& kv = kvs.emplace_back();
+    kv.set_key(EncodeKey(id));
+    kv.set_value(vector.SerializeAsString());
+  }
+  // Out of the region range.
+  auto& out_kv = kvs.emplace_back();
+  out_kv.set_key(EncodeKey(end_id + 10));
+  out_kv.set_value(kvs.front().value());
+  ASSERT_TRUE(engine->Writer()->KvBatchPutAndDelete(Constant::kVectorDataCF, kvs, {}).ok());
+
+  pb::common::VectorIndexParameter index_parameter;
+  index_parameter.set_vector_index_type(pb::common::VectorIndexType::VECTOR_INDEX_TYPE_HNSW);
+  index_parameter.mutable_hnsw_parameter()->set_dimension(kDimension);
+  index_parameter.mutable_hnsw_parameter()->set_metric_type(pb::common::MetricType::METRIC_TYPE_L2);
+  index_parameter.mutable_hnsw_parameter()->set_efconstruction(40);
+  index_parameter.mutable_hnsw_parameter()->set_max_elements(end_id);
+  index_parameter.mutable_hnsw_parameter()->set_nlinks(16);
+
+  pb::common::RegionEpoch epoch;
+  epoch.set_conf_version(1);
+  epoch.set_version(1);
+  pb::common::Range range;
+  range.set_start_key(EncodeKey(start_id));
+  range.set_end_key(EncodeKey(end_id));
+
+  const int64_t vector_index_id = 1;
+  auto vector_index = VectorIndexFactory::NewHnsw(vector_index_id, index_parameter, epoch, range, nullptr);
+  ASSERT_NE(vector_index, nullptr);
+  vector_index->SetApplyLogId(666);
+  auto vector_index_wrapper = VectorIndexWrapper::New(vector_index_id, index_parameter);
+
+  IteratorOptions options;
+  options.upper_bound = range.end_key();
+  auto iter = engine->Reader()->NewIterator(Constant::kVectorDataCF, options);
+  ASSERT_NE(iter, nullptr);
+
+  auto status = VectorIndexManager::BuildVectorIndexWithData(vector_index_wrapper, vector_index, iter,
+                                                             range.start_key(), range.end_key(), "unit test");
+  ASSERT_TRUE(status.ok()) << status.error_str();
+
+  int64_t count = 0;
+  ASSERT_TRUE(vector_index->GetCount(count).ok());
+  EXPECT_EQ(end_id - start_id - 1, count);
+  EXPECT_EQ(666, vector_index->ApplyLogId());
+
+  // The added vector is searchable.
+  std::vector<pb::common::VectorWithId> queries(1);
+  queries[0].set_id(start_id);
+  queries[0].mutable_vector()->ParseFromString(kvs.front().value());
+  std::vector<pb::index::VectorWithDistanceResult> results;
+  pb::common::VectorSearchParameter parameter;
+  parameter.mutable_hnsw()->set_efsearch(40);
+  ASSERT_TRUE(vector_index->Search(queries, 1, {}, false, parameter, results).ok());
+  ASSERT_EQ(1, results.size());
+  ASSERT_EQ(1, results[0].vector_with_distances_size());
+  EXPECT_EQ(start_id, results[0].vector_with_distances(0).vector_with_id().id());
+}
+
+// Replay across several windows, the add/delete of same vector id is coalesced in log order.
+TEST_F(VectorIndexManagerTest, ReplayWalToVectorIndex) {
+  gflags::FlagSaver flag_saver;
+  FLAGS_vector_index_replay_wal_window_size = 2;
+  FLAGS_vector_index_replay_wal_decode_parallel_num = 2;
+
+  const std::string log_path = kVectorIndexManagerRootPath + "/replay_wal_log";
+  Helper::CreateDirectories(log_path);
+  auto log_storage = std::make_shared<SegmentLogStorage>(log_path, 101, 8 * 1024 * 1024, INT64_MAX);
+  braft::ConfigurationManager configuration_manager;
+  ASSERT_EQ(0, log_storage->Init(&configuration_manager));
+
+  const int64_t start_id = 1;
+  const int64_t end_id = 5001;
+  AppendVectorLogEntry(log_storage, {GenVectorWithId(1, 1.0F), GenVectorWithId(2, 2.0F), GenVectorWithId(3, 3.0F)},
+                       {});
+  AppendVectorLogEntry(log_storage, {}, {2});
+  // Re-add the deleted vector with a new value, and a vector out of the region range.
+  AppendVectorLogEntry(log_storage, {GenVectorWithId(2, 20.0F), GenVectorWithId(end_id + 10, 1.0F)}, {});
+  AppendVectorLogEntry(log_storage, {}, {3});
+  AppendVectorLogEntry(log_storage, {GenVectorWithId(4, 4.0F)}, {});
+  const int64_t last_log_id = log_storage->LastLogIndex();
+
+  pb::common::VectorIndexParameter index_parameter;
+  index_parameter.set_vector_index_type(pb::common::VectorIndexType::VECTOR_INDEX_TYPE_FLAT);
+  index_parameter.mutable_flat_parameter()->set_dimension(kDimension);
+  index_parameter.mutable_flat_parameter()->set_metric_type(pb::common::MetricType::METRIC_TYPE_L2);
+  pb::common::RegionEpoch epoch;
+  epoch.set_conf_version(1);
+  epoch.set_version(1);
+  pb::common::Range range;
+  range.set_start_key(EncodeKey(start_id));
+  range.set_end_key(EncodeKey(end_id));
+
+  auto vector_index = VectorIndexFactory::New(2, index_parameter, epoch, range);
+  ASSERT_NE(vector_index, nullptr);
+
+  auto status = VectorIndexManager::ReplayWalToVectorIndex(log_storage, vector_index, log_storage->FirstLogIndex(),
+                                                           last_log_id);
+  ASSERT_TRUE(status.ok()) << status.error_str();
+
+  int64_t count = 0;
+  ASSERT_TRUE(vector_index->GetCount(count).ok());
+  EXPECT_EQ(3, count);
+  EXPECT_EQ(last_log_id, vector_index->ApplyLogId());
+
+  // The re-added vector keeps the last value.
+  std::vector<pb::common::VectorWithId> queries = {GenVectorWithId(0, 20.0F)};
+  std::vector<pb::index::VectorWithDistanceResult> results;
+  pb::common::VectorSearchParameter parameter;
+  ASSERT_TRUE(vector_index->Search(queries, 1, {}, false, parameter, results).ok());
+  ASSERT_EQ(1, results.size());
+  ASSERT_EQ(1, results[0].vector_with_distances_size());
+  EXPECT_EQ(2, results[0].vector_with_distances(0).vector_with_id().id());
+  EXPECT_FLOAT_EQ(0.0F, results[0].vector_with_distances(0).distance());
+}
+
+}  // namespace dingodb
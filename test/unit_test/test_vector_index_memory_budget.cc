@@ -0,0 +1,134 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "bthread/bthread.h"
+#include "common/helper.h"
+#include "common/synchronization.h"
+#include "gflags/gflags.h"
+#include "proto/common.pb.h"
+#include "vector/codec.h"
+#include "vector/vector_index.h"
+#include "vector/vector_index_factory.h"
+#include "vector/vector_index_memory_budget.h"
+
+namespace dingodb {
+
+DECLARE_int64(vector_index_memory_budget_min_idle_s);
+
+class VectorIndexMemoryBudgetTest : public testing::Test {
+ protected:
+  // id, memory_size, last_access_time_ms, access_count
+  static std::vector<VectorIndexMemoryBudget::Candidate> GenCandidates() {
+    return {{1, 100, 3000, 1}, {2, 200, 1000, 50}, {3, 300, 2000, 10}, {4, 400, 4000, 5}};
+  }
+};
+
+TEST_F(VectorIndexMemoryBudgetTest, UnderBudget) {
+  auto evict_ids = VectorIndexMemoryBudget::SelectEvictCandidates(GenCandidates(), 1000, 1000,
+                                                                  VectorIndexMemoryBudget::EvictPolicy::kLRU);
+  EXPECT_TRUE(evict_ids.empty());
+}
+
+TEST_F(VectorIndexMemoryBudgetTest, SelectLRU) {
+  auto evict_ids = VectorIndexMemoryBudget::SelectEvictCandidates(GenCandidates(), 1000, 600,
+                                                                  VectorIndexMemoryBudget::EvictPolicy::kLRU);
+  // The least recently accessed first, 1000 - 200 - 300 <= 600.
+  ASSERT_EQ(evict_ids.size(), 2);
+  EXPECT_EQ(evict_ids[0], 2);
+  EXPECT_EQ(evict_ids[1], 3);
+}
+
+TEST_F(VectorIndexMemoryBudgetTest, SelectLFU) {
+  auto evict_ids = VectorIndexMemoryBudget::SelectEvictCandidates(GenCandidates(), 1000, 600,
+                                                                  VectorIndexMemoryBudget::EvictPolicy::kLFU);
+  // The least frequently accessed first, 1000 - 100 - 400 <= 600.
+  ASSERT_EQ(evict_ids.size(), 2);
+  EXPECT_EQ(evict_ids[0], 1);
+  EXPECT_EQ(evict_ids[1], 4);
+}
+
+TEST_F(VectorIndexMemoryBudgetTest, NotEnoughCandidate) {
+  auto evict_ids = VectorIndexMemoryBudget::SelectEvictCandidates(GenCandidates(), 2000, 100,
+                                                                  VectorIndexMemoryBudget::EvictPolicy::kLRU);
+  // Evict all the candidates, the rest are not evictable.
+  EXPECT_EQ(evict_ids.size(), 4);
+}
+
+TEST_F(VectorIndexMemoryBudgetTest, WaitReload) {
+  pb::common::VectorIndexParameter index_parameter;
+  index_parameter.set_vector_index_type(pb::common::VectorIndexType::VECTOR_INDEX_TYPE_FLAT);
+  index_parameter.mutable_flat_parameter()->set_dimension(8);
+  index_parameter.mutable_flat_parameter()->set_metric_type(pb::common::MetricType::METRIC_TYPE_L2);
+  auto vector_index_wrapper = VectorIndexWrapper::New(1, index_parameter);
+
+  // Not evicted, no wait.
+  EXPECT_TRUE(vector_index_wrapper->WaitReload(1000));
+
+  vector_index_wrapper->EvictVectorIndex("unit test");
+  EXPECT_TRUE(vector_index_wrapper->IsEvicted());
+  EXPECT_FALSE(vector_index_wrapper->WaitReload(10));
+
+  // The waiter is woken up once the evicted state is left, not at the end of the wait time.
+  Bthread bthread([vector_index_wrapper] {
+    bthread_usleep(100 * 1000);
+    vector_index_wrapper->ClearVectorIndex("unit test");
+  });
+  int64_t start_time_ms = Helper::TimestampMs();
+  EXPECT_TRUE(vector_index_wrapper->WaitReload(10000));
+  EXPECT_LT(Helper::TimestampMs() - start_time_ms, 10000);
+  EXPECT_FALSE(vector_index_wrapper->IsEvicted());
+  bthread.Join();
+}
+
+TEST_F(VectorIndexMemoryBudgetTest, CanEvictOnlyLeader) {
+  gflags::FlagSaver flag_saver;
+  FLAGS_vector_index_memory_budget_min_idle_s = 0;
+
+  pb::common::VectorIndexParameter index_parameter;
+  index_parameter.set_vector_index_type(pb::common::VectorIndexType::VECTOR_INDEX_TYPE_FLAT);
+  index_parameter.mutable_flat_parameter()->set_dimension(8);
+  index_parameter.mutable_flat_parameter()->set_metric_type(pb::common::MetricType::METRIC_TYPE_L2);
+  pb::common::RegionEpoch epoch;
+  epoch.set_conf_version(1);
+  epoch.set_version(1);
+  pb::common::Range range;
+  VectorCodec::EncodeVectorKey('r', 1000, 1, *range.mutable_start_key());
+  VectorCodec::EncodeVectorKey('r', 1000, 1000, *range.mutable_end_key());
+
+  auto vector_index_wrapper = VectorIndexWrapper::New(1, index_parameter);
+  vector_index_wrapper->UpdateVectorIndex(VectorIndexFactory::New(1, index_parameter, epoch, range), "unit test");
+  ASSERT_TRUE(vector_index_wrapper->IsReady());
+
+  // The follower hold vector index is never accessed by request, nothing would reload it.
+  std::string reason;
+  EXPECT_FALSE(VectorIndexMemoryBudget::CanEvict(vector_index_wrapper, false, reason));
+  EXPECT_EQ("not leader", reason);
+
+  // The leader pass the leader check, still need a snapshot to reload from.
+  EXPECT_FALSE(VectorIndexMemoryBudget::CanEvict(vector_index_wrapper, true, reason));
+  EXPECT_EQ("no snapshot", reason);
+
+  vector_index_wrapper->EvictVectorIndex("unit test");
+  EXPECT_FALSE(vector_index_wrapper->IsReady());
+  EXPECT_FALSE(VectorIndexMemoryBudget::CanEvict(vector_index_wrapper, true, reason));
+  EXPECT_EQ("not ready", reason);
+}
+
+}  // namespace dingodb
@@ -14,16 +14,30 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <cstdint>
 #include <cstdlib>
+#include <filesystem>
+#include <fstream>
 #include <memory>
 #include <string>
 #include <vector>
 
+#include "braft/log_entry.h"
+#include "braft/protobuf_file.h"
 #include "butil/endpoint.h"
 #include "butil/strings/string_split.h"
+#include "common/helper.h"
 #include "fmt/core.h"
+#include "log/segment_log_storage.h"
+#include "proto/common.pb.h"
+#include "proto/index.pb.h"
+#include "proto/raft.pb.h"
+#include "proto/store_internal.pb.h"
+#include "vector/codec.h"
+#include "vector/vector_index_factory.h"
 #include "vector/vector_index_snapshot.h"
+#include "vector/vector_index_snapshot_manager.h"
 
 class VectorIndexSnapshotTest : public testing::Test {
  protected:
@@ -149,3 +163,165 @@ TEST_F(VectorIndexSnapshotTest, AddSnapshot) {  // NOLINT
     EXPECT_EQ(1, snapshot_set->GetSnapshots().size());
   }
 }
+
+TEST_F(VectorIndexSnapshotTest, IncrementalSnapshotMeta) {  // NOLINT
+  int64_t vector_index_id = 102;
+  int64_t base_snapshot_log_id = 10;
+  int64_t snapshot_log_id = 30;
+  std::string path = fmt::format("/tmp/{}/snapshot_{:020}", vector_index_id, snapshot_log_id);
+  std::filesystem::create_directories(path);
+
+  dingodb::pb::store_internal::VectorIndexSnapshotMeta meta;
+  meta.set_vector_index_id(vector_index_id);
+  meta.set_snapshot_log_id(snapshot_log_id);
+  meta.set_base_snapshot_log_id(base_snapshot_log_id);
+  braft::ProtoBufFile pb_file_meta(fmt::format("{}/meta", path));
+  ASSERT_EQ(0, pb_file_meta.save(&meta, true));
+
+  std::ofstream(fmt::format("{}/index_{}_{}.idx", path, vector_index_id, base_snapshot_log_id)).close();
+  std::ofstream(fmt::format("{}/delta_{:020}_{:020}", path, 20, 30)).close();
+  std::ofstream(fmt::format("{}/delta_{:020}_{:020}", path, 10, 20)).close();
+
+  auto snapshot = dingodb::vector_index::SnapshotMeta::New(vector_index_id, path);
+  ASSERT_TRUE(snapshot->Init());
+  EXPECT_EQ(snapshot_log_id, snapshot->SnapshotLogId());
+  EXPECT_EQ(base_snapshot_log_id, snapshot->BaseSnapshotLogId());
+  EXPECT_TRUE(snapshot->IsIncremental());
+  EXPECT_EQ(fmt::format("{}/index_{}_{}.idx", path, vector_index_id, base_snapshot_log_id), snapshot->IndexDataPath());
+
+  auto delta_paths = snapshot->DeltaPaths();
+  ASSERT_EQ(2, delta_paths.size());
+  EXPECT_EQ(fmt::format("{}/delta_{:020}_{:020}", path, 10, 20), delta_paths[0]);
+  EXPECT_EQ(fmt::format("{}/delta_{:020}_{:020}", path, 20, 30), delta_paths[1]);
+}
+
+static const int kDeltaDimension = 8;
+
+static dingodb::pb::common::VectorWithId GenVectorWithId(int64_t vector_id, float value) {
+  dingodb::pb::common::VectorWithId vector_with_id;
+  vector_with_id.set_id(vector_id);
+  vector_with_id.mutable_vector()->set_dimension(kDeltaDimension);
+  vector_with_id.mutable_vector()->set_value_type(dingodb::pb::common::ValueType::FLOAT);
+  for (int i = 0; i < kDeltaDimension; ++i) {
+    vector_with_id.mutable_vector()->add_float_values(value);
+  }
+  return vector_with_id;
+}
+
+static void AppendVectorLogEntry(std::shared_ptr<dingodb::SegmentLogStorage> log_storage,
+                                 const std::vector<dingodb::pb::common::VectorWithId>& add_vectors,
+                                 const std::vector<int64_t>& delete_ids) {
+  dingodb::pb::raft::RaftCmdRequest raft_cmd;
+  if (!add_vectors.empty()) {
+    auto* request = raft_cmd.add_requests();
+    request->set_cmd_type(dingodb::pb::raft::VECTOR_ADD);
+    for (const auto& vector : add_vectors) {
+      *request->mutable_vector_add()->add_vectors() = vector;
+    }
+  }
+  if (!delete_ids.empty()) {
+    auto* request = raft_cmd.add_requests();
+    request->set_cmd_type(dingodb::pb::raft::VECTOR_DELETE);
+    for (auto vector_id : delete_ids) {
+      request->mutable_vector_delete()->add_ids(vector_id);
+    }
+  }
+
+  auto* log_entry = new braft::LogEntry();
+  log_entry->AddRef();
+  log_entry->type = braft::ENTRY_TYPE_DATA;
+  log_entry->id.term = 1;
+  log_entry->id.index = log_storage->LastLogIndex() + 1;
+  butil::IOBufAsZeroCopyOutputStream wrapper(&log_entry->data);
+  raft_cmd.SerializeToZeroCopyStream(&wrapper);
+
+  log_storage->AppendEntry(log_entry);
+  log_entry->Release();
+}
+
+// Upsert -> delete -> re-upsert of the same vector across two deltas, applied on the base index.
+TEST_F(VectorIndexSnapshotTest, SnapshotDeltaRoundTrip) {  // NOLINT
+  const std::string path = "./unit_test_vector_index_snapshot_delta";
+  const int64_t partition_id = 1000;
+  dingodb::Helper::CreateDirectories(path + "/log");
+
+  auto log_storage = std::make_shared<dingodb::SegmentLogStorage>(path + "/log", 103, 8 * 1024 * 1024, INT64_MAX);
+  braft::ConfigurationManager configuration_manager;
+  ASSERT_EQ(0, log_storage->Init(&configuration_manager));
+
+  dingodb::pb::common::Range range;
+  dingodb::VectorCodec::EncodeVectorKey('r', partition_id, 1, *range.mutable_start_key());
+  dingodb::VectorCodec::EncodeVectorKey('r', partition_id, 100, *range.mutable_end_key());
+
+  // delta (0, 2]: upsert 4, then delete 2 and 4.
+  AppendVectorLogEntry(log_storage, {GenVectorWithId(4, 4.0f)}, {});
+  AppendVectorLogEntry(log_storage, {}, {2, 4});
+  // delta (2, 4]: re-upsert 2 and 4, the vector 200 is out of range, then delete 3.
+  AppendVectorLogEntry(log_storage, {GenVectorWithId(4, 40.0f), GenVectorWithId(2, 20.0f), GenVectorWithId(200, 1.0f)},
+                       {});
+  AppendVectorLogEntry(log_storage, {}, {3});
+
+  dingodb::pb::store_internal::VectorIndexSnapshotDelta delta1;
+  auto status = dingodb::VectorIndexSnapshotManager::GenSnapshotDelta(log_storage, range, 0, 2, delta1);
+  ASSERT_TRUE(status.ok()) << status.error_str();
+  EXPECT_EQ(0, delta1.upsert_vectors_size());
+  std::vector<int64_t> delete_ids1(delta1.delete_ids().begin(), delta1.delete_ids().end());
+  std::sort(delete_ids1.begin(), delete_ids1.end());
+  EXPECT_EQ(std::vector<int64_t>({2, 4}), delete_ids1);
+
+  dingodb::pb::store_internal::VectorIndexSnapshotDelta delta2;
+  status = dingodb::VectorIndexSnapshotManager::GenSnapshotDelta(log_storage, range, 2, 4, delta2);
+  ASSERT_TRUE(status.ok()) << status.error_str();
+  EXPECT_EQ(2, delta2.start_log_id());
+  EXPECT_EQ(4, delta2.end_log_id());
+  ASSERT_EQ(2, delta2.upsert_vectors_size());
+  for (const auto& vector : delta2.upsert_vectors()) {
+    EXPECT_EQ(vector.id() == 4 ? 40.0f : 20.0f, vector.vector().float_values(0));
+  }
+  ASSERT_EQ(1, delta2.delete_ids_size());
+  EXPECT_EQ(3, delta2.delete_ids(0));
+
+  std::vector<std::string> delta_paths = {fmt::format("{}/delta_{:020}_{:020}", path, 0, 2),
+                                          fmt::format("{}/delta_{:020}_{:020}", path, 2, 4)};
+  braft::ProtoBufFile pb_file_delta1(delta_paths[0]);
+  ASSERT_EQ(0, pb_file_delta1.save(&delta1, true));
+  braft::ProtoBufFile pb_file_delta2(delta_paths[1]);
+  ASSERT_EQ(0, pb_file_delta2.save(&delta2, true));
+
+  // The base index has 1, 2, 3.
+  dingodb::pb::common::VectorIndexParameter index_parameter;
+  index_parameter.set_vector_index_type(dingodb::pb::common::VectorIndexType::VECTOR_INDEX_TYPE_FLAT);
+  index_parameter.mutable_flat_parameter()->set_dimension(kDeltaDimension);
+  index_parameter.mutable_flat_parameter()->set_metric_type(dingodb::pb::common::MetricType::METRIC_TYPE_L2);
+  dingodb::pb::common::RegionEpoch epoch;
+  epoch.set_conf_version(1);
+  epoch.set_version(1);
+  auto vector_index = dingodb::VectorIndexFactory::New(103, index_parameter, epoch, range);
+  ASSERT_NE(nullptr, vector_index);
+  ASSERT_TRUE(vector_index->Add({GenVectorWithId(1, 1.0f), GenVectorWithId(2, 2.0f), GenVectorWithId(3, 3.0f)}).ok());
+
+  for (const auto& delta_path : delta_paths) {
+    status = dingodb::VectorIndexSnapshotManager::ApplySnapshotDelta(vector_index, delta_path);
+    ASSERT_TRUE(status.ok()) << status.error_str();
+  }
+
+  int64_t count = 0;
+  ASSERT_TRUE(vector_index->GetCount(count).ok());
+  EXPECT_EQ(3, count);
+
+  // The re-upserted vectors have the values of the last delta, the deleted one is gone.
+  std::vector<dingodb::pb::common::VectorWithId> queries = {GenVectorWithId(0, 40.0f), GenVectorWithId(0, 20.0f),
+                                                            GenVectorWithId(0, 3.0f)};
+  std::vector<dingodb::pb::index::VectorWithDistanceResult> results;
+  ASSERT_TRUE(vector_index->Search(queries, 1, {}, false, {}, results).ok());
+  ASSERT_EQ(3, results.size());
+  std::vector<int64_t> expect_ids = {4, 2, 1};
+  for (size_t i = 0; i < results.size(); ++i) {
+    ASSERT_EQ(1, results[i].vector_with_distances_size());
+    EXPECT_EQ(expect_ids[i], results[i].vector_with_distances(0).vector_with_id().id());
+  }
+  EXPECT_FLOAT_EQ(0.0f, results[0].vector_with_distances(0).distance());
+  EXPECT_FLOAT_EQ(0.0f, results[1].vector_with_distances(0).distance());
+
+  dingodb::Helper::RemoveAllFileOrDirectory(path);
+}
@@ -0,0 +1,186 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "gflags/gflags.h"
+#include "proto/common.pb.h"
+#include "vector/vector_index_train_sample.h"
+#include "vector/vector_index_utils.h"
+
+namespace dingodb {
+
+DECLARE_int64(vector_index_train_sample_max_count);
+
+class VectorIndexTrainSampleTest : public testing::Test {
+ protected:
+  static constexpr int32_t kDimension = 4;
+
+  static std::vector<pb::common::VectorWithId> GenVectors(int64_t start_id, int64_t count) {
+    std::vector<pb::common::VectorWithId> vector_with_ids;
+    for (int64_t id = start_id; id < start_id + count; ++id) {
+      auto& vector_with_id = vector_with_ids.emplace_back();
+      vector_with_id.set_id(id);
+      for (int i = 0; i < kDimension; ++i) {
+        vector_with_id.mutable_vector()->add_float_values(static_cast<float>(id));
+      }
+    }
+    return vector_with_ids;
+  }
+};
+
+TEST_F(VectorIndexTrainSampleTest, Bounded) {
+  auto train_sample = VectorIndexTrainSample::New(100, kDimension, 1);
+
+  train_sample->Add(GenVectors(0, 50));
+  EXPECT_EQ(train_sample->Size(), 50);
+  EXPECT_EQ(train_sample->GetTrainData().size(), 50 * kDimension);
+
+  train_sample->Add(GenVectors(50, 10000));
+  EXPECT_EQ(train_sample->Size(), 100);
+  EXPECT_EQ(train_sample->SeenCount(), 10050);
+  EXPECT_EQ(train_sample->GetTrainData().size(), 100 * kDimension);
+
+  // Mismatch dimension is ignored.
+  std::vector<pb::common::VectorWithId> invalid_vectors(1);
+  invalid_vectors[0].mutable_vector()->add_float_values(1.0);
+  train_sample->Add(invalid_vectors);
+  EXPECT_EQ(train_sample->SeenCount(), 10050);
+
+  train_sample->Clear();
+  EXPECT_EQ(train_sample->Size(), 0);
+  EXPECT_EQ(train_sample->SeenCount(), 0);
+}
+
+TEST_F(VectorIndexTrainSampleTest, DeleteAndUpdate) {
+  auto train_sample = VectorIndexTrainSample::New(100, kDimension, 1);
+  train_sample->Add(GenVectors(0, 10));
+  int64_t memory_size = train_sample->MemorySize();
+  EXPECT_GE(memory_size, 10 * kDimension * sizeof(float));
+
+  // The deleted vector is dropped from the sample, the unknown one is ignored.
+  train_sample->Delete({3, 5, 1000});
+  EXPECT_EQ(train_sample->Size(), 8);
+  EXPECT_EQ(train_sample->SeenCount(), 8);
+  auto train_data = train_sample->GetTrainData();
+  ASSERT_EQ(train_data.size(), 8 * kDimension);
+  for (size_t i = 0; i < train_data.size(); i += kDimension) {
+    EXPECT_NE(train_data[i], 3.0f);
+    EXPECT_NE(train_data[i], 5.0f);
+  }
+
+  // The sampled vector is updated in place, not sampled twice.
+  auto vector_with_ids = GenVectors(7, 1);
+  for (auto& value : *vector_with_ids[0].mutable_vector()->mutable_float_values()) {
+    value = 70.0f;
+  }
+  train_sample->Add(vector_with_ids);
+  EXPECT_EQ(train_sample->Size(), 8);
+  train_data = train_sample->GetTrainData();
+  int64_t updated_count = 0;
+  for (size_t i = 0; i < train_data.size(); i += kDimension) {
+    EXPECT_NE(train_data[i], 7.0f);
+    updated_count += train_data[i] == 70.0f ? 1 : 0;
+  }
+  EXPECT_EQ(updated_count, 1);
+
+  // Delete and add again.
+  train_sample->Delete({7});
+  train_sample->Add(GenVectors(7, 1));
+  EXPECT_EQ(train_sample->Size(), 8);
+}
+
+TEST_F(VectorIndexTrainSampleTest, Uniform) {
+  auto train_sample = VectorIndexTrainSample::New(1000, kDimension, 1);
+  train_sample->Add(GenVectors(0, 10000));
+  train_sample->Add(GenVectors(10000, 10000));
+
+  // Half of the sample should come from the latter half of the stream.
+  auto train_data = train_sample->GetTrainData();
+  int64_t latter_count = 0;
+  for (size_t i = 0; i < train_data.size(); i += kDimension) {
+    if (train_data[i] >= 10000) {
+      ++latter_count;
+    }
+  }
+  EXPECT_GT(latter_count, 400);
+  EXPECT_LT(latter_count, 600);
+}
+
+TEST_F(VectorIndexTrainSampleTest, GetCapacity) {
+  pb::common::VectorIndexParameter parameter;
+  parameter.set_vector_index_type(pb::common::VECTOR_INDEX_TYPE_HNSW);
+  EXPECT_EQ(VectorIndexTrainSample::GetCapacity(parameter), 0);
+  EXPECT_EQ(VectorIndexTrainSample::New(parameter), nullptr);
+
+  parameter.set_vector_index_type(pb::common::VECTOR_INDEX_TYPE_IVF_FLAT);
+  parameter.mutable_ivf_flat_parameter()->set_dimension(kDimension);
+  parameter.mutable_ivf_flat_parameter()->set_ncentroids(10);
+  EXPECT_EQ(VectorIndexTrainSample::GetCapacity(parameter), 2560);
+
+  auto train_sample = VectorIndexTrainSample::New(parameter);
+  ASSERT_NE(train_sample, nullptr);
+  EXPECT_EQ(train_sample->Capacity(), 2560);
+  EXPECT_EQ(train_sample->Dimension(), kDimension);
+}
+
+TEST_F(VectorIndexTrainSampleTest, GetCapacityNotBelowTrainNeed) {
+  gflags::FlagSaver flag_saver;
+  FLAGS_vector_index_train_sample_max_count = 1000;
+
+  // The max count cap the 256 points per centroid, but never below the 39 points per centroid.
+  pb::common::VectorIndexParameter parameter;
+  parameter.set_vector_index_type(pb::common::VECTOR_INDEX_TYPE_IVF_FLAT);
+  parameter.mutable_ivf_flat_parameter()->set_dimension(kDimension);
+  parameter.mutable_ivf_flat_parameter()->set_ncentroids(2);
+  EXPECT_EQ(VectorIndexTrainSample::GetCapacity(parameter), 512);
+  parameter.mutable_ivf_flat_parameter()->set_ncentroids(10);
+  EXPECT_EQ(VectorIndexTrainSample::GetCapacity(parameter), 1000);
+  parameter.mutable_ivf_flat_parameter()->set_ncentroids(2048);
+  EXPECT_EQ(VectorIndexTrainSample::GetCapacity(parameter), 39 * 2048);
+
+  // The pq codebook always get 256 points per code.
+  parameter.set_vector_index_type(pb::common::VECTOR_INDEX_TYPE_IVF_PQ);
+  parameter.mutable_ivf_pq_parameter()->set_dimension(kDimension);
+  parameter.mutable_ivf_pq_parameter()->set_ncentroids(10);
+  parameter.mutable_ivf_pq_parameter()->set_nbits_per_idx(8);
+  EXPECT_EQ(VectorIndexTrainSample::GetCapacity(parameter), 256 * 256);
+  parameter.mutable_ivf_pq_parameter()->set_ncentroids(4096);
+  EXPECT_EQ(VectorIndexTrainSample::GetCapacity(parameter), 39 * 4096);
+}
+
+TEST_F(VectorIndexTrainSampleTest, ImbalanceFactor) {
+  EXPECT_DOUBLE_EQ(VectorIndexTrainSample::ImbalanceFactor({}), 1.0);
+  EXPECT_DOUBLE_EQ(VectorIndexTrainSample::ImbalanceFactor({10, 10, 10, 10}), 1.0);
+  // All in one list of four.
+  EXPECT_DOUBLE_EQ(VectorIndexTrainSample::ImbalanceFactor({40, 0, 0, 0}), 4.0);
+}
+
+TEST_F(VectorIndexTrainSampleTest, NeedRetrainOnSample) {
+  // nlist 10 need at least 390 vectors to train.
+  EXPECT_FALSE(VectorIndexUtils::NeedRetrainOnSample(10, 389, 10, 2560));
+  EXPECT_TRUE(VectorIndexUtils::NeedRetrainOnSample(10, 390, 10, 2560));
+  // Not double of the last train.
+  EXPECT_FALSE(VectorIndexUtils::NeedRetrainOnSample(1000, 1999, 10, 2560));
+  EXPECT_TRUE(VectorIndexUtils::NeedRetrainOnSample(1000, 2000, 10, 2560));
+  // Already trained with full sample.
+  EXPECT_FALSE(VectorIndexUtils::NeedRetrainOnSample(2560, 2560, 10, 2560));
+  // Capacity less than the min train size.
+  EXPECT_TRUE(VectorIndexUtils::NeedRetrainOnSample(10, 200, 10, 200));
+}
+
+}  // namespace dingodb
@@ -0,0 +1,192 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/constant.h"
+#include "common/helper.h"
+#include "config/yaml_config.h"
+#include "engine/engine.h"
+#include "engine/rocks_raw_engine.h"
+#include "gflags/gflags.h"
+#include "proto/common.pb.h"
+#include "proto/index.pb.h"
+#include "vector/codec.h"
+#include "vector/vector_index.h"
+#include "vector/vector_index_factory.h"
+#include "vector/vector_reader.h"
+
+namespace dingodb {  // NOLINT
+
+DECLARE_int64(vector_scalar_post_filter_init_expand_times);
+DECLARE_int64(vector_scalar_post_filter_max_expand_times);
+
+static const std::string kVectorReaderRootPath = "./unit_test_vector_reader";
+static const std::string kVectorReaderLogPath = kVectorReaderRootPath + "/log";
+static const std::string kVectorReaderStorePath = kVectorReaderRootPath + "/db";
+static const std::string kVectorReaderYamlConfigContent =
+    "cluster:\n"
+    "  name: dingodb\n"
+    "  instance_id: 666\n"
+    "server:\n"
+    "  host: 127.0.0.1\n"
+    "  port: 23000\n"
+    "log:\n"
+    "  path: " +
+    kVectorReaderLogPath +
+    "\n"
+    "store:\n"
+    "  path: " +
+    kVectorReaderStorePath + "\n";
+
+class VectorReaderTest : public testing::Test {
+ protected:
+  static void SetUpTestSuite() {
+    Helper::CreateDirectories(kVectorReaderLogPath);
+    Helper::CreateDirectories(kVectorReaderStorePath);
+
+    std::shared_ptr<Config> config = std::make_shared<YamlConfig>();
+    if (config->Load(kVectorReaderYamlConfigContent) != 0) {
+      std::cout << "Load config failed" << '\n';
+      return;
+    }
+
+    engine = std::make_shared<RocksRawEngine>();
+    if (!engine->Init(config, {Constant::kVectorScalarCF})) {
+      std::cout << "RocksRawEngine init failed" << '\n';
+    }
+  }
+
+  static void TearDownTestSuite() {
+    engine->Close();
+    engine->Destroy();
+    Helper::RemoveAllFileOrDirectory(kVectorReaderRootPath);
+  }
+
+  static std::string EncodeKey(int64_t vector_id) {
+    std::string key;
+    VectorCodec::EncodeVectorKey('r', kPartitionId, vector_id, key);
+    return key;
+  }
+
+  static pb::common::VectorScalardata GenScalarData(const std::string& tag) {
+    pb::common::ScalarValue scalar_value;
+    scalar_value.set_field_type(pb::common::ScalarFieldType::STRING);
+    scalar_value.add_fields()->set_string_data(tag);
+
+    pb::common::VectorScalardata scalar_data;
+    scalar_data.mutable_scalar_data()->insert({"tag", scalar_value});
+    return scalar_data;
+  }
+
+  static constexpr int64_t kPartitionId = 1000;
+  static constexpr int kDimension = 8;
+
+  static std::shared_ptr<RocksRawEngine> engine;
+};
+
+std::shared_ptr<RocksRawEngine> VectorReaderTest::engine = nullptr;
+
+TEST_F(VectorReaderTest, ScalarPostFilterExpand) {
+  gflags::FlagSaver flag_saver;
+  FLAGS_vector_scalar_post_filter_init_expand_times = 4;
+  FLAGS_vector_scalar_post_filter_max_expand_times = 100;
+
+  // The vector of id k is (k, 0, ...), only the ids multiple of 10 match the filter.
+  const int64_t start_id = 1;
+  const int64_t end_id = 201;
+  pb::common::Range range;
+  range.set_start_key(EncodeKey(start_id));
+  range.set_end_key(EncodeKey(end_id));
+
+  std::vector<pb::common::VectorWithId> vector_with_ids;
+  std::vector<pb::common::KeyValue> scalar_kvs;
+  for (int64_t id = start_id; id < end_id; ++id) {
+    auto& vector_with_id = vector_with_ids.emplace_back();
+    vector_with_id.set_id(id);
+    for (int i = 0; i < kDimension; ++i) {
+      vector_with_id.mutable_vector()->add_float_values(i == 0 ? static_cast<float>(id) : 0.0F);
+    }
+
+    auto& kv = scalar_kvs.emplace_back();
+    kv.set_key(EncodeKey(id));
+    kv.set_value(GenScalarData(id % 10 == 0 ? "a" : "b").SerializeAsString());
+  }
+  ASSERT_TRUE(engine->Writer()->KvBatchPutAndDelete(Constant::kVectorScalarCF, scalar_kvs, {}).ok());
+
+  pb::common::VectorIndexParameter index_parameter;
+  index_parameter.set_vector_index_type(pb::common::VectorIndexType::VECTOR_INDEX_TYPE_FLAT);
+  index_parameter.mutable_flat_parameter()->set_dimension(kDimension);
+  index_parameter.mutable_flat_parameter()->set_metric_type(pb::common::MetricType::METRIC_TYPE_L2);
+  pb::common::RegionEpoch epoch;
+  epoch.set_conf_version(1);
+  epoch.set_version(1);
+
+  auto vector_index = VectorIndexFactory::New(1, index_parameter, epoch, range);
+  ASSERT_NE(vector_index, nullptr);
+  ASSERT_TRUE(vector_index->Add(vector_with_ids).ok());
+  auto vector_index_wrapper = VectorIndexWrapper::New(1, index_parameter);
+  vector_index_wrapper->UpdateVectorIndex(vector_index, "unit test");
+  ASSERT_TRUE(vector_index_wrapper->IsReady());
+
+  auto ctx = std::make_shared<Engine::VectorReader::Context>();
+  ctx->partition_id = kPartitionId;
+  ctx->region_range = range;
+  ctx->vector_index = vector_index_wrapper;
+  auto& query = ctx->vector_with_ids.emplace_back();
+  for (int i = 0; i < kDimension; ++i) {
+    query.mutable_vector()->add_float_values(0.0F);
+  }
+  *query.mutable_scalar_data() = GenScalarData("a");
+  ctx->parameter.set_top_n(5);
+  ctx->parameter.set_vector_filter(pb::common::VectorFilter::SCALAR_FILTER);
+  ctx->parameter.set_vector_filter_type(pb::common::VectorFilterType::QUERY_POST);
+  ctx->parameter.set_without_vector_data(true);
+  ctx->parameter.set_without_scalar_data(true);
+  ctx->parameter.set_without_table_data(true);
+
+  auto vector_reader = VectorReader::New(engine->Reader());
+
+  // The first pass gets the 20 nearest candidates with 2 matched, the expanded pass fills the top 5.
+  {
+    std::vector<pb::index::VectorWithDistanceResult> results;
+    auto status = vector_reader->VectorBatchSearch(ctx, results);
+    ASSERT_TRUE(status.ok()) << status.error_str();
+    ASSERT_EQ(results.size(), 1);
+    ASSERT_EQ(results[0].vector_with_distances_size(), 5);
+    for (int i = 0; i < 5; ++i) {
+      EXPECT_EQ(results[0].vector_with_distances(i).vector_with_id().id(), (i + 1) * 10);
+    }
+  }
+
+  // Not allowed to expand, only the matched ones of the first pass.
+  {
+    FLAGS_vector_scalar_post_filter_max_expand_times = 4;
+    std::vector<pb::index::VectorWithDistanceResult> results;
+    auto status = vector_reader->VectorBatchSearch(ctx, results);
+    ASSERT_TRUE(status.ok()) << status.error_str();
+    ASSERT_EQ(results.size(), 1);
+    ASSERT_EQ(results[0].vector_with_distances_size(), 2);
+    EXPECT_EQ(results[0].vector_with_distances(0).vector_with_id().id(), 10);
+    EXPECT_EQ(results[0].vector_with_distances(1).vector_with_id().id(), 20);
+  }
+}
+
+}  // namespace dingodb
@@ -0,0 +1,132 @@
+// Copyright (c) 2023 dingodb.com, Inc. All Rights Reserved
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "butil/status.h"
+#include "gflags/gflags.h"
+#include "proto/common.pb.h"
+#include "proto/index.pb.h"
+#include "vector/vector_search_coalescer.h"
+
+namespace dingodb {
+
+DECLARE_int64(vector_search_coalesce_window_us);
+
+class VectorSearchCoalescerTest : public testing::Test {
+ protected:
+  // Echo the query id as the result, so that we can check the result is split back correctly.
+  static butil::Status EchoSearch(const std::vector<pb::common::VectorWithId>& vector_with_ids,
+                                  std::vector<pb::index::VectorWithDistanceResult>& results) {
+    for (const auto& vector_with_id : vector_with_ids) {
+      auto& result = results.emplace_back();
+      result.add_vector_with_distances()->mutable_vector_with_id()->set_id(vector_with_id.id());
+    }
+    return butil::Status::OK();
+  }
+};
+
+TEST_F(VectorSearchCoalescerTest, GenCoalesceKey) {
+  pb::common::VectorSearchParameter parameter;
+  parameter.mutable_ivf_flat()->set_nprobe(10);
+  parameter.set_top_n(10);
+
+  pb::common::VectorSearchParameter other_parameter = parameter;
+  other_parameter.set_without_scalar_data(true);
+  EXPECT_EQ(VectorSearchCoalescer::GenCoalesceKey(10, false, parameter),
+            VectorSearchCoalescer::GenCoalesceKey(10, false, other_parameter));
+
+  other_parameter.mutable_ivf_flat()->set_nprobe(20);
+  EXPECT_NE(VectorSearchCoalescer::GenCoalesceKey(10, false, parameter),
+            VectorSearchCoalescer::GenCoalesceKey(10, false, other_parameter));
+  EXPECT_NE(VectorSearchCoalescer::GenCoalesceKey(10, false, parameter),
+            VectorSearchCoalescer::GenCoalesceKey(5, false, parameter));
+  EXPECT_NE(VectorSearchCoalescer::GenCoalesceKey(10, false, parameter),
+            VectorSearchCoalescer::GenCoalesceKey(10, true, parameter));
+
+  EXPECT_TRUE(VectorSearchCoalescer::IsSupportCoalesce(pb::common::VectorIndexType::VECTOR_INDEX_TYPE_FLAT));
+  EXPECT_FALSE(VectorSearchCoalescer::IsSupportCoalesce(pb::common::VectorIndexType::VECTOR_INDEX_TYPE_HNSW));
+}
+
+TEST_F(VectorSearchCoalescerTest, SearchAlone) {
+  auto coalescer = VectorSearchCoalescer::New();
+
+  std::vector<pb::common::VectorWithId> vector_with_ids(3);
+  for (int i = 0; i < vector_with_ids.size(); ++i) {
+    vector_with_ids[i].set_id(i + 1);
+  }
+
+  std::vector<pb::index::VectorWithDistanceResult> results;
+  auto status = coalescer->Search("key", vector_with_ids, EchoSearch, results);
+  EXPECT_TRUE(status.ok());
+  ASSERT_EQ(results.size(), vector_with_ids.size());
+  for (int i = 0; i < results.size(); ++i) {
+    EXPECT_EQ(results[i].vector_with_distances(0).vector_with_id().id(), vector_with_ids[i].id());
+  }
+}
+
+TEST_F(VectorSearchCoalescerTest, SearchConcurrent) {
+  // Restore the window when the test is done, the flag is shared by the later tests.
+  gflags::FlagSaver flag_saver;
+  FLAGS_vector_search_coalesce_window_us = 50000;
+  auto coalescer = VectorSearchCoalescer::New();
+
+  const int thread_num = 16;
+  const int query_num = 4;
+  std::atomic<int> search_count{0};
+  std::atomic<int> error_count{0};
+
+  auto search_func = [&](const std::vector<pb::common::VectorWithId>& vector_with_ids,
+                         std::vector<pb::index::VectorWithDistanceResult>& results) {
+    search_count.fetch_add(1);
+    return EchoSearch(vector_with_ids, results);
+  };
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < thread_num; ++t) {
+    threads.emplace_back([&, t]() {
+      std::vector<pb::common::VectorWithId> vector_with_ids(query_num);
+      for (int i = 0; i < query_num; ++i) {
+        vector_with_ids[i].set_id(t * query_num + i + 1);
+      }
+
+      std::vector<pb::index::VectorWithDistanceResult> results;
+      auto status = coalescer->Search("key", vector_with_ids, search_func, results);
+      if (!status.ok() || results.size() != query_num) {
+        error_count.fetch_add(1);
+        return;
+      }
+      for (int i = 0; i < query_num; ++i) {
+        if (results[i].vector_with_distances(0).vector_with_id().id() != vector_with_ids[i].id()) {
+          error_count.fetch_add(1);
+        }
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(error_count.load(), 0);
+  EXPECT_LT(search_count.load(), thread_num);
+}
+
+}  // namespace dingodb